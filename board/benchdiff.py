@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+# =============================================================================
+# board/benchdiff.py
+# Compare two APP=bench captures and flag regressions
+#
+# Usage:
+#   python3 board/benchdiff.py <before.log> <after.log> [--threshold PCT]
+#
+# Example:
+#   make BOARD=milkv-mars APP=bench            # flash, capture uart.log
+#   python3 board/benchdiff.py main.log branch.log
+#
+#   name                      param    before ns    after ns    change
+#   fb.fill_rect                256       41210       38876     -5.7%
+#   mem.memcpy              1048576     2140331     2398102    +12.0%  << slower
+#
+# =============================================================================
+# HOW IT WORKS
+# =============================================================================
+#
+# See kernel/src/bench.c. Every "@B" line is one result; the key is the
+# name plus its size parameter, the value compared is nanoseconds per
+# operation. Other UART output in the log is ignored, so a raw session
+# capture works as-is. A later "@bench" header resets the results, so a
+# log holding several runs compares its last one.
+#
+# Exit status is 1 if any result got slower than the threshold (default
+# 5%), so the script can gate a CI job that has a board attached.
+#
+# =============================================================================
+
+import sys
+
+
+def parse(path):
+    board = None
+    results = {}
+    with open(path, "r", errors="replace") as f:
+        for line in f:
+            fields = line.strip().split()
+            if not fields:
+                continue
+            if fields[0] == "@bench" and len(fields) >= 3:
+                board = fields[2]
+                results = {}
+            elif fields[0] == "@B" and len(fields) == 7:
+                try:
+                    param, ns = int(fields[2]), int(fields[5])
+                except ValueError:
+                    continue
+                results[(fields[1], param)] = ns
+    if board is None:
+        sys.exit("benchdiff: no @bench header in %s — was it built with APP=bench?" % path)
+    return board, results
+
+
+def main():
+    args = sys.argv[1:]
+    threshold = 5.0
+    if "--threshold" in args:
+        i = args.index("--threshold")
+        threshold = float(args[i + 1])
+        del args[i:i + 2]
+    if len(args) != 2:
+        sys.exit("usage: benchdiff.py <before.log> <after.log> [--threshold PCT]")
+
+    board_a, before = parse(args[0])
+    board_b, after = parse(args[1])
+    if board_a != board_b:
+        print("# warning: comparing %s against %s" % (board_a, board_b))
+
+    slower = 0
+    print("%-26s %9s %12s %12s %9s" % ("name", "param", "before ns", "after ns", "change"))
+    for key in sorted(set(before) | set(after)):
+        name, param = key
+        a, b = before.get(key), after.get(key)
+        if a is None or b is None:
+            print("%-26s %9u %12s %12s" % (name, param,
+                                            "-" if a is None else a, "-" if b is None else b))
+            continue
+        change = (b - a) * 100.0 / a if a else 0.0
+        flag = ""
+        if change > threshold:
+            flag = "  << slower"
+            slower += 1
+        elif change < -threshold:
+            flag = "  faster"
+        print("%-26s %9u %12u %12u %+8.1f%%%s" % (name, param, a, b, change, flag))
+
+    if slower:
+        print("# %u result(s) slower by more than %.1f%%" % (slower, threshold))
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
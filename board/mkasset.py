@@ -0,0 +1,303 @@
+#!/usr/bin/env python3
+# =============================================================================
+# board/mkasset.py
+# Convert an image into a compressed fb_rle_image_t C header
+#
+# Usage:
+#   python3 board/mkasset.py <input.png|input.ppm> <output.h> [symbol]
+#
+# Example:
+#   python3 board/mkasset.py art/logo.png ui/src/assets/logo.h ui_logo
+#
+#   #include "logo.h"
+#   fb_draw_rle(fb, 16, 16, &ui_logo);
+#
+# =============================================================================
+# THE FORMAT
+# =============================================================================
+#
+# See fb_rle_image_t in drivers/src/framebuffer/framebuffer.h. In short:
+#
+#   palette[]   every distinct ARGB8888 color in the image (at most 256);
+#               fully transparent pixels never get an entry
+#   data[]      per row, a stream of one-byte ops (op << 6 | n - 1):
+#                   SKIP n          transparent run
+#                   RUN n, idx      n pixels of palette[idx]
+#                   LITERAL n, idx… n pixels, one index each
+#   rows[]      byte offset of each row's stream; identical rows share one
+#
+# The header holds `static const` arrays: include it in the one file that
+# draws the asset. Nothing is decoded at build time or at boot —
+# fb_draw_rle() walks the stream straight into the framebuffer.
+#
+# =============================================================================
+# WHY NO PILLOW
+# =============================================================================
+#
+# The build only assumes python3 (mkimage.py is the same). PNG is zlib plus
+# a per-row filter, which the standard library covers: 8-bit grayscale,
+# RGB, RGBA, gray+alpha and palette PNGs, non-interlaced — what every
+# image editor exports by default. Binary PPM (P6) works as well.
+#
+# =============================================================================
+
+import struct
+import sys
+import zlib
+
+SKIP, RUN, LITERAL = 0, 1, 2
+MAX_RUN = 64
+
+
+# ---------------------------------------------------------------------------
+# Image loading → list of rows of ARGB8888 ints
+# ---------------------------------------------------------------------------
+
+def paeth(a, b, c):
+    p = a + b - c
+    pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+    if pa <= pb and pa <= pc:
+        return a
+    return b if pb <= pc else c
+
+
+def load_png(blob):
+    pos = 8
+    ihdr = None
+    plte = b""
+    trns = b""
+    idat = []
+    while pos < len(blob):
+        length, kind = struct.unpack(">I4s", blob[pos:pos + 8])
+        body = blob[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if kind == b"IHDR":
+            ihdr = struct.unpack(">IIBBBBB", body)
+        elif kind == b"PLTE":
+            plte = body
+        elif kind == b"tRNS":
+            trns = body
+        elif kind == b"IDAT":
+            idat.append(body)
+        elif kind == b"IEND":
+            break
+
+    width, height, depth, ctype, _, _, interlace = ihdr
+    if depth != 8 or interlace != 0:
+        sys.exit("mkasset: only 8-bit, non-interlaced PNGs are supported")
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}.get(ctype)
+    if channels is None:
+        sys.exit("mkasset: unsupported PNG color type %d" % ctype)
+
+    raw = zlib.decompress(b"".join(idat))
+    stride = width * channels
+    prev = bytearray(stride)
+    rows = []
+    pos = 0
+    for _ in range(height):
+        ftype = raw[pos]
+        line = bytearray(raw[pos + 1:pos + 1 + stride])
+        pos += 1 + stride
+        for i in range(stride):
+            a = line[i - channels] if i >= channels else 0
+            b = prev[i]
+            c = prev[i - channels] if i >= channels else 0
+            if ftype == 1:
+                line[i] = (line[i] + a) & 0xFF
+            elif ftype == 2:
+                line[i] = (line[i] + b) & 0xFF
+            elif ftype == 3:
+                line[i] = (line[i] + ((a + b) >> 1)) & 0xFF
+            elif ftype == 4:
+                line[i] = (line[i] + paeth(a, b, c)) & 0xFF
+        prev = line
+
+        px = []
+        for x in range(width):
+            v = line[x * channels:(x + 1) * channels]
+            if ctype == 0:
+                r = g = b = v[0]; al = 255
+            elif ctype == 4:
+                r = g = b = v[0]; al = v[1]
+            elif ctype == 2:
+                r, g, b = v; al = 255
+            elif ctype == 6:
+                r, g, b, al = v
+            else:
+                i = v[0]
+                r, g, b = plte[i * 3:i * 3 + 3]
+                al = trns[i] if i < len(trns) else 255
+            px.append((al << 24) | (r << 16) | (g << 8) | b)
+        rows.append(px)
+    return width, height, rows
+
+
+def load_ppm(blob):
+    fields = []
+    pos = 2
+    while len(fields) < 3:
+        while blob[pos:pos + 1].isspace():
+            pos += 1
+        if blob[pos:pos + 1] == b"#":
+            pos = blob.index(b"\n", pos)
+            continue
+        end = pos
+        while not blob[end:end + 1].isspace():
+            end += 1
+        fields.append(int(blob[pos:end]))
+        pos = end
+    width, height, maxval = fields
+    if maxval != 255:
+        sys.exit("mkasset: only 8-bit PPMs are supported")
+    pos += 1
+    rows = []
+    for y in range(height):
+        px = []
+        for x in range(width):
+            r, g, b = blob[pos:pos + 3]
+            pos += 3
+            px.append(0xFF000000 | (r << 16) | (g << 8) | b)
+        rows.append(px)
+    return width, height, rows
+
+
+def load(path):
+    with open(path, "rb") as f:
+        blob = f.read()
+    if blob[:8] == b"\x89PNG\r\n\x1a\n":
+        return load_png(blob)
+    if blob[:2] == b"P6":
+        return load_ppm(blob)
+    sys.exit("mkasset: %s is neither a PNG nor a binary PPM" % path)
+
+
+# ---------------------------------------------------------------------------
+# Encoding
+# ---------------------------------------------------------------------------
+
+def encode_row(indices):
+    """indices: palette index per pixel, None for transparent."""
+    out = bytearray()
+    literal = []
+
+    def flush_literal():
+        while literal:
+            chunk = literal[:MAX_RUN]
+            del literal[:MAX_RUN]
+            out.append((LITERAL << 6) | (len(chunk) - 1))
+            out.extend(chunk)
+
+    x = 0
+    n = len(indices)
+    while x < n:
+        v = indices[x]
+        run = 1
+        while x + run < n and indices[x + run] == v and run < MAX_RUN:
+            run += 1
+
+        if v is None:
+            flush_literal()
+            out.append((SKIP << 6) | (run - 1))
+        elif run >= 3 or (run == 2 and not literal):
+            flush_literal()
+            out.append((RUN << 6) | (run - 1))
+            out.append(v)
+        else:
+            literal.extend([v] * run)
+        x += run
+    flush_literal()
+    return bytes(out)
+
+
+def decode_row(stream, width, palette):
+    """Reference decoder, used to check every row before writing."""
+    px = []
+    pos = 0
+    while len(px) < width:
+        op, n = stream[pos] >> 6, (stream[pos] & 0x3F) + 1
+        pos += 1
+        if op == SKIP:
+            px.extend([0] * n)
+        elif op == RUN:
+            px.extend([palette[stream[pos]]] * n)
+            pos += 1
+        else:
+            px.extend(palette[i] for i in stream[pos:pos + n])
+            pos += n
+    return px
+
+
+def convert(width, height, rows):
+    palette = []
+    lookup = {}
+    for row in rows:
+        for c in row:
+            if (c >> 24) != 0 and c not in lookup:
+                lookup[c] = len(palette)
+                palette.append(c)
+    if len(palette) > 256:
+        sys.exit("mkasset: %d colors — at most 256 fit a palette index "
+                 "(flatten or posterize the image first)" % len(palette))
+
+    data = bytearray()
+    offsets = []
+    seen = {}
+    for row in rows:
+        stream = encode_row([lookup[c] if (c >> 24) != 0 else None for c in row])
+        expect = [c if (c >> 24) != 0 else 0 for c in row]
+        assert decode_row(stream, width, palette) == expect
+        if stream not in seen:
+            seen[stream] = len(data)
+            data.extend(stream)
+        offsets.append(seen[stream])
+    return palette, offsets, bytes(data)
+
+
+# ---------------------------------------------------------------------------
+# Output
+# ---------------------------------------------------------------------------
+
+def c_array(ctype, name, values, fmt, per_line):
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append("    " + ", ".join(fmt % v for v in values[i:i + per_line]) + ",")
+    return "static const %s %s[%d] = {\n%s\n};\n" % (
+        ctype, name, len(values), "\n".join(lines))
+
+
+def main():
+    if len(sys.argv) not in (3, 4):
+        sys.exit("usage: mkasset.py <input.png|input.ppm> <output.h> [symbol]")
+    src, dst = sys.argv[1], sys.argv[2]
+    symbol = sys.argv[3] if len(sys.argv) == 4 else \
+        dst.rsplit("/", 1)[-1].split(".")[0].replace("-", "_")
+
+    width, height, rows = load(src)
+    palette, offsets, data = convert(width, height, rows)
+    guard = symbol.upper() + "_ASSET_H"
+    raw = width * height * 4
+    packed = len(data) + 4 * (len(palette) + len(offsets))
+
+    with open(dst, "w") as f:
+        f.write("/*\n * %s — generated by board/mkasset.py from %s. Do not edit.\n"
+                " *\n * %ux%u, %u colors: %u bytes (ARGB8888 would be %u)\n */\n\n"
+                % (dst.rsplit("/", 1)[-1], src.rsplit("/", 1)[-1],
+                   width, height, len(palette), packed, raw))
+        f.write("#ifndef %s\n#define %s\n\n#include \"framebuffer.h\"\n\n" % (guard, guard))
+        f.write(c_array("uint32_t", symbol + "_palette", palette, "0x%08X", 6))
+        f.write("\n")
+        f.write(c_array("uint32_t", symbol + "_rows", offsets, "%u", 10))
+        f.write("\n")
+        f.write(c_array("uint8_t", symbol + "_data", list(data), "0x%02X", 12))
+        f.write("\nstatic const fb_rle_image_t %s = {\n"
+                "    .width   = %u,\n    .height  = %u,\n"
+                "    .palette = %s_palette,\n    .rows    = %s_rows,\n"
+                "    .data    = %s_data,\n};\n\n#endif /* %s */\n"
+                % (symbol, width, height, symbol, symbol, symbol, guard))
+
+    print("mkasset: %s → %s: %ux%u, %u colors, %u → %u bytes"
+          % (src, dst, width, height, len(palette), raw, packed))
+
+
+if __name__ == "__main__":
+    main()
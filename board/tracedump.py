@@ -0,0 +1,187 @@
+#!/usr/bin/env python3
+# =============================================================================
+# board/tracedump.py
+# Decode a trace_dump() capture against the kernel ELF
+#
+# Usage:
+#   python3 board/tracedump.py <kernel.elf> <uart.log> [--raw]
+#
+# Example:
+#   picocom -b 115200 /dev/ttyUSB0 --logfile uart.log     # run, trace_dump()
+#   python3 board/tracedump.py build/milkv-mars/kernel.elf uart.log
+#
+#   [1]     12.345678  +0.000041  present: 37 dirty rows, age 1
+#
+# =============================================================================
+# HOW IT WORKS
+# =============================================================================
+#
+# See kernel/src/trace.h. The target never formats anything: each record
+# holds the ADDRESS of its format string. Every format is a string literal,
+# so it sits in the ELF's .rodata at exactly that address — we read it from
+# the section data, then run the printf here.
+#
+# Everything on the "@..." lines is hex. Other lines in the log (ordinary
+# UART output) are skipped, so the raw session capture works as-is.
+# Records from every core are merged by timestamp; the second column is
+# seconds since the first record, the third the gap to the previous one.
+#
+# Rebuild and the addresses move: decode with the ELF that produced the
+# capture.
+#
+# =============================================================================
+
+import re
+import struct
+import sys
+
+SHT_NOBITS = 8
+SHF_ALLOC = 0x2
+
+CONV = re.compile(r"%([-0]*)(\d*)(ll|l|z)?([diuxXpsc%])")
+
+
+# ---------------------------------------------------------------------------
+# ELF: allocated sections, and strings by address
+# ---------------------------------------------------------------------------
+
+class Image:
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.blob = f.read()
+        if self.blob[:4] != b"\x7fELF":
+            sys.exit("tracedump: %s is not an ELF file" % path)
+
+        self.wide = self.blob[4] == 2
+        order = "<" if self.blob[5] == 1 else ">"
+        if self.wide:
+            shoff, = struct.unpack_from(order + "Q", self.blob, 0x28)
+            shentsize, shnum = struct.unpack_from(order + "HH", self.blob, 0x3A)
+            fmt = order + "IIQQQQ"
+        else:
+            shoff, = struct.unpack_from(order + "I", self.blob, 0x20)
+            shentsize, shnum = struct.unpack_from(order + "HH", self.blob, 0x2E)
+            fmt = order + "IIIIII"
+
+        self.sections = []
+        for i in range(shnum):
+            _, kind, flags, addr, offset, size = struct.unpack_from(
+                fmt, self.blob, shoff + i * shentsize)
+            if flags & SHF_ALLOC and kind != SHT_NOBITS and size:
+                self.sections.append((addr, offset, size))
+
+        self.word_bits = 64 if self.wide else 32
+
+    def string(self, addr):
+        for base, offset, size in self.sections:
+            if base <= addr < base + size:
+                start = offset + (addr - base)
+                end = self.blob.find(b"\0", start, offset + size)
+                if end < 0:
+                    return None
+                return self.blob[start:end].decode("utf-8", "replace")
+        return None
+
+
+# ---------------------------------------------------------------------------
+# printf, the hal_debug_printf() subset
+# ---------------------------------------------------------------------------
+
+def render(image, fmt, args):
+    bits = image.word_bits
+    mask = (1 << bits) - 1
+    args = list(args)
+
+    def conv(m):
+        flags, width, _, kind = m.groups()
+        if kind == "%":
+            return "%"
+        v = args.pop(0) & mask if args else 0
+        if kind in "di":
+            if v >> (bits - 1):
+                v -= 1 << bits
+            text = str(v)
+        elif kind == "u":
+            text = str(v)
+        elif kind == "x":
+            text = "%x" % v
+        elif kind == "X":
+            text = "%X" % v
+        elif kind == "p":
+            text = "0x%x" % v
+        elif kind == "c":
+            text = chr(v & 0xFF)
+        else:
+            s = image.string(v)
+            text = s if s is not None else "<str@0x%x>" % v
+        width = int(width or 0)
+        if "-" in flags:
+            return text.ljust(width)
+        if "0" in flags and kind not in "sc":
+            sign = "-" if text.startswith("-") else ""
+            return sign + text[len(sign):].rjust(width - len(sign), "0")
+        return text.rjust(width)
+
+    return CONV.sub(conv, fmt)
+
+
+# ---------------------------------------------------------------------------
+# Capture parsing
+# ---------------------------------------------------------------------------
+
+def parse(path):
+    records = []
+    written = {}
+    ring = None
+    with open(path, "r", errors="replace") as f:
+        for line in f:
+            fields = line.strip().split()
+            if not fields:
+                continue
+            try:
+                values = [int(v, 16) for v in fields[1:]]
+            except ValueError:
+                continue
+            if fields[0] == "@trace" and len(values) == 2:
+                ring = values[1]
+                records, written = [], {}         # a later dump replaces earlier ones
+            elif fields[0] == "@C" and len(values) == 2:
+                written[values[0]] = values[1]
+            elif fields[0] == "@T" and len(values) >= 3:
+                records.append((values[1], values[0], values[2], values[3:]))
+    if ring is None:
+        sys.exit("tracedump: no @trace header in %s — did trace_dump() run?" % path)
+    return ring, written, records
+
+
+def main():
+    argv = [a for a in sys.argv[1:] if a != "--raw"]
+    raw = "--raw" in sys.argv
+    if len(argv) != 2:
+        sys.exit("usage: tracedump.py <kernel.elf> <uart.log> [--raw]")
+
+    image = Image(argv[0])
+    ring, written, records = parse(argv[1])
+
+    for cpu in sorted(written):
+        lost = written[cpu] - ring
+        if lost > 0:
+            print("# core %u: %u older records overwritten" % (cpu, lost))
+
+    records.sort(key=lambda r: r[0])
+    t0 = records[0][0] if records else 0
+    prev = t0
+    for ts, cpu, fmt_addr, args in records:
+        fmt = image.string(fmt_addr)
+        if fmt is None:
+            text = "<unknown format 0x%x> %s" % (fmt_addr, " ".join("%x" % a for a in args))
+        elif raw:
+            text = "%s  %s" % (fmt, " ".join("%x" % a for a in args))
+        else:
+            text = render(image, fmt, args)
+        print("[%u] %12.6f  +%.6f  %s" % (cpu, (ts - t0) / 1e6, (ts - prev) / 1e6, text))
+        prev = ts
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,93 @@
+/*
+ * common/bitops.h — Bit Scan and Population Count
+ * =================================================
+ *
+ * Header-only. Count-leading-zeros and friends are the backbone of every
+ * O(1) bitmap search in this kernel (TLSF free lists, text run scanning,
+ * the online-CPU mask), so they need to be single instructions where the
+ * hardware has them:
+ *
+ *   ARM64:       clz (rbit + clz for ctz). No scalar popcount: cnt is a
+ *                NEON instruction and we build with -mgeneral-regs-only
+ *   Cortex-M33:  clz (__ARM_FEATURE_CLZ)
+ *   RISC-V:      clz/ctz/cpop — only with the Zbb extension
+ *   x86_64:      bsr/bsf; popcnt only with -mpopcnt (__POPCNT__)
+ *
+ * WHY NOT JUST __builtin_clz() EVERYWHERE?
+ * ----------------------------------------
+ * Without a native instruction GCC emits a call to libgcc's __clzdi2 /
+ * __ctzdi2 / __popcountdi2 — and we link with -nostdlib and no libgcc.
+ * The RV64GC boards (the U74 has no Zbb) would fail to link. So when
+ * __riscv_zbb isn't defined we fall back to a short branch-free-ish
+ * binary search, which still beats a bit-at-a-time loop by a wide margin.
+ *
+ * All functions take a NON-ZERO argument except bit_popcount32().
+ */
+
+#ifndef BITOPS_H
+#define BITOPS_H
+
+#include "types.h"
+
+#if defined(__aarch64__) || defined(__x86_64__) || defined(__riscv_zbb) || \
+    defined(__ARM_FEATURE_CLZ)
+#define BITOPS_HW 1
+#else
+#define BITOPS_HW 0
+#endif
+
+/* Number of leading zero bits, x != 0 */
+static inline uint32_t bit_clz32(uint32_t x)
+{
+#if BITOPS_HW
+    return (uint32_t)__builtin_clz(x);
+#else
+    uint32_t n = 0;
+    if (!(x & 0xFFFF0000u)) { n += 16; x <<= 16; }
+    if (!(x & 0xFF000000u)) { n += 8;  x <<= 8;  }
+    if (!(x & 0xF0000000u)) { n += 4;  x <<= 4;  }
+    if (!(x & 0xC0000000u)) { n += 2;  x <<= 2;  }
+    if (!(x & 0x80000000u)) { n += 1; }
+    return n;
+#endif
+}
+
+/* Number of trailing zero bits, x != 0 */
+static inline uint32_t bit_ctz32(uint32_t x)
+{
+#if BITOPS_HW
+    return (uint32_t)__builtin_ctz(x);
+#else
+    return 31 - bit_clz32(x & (0u - x));    /* Isolate the lowest set bit */
+#endif
+}
+
+static inline uint32_t bit_clz64(uint64_t x)
+{
+#if BITOPS_HW
+    return (uint32_t)__builtin_clzll(x);
+#else
+    uint32_t hi = (uint32_t)(x >> 32);
+    return hi ? bit_clz32(hi) : 32 + bit_clz32((uint32_t)x);
+#endif
+}
+
+/* Index of the highest set bit (floor(log2(x))), x != 0 */
+static inline uint32_t bit_fls64(uint64_t x)
+{
+    return 63 - bit_clz64(x);
+}
+
+static inline uint32_t bit_popcount32(uint32_t x)
+{
+#if defined(__POPCNT__) || defined(__riscv_zbb)
+    return (uint32_t)__builtin_popcount(x);
+#else
+    x = x - ((x >> 1) & 0x55555555u);
+    x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+    x = (x + (x >> 4)) & 0x0F0F0F0Fu;
+    return (x * 0x01010101u) >> 24;
+#endif
+}
+
+#endif /* BITOPS_H */
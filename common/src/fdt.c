@@ -0,0 +1,466 @@
+/*
+ * fdt.c - Indexed Flattened Device Tree
+ * ======================================
+ *
+ * See fdt.h. One pass over the structure block fills the node and
+ * property tables; the compatible and phandle tables are sorted at the
+ * end so both become binary searches.
+ *
+ * BLOB LAYOUT (all big-endian):
+ *
+ *   header        magic, totalsize, off_dt_struct, off_dt_strings, ...
+ *   mem reserve   (unused here)
+ *   structure     BEGIN_NODE "name\0" pad
+ *                   PROP len nameoff value pad
+ *                   ...
+ *                   BEGIN_NODE ... END_NODE       (children, after props)
+ *                 END_NODE
+ *                 END
+ *   strings       "compatible\0reg\0#address-cells\0..."
+ *
+ * Every token and value starts on a 4-byte boundary of the blob.
+ */
+
+#include "fdt.h"
+#include "string.h"
+
+#define FDT_MAGIC       0xD00DFEED
+#define FDT_BEGIN_NODE  0x00000001
+#define FDT_END_NODE    0x00000002
+#define FDT_PROP        0x00000003
+#define FDT_NOP         0x00000004
+#define FDT_END         0x00000009
+
+#define FDT_ALIGN4(x)   (((x) + 3) & ~3u)
+
+/* =============================================================================
+ * INDEX
+ * =============================================================================
+ */
+
+typedef struct {
+    uint32_t name;          /* Blob offset of the node name */
+    int16_t  parent;
+    uint16_t prop_first;
+    uint16_t prop_count;
+    uint8_t  addr_cells;    /* #address-cells for this node's children */
+    uint8_t  size_cells;    /* #size-cells for this node's children */
+    uint32_t phandle;
+} fdt_node_rec_t;
+
+typedef struct {
+    uint32_t hash;          /* fdt_hash() of the name */
+    uint32_t name;          /* Blob offset of the name, in the strings block */
+    uint32_t val;           /* Blob offset of the value */
+    uint32_t len;
+} fdt_prop_rec_t;
+
+/*
+ * Sorted lookup entry. key = value << 32 | node, so entries for the same
+ * hash or phandle sit together in document order, and "the first match
+ * after node N" is a lower bound on value << 32 | (N + 1).
+ */
+typedef struct {
+    uint64_t key;
+    uint32_t str;           /* compat[]: blob offset of the string */
+} fdt_key_t;
+
+static fdt_node_rec_t g_nodes[FDT_MAX_NODES];
+static fdt_prop_rec_t g_props[FDT_MAX_PROPS];
+static fdt_key_t      g_compat[FDT_MAX_COMPAT];
+static fdt_key_t      g_phandles[FDT_MAX_PHANDLES];
+static uint16_t       g_memory[FDT_MAX_MEMORY];
+
+static struct {
+    const uint8_t *blob;
+    bool           ready;
+    uint32_t       nodes;
+    uint32_t       props;
+    uint32_t       compat;
+    uint32_t       phandles;
+    uint32_t       memory;
+} g_fdt;
+
+/* Hashes of the property names the parser itself acts on */
+static uint32_t h_compatible, h_phandle, h_linux_phandle;
+static uint32_t h_address_cells, h_size_cells, h_device_type;
+
+/* =============================================================================
+ * HELPERS
+ * =============================================================================
+ */
+
+static inline uint32_t be32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+           ((uint32_t)p[2] <<  8) | ((uint32_t)p[3]);
+}
+
+/* Up to 64 bits out of `cells` big-endian cells; extra high cells drop off */
+static uint64_t read_cells(const uint8_t *p, uint32_t cells)
+{
+    uint64_t v = 0;
+    for (uint32_t i = 0; i < cells; i++) {
+        v = (v << 32) | be32(p + 4 * i);
+    }
+    return v;
+}
+
+/* FNV-1a, 32-bit */
+static uint32_t fdt_hash(const char *s)
+{
+    uint32_t h = 2166136261u;
+    while (*s) {
+        h ^= (uint8_t)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static inline const char *blob_str(uint32_t off)
+{
+    return (const char *)g_fdt.blob + off;
+}
+
+static inline bool valid_node(int node)
+{
+    return g_fdt.ready && node >= 0 && (uint32_t)node < g_fdt.nodes;
+}
+
+/* Shell sort: a few hundred entries, once, at boot */
+static void sort_keys(fdt_key_t *k, uint32_t n)
+{
+    for (uint32_t gap = n / 2; gap > 0; gap /= 2) {
+        for (uint32_t i = gap; i < n; i++) {
+            fdt_key_t t = k[i];
+            uint32_t  j = i;
+            while (j >= gap && k[j - gap].key > t.key) {
+                k[j] = k[j - gap];
+                j -= gap;
+            }
+            k[j] = t;
+        }
+    }
+}
+
+/* First entry with key >= want */
+static uint32_t lower_bound(const fdt_key_t *k, uint32_t n, uint64_t want)
+{
+    uint32_t lo = 0, hi = n;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (k[mid].key < want) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+/* =============================================================================
+ * THE ONE PASS
+ * =============================================================================
+ */
+
+/* Properties the index itself cares about */
+static bool index_prop(uint32_t node, const fdt_prop_rec_t *pr)
+{
+    fdt_node_rec_t *n   = &g_nodes[node];
+    const uint8_t  *val = g_fdt.blob + pr->val;
+    const char     *name = blob_str(pr->name);
+
+    if (pr->hash == h_compatible && strcmp(name, "compatible") == 0) {
+        uint32_t off = 0;
+        while (off < pr->len) {
+            const char *s  = (const char *)val + off;
+            uint32_t    sl = (uint32_t)strlen(s);
+            if (g_fdt.compat == FDT_MAX_COMPAT) return false;
+            g_compat[g_fdt.compat++] = (fdt_key_t){
+                ((uint64_t)fdt_hash(s) << 32) | node, pr->val + off };
+            off += sl + 1;
+        }
+    } else if (pr->len == 4 &&
+               ((pr->hash == h_phandle && strcmp(name, "phandle") == 0) ||
+                (pr->hash == h_linux_phandle && strcmp(name, "linux,phandle") == 0))) {
+        if (n->phandle) return true;            /* Both present: already have it */
+        if (g_fdt.phandles == FDT_MAX_PHANDLES) return false;
+        n->phandle = be32(val);
+        g_phandles[g_fdt.phandles++] = (fdt_key_t){
+            ((uint64_t)n->phandle << 32) | node, 0 };
+    } else if (pr->len == 4 && pr->hash == h_address_cells &&
+               strcmp(name, "#address-cells") == 0) {
+        n->addr_cells = (uint8_t)be32(val);
+    } else if (pr->len == 4 && pr->hash == h_size_cells &&
+               strcmp(name, "#size-cells") == 0) {
+        n->size_cells = (uint8_t)be32(val);
+    } else if (pr->hash == h_device_type && strcmp(name, "device_type") == 0 &&
+               strcmp((const char *)val, "memory") == 0) {
+        if (g_fdt.memory < FDT_MAX_MEMORY) g_memory[g_fdt.memory++] = (uint16_t)node;
+    }
+    return true;
+}
+
+bool fdt_init(const void *blob)
+{
+    if (g_fdt.ready && g_fdt.blob == blob) return true;
+
+    g_fdt.ready    = false;
+    g_fdt.blob     = (const uint8_t *)blob;
+    g_fdt.nodes    = 0;
+    g_fdt.props    = 0;
+    g_fdt.compat   = 0;
+    g_fdt.phandles = 0;
+    g_fdt.memory   = 0;
+
+    if (!blob || be32(g_fdt.blob) != FDT_MAGIC) return false;
+
+    h_compatible    = fdt_hash("compatible");
+    h_phandle       = fdt_hash("phandle");
+    h_linux_phandle = fdt_hash("linux,phandle");
+    h_address_cells = fdt_hash("#address-cells");
+    h_size_cells    = fdt_hash("#size-cells");
+    h_device_type   = fdt_hash("device_type");
+
+    const uint8_t *b = g_fdt.blob;
+    uint32_t total       = be32(b + 4);
+    uint32_t off_struct  = be32(b + 8);
+    uint32_t off_strings = be32(b + 12);
+    uint32_t version     = be32(b + 20);
+    uint32_t end         = version >= 17 ? off_struct + be32(b + 36) : total;
+
+    if (end > total || off_strings >= total) return false;
+
+    int32_t  stack[FDT_MAX_DEPTH];
+    uint32_t depth = 0;
+    uint32_t p     = off_struct;
+
+    while (p + 4 <= end) {
+        uint32_t token = be32(b + p);
+        p += 4;
+
+        switch (token) {
+        case FDT_BEGIN_NODE: {
+            if (g_fdt.nodes == FDT_MAX_NODES || depth == FDT_MAX_DEPTH) return false;
+
+            uint32_t node = g_fdt.nodes++;
+            g_nodes[node] = (fdt_node_rec_t){
+                .name       = p,
+                .parent     = (int16_t)(depth ? stack[depth - 1] : FDT_NONE),
+                .prop_first = (uint16_t)g_fdt.props,
+                .addr_cells = 2,        /* Defaults from the DT specification */
+                .size_cells = 1,
+            };
+            stack[depth++] = (int32_t)node;
+            p = FDT_ALIGN4(p + (uint32_t)strlen(blob_str(p)) + 1);
+            break;
+        }
+
+        case FDT_END_NODE:
+            if (depth == 0) return false;
+            depth--;
+            break;
+
+        case FDT_PROP: {
+            if (depth == 0 || p + 8 > end) return false;
+
+            uint32_t        node = (uint32_t)stack[depth - 1];
+            fdt_node_rec_t *n    = &g_nodes[node];
+            fdt_prop_rec_t  pr   = {
+                .len  = be32(b + p),
+                .name = off_strings + be32(b + p + 4),
+                .val  = p + 8,
+            };
+            p = FDT_ALIGN4(pr.val + pr.len);
+
+            /* Properties must precede subnodes, or this node's run is broken */
+            if (p > end || pr.name >= total || g_fdt.props == FDT_MAX_PROPS ||
+                n->prop_first + n->prop_count != g_fdt.props) {
+                return false;
+            }
+
+            pr.hash = fdt_hash(blob_str(pr.name));
+            g_props[g_fdt.props++] = pr;
+            n->prop_count++;
+
+            if (!index_prop(node, &pr)) return false;
+            break;
+        }
+
+        case FDT_NOP:
+            break;
+
+        case FDT_END:
+            p = end;
+            break;
+
+        default:
+            return false;
+        }
+    }
+
+    if (depth != 0 || g_fdt.nodes == 0) return false;
+
+    sort_keys(g_compat, g_fdt.compat);
+    sort_keys(g_phandles, g_fdt.phandles);
+    g_fdt.ready = true;
+    return true;
+}
+
+bool fdt_ready(void)
+{
+    return g_fdt.ready;
+}
+
+/* =============================================================================
+ * LOOKUPS
+ * =============================================================================
+ */
+
+uint32_t fdt_node_count(void)
+{
+    return g_fdt.ready ? g_fdt.nodes : 0;
+}
+
+const char *fdt_node_name(int node)
+{
+    return valid_node(node) ? blob_str(g_nodes[node].name) : NULL;
+}
+
+int fdt_parent(int node)
+{
+    return valid_node(node) ? g_nodes[node].parent : FDT_NONE;
+}
+
+static const fdt_prop_rec_t *find_prop(int node, const char *name)
+{
+    if (!valid_node(node)) return NULL;
+
+    const fdt_node_rec_t *n = &g_nodes[node];
+    uint32_t h = fdt_hash(name);
+
+    for (uint32_t i = n->prop_first; i < (uint32_t)n->prop_first + n->prop_count; i++) {
+        if (g_props[i].hash == h && strcmp(blob_str(g_props[i].name), name) == 0) {
+            return &g_props[i];
+        }
+    }
+    return NULL;
+}
+
+const void *fdt_prop(int node, const char *name, uint32_t *len)
+{
+    const fdt_prop_rec_t *pr = find_prop(node, name);
+    if (!pr) return NULL;
+    if (len) *len = pr->len;
+    return g_fdt.blob + pr->val;
+}
+
+bool fdt_prop_u32(int node, const char *name, uint32_t *out)
+{
+    const fdt_prop_rec_t *pr = find_prop(node, name);
+    if (!pr || pr->len != 4) return false;
+    *out = be32(g_fdt.blob + pr->val);
+    return true;
+}
+
+int fdt_find_compatible(const char *compat, int from)
+{
+    if (!g_fdt.ready || !compat) return FDT_NONE;
+    if (from < FDT_NONE) from = FDT_NONE;
+
+    uint64_t hash = fdt_hash(compat);
+    uint32_t i = lower_bound(g_compat, g_fdt.compat, (hash << 32) | (uint32_t)(from + 1));
+
+    for (; i < g_fdt.compat && (g_compat[i].key >> 32) == hash; i++) {
+        if (strcmp(blob_str(g_compat[i].str), compat) == 0) {
+            return (int)(uint32_t)g_compat[i].key;
+        }
+    }
+    return FDT_NONE;
+}
+
+bool fdt_is_compatible(int node, const char *compat)
+{
+    uint32_t    len;
+    const char *list = fdt_prop(node, "compatible", &len);
+    if (!list || !compat) return false;
+
+    for (uint32_t off = 0; off < len; off += (uint32_t)strlen(list + off) + 1) {
+        if (strcmp(list + off, compat) == 0) return true;
+    }
+    return false;
+}
+
+bool fdt_reg(int node, uint32_t i, uint64_t *addr, uint64_t *size)
+{
+    int parent = fdt_parent(node);
+    if (parent == FDT_NONE) return false;
+
+    uint32_t       len;
+    const uint8_t *reg = fdt_prop(node, "reg", &len);
+    if (!reg) return false;
+
+    uint32_t ac    = g_nodes[parent].addr_cells;
+    uint32_t sc    = g_nodes[parent].size_cells;
+    uint32_t entry = 4 * (ac + sc);
+    if (entry == 0 || (i + 1) * entry > len) return false;
+
+    reg += i * entry;
+    if (addr) *addr = read_cells(reg, ac);
+    if (size) *size = read_cells(reg + 4 * ac, sc);
+    return true;
+}
+
+int fdt_node_by_phandle(uint32_t ph)
+{
+    if (!g_fdt.ready || ph == 0) return FDT_NONE;
+
+    uint32_t i = lower_bound(g_phandles, g_fdt.phandles, (uint64_t)ph << 32);
+    if (i < g_fdt.phandles && (g_phandles[i].key >> 32) == ph) {
+        return (int)(uint32_t)g_phandles[i].key;
+    }
+    return FDT_NONE;
+}
+
+bool fdt_clock(int node, uint32_t i, int *provider, uint32_t *id)
+{
+    uint32_t       len;
+    const uint8_t *clk = fdt_prop(node, "clocks", &len);
+    if (!clk) return false;
+
+    /* Variable-length entries: <&provider cell...>, #clock-cells per provider */
+    uint32_t off = 0;
+    for (uint32_t k = 0; off + 4 <= len; k++) {
+        int      prov  = fdt_node_by_phandle(be32(clk + off));
+        uint32_t cells = 0;
+        if (prov == FDT_NONE) return false;
+        fdt_prop_u32(prov, "#clock-cells", &cells);
+
+        if (off + 4 * (1 + cells) > len) return false;
+        if (k == i) {
+            if (provider) *provider = prov;
+            if (id) *id = cells ? be32(clk + off + 4) : 0;
+            return true;
+        }
+        off += 4 * (1 + cells);
+    }
+    return false;
+}
+
+bool fdt_memory(uint32_t i, uint64_t *base, uint64_t *size)
+{
+    if (!g_fdt.ready) return false;
+
+    for (uint32_t m = 0; m < g_fdt.memory; m++) {
+        for (uint32_t r = 0; fdt_reg(g_memory[m], r, NULL, NULL); r++) {
+            if (i-- == 0) return fdt_reg(g_memory[m], r, base, size);
+        }
+    }
+    return false;
+}
+
+uint64_t fdt_memory_total(void)
+{
+    uint64_t total = 0, size;
+    for (uint32_t i = 0; fdt_memory(i, NULL, &size); i++) {
+        total += size;
+    }
+    return total;
+}
@@ -0,0 +1,127 @@
+/*
+ * fdt.h - Indexed Flattened Device Tree
+ * ======================================
+ *
+ * A device tree blob is built for streaming, not for lookups: one long
+ * run of BEGIN_NODE / PROP / END_NODE tokens with the property names in a
+ * separate string table. Asking it "where is the simple-framebuffer
+ * node?" means walking every token from the top and comparing every
+ * property name — and the next driver that asks for a UART, a clock or
+ * the memory node walks it all again.
+ *
+ * fdt_init() walks it ONCE and keeps a small index in .bss:
+ *
+ *   nodes[]      name, parent, its properties, #address-cells /
+ *                #size-cells for its children, phandle
+ *   props[]      FNV-1a hash of the name, value offset, length — a
+ *                node's properties are contiguous, so a lookup is a
+ *                hash compare over a handful of entries
+ *   compat[]     one entry per string of every `compatible` list,
+ *                sorted by hash: binary search
+ *   phandles[]   sorted by phandle: binary search, which is how
+ *                `clocks = <&clkgen 42>` finds the clock controller
+ *   memory[]     the nodes with device_type = "memory"
+ *
+ * Nothing is copied out of the blob: every string and value is read in
+ * place, so the blob must stay where it is (U-Boot leaves it in RAM the
+ * kernel never allocates from). Hashes are always confirmed with a string
+ * compare, so a collision costs a compare, never a wrong answer.
+ *
+ * NODES:
+ * ------
+ * A node is an index, 0 for the root, in the order the blob lists them —
+ * so fdt_find_compatible(c, prev) returns matches in document order.
+ * FDT_NONE means "no node".
+ *
+ * This file is portable C with no hardware access; any SoC that boots
+ * with a DTB (RISC-V through OpenSBI, or ARM64 with a DTB from the
+ * firmware) can use it.
+ */
+
+#ifndef FDT_H
+#define FDT_H
+
+#include "types.h"
+
+#define FDT_NONE            (-1)
+
+#ifndef FDT_MAX_NODES
+#define FDT_MAX_NODES       1024
+#endif
+#ifndef FDT_MAX_PROPS
+#define FDT_MAX_PROPS       8192
+#endif
+#ifndef FDT_MAX_COMPAT
+#define FDT_MAX_COMPAT      1024
+#endif
+#ifndef FDT_MAX_PHANDLES
+#define FDT_MAX_PHANDLES    512
+#endif
+#define FDT_MAX_MEMORY      4
+#define FDT_MAX_DEPTH       16
+
+/*
+ * Index the blob. Returns false if it isn't a DTB or doesn't fit the
+ * index tables; every lookup then reports "not found", so callers keep
+ * their fallbacks. Calling again with the same blob is free.
+ */
+bool fdt_init(const void *blob);
+
+/* True once fdt_init() has indexed a blob */
+bool fdt_ready(void);
+
+/* Nodes indexed; valid node numbers are 0 .. fdt_node_count() - 1 */
+uint32_t fdt_node_count(void);
+
+/* Node name, with its unit address ("framebuffer@fe000000"); "" for root */
+const char *fdt_node_name(int node);
+
+/* Parent node, FDT_NONE for the root */
+int fdt_parent(int node);
+
+/*
+ * First node after `from` whose compatible list contains `compat`.
+ * Pass FDT_NONE to start from the top.
+ */
+int fdt_find_compatible(const char *compat, int from);
+
+/* True if `compat` is one of the node's compatible strings */
+bool fdt_is_compatible(int node, const char *compat);
+
+/*
+ * Raw property value (big-endian cells, or a NUL-terminated string),
+ * or NULL. *len, if given, receives the length in bytes.
+ */
+const void *fdt_prop(int node, const char *name, uint32_t *len);
+
+/* One-cell property. Returns false if missing or not 4 bytes long. */
+bool fdt_prop_u32(int node, const char *name, uint32_t *out);
+
+/*
+ * Entry i of the node's `reg`, decoded with the PARENT's #address-cells
+ * and #size-cells (a size of 0 cells gives *size = 0). Returns false
+ * past the last entry. Addresses are the bus addresses in the blob; no
+ * `ranges` translation is done.
+ */
+bool fdt_reg(int node, uint32_t i, uint64_t *addr, uint64_t *size);
+
+/* Node that declared `phandle = <ph>`, or FDT_NONE */
+int fdt_node_by_phandle(uint32_t ph);
+
+/*
+ * Entry i of the node's `clocks`: the provider node and the first
+ * specifier cell (0 for a provider with #clock-cells = <0>). Returns
+ * false past the last entry or on an unknown phandle.
+ */
+bool fdt_clock(int node, uint32_t i, int *provider, uint32_t *id);
+
+/*
+ * Bank i of physical memory, counting every `reg` entry of every memory
+ * node in order. Returns false past the last bank.
+ */
+bool fdt_memory(uint32_t i, uint64_t *base, uint64_t *size);
+
+/* Sum of every memory bank, 0 without a DTB */
+uint64_t fdt_memory_total(void);
+
+#endif /* FDT_H */
@@ -0,0 +1,84 @@
+/*
+ * common/spinlock.h — Spinlocks and Atomic Helpers
+ * ==================================================
+ *
+ * Header-only. Everything here is built on the GCC __atomic builtins, which
+ * lower to the right instructions for each architecture:
+ *
+ *   ARM64:   ldaxr/stlxr exclusive pairs (ARMv8.0, Cortex-A53)
+ *   RISC-V:  amoswap.w.aq / amoswap.w.rl (A extension, part of RV64GC)
+ *   x86_64:  xchg (implicitly locked)
+ *
+ * ARM64 CAVEAT:
+ * -------------
+ * Exclusive loads/stores only work reliably on Normal CACHEABLE memory.
+ * With SCTLR_EL1.C = 0 the BCM2710 has no global monitor to fall back on
+ * and a stxr can fail forever. That is why the BCM2710 platform turns the
+ * data cache on before it starts the secondary cores (soc_init.c) — and why
+ * nothing here may be used on a Device-mapped address.
+ *
+ * WAITING:
+ * --------
+ * spin_hint() is the polite thing to do inside a busy-wait loop: yield on
+ * ARM64, pause on x86, a plain nop on RISC-V (no Zihintpause on RV64GC).
+ * We deliberately don't use wfe here: on RISC-V HAL_WFE() is wfi, and a
+ * secondary hart with interrupts masked would sleep forever.
+ */
+
+#ifndef SPINLOCK_H
+#define SPINLOCK_H
+
+#include "types.h"
+
+static inline void spin_hint(void)
+{
+#if defined(__aarch64__)
+    __asm__ volatile("yield" ::: "memory");
+#elif defined(__x86_64__)
+    __asm__ volatile("pause" ::: "memory");
+#else
+    __asm__ volatile("nop" ::: "memory");
+#endif
+}
+
+/* =============================================================================
+ * SPINLOCK
+ * =============================================================================
+ *
+ * Test-and-test-and-set: contenders spin on a plain load (which stays in
+ * their own cache) and only retry the atomic swap once the lock looks free.
+ * Not fair, but tiny — this kernel's critical sections are a few dozen
+ * instructions long.
+ */
+
+typedef struct {
+    volatile uint32_t locked;
+} spinlock_t;
+
+#define SPINLOCK_INIT   { 0 }
+
+static inline void spin_lock_init(spinlock_t *l)
+{
+    __atomic_store_n(&l->locked, 0, __ATOMIC_RELAXED);
+}
+
+static inline bool spin_trylock(spinlock_t *l)
+{
+    return __atomic_exchange_n(&l->locked, 1, __ATOMIC_ACQUIRE) == 0;
+}
+
+static inline void spin_lock(spinlock_t *l)
+{
+    while (__atomic_exchange_n(&l->locked, 1, __ATOMIC_ACQUIRE) != 0) {
+        while (__atomic_load_n(&l->locked, __ATOMIC_RELAXED) != 0) {
+            spin_hint();
+        }
+    }
+}
+
+static inline void spin_unlock(spinlock_t *l)
+{
+    __atomic_store_n(&l->locked, 0, __ATOMIC_RELEASE);
+}
+
+#endif /* SPINLOCK_H */
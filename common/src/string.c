@@ -13,12 +13,56 @@
  * The inline versions in types.h work for explicit calls, but the compiler
  * needs actual linkable symbols for its auto-generated calls.
  *
- * These implementations are intentionally simple and unoptimized for clarity.
- * A production OS would use optimized assembly versions.
+ * memset/memcpy/memmove are the hot ones: GCC emits calls to them for every
+ * struct copy and compound-literal initializer, and framebuffer_t alone is
+ * over a kilobyte. They come in two flavours, selected by soc.mk:
+ *
+ *   STRING_ARCH_MEMOPS defined   — the SoC links an assembly version
+ *                                  (boot/arm64/memops.S: NEON + DC ZVA).
+ *                                  The C versions below are compiled out.
+ *   otherwise                    — portable word-wide C: byte head until
+ *                                  the pointers are 8-byte aligned, then
+ *                                  four uint64_t per iteration, byte tail.
+ *                                  Used on RISC-V (U74 has no V extension)
+ *                                  and x86_64.
+ *
+ *   STRING_HAVE_CBO_ZERO defined — large memset(p, 0, n) hands whole
+ *                                  64-byte blocks to zero_dcache_range()
+ *                                  (cbo.zero, boot/riscv64/cache.S). Only
+ *                                  valid on cores with Zicboz (Ky X1).
+ *
+ * The rest of the file stays byte-at-a-time and unoptimized for clarity.
  */
 
 #include "string.h"
 
+/*
+ * GCC recognizes "copy/fill loop" idioms and will happily replace the body
+ * of memset with a call to... memset. -ffreestanding does not stop this, so
+ * the word loops below opt out of that transformation explicitly.
+ */
+#if defined(__GNUC__) && !defined(__clang__)
+#define STRING_NO_LIBCALL   __attribute__((optimize("no-tree-loop-distribute-patterns")))
+#else
+#define STRING_NO_LIBCALL
+#endif
+
+#if !defined(STRING_ARCH_MEMOPS)
+
+/* may_alias: these words overlay arbitrary (struct, byte) objects */
+typedef uint64_t __attribute__((may_alias)) word_t;
+
+#define WORD_SIZE       sizeof(word_t)
+#define WORD_MASK       (WORD_SIZE - 1)
+#define BULK_BYTES      (4 * WORD_SIZE)
+
+#if defined(STRING_HAVE_CBO_ZERO)
+/* boot/riscv64/cache.S — a0 must be 64-byte aligned, a1 a multiple of 64 */
+extern void zero_dcache_range(uintptr_t start, size_t len);
+#define CBO_ZERO_BLOCK  64
+#define CBO_ZERO_MIN    1024
+#endif
+
 /*
  * memset - Fill memory with a byte value
  *
@@ -26,16 +70,56 @@
  *   - Zeroing structs/arrays
  *   - Initializing large local variables
  *
+ * The byte is replicated into all eight lanes of a uint64_t so the bulk
+ * loop writes 32 bytes per iteration with aligned stores.
+ *
  * @param s     Destination pointer
  * @param c     Byte value to fill (only low 8 bits used)
  * @param n     Number of bytes to fill
  * @return      Original destination pointer
  */
+STRING_NO_LIBCALL
 void *memset(void *s, int c, size_t n)
 {
     uint8_t *p = (uint8_t *)s;
+    uint8_t  b = (uint8_t)c;
+
+    if (n >= BULK_BYTES) {
+        while ((uintptr_t)p & WORD_MASK) {
+            *p++ = b;
+            n--;
+        }
+
+#if defined(STRING_HAVE_CBO_ZERO)
+        if (b == 0 && n >= CBO_ZERO_MIN) {
+            while ((uintptr_t)p & (CBO_ZERO_BLOCK - 1)) {
+                *(word_t *)(void *)p = 0;
+                p += WORD_SIZE;
+                n -= WORD_SIZE;
+            }
+            size_t blocks = n & ~(size_t)(CBO_ZERO_BLOCK - 1);
+            zero_dcache_range((uintptr_t)p, blocks);
+            p += blocks;
+            n -= blocks;
+        }
+#endif
+
+        word_t  v = 0x0101010101010101ULL * b;
+        word_t *w = (word_t *)(void *)p;
+        while (n >= BULK_BYTES) {
+            w[0] = v; w[1] = v; w[2] = v; w[3] = v;
+            w += 4;
+            n -= BULK_BYTES;
+        }
+        while (n >= WORD_SIZE) {
+            *w++ = v;
+            n -= WORD_SIZE;
+        }
+        p = (uint8_t *)w;
+    }
+
     while (n--) {
-        *p++ = (uint8_t)c;
+        *p++ = b;
     }
     return s;
 }
@@ -45,6 +129,11 @@ void *memset(void *s, int c, size_t n)
  *
  * GCC uses this for struct assignments and passing large structs by value.
  *
+ * The word path is only taken when dest and src have the same alignment
+ * mod 8 — after the byte head both are then aligned. Mismatched pointers
+ * fall through to the byte loop: RISC-V U74 traps misaligned accesses,
+ * so we never issue one.
+ *
  * WARNING: Source and destination must not overlap!
  *          Use memmove() for overlapping regions.
  *
@@ -53,10 +142,34 @@ void *memset(void *s, int c, size_t n)
  * @param n     Number of bytes to copy
  * @return      Original destination pointer
  */
+STRING_NO_LIBCALL
 void *memcpy(void *dest, const void *src, size_t n)
 {
     uint8_t *d = (uint8_t *)dest;
     const uint8_t *s = (const uint8_t *)src;
+
+    if (n >= BULK_BYTES && (((uintptr_t)d ^ (uintptr_t)s) & WORD_MASK) == 0) {
+        while ((uintptr_t)d & WORD_MASK) {
+            *d++ = *s++;
+            n--;
+        }
+
+        word_t *wd = (word_t *)(void *)d;
+        const word_t *ws = (const word_t *)(const void *)s;
+        while (n >= BULK_BYTES) {
+            word_t a = ws[0], b = ws[1], c = ws[2], e = ws[3];
+            wd[0] = a; wd[1] = b; wd[2] = c; wd[3] = e;
+            wd += 4; ws += 4;
+            n -= BULK_BYTES;
+        }
+        while (n >= WORD_SIZE) {
+            *wd++ = *ws++;
+            n -= WORD_SIZE;
+        }
+        d = (uint8_t *)wd;
+        s = (const uint8_t *)ws;
+    }
+
     while (n--) {
         *d++ = *s++;
     }
@@ -66,35 +179,54 @@ void *memcpy(void *dest, const void *src, size_t n)
 /*
  * memmove - Copy memory (handles overlapping regions)
  *
- * Safer than memcpy but slightly slower. Use when source and
- * destination might overlap.
+ * Forward when dest is below src (or they don't overlap) — that is just
+ * memcpy, which loads each group of words before storing it. Backward
+ * otherwise, with the same word-wide loop run from the top down.
  *
  * @param dest  Destination pointer
  * @param src   Source pointer
  * @param n     Number of bytes to copy
  * @return      Original destination pointer
  */
+STRING_NO_LIBCALL
 void *memmove(void *dest, const void *src, size_t n)
 {
     uint8_t *d = (uint8_t *)dest;
     const uint8_t *s = (const uint8_t *)src;
 
-    if (d < s) {
-        /* Copy forward */
-        while (n--) {
-            *d++ = *s++;
-        }
-    } else if (d > s) {
-        /* Copy backward to handle overlap */
-        d += n;
-        s += n;
-        while (n--) {
+    if ((uintptr_t)d - (uintptr_t)s >= n) {
+        /* dest below src, or no overlap: forward copy is safe */
+        return memcpy(dest, src, n);
+    }
+
+    /* Copy backward to handle overlap */
+    d += n;
+    s += n;
+
+    if (n >= BULK_BYTES && (((uintptr_t)d ^ (uintptr_t)s) & WORD_MASK) == 0) {
+        while ((uintptr_t)d & WORD_MASK) {
             *--d = *--s;
+            n--;
+        }
+
+        word_t *wd = (word_t *)(void *)d;
+        const word_t *ws = (const word_t *)(const void *)s;
+        while (n >= WORD_SIZE) {
+            *--wd = *--ws;
+            n -= WORD_SIZE;
         }
+        d = (uint8_t *)wd;
+        s = (const uint8_t *)ws;
+    }
+
+    while (n--) {
+        *--d = *--s;
     }
     return dest;
 }
 
+#endif /* !STRING_ARCH_MEMOPS */
+
 /*
  * memcmp - Compare memory regions
  *
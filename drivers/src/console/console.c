@@ -0,0 +1,384 @@
+/*
+ * drivers/console/console.c — Framebuffer Text Console
+ *
+ * Tutorial-OS: Console Subsystem
+ *
+ * See console.h. Absolute line numbers count every line ever started;
+ * line L lives in ring[L % hist], and the live view shows lines
+ * top .. top + rows - 1 (minus `back` when scrolled back).
+ */
+
+#include "console.h"
+#include "hal.h"
+#include "../../common/src/string.h"
+#include "../../memory/src/allocator.h"
+
+/* A `shown` cell no real cell equals: forces that cell to be drawn */
+static const con_cell_t CON_UNKNOWN = { 0, 0 };
+
+static const uint32_t con_vga_palette[16] = {
+    0xFF000000, 0xFF0000AA, 0xFF00AA00, 0xFF00AAAA,
+    0xFFAA0000, 0xFFAA00AA, 0xFFAA5500, 0xFFAAAAAA,
+    0xFF555555, 0xFF5555FF, 0xFF55FF55, 0xFF55FFFF,
+    0xFFFF5555, 0xFFFF55FF, 0xFFFFFF55, 0xFFFFFFFF,
+};
+
+static console_t *g_debug_console;
+
+static inline con_cell_t *con_line(const console_t *con, uint32_t line)
+{
+    return con->ring + (size_t)(line % con->hist) * con->cols;
+}
+
+static void con_blank(con_cell_t *cells, uint32_t count, uint8_t attr)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        cells[i].ch   = ' ';
+        cells[i].attr = attr;
+    }
+}
+
+static inline bool con_cell_eq(con_cell_t a, con_cell_t b)
+{
+    return a.ch == b.ch && a.attr == b.attr;
+}
+
+/* =============================================================================
+ * SETUP
+ * =============================================================================
+ */
+
+hal_error_t console_init(console_t *con, framebuffer_t *fb, uint32_t x, uint32_t y,
+                         uint32_t cols, uint32_t rows, uint32_t scrollback, bool large)
+{
+    if (!con || !fb) return HAL_ERROR_NULL_PTR;
+
+    uint32_t cell_h = large ? FB_CHAR_HEIGHT_LG : FB_CHAR_HEIGHT;
+    if (x >= fb->width || y >= fb->height) return HAL_ERROR_INVALID_ARG;
+    if (cols == 0) cols = (fb->width - x) / CON_CELL_W;
+    if (rows == 0) rows = (fb->height - y) / cell_h;
+    if (cols == 0 || rows == 0 || cols > CON_MAX_COLS) return HAL_ERROR_INVALID_ARG;
+
+    memset(con, 0, sizeof(*con));
+    con->fb         = fb;
+    con->x          = x;
+    con->y          = y;
+    con->cols       = cols;
+    con->rows       = rows;
+    con->cell_h     = cell_h;
+    con->text_flags = large ? FB_TEXT_LARGE : 0;
+    con->hist       = rows + scrollback;
+    con->attr       = CON_ATTR_DEFAULT;
+    memcpy(con->palette, con_vga_palette, sizeof(con->palette));
+
+    /* Whole screen, give or take the partial cell at the edges */
+    con->full_screen = x == 0 && y == 0 &&
+                       (cols + 1) * CON_CELL_W > fb->width &&
+                       (rows + 1) * cell_h > fb->height;
+
+    con->ring  = heap_alloc((size_t)con->hist * cols * sizeof(con_cell_t));
+    con->shown = heap_alloc((size_t)rows * cols * sizeof(con_cell_t));
+    if (!con->ring || !con->shown) {
+        heap_free(con->ring);
+        heap_free(con->shown);
+        con->ring = con->shown = NULL;
+        return HAL_ERROR_NO_MEMORY;
+    }
+
+    con_blank(con->ring, con->hist * cols, con->attr);
+    return HAL_SUCCESS;
+}
+
+void console_free(console_t *con)
+{
+    if (!con) return;
+    if (g_debug_console == con) console_attach_debug(NULL, false);
+    heap_free(con->ring);
+    heap_free(con->shown);
+    con->ring = con->shown = NULL;
+}
+
+/* =============================================================================
+ * TEXT IN
+ * =============================================================================
+ */
+
+static void con_newline(console_t *con)
+{
+    con->cx = 0;
+    if (con->cy + 1 < con->rows) {
+        con->cy++;
+        return;
+    }
+    con->top++;
+    con_blank(con_line(con, con->top + con->rows - 1), con->cols, con->attr);
+}
+
+void console_putc(console_t *con, char c)
+{
+    if (!con || !con->ring) return;
+    con->back = 0;
+
+    switch (c) {
+        case '\n':
+            con_newline(con);
+            return;
+        case '\r':
+            con->cx = 0;
+            return;
+        case '\b':
+            if (con->cx > 0) con->cx--;
+            return;
+        case '\t':
+            do console_putc(con, ' '); while (con->cx % 8 != 0);
+            return;
+        default:
+            break;
+    }
+
+    if ((unsigned char)c < 0x20) return;
+    if ((unsigned char)c > 0x7E) c = '?';
+
+    if (con->cx >= con->cols) con_newline(con);
+    con_cell_t *cell = &con_line(con, con->top + con->cy)[con->cx++];
+    cell->ch   = c;
+    cell->attr = con->attr;
+}
+
+void console_write(console_t *con, const char *s, size_t len)
+{
+    if (!s) return;
+    for (size_t i = 0; i < len; i++) console_putc(con, s[i]);
+}
+
+void console_puts(console_t *con, const char *s)
+{
+    if (!s) return;
+    while (*s) console_putc(con, *s++);
+}
+
+void console_set_attr(console_t *con, uint8_t attr)
+{
+    if (con) con->attr = attr;
+}
+
+void console_set_cursor(console_t *con, uint32_t col, uint32_t row)
+{
+    if (!con) return;
+    con->cx = col < con->cols ? col : con->cols - 1;
+    con->cy = row < con->rows ? row : con->rows - 1;
+}
+
+void console_clear(console_t *con)
+{
+    if (!con || !con->ring) return;
+    for (uint32_t r = 0; r < con->rows; r++) {
+        con_blank(con_line(con, con->top + r), con->cols, con->attr);
+    }
+    con->cx = con->cy = 0;
+    con->back = 0;
+}
+
+void console_scrollback(console_t *con, int32_t lines)
+{
+    if (!con) return;
+
+    /* As far back as the ring still holds, and never before line 0 */
+    uint32_t max  = con->hist - con->rows;
+    if (max > con->top) max = con->top;
+
+    int64_t back = (int64_t)con->back + lines;
+    if (back < 0) back = 0;
+    if (back > max) back = max;
+    con->back = (uint32_t)back;
+}
+
+void console_invalidate(console_t *con)
+{
+    if (con) con->shown_valid = false;
+}
+
+/* =============================================================================
+ * DRAWING
+ * =============================================================================
+ */
+
+/*
+ * Move what's on screen by `delta` lines (positive: content goes up, as
+ * when output scrolls) and shift `shown` to match. The exposed lines are
+ * marked unknown, so the cell diff draws them.
+ */
+static void con_scroll_pixels(console_t *con, int32_t delta)
+{
+    framebuffer_t *fb = con->fb;
+    uint32_t n   = (uint32_t)(delta < 0 ? -delta : delta);
+    uint32_t px  = n * con->cell_h;
+    uint32_t w   = con->cols * CON_CELL_W;
+    uint32_t h   = con->rows * con->cell_h;
+    uint32_t bg  = con->palette[CON_ATTR_BG(con->attr)];
+    size_t   row = (size_t)con->cols * sizeof(con_cell_t);
+
+    if (con->full_screen) {
+        fb_scroll_v(fb, delta > 0 ? -(int32_t)px : (int32_t)px, bg);
+        /* Moving down drags the last row into the partial-cell strip */
+        if (delta < 0 && fb->height > con->y + h) {
+            fb_fill_rect(fb, 0, con->y + h, fb->width, fb->height - con->y - h, bg);
+        }
+    } else if (delta > 0) {
+        fb_copy_rect(fb, con->x, con->y + px, con->x, con->y, w, h - px);
+    } else {
+        fb_copy_rect(fb, con->x, con->y, con->x, con->y + px, w, h - px);
+    }
+
+    uint32_t keep = con->rows - n;
+    if (delta > 0) {
+        memmove(con->shown, con->shown + (size_t)n * con->cols, keep * row);
+        for (uint32_t i = keep * con->cols; i < con->rows * con->cols; i++) {
+            con->shown[i] = CON_UNKNOWN;
+        }
+    } else {
+        memmove(con->shown + (size_t)n * con->cols, con->shown, keep * row);
+        for (uint32_t i = 0; i < n * con->cols; i++) con->shown[i] = CON_UNKNOWN;
+    }
+}
+
+/* Cells [c0, c1) of row r, all one attribute, as one text run */
+static void con_draw_run(console_t *con, uint32_t r, const con_cell_t *line,
+                         uint32_t c0, uint32_t c1)
+{
+    char     text[CON_MAX_COLS + 1];
+    uint8_t  attr = line[c0].attr;
+
+    for (uint32_t c = c0; c < c1; c++) text[c - c0] = line[c].ch;
+    text[c1 - c0] = '\0';
+
+    fb_draw_text_run(con->fb, con->x + c0 * CON_CELL_W, con->y + r * con->cell_h, text,
+                     con->palette[CON_ATTR_FG(attr)], con->palette[CON_ATTR_BG(attr)],
+                     1, con->text_flags);
+}
+
+uint32_t console_flush(console_t *con)
+{
+    if (!con || !con->ring) return 0;
+
+    uint32_t want = con->top - con->back;
+
+    if (fb_buffer_age(con->fb) != 1) con->shown_valid = false;
+
+    if (con->shown_valid && want != con->shown_top) {
+        int32_t delta = (int32_t)(want - con->shown_top);
+        if ((uint32_t)(delta < 0 ? -delta : delta) < con->rows) {
+            con_scroll_pixels(con, delta);
+        } else {
+            con->shown_valid = false;
+        }
+    }
+    if (!con->shown_valid) {
+        for (uint32_t i = 0; i < con->rows * con->cols; i++) con->shown[i] = CON_UNKNOWN;
+    }
+    con->shown_top   = want;
+    con->shown_valid = true;
+
+    uint32_t drawn = 0;
+    size_t   bytes = (size_t)con->cols * sizeof(con_cell_t);
+
+    for (uint32_t r = 0; r < con->rows; r++) {
+        const con_cell_t *line  = con_line(con, want + r);
+        con_cell_t       *shown = con->shown + (size_t)r * con->cols;
+
+        if (memcmp(line, shown, bytes) == 0) continue;
+
+        uint32_t c = 0;
+        while (c < con->cols) {
+            if (con_cell_eq(line[c], shown[c])) { c++; continue; }
+
+            uint32_t end = c + 1;
+            while (end < con->cols && line[end].attr == line[c].attr &&
+                   !con_cell_eq(line[end], shown[end])) {
+                end++;
+            }
+            con_draw_run(con, r, line, c, end);
+            drawn += end - c;
+            c = end;
+        }
+        memcpy(shown, line, bytes);
+    }
+    return drawn;
+}
+
+/* =============================================================================
+ * DEBUG SINK
+ * =============================================================================
+ */
+
+/*
+ * The sink runs wherever hal_debug_* was called — any core, IRQs masked,
+ * maybe inside a handler — so all it does is copy into a ring. Producers
+ * are already serialised by hal_debug's lock; the one consumer is
+ * console_debug_flush() on the frame loop's core. Free-running indices,
+ * so head - tail is the fill level even after they wrap.
+ */
+#define CON_DEBUG_RING      4096u   /* Power of two */
+
+static char     g_debug_ring[CON_DEBUG_RING];
+static uint32_t g_debug_head;       /* Advanced by the sink */
+static uint32_t g_debug_tail;       /* Advanced by console_debug_flush() */
+static uint32_t g_debug_dropped;    /* Bytes that found the ring full */
+
+static void con_debug_sink(void *ctx, const char *s, size_t len)
+{
+    (void)ctx;
+
+    uint32_t head = g_debug_head;
+    uint32_t room = CON_DEBUG_RING - (head - __atomic_load_n(&g_debug_tail, __ATOMIC_ACQUIRE));
+
+    if (len > room) {
+        __atomic_fetch_add(&g_debug_dropped, (uint32_t)(len - room), __ATOMIC_RELAXED);
+        len = room;
+    }
+    for (size_t i = 0; i < len; i++) {
+        g_debug_ring[(head + i) & (CON_DEBUG_RING - 1)] = s[i];
+    }
+    __atomic_store_n(&g_debug_head, head + (uint32_t)len, __ATOMIC_RELEASE);
+}
+
+void console_attach_debug(console_t *con, bool present)
+{
+    if (con) con->present = present;
+
+    /* Whatever an old console never drew is not the new one's to show */
+    hal_debug_set_sink(NULL, NULL);
+    __atomic_store_n(&g_debug_tail, __atomic_load_n(&g_debug_head, __ATOMIC_ACQUIRE),
+                     __ATOMIC_RELEASE);
+    __atomic_store_n(&g_debug_dropped, 0, __ATOMIC_RELAXED);
+
+    g_debug_console = con;
+    if (con) hal_debug_set_sink(con_debug_sink, NULL);
+}
+
+uint32_t console_debug_flush(void)
+{
+    console_t *con = g_debug_console;
+    if (!con) return 0;
+
+    uint32_t tail = g_debug_tail;
+    uint32_t head = __atomic_load_n(&g_debug_head, __ATOMIC_ACQUIRE);
+    if (head == tail) return 0;
+
+    while (tail != head) {
+        uint32_t at = tail & (CON_DEBUG_RING - 1);
+        uint32_t n  = head - tail;
+        if (n > CON_DEBUG_RING - at) n = CON_DEBUG_RING - at;
+        console_write(con, g_debug_ring + at, n);
+        tail += n;
+    }
+    __atomic_store_n(&g_debug_tail, tail, __ATOMIC_RELEASE);
+
+    if (__atomic_exchange_n(&g_debug_dropped, 0, __ATOMIC_RELAXED) != 0) {
+        console_puts(con, "\n[debug output dropped]\n");
+    }
+
+    uint32_t drawn = console_flush(con);
+    if (con->present) fb_present(con->fb);
+    return drawn;
+}
@@ -0,0 +1,168 @@
+/*
+ * drivers/console/console.h — Framebuffer Text Console
+ * =====================================================
+ *
+ * A cols × rows grid of character cells on top of a framebuffer_t, with a
+ * scrollback ring in heap memory. Until now diagnostics only went to UART
+ * breadcrumbs and on-screen text was free-positioned fb_draw_string()
+ * calls; this gives the kernel a terminal to log into.
+ *
+ * CELLS, NOT PIXELS:
+ * ==================
+ * Writing to the console never touches the framebuffer. It only updates
+ * cells — one char plus one attribute byte (16-color fg and bg) — in the
+ * ring. console_flush() is what draws, and it only draws what changed:
+ *
+ *   ring (hist lines)          shown (rows lines)        framebuffer
+ *   ┌──────────────┐           ┌──────────────┐          ┌────────────┐
+ *   │ old lines    │  scroll   │ what the fb  │  diff →  │            │
+ *   │ ...          │ ───────▶  │ holds, cell  │  runs of │  glyphs    │
+ *   │ visible rows │  compare  │ for cell     │  changed │            │
+ *   └──────────────┘           └──────────────┘  cells   └────────────┘
+ *
+ * Every row is compared against the copy of what is on screen; each run
+ * of changed cells with one attribute goes out as a single
+ * fb_draw_text_run() call, which copies pre-rendered glyph scanlines
+ * from its cache. Printing one line into a full screen redraws that line.
+ *
+ * SCROLLING:
+ * ==========
+ * When output pushes the view up by n lines, flush moves the pixels
+ * instead of redrawing n × cols cells: fb_scroll_v() for a console that
+ * fills the screen (a scan-out offset change with fb_set_scroll_ring()),
+ * fb_copy_rect() for one in a window. Only the n exposed lines are then
+ * drawn. console_scrollback() moves the view through the ring the same
+ * way.
+ *
+ * DOUBLE BUFFERING:
+ * =================
+ * Both tricks assume the buffer being drawn still holds the last flush,
+ * i.e. fb_buffer_age() == 1: single-buffered scan-out, the scroll ring,
+ * or copy-forward. Any other age makes flush redraw every cell — still
+ * correct, just not cheap.
+ *
+ * LOGGING:
+ * ========
+ * console_attach_debug() makes the console the hal_debug_* sink, so
+ * hal_debug_printf() lands on screen as well as on the UART. Logging can
+ * come from any core or an IRQ handler, where drawing isn't safe, so the
+ * sink only queues the text; the frame loop calls console_debug_flush()
+ * to draw it.
+ */
+
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include "hal_types.h"
+#include "framebuffer.h"
+
+/* Cell width is always the 8-pixel font; rows are 8 or 16 (large) tall */
+#define CON_CELL_W          FB_CHAR_WIDTH
+#define CON_MAX_COLS        256
+
+/* Attribute byte: background in the high nibble, foreground in the low */
+#define CON_ATTR(fg, bg)    ((uint8_t)((((bg) & 0xF) << 4) | ((fg) & 0xF)))
+#define CON_ATTR_FG(a)      ((a) & 0xF)
+#define CON_ATTR_BG(a)      ((a) >> 4)
+
+/* The 16 palette slots, VGA order */
+enum {
+    CON_BLACK, CON_BLUE, CON_GREEN, CON_CYAN,
+    CON_RED, CON_MAGENTA, CON_BROWN, CON_LIGHT_GRAY,
+    CON_DARK_GRAY, CON_LIGHT_BLUE, CON_LIGHT_GREEN, CON_LIGHT_CYAN,
+    CON_LIGHT_RED, CON_LIGHT_MAGENTA, CON_YELLOW, CON_WHITE,
+};
+
+#define CON_ATTR_DEFAULT    CON_ATTR(CON_LIGHT_GRAY, CON_BLACK)
+
+typedef struct {
+    char    ch;                     /* Printable ASCII; 0 only in `shown` */
+    uint8_t attr;
+} con_cell_t;
+
+typedef struct {
+    framebuffer_t *fb;
+    uint32_t    x, y;               /* Pixel origin of cell (0, 0) */
+    uint32_t    cols, rows;
+    uint32_t    cell_h;             /* 8, or 16 with the large font */
+    uint32_t    text_flags;         /* 0 or FB_TEXT_LARGE */
+    bool        full_screen;        /* Scroll with fb_scroll_v() */
+
+    /* Content: `hist` lines of `cols` cells, indexed by absolute line % hist */
+    con_cell_t *ring;
+    uint32_t    hist;
+    uint32_t    top;                /* Absolute line at row 0 of the live view */
+    uint32_t    back;               /* Lines the view is scrolled back */
+    uint32_t    cx, cy;             /* Cursor, in live-view cells */
+    uint8_t     attr;               /* For the next characters written */
+
+    /* What the framebuffer holds: rows × cols, as of the last flush */
+    con_cell_t *shown;
+    uint32_t    shown_top;
+    bool        shown_valid;
+
+    uint32_t    palette[16];        /* ARGB8888 */
+
+    bool        present;            /* console_debug_flush() presents too */
+} console_t;
+
+/*
+ * Set up a console at pixel (x, y). cols / rows of 0 take whatever fits
+ * the rest of the screen; scrollback is the number of extra lines kept in
+ * the ring. large picks the 8×16 font.
+ *
+ * @return  HAL_SUCCESS, HAL_ERROR_NULL_PTR, HAL_ERROR_INVALID_ARG (no room
+ *          for one cell, or more than CON_MAX_COLS), HAL_ERROR_NO_MEMORY
+ */
+hal_error_t console_init(console_t *con, framebuffer_t *fb, uint32_t x, uint32_t y,
+                         uint32_t cols, uint32_t rows, uint32_t scrollback, bool large);
+
+/* Detach from the debug sink if attached, and free the ring */
+void console_free(console_t *con);
+
+/*
+ * Text in. Handles '\n', '\r', '\t' (8 columns), '\b'; other control bytes
+ * are dropped and anything outside printable ASCII becomes '?'. Writing
+ * snaps a scrolled-back view to the live one. Nothing is drawn until
+ * console_flush().
+ */
+void console_putc(console_t *con, char c);
+void console_write(console_t *con, const char *s, size_t len);
+void console_puts(console_t *con, const char *s);
+
+void console_set_attr(console_t *con, uint8_t attr);
+void console_set_cursor(console_t *con, uint32_t col, uint32_t row);
+
+/* Blank the live view in the current attribute and home the cursor */
+void console_clear(console_t *con);
+
+/* Move the view `lines` further back into the ring (negative: forward) */
+void console_scrollback(console_t *con, int32_t lines);
+
+/*
+ * Draw whatever changed since the last flush. Does not present.
+ *
+ * @return  Cells drawn
+ */
+uint32_t console_flush(console_t *con);
+
+/* Forget what is on screen: the next flush draws every cell */
+void console_invalidate(console_t *con);
+
+/*
+ * Become the hal_debug sink: every hal_debug_puts/printf is queued for
+ * console_debug_flush(). Text queued for a previous console is dropped.
+ * NULL detaches.
+ */
+void console_attach_debug(console_t *con, bool present);
+
+/*
+ * Write the queued debug text into the attached console and flush it,
+ * then — if it was attached with present — fb_present(). Call from the
+ * frame loop, on the core that draws; a no-op when nothing is queued.
+ *
+ * @return  Cells drawn
+ */
+uint32_t console_debug_flush(void);
+
+#endif /* CONSOLE_H */
@@ -0,0 +1,74 @@
+/*
+ * drivers/framebuffer/fb_format.c — Per-Format Raster Operations
+ *
+ * Tutorial-OS: Framebuffer Pixel Abstraction
+ *
+ * Instantiates fb_format_tmpl.h once per storage format built in, and
+ * maps fb->pixel_format to the resulting table. See fb_format.h.
+ */
+
+#include "fb_format.h"
+#include "fb_pixel.h"
+#include "fb_span.h"
+#include "../../common/src/string.h"
+
+/* =============================================================================
+ * 32-BIT (ARGB8888 / ABGR8888)
+ * =============================================================================
+ */
+
+#if FB_HAVE_XRGB32
+#define FMT_NAME            xrgb32
+#define FMT_PIXEL           uint32_t
+#define FMT_PACK(c)         (c)
+#define FMT_UNPACK(p)       (p)
+#define FMT_FILL(d, c, n)   fb_span_fill32((d), (c), (n))
+#define FMT_BLEND(d, c, n)  fb_span_blend32((d), (c), (n))
+#define FMT_COPY(d, s, n)   memcpy((d), (s), (size_t)(n) * 4)
+#define FMT_STREAM(d, c, n) fb_span_stream32((d), (c), (n))
+#define FMT_STREAM_COPY(d, s, n) fb_span_stream_copy32((d), (s), (n))
+#include "fb_format_tmpl.h"
+#endif
+
+/* =============================================================================
+ * RGB565 (RP2350 SHADOW BUFFER)
+ * =============================================================================
+ */
+
+#if FB_HAVE_RGB565
+#define FMT_NAME            rgb565
+#define FMT_PIXEL           uint16_t
+#define FMT_PACK(c)         fb_argb_to_565(c)
+#define FMT_UNPACK(p)       fb_565_to_argb(p)
+#define FMT_FILL(d, c, n)   fb_span_fill16((d), fb_argb_to_565(c), (n))
+#define FMT_BLEND(d, c, n)  fb_span_blend16((d), (c), (n))
+#include "fb_format_tmpl.h"
+#endif
+
+/* =============================================================================
+ * BINDING
+ * =============================================================================
+ */
+
+const fb_pixel_ops_t *fb_format_ops(fb_pixel_format_t format)
+{
+    switch (format) {
+#if FB_HAVE_XRGB32
+        case FB_FORMAT_ARGB8888:
+        case FB_FORMAT_ABGR8888:
+            return &fb_ops_xrgb32;
+#endif
+#if FB_HAVE_RGB565
+        case FB_FORMAT_RGB565:
+            return &fb_ops_rgb565;
+#endif
+        default:
+            return NULL;
+    }
+}
+
+bool fb_format_bind(framebuffer_t *fb)
+{
+    fb->ops = fb_format_ops(fb->pixel_format);
+    return fb->ops != NULL;
+}
@@ -0,0 +1,153 @@
+/*
+ * drivers/framebuffer/fb_format.h — Per-Format Raster Operations
+ *
+ * Tutorial-OS: Framebuffer Pixel Abstraction
+ *
+ * WHY THIS EXISTS:
+ * ================
+ *
+ * fb_pixel.h made every primitive format-aware by asking, per pixel,
+ * "is this RGB565?". That is one compare and branch inside every inner
+ * loop — cheap when predicted, but it also stops the compiler from
+ * unrolling or vectorising a blit row, because the loop body isn't one
+ * straight-line store.
+ *
+ * This header moves the question out of the loop. Each storage format
+ * gets its own copy of the raster core — write/read a pixel, fill or
+ * blend a span, walk a column, blit a row — generated at compile time
+ * from one template (fb_format_tmpl.h). fb_init picks the copy once, by
+ * storing a pointer to its ops table in fb->ops:
+ *
+ *     fb_init ──► fb_format_bind(fb) ──► fb->ops = &fb_ops_rgb565
+ *
+ *     fb_fill_rect(...)
+ *         for each row:  fb->ops->fill_span(row, x, w, color)
+ *                              │
+ *                              └── no format test past this point
+ *
+ * The indirect call is paid once per span or row, never per pixel.
+ *
+ * FORMATS:
+ * ========
+ *
+ *   fb_ops_xrgb32  32-bit pixels, stored as drawn. Serves ARGB8888 and
+ *                  ABGR8888 alike: drawing is always ARGB, and the R/B
+ *                  swap for ABGR scan-out is the display driver's job.
+ *   fb_ops_rgb565  16-bit RP2350 shadow buffer, converted on store and
+ *                  expanded on load. The ILI9488's RGB666 is a wire
+ *                  format produced at present time, not a storage one.
+ *
+ * COMPILING FORMATS OUT:
+ * ======================
+ *
+ * FB_HAVE_XRGB32 and FB_HAVE_RGB565 default to 1. A board whose panel
+ * only ever uses one format sets the other to 0 in its soc.mk/board.mk:
+ * that copy of the raster core is never built, fb_format_bind() refuses
+ * the format, and fb_ops() returns the remaining table as a constant.
+ */
+
+#ifndef FB_FORMAT_H
+#define FB_FORMAT_H
+
+#include "framebuffer.h"
+
+#ifndef FB_HAVE_XRGB32
+#define FB_HAVE_XRGB32      1
+#endif
+
+#ifndef FB_HAVE_RGB565
+#define FB_HAVE_RGB565      1
+#endif
+
+#if !FB_HAVE_XRGB32 && !FB_HAVE_RGB565
+#error "fb_format.h: at least one of FB_HAVE_XRGB32 / FB_HAVE_RGB565 must be 1"
+#endif
+
+/* Entries in blit_row[], one per fb_blend_mode_t */
+#define FB_BLEND_MODES      4
+
+/*
+ * The raster core for one storage format. Every entry takes a row pointer
+ * (fb_row()) and a starting column, like fb_write_px(); colors in and out
+ * are always ARGB8888. Nothing here clips, records or marks dirty — the
+ * primitives in framebuffer.c do that before calling in.
+ */
+struct fb_pixel_ops {
+    uint32_t bpp;                   /* Bytes per stored pixel */
+
+    void     (*write_px)(uint8_t *row, uint32_t x, uint32_t color);
+    uint32_t (*read_px)(const uint8_t *row, uint32_t x);
+
+    /* `count` pixels from column x: solid, or src-over one color */
+    void     (*fill_span)(uint8_t *row, uint32_t x, uint32_t count, uint32_t color);
+    void     (*blend_span)(uint8_t *row, uint32_t x, uint32_t count, uint32_t color);
+
+    /* fill_span with non-temporal stores, for spans past the stream size */
+    void     (*stream_span)(uint8_t *row, uint32_t x, uint32_t count, uint32_t color);
+
+    /* `count` pixels down column x, `pitch` bytes apart */
+    void     (*fill_col)(uint8_t *row, uint32_t pitch, uint32_t x,
+                         uint32_t count, uint32_t color);
+
+    /*
+     * Horizontal gradient: pixel px gets lerp(c1, c2, t) with t measured
+     * from `origin` over `extent` pixels, so a clipped span keeps the
+     * colors of the unclipped one.
+     */
+    void     (*lerp_span)(uint8_t *row, uint32_t x, uint32_t count,
+                          uint32_t c1, uint32_t c2,
+                          uint32_t origin, uint32_t extent);
+
+    /*
+     * `count` ARGB8888 source texels onto the row from column x, one
+     * function per blend mode (indexed by fb_blend_mode_t). The alpha
+     * row skips fully transparent texels without touching the row.
+     */
+    void     (*blit_row[FB_BLEND_MODES])(uint8_t *row, uint32_t x,
+                                         const uint32_t *src, uint32_t count);
+
+    /* FB_BLEND_ALPHA for an FB_BITMAP_PREMULTIPLIED source */
+    void     (*blit_row_premul)(uint8_t *row, uint32_t x,
+                                const uint32_t *src, uint32_t count);
+
+    /* Nearest-neighbour: pixel i gets src[(src_x + i) / scale] */
+    void     (*blit_row_scaled)(uint8_t *row, uint32_t x, const uint32_t *src,
+                                uint32_t src_x, uint32_t scale, uint32_t count);
+
+    /* blit_row[FB_BLEND_OPAQUE] with non-temporal stores */
+    void     (*stream_row)(uint8_t *row, uint32_t x, const uint32_t *src, uint32_t count);
+};
+
+#if FB_HAVE_XRGB32
+extern const fb_pixel_ops_t fb_ops_xrgb32;
+#endif
+#if FB_HAVE_RGB565
+extern const fb_pixel_ops_t fb_ops_rgb565;
+#endif
+
+/* The table for `format`, or NULL if it was compiled out */
+const fb_pixel_ops_t *fb_format_ops(fb_pixel_format_t format);
+
+/*
+ * Point fb->ops at the table for fb->pixel_format. Every fb_init path
+ * calls this once the format is known; code that assembles a
+ * framebuffer_t by hand must too. Returns false if the format isn't
+ * built in.
+ */
+bool fb_format_bind(framebuffer_t *fb);
+
+/* The bound table — a compile-time constant when only one format is built */
+static inline const fb_pixel_ops_t *fb_ops(const framebuffer_t *fb)
+{
+#if FB_HAVE_XRGB32 && !FB_HAVE_RGB565
+    (void)fb;
+    return &fb_ops_xrgb32;
+#elif FB_HAVE_RGB565 && !FB_HAVE_XRGB32
+    (void)fb;
+    return &fb_ops_rgb565;
+#else
+    return fb->ops;
+#endif
+}
+
+#endif /* FB_FORMAT_H */
@@ -0,0 +1,217 @@
+/*
+ * drivers/framebuffer/fb_format_tmpl.h — Raster Core Template
+ *
+ * Tutorial-OS: Framebuffer Pixel Abstraction
+ *
+ * NOT a normal header: fb_format.c includes it once per storage format,
+ * each time with these defined, and gets one complete raster core out:
+ *
+ *   FMT_NAME           Suffix for the generated names (xrgb32, rgb565)
+ *   FMT_PIXEL          Storage type of one pixel
+ *   FMT_PACK(argb)     ARGB8888 → FMT_PIXEL
+ *   FMT_UNPACK(px)     FMT_PIXEL → ARGB8888
+ *   FMT_FILL(d, c, n)  Solid span kernel (fb_span.h), c still ARGB8888
+ *   FMT_BLEND(d, c, n) Src-over span kernel (fb_span.h)
+ *   FMT_COPY(d, s, n)  Optional: n ARGB8888 texels stored as-is (memcpy),
+ *                      for formats where FMT_PACK is the identity
+ *   FMT_STREAM(d, c, n)       Optional: FMT_FILL with non-temporal stores
+ *   FMT_STREAM_COPY(d, s, n)  Optional: FMT_COPY with non-temporal stores
+ *                      Without them the stream ops are the ordinary ones.
+ *
+ * Every loop below has the format baked in as a constant: the pack is a
+ * shift-and-mask (or nothing at all), the pointer steps by sizeof the real
+ * pixel, and the compiler is free to unroll and vectorise. The result is
+ * the table fb_ops_<FMT_NAME>. All parameter macros are #undef'd at the
+ * end, ready for the next format.
+ */
+
+#define FMT_CAT_(a, b)      a##b
+#define FMT_CAT(a, b)       FMT_CAT_(a, b)
+#define FMT_FN(op)          FMT_CAT(FMT_CAT(fmt_, FMT_NAME), FMT_CAT(_, op))
+
+static void FMT_FN(write_px)(uint8_t *row, uint32_t x, uint32_t color)
+{
+    ((FMT_PIXEL *)(void *)row)[x] = FMT_PACK(color);
+}
+
+static uint32_t FMT_FN(read_px)(const uint8_t *row, uint32_t x)
+{
+    return FMT_UNPACK(((const FMT_PIXEL *)(const void *)row)[x]);
+}
+
+static void FMT_FN(fill_span)(uint8_t *row, uint32_t x, uint32_t count, uint32_t color)
+{
+    FMT_FILL((FMT_PIXEL *)(void *)row + x, color, count);
+}
+
+static void FMT_FN(blend_span)(uint8_t *row, uint32_t x, uint32_t count, uint32_t color)
+{
+    FMT_BLEND((FMT_PIXEL *)(void *)row + x, color, count);
+}
+
+static void FMT_FN(stream_span)(uint8_t *row, uint32_t x, uint32_t count, uint32_t color)
+{
+#ifdef FMT_STREAM
+    FMT_STREAM((FMT_PIXEL *)(void *)row + x, color, count);
+#else
+    FMT_FILL((FMT_PIXEL *)(void *)row + x, color, count);
+#endif
+}
+
+static void FMT_FN(fill_col)(uint8_t *row, uint32_t pitch, uint32_t x,
+                             uint32_t count, uint32_t color)
+{
+    FMT_PIXEL v = FMT_PACK(color);
+    uint8_t  *p = row + (size_t)x * sizeof(FMT_PIXEL);
+
+    for (uint32_t i = 0; i < count; i++, p += pitch) {
+        *(FMT_PIXEL *)(void *)p = v;
+    }
+}
+
+static void FMT_FN(lerp_span)(uint8_t *row, uint32_t x, uint32_t count,
+                              uint32_t c1, uint32_t c2,
+                              uint32_t origin, uint32_t extent)
+{
+    FMT_PIXEL *d = (FMT_PIXEL *)(void *)row + x;
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t col = x + i - origin;
+        uint8_t  t   = (extent > 1) ? (col * 255) / (extent - 1) : 0;
+        d[i] = FMT_PACK(fb_color_lerp(c1, c2, t));
+    }
+}
+
+/* A run of texels that replace the destination outright */
+static inline void FMT_FN(copy_run)(FMT_PIXEL *d, const uint32_t *src, uint32_t count)
+{
+#ifdef FMT_COPY
+    FMT_COPY(d, src, count);
+#else
+    for (uint32_t i = 0; i < count; i++) d[i] = FMT_PACK(src[i]);
+#endif
+}
+
+static void FMT_FN(blit_opaque)(uint8_t *row, uint32_t x, const uint32_t *src,
+                                uint32_t count)
+{
+    FMT_FN(copy_run)((FMT_PIXEL *)(void *)row + x, src, count);
+}
+
+static void FMT_FN(stream_row)(uint8_t *row, uint32_t x, const uint32_t *src,
+                               uint32_t count)
+{
+#ifdef FMT_STREAM_COPY
+    FMT_STREAM_COPY((FMT_PIXEL *)(void *)row + x, src, count);
+#else
+    FMT_FN(copy_run)((FMT_PIXEL *)(void *)row + x, src, count);
+#endif
+}
+
+/*
+ * Alpha rows: sprites are mostly fully opaque or fully transparent
+ * texels with a blended edge. Opaque runs go out as one copy, transparent
+ * ones are skipped, and only the edge pays for a read-modify-write.
+ */
+#define FMT_ALPHA_ROW(blend)                                            \
+    FMT_PIXEL *d = (FMT_PIXEL *)(void *)row + x;                       \
+    uint32_t   i = 0;                                                   \
+                                                                        \
+    while (i < count) {                                                 \
+        uint32_t sa = FB_ALPHA(src[i]);                                 \
+        if (sa == 255) {                                                \
+            uint32_t run = i + 1;                                       \
+            while (run < count && FB_ALPHA(src[run]) == 255) run++;     \
+            FMT_FN(copy_run)(d + i, src + i, run - i);                  \
+            i = run;                                                    \
+            continue;                                                   \
+        }                                                               \
+        if (sa != 0) d[i] = FMT_PACK(blend(src[i], FMT_UNPACK(d[i])));  \
+        i++;                                                            \
+    }
+
+static void FMT_FN(blit_alpha)(uint8_t *row, uint32_t x, const uint32_t *src,
+                               uint32_t count)
+{
+    FMT_ALPHA_ROW(fb_blend_alpha)
+}
+
+static void FMT_FN(blit_premul)(uint8_t *row, uint32_t x, const uint32_t *src,
+                                uint32_t count)
+{
+    FMT_ALPHA_ROW(fb_blend_premul)
+}
+
+#undef FMT_ALPHA_ROW
+
+static void FMT_FN(blit_additive)(uint8_t *row, uint32_t x, const uint32_t *src,
+                                  uint32_t count)
+{
+    FMT_PIXEL *d = (FMT_PIXEL *)(void *)row + x;
+    for (uint32_t i = 0; i < count; i++) {
+        d[i] = FMT_PACK(fb_blend_additive(src[i], FMT_UNPACK(d[i])));
+    }
+}
+
+static void FMT_FN(blit_multiply)(uint8_t *row, uint32_t x, const uint32_t *src,
+                                  uint32_t count)
+{
+    FMT_PIXEL *d = (FMT_PIXEL *)(void *)row + x;
+    for (uint32_t i = 0; i < count; i++) {
+        d[i] = FMT_PACK(fb_blend_multiply(src[i], FMT_UNPACK(d[i])));
+    }
+}
+
+/*
+ * One divide per row, not per pixel: each texel is packed once and
+ * stored `scale` times, the first texel only for what's left of its
+ * phase after clipping.
+ */
+static void FMT_FN(blit_row_scaled)(uint8_t *row, uint32_t x, const uint32_t *src,
+                                    uint32_t src_x, uint32_t scale, uint32_t count)
+{
+    FMT_PIXEL      *d   = (FMT_PIXEL *)(void *)row + x;
+    FMT_PIXEL      *end = d + count;
+    const uint32_t *s   = src + src_x / scale;
+    uint32_t        rep = scale - src_x % scale;
+
+    while (d < end) {
+        FMT_PIXEL v = FMT_PACK(*s++);
+        if (rep > (uint32_t)(end - d)) rep = (uint32_t)(end - d);
+        for (uint32_t k = 0; k < rep; k++) *d++ = v;
+        rep = scale;
+    }
+}
+
+const fb_pixel_ops_t FMT_CAT(fb_ops_, FMT_NAME) = {
+    .bpp             = sizeof(FMT_PIXEL),
+    .write_px        = FMT_FN(write_px),
+    .read_px         = FMT_FN(read_px),
+    .fill_span       = FMT_FN(fill_span),
+    .blend_span      = FMT_FN(blend_span),
+    .stream_span     = FMT_FN(stream_span),
+    .fill_col        = FMT_FN(fill_col),
+    .lerp_span       = FMT_FN(lerp_span),
+    .blit_row        = {
+        [FB_BLEND_OPAQUE]   = FMT_FN(blit_opaque),
+        [FB_BLEND_ALPHA]    = FMT_FN(blit_alpha),
+        [FB_BLEND_ADDITIVE] = FMT_FN(blit_additive),
+        [FB_BLEND_MULTIPLY] = FMT_FN(blit_multiply),
+    },
+    .blit_row_premul = FMT_FN(blit_premul),
+    .blit_row_scaled = FMT_FN(blit_row_scaled),
+    .stream_row      = FMT_FN(stream_row),
+};
+
+#undef FMT_FN
+#undef FMT_CAT
+#undef FMT_CAT_
+#undef FMT_NAME
+#undef FMT_PIXEL
+#undef FMT_PACK
+#undef FMT_UNPACK
+#undef FMT_FILL
+#undef FMT_BLEND
+#undef FMT_COPY
+#undef FMT_STREAM
+#undef FMT_STREAM_COPY
@@ -0,0 +1,300 @@
+/*
+ * fb_panel.c — Streaming Damage to a Command-Driven Panel
+ *
+ * See fb_panel.h for the pipeline. Nothing here knows about SPI or a DMA
+ * engine: the link does the talking, this file decides what to say.
+ */
+
+#include "../../common/src/types.h"
+#include "../../memory/src/allocator.h"
+#include "fb_panel.h"
+#include "mmio.h"
+
+static inline uint32_t min_u32(uint32_t a, uint32_t b) { return a < b ? a : b; }
+static inline uint32_t max_u32(uint32_t a, uint32_t b) { return a > b ? a : b; }
+
+/* =============================================================================
+ * SETUP
+ * =============================================================================
+ */
+
+bool fb_panel_init(fb_panel_t *p, const framebuffer_t *fb,
+                   const fb_panel_link_t *link, fb_panel_wire_t wire, uint32_t slots)
+{
+    *p = (fb_panel_t){0};
+    if (slots == 0) slots = FB_PANEL_RING_SLOTS;
+
+    /* Slots on cache-line boundaries: cleaning one never touches the next */
+    uint32_t slot_bytes = (fb->width * fb_panel_wire_bpp(wire) + 63) & ~63u;
+    uint8_t *ring = heap_alloc_aligned((size_t)slot_bytes * slots, 64);
+    if (ring == NULL) return false;
+
+    p->link       = link;
+    p->wire       = wire;
+    p->width      = fb->width;
+    p->height     = fb->height;
+    p->ring       = ring;
+    p->slots      = slots;
+    p->slot_bytes = slot_bytes;
+    return true;
+}
+
+void fb_panel_destroy(fb_panel_t *p)
+{
+    fb_panel_wait(p);
+    if (p->ring) heap_free(p->ring);
+    *p = (fb_panel_t){0};
+}
+
+/* =============================================================================
+ * FORMAT CONVERSION
+ * =============================================================================
+ *
+ * Widening 5 or 6 bits to 8 repeats the top bits into the bottom, so
+ * full intensity stays full: 0x1F → 0xFF, not 0xF8. The ILI9488 ignores
+ * the low two bits of each RGB666 byte anyway.
+ */
+
+uint32_t fb_panel_convert_row(fb_panel_wire_t wire, const uint8_t *row, uint32_t src_bpp,
+                              uint32_t x, uint32_t count, uint8_t *out)
+{
+    uint8_t *o = out;
+
+    if (src_bpp == 2) {
+        const uint16_t *s = (const uint16_t *)row + x;
+        if (wire == FB_PANEL_RGB565) {
+            for (uint32_t i = 0; i < count; i++) {
+                *o++ = (uint8_t)(s[i] >> 8);
+                *o++ = (uint8_t)s[i];
+            }
+        } else {
+            for (uint32_t i = 0; i < count; i++) {
+                uint32_t r = (s[i] >> 11) & 0x1F;
+                uint32_t g = (s[i] >> 5)  & 0x3F;
+                uint32_t b =  s[i]        & 0x1F;
+                *o++ = (uint8_t)((r << 3) | (r >> 2));
+                *o++ = (uint8_t)((g << 2) | (g >> 4));
+                *o++ = (uint8_t)((b << 3) | (b >> 2));
+            }
+        }
+    } else {
+        /* Stored as drawn — ARGB, whatever the scan-out order (fb_format.h) */
+        const uint32_t *s = (const uint32_t *)row + x;
+        if (wire == FB_PANEL_RGB565) {
+            for (uint32_t i = 0; i < count; i++) {
+                uint32_t c = s[i];
+                uint32_t v = ((c >> 8) & 0xF800) | ((c >> 5) & 0x07E0) | ((c >> 3) & 0x001F);
+                *o++ = (uint8_t)(v >> 8);
+                *o++ = (uint8_t)v;
+            }
+        } else {
+            for (uint32_t i = 0; i < count; i++) {
+                uint32_t c = s[i];
+                *o++ = (uint8_t)(c >> 16);
+                *o++ = (uint8_t)(c >> 8);
+                *o++ = (uint8_t)c;
+            }
+        }
+    }
+    return (uint32_t)(o - out);
+}
+
+/* =============================================================================
+ * WINDOWS
+ * =============================================================================
+ *
+ * Two windows are merged when sending their bounding box costs less than
+ * sending them apart: the pixels the box adds that neither had, against
+ * one FB_PANEL_WINDOW_COST saved. Overlapping windows always qualify —
+ * their shared pixels would otherwise go out twice. A merge can make a
+ * new pair worth merging, so repeat until nothing changes; there are at
+ * most FB_MAX_DIRTY_RECTS windows.
+ */
+
+static uint64_t rect_area(const fb_dirty_t *r)
+{
+    return (uint64_t)r->w * r->h;
+}
+
+static fb_dirty_t rect_union(const fb_dirty_t *a, const fb_dirty_t *b)
+{
+    uint32_t x1 = min_u32(a->x, b->x);
+    uint32_t y1 = min_u32(a->y, b->y);
+    uint32_t x2 = max_u32(a->x + a->w, b->x + b->w);
+    uint32_t y2 = max_u32(a->y + a->h, b->y + b->h);
+    return (fb_dirty_t){ x1, y1, x2 - x1, y2 - y1 };
+}
+
+static bool rect_clip(fb_dirty_t *r, uint32_t width, uint32_t height)
+{
+    if (r->x >= width || r->y >= height) return false;
+    r->w = min_u32(r->w, width - r->x);
+    r->h = min_u32(r->h, height - r->y);
+    return r->w != 0 && r->h != 0;
+}
+
+static void windows_merge(fb_dirty_t *w, uint32_t *count, uint32_t wire_bpp)
+{
+    bool merged = true;
+
+    while (merged) {
+        merged = false;
+        for (uint32_t i = 0; i < *count && !merged; i++) {
+            for (uint32_t j = i + 1; j < *count; j++) {
+                fb_dirty_t u     = rect_union(&w[i], &w[j]);
+                uint64_t   apart = rect_area(&w[i]) + rect_area(&w[j]);
+                uint64_t   boxed = rect_area(&u);
+
+                if (boxed > apart && (boxed - apart) * wire_bpp >= FB_PANEL_WINDOW_COST) {
+                    continue;
+                }
+                w[i] = u;
+                w[j] = w[--*count];
+                merged = true;
+                break;
+            }
+        }
+    }
+}
+
+uint32_t fb_panel_collect(const fb_panel_t *p, const framebuffer_t *fb, fb_dirty_t *out)
+{
+    uint32_t n = 0;
+
+    if (!fb->full_dirty) {
+        for (uint32_t i = 0; i < fb->dirty_count; i++) {
+            out[n] = fb->dirty_rects[i];
+            if (rect_clip(&out[n], p->width, p->height)) n++;
+        }
+
+        /* The put_pixel/line bounding box, if fb_present() hasn't folded it in */
+        if (fb->touch_x2 != 0) {
+            fb_dirty_t t = { fb->touch_x1, fb->touch_y1,
+                             fb->touch_x2 - fb->touch_x1, fb->touch_y2 - fb->touch_y1 };
+            if (rect_clip(&t, p->width, p->height)) {
+                if (n < FB_MAX_DIRTY_RECTS) {
+                    out[n++] = t;
+                } else {
+                    out[n - 1] = rect_union(&out[n - 1], &t);
+                }
+            }
+        }
+    }
+
+    if (fb->full_dirty || (fb->dirty_count == 0 && fb->touch_x2 == 0)) {
+        out[0] = (fb_dirty_t){ 0, 0, p->width, p->height };
+        return 1;
+    }
+
+    windows_merge(out, &n, fb_panel_wire_bpp(p->wire));
+    return n;
+}
+
+/* =============================================================================
+ * STREAMING
+ * =============================================================================
+ *
+ * Slot s is reused every p->slots sends. Before converting into it, at
+ * most p->slots - 1 sends may still be in flight — then s's own send,
+ * the oldest, is done.
+ */
+
+typedef struct {
+    fb_panel_t *p;
+    uint32_t    slot;       /* Ring slot being filled */
+    uint32_t    fill;       /* Bytes in it so far */
+    uint32_t    queued;     /* Sends in flight, as far as we know */
+} fb_stream_t;
+
+static void stream_flush(fb_stream_t *st)
+{
+    fb_panel_t *p = st->p;
+    if (st->fill == 0) return;
+
+    uint8_t *slot = p->ring + (size_t)st->slot * p->slot_bytes;
+    clean_dcache_range((uintptr_t)slot, st->fill);   /* The DMA engine reads DRAM */
+    p->link->send(p->link->ctx, slot, st->fill);
+    p->bytes_sent += st->fill;
+
+    st->fill = 0;
+    st->slot = (st->slot + 1 == p->slots) ? 0 : st->slot + 1;
+    if (st->queued < p->slots) st->queued++;
+
+    /* The next slot must be free before anything is converted into it */
+    if (st->queued == p->slots) {
+        p->link->drain(p->link->ctx, p->slots - 1);
+        st->queued = p->slots - 1;
+    }
+}
+
+static void stream_window(fb_stream_t *st, const fb_dirty_t *w)
+{
+    fb_panel_t *p         = st->p;
+    uint32_t    row_bytes = w->w * fb_panel_wire_bpp(p->wire);
+
+    /* Commands can't interleave with pixel data still on the wire */
+    p->link->drain(p->link->ctx, 0);
+    st->queued = 0;
+    p->link->window(p->link->ctx, w->x, w->y, w->w, w->h);
+    p->windows_sent++;
+
+    for (uint32_t y = w->y; y < w->y + w->h; y++) {
+        if (st->fill + row_bytes > p->slot_bytes) stream_flush(st);
+
+        const uint8_t *row = p->src + (size_t)y * p->src_pitch;
+        uint8_t       *out = p->ring + (size_t)st->slot * p->slot_bytes + st->fill;
+        st->fill += fb_panel_convert_row(p->wire, row, p->src_bpp, w->x, w->w, out);
+    }
+    stream_flush(st);
+}
+
+static void fb_panel_stream(fb_panel_t *p)
+{
+    fb_stream_t st = { .p = p };
+
+    for (uint32_t i = 0; i < p->window_count; i++) {
+        stream_window(&st, &p->windows[i]);
+    }
+    p->link->drain(p->link->ctx, 0);
+    p->frames_sent++;
+}
+
+static void fb_panel_job(void *arg, uint32_t index)
+{
+    (void)index;
+    fb_panel_stream((fb_panel_t *)arg);
+}
+
+/* Take what the stream needs from fb: the swap and dirty reset come next */
+static void fb_panel_snapshot(fb_panel_t *p, const framebuffer_t *fb)
+{
+    p->src          = (const uint8_t *)fb->buffers[fb->front_buffer];
+    p->src_pitch    = fb->pitch;
+    p->src_bpp      = (fb->pixel_format == FB_FORMAT_RGB565) ? 2 : 4;
+    p->window_count = fb_panel_collect(p, fb, p->windows);
+}
+
+void fb_panel_present(fb_panel_t *p, const framebuffer_t *fb)
+{
+    fb_panel_wait(p);
+    fb_panel_snapshot(p, fb);
+    fb_panel_stream(p);
+}
+
+void fb_panel_present_async(fb_panel_t *p, const framebuffer_t *fb)
+{
+    /* One buffer: the next frame would be drawn over the one being sent */
+    if (fb->front_buffer == fb->back_buffer) {
+        fb_panel_present(p, fb);
+        return;
+    }
+
+    fb_panel_wait(p);
+    fb_panel_snapshot(p, fb);
+    job_submit(&p->job, fb_panel_job, p, 0);
+}
+
+void fb_panel_wait(fb_panel_t *p)
+{
+    job_wait(&p->job);
+}
@@ -0,0 +1,193 @@
+/*
+ * drivers/framebuffer/fb_panel.h — Streaming Damage to a Command-Driven Panel
+ *
+ * Tutorial-OS: Framebuffer Driver
+ *
+ * WHY THIS EXISTS:
+ * ================
+ *
+ * A memory-mapped display reads the framebuffer by itself; presenting is
+ * moving a scan-out pointer. An SPI panel like the ILI9488 has its own
+ * RAM, and every pixel that changes has to be pushed down the wire:
+ *
+ *   320 × 480 × 3 bytes (RGB666) = 460,800 bytes per full frame
+ *   at DISP_SPI_BAUD = 10 MHz    = 1.25 MB/s  →  2.7 frames/s
+ *
+ * The wire is the frame-rate ceiling, so the only real win is sending
+ * fewer bytes. The panel lets us: a column/page address window (CASET,
+ * PASET) followed by RAMWR writes just that rectangle of panel RAM. The
+ * dirty list fb_present() already keeps says which rectangles changed.
+ *
+ * THE PIPELINE:
+ * =============
+ *
+ *   shadow (RGB565)            ring (wire format)           link
+ *   ┌──────────────┐  convert  ┌──────┬──────┬──────┐  send  ┌─────┐
+ *   │   ▓▓  window │ ────────► │ slot │ slot │ slot │ ─────► │ DMA │ ─► SPI
+ *   └──────────────┘  per row  └──────┴──────┴──────┘        └─────┘
+ *
+ *   1. The frame's dirty rects become address windows. Windows that
+ *      overlap, or whose union wastes fewer bytes than a window costs,
+ *      are merged first (fb_panel_collect).
+ *   2. Rows of a window are converted into the next ring slot. A window's
+ *      rows are contiguous in RAMWR order, so a slot packs as many as fit.
+ *   3. A full slot is handed to link->send(), which queues it on the DMA
+ *      engine and returns. Converting the next slot overlaps sending this
+ *      one; the pipeline only waits when it comes back round to a slot
+ *      still in flight.
+ *
+ * A chained DMA channel (one descriptor per slot) is exactly this ring.
+ *
+ * RENDER AND TRANSFER ON DIFFERENT CORES:
+ * =======================================
+ *
+ * fb_panel_present_async() runs the stream as a job, so on a two-core
+ * part the second core sends frame N while the first draws frame N+1:
+ *
+ *   core 0:  draw N │ present │ draw N+1 │ present │ draw N+2 ...
+ *   core 1:         │ stream N           │ stream N+1 ...
+ *
+ * That only works if frame N+1 is drawn into a different buffer from
+ * the one being streamed — FB_BUFFER_COUNT >= 2. Two 320×480 RGB565
+ * buffers are 600 KB; where that doesn't fit (the RP2350 has 520 KB of
+ * SRAM), the framebuffer is single-buffered and the stream runs on the
+ * spot instead: conversion still overlaps DMA, drawing does not.
+ *
+ * HOW A SoC USES IT:
+ * ==================
+ *
+ * The SoC layer owns the link — SPI, D/C pin, DMA channel — and the
+ * strong fb_flip_display(), which is called right after the swap with the
+ * presented frame's dirty list still intact:
+ *
+ *   static fb_panel_t g_panel;
+ *
+ *   void fb_flip_display(framebuffer_t *fb)
+ *   {
+ *       fb_panel_present_async(&g_panel, fb);
+ *   }
+ *
+ * fb_panel_present_async() waits for the previous stream first, which is
+ * also what paces the frame rate to the wire.
+ *
+ * Only the shadow buffer's own rows are streamed; the hardware scroll
+ * ring (fb_set_scroll_ring) is a memory-mapped display feature.
+ */
+
+#ifndef FB_PANEL_H
+#define FB_PANEL_H
+
+#include "framebuffer.h"
+#include "job.h"
+
+/* Ring slots, by default. Two is enough to overlap; more absorbs jitter. */
+#ifndef FB_PANEL_RING_SLOTS
+#define FB_PANEL_RING_SLOTS     4
+#endif
+
+/*
+ * What opening a window costs, in wire bytes: the CASET/PASET/RAMWR
+ * commands, toggling D/C, and the ring draining before the commands can
+ * go out. Two windows closer than this are cheaper sent as one.
+ */
+#define FB_PANEL_WINDOW_COST    512
+
+/* Pixel formats the panel accepts on the wire */
+typedef enum {
+    FB_PANEL_RGB666 = 0,        /* 3 bytes, R G B, top 6 bits — ILI9488 over SPI */
+    FB_PANEL_RGB565 = 1,        /* 2 bytes, big-endian — ST7789, ILI9341 */
+} fb_panel_wire_t;
+
+/*
+ * The transport, provided by the SoC layer. Sends complete in the order
+ * they were queued.
+ *
+ *   window(x, y, w, h)   Address [x, x+w) × [y, y+h) and start RAMWR; the
+ *                        pixels follow row by row. Only called with no
+ *                        send in flight.
+ *   send(data, len)      Queue len bytes of pixel data and return. data
+ *                        stays untouched until drain() says it is done.
+ *   drain(pending)       Block until at most `pending` sends are still in
+ *                        flight. drain(0): the wire is idle.
+ *
+ * fb_flip_display() runs with interrupts masked, so drain() must poll
+ * the DMA channel rather than sleep until its interrupt.
+ */
+typedef struct {
+    void  *ctx;
+    void (*window)(void *ctx, uint32_t x, uint32_t y, uint32_t w, uint32_t h);
+    void (*send)(void *ctx, const uint8_t *data, uint32_t len);
+    void (*drain)(void *ctx, uint32_t pending);
+} fb_panel_link_t;
+
+typedef struct {
+    const fb_panel_link_t *link;
+    fb_panel_wire_t        wire;
+    uint32_t               width;       /* Panel size — the framebuffer's */
+    uint32_t               height;
+
+    uint8_t               *ring;        /* slots × slot_bytes, heap */
+    uint32_t               slots;
+    uint32_t               slot_bytes;  /* One full panel row, at least */
+
+    /* The frame being streamed: a snapshot, the framebuffer moves on */
+    const uint8_t         *src;
+    uint32_t               src_pitch;
+    uint32_t               src_bpp;
+    fb_dirty_t             windows[FB_MAX_DIRTY_RECTS];
+    uint32_t               window_count;
+    job_counter_t          job;
+
+    /* Totals since fb_panel_init, for benchmarks and the curious */
+    uint64_t               bytes_sent;
+    uint32_t               windows_sent;
+    uint32_t               frames_sent;
+} fb_panel_t;
+
+/*
+ * Allocate a ring of `slots` rows (0 = FB_PANEL_RING_SLOTS) for a panel
+ * the size of fb. Returns false if the heap is out of room.
+ */
+bool fb_panel_init(fb_panel_t *p, const framebuffer_t *fb,
+                   const fb_panel_link_t *link, fb_panel_wire_t wire, uint32_t slots);
+void fb_panel_destroy(fb_panel_t *p);
+
+/*
+ * The windows fb's current damage needs, merged; returns how many were
+ * written to out[] (at most FB_MAX_DIRTY_RECTS). Full damage — or none
+ * recorded, which fb_present() treats the same way — is one window
+ * covering the panel. Does not touch fb's dirty state.
+ */
+uint32_t fb_panel_collect(const fb_panel_t *p, const framebuffer_t *fb, fb_dirty_t *out);
+
+/*
+ * Stream the front buffer's damage and return when it is on the wire.
+ * Call after the swap, before the dirty list is cleared — from
+ * fb_flip_display().
+ */
+void fb_panel_present(fb_panel_t *p, const framebuffer_t *fb);
+
+/*
+ * Same, as a job another core picks up. Waits for the previous stream
+ * first. With a single buffer there is nothing to overlap with, and this
+ * is fb_panel_present().
+ */
+void fb_panel_present_async(fb_panel_t *p, const framebuffer_t *fb);
+
+/* The last fb_panel_present_async() has finished, wire drained */
+void fb_panel_wait(fb_panel_t *p);
+
+/*
+ * Convert count pixels starting at column x of a stored row (src_bpp 2 =
+ * RGB565, 4 = 32-bit ARGB) to the wire format. Returns bytes written.
+ */
+uint32_t fb_panel_convert_row(fb_panel_wire_t wire, const uint8_t *row, uint32_t src_bpp,
+                              uint32_t x, uint32_t count, uint8_t *out);
+
+/* Bytes per pixel on the wire */
+static inline uint32_t fb_panel_wire_bpp(fb_panel_wire_t wire)
+{
+    return wire == FB_PANEL_RGB666 ? 3 : 2;
+}
+
+#endif /* FB_PANEL_H */
@@ -109,6 +109,12 @@ static inline uint8_t *fb_row(const struct framebuffer *fb, uint32_t y)
     return (uint8_t *)fb->addr + y * fb->pitch;
 }
 
+/* Bytes per stored pixel — 2 for RGB565, 4 for the 32-bit formats */
+static inline uint32_t fb_bytes_per_px(const struct framebuffer *fb)
+{
+    return (fb->pixel_format == FB_FORMAT_RGB565) ? 2 : 4;
+}
+
 /* ─────────────────────────────────────────────────────────────────────────────
  * PIXEL WRITE
  * ─────────────────────────────────────────────────────────────────────────────
@@ -0,0 +1,455 @@
+/*
+ * drivers/framebuffer/fb_span.c — Horizontal Span Kernels
+ *
+ * Tutorial-OS: Framebuffer Span Layer
+ *
+ * ONE SOURCE, THREE WIDTHS:
+ * =========================
+ *
+ * The kernels are written once against span_vec_t, which is either
+ *
+ *   - a GCC generic vector of uint16_t lanes (vector_size 16 or 32), which
+ *     the compiler lowers to SSE2/AVX2 on x86-64, NEON on ARM64 and RVV on
+ *     RISC-V when the V extension is enabled, or
+ *   - a plain uint64_t, treated as four 16-bit lanes ("SWAR": SIMD Within
+ *     A Register). This is what the JH7110 (rv64gc, no V) and any ARM64
+ *     build that keeps -mgeneral-regs-only get.
+ *
+ * The trick that makes one source work for both: every operation below is
+ * something a uint64_t can also do lane-by-lane without carries spilling
+ * into the neighbouring lane. Products are at most 255 * 255 = 65025 and
+ * sums stay below 65536, so 16 bits per lane is always enough. Right shifts
+ * are the only operation that leaks between lanes in a uint64_t, so every
+ * right shift is followed by a mask — a no-op for real vector lanes.
+ *
+ * ARM64 NOTE:
+ * -----------
+ * The kernel is built with -mgeneral-regs-only so the exception vectors
+ * don't have to save 512 bytes of SIMD state. The Makefile compiles only
+ * this file without that flag when a soc.mk sets FB_SPAN_CFLAGS (which
+ * also defines FB_SPAN_NEON). Nothing here runs in interrupt context.
+ *
+ * THE /255 WITHOUT A DIVIDE:
+ * ==========================
+ *
+ * For 0 <= x <= 65025:  x / 255 == (x + 1 + (x >> 8)) >> 8   (exactly)
+ *
+ * That keeps the results identical to fb_blend_alpha(), which divides.
+ */
+
+#include "fb_span.h"
+
+#if !defined(SPAN_VEC_BYTES)
+#if defined(__AVX2__)
+#define SPAN_VEC_BYTES 32
+#elif defined(__SSE2__) || defined(__riscv_vector) || \
+      (defined(__aarch64__) && defined(FB_SPAN_NEON))
+#define SPAN_VEC_BYTES 16
+#else
+#define SPAN_VEC_BYTES 8
+#endif
+#endif
+
+#if SPAN_VEC_BYTES == 8
+typedef uint64_t __attribute__((may_alias)) span_vec_t;
+#else
+typedef uint16_t span_vec_t __attribute__((vector_size(SPAN_VEC_BYTES), may_alias));
+#endif
+
+#define SPAN_PX32   (SPAN_VEC_BYTES / 4)    /* ARGB8888 pixels per vector */
+#define SPAN_PX16   (SPAN_VEC_BYTES / 2)    /* RGB565 pixels per vector   */
+#define SPAN_MASK   (SPAN_VEC_BYTES - 1)
+
+/* Broadcast helpers — run once per span, not per pixel */
+static inline span_vec_t span_splat16(uint16_t v)
+{
+    union { span_vec_t vec; uint16_t h[SPAN_PX16]; } u;
+    for (uint32_t i = 0; i < SPAN_PX16; i++) u.h[i] = v;
+    return u.vec;
+}
+
+static inline span_vec_t span_splat32(uint32_t v)
+{
+    union { span_vec_t vec; uint32_t w[SPAN_PX32]; } u;
+    for (uint32_t i = 0; i < SPAN_PX32; i++) u.w[i] = v;
+    return u.vec;
+}
+
+/*
+ * Per-lane x * k for lanes and k <= 255. A vector multiplies lane by lane;
+ * a uint64_t has to be multiplied by the scalar k itself, since multiplying
+ * by a broadcast k would add cross-lane partial products.
+ */
+static inline span_vec_t span_scale(span_vec_t x, span_vec_t vk, uint32_t k)
+{
+#if SPAN_VEC_BYTES == 8
+    (void)vk;
+    return x * k;
+#else
+    (void)k;
+    return x * vk;
+#endif
+}
+
+/* Per-lane x / 255 for x <= 65025 */
+static inline span_vec_t span_div255(span_vec_t x, span_vec_t lo8, span_vec_t one)
+{
+    return ((x + one + ((x >> 8) & lo8)) >> 8) & lo8;
+}
+
+/* Scalar twins used for the unaligned head/tail pixels */
+static inline uint32_t div255(uint32_t x)
+{
+    return (x + 1 + (x >> 8)) >> 8;
+}
+
+static inline uint16_t blend565(uint16_t p, uint32_t sr, uint32_t sg,
+                                uint32_t sb, uint32_t inv)
+{
+    uint32_t r = (p >> 11) & 0x1F;
+    uint32_t g = (p >>  5) & 0x3F;
+    uint32_t b =  p        & 0x1F;
+    r = (r << 3) | (r >> 2);
+    g = (g << 2) | (g >> 4);
+    b = (b << 3) | (b >> 2);
+    r = div255(r * inv + sr);
+    g = div255(g * inv + sg);
+    b = div255(b * inv + sb);
+    return (uint16_t)(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+}
+
+
+/* =============================================================================
+ * SOLID FILLS
+ * =============================================================================
+ */
+
+void fb_span_fill32(uint32_t *dst, uint32_t color, uint32_t count)
+{
+    while (count && ((uintptr_t)dst & SPAN_MASK)) {
+        *dst++ = color;
+        count--;
+    }
+
+    span_vec_t v = span_splat32(color);
+    span_vec_t *vp = (span_vec_t *)(void *)dst;
+    while (count >= SPAN_PX32 * 4) {
+        vp[0] = v;
+        vp[1] = v;
+        vp[2] = v;
+        vp[3] = v;
+        vp += 4;
+        count -= SPAN_PX32 * 4;
+    }
+    while (count >= SPAN_PX32) {
+        *vp++ = v;
+        count -= SPAN_PX32;
+    }
+
+    dst = (uint32_t *)(void *)vp;
+    while (count--) *dst++ = color;
+}
+
+void fb_span_fill16(uint16_t *dst, uint16_t color, uint32_t count)
+{
+    while (count && ((uintptr_t)dst & SPAN_MASK)) {
+        *dst++ = color;
+        count--;
+    }
+
+    span_vec_t v = span_splat16(color);
+    span_vec_t *vp = (span_vec_t *)(void *)dst;
+    while (count >= SPAN_PX16 * 4) {
+        vp[0] = v;
+        vp[1] = v;
+        vp[2] = v;
+        vp[3] = v;
+        vp += 4;
+        count -= SPAN_PX16 * 4;
+    }
+    while (count >= SPAN_PX16) {
+        *vp++ = v;
+        count -= SPAN_PX16;
+    }
+
+    dst = (uint16_t *)(void *)vp;
+    while (count--) *dst++ = color;
+}
+
+
+/* =============================================================================
+ * SRC-OVER BLENDS
+ * =============================================================================
+ *
+ * ARGB8888: a pixel 0xAARRGGBB viewed as two 16-bit lanes is [GGBB][AARR].
+ * Masking with 0x00FF gives the B and R channels, shifting right by 8 gives
+ * G and A. Each half is blended with
+ *
+ *     out = (dst * (255 - sa) + src * sa) / 255
+ *
+ * where the src * sa terms are constants precomputed per span. Alpha uses
+ * src = 255 so that a = (255 * sa + da * inv) / 255, as fb_blend_alpha does.
+ */
+
+void fb_span_blend32(uint32_t *dst, uint32_t color, uint32_t count)
+{
+    uint32_t sa = color >> 24;
+    if (sa == 0) return;
+    if (sa == 255) {
+        fb_span_fill32(dst, color, count);
+        return;
+    }
+
+    uint32_t inv = 255 - sa;
+    uint32_t s_r = ((color >> 16) & 0xFF) * sa;
+    uint32_t s_g = ((color >>  8) & 0xFF) * sa;
+    uint32_t s_b = ( color        & 0xFF) * sa;
+    uint32_t s_a = 255 * sa;
+
+    while (count && ((uintptr_t)dst & SPAN_MASK)) {
+        uint32_t d = *dst;
+        uint32_t r = div255(((d >> 16) & 0xFF) * inv + s_r);
+        uint32_t g = div255(((d >>  8) & 0xFF) * inv + s_g);
+        uint32_t b = div255(( d        & 0xFF) * inv + s_b);
+        uint32_t a = div255(( d >> 24        ) * inv + s_a);
+        *dst++ = (a << 24) | (r << 16) | (g << 8) | b;
+        count--;
+    }
+
+    span_vec_t lo8   = span_splat16(0x00FF);
+    span_vec_t one   = span_splat16(1);
+    span_vec_t vinv  = span_splat16((uint16_t)inv);
+    span_vec_t src_rb = span_splat32((s_r << 16) | s_b);
+    span_vec_t src_ag = span_splat32((s_a << 16) | s_g);
+
+    span_vec_t *vp = (span_vec_t *)(void *)dst;
+    while (count >= SPAN_PX32) {
+        span_vec_t d  = *vp;
+        span_vec_t rb = span_scale(d & lo8, vinv, inv) + src_rb;
+        span_vec_t ag = span_scale((d >> 8) & lo8, vinv, inv) + src_ag;
+        *vp++ = span_div255(rb, lo8, one) | (span_div255(ag, lo8, one) << 8);
+        count -= SPAN_PX32;
+    }
+
+    dst = (uint32_t *)(void *)vp;
+    while (count--) {
+        uint32_t d = *dst;
+        uint32_t r = div255(((d >> 16) & 0xFF) * inv + s_r);
+        uint32_t g = div255(((d >>  8) & 0xFF) * inv + s_g);
+        uint32_t b = div255(( d        & 0xFF) * inv + s_b);
+        uint32_t a = div255(( d >> 24        ) * inv + s_a);
+        *dst++ = (a << 24) | (r << 16) | (g << 8) | b;
+    }
+}
+
+/*
+ * RGB565: one pixel per 16-bit lane. Each channel is expanded to 8 bits the
+ * same way fb_565_to_argb() does, blended, then truncated back exactly like
+ * fb_argb_to_565(). RGB565 has no alpha channel to carry.
+ */
+void fb_span_blend16(uint16_t *dst, uint32_t color, uint32_t count)
+{
+    uint32_t sa = color >> 24;
+    if (sa == 0) return;
+    if (sa == 255) {
+        uint16_t r = (color >> 19) & 0x1F;
+        uint16_t g = (color >> 10) & 0x3F;
+        uint16_t b = (color >>  3) & 0x1F;
+        fb_span_fill16(dst, (uint16_t)((r << 11) | (g << 5) | b), count);
+        return;
+    }
+
+    uint32_t inv = 255 - sa;
+    uint32_t s_r = ((color >> 16) & 0xFF) * sa;
+    uint32_t s_g = ((color >>  8) & 0xFF) * sa;
+    uint32_t s_b = ( color        & 0xFF) * sa;
+
+    while (count && ((uintptr_t)dst & SPAN_MASK)) {
+        *dst = blend565(*dst, s_r, s_g, s_b, inv);
+        dst++;
+        count--;
+    }
+
+    span_vec_t lo8  = span_splat16(0x00FF);
+    span_vec_t one  = span_splat16(1);
+    span_vec_t m5   = span_splat16(0x1F);
+    span_vec_t m6   = span_splat16(0x3F);
+    span_vec_t m3   = span_splat16(0x07);
+    span_vec_t m2   = span_splat16(0x03);
+    span_vec_t vinv = span_splat16((uint16_t)inv);
+    span_vec_t vs_r = span_splat16((uint16_t)s_r);
+    span_vec_t vs_g = span_splat16((uint16_t)s_g);
+    span_vec_t vs_b = span_splat16((uint16_t)s_b);
+
+    span_vec_t *vp = (span_vec_t *)(void *)dst;
+    while (count >= SPAN_PX16) {
+        span_vec_t d = *vp;
+        span_vec_t r = (d >> 11) & m5;
+        span_vec_t g = (d >>  5) & m6;
+        span_vec_t b =  d        & m5;
+        r = (r << 3) | ((r >> 2) & m3);
+        g = (g << 2) | ((g >> 4) & m2);
+        b = (b << 3) | ((b >> 2) & m3);
+        r = span_div255(span_scale(r, vinv, inv) + vs_r, lo8, one);
+        g = span_div255(span_scale(g, vinv, inv) + vs_g, lo8, one);
+        b = span_div255(span_scale(b, vinv, inv) + vs_b, lo8, one);
+        *vp++ = (((r >> 3) & m5) << 11) | (((g >> 2) & m6) << 5) | ((b >> 3) & m5);
+        count -= SPAN_PX16;
+    }
+
+    dst = (uint16_t *)(void *)vp;
+    while (count--) {
+        *dst = blend565(*dst, s_r, s_g, s_b, inv);
+        dst++;
+    }
+}
+
+
+/* =============================================================================
+ * STREAMING FILLS AND COPIES
+ * =============================================================================
+ *
+ * An ordinary store to write-back memory first pulls the line into the
+ * cache (write-allocate), and the line stays there, dirty, until the
+ * present-time clean writes it out. For an 8 MB clear that is 8 MB of
+ * useful data evicted and 131,072 lines to clean. A non-temporal store
+ * tells the core the data won't be read again:
+ *
+ *   x86-64   MOVNTI goes straight to the write-combining buffers, never
+ *            into the cache. The clean afterwards finds nothing.
+ *   ARM64    STNP is a hint. The A53 streams the stores without
+ *            allocating when it can, so the clean mostly walks lines
+ *            that aren't there (cheap, no write-back) — but it still has
+ *            to run, since nothing guarantees the hint was taken.
+ *            DC ZVA zeroes a whole block (DCZID_EL0, 64 bytes on the
+ *            A53) with no read of the old line at all.
+ *
+ * Either way the span's neighbours in the cache — glyph tables, the
+ * display list, the heap — survive the clear.
+ */
+
+#if defined(STRING_HAVE_CBO_ZERO) && defined(__riscv)
+/* boot/riscv64/cache.S — start 64-byte aligned, len a multiple of 64 */
+extern void zero_dcache_range(uintptr_t start, size_t len);
+#define STREAM_ZERO_BLOCK   64
+#endif
+
+#if defined(__aarch64__)
+/* DC ZVA block size in bytes, 0 while unread, 1 if DCZID_EL0.DZP forbids it */
+static uint32_t g_zva_bytes;
+
+static uint32_t stream_zva_bytes(void)
+{
+    if (g_zva_bytes == 0) {
+        uint64_t dczid;
+        __asm__ volatile("mrs %0, dczid_el0" : "=r"(dczid));
+        g_zva_bytes = (dczid & 0x10) ? 1 : 4u << (dczid & 0xF);
+    }
+    return g_zva_bytes;
+}
+#endif
+
+void fb_span_stream32(uint32_t *dst, uint32_t color, uint32_t count)
+{
+#if defined(__aarch64__)
+    uint32_t zva = stream_zva_bytes();
+    if (color == 0 && zva > 1 && count >= 2 * zva / 4) {
+        while ((uintptr_t)dst & (zva - 1)) {
+            *dst++ = 0;
+            count--;
+        }
+        while (count >= zva / 4) {
+            __asm__ volatile("dc zva, %0" :: "r"(dst) : "memory");
+            dst   += zva / 4;
+            count -= zva / 4;
+        }
+    }
+
+    while (count && ((uintptr_t)dst & 15)) {
+        *dst++ = color;
+        count--;
+    }
+    uint64_t v = color * 0x0000000100000001ULL;
+    while (count >= 16) {
+        __asm__ volatile("stnp %1, %1, [%0]\n\t"
+                         "stnp %1, %1, [%0, #16]\n\t"
+                         "stnp %1, %1, [%0, #32]\n\t"
+                         "stnp %1, %1, [%0, #48]"
+                         :: "r"(dst), "r"(v) : "memory");
+        dst   += 16;
+        count -= 16;
+    }
+    while (count >= 4) {
+        __asm__ volatile("stnp %1, %1, [%0]" :: "r"(dst), "r"(v) : "memory");
+        dst   += 4;
+        count -= 4;
+    }
+#elif defined(__x86_64__)
+    while (count && ((uintptr_t)dst & 7)) {
+        *dst++ = color;
+        count--;
+    }
+    uint64_t v = color * 0x0000000100000001ULL;
+    uint64_t *w = (uint64_t *)(void *)dst;
+    while (count >= 8) {
+        __asm__ volatile("movnti %1, (%0)\n\t"
+                         "movnti %1, 8(%0)\n\t"
+                         "movnti %1, 16(%0)\n\t"
+                         "movnti %1, 24(%0)"
+                         :: "r"(w), "r"(v) : "memory");
+        w     += 4;
+        count -= 8;
+    }
+    dst = (uint32_t *)(void *)w;
+    __asm__ volatile("sfence" ::: "memory");
+#elif defined(STREAM_ZERO_BLOCK)
+    if (color == 0 && count >= 2 * STREAM_ZERO_BLOCK / 4) {
+        while ((uintptr_t)dst & (STREAM_ZERO_BLOCK - 1)) {
+            *dst++ = 0;
+            count--;
+        }
+        size_t bytes = ((size_t)count * 4) & ~(size_t)(STREAM_ZERO_BLOCK - 1);
+        zero_dcache_range((uintptr_t)dst, bytes);
+        dst   += bytes / 4;
+        count -= (uint32_t)(bytes / 4);
+    }
+#endif
+    fb_span_fill32(dst, color, count);
+}
+
+void fb_span_stream_copy32(uint32_t *dst, const uint32_t *src, uint32_t count)
+{
+#if defined(__aarch64__)
+    while (count && ((uintptr_t)dst & 15)) {
+        *dst++ = *src++;
+        count--;
+    }
+    /* LDP tolerates an unaligned src on Normal memory; dst is aligned */
+    while (count >= 4) {
+        uint64_t a, b;
+        __asm__ volatile("ldp %0, %1, [%2]\n\t"
+                         "stnp %0, %1, [%3]"
+                         : "=&r"(a), "=&r"(b) : "r"(src), "r"(dst) : "memory");
+        dst   += 4;
+        src   += 4;
+        count -= 4;
+    }
+#elif defined(__x86_64__)
+    while (count && ((uintptr_t)dst & 7)) {
+        *dst++ = *src++;
+        count--;
+    }
+    uint64_t *w = (uint64_t *)(void *)dst;
+    while (count >= 2) {
+        uint64_t v;
+        __builtin_memcpy(&v, src, 8);
+        __asm__ volatile("movnti %1, (%0)" :: "r"(w), "r"(v) : "memory");
+        w++;
+        src   += 2;
+        count -= 2;
+    }
+    dst = (uint32_t *)(void *)w;
+    __asm__ volatile("sfence" ::: "memory");
+#endif
+    while (count--) *dst++ = *src++;
+}
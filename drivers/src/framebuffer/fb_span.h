@@ -0,0 +1,60 @@
+/*
+ * drivers/framebuffer/fb_span.h — Horizontal Span Kernels
+ *
+ * Tutorial-OS: Framebuffer Span Layer
+ *
+ * WHY THIS EXISTS:
+ * ================
+ *
+ * Almost every fill in the drawing API reduces to "do the same thing to N
+ * consecutive pixels of one row": fb_clear() is height spans, fb_fill_rect()
+ * is h spans, a vertical gradient is one solid span per row, and fb_fade()
+ * is one blended span per row. The original loops stored one pixel per
+ * iteration through WRITE_VOLATILE, which prevents the compiler from ever
+ * merging the stores. These kernels store a whole vector (16 bytes on
+ * SSE2/NEON/RVV, 8 bytes as a uint64_t on everything else) per iteration.
+ *
+ * The kernels know nothing about framebuffer_t. They take a pointer to the
+ * first pixel and a pixel count; clipping and dirty marking stay in
+ * framebuffer.c, which picks the 32-bit or 16-bit kernel from
+ * fb->pixel_format.
+ *
+ * BLEND SEMANTICS:
+ * ================
+ *
+ * fb_span_blend32/16 composite one constant ARGB color over the span with
+ * the same math as fb_blend_alpha(), bit for bit. Alpha 0 leaves the span
+ * untouched, alpha 255 becomes a solid fill.
+ */
+
+#ifndef FB_SPAN_H
+#define FB_SPAN_H
+
+#include "../../common/src/types.h"
+
+/* Solid fills — dst must be naturally aligned for its pixel size */
+void fb_span_fill32(uint32_t *dst, uint32_t color, uint32_t count);
+void fb_span_fill16(uint16_t *dst, uint16_t color, uint32_t count);
+
+/* Src-over of one ARGB8888 color onto ARGB8888 / RGB565 pixels */
+void fb_span_blend32(uint32_t *dst, uint32_t color, uint32_t count);
+void fb_span_blend16(uint16_t *dst, uint32_t color, uint32_t count);
+
+/*
+ * Streaming twins of fb_span_fill32 and a plain row copy, for spans the
+ * CPU writes once and never reads back (fb_clear, big fills and blits).
+ * The stores bypass or barely touch the data cache:
+ *
+ *   ARM64    STNP pairs; DC ZVA for color 0
+ *   x86-64   MOVNTI, then SFENCE before returning
+ *   RISC-V   cbo.zero for color 0 with STRING_HAVE_CBO_ZERO, else the
+ *            ordinary fill (rv64gc has no non-temporal store)
+ *
+ * dst must be Normal memory (FB_MEM_CACHED or FB_MEM_WC): DC ZVA faults
+ * on Device. Each call is complete and ordered on return, so parallel
+ * bands need no fence of their own.
+ */
+void fb_span_stream32(uint32_t *dst, uint32_t color, uint32_t count);
+void fb_span_stream_copy32(uint32_t *dst, const uint32_t *src, uint32_t count);
+
+#endif /* FB_SPAN_H */
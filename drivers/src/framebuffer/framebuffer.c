@@ -7,12 +7,15 @@
  * Matches the Rust implementation feature-for-feature.
  *
  * FORMAT AWARENESS:
- * Drawing functions always accept ARGB8888 colors (0xAARRGGBB). On RGB565
- * platforms, fb_pixel.h helpers convert on write and expand on read.
- * On ARGB8888 platforms, the format branch is never taken — zero overhead.
+ * Drawing functions always accept ARGB8888 colors (0xAARRGGBB). Pixel memory
+ * is only touched through fb_ops(fb) (fb_format.h): a raster core generated
+ * per storage format and bound once by fb_init, so no inner loop tests
+ * fb->pixel_format.
  */
 
 #include "../../common/src/types.h"
+#include "../../common/src/string.h"
+#include "../../memory/src/allocator.h"
 #include "framebuffer.h"
 
 /* BCM platforms use VideoCore mailbox for framebuffer allocation and vsync */
@@ -51,11 +54,34 @@ static inline void clean_dcache_range(uintptr_t addr, size_t size)
 }
 #else
 #include "mmio.h"
+#include "hal_cache.h"
 #endif
 
 /* Format-aware pixel access helpers (RGB565 ↔ ARGB8888 conversion) */
 #include "fb_pixel.h"
 
+/* Per-format raster core, bound to fb->ops at init */
+#include "fb_format.h"
+
+/* Vectorized solid/blend span kernels */
+#include "fb_span.h"
+
+/* clz without libgcc on RV64GC */
+#include "bitops.h"
+
+/* Band-parallel execution across every online core (kernel/src) */
+#include "job.h"
+#include "smp.h"
+#include "hal_cpu.h"
+
+/* Per-frame scratch memory, recycled on every present */
+#include "../../memory/src/arena.h"
+
+/* Vsync interrupt hook, flip timeout and idle wait (kernel/src/timer.h) */
+#include "hal_display.h"
+#include "timer.h"
+#include "prof.h"
+
 /* =============================================================================
  * GAMEBOY PALETTE (ARGB8888) - DMG Classic Green
  * =============================================================================
@@ -592,6 +618,8 @@ static inline int32_t max_i32(int32_t a, int32_t b) { return a > b ? a : b; }
 static inline uint32_t min_u32(uint32_t a, uint32_t b) { return a < b ? a : b; }
 static inline uint32_t max_u32(uint32_t a, uint32_t b) { return a > b ? a : b; }
 static inline int32_t abs_i32(int32_t x) { return x < 0 ? -x : x; }
+static inline int64_t min_i64(int64_t a, int64_t b) { return a < b ? a : b; }
+static inline int64_t max_i64(int64_t a, int64_t b) { return a > b ? a : b; }
 
 static inline bool is_clipped(const framebuffer_t *fb, uint32_t x, uint32_t y)
 {
@@ -600,6 +628,100 @@ static inline bool is_clipped(const framebuffer_t *fb, uint32_t x, uint32_t y)
            x >= clip->x + clip->w || y >= clip->y + clip->h;
 }
 
+/*
+ * Clip-first culling: every primitive works out its bounding box
+ * [x1, x2) × [y1, y2) before anything else and returns at once if the box
+ * misses the clip rect — no glyph cache lookup, no DMA sync, no loop that
+ * rejects its pixels one at a time. A scrolled list item above the
+ * viewport costs a few compares. 64-bit, so boxes built from int32
+ * centres and radii can't wrap.
+ */
+static inline bool fb_culled(const framebuffer_t *fb, int64_t x1, int64_t y1,
+                             int64_t x2, int64_t y2)
+{
+    const fb_clip_t *clip = &fb->clip_stack[fb->clip_depth];
+    return x2 <= (int64_t)clip->x || x1 >= (int64_t)clip->x + clip->w ||
+           y2 <= (int64_t)clip->y || y1 >= (int64_t)clip->y + clip->h ||
+           x2 <= x1 || y2 <= y1;
+}
+
+/* The box lies wholly inside the clip rect: per-pixel tests can go */
+static inline bool fb_unclipped(const framebuffer_t *fb, int64_t x1, int64_t y1,
+                                int64_t x2, int64_t y2)
+{
+    const fb_clip_t *clip = &fb->clip_stack[fb->clip_depth];
+    return x1 >= (int64_t)clip->x && x2 <= (int64_t)clip->x + clip->w &&
+           y1 >= (int64_t)clip->y && y2 <= (int64_t)clip->y + clip->h;
+}
+
+/*
+ * Grow the "touched" bounding box to include [x1, x2) × [y1, y2).
+ *
+ * Called by the per-pixel and line primitives instead of fb_mark_dirty():
+ * a circle outline is hundreds of put_pixel calls, and appending each one
+ * to dirty_rects[] would overflow it immediately. Four compares per write
+ * keeps the fast paths fast; fb_present() turns the box into one rect.
+ */
+static inline void fb_touch(framebuffer_t *fb, uint32_t x1, uint32_t y1,
+                            uint32_t x2, uint32_t y2)
+{
+    if (fb->full_dirty) return;
+    if (fb->touch_x2 == 0) {
+        fb->touch_x1 = x1; fb->touch_y1 = y1;
+        fb->touch_x2 = x2; fb->touch_y2 = y2;
+        return;
+    }
+    if (x1 < fb->touch_x1) fb->touch_x1 = x1;
+    if (y1 < fb->touch_y1) fb->touch_y1 = y1;
+    if (x2 > fb->touch_x2) fb->touch_x2 = x2;
+    if (y2 > fb->touch_y2) fb->touch_y2 = y2;
+}
+
+/*
+ * Wait for an offloaded fill or copy (DMA OFFLOAD below) before the CPU
+ * touches pixels. One load when nothing is in flight.
+ */
+static inline void fb_dma_sync(framebuffer_t *fb)
+{
+    if (fb->dma_fence.seq != 0) fb_dma_wait(fb);
+}
+
+/*
+ * fb_record() — divert a primitive into fb->recorder (see fb_cmd_t).
+ *
+ * Returns false in normal immediate mode, so each recordable primitive
+ * starts with `if (fb_record(...)) return;` at the cost of one NULL test.
+ * Returning false also means "about to draw", so it syncs with the DMA
+ * engine first; fb_record_cmd() is the same without the sync, for the
+ * primitives that may offload themselves.
+ */
+static inline bool fb_record_cmd(framebuffer_t *fb, uint32_t op,
+                                 int32_t x, int32_t y, int32_t w, int32_t h,
+                                 uint32_t r, uint32_t color, uint32_t color2,
+                                 uint32_t flags, const char *text)
+{
+    if (!fb->recorder) return false;
+    fb_cmd_t cmd = {
+        .op = op, .x = x, .y = y, .w = w, .h = h, .r = r,
+        .color = color, .color2 = color2, .flags = flags,
+        .clip = fb->clip_stack[fb->clip_depth],
+    };
+    fb->recorder->record(fb->recorder, &cmd, text);
+    return true;
+}
+
+static inline bool fb_record(framebuffer_t *fb, uint32_t op,
+                             int32_t x, int32_t y, int32_t w, int32_t h,
+                             uint32_t r, uint32_t color, uint32_t color2,
+                             uint32_t flags, const char *text)
+{
+    if (fb_record_cmd(fb, op, x, y, w, h, r, color, color2, flags, text)) {
+        return true;
+    }
+    fb_dma_sync(fb);
+    return false;
+}
+
 static inline size_t strlen_local(const char *s)
 {
     size_t len = 0;
@@ -616,6 +738,213 @@ static inline uint32_t fb_pack_color(const framebuffer_t *fb, uint32_t argb)
     return argb;
 }
 
+/* =============================================================================
+ * PARALLEL BANDS
+ * =============================================================================
+ *
+ * Big fills, blits and the present-time cache clean are split into
+ * horizontal bands and handed to the job system (job.h), one band per job:
+ *
+ *     ┌──────────────────────────┐
+ *     │ band 0   (calling core)  │
+ *     ├──────────────────────────┤
+ *     │ band 1   (stolen by CPU1)│
+ *     ├──────────────────────────┤
+ *     │ ...                      │
+ *     └──────────────────────────┘
+ *
+ * Bands are disjoint rows, so workers never write the same pixel. A band
+ * function ONLY touches pixels: recording, clipping and dirty tracking
+ * stay on the calling core, before or after the fan-out. That keeps
+ * fb->dirty_rects[] and the touch box single-writer.
+ *
+ * job_parallel_for() returns once every band has finished, which is the
+ * barrier between "pixels written" and anything that reads them (the next
+ * primitive, or the flip in fb_present()).
+ *
+ * Below FB_PAR_MIN_PIXELS the fan-out costs more than it saves — a button
+ * or a glyph runs straight through on the calling core, as does
+ * everything before smp_init().
+ */
+#define FB_PAR_MIN_PIXELS   (32 * 1024)     /* ~128 KB of ARGB8888 */
+#define FB_PAR_BANDS_PER_CPU 2              /* Slack for work stealing */
+#define FB_PAR_MAX_BANDS    32
+
+/* Work on units [lo, hi) — rows or columns, relative to the operation */
+typedef void (*fb_band_fn_t)(void *ctx, uint32_t lo, uint32_t hi);
+
+typedef struct {
+    fb_band_fn_t fn;
+    void        *ctx;
+    uint32_t     count;
+    uint32_t     per_band;
+} fb_par_t;
+
+static void fb_par_band(void *arg, uint32_t index)
+{
+    const fb_par_t *p = (const fb_par_t *)arg;
+    uint32_t lo = index * p->per_band;
+    uint32_t hi = lo + p->per_band;
+    if (hi > p->count) hi = p->count;
+    p->fn(p->ctx, lo, hi);
+}
+
+/*
+ * Run fn over [0, count) units of unit_px pixels each, split into bands
+ * whose size is a multiple of `align` units.
+ */
+static void fb_parallel(uint32_t count, uint32_t unit_px, uint32_t align,
+                        fb_band_fn_t fn, void *ctx)
+{
+    uint32_t cpus = smp_cpu_count();
+
+    if (cpus == 1 || (uint64_t)count * unit_px < FB_PAR_MIN_PIXELS) {
+        fn(ctx, 0, count);
+        return;
+    }
+
+    uint32_t bands = min_u32(cpus * FB_PAR_BANDS_PER_CPU, FB_PAR_MAX_BANDS);
+    uint32_t per   = (count + bands - 1) / bands;
+    per = (per + align - 1) / align * align;
+
+    fb_par_t p = { .fn = fn, .ctx = ctx, .count = count, .per_band = per };
+    job_parallel_for((count + per - 1) / per, fb_par_band, &p);
+}
+
+/* =============================================================================
+ * DMA OFFLOAD
+ * =============================================================================
+ *
+ * A full-screen fb_clear at 1080p is 8 MB of stores; a scroll is that
+ * much read and written again. The SoC's DMA engine (hal_dma.h, 2D
+ * TRANSFER ENGINE) moves rectangles on its own, so the bulk operations
+ * describe their rows as hal_dma_2d_t transfers and return at once. The
+ * fence lands in fb->dma_fence; fb_dma_sync() at the top of every CPU
+ * primitive is what keeps the two writers from interleaving.
+ *
+ * Only uncached scan-out buffers qualify: the engine writes DRAM behind
+ * the D-cache, and with FB_MEM_CACHED a dirty line written back later
+ * would land on top of its pixels. Below FB_DMA_MIN_BYTES the descriptor
+ * setup and the wait cost more than the CPU loop. The recorder and the
+ * clip stack are CPU-side concepts too: recorded or clipped calls stay on
+ * the CPU path.
+ *
+ * Any refusal from the HAL (no engine, not initialised yet, row too long
+ * to encode) falls back to the CPU code, unchanged.
+ */
+#define FB_DMA_MIN_BYTES    (64 * 1024)
+
+void fb_dma_wait(framebuffer_t *fb)
+{
+    if (fb->dma_fence.seq == 0) return;
+    hal_dma_fence_wait(fb->dma_fence);
+    fb->dma_fence.seq = 0;
+}
+
+static bool fb_dma_usable(const framebuffer_t *fb, uint64_t bytes)
+{
+    return fb->mem_type != FB_MEM_CACHED && fb->recorder == NULL &&
+           fb->clip_depth == 0 && bytes >= FB_DMA_MIN_BYTES;
+}
+
+/* Queue a chain; true if the engine took it */
+static bool fb_dma_submit(framebuffer_t *fb, const hal_dma_2d_t *xfers,
+                          uint32_t count)
+{
+    hal_dma_fence_t fence;
+
+    if (HAL_FAILED(hal_dma_2d_submit(HAL_DMA_CH_DISPLAY, xfers, count, &fence))) {
+        return false;
+    }
+    fb->dma_fence = fence;      /* Chains on one channel finish in order */
+    return true;
+}
+
+/* The 32-bit pattern fb_fill_span() would store for `color` */
+static uint32_t fb_dma_pattern(const framebuffer_t *fb, uint32_t color)
+{
+    if (fb->pixel_format == FB_FORMAT_RGB565) {
+        uint32_t c = fb_argb_to_565(color);
+        return c | (c << 16);
+    }
+    return color;
+}
+
+static hal_dma_2d_t fb_dma_fill_desc(const framebuffer_t *fb, uint32_t x,
+                                     uint32_t y, uint32_t w, uint32_t h,
+                                     uint32_t color)
+{
+    uint32_t bpp = fb_bytes_per_px(fb);
+    return (hal_dma_2d_t){
+        .op        = HAL_DMA_2D_FILL,
+        .dst       = fb_row(fb, y) + (size_t)x * bpp,
+        .fill      = fb_dma_pattern(fb, color),
+        .row_bytes = w * bpp,
+        .rows      = h,
+        .dst_pitch = (int32_t)fb->pitch,
+    };
+}
+
+/*
+ * Rows walk bottom-up (negative pitches from the last row) when the
+ * destination is below the source, like fb_copy_rows_band(). Within a
+ * row the engine only copies forwards, so returns false for a same-row
+ * copy to the right over itself — memmove's case.
+ */
+static bool fb_dma_copy_desc(const framebuffer_t *fb, uint32_t src_x,
+                             uint32_t src_y, uint32_t dst_x, uint32_t dst_y,
+                             uint32_t w, uint32_t h, hal_dma_2d_t *out)
+{
+    if (src_y == dst_y && dst_x > src_x && dst_x < src_x + w) return false;
+
+    uint32_t bpp   = fb_bytes_per_px(fb);
+    bool     up    = src_y < dst_y;
+    uint32_t first = up ? h - 1 : 0;
+    int32_t  pitch = up ? -(int32_t)fb->pitch : (int32_t)fb->pitch;
+
+    *out = (hal_dma_2d_t){
+        .op        = HAL_DMA_2D_COPY,
+        .dst       = fb_row(fb, dst_y + first) + (size_t)dst_x * bpp,
+        .src       = fb_row(fb, src_y + first) + (size_t)src_x * bpp,
+        .row_bytes = w * bpp,
+        .rows      = h,
+        .dst_pitch = pitch,
+        .src_pitch = pitch,
+    };
+    return true;
+}
+
+/* =============================================================================
+ * STREAMING STORES
+ * =============================================================================
+ *
+ * Fills and opaque copies of at least fb->stream_min bytes go through
+ * the format's stream_span / stream_row (fb_span.h): non-temporal stores
+ * that leave the caches alone. The size is judged per operation, not
+ * per span — a 1080p clear is one 8 MB decision even though each core
+ * only sees its band. The default is half the A53's L2: anything bigger
+ * would have evicted everything else anyway. Smaller fills stay cached,
+ * because the next blend over them reads them straight back.
+ *
+ * Device mappings never stream (DC ZVA faults on them), and blends
+ * don't either: fb_fade() reads every pixel first, so the line is
+ * already in the cache by the time it is written.
+ */
+#ifndef FB_STREAM_MIN_BYTES
+#define FB_STREAM_MIN_BYTES (256 * 1024)
+#endif
+
+static bool fb_streams(const framebuffer_t *fb, uint64_t bytes)
+{
+    size_t min = fb->stream_min ? fb->stream_min : FB_STREAM_MIN_BYTES;
+    return fb->mem_type != FB_MEM_DEVICE && bytes >= min;
+}
+
+void fb_set_stream_threshold(framebuffer_t *fb, size_t bytes)
+{
+    fb->stream_min = bytes;
+}
+
 /* =============================================================================
  * MATH HELPERS
  * =============================================================================
@@ -697,6 +1026,22 @@ uint32_t fb_blend_alpha(uint32_t src, uint32_t dst)
     return FB_ARGB(a, r, g, b);
 }
 
+void fb_premultiply(uint32_t *pixels, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t c = pixels[i];
+        uint32_t a = FB_ALPHA(c);
+        if (a == 255) continue;
+
+        /* Same lane trick as fb_blend_premul, scaling by a instead */
+        uint32_t rb = (c & 0x00FF00FF) * a;
+        uint32_t g  = ((c >> 8) & 0xFF) * a;
+        rb = ((rb + 0x00010001 + ((rb >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+        g  = ((g + 1 + (g >> 8)) >> 8) & 0xFF;
+        pixels[i] = (a << 24) | rb | (g << 8);
+    }
+}
+
 uint32_t fb_blend_additive(uint32_t src, uint32_t dst)
 {
     uint32_t r = min_u32(FB_RED(src) + FB_RED(dst), 255);
@@ -801,12 +1146,13 @@ bool fb_init_with_size(framebuffer_t *fb, uint32_t width, uint32_t height)
     fb->virtual_height = virtual_height;
     fb->buffer_size = pitch * height;
 
-    fb->buffers[0] = (uint32_t *)(uintptr_t)fb_addr;
-    if (FB_BUFFER_COUNT > 1) {
-        fb->buffers[1] = (uint32_t *)(uintptr_t)(fb_addr + fb->buffer_size);
+    for (uint32_t b = 0; b < FB_BUFFER_COUNT; b++) {
+        fb->buffers[b] = (uint32_t *)(uintptr_t)(fb_addr + b * fb->buffer_size);
     }
+    fb->mem_type = hal_display_map_scanout(fb_addr, fb_size_bytes);
 
     fb->front_buffer = 0;
+    fb->scan_buffer = 0;
     fb->back_buffer = (FB_BUFFER_COUNT > 1) ? 1 : 0;
     fb->addr = fb->buffers[fb->back_buffer];
 
@@ -816,6 +1162,13 @@ bool fb_init_with_size(framebuffer_t *fb, uint32_t width, uint32_t height)
     fb->clip_stack[0].w = width;
     fb->clip_stack[0].h = height;
 
+    fb->scroll_base = NULL;
+    fb->scroll_rows = 0;
+    fb->scroll_top = 0;
+
+    fb->pixel_format = FB_FORMAT_ARGB8888;
+    if (!fb_format_bind(fb)) return false;
+
     fb->dirty_count = 0;
     fb->full_dirty = true;
     fb->frame_count = 0;
@@ -859,14 +1212,34 @@ void fb_set_vsync(framebuffer_t *fb, bool enabled)
     fb->vsync_enabled = enabled;
 }
 
+/*
+ * The back buffer becomes the front (the latest presented frame); the new
+ * back buffer is any one the display is neither scanning nor about to.
+ *
+ *   Double:  there is none — the old front comes back, and fb_wait_flip()
+ *            holds off drawing until the vsync releases it.
+ *   Triple:  the third buffer; or, if the previous frame is still queued,
+ *            that frame's buffer — it is replaced before it is ever shown
+ *            ("latest frame wins"), so the renderer never waits.
+ *
+ * IRQs masked by the caller: the vsync interrupt moves scan_buffer.
+ */
 static void fb_swap_buffers(framebuffer_t *fb)
 {
     if (FB_BUFFER_COUNT < 2) return;
 
-    uint32_t temp = fb->front_buffer;
-    fb->front_buffer = fb->back_buffer;
-    fb->back_buffer = temp;
+    uint32_t presented = fb->back_buffer;
+    uint32_t next      = fb->front_buffer;
+
+    for (uint32_t i = 0; i < FB_BUFFER_COUNT; i++) {
+        if (i != presented && i != fb->scan_buffer) {
+            next = i;
+            break;
+        }
+    }
 
+    fb->front_buffer = presented;
+    fb->back_buffer  = next;
     fb->addr = fb->buffers[fb->back_buffer];
 }
 
@@ -874,23 +1247,11 @@ static void fb_swap_buffers(framebuffer_t *fb)
 
 static void fb_flip_display(framebuffer_t *fb)
 {
-    uint32_t y_offset = fb->front_buffer * fb->height;
+    uint32_t y_offset = fb->scroll_rows ? fb->scroll_top
+                                        : fb->front_buffer * fb->height;
     bcm_mailbox_set_virtual_offset(0, y_offset);
 }
 
-static void fb_wait_vsync(framebuffer_t *fb)
-{
-    (void)fb;  /* Unused parameter */
-
-    /* Use the convenience function - falls back to delay if not supported */
-    if (!bcm_mailbox_wait_vsync()) {
-        /* Fallback: ~16ms delay */
-        for (volatile uint32_t i = 0; i < 50000; i++) {
-            __asm__ volatile("nop");
-        }
-    }
-}
-
 #else /* !HAS_BCM_MAILBOX */
 
 /*
@@ -909,193 +1270,736 @@ __attribute__((weak)) void fb_flip_display(framebuffer_t *fb)
     (void)fb;  /* Non-BCM: no-op, handled by display_*.c */
 }
 
-static void fb_wait_vsync(framebuffer_t *fb)
-{
-    (void)fb;
-    /* Non-BCM: simple delay fallback */
-    for (volatile uint32_t i = 0; i < 50000; i++) {
-        HAL_NOP();
-    }
-}
-
 #endif /* HAS_BCM_MAILBOX */
 
-void fb_present(framebuffer_t *fb)
-{
-    if (!fb->initialized) return;
-
-    HAL_DSB();
-    clean_dcache_range((uintptr_t)fb->addr, fb_size(fb));
-    HAL_DSB();
-
-    fb_swap_buffers(fb);
-    fb_flip_display(fb);
+/*
+ * fb_for_each_dirty_span — hand every dirty byte range to a callback
+ *
+ * The display controller reads DRAM, not our D-cache, so everything drawn
+ * since the last present has to be cleaned first. Cleaning the whole buffer
+ * is ~8 MB of dc cvac at 1080p; kernel_main's once-a-second update touches
+ * two small panels. So we walk the dirty list instead:
+ *
+ *   1. Fold the put_pixel/hline/vline bounding box into dirty_rects[].
+ *   2. For each row covered by any rect, take the union of the x extents
+ *      of the rects crossing that row. That is the row's span.
+ *   3. Emit [row + x1 * bpp, row + x2 * bpp). pitch may exceed
+ *      width * bpp, so we step rows by pitch, not by the span length.
+ *   4. Spans that start within a cache line of where the previous one
+ *      ended are merged into one callback. Full-width rows with
+ *      pitch == width * bpp collapse into a single range.
+ *
+ * Two disjoint rects on the same row emit the gap between them as well.
+ * That costs at most one row's worth of lines and saves sorting spans.
+ *
+ * full_dirty (or nothing recorded at all) emits the whole buffer once.
+ *
+ * fb_present() uses this with clean_dcache_range(). SoC display drivers
+ * with their own write-back mechanism (JH7110 L2 Flush64) pass theirs.
+ */
+#define FB_CLEAN_MERGE_GAP  64   /* One cache line on every supported core */
 
-    if (fb->vsync_enabled) {
-        fb_wait_vsync(fb);
+/* Fold the touch box into dirty_rects[]; true if the whole buffer is dirty */
+static bool fb_damage_is_full(framebuffer_t *fb)
+{
+    if (fb->touch_x2 != 0) {
+        fb_mark_dirty(fb, fb->touch_x1, fb->touch_y1,
+                      fb->touch_x2 - fb->touch_x1, fb->touch_y2 - fb->touch_y1);
+        fb->touch_x2 = 0;
     }
-
-    fb_clear_dirty(fb);
-    fb->frame_count++;
+    return fb->full_dirty || fb->dirty_count == 0;
 }
 
-void fb_present_immediate(framebuffer_t *fb)
+static void fb_walk_dirty_spans(framebuffer_t *fb, uintptr_t base,
+                                fb_span_fn_t fn, void *ctx)
 {
-    if (!fb->initialized) return;
+    if (fb_damage_is_full(fb)) {
+        fn(base, fb_size(fb), ctx);
+        return;
+    }
 
-    HAL_DSB();
-    clean_dcache_range((uintptr_t)fb->addr, fb_size(fb));
-    HAL_DSB();
-}
+    uint32_t bpp  = fb_bytes_per_px(fb);
+    uint32_t y_lo = fb->height;
+    uint32_t y_hi = 0;
 
+    for (uint32_t i = 0; i < fb->dirty_count; i++) {
+        const fb_dirty_t *r = &fb->dirty_rects[i];
+        y_lo = min_u32(y_lo, r->y);
+        y_hi = max_u32(y_hi, r->y + r->h);
+    }
+    y_hi = min_u32(y_hi, fb->height);
 
-/* =============================================================================
- * CLIPPING
- * =============================================================================
- */
+    uintptr_t run_start = 0;
+    uintptr_t run_end   = 0;
 
-bool fb_push_clip(framebuffer_t *fb, fb_rect_t rect)
-{
-    if (fb->clip_depth >= FB_MAX_CLIP_DEPTH - 1) return false;
+    for (uint32_t y = y_lo; y < y_hi; y++) {
+        uint32_t x1 = fb->width;
+        uint32_t x2 = 0;
 
-    fb_clip_t *current = &fb->clip_stack[fb->clip_depth];
-    int32_t x1 = max_i32(rect.x, (int32_t)current->x);
-    int32_t y1 = max_i32(rect.y, (int32_t)current->y);
-    int32_t x2 = min_i32(rect.x + (int32_t)rect.w, (int32_t)(current->x + current->w));
-    int32_t y2 = min_i32(rect.y + (int32_t)rect.h, (int32_t)(current->y + current->h));
+        for (uint32_t i = 0; i < fb->dirty_count; i++) {
+            const fb_dirty_t *r = &fb->dirty_rects[i];
+            if (y < r->y || y >= r->y + r->h) continue;
+            x1 = min_u32(x1, r->x);
+            x2 = max_u32(x2, r->x + r->w);
+        }
+        x2 = min_u32(x2, fb->width);
+        if (x2 <= x1) continue;
 
-    fb->clip_depth++;
-    fb_clip_t *new_clip = &fb->clip_stack[fb->clip_depth];
+        uintptr_t row   = base + (uintptr_t)y * fb->pitch;
+        uintptr_t start = row + (uintptr_t)x1 * bpp;
+        uintptr_t end   = row + (uintptr_t)x2 * bpp;
 
-    if (x2 <= x1 || y2 <= y1) {
-        new_clip->x = new_clip->y = new_clip->w = new_clip->h = 0;
-    } else {
-        new_clip->x = (uint32_t)x1;
-        new_clip->y = (uint32_t)y1;
-        new_clip->w = (uint32_t)(x2 - x1);
-        new_clip->h = (uint32_t)(y2 - y1);
+        if (run_end != 0 && start <= run_end + FB_CLEAN_MERGE_GAP) {
+            run_end = end;
+            continue;
+        }
+        if (run_end != 0) {
+            fn(run_start, run_end - run_start, ctx);
+        }
+        run_start = start;
+        run_end   = end;
     }
-    return true;
-}
 
-void fb_pop_clip(framebuffer_t *fb)
-{
-    if (fb->clip_depth > 0) fb->clip_depth--;
+    if (run_end != 0) {
+        fn(run_start, run_end - run_start, ctx);
+    }
 }
 
-void fb_reset_clip(framebuffer_t *fb)
+void fb_for_each_dirty_span(framebuffer_t *fb, fb_span_fn_t fn, void *ctx)
 {
-    fb->clip_depth = 0;
-    fb->clip_stack[0].x = 0;
-    fb->clip_stack[0].y = 0;
-    fb->clip_stack[0].w = fb->width;
-    fb->clip_stack[0].h = fb->height;
+    fb_walk_dirty_spans(fb, (uintptr_t)fb->addr, fn, ctx);
 }
 
-fb_clip_t fb_get_clip(const framebuffer_t *fb)
+static void fb_clean_span(uintptr_t start, size_t len, void *ctx)
 {
-    return fb->clip_stack[fb->clip_depth];
+    (void)ctx;
+    clean_dcache_range(start, len);
 }
 
-
-/* =============================================================================
- * DIRTY TRACKING
- * =============================================================================
+/*
+ * Whole-buffer clean and copy, one row band per job. The last band also
+ * covers any tail past height * pitch so the result matches fb_size().
+ *
+ * Each band's clean_dcache_range() ends in its own DSB on the core that
+ * issued the maintenance, before the job counter is released — so when
+ * fb_parallel() returns, every band's lines have reached memory.
  */
-
-void fb_mark_dirty(framebuffer_t *fb, uint32_t x, uint32_t y, uint32_t w, uint32_t h)
-{
-    if (fb->full_dirty) return;
-    if (fb->dirty_count >= FB_MAX_DIRTY_RECTS) { fb->full_dirty = true; return; }
-    fb->dirty_rects[fb->dirty_count].x = x;
-    fb->dirty_rects[fb->dirty_count].y = y;
-    fb->dirty_rects[fb->dirty_count].w = w;
-    fb->dirty_rects[fb->dirty_count].h = h;
-    fb->dirty_count++;
-}
-
-void fb_mark_all_dirty(framebuffer_t *fb)
+typedef struct {
+    const framebuffer_t *fb;
+    uintptr_t            src;
+    uintptr_t            dst;       /* 0 = clean src in place */
+    bool                 clean;     /* Scan-out is cached: clean what we write */
+    bool                 stream;    /* Copy with non-temporal stores */
+} fb_bulk_t;
+
+static void fb_bulk_band(void *ctx, uint32_t lo, uint32_t hi)
 {
-    fb->full_dirty = true;
+    const fb_bulk_t *b = (const fb_bulk_t *)ctx;
+    size_t off = (size_t)lo * b->fb->pitch;
+    size_t len = (hi == b->fb->height) ? fb_size(b->fb) - off
+                                       : (size_t)(hi - lo) * b->fb->pitch;
+
+    if (b->dst && b->stream) {
+        fb_span_stream_copy32((uint32_t *)b->dst + off / 4,
+                              (const uint32_t *)b->src + off / 4, (uint32_t)(len / 4));
+        if (b->clean) clean_dcache_range(b->dst + off, len);
+    } else if (b->dst) {
+        memcpy((void *)(b->dst + off), (const void *)(b->src + off), len);
+        if (b->clean) clean_dcache_range(b->dst + off, len);
+    } else {
+        clean_dcache_range(b->src + off, len);
+    }
 }
 
-void fb_clear_dirty(framebuffer_t *fb)
+static void fb_bulk(const framebuffer_t *fb, uintptr_t src, uintptr_t dst)
 {
-    fb->dirty_count = 0;
-    fb->full_dirty = false;
+    fb_bulk_t b = {
+        .fb = fb, .src = src, .dst = dst,
+        .clean = fb->mem_type == FB_MEM_CACHED,
+        .stream = dst && fb_bytes_per_px(fb) == 4 && fb_streams(fb, fb_size(fb)),
+    };
+    fb_parallel(fb->height, fb->width, 1, fb_bulk_band, &b);
 }
 
-bool fb_is_dirty(const framebuffer_t *fb)
+/*
+ * Write-combining and device mappings never hold dirty lines: the stores
+ * are already on their way to DRAM and the caller's DSB drains them.
+ */
+static void fb_clean_dirty(framebuffer_t *fb)
 {
-    return fb->full_dirty || fb->dirty_count > 0;
+    if (fb->mem_type != FB_MEM_CACHED) return;
+
+    /*
+     * Partial damage is usually a few panels: walk it on this core. A full
+     * frame on a single core is cheaper by set/way once it outgrows the
+     * cache (hal_cache.h); with workers online it is split across them.
+     */
+    if (fb_damage_is_full(fb)) {
+#if !defined(SOC_RP2350)
+        if (hal_dcache_prefers_whole(fb_size(fb))) {
+            hal_dcache_clean((uintptr_t)fb->addr, fb_size(fb));
+            return;
+        }
+#endif
+        fb_bulk(fb, (uintptr_t)fb->addr, 0);
+        return;
+    }
+    fb_for_each_dirty_span(fb, fb_clean_span, NULL);
 }
 
-
 /* =============================================================================
- * BASIC DRAWING — FORMAT-AWARE
+ * DAMAGE HISTORY / COPY-FORWARD
  * =============================================================================
  *
- * Every function that directly accesses pixel memory is format-aware.
- * ARGB8888: original uint32_t* path (zero overhead — branch never taken).
- * RGB565:   uses fb_pixel.h helpers for conversion.
+ * Double buffering hands back a buffer that is two frames stale: frame N
+ * went into buffer A, frame N-1 is still in buffer B. That is why
+ * kernel_main used to draw its static panels twice at boot, and why any
+ * app that only redraws what changed would flicker between two versions.
  *
- * Fast paths exist for fb_clear(), fb_fill_rect(), and fb_draw_hline()
- * where the color is converted once and the 16-bit value is filled
- * directly, avoiding per-pixel ARGB→RGB565 conversion for solid fills.
+ * Copy-forward fixes the invariant instead of the app: once A is on
+ * screen, we copy frame N's dirty rows from A into B. B then equals the
+ * screen and the app only draws the delta for frame N+1. The copy is the
+ * same row-span walk the cache clean uses, so a small panel update costs
+ * a few KB of copies, not a full redraw.
+ *
+ * The copied rows are cleaned right away. They won't be in frame N+1's
+ * dirty list, but the display will scan them when B is presented.
  */
 
-void fb_clear(framebuffer_t *fb, uint32_t color)
+void fb_set_copy_forward(framebuffer_t *fb, bool enabled)
 {
-    if (fb->pixel_format == FB_FORMAT_RGB565) {
-        /* Fast path: convert once, fill with 16-bit value */
-        uint16_t c565 = fb_argb_to_565(color);
-        uint16_t *buf = (uint16_t *)(void *)fb->addr;
-        uint32_t total = (fb->pitch / 2) * fb->height;
-        for (uint32_t i = 0; i < total; i++) {
-            buf[i] = c565;
-        }
-    } else {
-        uint32_t pitch_words = fb->pitch / 4;
-        for (uint32_t y = 0; y < fb->height; y++) {
-            uint32_t *row = fb->addr + y * pitch_words;
-            for (uint32_t x = 0; x < fb->width; x++) {
-                WRITE_VOLATILE(&row[x], color);
-            }
-        }
-    }
-    fb_mark_all_dirty(fb);
+    fb->copy_forward = enabled;
 }
 
-void fb_put_pixel(framebuffer_t *fb, uint32_t x, uint32_t y, uint32_t color)
+uint32_t fb_buffer_age(const framebuffer_t *fb)
 {
-    if (x >= fb->width || y >= fb->height || is_clipped(fb, x, y)) return;
-    uint8_t *row = fb_row(fb, y);
-    fb_write_px(fb, row, x, color);
+    return fb->buffer_age[fb->back_buffer];
 }
 
-void fb_put_pixel_blend(framebuffer_t *fb, uint32_t x, uint32_t y, uint32_t color)
+typedef struct {
+    uintptr_t src_base;
+    uintptr_t dst_base;
+    bool      clean;
+} fb_copy_fwd_t;
+
+static void fb_copy_forward_span(uintptr_t start, size_t len, void *ctx)
 {
-    if (x >= fb->width || y >= fb->height || is_clipped(fb, x, y)) return;
-    uint8_t *row = fb_row(fb, y);
-    uint32_t dst = fb_read_px(fb, row, x);
-    fb_write_px(fb, row, x, fb_blend_alpha(color, dst));
+    const fb_copy_fwd_t *cf = (const fb_copy_fwd_t *)ctx;
+    uintptr_t dst = cf->dst_base + (start - cf->src_base);
+
+    memcpy((void *)dst, (const void *)start, len);
+    if (cf->clean) clean_dcache_range(dst, len);
 }
 
-void fb_put_pixel_unchecked(framebuffer_t *fb, uint32_t x, uint32_t y, uint32_t color)
+static bool fb_buffers_shared(const framebuffer_t *fb)
 {
-    uint8_t *row = fb_row(fb, y);
-    fb_write_px(fb, row, x, color);
+    return FB_BUFFER_COUNT < 2 ||
+           fb->buffers[fb->front_buffer] == fb->buffers[fb->back_buffer];
 }
 
-uint32_t fb_get_pixel(const framebuffer_t *fb, uint32_t x, uint32_t y)
+static void fb_save_damage(framebuffer_t *fb)
+{
+    fb->prev_full_dirty  = fb->full_dirty;
+    fb->prev_dirty_count = fb->dirty_count;
+    for (uint32_t i = 0; i < fb->dirty_count; i++) {
+        fb->prev_dirty_rects[i] = fb->dirty_rects[i];
+    }
+}
+
+/*
+ * Bring the back buffer up to the frame in front_buffer. Age 2 is one
+ * frame behind: replay this frame's damage. Age 3 — the usual case with
+ * triple buffering — is two behind: replay the union of this frame's and
+ * the previous one's, by appending prev_dirty_rects[] to the dirty list
+ * for the walk and truncating it again afterwards. fb_mark_dirty() only
+ * ever appends, so the truncation restores the list exactly. Anything
+ * older, or either frame fully dirty, is a whole-buffer copy.
+ */
+static void fb_copy_forward(framebuffer_t *fb)
+{
+    uint32_t back_age = fb->buffer_age[fb->back_buffer];
+    fb_copy_fwd_t cf = {
+        .src_base = (uintptr_t)fb->buffers[fb->front_buffer],
+        .dst_base = (uintptr_t)fb->buffers[fb->back_buffer],
+        .clean    = fb->mem_type == FB_MEM_CACHED,
+    };
+    bool partial = (back_age == 2) ||
+                   (back_age == 3 && !fb->prev_full_dirty && fb->prev_dirty_count != 0);
+
+    if (partial && !fb_damage_is_full(fb)) {
+        uint32_t count = fb->dirty_count;
+
+        if (back_age == 3) {
+            for (uint32_t i = 0; i < fb->prev_dirty_count; i++) {
+                const fb_dirty_t *r = &fb->prev_dirty_rects[i];
+                fb_mark_dirty(fb, r->x, r->y, r->w, r->h);
+            }
+        }
+        fb_walk_dirty_spans(fb, cf.src_base, fb_copy_forward_span, &cf);
+
+        fb->dirty_count = count;
+        fb->full_dirty  = false;
+    } else {
+        fb_bulk(fb, cf.src_base, cf.dst_base);
+    }
+    HAL_DSB();
+    fb->buffer_age[fb->back_buffer] = 1;
+}
+
+/*
+ * Age every buffer by one, bring the new back buffer up to date (if
+ * copy-forward is on) and save the presented frame's damage. Runs after
+ * the swap, so front_buffer is the frame just presented and the dirty
+ * list describes it; prev_dirty_rects[] still holds the frame before.
+ */
+static void fb_update_damage_history(framebuffer_t *fb)
+{
+    if (fb_buffers_shared(fb)) {
+        /* One physical buffer — whatever we draw on is the screen */
+        for (uint32_t i = 0; i < FB_BUFFER_COUNT; i++) fb->buffer_age[i] = 1;
+        fb_save_damage(fb);
+        return;
+    }
+
+    for (uint32_t i = 0; i < FB_BUFFER_COUNT; i++) {
+        if (fb->buffer_age[i] != 0) fb->buffer_age[i]++;
+    }
+    fb->buffer_age[fb->front_buffer] = 1;
+
+    if (fb->copy_forward) fb_copy_forward(fb);
+    fb_save_damage(fb);
+}
+
+/* =============================================================================
+ * ASYNCHRONOUS FLIP
+ * =============================================================================
+ *
+ * A present has a hardware half and a bookkeeping half:
+ *
+ *   fb_present_async()        vsync IRQ                fb_wait_flip()
+ *   ──────────────────        ─────────                ──────────────
+ *   clean dirty lines
+ *   swap, queue the flip ───▶ scan-out switches
+ *   return                    flip_pending = false
+ *                             frame_count++, callback ─▶ damage history,
+ *                                                        copy-forward,
+ *                                                        dirty reset
+ *
+ * The flip is queued with the display BEFORE it is marked pending, so a
+ * vsync landing in between can't complete a flip the hardware hasn't seen
+ * — at worst it completes one frame late.
+ *
+ * WHERE VSYNC COMES FROM:
+ * -----------------------
+ * The SoC's interrupt handler calls hal_display_vsync_irq() once per
+ * vertical blank (BCM2710: the firmware's SMI interrupt). Every flip also
+ * arms a timer event as a backstop:
+ *
+ *   vsync IRQ available    FB_FLIP_TIMEOUT_US — only fires if an IRQ is
+ *                          lost. If it fires before ANY vsync IRQ has ever
+ *                          been seen, the firmware isn't raising them, and
+ *                          we stop waiting for them.
+ *   no vsync IRQ           FB_FRAME_US — one refresh, the same pacing the
+ *                          old busy-wait gave, but asleep.
+ *
+ * Only one flip is in flight at a time, so a single timer event and one
+ * framebuffer pointer are all the state the IRQ side needs.
+ */
+
+#define FB_FRAME_US         16667               /* One 60 Hz refresh */
+#define FB_FLIP_TIMEOUT_US  (3 * FB_FRAME_US)
+
+static framebuffer_t     *g_flip_fb;
+static hal_timer_event_t  g_flip_timeout;
+static volatile bool      g_flip_done;
+static int8_t             g_vsync_irq = -1;     /* -1 untried, 0 no, 1 yes */
+static bool               g_vsync_seen;
+
+/* Platforms without a vsync interrupt: the flip timer does the pacing */
+HAL_WEAK hal_error_t hal_display_vsync_irq_init(void)
+{
+    return HAL_ERROR_NOT_SUPPORTED;
+}
+
+/* Platforms that don't choose a memory type: assume write-back */
+HAL_WEAK fb_mem_t hal_display_map_scanout(uintptr_t base, size_t size)
+{
+    (void)base;
+    (void)size;
+    return FB_MEM_CACHED;
+}
+
+/* IRQ context (or cpu_idle()'s polling loop, IRQs masked) */
+static void fb_flip_complete(void)
+{
+    framebuffer_t *fb = g_flip_fb;
+
+    if (fb == NULL || !fb->flip_pending) return;
+
+    hal_timer_event_cancel(&g_flip_timeout);
+    fb->flip_pending = false;
+    fb->scan_buffer  = fb->front_buffer;    /* The latest queued frame */
+    fb->frame_count++;
+    g_flip_done = true;
+
+    if (fb->frame_fn) fb->frame_fn(fb, fb->frame_arg);
+}
+
+void hal_display_vsync_irq(void)
+{
+    g_vsync_seen = true;
+    fb_flip_complete();
+}
+
+static void fb_flip_timeout(void *arg)
+{
+    (void)arg;
+    if (g_vsync_irq == 1 && !g_vsync_seen) {
+        g_vsync_irq = 0;
+    }
+    fb_flip_complete();
+}
+
+/* Thread-side half: the old front buffer is no longer being scanned */
+static void fb_flip_finish(framebuffer_t *fb)
+{
+    fb->flip_finish_due = false;
+    fb_update_damage_history(fb);
+    fb_clear_dirty(fb);
+
+    /* The frame before last is gone from the screen: recycle its scratch */
+    frame_arena_flip();
+}
+
+void fb_set_frame_callback(framebuffer_t *fb, fb_frame_fn_t fn, void *arg)
+{
+    hal_irq_flags_t f = hal_irq_save();
+    fb->frame_fn  = fn;
+    fb->frame_arg = arg;
+    hal_irq_restore(f);
+}
+
+void fb_present_async(framebuffer_t *fb)
+{
+    if (!fb->initialized) return;
+
+    /* An offloaded fill or copy must land before the dirty lines go out */
+    fb_dma_wait(fb);
+
+    /*
+     * Double buffering: the previous flip must be on screen first. Triple:
+     * returns at once — a queued frame is replaced, not waited for.
+     */
+    fb_wait_flip(fb);
+
+    PROF_ZONE_BEGIN("flush");
+    HAL_DSB();
+    fb_clean_dirty(fb);     /* Banded; returns after the last band's DSB */
+    HAL_DSB();
+    PROF_ZONE_END();
+
+    bool instant = !fb->vsync_enabled || fb_buffers_shared(fb);
+    if (!instant && g_vsync_irq < 0) {
+        g_vsync_irq = HAL_OK(hal_display_vsync_irq_init()) ? 1 : 0;
+    }
+
+    /* Swap, queue and mark pending with no vsync landing in between */
+    hal_irq_flags_t f = hal_irq_save();
+    fb_swap_buffers(fb);
+    fb_flip_display(fb);
+    fb->flip_finish_due = true;
+
+    if (instant) {
+        /* Nothing on screen to wait for — complete on the spot */
+        fb->scan_buffer = fb->front_buffer;
+        hal_irq_restore(f);
+        fb->frame_count++;
+        if (fb->frame_fn) fb->frame_fn(fb, fb->frame_arg);
+        fb_flip_finish(fb);
+        return;
+    }
+
+    g_flip_fb        = fb;
+    g_flip_done      = false;
+    fb->flip_pending = true;
+    hal_timer_event_start(&g_flip_timeout,
+                          g_vsync_irq ? FB_FLIP_TIMEOUT_US : FB_FRAME_US,
+                          0, fb_flip_timeout, NULL);
+    hal_irq_restore(f);
+
+    /*
+     * Triple buffering: the new back buffer isn't on screen, so the
+     * bookkeeping (and copy-forward into it) can run now.
+     */
+    if (fb->back_buffer != fb->scan_buffer) {
+        fb_flip_finish(fb);
+    }
+}
+
+/* Sleep while a queued flip still holds the back buffer (or, `all`, any flip) */
+static void fb_wait_scanout(framebuffer_t *fb, bool all)
+{
+    while (fb->flip_pending && (all || fb->back_buffer == fb->scan_buffer)) {
+        cpu_idle_wait(&g_flip_done);
+    }
+    if (fb->flip_finish_due) {
+        fb_flip_finish(fb);
+    }
+}
+
+void fb_wait_flip(framebuffer_t *fb)
+{
+    fb_wait_scanout(fb, false);
+}
+
+void fb_present(framebuffer_t *fb)
+{
+    fb_present_async(fb);
+    fb_wait_flip(fb);
+}
+
+void fb_present_immediate(framebuffer_t *fb)
+{
+    if (!fb->initialized) return;
+
+    fb_dma_wait(fb);
+
+    HAL_DSB();
+    fb_clean_dirty(fb);
+    HAL_DSB();
+
+    /* Same buffer stays on screen — start the next batch of damage fresh */
+    fb_clear_dirty(fb);
+}
+
+
+/* =============================================================================
+ * CLIPPING
+ * =============================================================================
+ */
+
+bool fb_push_clip(framebuffer_t *fb, fb_rect_t rect)
+{
+    if (fb->clip_depth >= FB_MAX_CLIP_DEPTH - 1) return false;
+
+    fb_clip_t *current = &fb->clip_stack[fb->clip_depth];
+    int32_t x1 = max_i32(rect.x, (int32_t)current->x);
+    int32_t y1 = max_i32(rect.y, (int32_t)current->y);
+    int32_t x2 = min_i32(rect.x + (int32_t)rect.w, (int32_t)(current->x + current->w));
+    int32_t y2 = min_i32(rect.y + (int32_t)rect.h, (int32_t)(current->y + current->h));
+
+    fb->clip_depth++;
+    fb_clip_t *new_clip = &fb->clip_stack[fb->clip_depth];
+
+    if (x2 <= x1 || y2 <= y1) {
+        new_clip->x = new_clip->y = new_clip->w = new_clip->h = 0;
+    } else {
+        new_clip->x = (uint32_t)x1;
+        new_clip->y = (uint32_t)y1;
+        new_clip->w = (uint32_t)(x2 - x1);
+        new_clip->h = (uint32_t)(y2 - y1);
+    }
+    return true;
+}
+
+void fb_pop_clip(framebuffer_t *fb)
+{
+    if (fb->clip_depth > 0) fb->clip_depth--;
+}
+
+void fb_reset_clip(framebuffer_t *fb)
+{
+    fb->clip_depth = 0;
+    fb->clip_stack[0].x = 0;
+    fb->clip_stack[0].y = 0;
+    fb->clip_stack[0].w = fb->width;
+    fb->clip_stack[0].h = fb->height;
+}
+
+fb_clip_t fb_get_clip(const framebuffer_t *fb)
+{
+    return fb->clip_stack[fb->clip_depth];
+}
+
+
+/* =============================================================================
+ * DIRTY TRACKING
+ * =============================================================================
+ */
+
+void fb_mark_dirty(framebuffer_t *fb, uint32_t x, uint32_t y, uint32_t w, uint32_t h)
+{
+    if (fb->full_dirty || w == 0 || h == 0) return;
+
+    /* Drop rects already covered — text drawn over a freshly filled panel
+     * is the common case and shouldn't eat a slot. */
+    for (uint32_t i = 0; i < fb->dirty_count; i++) {
+        const fb_dirty_t *r = &fb->dirty_rects[i];
+        if (x >= r->x && y >= r->y &&
+            x + w <= r->x + r->w && y + h <= r->y + r->h) {
+            return;
+        }
+    }
+
+    if (fb->dirty_count >= FB_MAX_DIRTY_RECTS) { fb->full_dirty = true; return; }
+    fb->dirty_rects[fb->dirty_count].x = x;
+    fb->dirty_rects[fb->dirty_count].y = y;
+    fb->dirty_rects[fb->dirty_count].w = w;
+    fb->dirty_rects[fb->dirty_count].h = h;
+    fb->dirty_count++;
+}
+
+void fb_mark_all_dirty(framebuffer_t *fb)
+{
+    fb->full_dirty = true;
+}
+
+void fb_clear_dirty(framebuffer_t *fb)
+{
+    fb->dirty_count = 0;
+    fb->full_dirty = false;
+    fb->touch_x2 = 0;
+}
+
+bool fb_is_dirty(const framebuffer_t *fb)
+{
+    return fb->full_dirty || fb->dirty_count > 0 || fb->touch_x2 != 0;
+}
+
+
+/* =============================================================================
+ * BASIC DRAWING — FORMAT-AWARE
+ * =============================================================================
+ *
+ * Every function that directly accesses pixel memory goes through the
+ * format's ops table (fb_format.h), one call per span or row.
+ *
+ * Solid and blended fills end up in the span kernels in fb_span.c: the
+ * color is converted once per span and stored a vector at a time, instead
+ * of one WRITE_VOLATILE pixel per iteration.
+ */
+
+/* Solid run of `count` pixels starting at column x of `row` */
+static inline void fb_fill_span(const framebuffer_t *fb, uint8_t *row,
+                                uint32_t x, uint32_t count, uint32_t color)
+{
+    fb_ops(fb)->fill_span(row, x, count, color);
+}
+
+/* Src-over run of `count` pixels starting at column x of `row` */
+static inline void fb_blend_span(const framebuffer_t *fb, uint8_t *row,
+                                 uint32_t x, uint32_t count, uint32_t color)
+{
+    fb_ops(fb)->blend_span(row, x, count, color);
+}
+
+/*
+ * Band context shared by the rectangle fills. Band rows are relative to y1;
+ * origin/extent are the unclipped rect's start and size along the gradient
+ * axis, so clipping never shifts the gradient.
+ */
+typedef struct {
+    const framebuffer_t *fb;
+    uint32_t x1, y1, w;
+    uint32_t color, color2;
+    uint32_t origin, extent;
+    bool     stream;                /* Big enough for non-temporal stores */
+} fb_rect_job_t;
+
+/* fill_span, or stream_span once the whole fill passes the stream size */
+static inline void fb_job_span(const fb_rect_job_t *j, uint8_t *row,
+                               uint32_t x, uint32_t count, uint32_t color)
+{
+    const fb_pixel_ops_t *ops = fb_ops(j->fb);
+    (j->stream ? ops->stream_span : ops->fill_span)(row, x, count, color);
+}
+
+static void fb_clear_band(void *ctx, uint32_t lo, uint32_t hi)
+{
+    const fb_rect_job_t *j = (const fb_rect_job_t *)ctx;
+    const framebuffer_t *fb = j->fb;
+
+    /* One span per band, row padding included */
+    uint32_t row_px = fb->pitch / fb_bytes_per_px(fb);
+    fb_job_span(j, fb_row(fb, lo), 0, row_px * (hi - lo), j->color);
+}
+
+static void fb_fill_band(void *ctx, uint32_t lo, uint32_t hi)
+{
+    const fb_rect_job_t *j = (const fb_rect_job_t *)ctx;
+    for (uint32_t py = j->y1 + lo; py < j->y1 + hi; py++) {
+        fb_job_span(j, fb_row(j->fb, py), j->x1, j->w, j->color);
+    }
+}
+
+static void fb_blend_band(void *ctx, uint32_t lo, uint32_t hi)
+{
+    const fb_rect_job_t *j = (const fb_rect_job_t *)ctx;
+    for (uint32_t py = j->y1 + lo; py < j->y1 + hi; py++) {
+        fb_blend_span(j->fb, fb_row(j->fb, py), j->x1, j->w, j->color);
+    }
+}
+
+void fb_clear(framebuffer_t *fb, uint32_t color)
+{
+    if (fb_record_cmd(fb, FB_CMD_FILL_RECT, 0, 0, (int32_t)fb->width, (int32_t)fb->height,
+                      0, color, 0, 0, NULL)) return;
+
+    if (fb_dma_usable(fb, fb->buffer_size)) {
+        /* Whole rows, padding included, as fb_clear_band does */
+        hal_dma_2d_t x = fb_dma_fill_desc(fb, 0, 0, fb->width, fb->height, color);
+        x.row_bytes = fb->pitch;
+        if (fb_dma_submit(fb, &x, 1)) {
+            fb_mark_all_dirty(fb);
+            return;
+        }
+    }
+    fb_dma_sync(fb);
+
+    fb_rect_job_t j = { .fb = fb, .color = color, .stream = fb_streams(fb, fb->buffer_size) };
+    fb_parallel(fb->height, fb->width, 1, fb_clear_band, &j);
+    fb_mark_all_dirty(fb);
+}
+
+void fb_put_pixel(framebuffer_t *fb, uint32_t x, uint32_t y, uint32_t color)
+{
+    fb_dma_sync(fb);
+    if (x >= fb->width || y >= fb->height || is_clipped(fb, x, y)) return;
+    fb_ops(fb)->write_px(fb_row(fb, y), x, color);
+    fb_touch(fb, x, y, x + 1, y + 1);
+}
+
+void fb_put_pixel_blend(framebuffer_t *fb, uint32_t x, uint32_t y, uint32_t color)
+{
+    fb_dma_sync(fb);
+    if (x >= fb->width || y >= fb->height || is_clipped(fb, x, y)) return;
+    const fb_pixel_ops_t *ops = fb_ops(fb);
+    uint8_t *row = fb_row(fb, y);
+    ops->write_px(row, x, fb_blend_alpha(color, ops->read_px(row, x)));
+    fb_touch(fb, x, y, x + 1, y + 1);
+}
+
+void fb_put_pixel_unchecked(framebuffer_t *fb, uint32_t x, uint32_t y, uint32_t color)
+{
+    fb_dma_sync(fb);
+    fb_ops(fb)->write_px(fb_row(fb, y), x, color);
+    fb_touch(fb, x, y, x + 1, y + 1);
+}
+
+uint32_t fb_get_pixel(const framebuffer_t *fb, uint32_t x, uint32_t y)
 {
     if (x >= fb->width || y >= fb->height) return FB_COLOR_TRANSPARENT;
-    const uint8_t *row = (const uint8_t *)fb->addr + y * fb->pitch;
-    return fb_read_px(fb, row, x);
+    if (fb->dma_fence.seq != 0) {
+        hal_dma_fence_wait(fb->dma_fence);  /* const: leaves the fence set */
+    }
+    return fb_ops(fb)->read_px(fb_row(fb, y), x);
 }
 
 void fb_fill_rect(framebuffer_t *fb, uint32_t x, uint32_t y, uint32_t w, uint32_t h, uint32_t color)
 {
+    if (fb_record(fb, FB_CMD_FILL_RECT, (int32_t)x, (int32_t)y, (int32_t)w, (int32_t)h,
+                  0, color, 0, 0, NULL)) return;
+
     const fb_clip_t *clip = &fb->clip_stack[fb->clip_depth];
     uint32_t x1 = max_u32(x, clip->x);
     uint32_t y1 = max_u32(y, clip->y);
@@ -1104,133 +2008,467 @@ void fb_fill_rect(framebuffer_t *fb, uint32_t x, uint32_t y, uint32_t w, uint32_
 
     if (x2 <= x1 || y2 <= y1) return;
 
-    if (fb->pixel_format == FB_FORMAT_RGB565) {
-        /* Fast path: convert once, fill with 16-bit value */
-        uint16_t c565 = fb_argb_to_565(color);
-        for (uint32_t py = y1; py < y2; py++) {
-            uint16_t *row = (uint16_t *)fb_row(fb, py);
-            for (uint32_t px = x1; px < x2; px++) {
-                row[px] = c565;
-            }
-        }
-    } else {
-        uint32_t pitch_words = fb->pitch / 4;
-        for (uint32_t py = y1; py < y2; py++) {
-            uint32_t *row = fb->addr + py * pitch_words;
-            for (uint32_t px = x1; px < x2; px++) {
-                WRITE_VOLATILE(&row[px], color);
-            }
-        }
-    }
+    fb_rect_job_t j = {
+        .fb = fb, .x1 = x1, .y1 = y1, .w = x2 - x1, .color = color,
+        .stream = fb_streams(fb, (uint64_t)(x2 - x1) * (y2 - y1) * fb_bytes_per_px(fb)),
+    };
+    fb_parallel(y2 - y1, x2 - x1, 1, fb_fill_band, &j);
     fb_mark_dirty(fb, x1, y1, x2 - x1, y2 - y1);
 }
 
-void fb_fill_rect_blend(framebuffer_t *fb, uint32_t x, uint32_t y, uint32_t w, uint32_t h, uint32_t color)
+void fb_fill_rect_blend(framebuffer_t *fb, uint32_t x, uint32_t y, uint32_t w, uint32_t h, uint32_t color)
+{
+    if (fb_record(fb, FB_CMD_FILL_BLEND, (int32_t)x, (int32_t)y, (int32_t)w, (int32_t)h,
+                  0, color, 0, 0, NULL)) return;
+
+    const fb_clip_t *clip = &fb->clip_stack[fb->clip_depth];
+    uint32_t x1 = max_u32(x, clip->x);
+    uint32_t y1 = max_u32(y, clip->y);
+    uint32_t x2 = min_u32(x + w, clip->x + clip->w);
+    uint32_t y2 = min_u32(y + h, clip->y + clip->h);
+
+    if (x2 <= x1 || y2 <= y1) return;
+
+    if (FB_ALPHA(color) == 0) return;
+
+    fb_rect_job_t j = { .fb = fb, .x1 = x1, .y1 = y1, .w = x2 - x1, .color = color };
+    fb_parallel(y2 - y1, x2 - x1, 1, fb_blend_band, &j);
+    fb_mark_dirty(fb, x1, y1, x2 - x1, y2 - y1);
+}
+
+void fb_draw_rect(framebuffer_t *fb, uint32_t x, uint32_t y, uint32_t w, uint32_t h, uint32_t color)
+{
+    if (w == 0 || h == 0) return;
+    fb_draw_hline(fb, x, y, w, color);
+    fb_draw_hline(fb, x, y + h - 1, w, color);
+    fb_draw_vline(fb, x, y, h, color);
+    fb_draw_vline(fb, x + w - 1, y, h, color);
+}
+
+void fb_draw_hline(framebuffer_t *fb, uint32_t x, uint32_t y, uint32_t len, uint32_t color)
+{
+    if (fb_record(fb, FB_CMD_HLINE, (int32_t)x, (int32_t)y, (int32_t)len, 1,
+                  0, color, 0, 0, NULL)) return;
+
+    const fb_clip_t *clip = &fb->clip_stack[fb->clip_depth];
+    if (y < clip->y || y >= clip->y + clip->h) return;
+
+    uint32_t x1 = max_u32(x, clip->x);
+    uint32_t x2 = min_u32(x + len, clip->x + clip->w);
+    if (x2 <= x1) return;
+
+    fb_fill_span(fb, fb_row(fb, y), x1, x2 - x1, color);
+    fb_touch(fb, x1, y, x2, y + 1);
+}
+
+void fb_draw_vline(framebuffer_t *fb, uint32_t x, uint32_t y, uint32_t len, uint32_t color)
+{
+    if (fb_record(fb, FB_CMD_VLINE, (int32_t)x, (int32_t)y, 1, (int32_t)len,
+                  0, color, 0, 0, NULL)) return;
+
+    const fb_clip_t *clip = &fb->clip_stack[fb->clip_depth];
+    if (x < clip->x || x >= clip->x + clip->w) return;
+
+    uint32_t y1 = max_u32(y, clip->y);
+    uint32_t y2 = min_u32(y + len, clip->y + clip->h);
+    if (y2 <= y1) return;
+
+    fb_ops(fb)->fill_col(fb_row(fb, y1), fb->pitch, x, y2 - y1, color);
+    fb_touch(fb, x, y1, x + 1, y2);
+}
+
+/* =============================================================================
+ * SPAN RASTERIZER
+ * =============================================================================
+ *
+ * Every filled shape below is described the same way: for each scanline,
+ * the one run of columns [x0, x1) it covers. fb_raster_span() clips that
+ * run against the clip rect once and hands it to the span kernels — one
+ * fill_span/blend_span call per row, no per-pixel clip test, and because
+ * no pixel is covered twice a blended shape composites exactly once.
+ *
+ * The shapes only have to produce the runs:
+ *
+ *   circles, rounded corners   fb_disc_t: half-width of a disc row,
+ *                              walked a row at a time — a few compares
+ *                              per row, no square root. Circles use the
+ *                              midpoint rule, so they match their outline
+ *   triangles, thick lines     fb_edge_t: one DDA per polygon edge,
+ *                              stepped a scanline at a time with no divide
+ *
+ * Rows outside the clip are never visited, and the union of what was drawn
+ * becomes a single dirty rect at the end.
+ */
+
+typedef struct {
+    framebuffer_t *fb;
+    void (*span)(uint8_t *row, uint32_t x, uint32_t count, uint32_t color);
+    uint32_t color;
+    bool     blend;
+    int32_t  cx1, cy1, cx2, cy2;    /* Clip rect, half-open */
+    int32_t  bx1, by1, bx2, by2;    /* Union of the runs drawn (empty: x2 <= x1) */
+} fb_raster_t;
+
+static bool fb_raster_begin(fb_raster_t *r, framebuffer_t *fb, uint32_t color, bool blend)
+{
+    if (blend && FB_ALPHA(color) == 0) return false;
+    fb_dma_sync(fb);
+
+    const fb_clip_t      *clip = &fb->clip_stack[fb->clip_depth];
+    const fb_pixel_ops_t *ops  = fb_ops(fb);
+
+    r->fb    = fb;
+    r->span  = blend ? ops->blend_span : ops->fill_span;
+    r->color = color;
+    r->blend = blend;
+    r->cx1   = (int32_t)clip->x;
+    r->cy1   = (int32_t)clip->y;
+    r->cx2   = (int32_t)(clip->x + clip->w);
+    r->cy2   = (int32_t)(clip->y + clip->h);
+    r->bx1   = r->cx2;  r->bx2 = r->cx1;
+    r->by1   = r->cy2;  r->by2 = r->cy1;
+    return true;
+}
+
+static inline void fb_raster_include(fb_raster_t *r, int32_t x1, int32_t y1,
+                                     int32_t x2, int32_t y2)
+{
+    r->bx1 = min_i32(r->bx1, x1);  r->bx2 = max_i32(r->bx2, x2);
+    r->by1 = min_i32(r->by1, y1);  r->by2 = max_i32(r->by2, y2);
+}
+
+/* Columns [x0, x1) of row y */
+static inline void fb_raster_span(fb_raster_t *r, int32_t y, int32_t x0, int32_t x1)
+{
+    if (y < r->cy1 || y >= r->cy2) return;
+    x0 = max_i32(x0, r->cx1);
+    x1 = min_i32(x1, r->cx2);
+    if (x1 <= x0) return;
+
+    r->span(fb_row(r->fb, (uint32_t)y), (uint32_t)x0, (uint32_t)(x1 - x0), r->color);
+    fb_raster_include(r, x0, y, x1, y + 1);
+}
+
+static void fb_raster_end(fb_raster_t *r)
+{
+    if (r->bx2 <= r->bx1 || r->by2 <= r->by1) return;
+    fb_mark_dirty(r->fb, (uint32_t)r->bx1, (uint32_t)r->by1,
+                  (uint32_t)(r->bx2 - r->bx1), (uint32_t)(r->by2 - r->by1));
+}
+
+/*
+ * Half-width of a disc row: the largest w with w² + dy² <= t. Each call
+ * nudges the previous answer, so walking dy one row at a time costs a
+ * compare or two per row. t = r² gives the corners fb_fill_rounded_rect
+ * always had.
+ */
+typedef struct {
+    int64_t t;
+    int32_t w;
+} fb_disc_t;
+
+static inline int32_t fb_disc_width(fb_disc_t *d, int32_t dy)
+{
+    int64_t rem = d->t - (int64_t)dy * dy;
+    if (rem < 0) return -1;
+    while ((int64_t)d->w * d->w > rem) d->w--;
+    while ((int64_t)(d->w + 1) * (d->w + 1) <= rem) d->w++;
+    return d->w;
+}
+
+/*
+ * Half-width of a row of the midpoint circle — the exact run between the
+ * two pixels fb_draw_circle() puts on that row, so a fill and its outline
+ * of the same radius line up.
+ *
+ * fb_draw_circle() steps x and keeps y while d = (x+1)² + y² − y − r² < 0,
+ * i.e. pixel (x, y) is on the outline when x² + y² − y < r². In the octant
+ * it walks (x <= y) the row is y and the half-width x; in its mirror the
+ * row is x and the half-width y. So for row dy the half-width is the
+ * largest w with
+ *
+ *   w² + dy² − dy < r²     (w <= dy)
+ *   w² − w + dy²  < r²     (w >= dy)
+ *
+ * Both sides grow with w and agree at w = dy, so the same nudging as
+ * fb_disc_width() finds it; w = 0 always qualifies for |dy| <= r.
+ */
+static inline int64_t fb_mid_eval(int32_t w, int32_t dy)
+{
+    int64_t ww = (int64_t)w * w, yy = (int64_t)dy * dy;
+    return w <= dy ? ww + yy - dy : ww - w + yy;
+}
+
+static inline int32_t fb_mid_width(fb_disc_t *d, int32_t dy)
 {
-    const fb_clip_t *clip = &fb->clip_stack[fb->clip_depth];
-    uint32_t x1 = max_u32(x, clip->x);
-    uint32_t y1 = max_u32(y, clip->y);
-    uint32_t x2 = min_u32(x + w, clip->x + clip->w);
-    uint32_t y2 = min_u32(y + h, clip->y + clip->h);
+    if (dy < 0) dy = -dy;
+    while (d->w > 0 && fb_mid_eval(d->w, dy) >= d->t) d->w--;
+    while (fb_mid_eval(d->w + 1, dy) < d->t) d->w++;
+    return d->w;
+}
 
-    if (x2 <= x1 || y2 <= y1) return;
+static void fb_raster_disc(fb_raster_t *r, int32_t cx, int32_t cy, int32_t rad)
+{
+    fb_disc_t d  = { (int64_t)rad * rad, 0 };
+    int32_t   y0 = max_i32(cy - rad, r->cy1);
+    int32_t   y1 = min_i32(cy + rad + 1, r->cy2);
 
-    for (uint32_t py = y1; py < y2; py++) {
-        uint8_t *row = fb_row(fb, py);
-        for (uint32_t px = x1; px < x2; px++) {
-            uint32_t dst = fb_read_px(fb, row, px);
-            fb_write_px(fb, row, px, fb_blend_alpha(color, dst));
-        }
+    for (int32_t y = y0; y < y1; y++) {
+        int32_t hw = fb_mid_width(&d, y - cy);
+        fb_raster_span(r, y, cx - hw, cx + hw + 1);
     }
-    fb_mark_dirty(fb, x1, y1, x2 - x1, y2 - y1);
 }
 
-void fb_draw_rect(framebuffer_t *fb, uint32_t x, uint32_t y, uint32_t w, uint32_t h, uint32_t color)
+/*
+ * Row yy of a rounded rect whose corner discs have radius rad (already
+ * clamped to w/2, h/2). Rows between the corners are full width.
+ */
+static void fb_rrect_row(fb_disc_t *d, int32_t x, int32_t y, int32_t w, int32_t h,
+                         int32_t rad, int32_t yy, int32_t *x0, int32_t *x1)
 {
-    if (w == 0 || h == 0) return;
-    fb_draw_hline(fb, x, y, w, color);
-    fb_draw_hline(fb, x, y + h - 1, w, color);
-    fb_draw_vline(fb, x, y, h, color);
-    fb_draw_vline(fb, x + w - 1, y, h, color);
+    int32_t dy = 0;
+    if (yy < y + rad)               dy = y + rad - yy;
+    else if (yy > y + h - 1 - rad)  dy = yy - (y + h - 1 - rad);
+
+    int32_t inset = rad - fb_disc_width(d, dy);
+    *x0 = x + inset;
+    *x1 = x + w - inset;
 }
 
-void fb_draw_hline(framebuffer_t *fb, uint32_t x, uint32_t y, uint32_t len, uint32_t color)
+/*
+ * Filled rounded rect: the corner rows go through fb_raster_span(); the
+ * full-width block between them is a plain rect and takes the banded,
+ * multi-core fill path like fb_fill_rect().
+ */
+static void fb_raster_rrect(fb_raster_t *r, int32_t x, int32_t y, int32_t w, int32_t h,
+                            int32_t rad)
 {
-    const fb_clip_t *clip = &fb->clip_stack[fb->clip_depth];
-    if (y < clip->y || y >= clip->y + clip->h) return;
+    fb_disc_t d   = { (int64_t)rad * rad, rad };
+    int32_t   top = y + rad;                /* First full-width row */
+    int32_t   bot = y + h - rad;            /* One past the last */
+
+    for (int32_t yy = max_i32(y, r->cy1); yy < min_i32(top, r->cy2); yy++) {
+        int32_t x0, x1;
+        fb_rrect_row(&d, x, y, w, h, rad, yy, &x0, &x1);
+        fb_raster_span(r, yy, x0, x1);
+    }
 
-    uint32_t x1 = max_u32(x, clip->x);
-    uint32_t x2 = min_u32(x + len, clip->x + clip->w);
-    if (x2 <= x1) return;
+    int32_t mx1 = max_i32(x, r->cx1), mx2 = min_i32(x + w, r->cx2);
+    int32_t my1 = max_i32(top, r->cy1), my2 = min_i32(bot, r->cy2);
+    if (mx2 > mx1 && my2 > my1) {
+        fb_rect_job_t j = { .fb = r->fb, .x1 = (uint32_t)mx1, .y1 = (uint32_t)my1,
+                            .w = (uint32_t)(mx2 - mx1), .color = r->color };
+        fb_parallel((uint32_t)(my2 - my1), j.w, 1, r->blend ? fb_blend_band : fb_fill_band, &j);
+        fb_raster_include(r, mx1, my1, mx2, my2);
+    }
 
-    if (fb->pixel_format == FB_FORMAT_RGB565) {
-        /* Fast path: convert once, fill with 16-bit value */
-        uint16_t c565 = fb_argb_to_565(color);
-        uint16_t *row = (uint16_t *)fb_row(fb, y);
-        for (uint32_t px = x1; px < x2; px++) {
-            row[px] = c565;
-        }
-    } else {
-        uint32_t *row = fb->addr + y * (fb->pitch / 4);
-        for (uint32_t px = x1; px < x2; px++) {
-            WRITE_VOLATILE(&row[px], color);
-        }
+    for (int32_t yy = max_i32(bot, r->cy1); yy < min_i32(y + h, r->cy2); yy++) {
+        int32_t x0, x1;
+        fb_rrect_row(&d, x, y, w, h, rad, yy, &x0, &x1);
+        fb_raster_span(r, yy, x0, x1);
     }
 }
 
-/* Helper that handles negative coordinates safely */
-static void fb_draw_hline_safe(framebuffer_t *fb, int32_t x, int32_t y, int32_t len, uint32_t color)
+/*
+ * One polygon edge, ya < yb, as a DDA: x = xa + floor((xb - xa)(y - ya) /
+ * (yb - ya)), with the quotient and remainder of the slope worked out once
+ * so stepping a row is an add and a compare.
+ */
+typedef struct {
+    int32_t y0, y1;                 /* Rows it spans, inclusive */
+    int32_t x, q, rem, err, dy;
+} fb_edge_t;
+
+static inline int64_t fb_floor_div(int64_t a, int64_t b)
+{
+    int64_t q = a / b;
+    return (a % b != 0 && a < 0) ? q - 1 : q;
+}
+
+/* Start the edge from (xa, ya) to (xb, yb) at row y (ya <= y <= yb) */
+static void fb_edge_init(fb_edge_t *e, int32_t xa, int32_t ya, int32_t xb, int32_t yb,
+                         int32_t y)
+{
+    int64_t num = (int64_t)xb - xa;
+    int64_t t   = num * (y - ya);
+    int64_t f   = fb_floor_div(t, yb - ya);
+
+    e->y0  = y;
+    e->y1  = yb;
+    e->dy  = yb - ya;
+    e->x   = xa + (int32_t)f;
+    e->err = (int32_t)(t - f * e->dy);
+    e->q   = (int32_t)fb_floor_div(num, e->dy);
+    e->rem = (int32_t)(num - (int64_t)e->q * e->dy);
+}
+
+static inline void fb_edge_step(fb_edge_t *e)
 {
-    /* Clip to screen bounds */
-    if (y < 0 || y >= (int32_t)fb->height) return;
-    if (x >= (int32_t)fb->width) return;
-    if (x + len <= 0) return;
+    e->x   += e->q;
+    e->err += e->rem;
+    if (e->err >= e->dy) { e->x++; e->err -= e->dy; }
+}
+
+#define FB_RASTER_MAX_VERTS 4
 
-    if (x < 0) {
-        len += x;  /* Reduce length by off-screen amount */
-        x = 0;
+/*
+ * Convex polygon, n <= FB_RASTER_MAX_VERTS vertices in either winding.
+ * Each row covers [leftmost edge, rightmost edge] inclusive — the same
+ * pixels the old flat-top/flat-bottom triangle halves drew.
+ */
+static void fb_raster_convex(fb_raster_t *r, const int32_t *vx, const int32_t *vy, uint32_t n)
+{
+    int32_t ymin = vy[0], ymax = vy[0];
+    for (uint32_t i = 1; i < n; i++) {
+        ymin = min_i32(ymin, vy[i]);
+        ymax = max_i32(ymax, vy[i]);
     }
-    if (x + len > (int32_t)fb->width) {
-        len = (int32_t)fb->width - x;
+    int32_t y0 = max_i32(ymin, r->cy1);
+    int32_t y1 = min_i32(ymax, r->cy2 - 1);
+    if (y1 < y0) return;
+
+    fb_edge_t e[FB_RASTER_MAX_VERTS];
+    uint32_t  ne = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t a = i, b = (i + 1) % n;
+        if (vy[a] == vy[b]) continue;       /* Its ends belong to its neighbours */
+        if (vy[a] > vy[b]) { uint32_t t = a; a = b; b = t; }
+        if (vy[b] < y0 || vy[a] > y1) continue;
+        fb_edge_init(&e[ne++], vx[a], vy[a], vx[b], vy[b], max_i32(vy[a], y0));
     }
 
-    if (len > 0) {
-        fb_draw_hline(fb, (uint32_t)x, (uint32_t)y, (uint32_t)len, color);
+    for (int32_t y = y0; y <= y1; y++) {
+        int32_t lo = 0, hi = -1;
+        bool    any = false;
+        for (uint32_t i = 0; i < ne; i++) {
+            if (y < e[i].y0 || y > e[i].y1) continue;
+            if (!any || e[i].x < lo) lo = e[i].x;
+            if (!any || e[i].x > hi) hi = e[i].x;
+            any = true;
+            if (y < e[i].y1) fb_edge_step(&e[i]);
+        }
+        if (any) fb_raster_span(r, y, lo, hi + 1);
     }
 }
 
-void fb_draw_vline(framebuffer_t *fb, uint32_t x, uint32_t y, uint32_t len, uint32_t color)
-{
-    const fb_clip_t *clip = &fb->clip_stack[fb->clip_depth];
-    if (x < clip->x || x >= clip->x + clip->w) return;
+/*
+ * CLIPPED LINES:
+ * ==============
+ *
+ * Walking Bresenham from end to end and testing every pixel against the
+ * clip costs the full length of the line however little of it shows —
+ * and a line crossing a small clip rect is mostly invisible. Instead the
+ * visible part is found first (Liang–Barsky, in whole pixel steps) and
+ * only that is walked.
+ *
+ * It has to draw exactly the pixels the plain walk would, or a clipped
+ * line would wobble against the same line drawn unclipped. The walk
+ * steps the major axis every pixel; after k steps the minor axis has
+ * moved
+ *
+ *   n(k) = floor((2·k·d_minor + d_major) / (2·d_major))
+ *
+ * which is the error term in closed form. So:
+ *
+ *   1. Steps k whose major coordinate is inside the clip: an interval.
+ *   2. Minor offsets n inside the clip: another interval, turned into
+ *      steps by inverting n(k) — it is monotonic.
+ *   3. Intersect, start the error term at the first step, walk to the
+ *      last. No per-pixel clip test.
+ *
+ * Horizontal and vertical lines skip all of it: they are one fill_span
+ * or fill_col call. Endpoints are assumed within ±2^30, where the
+ * products above fit in 64 bits.
+ */
 
-    uint32_t y1 = max_u32(y, clip->y);
-    uint32_t y2 = min_u32(y + len, clip->y + clip->h);
-    if (y2 <= y1) return;
+/* Steps k in [0, d] where a0 + s·k lands in [lo, hi]; false if none */
+static bool fb_line_steps(int64_t a0, int64_t s, int64_t lo, int64_t hi, int64_t d,
+                          int64_t *k0, int64_t *k1)
+{
+    *k0 = (s > 0) ? lo - a0 : a0 - hi;
+    *k1 = (s > 0) ? hi - a0 : a0 - lo;
+    *k0 = max_i64(*k0, 0);
+    *k1 = min_i64(*k1, d);
+    return *k0 <= *k1;
+}
 
-    for (uint32_t py = y1; py < y2; py++) {
-        uint8_t *row = fb_row(fb, py);
-        fb_write_px(fb, row, x, color);
+static void fb_line_clipped(framebuffer_t *fb, int32_t x0, int32_t y0, int32_t x1, int32_t y1,
+                            uint32_t color)
+{
+    const fb_clip_t *clip = &fb->clip_stack[fb->clip_depth];
+    int64_t cx1 = clip->x, cx2 = (int64_t)clip->x + clip->w - 1;    /* Inclusive */
+    int64_t cy1 = clip->y, cy2 = (int64_t)clip->y + clip->h - 1;
+
+    int64_t dx = (x1 > x0) ? (int64_t)x1 - x0 : (int64_t)x0 - x1;
+    int64_t dy = (y1 > y0) ? (int64_t)y1 - y0 : (int64_t)y0 - y1;
+    int64_t sx = x0 < x1 ? 1 : -1;
+    int64_t sy = y0 < y1 ? 1 : -1;
+
+    /* Major axis a, minor axis b */
+    bool    xmaj = dx >= dy;
+    int64_t da   = xmaj ? dx : dy,   db = xmaj ? dy : dx;
+    int64_t a0   = xmaj ? x0 : y0,   b0 = xmaj ? y0 : x0;
+    int64_t sa   = xmaj ? sx : sy,   sb = xmaj ? sy : sx;
+
+    int64_t k0, k1, n0, n1;
+    if (!fb_line_steps(a0, sa, xmaj ? cx1 : cy1, xmaj ? cx2 : cy2, da, &k0, &k1)) return;
+    if (!fb_line_steps(b0, sb, xmaj ? cy1 : cx1, xmaj ? cy2 : cx2, db, &n0, &n1)) return;
+
+    /* n(k) >= n0 and n(k) <= n1, solved for k */
+    k0 = max_i64(k0, -fb_floor_div(da - 2 * da * n0, 2 * db));
+    k1 = min_i64(k1, fb_floor_div(2 * da * (n1 + 1) - da - 1, 2 * db));
+    if (k1 < k0) return;
+
+    const fb_pixel_ops_t *ops = fb_ops(fb);
+    int64_t num = 2 * k0 * db + da;
+    int64_t n   = num / (2 * da);
+    int64_t err = num - n * 2 * da;
+    int64_t px = 0, py = 0, fx = 0, fy = 0;
+
+    for (int64_t k = k0; k <= k1; k++) {
+        int64_t a = a0 + sa * k, b = b0 + sb * n;
+        px = xmaj ? a : b;
+        py = xmaj ? b : a;
+        if (k == k0) { fx = px; fy = py; }
+        ops->write_px(fb_row(fb, (uint32_t)py), (uint32_t)px, color);
+
+        err += 2 * db;
+        if (err >= 2 * da) { err -= 2 * da; n++; }
     }
+
+    /* First and last pixel bound everything drawn */
+    fb_touch(fb, (uint32_t)min_i64(fx, px), (uint32_t)min_i64(fy, py),
+             (uint32_t)max_i64(fx, px) + 1, (uint32_t)max_i64(fy, py) + 1);
 }
 
 void fb_draw_line(framebuffer_t *fb, int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color)
 {
-    int32_t dx = abs_i32(x1 - x0);
-    int32_t dy = -abs_i32(y1 - y0);
-    int32_t sx = x0 < x1 ? 1 : -1;
-    int32_t sy = y0 < y1 ? 1 : -1;
-    int32_t err = dx + dy;
+    if (fb_record_cmd(fb, FB_CMD_LINE, x0, y0, x1, y1, 0, color, 0, 0, NULL)) return;
 
-    while (1) {
-        if (x0 >= 0 && y0 >= 0) {
-            fb_put_pixel(fb, (uint32_t)x0, (uint32_t)y0, color);
-        }
-        if (x0 == x1 && y0 == y1) break;
-        int32_t e2 = 2 * err;
-        if (e2 >= dy) { err += dy; x0 += sx; }
-        if (e2 <= dx) { err += dx; y0 += sy; }
+    /* Culled lines never wait on the DMA engine; anything drawn does */
+    int64_t lx = min_i32(x0, x1), hx = (int64_t)max_i32(x0, x1) + 1;
+    int64_t ly = min_i32(y0, y1), hy = (int64_t)max_i32(y0, y1) + 1;
+    if (fb_culled(fb, lx, ly, hx, hy)) return;
+    fb_dma_sync(fb);
+
+    const fb_clip_t *clip = &fb->clip_stack[fb->clip_depth];
+
+    if (y0 == y1) {
+        uint32_t a = (uint32_t)max_i64(lx, clip->x);
+        uint32_t b = (uint32_t)min_i64(hx, (int64_t)clip->x + clip->w);
+        fb_fill_span(fb, fb_row(fb, (uint32_t)y0), a, b - a, color);
+        fb_touch(fb, a, (uint32_t)y0, b, (uint32_t)y0 + 1);
+        return;
+    }
+    if (x0 == x1) {
+        uint32_t a = (uint32_t)max_i64(ly, clip->y);
+        uint32_t b = (uint32_t)min_i64(hy, (int64_t)clip->y + clip->h);
+        fb_ops(fb)->fill_col(fb_row(fb, a), fb->pitch, (uint32_t)x0, b - a, color);
+        fb_touch(fb, (uint32_t)x0, a, (uint32_t)x0 + 1, b);
+        return;
     }
+
+    fb_line_clipped(fb, x0, y0, x1, y1, color);
 }
 
 void fb_draw_line_thick(framebuffer_t *fb, int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t thickness, uint32_t color)
@@ -1240,6 +2478,10 @@ void fb_draw_line_thick(framebuffer_t *fb, int32_t x0, int32_t y0, int32_t x1, i
         return;
     }
 
+    int64_t pad = thickness / 2 + 1;
+    if (fb_culled(fb, min_i32(x0, x1) - pad, min_i32(y0, y1) - pad,
+                  max_i32(x0, x1) + pad + 1, max_i32(y0, y1) + pad + 1)) return;
+
     int32_t dx = x1 - x0;
     int32_t dy = y1 - y0;
     int32_t len_sq = dx * dx + dy * dy;
@@ -1255,13 +2497,21 @@ void fb_draw_line_thick(framebuffer_t *fb, int32_t x0, int32_t y0, int32_t x1, i
         return;
     }
 
-    int32_t half_thick = (int32_t)thickness / 2;
-
-    for (int32_t offset = -half_thick; offset <= half_thick; offset++) {
-        int32_t ox = (-dy * offset) / len;
-        int32_t oy = (dx * offset) / len;
-        fb_draw_line(fb, x0 + ox, y0 + oy, x1 + ox, y1 + oy, color);
-    }
+    /* Half the thickness along the normal (-dy, dx) / len, rounded */
+    int64_t den = 2 * (int64_t)len;
+    int64_t nx  = -(int64_t)dy * thickness;
+    int64_t ny  =  (int64_t)dx * thickness;
+    int32_t ox  = (int32_t)((nx >= 0 ? nx + len : nx - len) / den);
+    int32_t oy  = (int32_t)((ny >= 0 ? ny + len : ny - len) / den);
+
+    /* The stroke is one quad */
+    int32_t vx[4] = { x0 + ox, x1 + ox, x1 - ox, x0 - ox };
+    int32_t vy[4] = { y0 + oy, y1 + oy, y1 - oy, y0 - oy };
+
+    fb_raster_t r;
+    if (!fb_raster_begin(&r, fb, color, false)) return;
+    fb_raster_convex(&r, vx, vy, 4);
+    fb_raster_end(&r);
 }
 
 /* =============================================================================
@@ -1271,54 +2521,51 @@ void fb_draw_line_thick(framebuffer_t *fb, int32_t x0, int32_t y0, int32_t x1, i
 
 void fb_fill_circle(framebuffer_t *fb, int32_t cx, int32_t cy, uint32_t radius, uint32_t color)
 {
-    if (radius == 0) {
-        if (cx >= 0 && cy >= 0 && cx < (int32_t)fb->width && cy < (int32_t)fb->height) {
-            fb_put_pixel(fb, (uint32_t)cx, (uint32_t)cy, color);
-        }
-        return;
-    }
-
-    int32_t r = (int32_t)radius;
-    int32_t x = 0;
-    int32_t y = r;
-    int32_t d = 1 - r;
-
-    while (x <= y) {
-        /* Draw horizontal spans for all 4 quadrants */
-        fb_draw_hline_safe(fb, cx - x, cy + y, 2 * x + 1, color);
-        fb_draw_hline_safe(fb, cx - x, cy - y, 2 * x + 1, color);
-        fb_draw_hline_safe(fb, cx - y, cy + x, 2 * y + 1, color);
-        fb_draw_hline_safe(fb, cx - y, cy - x, 2 * y + 1, color);
+    if (fb_record(fb, FB_CMD_FILL_CIRCLE, cx, cy, 0, 0, radius, color, 0, 0, NULL)) return;
+    if (fb_culled(fb, (int64_t)cx - radius, (int64_t)cy - radius,
+                  (int64_t)cx + radius + 1, (int64_t)cy + radius + 1)) return;
+
+    fb_raster_t r;
+    if (!fb_raster_begin(&r, fb, color, false)) return;
+    fb_raster_disc(&r, cx, cy, (int32_t)radius);
+    fb_raster_end(&r);
+}
 
-        /* Midpoint circle algorithm */
-        if (d < 0) {
-            d += 2 * x + 3;
-        } else {
-            d += 2 * (x - y) + 5;
-            y--;
-        }
-        x++;
-    }
+/* One outline pixel: unchecked when ops is set, through fb_put_pixel() if not */
+static inline void fb_circle_px(framebuffer_t *fb, const fb_pixel_ops_t *ops,
+                                int32_t x, int32_t y, uint32_t color)
+{
+    if (ops) ops->write_px(fb_row(fb, (uint32_t)y), (uint32_t)x, color);
+    else     fb_put_pixel(fb, (uint32_t)x, (uint32_t)y, color);
 }
 
 void fb_draw_circle(framebuffer_t *fb, int32_t cx, int32_t cy, uint32_t radius, uint32_t color)
 {
+    if (fb_record_cmd(fb, FB_CMD_DRAW_CIRCLE, cx, cy, 0, 0, radius, color, 0, 0, NULL)) return;
+
+    int64_t bx1 = (int64_t)cx - radius, bx2 = (int64_t)cx + radius + 1;
+    int64_t by1 = (int64_t)cy - radius, by2 = (int64_t)cy + radius + 1;
+    if (fb_culled(fb, bx1, by1, bx2, by2)) return;
+    fb_dma_sync(fb);
+
     if (radius == 0) {
-        if (cx >= 0 && cy >= 0) fb_put_pixel(fb, (uint32_t)cx, (uint32_t)cy, color);
+        fb_put_pixel(fb, (uint32_t)cx, (uint32_t)cy, color);
         return;
     }
 
+    /* Wholly inside the clip: the eight octants go straight to write_px */
+    const fb_pixel_ops_t *ops = fb_unclipped(fb, bx1, by1, bx2, by2) ? fb_ops(fb) : NULL;
     int32_t x = 0, y = (int32_t)radius, d = 1 - (int32_t)radius;
 
     while (x <= y) {
-        fb_put_pixel(fb, (uint32_t)(cx + x), (uint32_t)(cy + y), color);
-        fb_put_pixel(fb, (uint32_t)(cx - x), (uint32_t)(cy + y), color);
-        fb_put_pixel(fb, (uint32_t)(cx + x), (uint32_t)(cy - y), color);
-        fb_put_pixel(fb, (uint32_t)(cx - x), (uint32_t)(cy - y), color);
-        fb_put_pixel(fb, (uint32_t)(cx + y), (uint32_t)(cy + x), color);
-        fb_put_pixel(fb, (uint32_t)(cx - y), (uint32_t)(cy + x), color);
-        fb_put_pixel(fb, (uint32_t)(cx + y), (uint32_t)(cy - x), color);
-        fb_put_pixel(fb, (uint32_t)(cx - y), (uint32_t)(cy - x), color);
+        fb_circle_px(fb, ops, cx + x, cy + y, color);
+        fb_circle_px(fb, ops, cx - x, cy + y, color);
+        fb_circle_px(fb, ops, cx + x, cy - y, color);
+        fb_circle_px(fb, ops, cx - x, cy - y, color);
+        fb_circle_px(fb, ops, cx + y, cy + x, color);
+        fb_circle_px(fb, ops, cx - y, cy + x, color);
+        fb_circle_px(fb, ops, cx + y, cy - x, color);
+        fb_circle_px(fb, ops, cx - y, cy - x, color);
 
         if (d < 0) {
             d += 2 * x + 3;
@@ -1328,11 +2575,17 @@ void fb_draw_circle(framebuffer_t *fb, int32_t cx, int32_t cy, uint32_t radius,
         }
         x++;
     }
+
+    /* (cx ± r, cy) and (cx, cy ± r) are always drawn: the box is exact */
+    if (ops) fb_touch(fb, (uint32_t)bx1, (uint32_t)by1, (uint32_t)bx2, (uint32_t)by2);
 }
 
 void fb_draw_arc(framebuffer_t *fb, uint32_t cx, uint32_t cy, uint32_t radius,
                  uint32_t start_deg, uint32_t end_deg, uint32_t color)
 {
+    if (fb_culled(fb, (int64_t)cx - radius, (int64_t)cy - radius,
+                  (int64_t)cx + radius + 1, (int64_t)cy + radius + 1)) return;
+
     if (radius == 0) {
         fb_put_pixel(fb, cx, cy, color);
         return;
@@ -1363,165 +2616,199 @@ void fb_draw_arc(framebuffer_t *fb, uint32_t cx, uint32_t cy, uint32_t radius,
 void fb_fill_rounded_rect(framebuffer_t *fb, uint32_t x, uint32_t y, uint32_t w, uint32_t h,
                           uint32_t radius, uint32_t color)
 {
+    if (fb_record(fb, FB_CMD_FILL_ROUNDED, (int32_t)x, (int32_t)y, (int32_t)w, (int32_t)h,
+                  radius, color, 0, 0, NULL)) return;
+    if (fb_culled(fb, x, y, (int64_t)x + w, (int64_t)y + h)) return;
+
     if (radius == 0) { fb_fill_rect(fb, x, y, w, h, color); return; }
     if (radius > w / 2) radius = w / 2;
     if (radius > h / 2) radius = h / 2;
 
-    /* Center rectangles */
-    fb_fill_rect(fb, x + radius, y, w - 2 * radius, h, color);
-    fb_fill_rect(fb, x, y + radius, radius, h - 2 * radius, color);
-    fb_fill_rect(fb, x + w - radius, y + radius, radius, h - 2 * radius, color);
-
-    /* Corner circles using the filled circle approach for quarter circles */
-    int32_t r = (int32_t)radius;
-    for (int32_t dy = 0; dy <= r; dy++) {
-        for (int32_t dx = 0; dx <= r; dx++) {
-            if (dx * dx + dy * dy <= r * r) {
-                /* Top-left */
-                fb_put_pixel(fb, x + radius - dx, y + radius - dy, color);
-                /* Top-right */
-                fb_put_pixel(fb, x + w - 1 - radius + dx, y + radius - dy, color);
-                /* Bottom-left */
-                fb_put_pixel(fb, x + radius - dx, y + h - 1 - radius + dy, color);
-                /* Bottom-right */
-                fb_put_pixel(fb, x + w - 1 - radius + dx, y + h - 1 - radius + dy, color);
-            }
-        }
-    }
+    fb_raster_t r;
+    if (!fb_raster_begin(&r, fb, color, false)) return;
+    fb_raster_rrect(&r, (int32_t)x, (int32_t)y, (int32_t)w, (int32_t)h, (int32_t)radius);
+    fb_raster_end(&r);
+}
+
+void fb_fill_rounded_rect_blend(framebuffer_t *fb, uint32_t x, uint32_t y, uint32_t w, uint32_t h,
+                                uint32_t radius, uint32_t color)
+{
+    if (fb_record(fb, FB_CMD_FILL_ROUNDED_BLEND, (int32_t)x, (int32_t)y, (int32_t)w, (int32_t)h,
+                  radius, color, 0, 0, NULL)) return;
+    if (fb_culled(fb, x, y, (int64_t)x + w, (int64_t)y + h)) return;
+
+    if (radius > w / 2) radius = w / 2;
+    if (radius > h / 2) radius = h / 2;
+
+    fb_raster_t r;
+    if (!fb_raster_begin(&r, fb, color, true)) return;
+    fb_raster_rrect(&r, (int32_t)x, (int32_t)y, (int32_t)w, (int32_t)h, (int32_t)radius);
+    fb_raster_end(&r);
 }
 
 void fb_draw_rounded_rect(framebuffer_t *fb, uint32_t x, uint32_t y, uint32_t w, uint32_t h,
                           uint32_t radius, uint32_t color)
 {
-    if (radius == 0) { fb_draw_rect(fb, x, y, w, h, color); return; }
+    if (fb_record(fb, FB_CMD_DRAW_ROUNDED, (int32_t)x, (int32_t)y, (int32_t)w, (int32_t)h,
+                  radius, color, 0, 0, NULL)) return;
+    if (fb_culled(fb, x, y, (int64_t)x + w, (int64_t)y + h)) return;
+
+    /* Clamped first: a 1-pixel-wide or -tall box has no room for a corner */
     if (radius > w / 2) radius = w / 2;
     if (radius > h / 2) radius = h / 2;
+    if (radius == 0) { fb_draw_rect(fb, x, y, w, h, color); return; }
 
-    /* Straight edges */
-    fb_draw_hline(fb, x + radius, y, w - 2 * radius, color);
-    fb_draw_hline(fb, x + radius, y + h - 1, w - 2 * radius, color);
-    fb_draw_vline(fb, x, y + radius, h - 2 * radius, color);
-    fb_draw_vline(fb, x + w - 1, y + radius, h - 2 * radius, color);
-
-    /* Corner arcs using midpoint circle algorithm */
-    int32_t r = (int32_t)radius;
-    int32_t px = 0, py = r, d = 1 - r;
-
-    while (px <= py) {
-        /* Top-left */
-        fb_put_pixel(fb, x + radius - px, y + radius - py, color);
-        fb_put_pixel(fb, x + radius - py, y + radius - px, color);
-        /* Top-right */
-        fb_put_pixel(fb, x + w - 1 - radius + px, y + radius - py, color);
-        fb_put_pixel(fb, x + w - 1 - radius + py, y + radius - px, color);
-        /* Bottom-left */
-        fb_put_pixel(fb, x + radius - px, y + h - 1 - radius + py, color);
-        fb_put_pixel(fb, x + radius - py, y + h - 1 - radius + px, color);
-        /* Bottom-right */
-        fb_put_pixel(fb, x + w - 1 - radius + px, y + h - 1 - radius + py, color);
-        fb_put_pixel(fb, x + w - 1 - radius + py, y + h - 1 - radius + px, color);
+    /*
+     * A one-pixel ring: in the corner rows, the outer shape's run minus
+     * the run of the shape one pixel inside it (same corner centres,
+     * radius - 1). Between the corners it is just the two side columns.
+     */
+    int32_t ix = (int32_t)x, iy = (int32_t)y, iw = (int32_t)w, ih = (int32_t)h;
+    int32_t rad = (int32_t)radius;
 
-        if (d < 0) {
-            d += 2 * px + 3;
-        } else {
-            d += 2 * (px - py) + 5;
-            py--;
+    fb_raster_t r;
+    if (!fb_raster_begin(&r, fb, color, false)) return;
+
+    fb_disc_t outer = { (int64_t)rad * rad, rad };
+    fb_disc_t inner = { (int64_t)(rad - 1) * (rad - 1), rad - 1 };
+
+    for (int32_t band = 0; band < 2; band++) {
+        int32_t from = band ? iy + ih - rad : iy;
+        int32_t to   = band ? iy + ih       : iy + rad;
+
+        for (int32_t yy = max_i32(from, r.cy1); yy < min_i32(to, r.cy2); yy++) {
+            int32_t ox0, ox1, jx0, jx1;
+            fb_rrect_row(&outer, ix, iy, iw, ih, rad, yy, &ox0, &ox1);
+
+            if (yy == iy || yy == iy + ih - 1 || iw <= 2) {
+                fb_raster_span(&r, yy, ox0, ox1);
+                continue;
+            }
+            fb_rrect_row(&inner, ix + 1, iy + 1, iw - 2, ih - 2, rad - 1, yy, &jx0, &jx1);
+            fb_raster_span(&r, yy, ox0, jx0);
+            fb_raster_span(&r, yy, jx1, ox1);
         }
-        px++;
+    }
+    fb_raster_end(&r);
+
+    if (h > 2 * radius) {
+        fb_draw_vline(fb, x, y + radius, h - 2 * radius, color);
+        fb_draw_vline(fb, x + w - 1, y + radius, h - 2 * radius, color);
     }
 }
 
 void fb_draw_triangle(framebuffer_t *fb, int32_t x0, int32_t y0, int32_t x1, int32_t y1,
                       int32_t x2, int32_t y2, uint32_t color)
 {
+    if (fb_culled(fb, min_i32(x0, min_i32(x1, x2)), min_i32(y0, min_i32(y1, y2)),
+                  (int64_t)max_i32(x0, max_i32(x1, x2)) + 1,
+                  (int64_t)max_i32(y0, max_i32(y1, y2)) + 1)) return;
+
     fb_draw_line(fb, x0, y0, x1, y1, color);
     fb_draw_line(fb, x1, y1, x2, y2, color);
     fb_draw_line(fb, x2, y2, x0, y0, color);
 }
 
-static void fb_fill_flat_bottom_triangle(framebuffer_t *fb, int32_t x0, int32_t y0,
-                                         int32_t x1, int32_t y1, int32_t x2, uint32_t color)
+void fb_fill_triangle(framebuffer_t *fb, int32_t x0, int32_t y0, int32_t x1, int32_t y1,
+                      int32_t x2, int32_t y2, uint32_t color)
 {
-    if (y1 == y0) return;
-
-    int32_t dy = y1 - y0;
-    int32_t dx1 = x1 - x0;
-    int32_t dx2 = x2 - x0;
-
-    for (int32_t y = y0; y <= y1; y++) {
-        int32_t t = y - y0;
-        int32_t cx1 = x0 + (dx1 * t) / dy;
-        int32_t cx2 = x0 + (dx2 * t) / dy;
-        if (cx1 > cx2) { int32_t tmp = cx1; cx1 = cx2; cx2 = tmp; }
-        if (y >= 0) {
-            fb_draw_hline(fb, (uint32_t)max_i32(cx1, 0), (uint32_t)y,
-                         (uint32_t)(cx2 - cx1 + 1), color);
-        }
-    }
+    if (y0 == y1 && y1 == y2) return;  /* Degenerate */
+    if (fb_culled(fb, min_i32(x0, min_i32(x1, x2)), min_i32(y0, min_i32(y1, y2)),
+                  (int64_t)max_i32(x0, max_i32(x1, x2)) + 1,
+                  (int64_t)max_i32(y0, max_i32(y1, y2)) + 1)) return;
+
+    int32_t vx[3] = { x0, x1, x2 };
+    int32_t vy[3] = { y0, y1, y2 };
+
+    fb_raster_t r;
+    if (!fb_raster_begin(&r, fb, color, false)) return;
+    fb_raster_convex(&r, vx, vy, 3);
+    fb_raster_end(&r);
 }
 
-static void fb_fill_flat_top_triangle(framebuffer_t *fb, int32_t x0, int32_t x1,
-                                      int32_t y0, int32_t x2, int32_t y2, uint32_t color)
+/* Each row is one solid span; t is still measured over the full rect */
+static void fb_gradient_v_band(void *ctx, uint32_t lo, uint32_t hi)
 {
-    if (y2 == y0) return;
-
-    int32_t dy = y2 - y0;
-    int32_t dx1 = x2 - x0;
-    int32_t dx2 = x2 - x1;
-
-    for (int32_t y = y2; y >= y0; y--) {
-        int32_t t = y2 - y;
-        int32_t cx1 = x2 - (dx1 * t) / dy;
-        int32_t cx2 = x2 - (dx2 * t) / dy;
-        if (cx1 > cx2) { int32_t tmp = cx1; cx1 = cx2; cx2 = tmp; }
-        if (y >= 0) {
-            fb_draw_hline(fb, (uint32_t)max_i32(cx1, 0), (uint32_t)y,
-                         (uint32_t)(cx2 - cx1 + 1), color);
-        }
+    const fb_rect_job_t *j = (const fb_rect_job_t *)ctx;
+    for (uint32_t py = j->y1 + lo; py < j->y1 + hi; py++) {
+        uint32_t row = py - j->origin;
+        uint8_t t = (j->extent > 1) ? (row * 255) / (j->extent - 1) : 0;
+        uint32_t c = fb_color_lerp(j->color, j->color2, t);
+        fb_job_span(j, fb_row(j->fb, py), j->x1, j->w, c);
     }
 }
 
-void fb_fill_triangle(framebuffer_t *fb, int32_t x0, int32_t y0, int32_t x1, int32_t y1,
-                      int32_t x2, int32_t y2, uint32_t color)
+/*
+ * Every row of a horizontal gradient is identical: each band lerps its
+ * first row pixel by pixel, then copies that row down the rest of the band.
+ */
+static void fb_gradient_h_band(void *ctx, uint32_t lo, uint32_t hi)
 {
-    /* Sort vertices by y coordinate */
-    if (y0 > y1) { int32_t t; t = x0; x0 = x1; x1 = t; t = y0; y0 = y1; y1 = t; }
-    if (y1 > y2) { int32_t t; t = x1; x1 = x2; x2 = t; t = y1; y1 = y2; y2 = t; }
-    if (y0 > y1) { int32_t t; t = x0; x0 = x1; x1 = t; t = y0; y0 = y1; y1 = t; }
-
-    if (y0 == y2) return;  /* Degenerate */
-
-    if (y1 == y2) {
-        fb_fill_flat_bottom_triangle(fb, x0, y0, x1, y1, x2, color);
-    } else if (y0 == y1) {
-        fb_fill_flat_top_triangle(fb, x0, x1, y0, x2, y2, color);
-    } else {
-        int32_t x3 = x0 + ((y1 - y0) * (x2 - x0)) / (y2 - y0);
-        fb_fill_flat_bottom_triangle(fb, x0, y0, x1, y1, x3, color);
-        fb_fill_flat_top_triangle(fb, x1, x3, y1, x2, y2, color);
+    const fb_rect_job_t *j = (const fb_rect_job_t *)ctx;
+    const framebuffer_t *fb = j->fb;
+    uint32_t bpp = fb_bytes_per_px(fb);
+    uint8_t *first = fb_row(fb, j->y1 + lo);
+
+    fb_ops(fb)->lerp_span(first, j->x1, j->w, j->color, j->color2,
+                          j->origin, j->extent);
+    for (uint32_t py = j->y1 + lo + 1; py < j->y1 + hi; py++) {
+        if (j->stream && bpp == 4) {
+            fb_span_stream_copy32((uint32_t *)(void *)fb_row(fb, py) + j->x1,
+                                  (const uint32_t *)(const void *)first + j->x1, j->w);
+        } else {
+            memcpy(fb_row(fb, py) + (size_t)j->x1 * bpp,
+                   first + (size_t)j->x1 * bpp, (size_t)j->w * bpp);
+        }
     }
 }
 
 void fb_fill_rect_gradient_v(framebuffer_t *fb, uint32_t x, uint32_t y, uint32_t w, uint32_t h,
                              uint32_t top_color, uint32_t bottom_color)
 {
-    for (uint32_t row = 0; row < h; row++) {
-        uint8_t t = (h > 1) ? (row * 255) / (h - 1) : 0;
-        uint32_t c = fb_color_lerp(top_color, bottom_color, t);
-        fb_draw_hline(fb, x, y + row, w, c);
-    }
+    if (fb_record(fb, FB_CMD_GRADIENT_V, (int32_t)x, (int32_t)y, (int32_t)w, (int32_t)h,
+                  0, top_color, bottom_color, 0, NULL)) return;
+
+    const fb_clip_t *clip = &fb->clip_stack[fb->clip_depth];
+    uint32_t x1 = max_u32(x, clip->x);
+    uint32_t y1 = max_u32(y, clip->y);
+    uint32_t x2 = min_u32(x + w, clip->x + clip->w);
+    uint32_t y2 = min_u32(y + h, clip->y + clip->h);
+
+    if (x2 <= x1 || y2 <= y1) return;
+
+    fb_rect_job_t j = {
+        .fb = fb, .x1 = x1, .y1 = y1, .w = x2 - x1,
+        .color = top_color, .color2 = bottom_color, .origin = y, .extent = h,
+        .stream = fb_streams(fb, (uint64_t)(x2 - x1) * (y2 - y1) * fb_bytes_per_px(fb)),
+    };
+    fb_parallel(y2 - y1, x2 - x1, 1, fb_gradient_v_band, &j);
+    fb_mark_dirty(fb, x1, y1, x2 - x1, y2 - y1);
 }
 
 void fb_fill_rect_gradient_h(framebuffer_t *fb, uint32_t x, uint32_t y, uint32_t w, uint32_t h,
                              uint32_t left_color, uint32_t right_color)
 {
-    for (uint32_t col = 0; col < w; col++) {
-        uint8_t t = (w > 1) ? (col * 255) / (w - 1) : 0;
-        uint32_t c = fb_color_lerp(left_color, right_color, t);
-        fb_draw_vline(fb, x + col, y, h, c);
-    }
+    if (fb_record(fb, FB_CMD_GRADIENT_H, (int32_t)x, (int32_t)y, (int32_t)w, (int32_t)h,
+                  0, left_color, right_color, 0, NULL)) return;
+
+    const fb_clip_t *clip = &fb->clip_stack[fb->clip_depth];
+    uint32_t x1 = max_u32(x, clip->x);
+    uint32_t y1 = max_u32(y, clip->y);
+    uint32_t x2 = min_u32(x + w, clip->x + clip->w);
+    uint32_t y2 = min_u32(y + h, clip->y + clip->h);
+
+    if (x2 <= x1 || y2 <= y1) return;
+
+    fb_rect_job_t j = {
+        .fb = fb, .x1 = x1, .y1 = y1, .w = x2 - x1,
+        .color = left_color, .color2 = right_color, .origin = x, .extent = w,
+        .stream = fb_streams(fb, (uint64_t)(x2 - x1) * (y2 - y1) * fb_bytes_per_px(fb)),
+    };
+    fb_parallel(y2 - y1, x2 - x1, 1, fb_gradient_h_band, &j);
+    fb_mark_dirty(fb, x1, y1, x2 - x1, y2 - y1);
 }
 
+/* Full-screen src-over of translucent black: one blended span per row */
 void fb_fade(framebuffer_t *fb, uint8_t amount)
 {
     uint32_t fade_color = FB_WITH_ALPHA(FB_COLOR_BLACK, amount);
@@ -1532,167 +2819,356 @@ void fb_fade(framebuffer_t *fb, uint8_t amount)
 /* =============================================================================
  * TEXT RENDERING
  * =============================================================================
- * All text functions use fb_put_pixel() which is already format-aware.
- * No changes needed here — format awareness comes from the pixel helpers.
+ *
+ * Every text function funnels into fb_draw_text_run(). The original
+ * implementation called fb_put_pixel() 64 times per 8×8 glyph (scale² times
+ * more for scaled text), re-checking bounds and the clip stack each time.
+ * The engine below clips once per string and then writes whole spans:
+ *
+ *   Opaque text:      Each glyph row is two nibbles. For a given fg/bg/scale
+ *                     there are only 16 possible 4-pixel (4·scale wide)
+ *                     patterns, so we pre-render them once into a cache
+ *                     slot and memcpy two patterns per glyph row. Slots
+ *                     are filled on a miss, so each core has its own set:
+ *                     text drawn by a job worker never renders into a slot
+ *                     another core is copying from, and no lock is needed.
+ *
+ *   Transparent text: Only the set bits are drawn. clz finds each run of
+ *                     consecutive set bits, which becomes one fb_fill_span().
+ *
+ * Dirty tracking uses fb_touch() with the clipped bounding box of the run,
+ * the same accumulator the per-pixel path fed.
  */
 
-void fb_draw_char(framebuffer_t *fb, uint32_t x, uint32_t y, char c, uint32_t fg, uint32_t bg)
+#define FB_TEXT_CACHE_SLOTS     4
+#define FB_TEXT_CACHE_SCALE     4       /* Larger scales skip the cache */
+
+/* Pre-rendered nibble patterns: 16 patterns × 4·scale pixels (RGB565 packs two per word) */
+typedef struct {
+    uint32_t fg;
+    uint32_t bg;
+    uint32_t scale;
+    uint32_t format;
+    bool     valid;
+    uint32_t px[16][4 * FB_TEXT_CACHE_SCALE];
+} fb_glyph_cache_t;
+
+typedef struct {
+    fb_glyph_cache_t slot[FB_TEXT_CACHE_SLOTS];
+    uint32_t         next;
+} fb_glyph_cache_set_t;
+
+static fb_glyph_cache_set_t g_glyph_cache[HAL_MAX_CPUS];
+
+/* Per-run state, computed once by fb_text_begin() */
+typedef struct {
+    uint32_t fg, bg, scale, flags;
+    uint32_t bpp;                       /* Bytes per stored pixel */
+    uint32_t cx1, cy1, cx2, cy2;        /* Effective clip, half-open */
+    const uint8_t *font;                /* font_8x8 or font_8x16 base */
+    uint32_t rows;                      /* Glyph rows: 8 or 16 */
+    const fb_glyph_cache_t *cache;      /* Opaque only; NULL → bg + runs */
+} fb_text_ctx_t;
+
+static const fb_glyph_cache_t *fb_glyph_cache_get(const framebuffer_t *fb,
+                                                  uint32_t fg, uint32_t bg,
+                                                  uint32_t scale)
 {
-    uint8_t ch = (uint8_t)c;
-    if (ch < 32 || ch > 126) ch = '?';
-    const uint8_t *glyph = font_8x8[ch - 32];
+    uint32_t cpu = hal_cpu_id();
+    if (scale > FB_TEXT_CACHE_SCALE || cpu >= HAL_MAX_CPUS) return NULL;
+
+    fb_glyph_cache_set_t *set = &g_glyph_cache[cpu];
+    for (uint32_t i = 0; i < FB_TEXT_CACHE_SLOTS; i++) {
+        const fb_glyph_cache_t *c = &set->slot[i];
+        if (c->valid && c->fg == fg && c->bg == bg &&
+            c->scale == scale && c->format == (uint32_t)fb->pixel_format) {
+            return c;
+        }
+    }
 
-    for (uint32_t row = 0; row < 8; row++) {
-        uint8_t bits = glyph[row];
-        for (uint32_t col = 0; col < 8; col++) {
-            uint32_t color = (bits & (0x80 >> col)) ? fg : bg;
-            fb_put_pixel(fb, x + col, y + row, color);
+    /* Miss: round-robin replacement, render all 16 nibble patterns */
+    fb_glyph_cache_t *c = &set->slot[set->next];
+    set->next = (set->next + 1) % FB_TEXT_CACHE_SLOTS;
+
+    const fb_pixel_ops_t *ops = fb_ops(fb);
+    for (uint32_t n = 0; n < 16; n++) {
+        for (uint32_t col = 0; col < 4; col++) {
+            bool on = (n & (0x8 >> col)) != 0;
+            ops->fill_span((uint8_t *)c->px[n], col * scale, scale, on ? fg : bg);
         }
     }
+    c->fg = fg;
+    c->bg = bg;
+    c->scale = scale;
+    c->format = (uint32_t)fb->pixel_format;
+    c->valid = true;
+    return c;
 }
 
-void fb_draw_char_transparent(framebuffer_t *fb, uint32_t x, uint32_t y, char c, uint32_t fg)
+static bool fb_text_begin(const framebuffer_t *fb, fb_text_ctx_t *t,
+                          uint32_t fg, uint32_t bg, uint32_t scale, uint32_t flags)
 {
-    uint8_t ch = (uint8_t)c;
-    if (ch < 32 || ch > 126) ch = '?';
-    const uint8_t *glyph = font_8x8[ch - 32];
+    const fb_clip_t *clip = &fb->clip_stack[fb->clip_depth];
 
-    for (uint32_t row = 0; row < 8; row++) {
-        uint8_t bits = glyph[row];
-        for (uint32_t col = 0; col < 8; col++) {
-            if (bits & (0x80 >> col)) {
-                fb_put_pixel(fb, x + col, y + row, fg);
-            }
-        }
+    t->fg = fg;
+    t->bg = bg;
+    t->scale = scale;
+    t->flags = flags;
+    t->bpp = fb_bytes_per_px(fb);
+    t->cx1 = clip->x;
+    t->cy1 = clip->y;
+    t->cx2 = min_u32(clip->x + clip->w, fb->width);
+    t->cy2 = min_u32(clip->y + clip->h, fb->height);
+    if (flags & FB_TEXT_LARGE) {
+        t->font = &font_8x16[0][0];
+        t->rows = FB_CHAR_HEIGHT_LG;
+    } else {
+        t->font = &font_8x8[0][0];
+        t->rows = FB_CHAR_HEIGHT;
     }
+    t->cache = (flags & FB_TEXT_TRANSPARENT) ? NULL
+             : fb_glyph_cache_get(fb, fg, bg, t->scale);
+
+    return t->cx2 > t->cx1 && t->cy2 > t->cy1;
 }
 
-void fb_draw_char_large(framebuffer_t *fb, uint32_t x, uint32_t y, char c, uint32_t fg, uint32_t bg)
+static inline const uint8_t *fb_text_glyph_bits(const fb_text_ctx_t *t, char c)
 {
     uint8_t ch = (uint8_t)c;
     if (ch < 32 || ch > 126) ch = '?';
-    const uint8_t *glyph = font_8x16[ch - 32];
+    return t->font + (uint32_t)(ch - 32) * t->rows;
+}
 
-    for (uint32_t row = 0; row < 16; row++) {
-        uint8_t bits = glyph[row];
-        for (uint32_t col = 0; col < 8; col++) {
-            uint32_t color = (bits & (0x80 >> col)) ? fg : bg;
-            fb_put_pixel(fb, x + col, y + row, color);
-        }
+/* Fill the set-bit runs of `bits` (MSB = leftmost) within columns [a, b) */
+static void fb_text_runs(framebuffer_t *fb, uint8_t *row, uint32_t x0,
+                         uint32_t bits, uint32_t a, uint32_t b,
+                         const fb_text_ctx_t *t)
+{
+    uint32_t m = bits << 24;
+    uint32_t col = 0;
+    while (m) {
+        uint32_t skip = bit_clz32(m);
+        m <<= skip;
+        col += skip;
+        uint32_t run = bit_clz32(~m);
+        m <<= run;
+
+        uint32_t s = max_u32(col * t->scale, a);
+        uint32_t e = min_u32((col + run) * t->scale, b);
+        if (e > s) fb_fill_span(fb, row, x0 + s, e - s, t->fg);
+        col += run;
     }
 }
 
-void fb_draw_char_large_transparent(framebuffer_t *fb, uint32_t x, uint32_t y, char c, uint32_t fg)
+/* Copy the pre-rendered glyph row for `bits` within columns [a, b) */
+static void fb_text_scanline(uint8_t *row, uint32_t x0, uint32_t bits,
+                             uint32_t a, uint32_t b, const fb_text_ctx_t *t)
 {
-    uint8_t ch = (uint8_t)c;
-    if (ch < 32 || ch > 126) ch = '?';
-    const uint8_t *glyph = font_8x16[ch - 32];
+    uint32_t half = 4 * t->scale;
+    const uint8_t *hi = (const uint8_t *)t->cache->px[(bits >> 4) & 0xF];
+    const uint8_t *lo = (const uint8_t *)t->cache->px[bits & 0xF];
 
-    for (uint32_t row = 0; row < 16; row++) {
-        uint8_t bits = glyph[row];
-        for (uint32_t col = 0; col < 8; col++) {
-            if (bits & (0x80 >> col)) {
-                fb_put_pixel(fb, x + col, y + row, fg);
-            }
+    if (a < half) {
+        uint32_t e = min_u32(b, half);
+        memcpy(row + (x0 + a) * t->bpp, hi + a * t->bpp, (e - a) * t->bpp);
+    }
+    if (b > half) {
+        uint32_t s = max_u32(a, half);
+        memcpy(row + (x0 + s) * t->bpp, lo + (s - half) * t->bpp, (b - s) * t->bpp);
+    }
+}
+
+/* Draw one glyph cell at (x, y); the cell must start inside uint32 range */
+static void fb_text_glyph(framebuffer_t *fb, const fb_text_ctx_t *t,
+                          uint32_t x, uint32_t y, const uint8_t *glyph)
+{
+    uint32_t cell_w = FB_CHAR_WIDTH * t->scale;
+    uint32_t cell_h = t->rows * t->scale;
+
+    /* Visible columns [a, b) and rows [ry1, ry2) of the cell */
+    if (x >= t->cx2 || y >= t->cy2) return;
+    if (x + cell_w <= t->cx1 || y + cell_h <= t->cy1) return;
+    uint32_t a = (x < t->cx1) ? t->cx1 - x : 0;
+    uint32_t b = min_u32(cell_w, t->cx2 - x);
+    uint32_t ry1 = (y < t->cy1) ? t->cy1 - y : 0;
+    uint32_t ry2 = min_u32(cell_h, t->cy2 - y);
+
+    for (uint32_t r = ry1; r < ry2; r++) {
+        uint32_t bits = glyph[r / t->scale];
+        uint8_t *row = fb_row(fb, y + r);
+
+        if (t->flags & FB_TEXT_TRANSPARENT) {
+            fb_text_runs(fb, row, x, bits, a, b, t);
+        } else if (t->cache) {
+            fb_text_scanline(row, x, bits, a, b, t);
+        } else {
+            fb_fill_span(fb, row, x + a, b - a, t->bg);
+            fb_text_runs(fb, row, x, bits, a, b, t);
         }
     }
 }
 
+uint32_t fb_draw_text_run(framebuffer_t *fb, uint32_t x, uint32_t y,
+                          const char *str, uint32_t fg, uint32_t bg,
+                          uint32_t scale, uint32_t flags)
+{
+    /* Zero-sized cells: nothing to draw, and the pen doesn't move */
+    if (scale == 0) return x;
+
+    if (fb_record(fb, FB_CMD_TEXT, (int32_t)x, (int32_t)y, 0, 0,
+                  scale, fg, bg, flags, str)) {
+        return x + (uint32_t)strlen_local(str) * FB_CHAR_WIDTH * scale;
+    }
+
+    /*
+     * Where the pen ends up — the last whole cell that fits on screen —
+     * is arithmetic, so it doesn't depend on drawing anything.
+     */
+    uint32_t cell_w = FB_CHAR_WIDTH * scale;
+    uint32_t cell_h = ((flags & FB_TEXT_LARGE) ? FB_CHAR_HEIGHT_LG : FB_CHAR_HEIGHT) * scale;
+    uint32_t len    = (uint32_t)strlen_local(str);
+    uint32_t fit    = (x + cell_w <= fb->width) ? (fb->width - x) / cell_w : 0;
+    uint32_t end    = x + min_u32(len, fit) * cell_w;
+
+    if (fb_culled(fb, x, y, end, (int64_t)y + cell_h)) return end;
+
+    fb_text_ctx_t t;
+    if (!fb_text_begin(fb, &t, fg, bg, scale, flags)) return end;
+
+    /* Only the cells that reach into the clip's columns */
+    uint32_t i     = (t.cx1 > x) ? (t.cx1 - x) / cell_w : 0;
+    for (uint32_t cx = x + i * cell_w; cx < end && cx < t.cx2; cx += cell_w) {
+        fb_text_glyph(fb, &t, cx, y, fb_text_glyph_bits(&t, str[i++]));
+    }
+
+    /* One dirty box for the whole run, clipped */
+    uint32_t x1 = max_u32(x, t.cx1);
+    uint32_t y1 = max_u32(y, t.cy1);
+    uint32_t x2 = min_u32(end, t.cx2);
+    uint32_t y2 = min_u32(y + t.rows * t.scale, t.cy2);
+    if (x2 > x1 && y2 > y1) fb_touch(fb, x1, y1, x2, y2);
+    return end;
+}
+
+/* Single characters: same engine, without the fb->width stop */
+static void fb_draw_char_flags(framebuffer_t *fb, uint32_t x, uint32_t y, char c,
+                               uint32_t fg, uint32_t bg, uint32_t scale,
+                               uint32_t flags)
+{
+    uint32_t ch = (flags & FB_TEXT_LARGE) ? FB_CHAR_HEIGHT_LG : FB_CHAR_HEIGHT;
+    if (scale == 0) return;
+    if (fb_culled(fb, x, y, (int64_t)x + FB_CHAR_WIDTH * scale, (int64_t)y + ch * scale)) return;
+
+    fb_text_ctx_t t;
+    if (!fb_text_begin(fb, &t, fg, bg, scale, flags)) return;
+    fb_text_glyph(fb, &t, x, y, fb_text_glyph_bits(&t, c));
+
+    uint32_t x1 = max_u32(x, t.cx1);
+    uint32_t y1 = max_u32(y, t.cy1);
+    uint32_t x2 = min_u32(x + FB_CHAR_WIDTH * t.scale, t.cx2);
+    uint32_t y2 = min_u32(y + t.rows * t.scale, t.cy2);
+    if (x2 > x1 && y2 > y1) fb_touch(fb, x1, y1, x2, y2);
+}
+
+void fb_draw_char(framebuffer_t *fb, uint32_t x, uint32_t y, char c, uint32_t fg, uint32_t bg)
+{
+    fb_draw_char_flags(fb, x, y, c, fg, bg, 1, 0);
+}
+
+void fb_draw_char_transparent(framebuffer_t *fb, uint32_t x, uint32_t y, char c, uint32_t fg)
+{
+    fb_draw_char_flags(fb, x, y, c, fg, 0, 1, FB_TEXT_TRANSPARENT);
+}
+
+void fb_draw_char_large(framebuffer_t *fb, uint32_t x, uint32_t y, char c, uint32_t fg, uint32_t bg)
+{
+    fb_draw_char_flags(fb, x, y, c, fg, bg, 1, FB_TEXT_LARGE);
+}
+
+void fb_draw_char_large_transparent(framebuffer_t *fb, uint32_t x, uint32_t y, char c, uint32_t fg)
+{
+    fb_draw_char_flags(fb, x, y, c, fg, 0, 1, FB_TEXT_LARGE | FB_TEXT_TRANSPARENT);
+}
+
 void fb_draw_char_scaled(framebuffer_t *fb, uint32_t x, uint32_t y, char c,
                          uint32_t fg, uint32_t bg, uint32_t scale)
 {
-    uint8_t ch = (uint8_t)c;
-    if (ch < 32 || ch > 126) ch = '?';
-    const uint8_t *glyph = font_8x8[ch - 32];
-
-    for (uint32_t row = 0; row < 8; row++) {
-        uint8_t bits = glyph[row];
-        for (uint32_t col = 0; col < 8; col++) {
-            uint32_t color = (bits & (0x80 >> col)) ? fg : bg;
-            for (uint32_t sy = 0; sy < scale; sy++) {
-                for (uint32_t sx = 0; sx < scale; sx++) {
-                    fb_put_pixel(fb, x + col * scale + sx, y + row * scale + sy, color);
-                }
-            }
-        }
-    }
+    fb_draw_char_flags(fb, x, y, c, fg, bg, scale, 0);
 }
 
 void fb_draw_string(framebuffer_t *fb, uint32_t x, uint32_t y, const char *str, uint32_t fg, uint32_t bg)
 {
-    while (*str) {
-        if (x + FB_CHAR_WIDTH > fb->width) break;
-        fb_draw_char(fb, x, y, *str++, fg, bg);
-        x += FB_CHAR_WIDTH;
-    }
+    fb_draw_text_run(fb, x, y, str, fg, bg, 1, 0);
 }
 
 void fb_draw_string_transparent(framebuffer_t *fb, uint32_t x, uint32_t y, const char *str, uint32_t fg)
 {
-    while (*str) {
-        if (x + FB_CHAR_WIDTH > fb->width) break;
-        fb_draw_char_transparent(fb, x, y, *str++, fg);
-        x += FB_CHAR_WIDTH;
-    }
+    fb_draw_text_run(fb, x, y, str, fg, 0, 1, FB_TEXT_TRANSPARENT);
 }
 
 void fb_draw_string_large(framebuffer_t *fb, uint32_t x, uint32_t y, const char *str, uint32_t fg, uint32_t bg)
 {
-    while (*str) {
-        if (x + FB_CHAR_WIDTH_LG > fb->width) break;
-        fb_draw_char_large(fb, x, y, *str++, fg, bg);
-        x += FB_CHAR_WIDTH_LG;
-    }
+    fb_draw_text_run(fb, x, y, str, fg, bg, 1, FB_TEXT_LARGE);
 }
 
 void fb_draw_string_large_transparent(framebuffer_t *fb, uint32_t x, uint32_t y, const char *str, uint32_t fg)
 {
-    while (*str) {
-        if (x + FB_CHAR_WIDTH_LG > fb->width) break;
-        fb_draw_char_large_transparent(fb, x, y, *str++, fg);
-        x += FB_CHAR_WIDTH_LG;
-    }
+    fb_draw_text_run(fb, x, y, str, fg, 0, 1, FB_TEXT_LARGE | FB_TEXT_TRANSPARENT);
 }
 
 void fb_draw_string_scaled(framebuffer_t *fb, uint32_t x, uint32_t y, const char *str,
                            uint32_t fg, uint32_t bg, uint32_t scale)
 {
-    uint32_t char_w = FB_CHAR_WIDTH * scale;
-    while (*str) {
-        if (x + char_w > fb->width) break;
-        fb_draw_char_scaled(fb, x, y, *str++, fg, bg, scale);
-        x += char_w;
-    }
+    fb_draw_text_run(fb, x, y, str, fg, bg, scale, 0);
 }
 
 void fb_draw_string_scaled_transparent(framebuffer_t *fb, uint32_t x, uint32_t y,
                                        const char *str, uint32_t fg, uint32_t scale)
 {
-    if (scale <= 1) {
-        fb_draw_string_transparent(fb, x, y, str, fg);
-        return;
-    }
-    uint32_t char_w = FB_CHAR_WIDTH * scale;
-    while (*str) {
-        if (x + char_w > fb->width) break;
-        /* Draw only set pixels — skip background pixels entirely */
-        uint8_t ch = (uint8_t)*str;
-        if (ch < 32 || ch > 126) ch = '?';
-        const uint8_t *glyph = font_8x8[ch - 32];
-        for (uint32_t row = 0; row < 8; row++) {
-            uint8_t bits = glyph[row];
-            for (uint32_t col = 0; col < 8; col++) {
-                if (bits & (0x80 >> col)) {
-                    for (uint32_t sy = 0; sy < scale; sy++)
-                        for (uint32_t sx = 0; sx < scale; sx++)
-                            fb_put_pixel(fb, x + col*scale + sx,
-                                            y + row*scale + sy, fg);
-                }
-            }
-        }
-        x += char_w;
-        str++;
+    fb_draw_text_run(fb, x, y, str, fg, 0, scale, FB_TEXT_TRANSPARENT);
+}
+
+/*
+ * fb_replay_cmd() — run a recorded command in immediate mode.
+ *
+ * The recorded clip is pushed on top of whatever the caller has pushed,
+ * so a display list can further restrict replay to its damaged tiles.
+ */
+void fb_replay_cmd(framebuffer_t *fb, const fb_cmd_t *cmd, const char *text)
+{
+    fb_rect_t clip = { (int32_t)cmd->clip.x, (int32_t)cmd->clip.y,
+                       cmd->clip.w, cmd->clip.h };
+    if (!fb_push_clip(fb, clip)) return;
+
+    uint32_t x = (uint32_t)cmd->x, y = (uint32_t)cmd->y;
+    uint32_t w = (uint32_t)cmd->w, h = (uint32_t)cmd->h;
+
+    switch (cmd->op) {
+    case FB_CMD_FILL_RECT:    fb_fill_rect(fb, x, y, w, h, cmd->color); break;
+    case FB_CMD_FILL_BLEND:   fb_fill_rect_blend(fb, x, y, w, h, cmd->color); break;
+    case FB_CMD_FILL_ROUNDED: fb_fill_rounded_rect(fb, x, y, w, h, cmd->r, cmd->color); break;
+    case FB_CMD_FILL_ROUNDED_BLEND:
+        fb_fill_rounded_rect_blend(fb, x, y, w, h, cmd->r, cmd->color);
+        break;
+    case FB_CMD_DRAW_ROUNDED: fb_draw_rounded_rect(fb, x, y, w, h, cmd->r, cmd->color); break;
+    case FB_CMD_GRADIENT_V:   fb_fill_rect_gradient_v(fb, x, y, w, h, cmd->color, cmd->color2); break;
+    case FB_CMD_GRADIENT_H:   fb_fill_rect_gradient_h(fb, x, y, w, h, cmd->color, cmd->color2); break;
+    case FB_CMD_HLINE:        fb_draw_hline(fb, x, y, w, cmd->color); break;
+    case FB_CMD_VLINE:        fb_draw_vline(fb, x, y, h, cmd->color); break;
+    case FB_CMD_LINE:         fb_draw_line(fb, cmd->x, cmd->y, cmd->w, cmd->h, cmd->color); break;
+    case FB_CMD_FILL_CIRCLE:  fb_fill_circle(fb, cmd->x, cmd->y, cmd->r, cmd->color); break;
+    case FB_CMD_DRAW_CIRCLE:  fb_draw_circle(fb, cmd->x, cmd->y, cmd->r, cmd->color); break;
+    case FB_CMD_TEXT:
+        if (text) fb_draw_text_run(fb, x, y, text, cmd->color, cmd->color2, cmd->r, cmd->flags);
+        break;
+    case FB_CMD_SURFACE:
+        fb_draw_surface(fb, (const fb_surface_t *)cmd->src, cmd->x, cmd->y, w, h);
+        break;
+    default:
+        break;
     }
+
+    fb_pop_clip(fb);
 }
 
 void fb_draw_string_centered(framebuffer_t *fb, uint32_t y, const char *str, uint32_t fg, uint32_t bg)
@@ -1729,8 +3205,9 @@ uint32_t fb_text_width_large(const char *str)
 /* =============================================================================
  * BITMAP BLITTING — FORMAT-AWARE
  * =============================================================================
- * Bitmap source data is always ARGB8888. On RGB565 framebuffers, each
- * source pixel is converted via fb_write_px/fb_read_px.
+ * Bitmap source data is always ARGB8888. Each destination row is one call
+ * into the format's blit_row[] — the blend mode is picked per blit, the
+ * pixel format per framebuffer, and neither is tested per pixel.
  */
 
 void fb_blit_bitmap(framebuffer_t *fb, int32_t x, int32_t y, const fb_bitmap_t *bitmap)
@@ -1743,60 +3220,100 @@ void fb_blit_bitmap_alpha(framebuffer_t *fb, int32_t x, int32_t y, const fb_bitm
     fb_blit_bitmap_blend(fb, x, y, bitmap, FB_BLEND_ALPHA);
 }
 
-void fb_blit_bitmap_blend(framebuffer_t *fb, int32_t x, int32_t y, const fb_bitmap_t *bitmap,
-                          fb_blend_mode_t blend)
+/*
+ * Band context for the blitters. Bands are destination rows relative to
+ * dst_y; (src_x, src_y) is the bitmap texel that lands on (dst_x, dst_y).
+ */
+typedef struct {
+    const framebuffer_t *fb;
+    const fb_bitmap_t   *bitmap;
+    const fb_rle_image_t *rle;      /* fb_draw_rle instead of bitmap */
+    uint32_t src_x, src_y;
+    uint32_t dst_x, dst_y, w;
+    uint32_t scale_x, scale_y;      /* Scaled blit: offsets into the scaled image */
+    fb_blend_mode_t blend;
+    bool     stream;                /* Opaque and past the stream size */
+} fb_blit_job_t;
+
+static void fb_blit_band(void *ctx, uint32_t lo, uint32_t hi)
 {
-    if (!bitmap || !bitmap->data) return;
+    const fb_blit_job_t *j = (const fb_blit_job_t *)ctx;
+    const framebuffer_t *fb = j->fb;
+    const fb_bitmap_t *bitmap = j->bitmap;
+    const fb_pixel_ops_t *ops = fb_ops(fb);
+    void (*blit_row)(uint8_t *, uint32_t, const uint32_t *, uint32_t) =
+        j->stream ? ops->stream_row :
+        (j->blend == FB_BLEND_ALPHA && (bitmap->flags & FB_BITMAP_PREMULTIPLIED))
+            ? ops->blit_row_premul : ops->blit_row[j->blend];
+
+    for (uint32_t row = lo; row < hi; row++) {
+        const uint32_t *src = bitmap->data + (j->src_y + row) * bitmap->width + j->src_x;
+        blit_row(fb_row(fb, j->dst_y + row), j->dst_x, src, j->w);
+    }
+}
 
+/*
+ * Clip the destination rect [x, x+w) × [y, y+h) against the clip rect and
+ * the screen. Returns false if nothing is left; otherwise *j gets the
+ * clipped origin and width, and *h_out the clipped height.
+ */
+static bool fb_blit_clip(const framebuffer_t *fb, int32_t x, int32_t y,
+                         uint32_t w, uint32_t h, fb_blit_job_t *j, uint32_t *h_out)
+{
     const fb_clip_t *clip = &fb->clip_stack[fb->clip_depth];
 
-    uint32_t src_x = (x < (int32_t)clip->x) ? ((int32_t)clip->x - x) : 0;
-    uint32_t src_y = (y < (int32_t)clip->y) ? ((int32_t)clip->y - y) : 0;
+    j->src_x = (x < (int32_t)clip->x) ? (uint32_t)((int32_t)clip->x - x) : 0;
+    j->src_y = (y < (int32_t)clip->y) ? (uint32_t)((int32_t)clip->y - y) : 0;
+    if (j->src_x >= w || j->src_y >= h) return false;
 
-    uint32_t dst_x = (uint32_t)max_i32(x, (int32_t)clip->x);
-    uint32_t dst_y = (uint32_t)max_i32(y, (int32_t)clip->y);
+    j->dst_x = (uint32_t)max_i32(x, (int32_t)clip->x);
+    j->dst_y = (uint32_t)max_i32(y, (int32_t)clip->y);
+    if (j->dst_x >= clip->x + clip->w || j->dst_y >= clip->y + clip->h) return false;
 
-    uint32_t w = bitmap->width - src_x;
-    if (dst_x + w > clip->x + clip->w) w = clip->x + clip->w - dst_x;
-    if (dst_x + w > fb->width) w = fb->width - dst_x;
+    uint32_t cw = w - j->src_x;
+    if (j->dst_x + cw > clip->x + clip->w) cw = clip->x + clip->w - j->dst_x;
+    if (j->dst_x + cw > fb->width) cw = fb->width - j->dst_x;
 
-    uint32_t h = bitmap->height - src_y;
-    if (dst_y + h > clip->y + clip->h) h = clip->y + clip->h - dst_y;
-    if (dst_y + h > fb->height) h = fb->height - dst_y;
+    uint32_t ch = h - j->src_y;
+    if (j->dst_y + ch > clip->y + clip->h) ch = clip->y + clip->h - j->dst_y;
+    if (j->dst_y + ch > fb->height) ch = fb->height - j->dst_y;
 
-    if (w == 0 || h == 0) return;
+    if (cw == 0 || ch == 0) return false;
 
-    for (uint32_t row = 0; row < h; row++) {
-        uint32_t src_row = (src_y + row) * bitmap->width;
-        uint8_t *dst_row = fb_row(fb, dst_y + row);
-
-        for (uint32_t col = 0; col < w; col++) {
-            uint32_t src_pixel = bitmap->data[src_row + src_x + col];
-
-            switch (blend) {
-                case FB_BLEND_OPAQUE:
-                    fb_write_px(fb, dst_row, dst_x + col, src_pixel);
-                    break;
-                case FB_BLEND_ALPHA: {
-                    uint32_t dst_pixel = fb_read_px(fb, dst_row, dst_x + col);
-                    fb_write_px(fb, dst_row, dst_x + col, fb_blend_alpha(src_pixel, dst_pixel));
-                    break;
-                }
-                case FB_BLEND_ADDITIVE: {
-                    uint32_t dst_pixel = fb_read_px(fb, dst_row, dst_x + col);
-                    fb_write_px(fb, dst_row, dst_x + col, fb_blend_additive(src_pixel, dst_pixel));
-                    break;
-                }
-                case FB_BLEND_MULTIPLY: {
-                    uint32_t dst_pixel = fb_read_px(fb, dst_row, dst_x + col);
-                    fb_write_px(fb, dst_row, dst_x + col, fb_blend_multiply(src_pixel, dst_pixel));
-                    break;
-                }
-            }
-        }
-    }
+    j->w = cw;
+    *h_out = ch;
+    return true;
+}
 
-    fb_mark_dirty(fb, dst_x, dst_y, w, h);
+void fb_blit_bitmap_blend(framebuffer_t *fb, int32_t x, int32_t y, const fb_bitmap_t *bitmap,
+                          fb_blend_mode_t blend)
+{
+    if (!bitmap || !bitmap->data || (uint32_t)blend >= FB_BLEND_MODES) return;
+
+    fb_blit_job_t j = { .fb = fb, .bitmap = bitmap, .blend = blend };
+    uint32_t h;
+    if (!fb_blit_clip(fb, x, y, bitmap->width, bitmap->height, &j, &h)) return;
+    fb_dma_sync(fb);
+
+    j.stream = blend == FB_BLEND_OPAQUE &&
+               fb_streams(fb, (uint64_t)j.w * h * fb_bytes_per_px(fb));
+    fb_parallel(h, j.w, 1, fb_blit_band, &j);
+    fb_mark_dirty(fb, j.dst_x, j.dst_y, j.w, h);
+}
+
+/* Nearest-neighbour: (src_x, src_y) here index the scaled image */
+static void fb_blit_scaled_band(void *ctx, uint32_t lo, uint32_t hi)
+{
+    const fb_blit_job_t *j = (const fb_blit_job_t *)ctx;
+    const fb_bitmap_t *bitmap = j->bitmap;
+    const fb_pixel_ops_t *ops = fb_ops(j->fb);
+
+    for (uint32_t row = lo; row < hi; row++) {
+        const uint32_t *src = bitmap->data +
+                              ((j->src_y + row) / j->scale_y) * bitmap->width;
+        ops->blit_row_scaled(fb_row(j->fb, j->dst_y + row), j->dst_x,
+                             src, j->src_x, j->scale_x, j->w);
+    }
 }
 
 void fb_blit_bitmap_scaled(framebuffer_t *fb, int32_t x, int32_t y, const fb_bitmap_t *bitmap,
@@ -1804,20 +3321,29 @@ void fb_blit_bitmap_scaled(framebuffer_t *fb, int32_t x, int32_t y, const fb_bit
 {
     if (!bitmap || !bitmap->data || scale_x == 0 || scale_y == 0) return;
 
-    uint32_t dst_w = bitmap->width * scale_x;
-    uint32_t dst_h = bitmap->height * scale_y;
-
-    for (uint32_t dy = 0; dy < dst_h; dy++) {
-        uint32_t src_y = dy / scale_y;
-        for (uint32_t dx = 0; dx < dst_w; dx++) {
-            uint32_t src_x = dx / scale_x;
-            uint32_t pixel = bitmap->data[src_y * bitmap->width + src_x];
-            int32_t px = x + (int32_t)dx;
-            int32_t py = y + (int32_t)dy;
-            if (px >= 0 && py >= 0) {
-                fb_put_pixel(fb, (uint32_t)px, (uint32_t)py, pixel);
-            }
-        }
+    fb_blit_job_t j = { .fb = fb, .bitmap = bitmap, .scale_x = scale_x, .scale_y = scale_y };
+    uint32_t h;
+    if (!fb_blit_clip(fb, x, y, bitmap->width * scale_x, bitmap->height * scale_y,
+                      &j, &h)) return;
+    fb_dma_sync(fb);
+
+    fb_parallel(h, j.w, 1, fb_blit_scaled_band, &j);
+    fb_mark_dirty(fb, j.dst_x, j.dst_y, j.w, h);
+}
+
+/* Sub-rectangle of a sheet, src-over, fully transparent texels skipped */
+static void fb_blit_region_band(void *ctx, uint32_t lo, uint32_t hi)
+{
+    const fb_blit_job_t *j = (const fb_blit_job_t *)ctx;
+    const framebuffer_t *fb = j->fb;
+    const fb_pixel_ops_t *ops = fb_ops(fb);
+    void (*blit_row)(uint8_t *, uint32_t, const uint32_t *, uint32_t) =
+        (j->bitmap->flags & FB_BITMAP_PREMULTIPLIED) ? ops->blit_row_premul
+                                                     : ops->blit_row[FB_BLEND_ALPHA];
+
+    for (uint32_t row = lo; row < hi; row++) {
+        const uint32_t *src = j->bitmap->data + (j->src_y + row) * j->bitmap->width;
+        blit_row(fb_row(fb, j->dst_y + row), j->dst_x, src + j->src_x, j->w);
     }
 }
 
@@ -1827,77 +3353,475 @@ void fb_blit_bitmap_region(framebuffer_t *fb, const fb_bitmap_t *bitmap,
 {
     if (!bitmap || !bitmap->data) return;
 
-    for (uint32_t row = 0; row < src_h; row++) {
-        for (uint32_t col = 0; col < src_w; col++) {
-            uint32_t pixel = bitmap->data[(src_y + row) * bitmap->width + src_x + col];
-            int32_t px = dst_x + (int32_t)col;
-            int32_t py = dst_y + (int32_t)row;
-            if (px >= 0 && py >= 0 && FB_ALPHA(pixel) > 0) {
-                fb_put_pixel_blend(fb, (uint32_t)px, (uint32_t)py, pixel);
+    fb_blit_job_t j = { .fb = fb, .bitmap = bitmap };
+    uint32_t h;
+    if (!fb_blit_clip(fb, dst_x, dst_y, src_w, src_h, &j, &h)) return;
+    fb_dma_sync(fb);
+
+    j.src_x += src_x;
+    j.src_y += src_y;
+    fb_parallel(h, j.w, 1, fb_blit_region_band, &j);
+    fb_mark_dirty(fb, j.dst_x, j.dst_y, j.w, h);
+}
+
+/* =============================================================================
+ * OFF-SCREEN SURFACES
+ * =============================================================================
+ *
+ * An opaque surface has the target's format, so restoring from it is the
+ * same memcpy per row fb_copy_rect() does within one buffer. An overlay
+ * is ARGB8888 rows, which is what the format's alpha blit_row[] already
+ * takes from a bitmap — it just strides by the surface's pitch.
+ */
+
+static bool fb_surface_alloc(fb_surface_t *s, fb_pixel_format_t format, uint32_t pitch,
+                             int32_t x, int32_t y, uint32_t w, uint32_t h)
+{
+    *s = (fb_surface_t){0};
+    if (w == 0 || h == 0 || fb_format_ops(format) == NULL) return false;
+
+    size_t size = (size_t)pitch * h;
+    uint32_t *mem = heap_alloc_aligned(size, 64);
+    if (mem == NULL) return false;
+
+    framebuffer_t *f = &s->fb;
+    f->addr           = mem;
+    f->width          = w;
+    f->height         = h;
+    f->pitch          = pitch;
+    f->buffer_size    = size;
+    f->virtual_height = h;
+
+    /* One buffer: nothing scans a surface out, so nothing flips */
+    for (uint32_t b = 0; b < FB_BUFFER_COUNT; b++) f->buffers[b] = mem;
+
+    f->clip_stack[0] = (fb_clip_t){ 0, 0, w, h };
+    f->pixel_format  = format;
+    f->mem_type      = FB_MEM_CACHED;
+    f->initialized   = fb_format_bind(f);
+
+    s->x = x;
+    s->y = y;
+    return f->initialized;
+}
+
+bool fb_surface_create(fb_surface_t *s, const framebuffer_t *like,
+                       int32_t x, int32_t y, uint32_t w, uint32_t h)
+{
+    uint32_t bpp   = fb_bytes_per_px(like);
+    uint32_t pitch = (w == like->width) ? like->pitch : (w * bpp + 63) & ~63u;
+
+    if (!fb_surface_alloc(s, like->pixel_format, pitch, x, y, w, h)) return false;
+    s->blend = FB_BLEND_OPAQUE;
+    return true;
+}
+
+bool fb_surface_create_overlay(fb_surface_t *s, int32_t x, int32_t y,
+                               uint32_t w, uint32_t h)
+{
+    if (!fb_surface_alloc(s, FB_FORMAT_ARGB8888, w * 4, x, y, w, h)) return false;
+    s->blend = FB_BLEND_ALPHA;
+    fb_clear(&s->fb, 0x00000000);
+    return true;
+}
+
+void fb_surface_destroy(fb_surface_t *s)
+{
+    if (s->fb.initialized) heap_free(s->fb.buffers[0]);
+    *s = (fb_surface_t){0};
+}
+
+typedef struct {
+    const framebuffer_t *fb;
+    const framebuffer_t *src;
+    uint32_t src_x, src_y;
+    uint32_t dst_x, dst_y, w;
+    bool     copy;              /* Same format, opaque: plain row copies */
+} fb_surface_job_t;
+
+static void fb_surface_band(void *ctx, uint32_t lo, uint32_t hi)
+{
+    const fb_surface_job_t *j = (const fb_surface_job_t *)ctx;
+    const fb_pixel_ops_t *ops = fb_ops(j->fb);
+    uint32_t bpp = fb_bytes_per_px(j->fb);
+
+    for (uint32_t row = lo; row < hi; row++) {
+        uint8_t       *dst = fb_row(j->fb, j->dst_y + row);
+        const uint8_t *src = fb_row(j->src, j->src_y + row);
+
+        if (j->copy) {
+            memcpy(dst + (size_t)j->dst_x * bpp, src + (size_t)j->src_x * bpp,
+                   (size_t)j->w * bpp);
+        } else {
+            ops->blit_row[FB_BLEND_ALPHA](dst, j->dst_x,
+                                          (const uint32_t *)(const void *)src + j->src_x,
+                                          j->w);
+        }
+    }
+}
+
+void fb_draw_surface(framebuffer_t *fb, const fb_surface_t *s,
+                     int32_t x, int32_t y, uint32_t w, uint32_t h)
+{
+    if (s == NULL || !s->fb.initialized) return;
+
+    if (fb->recorder) {
+        fb_cmd_t cmd = {
+            .op = FB_CMD_SURFACE, .x = x, .y = y, .w = (int32_t)w, .h = (int32_t)h,
+            .clip = fb->clip_stack[fb->clip_depth], .src = s,
+        };
+        fb->recorder->record(fb->recorder, &cmd, NULL);
+        return;
+    }
+
+    /* The requested rectangle, cut down to what the surface covers */
+    int64_t x1 = max_i32(x, s->x);
+    int64_t y1 = max_i32(y, s->y);
+    int64_t x2 = (int64_t)x + w, sx2 = (int64_t)s->x + s->fb.width;
+    int64_t y2 = (int64_t)y + h, sy2 = (int64_t)s->y + s->fb.height;
+    if (sx2 < x2) x2 = sx2;
+    if (sy2 < y2) y2 = sy2;
+    if (x2 <= x1 || y2 <= y1) return;
+
+    fb_blit_job_t c = {0};
+    uint32_t rows;
+    if (!fb_blit_clip(fb, (int32_t)x1, (int32_t)y1, (uint32_t)(x2 - x1),
+                      (uint32_t)(y2 - y1), &c, &rows)) return;
+
+    bool copy = s->blend == FB_BLEND_OPAQUE;
+    if (copy && s->fb.pixel_format != fb->pixel_format) return;
+    if (!copy && s->fb.pixel_format != FB_FORMAT_ARGB8888) return;
+    fb_dma_sync(fb);
+
+    fb_surface_job_t j = {
+        .fb = fb, .src = &s->fb,
+        .src_x = (uint32_t)(x1 - s->x) + c.src_x,
+        .src_y = (uint32_t)(y1 - s->y) + c.src_y,
+        .dst_x = c.dst_x, .dst_y = c.dst_y, .w = c.w,
+        .copy = copy,
+    };
+    fb_parallel(rows, j.w, 1, fb_surface_band, &j);
+    fb_mark_dirty(fb, j.dst_x, j.dst_y, j.w, rows);
+}
+
+void fb_composite(framebuffer_t *fb, const fb_surface_t *const *layers,
+                  uint32_t count, int32_t x, int32_t y, uint32_t w, uint32_t h)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        fb_draw_surface(fb, layers[i], x, y, w, h);
+    }
+}
+
+/*
+ * Compressed assets (fb_rle_image_t). Each op is clipped to the visible
+ * source columns [a, b) and lands at dst_x + (col - a). Runs go to the
+ * span kernels by their color's alpha; a literal run is expanded through
+ * the palette into FB_RLE_MAX_RUN texels on the stack — the only staging
+ * there is — and blitted as one alpha row.
+ */
+static void fb_rle_row(const fb_pixel_ops_t *ops, uint8_t *row,
+                       const fb_rle_image_t *img, const uint8_t *p,
+                       uint32_t a, uint32_t b, uint32_t dst_x)
+{
+    uint32_t col = 0;
+
+    while (col < b) {
+        uint8_t  op = *p++;
+        uint32_t n  = (op & 0x3Fu) + 1;
+        uint32_t s  = max_u32(col, a);
+        uint32_t e  = min_u32(col + n, b);
+
+        switch (op >> 6) {
+            case FB_RLE_SKIP:
+                break;
+
+            case FB_RLE_RUN: {
+                uint32_t color = img->palette[*p++];
+                uint32_t alpha = FB_ALPHA(color);
+                if (e <= s || alpha == 0) break;
+                if (alpha == 255) {
+                    ops->fill_span(row, dst_x + s - a, e - s, color);
+                } else {
+                    ops->blend_span(row, dst_x + s - a, e - s, color);
+                }
+                break;
             }
+
+            case FB_RLE_LITERAL:
+                if (e > s) {
+                    uint32_t texels[FB_RLE_MAX_RUN];
+                    for (uint32_t i = s; i < e; i++) {
+                        texels[i - s] = img->palette[p[i - col]];
+                    }
+                    ops->blit_row[FB_BLEND_ALPHA](row, dst_x + s - a, texels, e - s);
+                }
+                p += n;
+                break;
+
+            default:
+                return;     /* Not a valid op: stop rather than run wild */
         }
+        col += n;
+    }
+}
+
+static void fb_rle_band(void *ctx, uint32_t lo, uint32_t hi)
+{
+    const fb_blit_job_t  *j   = (const fb_blit_job_t *)ctx;
+    const fb_rle_image_t *img = j->rle;
+    const fb_pixel_ops_t *ops = fb_ops(j->fb);
+
+    for (uint32_t row = lo; row < hi; row++) {
+        fb_rle_row(ops, fb_row(j->fb, j->dst_y + row), img,
+                   img->data + img->rows[j->src_y + row],
+                   j->src_x, j->src_x + j->w, j->dst_x);
     }
 }
 
+void fb_draw_rle(framebuffer_t *fb, int32_t x, int32_t y, const fb_rle_image_t *img)
+{
+    if (!img || !img->data || !img->rows || !img->palette) return;
+
+    fb_blit_job_t j = { .fb = fb, .rle = img };
+    uint32_t h;
+    if (!fb_blit_clip(fb, x, y, img->width, img->height, &j, &h)) return;
+    fb_dma_sync(fb);
+
+    fb_parallel(h, j.w, 1, fb_rle_band, &j);
+    fb_mark_dirty(fb, j.dst_x, j.dst_y, j.w, h);
+}
+
 
 /* =============================================================================
  * SCREEN OPERATIONS — FORMAT-AWARE
  * =============================================================================
  */
 
+/*
+ * fb_copy_rect() moves whole row segments with memmove() — overlap within a
+ * row (horizontal scroll) is memmove's problem, overlap between rows is
+ * handled by walking rows bottom-up when the destination is below the
+ * source.
+ *
+ * Choosing the bands:
+ *
+ *   Same row (dy == 0), or src and dst rows disjoint (|dy| >= h):
+ *       every row is independent — split into row bands.
+ *
+ *   Vertical overlap with dx == 0 (fb_scroll_v):
+ *       row N's destination is row N+dy's source, so row bands would race.
+ *       Columns never interact, though: split into column strips and let
+ *       each strip walk all rows in the safe order.
+ *
+ *   Anything else (diagonal overlap): one band, on this core.
+ */
+#define FB_COPY_STRIP_ALIGN 16      /* Pixels: strips start on a cache line */
+
+typedef struct {
+    const framebuffer_t *fb;
+    uint32_t src_x, src_y, dst_x, dst_y, w, h;
+    bool     bottom_up;
+} fb_copy_job_t;
+
+static inline void fb_copy_row(const fb_copy_job_t *j, uint32_t row,
+                               uint32_t col, uint32_t count)
+{
+    uint32_t bpp = fb_bytes_per_px(j->fb);
+    memmove(fb_row(j->fb, j->dst_y + row) + (size_t)(j->dst_x + col) * bpp,
+            fb_row(j->fb, j->src_y + row) + (size_t)(j->src_x + col) * bpp,
+            (size_t)count * bpp);
+}
+
+static void fb_copy_rows_band(void *ctx, uint32_t lo, uint32_t hi)
+{
+    const fb_copy_job_t *j = (const fb_copy_job_t *)ctx;
+
+    if (j->bottom_up) {
+        for (uint32_t row = hi; row > lo; row--) fb_copy_row(j, row - 1, 0, j->w);
+    } else {
+        for (uint32_t row = lo; row < hi; row++) fb_copy_row(j, row, 0, j->w);
+    }
+}
+
+static void fb_copy_cols_band(void *ctx, uint32_t lo, uint32_t hi)
+{
+    const fb_copy_job_t *j = (const fb_copy_job_t *)ctx;
+
+    if (j->bottom_up) {
+        for (uint32_t row = j->h; row > 0; row--) fb_copy_row(j, row - 1, lo, hi - lo);
+    } else {
+        for (uint32_t row = 0; row < j->h; row++) fb_copy_row(j, row, lo, hi - lo);
+    }
+}
+
 void fb_copy_rect(framebuffer_t *fb, uint32_t src_x, uint32_t src_y,
                   uint32_t dst_x, uint32_t dst_y, uint32_t w, uint32_t h)
 {
-    if (fb->pixel_format == FB_FORMAT_RGB565) {
-        /* RGB565: copy 2 bytes per pixel, no format conversion needed */
-        if (src_y < dst_y || (src_y == dst_y && src_x < dst_x)) {
-            /* Copy bottom-to-top, right-to-left */
-            for (uint32_t row = h; row > 0; row--) {
-                uint16_t *sr = (uint16_t *)fb_row(fb, src_y + row - 1);
-                uint16_t *dr = (uint16_t *)fb_row(fb, dst_y + row - 1);
-                for (uint32_t col = w; col > 0; col--) {
-                    dr[dst_x + col - 1] = sr[src_x + col - 1];
-                }
-            }
-        } else {
-            /* Copy top-to-bottom, left-to-right */
-            for (uint32_t row = 0; row < h; row++) {
-                uint16_t *sr = (uint16_t *)fb_row(fb, src_y + row);
-                uint16_t *dr = (uint16_t *)fb_row(fb, dst_y + row);
-                for (uint32_t col = 0; col < w; col++) {
-                    dr[dst_x + col] = sr[src_x + col];
-                }
-            }
-        }
+    if (w == 0 || h == 0) return;
+
+    hal_dma_2d_t x;
+    if (fb_dma_usable(fb, (uint64_t)w * h * fb_bytes_per_px(fb)) &&
+        fb_dma_copy_desc(fb, src_x, src_y, dst_x, dst_y, w, h, &x) &&
+        fb_dma_submit(fb, &x, 1)) {
+        fb_mark_dirty(fb, dst_x, dst_y, w, h);
+        return;
+    }
+    fb_dma_sync(fb);
+
+    fb_copy_job_t j = {
+        .fb = fb, .src_x = src_x, .src_y = src_y, .dst_x = dst_x, .dst_y = dst_y,
+        .w = w, .h = h, .bottom_up = src_y < dst_y,
+    };
+    uint32_t dy = (src_y > dst_y) ? src_y - dst_y : dst_y - src_y;
+
+    if (dy == 0 || dy >= h) {
+        fb_parallel(h, w, 1, fb_copy_rows_band, &j);
+    } else if (src_x == dst_x) {
+        fb_parallel(w, h, FB_COPY_STRIP_ALIGN, fb_copy_cols_band, &j);
     } else {
-        /* ARGB8888: copy 4 bytes per pixel */
-        uint32_t pitch_words = fb->pitch / 4;
-
-        /* Handle overlapping regions by copying in the right order */
-        if (src_y < dst_y || (src_y == dst_y && src_x < dst_x)) {
-            /* Copy bottom-to-top, right-to-left */
-            for (uint32_t row = h; row > 0; row--) {
-                for (uint32_t col = w; col > 0; col--) {
-                    uint32_t src_idx = (src_y + row - 1) * pitch_words + (src_x + col - 1);
-                    uint32_t dst_idx = (dst_y + row - 1) * pitch_words + (dst_x + col - 1);
-                    uint32_t pixel = READ_VOLATILE(&fb->addr[src_idx]);
-                    WRITE_VOLATILE(&fb->addr[dst_idx], pixel);
-                }
-            }
+        fb_copy_rows_band(&j, 0, h);
+    }
+
+    fb_mark_dirty(fb, dst_x, dst_y, w, h);
+}
+
+/* =============================================================================
+ * HARDWARE SCROLL RING
+ * =============================================================================
+ *
+ * See fb_set_scroll_ring() in framebuffer.h. Only a display whose scan-out
+ * offset we set ourselves can do this — fb_flip_display() above reads
+ * scroll_top — so everywhere else the ring stays off and fb_scroll_v()
+ * copies as before.
+ */
+
+/* Point addr and both buffer slots at the window starting at ring row `top` */
+static void fb_ring_set_window(framebuffer_t *fb, uint32_t top)
+{
+    uint32_t *window = (uint32_t *)(void *)((uint8_t *)fb->scroll_base +
+                                            (size_t)top * fb->pitch);
+    fb->scroll_top = top;
+    for (uint32_t i = 0; i < FB_BUFFER_COUNT; i++) fb->buffers[i] = window;
+    fb->addr = window;
+}
+
+bool fb_set_scroll_ring(framebuffer_t *fb, bool enabled)
+{
+    if (!fb->initialized) return false;
+    if (enabled == (fb->scroll_rows != 0)) return true;
+
+    if (!HAS_BCM_MAILBOX || fb->virtual_height < 2 * fb->height) return false;
+
+    /* Nothing in flight may still be reading or writing the old layout */
+    fb_wait_scanout(fb, true);
+    fb_dma_wait(fb);
+
+    if (enabled) {
+        /* Start the window on whatever is showing, so nothing moves */
+        uint32_t top = fb->scan_buffer * fb->height;
+
+        fb->scroll_base  = fb->buffers[0];
+        fb->scroll_rows  = fb->virtual_height;
+        fb->front_buffer = fb->scan_buffer;
+        fb->back_buffer  = fb->scan_buffer;
+        fb_ring_set_window(fb, top);
+        return true;
+    }
+
+    /* Window back to buffer 0, then undo the aliasing */
+    uint32_t top = fb->scroll_top;
+    fb->addr = fb->scroll_base;
+    if (top != 0) {
+        fb_copy_rect(fb, 0, top, 0, 0, fb->width, fb->height);
+        fb_dma_wait(fb);
+    }
+    for (uint32_t i = 0; i < FB_BUFFER_COUNT; i++) {
+        fb->buffers[i] = (uint32_t *)(void *)((uint8_t *)fb->scroll_base +
+                                              i * fb->buffer_size);
+        fb->buffer_age[i] = 0;      /* Unknown: the ring scribbled on them */
+    }
+    fb->scroll_base  = NULL;
+    fb->scroll_rows  = 0;
+    fb->scroll_top   = 0;
+    fb->front_buffer = 0;
+    fb->scan_buffer  = 0;
+    fb->back_buffer  = (FB_BUFFER_COUNT > 1) ? 1 : 0;
+    fb->buffer_age[0] = 1;
+
+    /* Show buffer 0 directly — a present would swap to the stale one */
+    fb_mark_all_dirty(fb);
+    fb_clean_dirty(fb);
+    fb_clear_dirty(fb);
+    HAL_DSB();
+    fb_flip_display(fb);
+
+    fb->addr = fb->buffers[fb->back_buffer];
+    fb_mark_all_dirty(fb);
+    return true;
+}
+
+/*
+ * Scroll the window by `pixels` (positive: content moves down). The band
+ * copy has to land in ring rows the screen isn't showing; it does, because
+ * the ring is at least two screens tall and the window has just run off
+ * the other end.
+ */
+static void fb_ring_scroll(framebuffer_t *fb, int32_t pixels, uint32_t fill_color)
+{
+    uint32_t n     = (uint32_t)abs_i32(pixels);
+    uint32_t keep  = fb->height - n;
+    uint32_t slack = fb->scroll_rows - fb->height;
+    uint32_t top   = fb->scroll_top;
+    bool     down  = pixels > 0;
+
+    /* Pending damage is in the old window's coordinates: write it back now */
+    fb_dma_sync(fb);
+    fb_clean_dirty(fb);
+    fb_clear_dirty(fb);
+
+    /* Off the end of the ring: move the rows that stay to the other end */
+    bool wrap = down ? top < n : top + n > slack;
+    if (wrap) {
+        fb->addr = fb->scroll_base;
+        if (down) {
+            fb_copy_rect(fb, 0, top, 0, slack + n, fb->width, keep);
         } else {
-            /* Copy top-to-bottom, left-to-right */
-            for (uint32_t row = 0; row < h; row++) {
-                for (uint32_t col = 0; col < w; col++) {
-                    uint32_t src_idx = (src_y + row) * pitch_words + (src_x + col);
-                    uint32_t dst_idx = (dst_y + row) * pitch_words + (dst_x + col);
-                    uint32_t pixel = READ_VOLATILE(&fb->addr[src_idx]);
-                    WRITE_VOLATILE(&fb->addr[dst_idx], pixel);
-                }
-            }
+            fb_copy_rect(fb, 0, top + n, 0, 0, fb->width, keep);
         }
+        fb_clear_dirty(fb);     /* Recorded in ring rows; redone below */
     }
 
-    fb_mark_dirty(fb, dst_x, dst_y, w, h);
+    if (down) {
+        top = wrap ? slack : top - n;
+    } else {
+        top = wrap ? 0 : top + n;
+    }
+    fb_ring_set_window(fb, top);
+
+    if (wrap) fb_mark_dirty(fb, 0, down ? n : 0, fb->width, keep);
+    fb_fill_rect(fb, 0, down ? 0 : keep, fb->width, n, fill_color);
+}
+
+/*
+ * A scroll on the DMA engine is one chain: the copy, then the fill of the
+ * exposed strip, so the strip is never painted before the copy has read
+ * it. Returns false (nothing queued) if the engine can't take it.
+ */
+static bool fb_scroll_dma(framebuffer_t *fb, uint32_t src_x, uint32_t src_y,
+                          uint32_t dst_x, uint32_t dst_y, uint32_t w, uint32_t h,
+                          fb_rect_t strip, uint32_t fill_color)
+{
+    hal_dma_2d_t x[2];
+
+    if (!fb_dma_usable(fb, fb->buffer_size)) return false;
+    if (!fb_dma_copy_desc(fb, src_x, src_y, dst_x, dst_y, w, h, &x[0])) return false;
+
+    x[1] = fb_dma_fill_desc(fb, (uint32_t)strip.x, (uint32_t)strip.y,
+                            strip.w, strip.h, fill_color);
+    if (!fb_dma_submit(fb, x, 2)) return false;
+
+    fb_mark_all_dirty(fb);
+    return true;
 }
 
 void fb_scroll_v(framebuffer_t *fb, int32_t pixels, uint32_t fill_color)
@@ -1910,14 +3834,26 @@ void fb_scroll_v(framebuffer_t *fb, int32_t pixels, uint32_t fill_color)
         return;
     }
 
+    if (fb->scroll_rows) {
+        fb_ring_scroll(fb, pixels, fill_color);
+        return;
+    }
+
+    uint32_t keep = fb->height - abs_pixels;
     if (pixels > 0) {
         /* Scroll down */
-        fb_copy_rect(fb, 0, 0, 0, abs_pixels, fb->width, fb->height - abs_pixels);
+        fb_rect_t strip = { 0, 0, fb->width, abs_pixels };
+        if (fb_scroll_dma(fb, 0, 0, 0, abs_pixels, fb->width, keep,
+                          strip, fill_color)) return;
+        fb_copy_rect(fb, 0, 0, 0, abs_pixels, fb->width, keep);
         fb_fill_rect(fb, 0, 0, fb->width, abs_pixels, fill_color);
     } else {
         /* Scroll up */
-        fb_copy_rect(fb, 0, abs_pixels, 0, 0, fb->width, fb->height - abs_pixels);
-        fb_fill_rect(fb, 0, fb->height - abs_pixels, fb->width, abs_pixels, fill_color);
+        fb_rect_t strip = { 0, (int32_t)keep, fb->width, abs_pixels };
+        if (fb_scroll_dma(fb, 0, abs_pixels, 0, 0, fb->width, keep,
+                          strip, fill_color)) return;
+        fb_copy_rect(fb, 0, abs_pixels, 0, 0, fb->width, keep);
+        fb_fill_rect(fb, 0, keep, fb->width, abs_pixels, fill_color);
     }
 }
 
@@ -1931,14 +3867,18 @@ void fb_scroll_h(framebuffer_t *fb, int32_t pixels, uint32_t fill_color)
         return;
     }
 
+    uint32_t keep = fb->width - abs_pixels;
     if (pixels > 0) {
-        /* Scroll right */
-        fb_copy_rect(fb, 0, 0, abs_pixels, 0, fb->width - abs_pixels, fb->height);
+        /* Scroll right — overlaps each row with itself, so CPU only */
+        fb_copy_rect(fb, 0, 0, abs_pixels, 0, keep, fb->height);
         fb_fill_rect(fb, 0, 0, abs_pixels, fb->height, fill_color);
     } else {
         /* Scroll left */
-        fb_copy_rect(fb, abs_pixels, 0, 0, 0, fb->width - abs_pixels, fb->height);
-        fb_fill_rect(fb, fb->width - abs_pixels, 0, abs_pixels, fb->height, fill_color);
+        fb_rect_t strip = { (int32_t)keep, 0, abs_pixels, fb->height };
+        if (fb_scroll_dma(fb, abs_pixels, 0, 0, 0, keep, fb->height,
+                          strip, fill_color)) return;
+        fb_copy_rect(fb, abs_pixels, 0, 0, 0, keep, fb->height);
+        fb_fill_rect(fb, keep, 0, abs_pixels, fb->height, fill_color);
     }
 }
 
@@ -1946,127 +3886,249 @@ void fb_scroll_h(framebuffer_t *fb, int32_t pixels, uint32_t fill_color)
 /* =============================================================================
  * GAMEBOY SCREEN BLITTING — FORMAT-AWARE
  * =============================================================================
- * On RGB565 framebuffers, uses fb_put_pixel() per scaled pixel (slower but
- * correct for the small 160×144 region). On ARGB8888, uses the original
- * scanline-buffer fast path with direct uint32_t writes.
+ * See GAME BOY SCREEN VIEW in framebuffer.h. Every source line becomes one
+ * scaled row in the storage format on the stack, which is then copied
+ * `scale` times into the framebuffer — so the framebuffer is only ever
+ * written, never read back, and the format is decided once per row.
+ *
+ * "Native" values are built through ops->write_px() into a uint32_t; for a
+ * 16-bit format the pixel lands in the low half (every target is
+ * little-endian), which is what fb_gb_scale_row() stores.
  */
 
-void fb_blit_gb_screen_dmg(framebuffer_t *fb, const uint8_t *pal_data)
+enum {
+    FB_GB_SRC_NONE,
+    FB_GB_SRC_DMG,                  /* 1 byte per pixel, palette index */
+    FB_GB_SRC_BGR555,               /* 2 bytes, native CGB color */
+    FB_GB_SRC_RGB888,               /* 3 bytes, fixed-placement GBC call */
+};
+
+static uint32_t fb_gb_native(const fb_pixel_ops_t *ops, uint32_t argb)
 {
-    fb_blit_gb_screen_dmg_palette(fb, pal_data, gb_palette);
+    uint32_t v = 0;
+    ops->write_px((uint8_t *)&v, 0, argb);
+    return v;
 }
 
-void fb_blit_gb_screen_dmg_palette(framebuffer_t *fb, const uint8_t *pal_data, const uint32_t *palette)
+/* FNV-1a over 32-bit words; every source line is a multiple of 4 bytes */
+static uint32_t fb_gb_hash(const uint8_t *p, uint32_t bytes)
 {
-    if (!pal_data) return;
-    if (!palette) palette = gb_palette;
+    uint32_t h = 2166136261u;
+    for (uint32_t i = 0; i < bytes; i += 4) {
+        uint32_t w;
+        memcpy(&w, p + i, 4);
+        h = (h ^ w) * 16777619u;
+    }
+    return h;
+}
 
-    if (fb->pixel_format == FB_FORMAT_RGB565) {
-        /* Format-aware path: use fb_put_pixel for each scaled pixel */
-        for (uint32_t y = 0; y < GB_HEIGHT; y++) {
-            uint32_t src_row = y * GB_WIDTH;
-            for (uint32_t x = 0; x < GB_WIDTH; x++) {
-                uint8_t pal_idx = pal_data[src_row + x];
-                uint32_t color = (pal_idx < 4) ? palette[pal_idx] : FB_COLOR_BLACK;
-                uint32_t dx = GB_OFFSET_X + x * GB_SCALE;
-                uint32_t dy = GB_OFFSET_Y + y * GB_SCALE;
-                for (uint32_t sy = 0; sy < GB_SCALE; sy++)
-                    for (uint32_t sx = 0; sx < GB_SCALE; sx++)
-                        fb_put_pixel(fb, dx + sx, dy + sy, color);
-            }
+static void fb_gb_scale_row(void *dst, const uint32_t *nat, uint32_t scale, uint32_t bpp)
+{
+    if (bpp == 4) {
+        uint32_t *d = (uint32_t *)dst;
+        for (uint32_t x = 0; x < GB_WIDTH; x++) {
+            for (uint32_t k = 0; k < scale; k++) *d++ = nat[x];
         }
     } else {
-        /* Original fast path for 32-bit framebuffers */
-        uint32_t scanline[GB_WIDTH * GB_SCALE];
-        uint32_t pitch_words = fb->pitch / 4;
-
-        for (uint32_t y = 0; y < GB_HEIGHT; y++) {
-            uint32_t src_row = y * GB_WIDTH;
-
-            for (uint32_t x = 0; x < GB_WIDTH; x++) {
-                uint8_t pal_idx = pal_data[src_row + x];
-                uint32_t color = (pal_idx < 4) ? palette[pal_idx] : FB_COLOR_BLACK;
-                scanline[x * 2] = color;
-                scanline[x * 2 + 1] = color;
-            }
-
-            uint32_t dst_y = GB_OFFSET_Y + y * GB_SCALE;
-            uint32_t *row0 = fb->addr + dst_y * pitch_words + GB_OFFSET_X;
-            uint32_t *row1 = fb->addr + (dst_y + 1) * pitch_words + GB_OFFSET_X;
-
-            for (uint32_t i = 0; i < GB_SCALED_W; i++) {
-                WRITE_VOLATILE(&row0[i], scanline[i]);
-                WRITE_VOLATILE(&row1[i], scanline[i]);
-            }
+        uint16_t *d = (uint16_t *)dst;
+        for (uint32_t x = 0; x < GB_WIDTH; x++) {
+            for (uint32_t k = 0; k < scale; k++) *d++ = (uint16_t)nat[x];
         }
+    }
+}
 
-        HAL_DSB();
+/* 5-bit channel → storage bits; a CGB color is lut_r | lut_g | lut_b */
+static void fb_gb_build_lut(fb_gb_view_t *v, const fb_pixel_ops_t *ops)
+{
+    for (uint32_t i = 0; i < 32; i++) {
+        uint32_t c = (i << 3) | (i >> 2);
+        v->lut_r[i] = fb_gb_native(ops, 0xFF000000u | (c << 16));
+        v->lut_g[i] = fb_gb_native(ops, c << 8);
+        v->lut_b[i] = fb_gb_native(ops, c);
     }
+    v->lut_ops = ops;
 }
 
-void fb_blit_gb_screen_gbc(framebuffer_t *fb, const uint8_t *rgb_data)
+void fb_gb_view_init(fb_gb_view_t *view, const framebuffer_t *fb, uint32_t scale)
 {
-    if (!rgb_data) return;
+    if (!view || !fb) return;
+
+    uint32_t fit = min_u32(fb->width / GB_WIDTH, fb->height / GB_HEIGHT);
+    fit = min_u32(max_u32(fit, 1), FB_GB_MAX_SCALE);
+    if (scale == 0 || scale > fit) scale = fit;
+
+    memset(view, 0, sizeof(*view));
+    view->scale = scale;
+    view->w     = GB_WIDTH  * scale;
+    view->h     = GB_HEIGHT * scale;
+    view->x     = fb->width  > view->w ? (fb->width  - view->w) / 2 : 0;
+    view->y     = fb->height > view->h ? (fb->height - view->h) / 2 : 0;
+}
 
-    if (fb->pixel_format == FB_FORMAT_RGB565) {
-        /* Format-aware path: use fb_put_pixel for each scaled pixel */
-        for (uint32_t y = 0; y < GB_HEIGHT; y++) {
-            uint32_t src_row = y * GB_WIDTH * 3;
-            for (uint32_t x = 0; x < GB_WIDTH; x++) {
-                uint32_t idx = src_row + x * 3;
-                uint32_t color = 0xFF000000 |
-                                ((uint32_t)rgb_data[idx] << 16) |
-                                ((uint32_t)rgb_data[idx + 1] << 8) |
-                                (uint32_t)rgb_data[idx + 2];
-                uint32_t dx = GB_OFFSET_X + x * GB_SCALE;
-                uint32_t dy = GB_OFFSET_Y + y * GB_SCALE;
-                for (uint32_t sy = 0; sy < GB_SCALE; sy++)
-                    for (uint32_t sx = 0; sx < GB_SCALE; sx++)
-                        fb_put_pixel(fb, dx + sx, dy + sy, color);
+void fb_gb_view_invalidate(fb_gb_view_t *view)
+{
+    if (view) view->source = FB_GB_SRC_NONE;
+}
+
+/*
+ * A line is drawn when it changed within the last `age` blits: the back
+ * buffer last held the frame from `age` presents ago, so anything newer
+ * isn't in it yet. Age 0 (contents unknown) draws everything. Consecutive
+ * drawn lines are merged into one dirty rect.
+ */
+static uint32_t fb_gb_blit(fb_gb_view_t *v, framebuffer_t *fb, const void *src,
+                           uint32_t kind, const uint32_t *palette, bool track)
+{
+    if (!v || !fb || !src || v->scale == 0) return 0;
+    if (v->x + v->w > fb->width || v->y + v->h > fb->height) return 0;
+    fb_dma_sync(fb);
+
+    const fb_pixel_ops_t *ops = fb_ops(fb);
+    uint32_t line_bytes = GB_WIDTH * (kind == FB_GB_SRC_DMG ? 1 :
+                                      kind == FB_GB_SRC_BGR555 ? 2 : 3);
+    uint32_t age = track ? fb_buffer_age(fb) : 0;
+    bool     all = v->source != kind;
+    uint32_t pal[5];
+
+    if (kind == FB_GB_SRC_DMG) {
+        if (memcmp(v->palette, palette, sizeof(v->palette)) != 0) {
+            memcpy(v->palette, palette, sizeof(v->palette));
+            all = true;
+        }
+        for (uint32_t i = 0; i < 4; i++) pal[i] = fb_gb_native(ops, palette[i]);
+        pal[4] = fb_gb_native(ops, FB_COLOR_BLACK);
+    } else if (kind == FB_GB_SRC_BGR555 && v->lut_ops != ops) {
+        fb_gb_build_lut(v, ops);
+        all = true;
+    }
+    v->source = kind;
+    v->frame++;
+
+    uint32_t scaled[GB_WIDTH * FB_GB_MAX_SCALE];
+    uint32_t nat[GB_WIDTH];
+    size_t   xoff = (size_t)v->x * ops->bpp;
+    size_t   rowb = (size_t)v->w * ops->bpp;
+    uint32_t drawn = 0, run = 0, run_y = 0;
+
+    for (uint32_t y = 0; y < GB_HEIGHT; y++) {
+        const uint8_t *line = (const uint8_t *)src + y * line_bytes;
+
+        if (track) {
+            uint32_t h = fb_gb_hash(line, line_bytes);
+            if (all || h != v->line_hash[y]) {
+                v->line_hash[y]  = h;
+                v->line_frame[y] = v->frame;
+            }
+            if (age != 0 && v->frame - v->line_frame[y] >= age) {
+                if (run) fb_mark_dirty(fb, v->x, v->y + run_y * v->scale, v->w, run * v->scale);
+                run = 0;
+                continue;
             }
         }
-    } else {
-        /* Original fast path for 32-bit framebuffers */
-        uint32_t scanline[GB_WIDTH * GB_SCALE];
-        uint32_t pitch_words = fb->pitch / 4;
-
-        for (uint32_t y = 0; y < GB_HEIGHT; y++) {
-            uint32_t src_row = y * GB_WIDTH * 3;
-
-            for (uint32_t x = 0; x < GB_WIDTH; x++) {
-                uint32_t idx = src_row + x * 3;
-                uint32_t color = 0xFF000000 |
-                                ((uint32_t)rgb_data[idx] << 16) |
-                                ((uint32_t)rgb_data[idx + 1] << 8) |
-                                (uint32_t)rgb_data[idx + 2];
-                scanline[x * 2] = color;
-                scanline[x * 2 + 1] = color;
+
+        switch (kind) {
+            case FB_GB_SRC_DMG:
+                for (uint32_t x = 0; x < GB_WIDTH; x++) {
+                    nat[x] = pal[line[x] < 4 ? line[x] : 4];
+                }
+                fb_gb_scale_row(scaled, nat, v->scale, ops->bpp);
+                break;
+
+            case FB_GB_SRC_BGR555: {
+                const uint16_t *c = (const uint16_t *)(const void *)line;
+                for (uint32_t x = 0; x < GB_WIDTH; x++) {
+                    nat[x] = v->lut_r[c[x] & 31] | v->lut_g[(c[x] >> 5) & 31] |
+                             v->lut_b[(c[x] >> 10) & 31];
+                }
+                fb_gb_scale_row(scaled, nat, v->scale, ops->bpp);
+                break;
             }
 
-            uint32_t dst_y = GB_OFFSET_Y + y * GB_SCALE;
-            uint32_t *row0 = fb->addr + dst_y * pitch_words + GB_OFFSET_X;
-            uint32_t *row1 = fb->addr + (dst_y + 1) * pitch_words + GB_OFFSET_X;
+            default:
+                for (uint32_t x = 0; x < GB_WIDTH; x++) {
+                    const uint8_t *p = line + x * 3;
+                    nat[x] = 0xFF000000u | ((uint32_t)p[0] << 16) |
+                             ((uint32_t)p[1] << 8) | p[2];
+                }
+                ops->blit_row_scaled((uint8_t *)scaled, 0, nat, 0, v->scale, v->w);
+                break;
+        }
 
-            for (uint32_t i = 0; i < GB_SCALED_W; i++) {
-                WRITE_VOLATILE(&row0[i], scanline[i]);
-                WRITE_VOLATILE(&row1[i], scanline[i]);
-            }
+        uint32_t dst_y = v->y + y * v->scale;
+        for (uint32_t k = 0; k < v->scale; k++) {
+            memcpy(fb_row(fb, dst_y + k) + xoff, scaled, rowb);
         }
 
-        HAL_DSB();
+        if (run == 0) run_y = y;
+        run++;
+        drawn++;
     }
+    if (run) fb_mark_dirty(fb, v->x, v->y + run_y * v->scale, v->w, run * v->scale);
+
+    return drawn;
 }
 
-void fb_draw_gb_border(framebuffer_t *fb, uint32_t color)
+uint32_t fb_gb_blit_dmg(fb_gb_view_t *view, framebuffer_t *fb,
+                        const uint8_t *pal_data, const uint32_t *palette)
+{
+    return fb_gb_blit(view, fb, pal_data, FB_GB_SRC_DMG,
+                      palette ? palette : gb_palette, true);
+}
+
+uint32_t fb_gb_blit_gbc(fb_gb_view_t *view, framebuffer_t *fb, const uint16_t *bgr555)
+{
+    return fb_gb_blit(view, fb, bgr555, FB_GB_SRC_BGR555, NULL, true);
+}
+
+void fb_gb_draw_border(const fb_gb_view_t *view, framebuffer_t *fb,
+                       uint32_t thickness, uint32_t color)
+{
+    if (!view || view->scale == 0) return;
+
+    /* Clamped at the top-left edge; fb_fill_rect() clips the rest */
+    uint32_t x0 = view->x > thickness ? view->x - thickness : 0;
+    uint32_t y0 = view->y > thickness ? view->y - thickness : 0;
+    uint32_t w  = view->x + view->w + thickness - x0;
+
+    fb_fill_rect(fb, x0, y0, w, view->y - y0, color);
+    fb_fill_rect(fb, x0, view->y + view->h, w, thickness, color);
+    fb_fill_rect(fb, x0, view->y, view->x - x0, view->h, color);
+    fb_fill_rect(fb, view->x + view->w, view->y, thickness, view->h, color);
+}
+
+/* The fixed GB_SCALE placement, as a view */
+static void fb_gb_fixed_view(fb_gb_view_t *v, const framebuffer_t *fb)
 {
-    uint32_t border = 4;
-    uint32_t x = GB_OFFSET_X - border;
-    uint32_t y = GB_OFFSET_Y - border;
-    uint32_t w = GB_SCALED_W + border * 2;
-    uint32_t h = GB_SCALED_H + border * 2;
+    fb_gb_view_init(v, fb, GB_SCALE);
+    v->scale = GB_SCALE;
+    v->w     = GB_SCALED_W;
+    v->h     = GB_SCALED_H;
+    v->x     = GB_OFFSET_X;
+    v->y     = GB_OFFSET_Y;
+}
+
+void fb_blit_gb_screen_dmg(framebuffer_t *fb, const uint8_t *pal_data)
+{
+    fb_blit_gb_screen_dmg_palette(fb, pal_data, gb_palette);
+}
+
+void fb_blit_gb_screen_dmg_palette(framebuffer_t *fb, const uint8_t *pal_data, const uint32_t *palette)
+{
+    fb_gb_view_t v;
+    fb_gb_fixed_view(&v, fb);
+    fb_gb_blit(&v, fb, pal_data, FB_GB_SRC_DMG, palette ? palette : gb_palette, false);
+}
+
+void fb_blit_gb_screen_gbc(framebuffer_t *fb, const uint8_t *rgb_data)
+{
+    fb_gb_view_t v;
+    fb_gb_fixed_view(&v, fb);
+    fb_gb_blit(&v, fb, rgb_data, FB_GB_SRC_RGB888, NULL, false);
+}
 
-    fb_fill_rect(fb, x, y, w, border, color);
-    fb_fill_rect(fb, x, y + h - border, w, border, color);
-    fb_fill_rect(fb, x, y, border, h, color);
-    fb_fill_rect(fb, x + w - border, y, border, h, color);
+void fb_draw_gb_border(framebuffer_t *fb, uint32_t color)
+{
+    fb_gb_view_t v;
+    fb_gb_fixed_view(&v, fb);
+    fb_gb_draw_border(&v, fb, 4, color);
 }
\ No newline at end of file
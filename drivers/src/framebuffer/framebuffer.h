@@ -64,6 +64,12 @@
 
 #include "hal_types.h"
 
+/* fb_mem_t — scan-out memory type, chosen by hal_display_map_scanout() */
+#include "hal_display.h"
+
+/* hal_dma_fence_t — bulk fills and copies offloaded to the DMA engine */
+#include "hal_dma.h"
+
 /* Include MMIO primitives — drawing code uses WRITE_VOLATILE/READ_VOLATILE */
 #include "mmio.h"
 
@@ -73,7 +79,11 @@
  * =============================================================================
  */
 
-/* Number of framebuffers for double-buffering (1 = single, 2 = double) */
+/*
+ * Number of framebuffers (1 = single, 2 = double, 3 = triple). The
+ * VideoCore allocation is height × FB_BUFFER_COUNT rows; see fb_present_async
+ * for what the third buffer buys.
+ */
 #ifndef FB_BUFFER_COUNT
 #define FB_BUFFER_COUNT     2
 #endif
@@ -110,6 +120,17 @@
 /* GameBoy display constants */
 #define GB_WIDTH            160
 #define GB_HEIGHT           144
+#define GB_CLOCK_HZ         4194304     /* CPU clock, single speed */
+#define GB_FRAME_CYCLES     70224       /* 154 lines × 456 dots */
+
+/* One frame, in cpu_pacer_init() terms: num/den µs = 16742.706 µs, 59.73 Hz */
+#define GB_FRAME_US_NUM     ((uint64_t)GB_FRAME_CYCLES * 1000000u)
+#define GB_FRAME_US_DEN     GB_CLOCK_HZ
+
+/* Largest integer zoom fb_gb_view_init() picks (1280×1152) */
+#define FB_GB_MAX_SCALE     8
+
+/* Fixed placement used by the fb_blit_gb_screen_*() calls */
 #define GB_SCALE            2
 #define GB_SCALED_W         (GB_WIDTH  * GB_SCALE)
 #define GB_SCALED_H         (GB_HEIGHT * GB_SCALE)
@@ -221,6 +242,57 @@ typedef struct {
     uint32_t h;
 } fb_clip_t;
 
+/*
+ * Draw-command recording
+ *
+ * When fb->recorder is non-NULL, the primitives listed with FB_CMD_* below
+ * do not touch pixels. They package their arguments (plus the clip in
+ * effect) into an fb_cmd_t and hand it to recorder->record(). Text commands
+ * also pass the string; the recorder must copy it if it keeps it.
+ *
+ * fb_replay_cmd() executes a recorded command for real. The retained-mode
+ * display list in ui/src/core/ui_displaylist.c is built on this. Anything
+ * not listed here (pixels, blits, bitmaps) bypasses the recorder and draws
+ * immediately, so keep it out of recorded sections.
+ *
+ * An FB_CMD_SURFACE records which surface and where, not its pixels: a
+ * recorder cannot see a surface being drawn into afterwards. Invalidate
+ * the display list when a surface it replays changes.
+ */
+typedef enum {
+    FB_CMD_FILL_RECT,       /* fb_fill_rect, fb_clear               */
+    FB_CMD_FILL_BLEND,      /* fb_fill_rect_blend                    */
+    FB_CMD_FILL_ROUNDED,    /* fb_fill_rounded_rect (r = radius)     */
+    FB_CMD_FILL_ROUNDED_BLEND, /* fb_fill_rounded_rect_blend          */
+    FB_CMD_DRAW_ROUNDED,    /* fb_draw_rounded_rect (r = radius)     */
+    FB_CMD_GRADIENT_V,      /* fb_fill_rect_gradient_v (color2 = end)*/
+    FB_CMD_GRADIENT_H,      /* fb_fill_rect_gradient_h (color2 = end)*/
+    FB_CMD_HLINE,           /* fb_draw_hline (w = length)            */
+    FB_CMD_VLINE,           /* fb_draw_vline (h = length)            */
+    FB_CMD_LINE,            /* fb_draw_line  (w, h = end point)      */
+    FB_CMD_FILL_CIRCLE,     /* fb_fill_circle (x, y = centre)        */
+    FB_CMD_DRAW_CIRCLE,     /* fb_draw_circle (x, y = centre)        */
+    FB_CMD_TEXT,            /* fb_draw_text_run (r = scale)          */
+    FB_CMD_SURFACE,         /* fb_draw_surface (src = the surface)   */
+} fb_cmd_op_t;
+
+typedef struct {
+    uint32_t  op;           /* fb_cmd_op_t */
+    int32_t   x, y;
+    int32_t   w, h;
+    uint32_t  r;
+    uint32_t  color;
+    uint32_t  color2;       /* Gradient end color, text background */
+    uint32_t  flags;        /* FB_TEXT_* for text */
+    fb_clip_t clip;         /* Clip in effect when recorded */
+    uint32_t  reserved;     /* Zero; keeps src aligned with no padding, */
+    const void *src;        /* since recorders hash the raw bytes       */
+} fb_cmd_t;
+
+typedef struct fb_recorder {
+    void (*record)(struct fb_recorder *rec, const fb_cmd_t *cmd, const char *text);
+} fb_recorder_t;
+
 /* Dirty rectangle for incremental present */
 typedef struct {
     uint32_t x;
@@ -229,13 +301,60 @@ typedef struct {
     uint32_t h;
 } fb_dirty_t;
 
-/* Bitmap for blitting (ARGB8888 pixel data, tightly packed) */
+/*
+ * Bitmap for blitting (ARGB8888 pixel data, tightly packed).
+ *
+ * With FB_BITMAP_PREMULTIPLIED in flags, R, G and B are already scaled by
+ * A (see fb_premultiply()), and alpha blits composite with
+ * fb_blend_premul(): one multiply-add per channel instead of two
+ * multiplies and a divide. Flags default to 0 — straight alpha — so
+ * { w, h, data } initializers keep their meaning.
+ */
+#define FB_BITMAP_PREMULTIPLIED (1u << 0)
+
 typedef struct {
     uint32_t        width;
     uint32_t        height;
     const uint32_t *data;
+    uint32_t        flags;      /* FB_BITMAP_* */
 } fb_bitmap_t;
 
+/*
+ * Run-length compressed, palette-indexed bitmap (board/mkasset.py).
+ *
+ * Flat UI art — icons, panels, logos — is a handful of colors in long
+ * runs. As raw ARGB8888 a 64×64 icon is 16 KB of kernel image; as runs of
+ * palette indices it is typically a few hundred bytes, and drawing it
+ * reads that much instead of 16 KB.
+ *
+ * Each row is a byte stream of ops covering exactly `width` pixels:
+ *
+ *     ┌──┬──────┐
+ *     │op│ n-1  │  op = byte >> 6, n = (byte & 0x3F) + 1  (1..64 pixels)
+ *     └──┴──────┘
+ *     FB_RLE_SKIP      n transparent pixels — nothing follows
+ *     FB_RLE_RUN       n pixels of one color — 1 palette index follows
+ *     FB_RLE_LITERAL   n different pixels — n palette indices follow
+ *
+ * rows[y] is the byte offset of row y's stream in data, so a blit can
+ * start at any row (clipping, band-parallel decode) without decoding the
+ * ones above it, and identical rows share one stream. fb_draw_rle()
+ * decodes straight into the framebuffer: opaque runs become span fills,
+ * translucent ones span blends, skips touch nothing.
+ */
+#define FB_RLE_SKIP         0
+#define FB_RLE_RUN          1
+#define FB_RLE_LITERAL      2
+#define FB_RLE_MAX_RUN      64
+
+typedef struct {
+    uint32_t        width;
+    uint32_t        height;
+    const uint32_t *palette;    /* ARGB8888, straight alpha, ≤ 256 entries */
+    const uint32_t *rows;       /* height offsets into data */
+    const uint8_t  *data;
+} fb_rle_image_t;
+
 /*
  * Pixel format — describes byte order as stored in the framebuffer.
  *
@@ -298,6 +417,17 @@ typedef enum {
  *              allocation which is deferred to a later tutorial chapter).
  */
 
+/*
+ * Frame-completion callback — see fb_set_frame_callback(). Runs in IRQ
+ * context when the flip it reports was waited on by a vsync interrupt or
+ * timer; keep it as short as a timer event callback.
+ */
+struct framebuffer;
+typedef void (*fb_frame_fn_t)(struct framebuffer *fb, void *arg);
+
+/* Raster core for the buffer's storage format — see fb_format.h */
+typedef struct fb_pixel_ops fb_pixel_ops_t;
+
 typedef struct framebuffer {
     /*
      * Buffer address and geometry.
@@ -321,6 +451,38 @@ typedef struct framebuffer {
     uint32_t   dirty_count;
     bool       full_dirty;
 
+    /*
+     * Bounding box of pixels written by the per-pixel and line primitives
+     * (fb_put_pixel*, fb_draw_hline, fb_draw_vline) which don't call
+     * fb_mark_dirty() themselves. Folded into dirty_rects[] at present time.
+     * Half-open [x1, x2) × [y1, y2); touch_x2 == 0 means "nothing touched",
+     * so a zero-initialized framebuffer_t starts out clean.
+     */
+    uint32_t   touch_x1, touch_y1;
+    uint32_t   touch_x2, touch_y2;
+
+    /*
+     * Back-buffer damage history.
+     *
+     * buffer_age[i] — how many presents ago buffer i last held the frame
+     *                 now on screen. 0 means "unknown contents" (fresh from
+     *                 fb_init). With plain double buffering the back buffer
+     *                 is always 2 frames stale after a swap; with triple
+     *                 buffering usually 3.
+     * prev_dirty_*  — the damage of the most recently presented frame,
+     *                 saved before the dirty list is cleared. An app that
+     *                 repairs stale buffers itself needs exactly this.
+     * copy_forward  — when set, fb_present() copies prev damage from the
+     *                 just-presented buffer into the new back buffer, so
+     *                 the back buffer always starts as an exact copy of
+     *                 the screen (age 1). See fb_set_copy_forward().
+     */
+    uint32_t   buffer_age[FB_BUFFER_COUNT];
+    fb_dirty_t prev_dirty_rects[FB_MAX_DIRTY_RECTS];
+    uint32_t   prev_dirty_count;
+    bool       prev_full_dirty;
+    bool       copy_forward;
+
     /* Clipping stack
      *
      * clip_stack[0] is the base clip — always the full framebuffer extent.
@@ -331,11 +493,52 @@ typedef struct framebuffer {
     fb_clip_t clip_stack[FB_MAX_CLIP_DEPTH];
     uint32_t  clip_depth;
 
+    /* Draw-command sink — NULL for normal immediate-mode drawing */
+    fb_recorder_t *recorder;
+
+    /*
+     * Asynchronous flip state (fb_present_async).
+     *
+     * flip_pending     — a flip has been queued and its vsync hasn't come
+     *                    yet; the old front buffer is still on screen.
+     *                    Cleared from IRQ context, hence volatile.
+     * flip_finish_due  — the thread-side half (damage history, copy-
+     *                    forward, dirty reset) still has to run; done by
+     *                    fb_wait_flip().
+     * scan_buffer      — the buffer the display is scanning right now.
+     *                    Trails front_buffer while a flip is queued; moved
+     *                    by the vsync interrupt.
+     */
+    volatile bool    flip_pending;
+    volatile uint32_t scan_buffer;
+    bool             flip_finish_due;
+    fb_frame_fn_t    frame_fn;
+    void            *frame_arg;
+
+    /*
+     * Last bulk operation handed to the DMA engine (fb_dma_wait). seq == 0
+     * once it has been waited for, or if nothing was ever offloaded.
+     */
+    hal_dma_fence_t  dma_fence;
+
+    /*
+     * Hardware scroll ring (fb_set_scroll_ring). scroll_rows != 0 while it
+     * is on: the whole virtual buffer — scroll_rows rows from scroll_base —
+     * is one ring, and the window on screen (and in addr) starts at row
+     * scroll_top.
+     */
+    uint32_t        *scroll_base;
+    uint32_t         scroll_rows;
+    uint32_t         scroll_top;
+
     /* Metadata */
-    uint64_t         frame_count;
+    uint64_t         frame_count;   /* Flips completed (bumped at vsync) */
     bool             vsync_enabled;
     bool             initialized;
     fb_pixel_format_t pixel_format;
+    const fb_pixel_ops_t *ops;      /* Bound from pixel_format by fb_init */
+    fb_mem_t         mem_type;      /* How buffers[] are mapped */
+    size_t           stream_min;    /* fb_set_stream_threshold; 0 = default */
 
 } framebuffer_t;
 
@@ -372,6 +575,99 @@ void fb_set_vsync(framebuffer_t *fb, bool enabled);
 void fb_present(framebuffer_t *fb);
 void fb_present_immediate(framebuffer_t *fb);
 
+/*
+ * Asynchronous present — fb_present() split in two.
+ *
+ * fb_present_async() cleans the dirty lines, swaps and queues the flip,
+ * and returns without waiting for vsync. The vsync interrupt (or, on
+ * platforms without one, a timer one refresh later) completes it:
+ * frame_count increments and the frame callback runs.
+ *
+ * fb_wait_flip() sleeps until the queued flip is complete, then does the
+ * thread-side bookkeeping (damage history, copy-forward, dirty reset).
+ * It MUST run before drawing into the framebuffer again — with two
+ * buffers the new back buffer is the one still being scanned out until
+ * that vsync. Everything else (polling hardware, building display lists,
+ * drawing into off-screen surfaces) can overlap the wait:
+ *
+ *     fb_present_async(fb);
+ *     poll_sensors();            ← runs while the flip is in flight
+ *     fb_wait_flip(fb);          ← usually returns at once by now
+ *     draw(fb);
+ *
+ * fb_present() is exactly fb_present_async() + fb_wait_flip(). A single
+ * shared buffer (SimpleFB, GOP) or vsync disabled completes on the spot.
+ *
+ * TRIPLE BUFFERING (FB_BUFFER_COUNT = 3):
+ * ---------------------------------------
+ * With a third buffer the new back buffer is never the one being scanned,
+ * so fb_wait_flip() returns at once and the renderer runs flat out. If a
+ * frame is presented while the previous one is still queued, the queued
+ * one is dropped and its buffer drawn into next — "latest frame wins":
+ *
+ *     scan   queued   drawing
+ *      A       B        C       present C → queued C, drawing B
+ *      A       C        B       vsync     → scan C,  drawing B
+ *
+ * The screen shows the newest complete frame at each vsync, at the cost
+ * of frames the display never showed (frame_count counts shown ones).
+ * Copy-forward still works: a buffer two frames stale is repaired with
+ * the union of both frames' damage.
+ *
+ * LIMITATION: scan_buffer follows the interrupt, not the scan-out latch.
+ * A present within microseconds of vsync can reuse a buffer the hardware
+ * latched a moment earlier, for one frame of tearing.
+ */
+void fb_present_async(framebuffer_t *fb);
+void fb_wait_flip(framebuffer_t *fb);
+static inline bool fb_flip_pending(const framebuffer_t *fb) { return fb->flip_pending; }
+
+/* Called once per completed flip — NULL to remove */
+void fb_set_frame_callback(framebuffer_t *fb, fb_frame_fn_t fn, void *arg);
+
+/*
+ * DMA offload — large fb_clear / fb_copy_rect / fb_scroll_v / fb_scroll_h
+ * calls on an uncached scan-out buffer (FB_MEM_WC, FB_MEM_DEVICE) are
+ * handed to the SoC's DMA engine (hal_dma_2d_submit) and return while it
+ * runs; smaller ones, cached buffers and SoCs without an engine take the
+ * CPU path as before.
+ *
+ * fb_dma_wait() blocks until the last offloaded operation has finished.
+ * Every drawing primitive and fb_present*() call it first, so normal code
+ * never sees a half-filled buffer — the time the engine saves is whatever
+ * runs between the bulk call and the next draw:
+ *
+ *     fb_clear(fb, bg);          ← queued on the engine
+ *     layout_widgets(&ui);       ← CPU work overlaps the fill
+ *     fb_draw_string(fb, ...);   ← waits here, then draws
+ *
+ * Code that touches fb_buffer() directly must call it too.
+ */
+void fb_dma_wait(framebuffer_t *fb);
+
+/*
+ * Streaming stores — fb_clear, solid and gradient fills, opaque blits and
+ * full-buffer copies of at least `bytes` write with non-temporal stores
+ * (STNP / DC ZVA, MOVNTI, cbo.zero; fb_span.h) instead of pulling every
+ * line through the cache. With FB_MEM_CACHED that also leaves the
+ * present-time clean little to write back. The default is
+ * FB_STREAM_MIN_BYTES (256 KB, overridable from a soc.mk); FB_STREAM_OFF
+ * turns it off. Device mappings never stream.
+ */
+#define FB_STREAM_OFF       ((size_t)-1)
+void fb_set_stream_threshold(framebuffer_t *fb, size_t bytes);
+
+/*
+ * Damage history — lets apps draw only what changed on double-buffered
+ * scan-out (BCM). With copy-forward on, each fb_present() replays the
+ * frame's dirty rows into the freshly swapped back buffer, so after the
+ * first present fb_buffer_age() is 1 and the back buffer already matches
+ * the screen. With it off, age is 2 and prev_dirty_rects[] tells the app
+ * what it has to repair itself. Single-buffer SimpleFB/GOP is always 1.
+ */
+void     fb_set_copy_forward(framebuffer_t *fb, bool enabled);
+uint32_t fb_buffer_age(const framebuffer_t *fb);
+
 
 /* =============================================================================
  * CLIPPING
@@ -387,6 +683,16 @@ fb_clip_t fb_get_clip(const framebuffer_t *fb);
 /* =============================================================================
  * DIRTY TRACKING
  * =============================================================================
+ *
+ * fb_present() writes back only the cache lines covered by the dirty list,
+ * one row span at a time. Every drawing primitive in framebuffer.c records
+ * what it touches, so normal drawing needs no extra calls. Code that writes
+ * through fb_buffer() directly must call fb_mark_dirty() for the region it
+ * changed (or fb_mark_all_dirty()) — otherwise those pixels may sit in the
+ * D-cache while the display controller scans stale DRAM.
+ *
+ * A frame with nothing recorded at all is treated as fully dirty, so code
+ * that never heard of dirty tracking keeps working unchanged.
  */
 
 void fb_mark_dirty(framebuffer_t *fb, uint32_t x, uint32_t y, uint32_t w, uint32_t h);
@@ -394,6 +700,14 @@ void fb_mark_all_dirty(framebuffer_t *fb);
 void fb_clear_dirty(framebuffer_t *fb);
 bool fb_is_dirty(const framebuffer_t *fb);
 
+/*
+ * Walk the dirty list as coalesced byte ranges, one per run of rows, in
+ * increasing address order. Emits the whole buffer once when full_dirty
+ * is set or nothing was recorded. Does not clear the dirty state.
+ */
+typedef void (*fb_span_fn_t)(uintptr_t start, size_t len, void *ctx);
+void fb_for_each_dirty_span(framebuffer_t *fb, fb_span_fn_t fn, void *ctx);
+
 
 /* =============================================================================
  * BASIC DRAWING
@@ -415,6 +729,8 @@ void fb_fill_circle(framebuffer_t *fb, int32_t cx, int32_t cy, uint32_t radius,
 
 void fb_fill_rounded_rect(framebuffer_t *fb, uint32_t x, uint32_t y,
                           uint32_t w, uint32_t h, uint32_t radius, uint32_t color);
+void fb_fill_rounded_rect_blend(framebuffer_t *fb, uint32_t x, uint32_t y,
+                                uint32_t w, uint32_t h, uint32_t radius, uint32_t color);
 void fb_draw_rounded_rect(framebuffer_t *fb, uint32_t x, uint32_t y,
                           uint32_t w, uint32_t h, uint32_t radius, uint32_t color);
 
@@ -423,6 +739,39 @@ void fb_copy_rect(framebuffer_t *fb,
                   uint32_t dst_x, uint32_t dst_y,
                   uint32_t w, uint32_t h);
 void fb_scroll_v(framebuffer_t *fb, int32_t pixels, uint32_t fill_color);
+void fb_scroll_h(framebuffer_t *fb, int32_t pixels, uint32_t fill_color);
+
+/*
+ * Hardware scroll ring — for views that scroll constantly (a log, a
+ * console) instead of redrawing.
+ *
+ * The virtual framebuffer the display controller scans is taller than the
+ * screen (height × FB_BUFFER_COUNT). With the ring on, that whole area is
+ * one buffer and the screen is a window into it: fb_scroll_v() moves the
+ * window by changing the scan-out Y offset, and only the exposed strip is
+ * drawn. When the window would run off either end of the ring it is
+ * copied back to the other end first — one band of height - |pixels|
+ * rows, once every (virtual_height - height) / |pixels| scrolls.
+ *
+ *     ring row 0   ┌────────────┐
+ *                  │            │
+ *     scroll_top ─▶├────────────┤ ┐
+ *                  │  window    │ │ height — what fb->addr points at
+ *                  ├────────────┤ ┘
+ *                  │            │
+ *                  └────────────┘ virtual_height
+ *
+ * The window IS the front buffer: drawing lands on screen without a swap
+ * (the damage history reports one shared buffer, age 1) and fb_present()
+ * just writes back the dirty lines and moves the offset. Turning the ring
+ * on keeps what is on screen; turning it off copies the window back to
+ * buffer 0 and returns to double buffering.
+ *
+ * Returns false where the scan-out offset can't be moved (SimpleFB, GOP)
+ * or the virtual buffer has no room past the screen.
+ */
+bool fb_set_scroll_ring(framebuffer_t *fb, bool enabled);
+static inline bool fb_scroll_ring_enabled(const framebuffer_t *fb) { return fb->scroll_rows != 0; }
 
 
 /* =============================================================================
@@ -445,6 +794,86 @@ void fb_draw_string_scaled_transparent(framebuffer_t *fb, uint32_t x, uint32_t y
                                        const char *str, uint32_t fg,
                                        uint32_t scale);
 
+/*
+ * fb_draw_text_run() — the engine behind every string function above.
+ *
+ * Clips once per string, then writes each glyph row as whole spans:
+ * opaque text copies pre-rendered scanlines from a small fg/bg/scale cache,
+ * transparent text fills only the runs of set bits. Like fb_draw_string(),
+ * the run stops at the first character whose cell would cross fb->width.
+ * Returns the x coordinate just past the last character drawn; scale 0
+ * draws nothing and returns x.
+ */
+#define FB_TEXT_TRANSPARENT     (1u << 0)   /* Skip background pixels  */
+#define FB_TEXT_LARGE           (1u << 1)   /* 8×16 font instead of 8×8 */
+
+uint32_t fb_draw_text_run(framebuffer_t *fb, uint32_t x, uint32_t y,
+                          const char *str, uint32_t fg, uint32_t bg,
+                          uint32_t scale, uint32_t flags);
+
+/* Execute a command captured through fb->recorder (see fb_cmd_t) */
+void fb_replay_cmd(framebuffer_t *fb, const fb_cmd_t *cmd, const char *text);
+
+
+/* =============================================================================
+ * OFF-SCREEN SURFACES
+ * =============================================================================
+ *
+ * A surface is a framebuffer_t whose one buffer lives in the heap instead
+ * of scan-out memory, so every fb_* call draws into it unchanged. Panels
+ * that never change are drawn into one once; afterwards any part of them
+ * is a row copy away, which is far cheaper than redrawing the panel fill,
+ * border, shadow and header text it is made of:
+ *
+ *   fb_surface_create(&layer, fb, 0, 0, fb->width, fb->height);
+ *   draw_static_panels(&layer.fb, ...);        // once
+ *
+ *   fb_draw_surface(fb, &layer, x, y, w, h);   // every tick: restore the
+ *   draw_values(fb, ...);                      // background, then draw
+ *
+ * Each surface sits at (x, y) on the framebuffer it is drawn to, and is
+ * either opaque — same pixel format as that framebuffer, rows copied
+ * verbatim — or an overlay — ARGB8888, transparent where nothing was
+ * drawn, composited src-over. An overlay keeps the content under a
+ * toast or a popup intact: removing it is drawing the layers below again.
+ *
+ * fb_draw_surface() is recordable (FB_CMD_SURFACE), so a display list
+ * restores only the tiles that changed. Surfaces never need cache
+ * maintenance: nothing but the CPU reads them.
+ */
+typedef struct fb_surface {
+    framebuffer_t   fb;         /* Draw into the surface through this */
+    int32_t         x, y;       /* Top-left corner on the target */
+    fb_blend_mode_t blend;      /* FB_BLEND_OPAQUE or FB_BLEND_ALPHA */
+} fb_surface_t;
+
+/*
+ * An opaque w × h surface in like's pixel format. A full-width surface
+ * also gets like's pitch, so its rows line up with the screen's byte for
+ * byte. Contents start undefined. False if the heap is out of memory.
+ */
+bool fb_surface_create(fb_surface_t *s, const framebuffer_t *like,
+                       int32_t x, int32_t y, uint32_t w, uint32_t h);
+
+/* An ARGB8888 overlay surface, cleared to transparent */
+bool fb_surface_create_overlay(fb_surface_t *s, int32_t x, int32_t y,
+                               uint32_t w, uint32_t h);
+
+/* Return the pixels to the heap */
+void fb_surface_destroy(fb_surface_t *s);
+
+/*
+ * Draw the part of s that covers the rectangle (x, y, w, h) of fb —
+ * coordinates are fb's; whatever of the rectangle s doesn't cover is
+ * left alone. Clipped like any other primitive.
+ */
+void fb_draw_surface(framebuffer_t *fb, const fb_surface_t *s,
+                     int32_t x, int32_t y, uint32_t w, uint32_t h);
+
+/* The layers, bottom first, over the rectangle (x, y, w, h) of fb */
+void fb_composite(framebuffer_t *fb, const fb_surface_t *const *layers,
+                  uint32_t count, int32_t x, int32_t y, uint32_t w, uint32_t h);
+
 
 /* =============================================================================
  * BITMAP BLITTING
@@ -454,6 +883,28 @@ void fb_draw_string_scaled_transparent(framebuffer_t *fb, uint32_t x, uint32_t y
 void fb_blit(framebuffer_t *fb, int32_t x, int32_t y,
              const fb_bitmap_t *bitmap, fb_blend_mode_t blend);
 
+/*
+ * The destination is clipped once per call; each row is then one call
+ * into the format's blit_row[] (fb_format.h). Opaque runs are row
+ * copies, and scaled blits step through the source without dividing.
+ */
+void fb_blit_bitmap(framebuffer_t *fb, int32_t x, int32_t y, const fb_bitmap_t *bitmap);
+void fb_blit_bitmap_alpha(framebuffer_t *fb, int32_t x, int32_t y, const fb_bitmap_t *bitmap);
+void fb_blit_bitmap_scaled(framebuffer_t *fb, int32_t x, int32_t y, const fb_bitmap_t *bitmap,
+                           uint32_t scale_x, uint32_t scale_y);
+void fb_blit_bitmap_region(framebuffer_t *fb, const fb_bitmap_t *bitmap,
+                           uint32_t src_x, uint32_t src_y, uint32_t src_w, uint32_t src_h,
+                           int32_t dst_x, int32_t dst_y);
+
+/* Decode a compressed asset straight into the framebuffer, src-over */
+void fb_draw_rle(framebuffer_t *fb, int32_t x, int32_t y, const fb_rle_image_t *img);
+
+/*
+ * Convert `count` straight-alpha pixels to premultiplied, in place. Do it
+ * once when an asset is loaded, then set FB_BITMAP_PREMULTIPLIED.
+ */
+void fb_premultiply(uint32_t *pixels, uint32_t count);
+
 
 /* =============================================================================
  * COLOR UTILITIES
@@ -477,6 +928,28 @@ uint32_t fb_blend_additive(uint32_t src, uint32_t dst);
 uint32_t fb_blend_multiply(uint32_t src, uint32_t dst);
 uint32_t fb_color_lerp(uint32_t c1, uint32_t c2, uint8_t t);
 
+/*
+ * Src-over for a premultiplied source: dst × (255 − A) / 255 + src.
+ *
+ * Two channels ride in each 32-bit multiply — R and B in one, A and G in
+ * the other, 16 bits apart, so the products (≤ 65025) never reach the
+ * neighbouring lane. The /255 is the exact shift form fb_span.c uses:
+ *
+ *     x / 255 == (x + 1 + (x >> 8)) >> 8      for 0 <= x <= 65025
+ *
+ * A premultiplied channel never exceeds A, so the final add can't carry.
+ */
+static inline uint32_t fb_blend_premul(uint32_t src, uint32_t dst)
+{
+    uint32_t inv = 255 - (src >> 24);
+    uint32_t rb  = (dst & 0x00FF00FF) * inv;
+    uint32_t ag  = ((dst >> 8) & 0x00FF00FF) * inv;
+
+    rb = ((rb + 0x00010001 + ((rb >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+    ag =  (ag + 0x00010001 + ((ag >> 8) & 0x00FF00FF))       & 0xFF00FF00;
+    return src + rb + ag;
+}
+
 /* Line primitives (forward-declared; defined after fb_draw_rect in framebuffer.c) */
 void fb_draw_hline(framebuffer_t *fb, uint32_t x, uint32_t y, uint32_t len, uint32_t color);
 void fb_draw_vline(framebuffer_t *fb, uint32_t x, uint32_t y, uint32_t len, uint32_t color);
@@ -490,10 +963,108 @@ uint32_t fb_measure_string(const char *str, bool large);
 void fb_blit_bitmap_blend(framebuffer_t *fb, int32_t x, int32_t y,
                           const fb_bitmap_t *bitmap, fb_blend_mode_t blend);
 
-/* Game Boy screen blitting */
+/* =============================================================================
+ * GAME BOY SCREEN VIEW
+ * =============================================================================
+ *
+ * An emulator hands over a whole 160×144 frame 59.73 times a second, and
+ * from one frame to the next most of it is the same: a scrolling stage
+ * changes every line, a menu or a text box changes a handful. The view
+ * remembers a hash of every source scanline and only redraws the ones that
+ * changed:
+ *
+ *   source line y ──hash──▶ same as last frame? ──yes──▶ skip (if the
+ *        │                                               back buffer has it)
+ *        no
+ *        ▼
+ *   160 pixels → native (palette / LUT) → one scaled row on the stack
+ *        ▼
+ *   memcpy × scale into the framebuffer, mark the rows dirty
+ *
+ * "If the back buffer has it" is fb_buffer_age(): a line that changed one
+ * frame ago is already on a single-buffered or copy-forward screen, but on
+ * plain double buffering the back buffer is two frames old and still needs
+ * it. That bookkeeping assumes one blit per present; after drawing over
+ * the view (a pause menu, fb_clear) call fb_gb_view_invalidate().
+ *
+ * The zoom is any integer, chosen from the display: 2× on 480×320, 3× on
+ * 640×480, 5× on 720p, 7× on 1080p. Colors are converted to the
+ * framebuffer's storage format once per frame (DMG: four palette entries)
+ * or once at all (GBC: a 15-bit → native table), so the per-pixel work is a
+ * table load and `scale` stores.
+ *
+ * Pair it with cpu_pacer_t (kernel/src/timer.h) for real-time speed:
+ *
+ *   fb_gb_view_t view;
+ *   cpu_pacer_t  pace;
+ *   fb_gb_view_init(&view, fb, 0);
+ *   cpu_pacer_init(&pace, GB_FRAME_US_NUM, GB_FRAME_US_DEN);
+ *   for (;;) {
+ *       gb_run_frame(&gb);
+ *       fb_gb_blit_gbc(&view, fb, gb.lcd);
+ *       fb_present(fb);
+ *       cpu_pacer_wait(&pace);
+ *   }
+ */
+
+typedef struct {
+    uint32_t scale;                         /* Integer zoom, 1..FB_GB_MAX_SCALE */
+    uint32_t x, y;                          /* Top-left of the scaled screen */
+    uint32_t w, h;                          /* GB_WIDTH/GB_HEIGHT × scale */
+
+    /* Change tracking — private */
+    uint32_t frame;                         /* Blits so far */
+    uint32_t source;                        /* Input kind the hashes are of */
+    uint32_t palette[4];                    /* DMG palette they were drawn with */
+    uint32_t line_hash[GB_HEIGHT];
+    uint32_t line_frame[GB_HEIGHT];         /* Blit that last changed the line */
+
+    /*
+     * GBC color table — private. One entry per 5-bit channel value, already
+     * in the storage format; a pixel is lut_r | lut_g | lut_b (the fields
+     * never overlap in FB_FORMAT_*), which is 384 bytes where a flat
+     * 32768-entry table would be 128KB.
+     */
+    const fb_pixel_ops_t *lut_ops;          /* Format the table was built for */
+    uint32_t lut_r[32], lut_g[32], lut_b[32];
+} fb_gb_view_t;
+
+/*
+ * Place a view on fb. scale 0 picks the largest integer zoom that fits;
+ * anything else is capped to what fits. The view is centred and starts
+ * invalidated, so the first blit draws every line.
+ */
+void fb_gb_view_init(fb_gb_view_t *view, const framebuffer_t *fb, uint32_t scale);
+
+/* Redraw every line on the next blit */
+void fb_gb_view_invalidate(fb_gb_view_t *view);
+
+/*
+ * One frame in. DMG: 160×144 palette indices (0–3, anything else is black)
+ * and four ARGB8888 colors, NULL for gb_palette. GBC: 160×144 native CGB
+ * colors, 0bbbbbgggggrrrrr. Both return the number of source lines
+ * redrawn, 0 if nothing changed or the view doesn't fit fb.
+ */
+uint32_t fb_gb_blit_dmg(fb_gb_view_t *view, framebuffer_t *fb,
+                        const uint8_t *pal_data, const uint32_t *palette);
+uint32_t fb_gb_blit_gbc(fb_gb_view_t *view, framebuffer_t *fb,
+                        const uint16_t *bgr555);
+
+/* A `thickness`-pixel frame just outside the view */
+void fb_gb_draw_border(const fb_gb_view_t *view, framebuffer_t *fb,
+                       uint32_t thickness, uint32_t color);
+
+/*
+ * Fixed-placement calls: GB_SCALE at GB_OFFSET_X/Y, every line drawn every
+ * time. Same row path as the view, minus the change tracking. The GBC
+ * one takes 8-bit RGB triples.
+ */
+void fb_blit_gb_screen_dmg(framebuffer_t *fb, const uint8_t *pal_data);
 void fb_blit_gb_screen_dmg_palette(framebuffer_t *fb,
                                    const uint8_t *pal_data,
                                    const uint32_t *palette);
+void fb_blit_gb_screen_gbc(framebuffer_t *fb, const uint8_t *rgb_data);
+void fb_draw_gb_border(framebuffer_t *fb, uint32_t color);
 
 
 #endif /* FRAMEBUFFER_H */
\ No newline at end of file
@@ -0,0 +1,123 @@
+/*
+ * hal/hal_cache.h - Adaptive Data Cache Maintenance
+ *
+ * Tutorial-OS: HAL Interface Definitions
+ *
+ * clean_dcache_range() and friends (hal_cpu.h) always walk the range one
+ * line at a time. That is right for a DMA descriptor or a dirty panel and
+ * wrong for a whole 1920×1080 framebuffer: 8 MB is 131,072 `dc cvac`s,
+ * while cleaning the ENTIRE cache by set/way is one operation per line
+ * the cache can hold — 8,704 on a Cortex-A53 with 32 KB L1 + 512 KB L2.
+ *
+ *   cost
+ *    │                     range (VA)
+ *    │                   ╱
+ *    │                 ╱
+ *    │ ─ ─ ─ ─ ─ ─ ─ ╳ ─ ─ ─ ─ ─ ─ ─ whole cache (set/way): flat
+ *    │             ╱ ▲
+ *    │           ╱   threshold
+ *    └──────────────────────────────▶ bytes
+ *
+ * hal_dcache_clean() / hal_dcache_flush() pick one or the other against a
+ * threshold. Line size and cache geometry are read once, by
+ * hal_cache_init(), instead of on every call.
+ *
+ * WHERE THE WHOLE-CACHE PATH EXISTS:
+ * ==================================
+ *   ARM64:   Yes, set/way (`dc csw` / `dc cisw`) over every data or
+ *            unified level up to the Level of Coherence.
+ *   RISC-V:  No. Zicbom only has by-address operations, and the JH7110's
+ *            SiFive L2 only has per-line Flush64; a displacement flush is
+ *            unreliable under its random replacement. The threshold stays
+ *            at "never" and both paths are the (unrolled) range walk.
+ *   x86_64:  Coherent DMA; everything is a no-op.
+ *
+ * SET/WAY IS NOT COHERENT:
+ * ========================
+ * A set/way operation only touches the caches of the core that issues it
+ * (and the shared levels below). Dirty lines another core wrote stay in
+ * that core's L1. So the whole-cache path is only taken while one core is
+ * online — once smp_init() has started the job workers, every clean is by
+ * address, which snoops every core. fb_present() splits large cleans
+ * across the workers instead.
+ *
+ * THRESHOLD:
+ * ==========
+ * hal_cache_soc_threshold() sets it at boot; the weak default is the
+ * combined size of the data caches, where the two costs meet if one
+ * set/way op costs the same as one by-address op. Measure the real
+ * crossover with hal_cache_calibrate().
+ */
+
+#ifndef HAL_CACHE_H
+#define HAL_CACHE_H
+
+#include "hal_types.h"
+
+#define HAL_CACHE_MAX_LEVELS    3
+#define HAL_CACHE_NEVER         ((size_t)-1)
+
+typedef struct {
+    uint32_t line;                          /* Smallest D-cache line, bytes */
+    uint32_t levels;                        /* Data/unified levels to PoC */
+    uint32_t level[HAL_CACHE_MAX_LEVELS];   /* Architectural level, 0 = L1 */
+    uint32_t size[HAL_CACHE_MAX_LEVELS];    /* Bytes per level */
+    uint32_t ways[HAL_CACHE_MAX_LEVELS];
+    uint32_t sets[HAL_CACHE_MAX_LEVELS];
+    uint32_t line_shift[HAL_CACHE_MAX_LEVELS];
+    bool     has_whole;                     /* Set/way maintenance exists */
+    size_t   threshold;                     /* Whole cache at or above this */
+} hal_cache_info_t;
+
+/*
+ * Read the cache geometry and set the threshold. Call once on the boot
+ * core, early; the hal_dcache_* calls below fall back to the range walk
+ * with a 64-byte line until it has run.
+ */
+void hal_cache_init(void);
+
+/* Geometry and policy as hal_cache_init() found them */
+const hal_cache_info_t *hal_cache_info(void);
+
+/*
+ * Clean / clean+invalidate [start, start + len): by address below the
+ * threshold, the entire cache above it. Same contract as the
+ * clean_dcache_range() / flush_dcache_range() pair — complete, with a
+ * barrier, on return.
+ */
+void hal_dcache_clean(uintptr_t start, size_t len);
+void hal_dcache_flush(uintptr_t start, size_t len);
+
+/*
+ * Invalidate is always by address: invalidating the whole cache would
+ * throw away every other dirty line in the system.
+ */
+void hal_dcache_invalidate(uintptr_t start, size_t len);
+
+/* True when hal_dcache_clean(len) would take the whole-cache path */
+bool hal_dcache_prefers_whole(size_t len);
+
+/* Override the threshold (HAL_CACHE_NEVER disables the whole-cache path) */
+void hal_cache_set_threshold(size_t bytes);
+
+/*
+ * Per-SoC threshold, called by hal_cache_init() with the geometry already
+ * filled in. Weak default: the total size of the data caches, or
+ * HAL_CACHE_NEVER without set/way.
+ */
+size_t hal_cache_soc_threshold(const hal_cache_info_t *info);
+
+/*
+ * Measure the crossover on this board: dirty `scratch`, time a range
+ * clean of it, dirty it again, time a whole-cache clean, and put the
+ * threshold where the two meet. scratch should be cacheable and a few
+ * times larger than the cache. Boot core, single core only (before
+ * smp_init()); takes a few milliseconds. Prints the result on the debug
+ * UART and applies it.
+ *
+ * @return  The new threshold, or HAL_CACHE_NEVER (no set/way, too many
+ *          cores online, or scratch too small to time)
+ */
+size_t hal_cache_calibrate(void *scratch, size_t len);
+
+#endif /* HAL_CACHE_H */
@@ -76,8 +76,14 @@
  *
  * These are defined here in the contract because they're truly portable —
  * volatile pointer access works on ARM64, RISC-V, x86, MIPS, everything.
+ *
+ * GUARD: common/mmio.h defines the same four functions (and skips them when
+ * this header came first). Kernel code that includes framebuffer.h before
+ * hal_cpu.h gets mmio.h's copies; we skip ours in that order.
  */
 
+#ifndef MMIO_H
+
 /*
  * mmio_write — Write a 32-bit value to a hardware register
  *
@@ -120,6 +126,73 @@ static inline uint8_t mmio_read8(uintptr_t addr)
     return *(volatile uint8_t *)addr;
 }
 
+#endif /* !MMIO_H */
+
+/* =============================================================================
+ * PORTABLE: CPU IDENTITY
+ * =============================================================================
+ *
+ * Once secondary cores are running (see kernel/src/smp.h), code that keeps
+ * per-core state — job deques, allocator caches, profiling counters — needs
+ * to know which core it is on. hal_cpu_id() returns a LOGICAL index:
+ * 0 is always the core that booted, 1..n-1 are the cores smp_init() started.
+ *
+ * This is the one place in this file with per-architecture code, because
+ * the answer is a single register read that has to stay inlined:
+ *
+ *   ARM64:   MPIDR_EL1.Aff0. On the Cortex-A53 clusters we support this is
+ *            already 0..3 and core 0 is the boot core.
+ *
+ *   RISC-V:  The tp register. Hart IDs are NOT dense (the JH7110's U74 cores
+ *            are harts 1-4; hart 0 is the S7 monitor core) and mhartid is
+ *            M-mode only. So boot code loads the logical index into tp:
+ *            common_init.S writes 0, the secondary trampoline writes the
+ *            index from hal_cpu_boot_t. Trap entry saves and restores tp.
+ *
+ *   Others:  Single-core for now, always 0.
+ */
+
+#ifndef HAL_MAX_CPUS
+#define HAL_MAX_CPUS    8       /* Ky X1 has 8 harts; everything else fewer */
+#endif
+
+static inline uint32_t hal_cpu_id(void)
+{
+#if defined(__aarch64__)
+    uint64_t mpidr;
+    __asm__ volatile("mrs %0, mpidr_el1" : "=r"(mpidr));
+    return (uint32_t)(mpidr & 0xFF);
+#elif defined(__riscv)
+    uintptr_t id;
+    __asm__ volatile("mv %0, tp" : "=r"(id));
+    return (uint32_t)id;
+#else
+    return 0;
+#endif
+}
+
+/*
+ * hal_cpu_boot_t — Everything a secondary core needs before it can run C
+ *
+ * The kernel fills stack_top/entry/cpu, the platform's
+ * hal_platform_start_cpu() fills mmu[] with the boot core's translation
+ * state, and the architecture's secondary trampoline consumes it:
+ *
+ *   boot/arm64/common_init.S    arm64_secondary_entry
+ *     mmu[0..3] = MAIR_EL1, TCR_EL1, TTBR0_EL1, SCTLR_EL1
+ *
+ *   boot/riscv64/common_init.S  riscv_secondary_start
+ *     mmu[0]    = satp (0 if the boot hart runs with the MMU off)
+ *
+ * The field offsets are hard-coded in both trampolines. Keep them in sync.
+ */
+typedef struct hal_cpu_boot {
+    uintptr_t   stack_top;              /* 0x00: initial SP, 16-byte aligned */
+    void      (*entry)(uint32_t cpu);   /* 0x08: C entry point, never returns */
+    uintptr_t   cpu;                    /* 0x10: logical CPU index */
+    uintptr_t   mmu[4];                 /* 0x18: architecture MMU state */
+} hal_cpu_boot_t;
+
 /* =============================================================================
  * CONTRACT: MEMORY BARRIERS
  * =============================================================================
@@ -28,6 +28,20 @@ typedef struct framebuffer framebuffer_t;
  * =============================================================================
  */
 
+/*
+ * Memory type of the scan-out buffers, as the display driver mapped them.
+ *
+ * Only FB_MEM_CACHED leaves drawn pixels in the CPU caches where the
+ * display can't see them; fb_present() cleans the dirty spans for that
+ * type and skips maintenance for the others. Zero-initialised
+ * framebuffers are CACHED — the safe assumption.
+ */
+typedef enum {
+    FB_MEM_CACHED = 0,        /* Write-back: clean on every present */
+    FB_MEM_WC,                /* Normal non-cacheable / write-combining */
+    FB_MEM_DEVICE,            /* Device / strongly ordered */
+} fb_mem_t;
+
 /*
  * Display output type
  */
@@ -220,6 +234,79 @@ hal_error_t hal_display_set_vsync(framebuffer_t *fb, bool enabled);
  */
 hal_error_t hal_display_wait_vsync(void);
 
+/* =============================================================================
+ * ASYNCHRONOUS FLIP
+ * =============================================================================
+ *
+ * hal_display_present() blocks until the vertical blank. The async form
+ * queues the flip and returns at once; the vsync interrupt completes it.
+ * See fb_present_async() in framebuffer.h for what may and may not
+ * overlap the wait.
+ */
+
+/*
+ * Frame-completion callback — runs once per completed flip, normally in
+ * IRQ context. Same signature as framebuffer.h's fb_frame_fn_t.
+ */
+typedef void (*hal_display_frame_fn_t)(framebuffer_t *fb, void *arg);
+
+/*
+ * Queue a present and return without waiting for vsync
+ *
+ * Maps to: fb_present_async(fb); fb_wait_flip(fb) before the next draw
+ *
+ * @param fb    Framebuffer
+ * @return      HAL_SUCCESS or error code
+ */
+hal_error_t hal_display_flip_async(framebuffer_t *fb);
+
+/*
+ * Set (or clear, with fn = NULL) the frame-completion callback
+ *
+ * Maps to: fb_set_frame_callback(fb, fn, arg)
+ */
+hal_error_t hal_display_set_frame_callback(framebuffer_t *fb,
+                                           hal_display_frame_fn_t fn,
+                                           void *arg);
+
+/* =============================================================================
+ * VSYNC INTERRUPT HOOKS
+ * =============================================================================
+ *
+ *   BCM2710:  The firmware raises the SMI interrupt (GPU IRQ 48) at each
+ *             vertical blank; we only acknowledge it. This is the same
+ *             signal the Linux firmware-KMS driver waits on.
+ *   JH7110:   Not wired — SimpleFB is a single buffer the DC8200 scans
+ *             continuously, so there is no flip to complete.
+ *
+ * framebuffer.c provides a weak hal_display_vsync_irq_init() returning
+ * HAL_ERROR_NOT_SUPPORTED; flips then complete on a one-refresh timer.
+ */
+
+/* Enable the vsync interrupt source. Called on the first async flip. */
+hal_error_t hal_display_vsync_irq_init(void);
+
+/* Called BY the SoC's interrupt handler once per vertical blank */
+void hal_display_vsync_irq(void);
+
+/* =============================================================================
+ * SCAN-OUT MEMORY TYPE
+ * =============================================================================
+ *
+ * The display driver calls this once it knows where the scan-out buffers
+ * are, so the SoC can map them with the memory type the board was built
+ * for and report what they ended up as (framebuffer_t.mem_type):
+ *
+ *   BCM2710:  FB_MAP=wc|cached|device in soc.mk, applied by rewriting the
+ *             2MB blocks in the boot page tables (soc/bcm2710/src/mmu.c).
+ *   JH7110:   Not overridden. The U74 has no Svpbmt, so DRAM is always
+ *             cacheable and presents keep their L2 Flush64 walk.
+ *
+ * framebuffer.c provides a weak default that changes nothing and returns
+ * FB_MEM_CACHED.
+ */
+fb_mem_t hal_display_map_scanout(uintptr_t base, size_t size);
+
 /* =============================================================================
  * DEFAULT CONFIGURATION
  * =============================================================================
@@ -263,7 +350,7 @@ hal_error_t hal_display_get_default_config(hal_display_config_t *config);
  * BCM2710/BCM2711 (Pi Zero 2W, Pi 4, CM4):
  *   - Uses VideoCore mailbox to allocate framebuffer
  *   - Uses existing mailbox-based code in framebuffer.c
- *   - Vsync via mailbox tag
+ *   - Blocking vsync via mailbox tag, async flips via the SMI interrupt
  *
  * bcm2712 (Pi 5, CM5):
  *   - Similar mailbox interface but different tags
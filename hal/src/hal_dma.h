@@ -90,7 +90,7 @@
  *   - fence iorw, iorw after the L2 flush loop to ensure store ordering.
  *   - DC8200 display controller at 0x29400000 is a DMA master that
  *     reads the framebuffer directly from DRAM via TileLink fabric.
- *   - MMU NOTE: mmu.S marks the framebuffer region (0xFE000000) as
+ *   - MMU NOTE: mmu.c marks the framebuffer region (0xFE000000) as
  *     Device (non-cacheable) in the Sv39 page tables. When the MMU is
  *     active, CPU writes to the framebuffer bypass the cache entirely
  *     and go straight to DRAM. hal_dma_flush_framebuffer() becomes a
@@ -240,6 +240,15 @@ typedef enum {
  *
  * Reading a DEVICE_OWNED buffer from the CPU is undefined behavior —
  * the device may be mid-write and cache state is invalid.
+ *
+ * COHERENT BUFFERS:
+ *   Buffers from dma_pool_alloc() (memory/src/dma_pool.h) live in a region
+ *   the boot page tables map non-cacheable, so there is never a dirty or
+ *   stale line to deal with. The pool sets coherent = true and fills in
+ *   dev_addr once; prepare/complete/sync then reduce to a barrier. The
+ *   ownership rules still apply — the device may be mid-transfer. On the
+ *   JH7110 (no Svpbmt) the region can't be uncached, so its buffers come
+ *   back with coherent = false and get the normal maintenance.
  */
 typedef enum {
     HAL_DMA_OWNER_CPU       = 0,
@@ -253,6 +262,7 @@ typedef struct {
     hal_dma_dir_t    direction;     /* Transfer direction */
     hal_dma_channel_t channel;      /* Which DMA channel owns this buffer */
     hal_dma_owner_t  owner;         /* Current ownership state */
+    bool             coherent;      /* Non-cacheable (dma_pool) — no maintenance */
 } hal_dma_buf_t;
 
 /* ==========================================================================
@@ -295,6 +305,7 @@ typedef struct {
     .direction = (_dir),                            \
     .channel   = (_ch),                             \
     .owner     = HAL_DMA_OWNER_CPU,                 \
+    .coherent  = false,                             \
 }
 
 /* ==========================================================================
@@ -333,8 +344,9 @@ typedef struct {
  *                    For peripherals on the TileLink coherency fabric (most
  *                    on-chip DMA masters), this is sufficient. For any device
  *                    that bypasses TileLink coherency, FROM_DEVICE transfers
- *                    require mapping the buffer as non-cacheable in the MMU
- *                    (PBMT_NC), which is outside the scope of hal_dma.
+ *                    require a non-cacheable mapping, which the U74 (no
+ *                    Svpbmt) can't provide — such a device can't be used
+ *                    for FROM_DEVICE here.
  *
  *   RISC-V (KYX1):  HAL_DMA_TO_DEVICE:   cbo.clean via clean_dcache_range()
  *                   HAL_DMA_FROM_DEVICE:  cbo.inval via invalidate_dcache_range()
@@ -345,6 +357,9 @@ typedef struct {
  *   x86_64:         No-op for cache (x86 is cache-coherent for DMA)
  *                   SFENCE for store ordering
  *
+ * Coherent buffers (buf->coherent) skip the cache operations and only
+ * get the barrier.
+ *
  * Sets buf->owner = HAL_DMA_OWNER_DEVICE.
  * Populates buf->dev_addr with the device-visible address.
  *
@@ -491,7 +506,7 @@ void hal_dma_full_barrier(void);
  * Replaces the existing pattern:
  *   JH7110: jh7110_l2_flush_range(fb_phys, fb_size) + fence iorw,iorw
  *           NOTE: When MMU is active and framebuffer VA is mapped as Device
- *           (non-cacheable) in mmu.S, writes already bypass the cache.
+ *           (non-cacheable) in mmu.c, writes already bypass the cache.
  *           This call reduces to a fence-only barrier in that case.
  *           The JH7110 SoC implementation detects this automatically.
  *   KYX1:   clean_dcache_range(fb_addr, fb_size)   [cbo.clean loop]
@@ -537,6 +552,9 @@ void hal_dma_zero_buffer(hal_dma_buf_t *buf);
  * Replaces the existing pattern in bcm_mailbox_call():
  *   clean cache + DSB ST + BCM_ARM_TO_BUS() address translation
  *
+ * The clean is skipped when buf lies in the coherent DMA pool, which is
+ * where bcm_mailbox_call() stages every message once the pool is up.
+ *
  * @param buf      Pointer to mailbox buffer (must be 16-byte aligned)
  * @param size     Size of mailbox buffer in bytes
  *
@@ -561,7 +579,9 @@ void hal_dma_complete_mailbox(void *buf, size_t size);
  */
 
 /*
- * hal_dma_zero_buffer() — Zero a DMA buffer using hardware-accelerated cache zero
+ * hal_dma_zero_range() — Zero raw memory using hardware-accelerated cache zero
+ *
+ * The descriptor-less core of hal_dma_zero_buffer().
  *
  * On KYX1 (Zicboz): uses cbo.zero — allocates a clean zero cache line without
  * reading from DRAM first. Significantly faster than a store loop for large
@@ -576,7 +596,7 @@ void hal_dma_complete_mailbox(void *buf, size_t size);
  * @param size  Size in bytes (should be a multiple of HAL_DMA_ALIGN for
  *              full hardware acceleration; partial tail uses scalar store)
  */
-void hal_dma_zero_buffer(void *buf, size_t size);
+void hal_dma_zero_range(void *buf, size_t size);
 
 /*
  * hal_dma_addr_is_reserved() — Check if an address falls in a reserved DMA region
@@ -609,7 +629,8 @@ void hal_dma_zero_buffer(void *buf, size_t size);
  */
 bool hal_dma_addr_is_reserved(uintptr_t addr, size_t size);
 
-
+/*
+ * hal_dma_buf_is_valid() — Sanity-check a DMA buffer descriptor
  *
  * Checks alignment, size, and ownership state. Useful in debug builds
  * to catch misuse early (e.g., CPU writing a DEVICE_OWNED buffer).
@@ -631,6 +652,105 @@ bool hal_dma_buf_is_valid(const hal_dma_buf_t *buf);
  */
 const char *hal_dma_channel_name(hal_dma_channel_t ch);
 
+/* ==========================================================================
+ * 2D TRANSFER ENGINE
+ * ==========================================================================
+ *
+ * Everything above is about buffers some *other* master reads or writes.
+ * This section drives a general-purpose DMA controller directly, as a
+ * memory-to-memory copy engine: the bulk framebuffer operations (fb_clear,
+ * fb_copy_rect, fb_scroll_v/h) hand their rectangles here and return while
+ * the engine moves the pixels, leaving the CPU free for layout and text.
+ *
+ * A transfer is a rectangle of `rows` rows of `row_bytes` bytes each:
+ *
+ *      dst ──► ┌─────── row_bytes ───────┐ ─┐
+ *              │                         │  │ dst_pitch (next row start)
+ *              ├─────────────────────────┤ ─┘
+ *              │                         │
+ *              └─────────────────────────┘   × rows
+ *
+ * Pitches are signed: a negative pitch walks the rectangle bottom-up,
+ * which is how an overlapping copy to a lower row stays correct.
+ *
+ *   HAL_DMA_2D_COPY   src → dst, row by row.
+ *   HAL_DMA_2D_FILL   dst ← the 32-bit `fill` pattern repeated. The engine
+ *                     reads the pattern from a constant it owns; src and
+ *                     src_pitch are ignored.
+ *
+ * hal_dma_2d_submit() takes an array of transfers and runs them in order
+ * as ONE chain of hardware descriptors (BCM: control blocks linked through
+ * NEXTCONBK), so a scroll — copy, then fill the exposed strip — is a
+ * single doorbell.
+ *
+ * FENCES:
+ * -------
+ * Submission returns a fence. Until it is signalled the engine owns both
+ * rectangles: the CPU must not write dst, or write src, or read dst.
+ * hal_dma_fence_wait() blocks until it is; a zero fence (seq == 0) is
+ * always signalled, so "no transfer in flight" needs no special case.
+ *
+ * Addresses are CPU addresses; the SoC translates them. The engine
+ * bypasses the CPU caches, so the rectangles must be in memory the CPU
+ * maps non-cacheable (dma_pool, a write-combining framebuffer) or the
+ * caller cleans and invalidates them itself — the engine does not.
+ *
+ * Platforms without a usable engine return HAL_ERROR_NOT_SUPPORTED from
+ * submit, and callers keep their CPU loops. Busy or misaligned requests
+ * fail the same way, with their own codes, so the fallback is always
+ * "do it on the CPU".
+ */
+typedef enum {
+    HAL_DMA_2D_COPY         = 0,
+    HAL_DMA_2D_FILL         = 1,
+} hal_dma_2d_op_t;
+
+typedef struct {
+    hal_dma_2d_op_t op;
+    void           *dst;            /* First byte of the first row */
+    const void     *src;            /* COPY only */
+    uint32_t        fill;           /* FILL only: pattern, little-endian */
+    uint32_t        row_bytes;
+    uint32_t        rows;
+    int32_t         dst_pitch;      /* Bytes from one row start to the next */
+    int32_t         src_pitch;
+} hal_dma_2d_t;
+
+typedef struct {
+    hal_dma_channel_t channel;
+    uint32_t          seq;          /* 0 = nothing to wait for */
+} hal_dma_fence_t;
+
+/*
+ * hal_dma_2d_submit() — Start a chain of 2D transfers
+ *
+ * Returns straight away; *fence_out (if not NULL) completes when the
+ * last transfer has. A channel runs one chain at a time: submitting
+ * while the previous chain is still running first waits for it.
+ *
+ * @param ch     Logical channel; BCM2710 backs DISPLAY and GENERIC
+ * @param xfers  Transfers, executed in array order
+ * @param count  1 .. the SoC's chain length (8 on BCM2710)
+ *
+ * @return HAL_SUCCESS, HAL_ERROR_NOT_SUPPORTED (no engine on this SoC or
+ *         channel), HAL_ERROR_INVALID_ARG (alignment, length or pitch
+ *         beyond what the engine encodes), HAL_ERROR_NOT_INIT (descriptor
+ *         memory unavailable — dma_pool not up yet)
+ */
+hal_error_t hal_dma_2d_submit(hal_dma_channel_t ch, const hal_dma_2d_t *xfers,
+                              uint32_t count, hal_dma_fence_t *fence_out);
+
+/* True once the fence's chain has finished (always true for seq == 0) */
+bool hal_dma_fence_signaled(hal_dma_fence_t fence);
+
+/*
+ * hal_dma_fence_wait() — Block until the fence is signalled
+ *
+ * @return HAL_SUCCESS, or HAL_ERROR_HARDWARE if the engine reported a
+ *         bus error during the chain (the pixels are then undefined)
+ */
+hal_error_t hal_dma_fence_wait(hal_dma_fence_t fence);
+
 /* ==========================================================================
  * PLATFORM IMPLEMENTATION NOTES
  * ==========================================================================
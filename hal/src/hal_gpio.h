@@ -196,6 +196,31 @@ hal_error_t hal_gpio_clear_mask(uint32_t mask, uint32_t bank);
  */
 uint32_t hal_gpio_read_mask(uint32_t bank);
 
+/*
+ * The registers behind hal_gpio_set_mask() / hal_gpio_clear_mask()
+ *
+ * A mask stored to *set drives those pins high, one stored to *clear
+ * drives them low, and every other pin keeps its level — no read, no
+ * function call. Waveform replay (kernel/src/gpio_wave.h) stores to
+ * these directly when the SoC has them.
+ */
+typedef struct {
+    volatile uint32_t *set;
+    volatile uint32_t *clear;
+} hal_gpio_port_t;
+
+/*
+ * Get the set/clear register pair for a bank
+ *
+ * A weak default returns HAL_ERROR_NOT_SUPPORTED: SoCs with a register
+ * per pin (JH7110) have no such pair, and the bulk calls loop instead.
+ *
+ * @param bank  Pin bank
+ * @param port  Output: the bank's registers
+ * @return      HAL_SUCCESS, HAL_ERROR_NOT_SUPPORTED or HAL_ERROR_INVALID_ARG
+ */
+hal_error_t hal_gpio_get_port(uint32_t bank, hal_gpio_port_t *port);
+
 /* =============================================================================
  * PERIPHERAL CONFIGURATION
  * =============================================================================
@@ -0,0 +1,145 @@
+/*
+ * hal/hal_perf.h - Hardware Performance Counters
+ *
+ * Tutorial-OS: HAL Interface Definitions
+ *
+ * The profiling zones (kernel/src/prof.h) say HOW LONG a loop took.
+ * This says WHY. Every core we run on has a performance monitoring unit
+ * that counts events — cache refills, stalled cycles, mispredicted
+ * branches — and a handful of counters that can each be pointed at one:
+ *
+ *   hal_perf_init();
+ *   hal_perf_configure_default();
+ *
+ *   hal_perf_region_t r;
+ *   hal_perf_start(&r);
+ *   fb_fill_rect(fb, 0, 0, 1920, 1080, color);
+ *   hal_perf_stop(&r);                 // r.count[i]: events in the region
+ *
+ * BANDWIDTH-BOUND OR LATENCY-BOUND?
+ * =================================
+ * A framebuffer loop that is slow is usually waiting on memory, and the
+ * fix depends on which way:
+ *
+ *   bandwidth-bound   The loop keeps DRAM busy. LLC refills × line size
+ *                     / cycles is close to what the bus can move per
+ *                     cycle, backend stalls are high. Only moving fewer
+ *                     bytes helps: skip clean tiles, 16-bit pixels,
+ *                     non-temporal stores that skip the read-for-
+ *                     ownership.
+ *
+ *   latency-bound     Stalls are high but the refill rate is far below
+ *                     the bus: each miss waits alone (a column walk, a
+ *                     pointer chase, a prefetcher defeated by the pitch).
+ *                     Change the access order or prefetch — the bus has
+ *                     room to spare.
+ *
+ * And if stalls are low and instructions per cycle are high, memory is
+ * not the problem at all — the loop is simply doing too much work.
+ *
+ * WHAT EACH ARCHITECTURE PROVIDES:
+ * ================================
+ *   ARM64:   PMUv3. PMCCNTR_EL0 for cycles plus PMCR_EL0.N programmable
+ *            32-bit counters (6 on the Cortex-A53/A72/A76). PMCEID0/1
+ *            list which common events this core implements.
+ *   RISC-V:  Cycles and instret from the base counters (rdcycle /
+ *            rdinstret), everything else through the SBI PMU extension:
+ *            S-mode cannot program mhpmevent, so OpenSBI does it and
+ *            tells us which hpmcounter CSR to read. Which events exist
+ *            is the platform's choice (the JH7110 device tree's pmu node).
+ *   x86_64:  Architectural perfmon (CPUID leaf 0xA). Fixed counters for
+ *            instructions and cycles, general counters for the
+ *            architectural events: LLC misses and mispredicted branches.
+ *            L1 refills and stall cycles are model-specific; not offered.
+ *
+ * Events a core doesn't have are refused by hal_perf_configure() rather
+ * than silently counting zero.
+ *
+ * ONE CORE AT A TIME:
+ * ===================
+ * Counters belong to the core that reads them. Configure on the core
+ * whose loops you want to count (the boot core: that is where the
+ * profiling zones run); hal_perf_read() on any other core reads zeros.
+ * The counters keep running across interrupts, so a region that takes
+ * an interrupt counts the handler too.
+ */
+
+#ifndef HAL_PERF_H
+#define HAL_PERF_H
+
+#include "hal_types.h"
+
+typedef enum {
+    HAL_PERF_CYCLES = 0,        /* Core clock cycles */
+    HAL_PERF_INSTRUCTIONS,      /* Instructions retired */
+    HAL_PERF_L1D_ACCESS,        /* L1 data cache accesses */
+    HAL_PERF_L1D_REFILL,        /* L1 data cache misses (refills) */
+    HAL_PERF_LLC_REFILL,        /* Last-level cache refills: DRAM reads */
+    HAL_PERF_STALL_FRONTEND,    /* Cycles with nothing to issue */
+    HAL_PERF_STALL_BACKEND,     /* Cycles issue was blocked (memory, mostly) */
+    HAL_PERF_BRANCH_MISS,       /* Mispredicted branches */
+    HAL_PERF_EVENT_COUNT
+} hal_perf_event_t;
+
+/* Events counted at once, at most */
+#define HAL_PERF_MAX_COUNTERS   6
+
+typedef struct {
+    uint64_t count[HAL_PERF_MAX_COUNTERS];  /* Indexed like the configured events */
+} hal_perf_counts_t;
+
+typedef struct {
+    hal_perf_counts_t start;
+    uint64_t          count[HAL_PERF_MAX_COUNTERS];   /* Set by hal_perf_stop() */
+} hal_perf_region_t;
+
+/*
+ * Find the PMU and enable it on the calling core. Returns
+ * HAL_ERROR_NOT_SUPPORTED where there is none (hosted builds, RISC-V
+ * firmware without the SBI PMU extension, ARM32); every other call then
+ * does nothing and reads zeros.
+ */
+hal_error_t hal_perf_init(void);
+
+/* True if this core can count the event (after hal_perf_init()) */
+bool hal_perf_supported(hal_perf_event_t event);
+
+/*
+ * Count these events, in this order, from now on — replacing whatever
+ * was configured before. count is at most HAL_PERF_MAX_COUNTERS.
+ *
+ * @return HAL_SUCCESS, HAL_ERROR_NOT_SUPPORTED (an event this core
+ *         doesn't have; nothing is configured), HAL_ERROR_INVALID_ARG
+ *         (too many events, or more than the PMU has counters for)
+ */
+hal_error_t hal_perf_configure(const hal_perf_event_t *events, uint32_t count);
+
+/*
+ * The set kernel code uses unless told otherwise: cycles, instructions,
+ * L1D refills, LLC refills, backend stalls, branch misses — minus those
+ * this core lacks. Returns how many were configured.
+ */
+uint32_t hal_perf_configure_default(void);
+
+/* Configured events, and which one slot i holds */
+uint32_t         hal_perf_count(void);
+hal_perf_event_t hal_perf_event(uint32_t slot);
+
+/* Running totals of every configured counter */
+void hal_perf_read(hal_perf_counts_t *out);
+
+/*
+ * Delta between two reads, per slot, modulo each counter's width — the
+ * ARMv8 event counters are 32 bits and wrap in a few seconds.
+ */
+void hal_perf_delta(const hal_perf_counts_t *start, const hal_perf_counts_t *end,
+                    uint64_t *delta);
+
+/* Bracket a region; r->count[] holds the events between the two calls */
+void hal_perf_start(hal_perf_region_t *r);
+void hal_perf_stop(hal_perf_region_t *r);
+
+/* Short name for reports: "cycles", "l1d_refill", ... */
+const char *hal_perf_event_name(hal_perf_event_t event);
+
+#endif /* HAL_PERF_H */
@@ -92,6 +92,20 @@ hal_error_t hal_platform_init(void);
  */
 bool hal_platform_is_initialized(void);
 
+/*
+ * Deferred initialization, called once by kernel_main() right after the
+ * first frame is on screen.
+ *
+ * Hardware that is slow to bring up and that the first frame doesn't
+ * need — a PMIC behind a 100 kHz I2C bus, a sensor that needs a settle
+ * delay — belongs here rather than in hal_platform_init(), so it stays
+ * out of the boot-to-first-frame path. Until it has run, the affected
+ * getters report HAL_ERROR_NOT_SUPPORTED and the UI shows "N/A".
+ *
+ * Weak default (kernel/src/main.c): nothing to do.
+ */
+hal_error_t hal_platform_late_init(void);
+
 /* =============================================================================
  * PLATFORM INFORMATION
  * =============================================================================
@@ -206,6 +220,38 @@ typedef enum {
  */
 uint32_t hal_platform_get_clock_rate(hal_clock_id_t clock_id);
 
+/*
+ * Get the range a clock can be set within
+ *
+ * @param clock_id  Clock to query
+ * @param min_hz    Output: slowest rate hal_platform_set_clock_rate() accepts
+ * @param max_hz    Output: fastest — on BCM the firmware's arm_freq, not
+ *                  the turbo ceiling a config.txt could unlock
+ * @return          HAL_SUCCESS, HAL_ERROR_NULL_PTR, or
+ *                  HAL_ERROR_NOT_SUPPORTED if the clock can't be set
+ */
+hal_error_t hal_platform_get_clock_limits(hal_clock_id_t clock_id,
+                                          uint32_t *min_hz, uint32_t *max_hz);
+
+/*
+ * Request a clock rate
+ *
+ * The platform picks the closest rate it can produce at or below hz
+ * (never above: a faster clock may need a higher voltage first) and
+ * reports it. BCM: the firmware's "set clock rate" tag, which also
+ * moves the core voltage. JH7110: the CPU core divider under PLL0, at
+ * the voltage U-Boot set.
+ *
+ * @param clock_id   Clock to set
+ * @param hz         Requested rate
+ * @param actual_hz  Output: rate now in effect (may be NULL)
+ * @return           HAL_SUCCESS, HAL_ERROR_NOT_SUPPORTED (fixed clock),
+ *                   HAL_ERROR_INVALID_ARG (below the minimum),
+ *                   HAL_ERROR_HARDWARE (the request was refused)
+ */
+hal_error_t hal_platform_set_clock_rate(hal_clock_id_t clock_id, uint32_t hz,
+                                        uint32_t *actual_hz);
+
 /* =============================================================================
  * TEMPERATURE MONITORING
  * =============================================================================
@@ -268,6 +314,52 @@ hal_error_t hal_platform_get_throttle_status(uint32_t *status);
  */
 bool hal_platform_is_throttled(void);
 
+/* =============================================================================
+ * DYNAMIC READINGS
+ * =============================================================================
+ * Everything above that can change between frames, fetched together.
+ * On the BCM2710 each getter is its own mailbox round trip to the
+ * VideoCore; hal_platform_poll_dynamic() packs them into one property
+ * transaction, and can start it early with hal_platform_request_dynamic().
+ * Platforms that implement neither get defaults built from the individual
+ * getters above.
+ */
+
+typedef struct {
+    uint32_t arm_freq_hz;       /* Current (possibly throttled) CPU clock */
+    uint32_t core_freq_hz;
+    uint32_t emmc_freq_hz;
+    uint32_t pwm_freq_hz;       /* 0 if not available */
+
+    int32_t  temp_mc;
+    bool     have_temp;
+
+    uint32_t throttle;          /* HAL_THROTTLE_* */
+    bool     have_throttle;
+} hal_platform_dynamic_t;
+
+/*
+ * Read every dynamic value at once
+ *
+ * Clocks that can't be read are 0; have_temp / have_throttle report
+ * whether those readings are valid.
+ *
+ * @param out   Output readings
+ * @return      HAL_SUCCESS or HAL_ERROR_NULL_PTR
+ */
+hal_error_t hal_platform_poll_dynamic(hal_platform_dynamic_t *out);
+
+/*
+ * Start fetching the dynamic readings without waiting for them
+ *
+ * The next hal_platform_poll_dynamic() collects the answer, so work done
+ * in between overlaps the query. Optional: poll works without it.
+ *
+ * @return  HAL_SUCCESS if a query is now in flight,
+ *          HAL_ERROR_NOT_SUPPORTED where reads are synchronous anyway
+ */
+hal_error_t hal_platform_request_dynamic(void);
+
 /* =============================================================================
  * POWER MANAGEMENT
  * =============================================================================
@@ -307,6 +399,39 @@ hal_error_t hal_platform_set_power(hal_device_id_t device, bool on);
  */
 hal_error_t hal_platform_get_power(hal_device_id_t device, bool *on);
 
+/* =============================================================================
+ * MULTICORE
+ * =============================================================================
+ * Used by kernel/src/smp.c. The kernel owns the stacks and the
+ * hal_cpu_boot_t blocks; the platform knows how to wake a core (spin
+ * table on BCM2710, SBI HSM on RISC-V) and where its trampoline lives.
+ *
+ * Platforms that don't implement these get the weak single-core defaults
+ * in smp.c, so the job system still works — it just runs everything on
+ * core 0.
+ */
+
+/*
+ * Number of cores the platform can bring up, including the boot core
+ *
+ * @return  1 if secondary start-up is not supported
+ */
+uint32_t hal_platform_get_cpu_count(void);
+
+/*
+ * Release one secondary core
+ *
+ * Fills boot->mmu[] with the boot core's translation state, makes the
+ * block visible to a core running with its caches off, and wakes the core.
+ * The core enters boot->entry(boot->cpu) on boot->stack_top.
+ *
+ * @param cpu   Logical CPU index, 1 .. hal_platform_get_cpu_count() - 1
+ * @param boot  Boot block (must stay valid until the core is running)
+ * @return      HAL_SUCCESS, HAL_ERROR_INVALID_ARG or HAL_ERROR_HARDWARE
+ */
+struct hal_cpu_boot;     /* hal_cpu.h */
+hal_error_t hal_platform_start_cpu(uint32_t cpu, struct hal_cpu_boot *boot);
+
 /* =============================================================================
  * SYSTEM CONTROL
  * =============================================================================
@@ -348,7 +473,8 @@ HAL_NORETURN void hal_panic(const char *message);
 /*
  * Write character to debug console
  *
- * Uses UART or other available debug output.
+ * Uses UART or other available debug output. Implemented per SoC; this is
+ * the raw character out and does NOT reach the debug sink below.
  *
  * @param c     Character to write
  */
@@ -357,6 +483,9 @@ void hal_debug_putc(char c);
 /*
  * Write string to debug console
  *
+ * Portable (kernel/src/debug.c): hal_debug_putc() for every character,
+ * then the debug sink, if one is set.
+ *
  * @param s     String to write
  */
 void hal_debug_puts(const char *s);
@@ -364,13 +493,33 @@ void hal_debug_puts(const char *s);
 /*
  * Write formatted string to debug console
  *
- * Limited printf implementation (no floating point).
+ * Limited printf implementation (no floating point), portable like
+ * hal_debug_puts(): %d %i %u %x %X %p %s %c, '-' / '0' flags, a width,
+ * and the l, ll and z modifiers.
+ *
+ * Formats and transmits before it returns. Inside timing-sensitive code
+ * use TRACE() (kernel/src/trace.h), which takes the same arguments and
+ * defers all of that to a host-side decoder.
  *
  * @param fmt   Format string
  * @param ...   Arguments
  */
 void hal_debug_printf(const char *fmt, ...);
 
+/*
+ * Debug sink — a second destination for hal_debug_puts/printf output,
+ * after the UART. The framebuffer console attaches itself here
+ * (console_attach_debug()) so logging shows up on screen.
+ *
+ * fn gets text in chunks (one per puts, up to 128 bytes per printf chunk),
+ * not NUL-terminated, serialised across cores, with IRQs masked — it may
+ * run on any core and inside an interrupt handler, so it must not block,
+ * draw or call hal_debug_* itself. NULL removes the sink.
+ */
+typedef void (*hal_debug_sink_fn_t)(void *ctx, const char *s, size_t len);
+
+void hal_debug_set_sink(hal_debug_sink_fn_t fn, void *ctx);
+
 /* =============================================================================
  * PLATFORM-SPECIFIC NOTES
  * =============================================================================
@@ -69,6 +69,16 @@ uint32_t hal_timer_get_ticks32(void);
  */
 uint64_t hal_timer_get_ms(void);
 
+/*
+ * Frequency of the architectural counter boot/<arch>/entry.S samples
+ * into __boot_counter (CNTPCT_EL0 on ARM64, `time` on RISC-V), or 0 if
+ * unknown. boottime.c uses it to place that sample on the
+ * hal_timer_get_ticks() timeline.
+ *
+ * Weak default (kernel/src/boottime.c): CNTFRQ_EL0 on ARM64, 0 elsewhere.
+ */
+uint64_t hal_timer_counter_hz(void);
+
 /* =============================================================================
  * DELAY FUNCTIONS
  * =============================================================================
@@ -79,7 +89,9 @@ uint64_t hal_timer_get_ms(void);
  * Delay for specified microseconds
  *
  * Busy-waits using the hardware timer. This is accurate to within
- * a few microseconds on most platforms.
+ * a few microseconds on most platforms. Meant for short hardware
+ * settle times; to wait milliseconds, start a timer event and sleep in
+ * cpu_idle() (see TIMER EVENTS below).
  *
  * @param us    Microseconds to delay
  */
@@ -187,6 +199,137 @@ HAL_INLINE uint64_t hal_stopwatch_elapsed_ms(hal_stopwatch_t *sw)
     return hal_stopwatch_elapsed_us(sw) / 1000;
 }
 
+/* =============================================================================
+ * TIMER EVENTS
+ * =============================================================================
+ *
+ * The delay functions above busy-wait: the core runs flat out, at full
+ * clock, doing nothing. For anything longer than a few microseconds the
+ * better answer is to program the timer's compare register, sleep in wfi,
+ * and let the interrupt wake us.
+ *
+ * A timer event is a callback with an absolute deadline (in
+ * hal_timer_get_ticks() microseconds) and an optional period. Pending
+ * events sit in one list sorted by deadline, and ONLY the earliest one is
+ * ever programmed into hardware — there is no periodic tick. When the
+ * compare fires, every expired event runs, periodic ones are re-queued,
+ * and the compare moves on to the new head:
+ *
+ *   head ──▶ [t=1000 ui] ──▶ [t=1250 led, period 250] ──▶ [t=5000 ...]
+ *               ▲
+ *               └── the only deadline in the compare register
+ *
+ * The queue and cpu_idle() live in kernel/src/timer.c — they are the same
+ * on every platform. Each SoC supplies the three hooks in the next section
+ * and calls hal_timer_irq() from its interrupt handler. A platform without
+ * them still runs events: cpu_idle() polls the clock instead of sleeping.
+ *
+ * CONTEXT:
+ * --------
+ * Callbacks run in IRQ context on the boot core with IRQs masked. Keep them
+ * short — set a flag, bump a counter — and don't call anything that might
+ * wait on the heap lock. Start and cancel events on the boot core only,
+ * from thread context or from inside a callback: the queue is protected by
+ * masking IRQs, not by a lock, and on RISC-V the compare is per hart.
+ */
+
+#define HAL_TIMER_NO_DEADLINE   UINT64_MAX
+
+typedef void (*hal_timer_fn_t)(void *arg);
+
+typedef struct hal_timer_event {
+    uint64_t                 deadline;  /* Absolute, microseconds         */
+    uint32_t                 period;    /* Microseconds, 0 = one-shot     */
+    hal_timer_fn_t           fn;
+    void                    *arg;
+    struct hal_timer_event  *next;      /* Pending list, sorted           */
+    bool                     pending;
+} hal_timer_event_t;
+
+/*
+ * hal_timer_events_init() - Enable the timer interrupt on the boot core
+ *
+ * Calls hal_timer_irq_init() and unmasks IRQs on the calling core. Call
+ * once, from kernel_main(), after the vectors are installed. Events
+ * started before this are kept and fire once it runs.
+ *
+ * @return  HAL_SUCCESS, or HAL_ERROR_NOT_SUPPORTED when the platform has no
+ *          timer interrupt (events then run from cpu_idle()'s polling loop)
+ */
+hal_error_t hal_timer_events_init(void);
+
+/*
+ * hal_timer_event_start() - Queue (or re-queue) an event
+ *
+ * @param ev         Caller-owned storage; must stay valid while pending
+ * @param delay_us   First expiry, relative to now
+ * @param period_us  Re-fire interval, or 0 for a one-shot
+ * @param fn         Callback (IRQ context)
+ * @param arg        Passed to fn
+ *
+ * Restarting a pending event moves it — it never ends up queued twice.
+ * Periodic events keep a fixed cadence: the next deadline is the previous
+ * one plus the period, not "now" plus the period, so latency doesn't
+ * accumulate as drift.
+ *
+ * @return  HAL_SUCCESS, HAL_ERROR_NULL_PTR
+ */
+hal_error_t hal_timer_event_start(hal_timer_event_t *ev, uint32_t delay_us,
+                                  uint32_t period_us, hal_timer_fn_t fn,
+                                  void *arg);
+
+/*
+ * hal_timer_event_cancel() - Remove an event if it is pending
+ *
+ * Safe on an event that has already fired or was never started.
+ */
+void hal_timer_event_cancel(hal_timer_event_t *ev);
+
+/*
+ * hal_timer_next_deadline() - Earliest pending deadline
+ *
+ * @return  Absolute microseconds, or HAL_TIMER_NO_DEADLINE
+ */
+uint64_t hal_timer_next_deadline(void);
+
+/* =============================================================================
+ * SOC TIMER INTERRUPT HOOKS
+ * =============================================================================
+ *
+ * Implemented per SoC. The kernel calls these with IRQs masked, always on
+ * the boot core:
+ *
+ *   BCM2710:  System Timer compare C1 (C0 and C2 belong to the VideoCore),
+ *             GPU IRQ 1 on the legacy controller, routed to core 0
+ *   JH7110:   SBI Timer extension (sbi_set_timer), supervisor timer
+ *             interrupt = scause 5
+ *
+ * The kernel provides weak defaults returning HAL_ERROR_NOT_SUPPORTED.
+ */
+
+/* Enable the timer as an interrupt source on the calling core */
+hal_error_t hal_timer_irq_init(void);
+
+/*
+ * Fire an interrupt at (or shortly after) deadline_us. Replaces any earlier
+ * compare and clears a pending one. A deadline already in the past must
+ * still fire — even on compare-for-equality hardware like the BCM2710's.
+ */
+void hal_timer_irq_set(uint64_t deadline_us);
+
+/* Cancel the compare and clear a pending timer interrupt */
+void hal_timer_irq_clear(void);
+
+/*
+ * hal_timer_irq() - Called BY the SoC's interrupt handler
+ *
+ * Runs every expired event and reprograms (or clears) the compare. The SoC
+ * handler must have acknowledged the interrupt source first if it is
+ * edge-latched (BCM2710 CS.M1); SBI's level-triggered timer is cleared by
+ * the reprogram itself.
+ */
+void hal_timer_irq(void);
+
 /* =============================================================================
  * PLATFORM-SPECIFIC NOTES
  * =============================================================================
@@ -349,6 +349,120 @@ typedef enum {
      */
 #endif
 
+#if defined(HAL_HOSTED)
+    /*
+     * Hosted build (host/Makefile): a user process may not halt the core,
+     * and there is no interrupt to wake it anyway. Waiting is spinning.
+     */
+    #undef  HAL_WFE
+    #undef  HAL_WFI
+    #define HAL_WFE()   HAL_NOP()
+    #define HAL_WFI()   HAL_NOP()
+#endif
+
+
+/* =============================================================================
+ * LOCAL INTERRUPT MASKING
+ * =============================================================================
+ *
+ * Mask or unmask IRQs on the CALLING core only — the other cores are not
+ * affected. hal_irq_save() masks and returns the previous state so nested
+ * critical sections compose:
+ *
+ *     hal_irq_flags_t f = hal_irq_save();
+ *     ... touch state the IRQ handler also touches ...
+ *     hal_irq_restore(f);
+ *
+ *   ARM64:   PSTATE.I via DAIFSet/DAIFClr (#2 = the I bit only)
+ *   RISC-V:  sstatus.SIE (bit 1) — csrrci is an atomic read-and-clear
+ *   ARM32:   PRIMASK via cpsid/cpsie (Cortex-M)
+ *   x86_64:  RFLAGS.IF via cli/sti
+ *
+ * A WFI executed with IRQs masked still wakes when an interrupt becomes
+ * pending — on all four. That is what makes "mask, check, sleep, unmask"
+ * race-free in cpu_idle() (kernel/src/timer.c).
+ */
+
+typedef unsigned long hal_irq_flags_t;
+
+#if defined(HAL_HOSTED)
+
+/* Hosted build: no interrupts reach the process, nothing to mask */
+HAL_INLINE void hal_irq_enable(void)  { }
+HAL_INLINE void hal_irq_disable(void) { }
+HAL_INLINE hal_irq_flags_t hal_irq_save(void) { return 0; }
+HAL_INLINE void hal_irq_restore(hal_irq_flags_t f) { (void)f; }
+
+#elif defined(__aarch64__)
+
+HAL_INLINE void hal_irq_enable(void)  { __asm__ volatile("msr daifclr, #2" ::: "memory"); }
+HAL_INLINE void hal_irq_disable(void) { __asm__ volatile("msr daifset, #2" ::: "memory"); }
+
+HAL_INLINE hal_irq_flags_t hal_irq_save(void)
+{
+    hal_irq_flags_t f;
+    __asm__ volatile("mrs %0, daif\n\tmsr daifset, #2" : "=r"(f) :: "memory");
+    return f;
+}
+
+HAL_INLINE void hal_irq_restore(hal_irq_flags_t f)
+{
+    __asm__ volatile("msr daif, %0" :: "r"(f) : "memory");
+}
+
+#elif defined(__riscv)
+
+HAL_INLINE void hal_irq_enable(void)  { __asm__ volatile("csrsi sstatus, 2" ::: "memory"); }
+HAL_INLINE void hal_irq_disable(void) { __asm__ volatile("csrci sstatus, 2" ::: "memory"); }
+
+HAL_INLINE hal_irq_flags_t hal_irq_save(void)
+{
+    hal_irq_flags_t f;
+    __asm__ volatile("csrrci %0, sstatus, 2" : "=r"(f) :: "memory");
+    return f & 2;
+}
+
+HAL_INLINE void hal_irq_restore(hal_irq_flags_t f)
+{
+    __asm__ volatile("csrs sstatus, %0" :: "r"(f & 2) : "memory");
+}
+
+#elif defined(__arm__) || defined(__thumb__)
+
+HAL_INLINE void hal_irq_enable(void)  { __asm__ volatile("cpsie i" ::: "memory"); }
+HAL_INLINE void hal_irq_disable(void) { __asm__ volatile("cpsid i" ::: "memory"); }
+
+HAL_INLINE hal_irq_flags_t hal_irq_save(void)
+{
+    hal_irq_flags_t f;
+    __asm__ volatile("mrs %0, primask\n\tcpsid i" : "=r"(f) :: "memory");
+    return f;
+}
+
+HAL_INLINE void hal_irq_restore(hal_irq_flags_t f)
+{
+    __asm__ volatile("msr primask, %0" :: "r"(f) : "memory");
+}
+
+#elif defined(__x86_64__)
+
+HAL_INLINE void hal_irq_enable(void)  { __asm__ volatile("sti" ::: "memory"); }
+HAL_INLINE void hal_irq_disable(void) { __asm__ volatile("cli" ::: "memory"); }
+
+HAL_INLINE hal_irq_flags_t hal_irq_save(void)
+{
+    hal_irq_flags_t f;
+    __asm__ volatile("pushfq\n\tpopq %0\n\tcli" : "=r"(f) :: "memory");
+    return f;
+}
+
+HAL_INLINE void hal_irq_restore(hal_irq_flags_t f)
+{
+    if (f & (1UL << 9)) hal_irq_enable();   /* RFLAGS.IF */
+}
+
+#endif
+
 
 /* =============================================================================
  * MMIO ACCESS
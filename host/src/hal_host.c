@@ -0,0 +1,323 @@
+/*
+ * hal_host.c - Hosted HAL
+ * ========================
+ *
+ * See hal_host.h. Everything here is either a fixed answer or a thin
+ * wrapper over libc; nothing is simulated beyond what the shared code
+ * needs to run.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/mman.h>
+
+#include "hal_host.h"
+#include "hal.h"
+#include "hal_dma.h"
+#include "fb_format.h"
+
+/* Read by kernel_main() / heap_init(), set by the boot code on a board */
+uint64_t __ram_base;
+uint64_t __ram_size;
+
+/* =============================================================================
+ * RAM
+ * =============================================================================
+ *
+ * __heap_start, __dma_start and __dma_end are --defsym'd to fixed
+ * addresses inside this mapping, exactly as a linker script places them
+ * inside RAM. MAP_FIXED_NOREPLACE fails rather than clobbering anything
+ * that already lives there.
+ */
+
+bool host_ram_init(void)
+{
+    void *p = mmap((void *)HOST_RAM_BASE, HOST_RAM_SIZE, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if (p != (void *)HOST_RAM_BASE) {
+        if (p != MAP_FAILED) munmap(p, HOST_RAM_SIZE);
+        return false;
+    }
+
+    __ram_base = HOST_RAM_BASE;
+    __ram_size = HOST_RAM_SIZE;
+    return true;
+}
+
+/* =============================================================================
+ * FRAMEBUFFER
+ * =============================================================================
+ */
+
+bool host_fb_create(framebuffer_t *fb, uint32_t width, uint32_t height,
+                    fb_pixel_format_t format)
+{
+    const fb_pixel_ops_t *ops = fb_format_ops(format);
+    if (ops == NULL || width == 0 || height == 0) return false;
+
+    /* Rows padded to 64 bytes, like the VideoCore's pitch */
+    uint32_t pitch = (width * ops->bpp + 63) & ~63u;
+    size_t   size  = (size_t)pitch * height;
+
+    void *mem = NULL;
+    if (posix_memalign(&mem, 64, size * FB_BUFFER_COUNT) != 0) return false;
+    memset(mem, 0, size * FB_BUFFER_COUNT);
+
+    *fb = (framebuffer_t){0};
+    fb->width          = width;
+    fb->height         = height;
+    fb->pitch          = pitch;
+    fb->virtual_height = height * FB_BUFFER_COUNT;
+    fb->buffer_size    = size;
+
+    for (uint32_t b = 0; b < FB_BUFFER_COUNT; b++) {
+        fb->buffers[b] = (uint32_t *)((uint8_t *)mem + b * size);
+    }
+    fb->mem_type = hal_display_map_scanout((uintptr_t)mem, size * FB_BUFFER_COUNT);
+
+    fb->front_buffer = 0;
+    fb->scan_buffer  = 0;
+    fb->back_buffer  = (FB_BUFFER_COUNT > 1) ? 1 : 0;
+    fb->addr         = fb->buffers[fb->back_buffer];
+
+    fb->clip_depth      = 0;
+    fb->clip_stack[0].x = 0;
+    fb->clip_stack[0].y = 0;
+    fb->clip_stack[0].w = width;
+    fb->clip_stack[0].h = height;
+
+    fb->pixel_format = format;
+    if (!fb_format_bind(fb)) {
+        free(mem);
+        return false;
+    }
+
+    /*
+     * No display to pace to: presents complete on the spot instead of
+     * waiting out a 60 Hz flip timer, so a benchmark measures drawing.
+     */
+    fb->full_dirty    = true;
+    fb->vsync_enabled = false;
+    fb->initialized   = true;
+    return true;
+}
+
+void host_fb_destroy(framebuffer_t *fb)
+{
+    if (fb->initialized) free(fb->buffers[0]);
+    *fb = (framebuffer_t){0};
+}
+
+bool fb_init(framebuffer_t *fb)
+{
+    return host_fb_create(fb, 1280, 720, FB_FORMAT_ARGB8888);
+}
+
+bool fb_init_with_size(framebuffer_t *fb, uint32_t width, uint32_t height)
+{
+    return host_fb_create(fb, width, height, FB_FORMAT_ARGB8888);
+}
+
+/* Nothing scans the buffer out; front_buffer is the "screen" */
+void fb_flip_display(framebuffer_t *fb)
+{
+    (void)fb;
+}
+
+/* =============================================================================
+ * PLATFORM — A FIXED, MADE-UP BOARD
+ * =============================================================================
+ */
+
+hal_error_t hal_platform_get_info(hal_platform_info_t *info)
+{
+    if (info == NULL) return HAL_ERROR_NULL_PTR;
+
+    info->platform_id    = HAL_PLATFORM_UNKNOWN;
+    info->arch           = HAL_ARCH_UNKNOWN;
+    info->board_name     = "Hosted";
+    info->soc_name       = "host";
+    info->board_revision = 0;
+    info->serial_number  = 0x0123456789ABCDEFULL;
+    return HAL_SUCCESS;
+}
+
+hal_error_t hal_platform_get_memory_info(hal_memory_info_t *info)
+{
+    if (info == NULL) return HAL_ERROR_NULL_PTR;
+
+    info->arm_base        = HOST_RAM_BASE;
+    info->arm_size        = HOST_RAM_SIZE;
+    info->peripheral_base = 0;
+    info->gpu_base        = 0;
+    info->gpu_size        = 0;
+    return HAL_SUCCESS;
+}
+
+uint32_t hal_platform_get_arm_freq(void)
+{
+    return 1000000000;
+}
+
+uint32_t hal_platform_get_clock_rate(hal_clock_id_t clock_id)
+{
+    switch (clock_id) {
+        case HAL_CLOCK_ARM:  return 1000000000;
+        case HAL_CLOCK_CORE: return 400000000;
+        case HAL_CLOCK_UART: return 48000000;
+        case HAL_CLOCK_EMMC: return 250000000;
+        default:             return 0;
+    }
+}
+
+hal_error_t hal_platform_get_temperature(int32_t *temp_mc)
+{
+    if (temp_mc == NULL) return HAL_ERROR_NULL_PTR;
+    *temp_mc = 45000;
+    return HAL_SUCCESS;
+}
+
+hal_error_t hal_platform_get_max_temperature(int32_t *temp_mc)
+{
+    if (temp_mc == NULL) return HAL_ERROR_NULL_PTR;
+    *temp_mc = 85000;
+    return HAL_SUCCESS;
+}
+
+hal_error_t hal_platform_get_throttle_status(uint32_t *status)
+{
+    if (status == NULL) return HAL_ERROR_NULL_PTR;
+    *status = 0;
+    return HAL_SUCCESS;
+}
+
+hal_error_t hal_platform_get_power(hal_device_id_t device, bool *on)
+{
+    (void)device;
+    if (on == NULL) return HAL_ERROR_NULL_PTR;
+    *on = true;
+    return HAL_SUCCESS;
+}
+
+/* =============================================================================
+ * GPIO — TWO BANKS OF LATCHES, NOTHING ATTACHED
+ * =============================================================================
+ *
+ * Enough for gpio_wave and its benchmarks: levels are remembered and read
+ * back. There is no set/clear register pair, so hal_gpio_get_port() keeps
+ * its weak default and replay goes through the bulk calls.
+ */
+
+#define HOST_GPIO_PINS      64
+
+static uint32_t g_gpio_level[2];
+
+hal_error_t hal_gpio_configure_dpi(void)
+{
+    return HAL_SUCCESS;
+}
+
+hal_error_t hal_gpio_set_high(uint32_t pin)
+{
+    if (pin >= HOST_GPIO_PINS) return HAL_ERROR_GPIO_INVALID_PIN;
+    g_gpio_level[pin / 32] |= 1u << (pin % 32);
+    return HAL_SUCCESS;
+}
+
+hal_error_t hal_gpio_set_low(uint32_t pin)
+{
+    if (pin >= HOST_GPIO_PINS) return HAL_ERROR_GPIO_INVALID_PIN;
+    g_gpio_level[pin / 32] &= ~(1u << (pin % 32));
+    return HAL_SUCCESS;
+}
+
+hal_error_t hal_gpio_set_mask(uint32_t mask, uint32_t bank)
+{
+    if (bank > 1) return HAL_ERROR_INVALID_ARG;
+    g_gpio_level[bank] |= mask;
+    return HAL_SUCCESS;
+}
+
+hal_error_t hal_gpio_clear_mask(uint32_t mask, uint32_t bank)
+{
+    if (bank > 1) return HAL_ERROR_INVALID_ARG;
+    g_gpio_level[bank] &= ~mask;
+    return HAL_SUCCESS;
+}
+
+uint32_t hal_gpio_read_mask(uint32_t bank)
+{
+    return bank > 1 ? 0 : g_gpio_level[bank];
+}
+
+/* =============================================================================
+ * TIMER
+ * =============================================================================
+ */
+
+#define HOST_FROZEN_US      1000000ULL
+
+static bool g_timer_frozen;
+
+void host_timer_freeze(bool frozen)
+{
+    g_timer_frozen = frozen;
+}
+
+uint64_t hal_timer_get_ticks(void)
+{
+    if (g_timer_frozen) return HOST_FROZEN_US;
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000;
+}
+
+uint32_t hal_timer_get_ticks32(void)
+{
+    return (uint32_t)hal_timer_get_ticks();
+}
+
+uint64_t hal_timer_get_ms(void)
+{
+    return hal_timer_get_ticks() / 1000;
+}
+
+/* =============================================================================
+ * DMA — NO ENGINE
+ * =============================================================================
+ */
+
+hal_error_t hal_dma_2d_submit(hal_dma_channel_t ch, const hal_dma_2d_t *xfers,
+                              uint32_t count, hal_dma_fence_t *fence_out)
+{
+    (void)ch;
+    (void)xfers;
+    (void)count;
+    (void)fence_out;
+    return HAL_ERROR_NOT_SUPPORTED;
+}
+
+hal_error_t hal_dma_fence_wait(hal_dma_fence_t fence)
+{
+    (void)fence;
+    return HAL_SUCCESS;
+}
+
+uintptr_t hal_dma_to_device_addr(void *cpu_addr)
+{
+    return (uintptr_t)cpu_addr;
+}
+
+/* =============================================================================
+ * DEBUG UART
+ * =============================================================================
+ */
+
+void hal_debug_putc(char c)
+{
+    fputc(c, stdout);
+}
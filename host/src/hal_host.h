@@ -0,0 +1,55 @@
+/*
+ * hal_host.h - Hosted HAL
+ * ========================
+ *
+ * The drivers, memory and UI layers only ever reach hardware through
+ * hal_*() calls, so they build unchanged as an ordinary Linux program once
+ * something answers those calls. hal_host.c is that something:
+ *
+ *   RAM          one mmap() at HOST_RAM_BASE laid out like a linker
+ *                script would (.dma_coherent, then the heap; see
+ *                host/Makefile for the --defsym lines), so every address
+ *                the sysinfo screen prints is the same from run to run
+ *   framebuffer  FB_BUFFER_COUNT buffers in host memory, stacked like the
+ *                VideoCore allocation; "scan-out" is a no-op
+ *   platform     a fixed, made-up board: same clocks, same temperature,
+ *                every time — the pixels must not depend on the host
+ *   timer        CLOCK_MONOTONIC in microseconds, or stopped (below)
+ *   debug UART   stdout
+ *
+ * One core and no DMA engine: smp_init() finds no secondaries and every
+ * job_parallel_for() runs inline, and fb_clear()/fb_copy_rect() take
+ * their CPU paths. Benchmarks taken here measure the rasterizer's code,
+ * not a board.
+ */
+
+#ifndef HAL_HOST_H
+#define HAL_HOST_H
+
+#include "types.h"
+#include "framebuffer.h"
+
+/* Must match the --defsym addresses in host/Makefile */
+#define HOST_RAM_BASE       0x40000000UL
+#define HOST_RAM_SIZE       (64UL * 1024 * 1024)
+
+/* Map RAM and publish __ram_base / __ram_size. False if the map failed. */
+bool host_ram_init(void);
+
+/*
+ * A RAM-backed framebuffer_t, set up the way display drivers do it
+ * (buffers[], clip_stack[0], ops). fb_init() makes a 1280x720 ARGB8888 one.
+ * Returns false for an unknown format or out of memory.
+ */
+bool host_fb_create(framebuffer_t *fb, uint32_t width, uint32_t height,
+                    fb_pixel_format_t format);
+void host_fb_destroy(framebuffer_t *fb);
+
+/*
+ * Stop the clock at a fixed time, or start it again. Golden scenes draw
+ * with it stopped: the HEAP panel prints the allocator's measured latency,
+ * which would otherwise differ from run to run.
+ */
+void host_timer_freeze(bool frozen);
+
+#endif /* HAL_HOST_H */
@@ -0,0 +1,790 @@
+/*
+ * host_main.c - Hosted Benchmarks and Golden Images
+ * ==================================================
+ *
+ * The rasterizer, the allocator and the widgets built as a Linux program
+ * (hal_host.h), so a change to any of them can be timed and checked
+ * without flashing a board:
+ *
+ *   make -C host bench     frames/s for the system-info screen, ops/s for
+ *                          the allocators and GPIO waveforms — same
+ *                          @bench/@B lines as APP=bench, so
+ *                          board/benchdiff.py compares them
+ *   make -C host check     draw every scene, compare with host/golden.txt;
+ *                          also checks the frame arenas' lifetime
+ *   make -C host record    rewrite host/golden.txt after an intended
+ *                          change to what the pixels should be
+ *
+ * THE SYSTEM-INFO SCREEN:
+ * -----------------------
+ * kernel/src/main.c is #included below with kernel_main renamed, so these
+ * scenes run its real static functions — compute_layout(), the first
+ * frame's first_frame_begin()/first_frame_finish(), the display list —
+ * instead of a copy that could drift. A scene is what kernel_main() puts
+ * on screen: the first frame, then N passes of its render loop (the loop
+ * body less its profiling, restated in sysinfo_update()). The heap is re-initialised first and the clock is
+ * stopped (host_timer_freeze), so the HEAP panel shows the same numbers
+ * every run.
+ *
+ * GOLDEN IMAGES:
+ * --------------
+ * A scene's checksum is FNV-1a 64 over the visible front buffer, row by
+ * row — width × bpp bytes per row, so pitch padding never counts. A
+ * mismatch means pixels changed: intended (record again, and say so in
+ * the commit) or not (a bug). The checksum doesn't say where; `check -v`
+ * prints every scene, and a single scene can be dumped with `ppm`.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hal_host.h"
+
+#define kernel_main host_kernel_main_unused
+#include "../../kernel/src/main.c"
+#undef kernel_main
+
+#include "fb_format.h"
+#include "fb_panel.h"
+#include "gpio_wave.h"
+#include "../../memory/src/pool.h"
+
+/* =============================================================================
+ * CONFIGURATION
+ * =============================================================================
+ */
+
+#define BENCH_MIN_US        200000U         /* Shortest timed batch */
+#define BENCH_MAX_ITERS     (1U << 24)
+#define BENCH_ROUNDS        5U
+#define BENCH_HEAP_BLOCKS   64U
+#define BENCH_GPIO_BYTES    64U
+#define BENCH_WAVE_STEPS    (BENCH_GPIO_BYTES * 16 + 1)     /* SPI: two per bit, one to idle */
+
+#define GOLDEN_MAX_SCENES   32U
+
+/* =============================================================================
+ * THE SYSTEM-INFO SCREEN
+ * =============================================================================
+ */
+
+typedef struct {
+    framebuffer_t   fb;
+    ui_theme_t      theme;
+    layout_t        L;
+    static_state_t  s;
+    dynamic_state_t d;
+} sysinfo_t;
+
+static void host_heap_reset(void)
+{
+    heap_init((uintptr_t)__ram_base, (size_t)__ram_size);
+    frame_arena_init(FRAME_ARENA_SIZE);
+    dma_pool_init();
+}
+
+/*
+ * kernel_main() up to and including the first fb_present(), with the boot
+ * queries run inline instead of on a worker
+ */
+static void sysinfo_first_frame(sysinfo_t *app)
+{
+    framebuffer_t *fb = &app->fb;
+
+    app->theme = ui_theme_for_width(fb->width, UI_PALETTE_DARK);
+    app->L     = compute_layout(fb->width, fb->height);
+    static_state_init(&app->s, fb->width);
+    dynamic_state_poll(&app->d);
+
+    fb_surface_t  *toasts;
+    framebuffer_t *base = first_frame_begin(fb, &app->L, &app->theme, &toasts);
+    first_frame_finish(fb, base, toasts, &app->L, &app->theme, &app->s, &app->d);
+}
+
+/* One pass of kernel_main()'s render loop, without the profiling HUD */
+static void sysinfo_update(sysinfo_t *app)
+{
+    framebuffer_t *fb = &app->fb;
+
+    dynamic_state_poll(&app->d);
+    fb_wait_flip(fb);
+    dyn_dl_begin(fb);
+    draw_dynamic_panels(fb, &app->L, &app->theme, &app->s, &app->d);
+    ui_dl_end(&dyn_dl);
+    fb_present_async(fb);
+}
+
+static bool sysinfo_open(sysinfo_t *app, uint32_t w, uint32_t h)
+{
+    host_heap_reset();
+    return host_fb_create(&app->fb, w, h, FB_FORMAT_ARGB8888);
+}
+
+/* =============================================================================
+ * PRIMITIVES SCENE
+ * =============================================================================
+ *
+ * One of everything, including shapes that hang off every edge, so the
+ * clipping paths are covered too. Drawn once per pixel format.
+ */
+
+static void draw_primitives(framebuffer_t *fb)
+{
+    ui_theme_t theme = ui_theme_for_width(fb->width, UI_PALETTE_DARK);
+    int32_t    w     = (int32_t)fb->width;
+    int32_t    h     = (int32_t)fb->height;
+
+    fb_clear(fb, 0xFF203040);
+
+    fb_fill_rect(fb, 8, 8, 64, 40, 0xFFE04030);
+    fb_fill_rect_blend(fb, 40, 24, 64, 40, 0x8030C060);
+    fb_draw_rect(fb, 4, 4, 104, 64, 0xFFFFFFFF);
+    fb_fill_rounded_rect(fb, 120, 8, 80, 48, 10, 0xFF3060E0);
+    fb_fill_rounded_rect_blend(fb, 150, 30, 80, 48, 12, 0xA0F0C020);
+    fb_draw_rounded_rect(fb, 116, 4, 88, 56, 12, 0xFFFFFFFF);
+
+    for (int32_t i = 0; i < 12; i++) {
+        fb_draw_line(fb, w / 2, h / 2, (i * w) / 6 - w / 2, (i & 1) ? -20 : h + 20,
+                     0xFF000000u | (uint32_t)(i * 0x151515));
+    }
+    fb_draw_circle(fb, 40, h - 40, 30, 0xFFFFFFFF);
+    fb_fill_circle(fb, w - 10, h / 2, 40, 0xFF40E0E0);
+    fb_fill_circle(fb, -10, 10, 30, 0xFFE040E0);
+
+    fb_draw_string(fb, 8, h / 2, "Tutorial-OS 0123456789", 0xFFFFFFFF, 0xFF000000);
+    fb_draw_string_transparent(fb, 8, h / 2 + 12, "transparent text", 0xFFFFFF00);
+    fb_draw_string_scaled(fb, 8, h / 2 + 24, "x2", 0xFF00FF00, 0xFF202020, 2);
+
+    ui_draw_panel(fb, ui_rect(w - 150, 70, 140, 60), &theme, UI_PANEL_ELEVATED);
+    ui_draw_progress_bar(fb, ui_rect(w - 140, 100, 120, 10), &theme, 62, 0);
+    ui_draw_toast(fb, ui_rect(w - 150, h - 40, 140, 30), &theme, "saved", UI_TOAST_SUCCESS);
+
+    fb_present(fb);
+}
+
+/* =============================================================================
+ * CIRCLES SCENE
+ * =============================================================================
+ *
+ * Filled circles under an outline of the same radius, radius 0 to 23 and
+ * two large ones, one hanging off the edge. The fill must stop exactly
+ * at its border: a fill pixel outside the outline shows up green against
+ * the background.
+ */
+
+static void draw_circles(framebuffer_t *fb)
+{
+    int32_t w = (int32_t)fb->width;
+    int32_t h = (int32_t)fb->height;
+
+    fb_clear(fb, 0xFF101010);
+
+    for (uint32_t r = 0; r < 24; r++) {
+        int32_t cx = 28 + (int32_t)(r % 6) * 52;
+        int32_t cy = 28 + (int32_t)(r / 6) * 52;
+        fb_fill_circle(fb, cx, cy, r, 0xFF30E060);
+        fb_draw_circle(fb, cx, cy, r, 0xFFFFFFFF);
+    }
+
+    /* Two large ones, the second clipped by the right and bottom edges */
+    fb_fill_circle(fb, w - 40, 50, 37, 0xFF30E060);
+    fb_draw_circle(fb, w - 40, 50, 37, 0xFFFFFFFF);
+    fb_fill_circle(fb, w - 10, h - 40, 72, 0xFF30E060);
+    fb_draw_circle(fb, w - 10, h - 40, 72, 0xFFFFFFFF);
+
+    fb_present(fb);
+}
+
+/* =============================================================================
+ * SCENES
+ * =============================================================================
+ */
+
+typedef struct {
+    const char *name;
+    uint32_t    width;
+    uint32_t    height;
+    uint32_t    format;     /* fb_pixel_format_t; sysinfo is ARGB8888 only */
+    uint32_t    updates;    /* Render-loop passes after the first frame */
+    void      (*draw)(framebuffer_t *fb);   /* NULL: the system-info screen */
+} scene_t;
+
+static const scene_t k_scenes[] = {
+    { "sysinfo.640x480",          640,  480, FB_FORMAT_ARGB8888, 0, NULL },
+    { "sysinfo.640x480.update3",  640,  480, FB_FORMAT_ARGB8888, 3, NULL },
+    { "sysinfo.1280x720",        1280,  720, FB_FORMAT_ARGB8888, 0, NULL },
+    { "sysinfo.1920x1080",       1920, 1080, FB_FORMAT_ARGB8888, 0, NULL },
+    { "sysinfo.1920x1080.update3", 1920, 1080, FB_FORMAT_ARGB8888, 3, NULL },
+    { "prims.argb8888",           320,  240, FB_FORMAT_ARGB8888, 0, draw_primitives },
+    { "prims.rgb565",             320,  240, FB_FORMAT_RGB565,   0, draw_primitives },
+    { "circles.argb8888",         400,  240, FB_FORMAT_ARGB8888, 0, draw_circles },
+};
+
+static uint64_t fb_checksum(const framebuffer_t *fb)
+{
+    const uint8_t *base = (const uint8_t *)fb->buffers[fb->front_buffer];
+    size_t         row  = (size_t)fb->width * fb->ops->bpp;
+    uint64_t       h    = 0xCBF29CE484222325ULL;
+
+    for (uint32_t y = 0; y < fb->height; y++) {
+        const uint8_t *p = base + (size_t)y * fb->pitch;
+        for (size_t i = 0; i < row; i++) {
+            h ^= p[i];
+            h *= 0x100000001B3ULL;
+        }
+    }
+    return h;
+}
+
+/* Draw a scene into app->fb, clock stopped; the caller destroys it */
+static bool scene_draw(const scene_t *sc, sysinfo_t *app)
+{
+    bool ok = true;
+
+    host_timer_freeze(true);
+    if (sc->draw == NULL) {
+        ok = sysinfo_open(app, sc->width, sc->height);
+        if (ok) {
+            sysinfo_first_frame(app);
+            for (uint32_t i = 0; i < sc->updates; i++) sysinfo_update(app);
+            fb_wait_flip(&app->fb);
+        }
+    } else {
+        host_heap_reset();
+        ok = host_fb_create(&app->fb, sc->width, sc->height,
+                            (fb_pixel_format_t)sc->format);
+        if (ok) sc->draw(&app->fb);
+    }
+    host_timer_freeze(false);
+    return ok;
+}
+
+static const scene_t *scene_find(const char *name)
+{
+    for (uint32_t i = 0; i < ARRAY_SIZE(k_scenes); i++) {
+        if (strcmp(k_scenes[i].name, name) == 0) return &k_scenes[i];
+    }
+    return NULL;
+}
+
+/* =============================================================================
+ * GOLDEN FILE
+ * =============================================================================
+ *
+ *   # comment
+ *   <scene> <16 hex digits>
+ */
+
+typedef struct {
+    char     name[64];
+    uint64_t sum;
+} golden_t;
+
+static uint32_t golden_load(const char *path, golden_t *out, uint32_t max)
+{
+    FILE *f = fopen(path, "r");
+    if (f == NULL) return 0;
+
+    char     line[160];
+    uint32_t n = 0;
+    while (n < max && fgets(line, sizeof(line), f)) {
+        unsigned long long sum;
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%63s %llx", out[n].name, &sum) == 2) {
+            out[n].sum = sum;
+            n++;
+        }
+    }
+    fclose(f);
+    return n;
+}
+
+static int cmd_record(const char *path)
+{
+    FILE *f = fopen(path, "w");
+    if (f == NULL) {
+        fprintf(stderr, "record: cannot write %s\n", path);
+        return 1;
+    }
+
+    fprintf(f, "# Golden checksums for host/src/host_main.c (make -C host record)\n");
+    for (uint32_t i = 0; i < ARRAY_SIZE(k_scenes); i++) {
+        sysinfo_t app;
+        if (!scene_draw(&k_scenes[i], &app)) {
+            fprintf(stderr, "record: %s: no framebuffer\n", k_scenes[i].name);
+            fclose(f);
+            return 1;
+        }
+        fprintf(f, "%s %016llx\n", k_scenes[i].name,
+                (unsigned long long)fb_checksum(&app.fb));
+        host_fb_destroy(&app.fb);
+    }
+    fclose(f);
+    printf("recorded %u scenes in %s\n", (unsigned)ARRAY_SIZE(k_scenes), path);
+    return 0;
+}
+
+/*
+ * The frame-arena promise (arena.h) the display list now relies on: a
+ * frame_alloc() block survives the next fb_present() and is recycled by
+ * the one after.
+ */
+static bool frame_arena_check(void)
+{
+    framebuffer_t fb;
+    bool          ok;
+
+    host_heap_reset();
+    if (!host_fb_create(&fb, 64, 64, FB_FORMAT_ARGB8888)) return false;
+
+    uint8_t *a = frame_alloc(256);
+    ok = a != NULL;
+    if (ok) memset(a, 0xA5, 256);
+    fb_present(&fb);
+
+    uint8_t *b = frame_alloc(256);
+    ok = ok && b != NULL && (b + 256 <= a || b >= a + 256);
+    if (ok) memset(b, 0x5A, 256);
+    for (uint32_t i = 0; ok && i < 256; i++) ok = a[i] == 0xA5;
+    fb_present(&fb);
+
+    ok = ok && frame_alloc(256) == a;
+    host_fb_destroy(&fb);
+    return ok;
+}
+
+static int cmd_check(const char *path, bool verbose)
+{
+    golden_t gold[GOLDEN_MAX_SCENES];
+    uint32_t ngold = golden_load(path, gold, GOLDEN_MAX_SCENES);
+    if (ngold == 0) {
+        fprintf(stderr, "check: no checksums in %s (make -C host record)\n", path);
+        return 1;
+    }
+
+    uint32_t failed = 0;
+    for (uint32_t i = 0; i < ARRAY_SIZE(k_scenes); i++) {
+        const scene_t *sc = &k_scenes[i];
+        const golden_t *g = NULL;
+        for (uint32_t j = 0; j < ngold; j++) {
+            if (strcmp(gold[j].name, sc->name) == 0) g = &gold[j];
+        }
+
+        sysinfo_t app;
+        if (!scene_draw(sc, &app)) {
+            printf("FAIL  %-28s no framebuffer\n", sc->name);
+            failed++;
+            continue;
+        }
+        uint64_t sum = fb_checksum(&app.fb);
+        host_fb_destroy(&app.fb);
+
+        if (g == NULL) {
+            printf("FAIL  %-28s %016llx  not in %s\n", sc->name,
+                   (unsigned long long)sum, path);
+            failed++;
+        } else if (g->sum != sum) {
+            printf("FAIL  %-28s %016llx  expected %016llx\n", sc->name,
+                   (unsigned long long)sum, (unsigned long long)g->sum);
+            failed++;
+        } else if (verbose) {
+            printf("ok    %-28s %016llx\n", sc->name, (unsigned long long)sum);
+        }
+    }
+
+    printf("%u/%u scenes match %s\n", (unsigned)(ARRAY_SIZE(k_scenes) - failed),
+           (unsigned)ARRAY_SIZE(k_scenes), path);
+
+    if (!frame_arena_check()) {
+        printf("FAIL  frame_alloc() block doesn't live exactly one present\n");
+        failed++;
+    }
+    return failed ? 1 : 0;
+}
+
+/* Binary PPM of one scene's front buffer, for looking at a mismatch */
+static int cmd_ppm(const char *name, const char *path)
+{
+    const scene_t *sc = scene_find(name);
+    if (sc == NULL) {
+        fprintf(stderr, "ppm: unknown scene %s\n", name);
+        return 1;
+    }
+
+    sysinfo_t app;
+    FILE *f = fopen(path, "wb");
+    if (f == NULL || !scene_draw(sc, &app)) {
+        fprintf(stderr, "ppm: cannot draw %s to %s\n", name, path);
+        if (f) fclose(f);
+        return 1;
+    }
+
+    framebuffer_t *fb = &app.fb;
+    fb->addr = fb->buffers[fb->front_buffer];
+    fprintf(f, "P6\n%u %u\n255\n", fb->width, fb->height);
+    for (uint32_t y = 0; y < fb->height; y++) {
+        for (uint32_t x = 0; x < fb->width; x++) {
+            uint32_t c = fb_get_pixel(fb, x, y);
+            if (fb->pixel_format == FB_FORMAT_ABGR8888) {
+                c = (c & 0xFF00FF00u) | ((c >> 16) & 0xFF) | ((c & 0xFF) << 16);
+            }
+            uint8_t rgb[3] = { (uint8_t)(c >> 16), (uint8_t)(c >> 8), (uint8_t)c };
+            fwrite(rgb, 1, 3, f);
+        }
+    }
+    fclose(f);
+    host_fb_destroy(fb);
+    return 0;
+}
+
+/* =============================================================================
+ * BENCHMARKS
+ * =============================================================================
+ *
+ * The timing loop of kernel/src/bench.c: grow the batch until it takes
+ * BENCH_MIN_US, report the best of BENCH_ROUNDS. Batches are ten times
+ * longer than on a board, because a desktop scheduler is noisier than an
+ * idle bare-metal core.
+ */
+
+typedef struct {
+    sysinfo_t   app;
+    uint32_t    size;       /* The <param> of the current run */
+    void       *blocks[BENCH_HEAP_BLOCKS];
+    arena_t     arena;
+    pool_t      pool;
+    fb_panel_t  panel;
+    uint8_t     gpio_data[BENCH_GPIO_BYTES];
+    gpio_wave_t wave;
+} bench_ctx_t;
+
+typedef void (*bench_fn_t)(bench_ctx_t *c, uint32_t iters);
+
+static uint64_t time_batch(bench_fn_t fn, bench_ctx_t *c, uint32_t iters)
+{
+    uint64_t t0 = hal_timer_get_ticks();
+    fn(c, iters);
+    return hal_timer_get_ticks() - t0;
+}
+
+static void bench_run(const char *name, bench_fn_t fn, bench_ctx_t *c, uint64_t bytes)
+{
+    uint32_t iters = 1;
+    uint64_t us;
+
+    fn(c, 1);
+    for (;;) {
+        us = time_batch(fn, c, iters);
+        if (us >= BENCH_MIN_US || iters >= BENCH_MAX_ITERS) break;
+
+        uint64_t next = us < BENCH_MIN_US / 8 ? (uint64_t)iters * 8
+                                              : (uint64_t)iters * BENCH_MIN_US / us + 1;
+        iters = next > BENCH_MAX_ITERS ? BENCH_MAX_ITERS : (uint32_t)next;
+    }
+    for (uint32_t r = 1; r < BENCH_ROUNDS; r++) {
+        uint64_t t = time_batch(fn, c, iters);
+        if (t < us) us = t;
+    }
+    if (us == 0) us = 1;
+
+    uint64_t ns_op = us * 1000 / iters;
+    uint64_t mbps  = bytes * iters / us;
+
+    hal_debug_printf("@B %s %u %u %u %u %u\n", name, c->size, iters,
+                     (uint32_t)us, (uint32_t)ns_op, (uint32_t)mbps);
+}
+
+/* --- Screen ----------------------------------------------------------------*/
+
+static void b_sysinfo_full(bench_ctx_t *c, uint32_t n)
+{
+    while (n--) sysinfo_first_frame(&c->app);
+}
+
+static void b_sysinfo_update(bench_ctx_t *c, uint32_t n)
+{
+    while (n--) sysinfo_update(&c->app);
+    fb_wait_flip(&c->app.fb);
+}
+
+static void bench_screen(bench_ctx_t *c)
+{
+    static const uint32_t sizes[][2] = { { 640, 480 }, { 1280, 720 }, { 1920, 1080 } };
+
+    for (uint32_t i = 0; i < ARRAY_SIZE(sizes); i++) {
+        if (!sysinfo_open(&c->app, sizes[i][0], sizes[i][1])) continue;
+
+        c->size = sizes[i][1];
+        bench_run("sysinfo.full",   b_sysinfo_full,   c, c->app.fb.buffer_size);
+        bench_run("sysinfo.update", b_sysinfo_update, c, 0);
+        host_fb_destroy(&c->app.fb);
+    }
+}
+
+/* --- SPI panel -------------------------------------------------------------
+ *
+ * fb_panel streaming the pico2-lafvin shadow buffer (320×480 RGB565) into
+ * a pretend ILI9488: the link writes each window into an RGB666 copy of
+ * panel RAM, with no time on the wire. What this times is conversion and
+ * window bookkeeping; the MB/s column is wire bytes, the number that sets
+ * the frame rate on the board.
+ */
+
+#define PANEL_W     320
+#define PANEL_H     480
+
+typedef struct {
+    uint8_t  ram[PANEL_W * PANEL_H * 3];
+    uint32_t x, y, w, h;        /* Open window */
+    uint32_t pos;               /* Pixels written into it */
+} host_panel_t;
+
+static host_panel_t g_host_panel;
+
+static void host_panel_window(void *ctx, uint32_t x, uint32_t y, uint32_t w, uint32_t h)
+{
+    host_panel_t *hp = (host_panel_t *)ctx;
+    hp->x = x; hp->y = y; hp->w = w; hp->h = h;
+    hp->pos = 0;
+}
+
+static void host_panel_send(void *ctx, const uint8_t *data, uint32_t len)
+{
+    host_panel_t *hp = (host_panel_t *)ctx;
+    for (uint32_t i = 0; i + 3 <= len && hp->pos < hp->w * hp->h; i += 3, hp->pos++) {
+        uint32_t px = hp->x + hp->pos % hp->w;
+        uint32_t py = hp->y + hp->pos / hp->w;
+        memcpy(&hp->ram[(py * PANEL_W + px) * 3], data + i, 3);
+    }
+}
+
+static void host_panel_drain(void *ctx, uint32_t pending)
+{
+    (void)ctx;
+    (void)pending;
+}
+
+static const fb_panel_link_t k_host_panel_link = {
+    .ctx    = &g_host_panel,
+    .window = host_panel_window,
+    .send   = host_panel_send,
+    .drain  = host_panel_drain,
+};
+
+static void b_panel_full(bench_ctx_t *c, uint32_t n)
+{
+    while (n--) {
+        fb_mark_all_dirty(&c->app.fb);
+        fb_panel_present(&c->panel, &c->app.fb);
+        fb_clear_dirty(&c->app.fb);
+    }
+}
+
+/* What the system-info loop redraws each second: two panels' contents */
+static void b_panel_update(bench_ctx_t *c, uint32_t n)
+{
+    while (n--) {
+        fb_mark_dirty(&c->app.fb, 12, 60, 140, 48);
+        fb_mark_dirty(&c->app.fb, 168, 60, 140, 48);
+        fb_mark_dirty(&c->app.fb, 12, 300, 296, 24);
+        fb_panel_present(&c->panel, &c->app.fb);
+        fb_clear_dirty(&c->app.fb);
+    }
+}
+
+static void bench_panel(bench_ctx_t *c)
+{
+    host_heap_reset();
+    if (!host_fb_create(&c->app.fb, PANEL_W, PANEL_H, FB_FORMAT_RGB565)) return;
+    draw_primitives(&c->app.fb);
+
+    if (fb_panel_init(&c->panel, &c->app.fb, &k_host_panel_link, FB_PANEL_RGB666, 0)) {
+        uint64_t full = (uint64_t)PANEL_W * PANEL_H * 3;
+        uint64_t update = (uint64_t)(2 * 140 * 48 + 296 * 24) * 3;
+
+        c->size = PANEL_H;
+        bench_run("panel.full",   b_panel_full,   c, full);
+        bench_run("panel.update", b_panel_update, c, update);
+        fb_panel_destroy(&c->panel);
+    }
+    host_fb_destroy(&c->app.fb);
+}
+
+/* --- GPIO waveforms --------------------------------------------------------
+ *
+ * The gpio.* group of kernel/src/bench.c against hal_host's latches: no
+ * bus to wait on, so this is the cost of the calls and the replay loop
+ * alone — gpio.pins against gpio.bus_wave is what batching saves before
+ * any register is involved.
+ */
+
+static gpio_wave_step_t g_wave_steps[BENCH_WAVE_STEPS];
+
+static const gpio_wave_bus_t k_bench_bus = { .shift = 0, .width = 8, .strobe = 1u << 8 };
+static const gpio_wave_spi_t k_bench_spi = { .mosi = 1u << 9, .sclk = 1u << 10 };
+
+static void b_gpio_pins(bench_ctx_t *c, uint32_t n)
+{
+    while (n--) {
+        for (uint32_t i = 0; i < BENCH_GPIO_BYTES; i++) {
+            for (uint32_t b = 0; b < 8; b++) {
+                if ((c->gpio_data[i] >> b) & 1) {
+                    hal_gpio_set_high(b);
+                } else {
+                    hal_gpio_set_low(b);
+                }
+            }
+            hal_gpio_set_low(8);
+            hal_gpio_set_high(8);
+        }
+    }
+}
+
+static void b_gpio_build(bench_ctx_t *c, uint32_t n)
+{
+    while (n--) {
+        gpio_wave_reset(&c->wave);
+        gpio_wave_bus_write(&c->wave, &k_bench_bus, c->gpio_data, BENCH_GPIO_BYTES);
+    }
+}
+
+static void b_gpio_play(bench_ctx_t *c, uint32_t n)
+{
+    gpio_wave_play(&c->wave, n);
+}
+
+static void bench_gpio(bench_ctx_t *c)
+{
+    for (uint32_t i = 0; i < BENCH_GPIO_BYTES; i++) {
+        c->gpio_data[i] = (uint8_t)(i * 37 + 11);
+    }
+    gpio_wave_init(&c->wave, g_wave_steps, BENCH_WAVE_STEPS, 0);
+
+    c->size = BENCH_GPIO_BYTES;
+    bench_run("gpio.pins",      b_gpio_pins,  c, BENCH_GPIO_BYTES);
+    bench_run("gpio.bus_build", b_gpio_build, c, 0);
+    bench_run("gpio.bus_wave",  b_gpio_play,  c, BENCH_GPIO_BYTES);
+
+    gpio_wave_reset(&c->wave);
+    gpio_wave_spi_write(&c->wave, &k_bench_spi, c->gpio_data, BENCH_GPIO_BYTES);
+    bench_run("gpio.spi_wave",  b_gpio_play,  c, BENCH_GPIO_BYTES);
+}
+
+/* --- Allocators -----------------------------------------------------------*/
+
+static void b_heap_lifo(bench_ctx_t *c, uint32_t n)
+{
+    while (n--) {
+        for (uint32_t i = 0; i < c->size; i++) c->blocks[i] = heap_alloc(64);
+        for (uint32_t i = c->size; i-- > 0; )   heap_free(c->blocks[i]);
+    }
+}
+
+static void b_heap_fifo(bench_ctx_t *c, uint32_t n)
+{
+    while (n--) {
+        for (uint32_t i = 0; i < c->size; i++) c->blocks[i] = heap_alloc(64);
+        for (uint32_t i = 0; i < c->size; i++) heap_free(c->blocks[i]);
+    }
+}
+
+static void b_heap_mixed(bench_ctx_t *c, uint32_t n)
+{
+    uint32_t seed = 12345;
+    while (n--) {
+        for (uint32_t i = 0; i < c->size; i++) {
+            seed = seed * 1103515245u + 12345u;
+            c->blocks[i] = heap_alloc(16u << ((seed >> 16) % 9));
+            if ((seed >> 8) & 1 && i > 0 && c->blocks[i - 1]) {
+                heap_free(c->blocks[i - 1]);
+                c->blocks[i - 1] = NULL;
+            }
+        }
+        for (uint32_t i = 0; i < c->size; i++) {
+            if (c->blocks[i]) heap_free(c->blocks[i]);
+        }
+    }
+}
+
+static void b_arena(bench_ctx_t *c, uint32_t n)
+{
+    while (n--) {
+        for (uint32_t i = 0; i < c->size; i++) c->blocks[i] = arena_alloc(&c->arena, 64);
+        arena_reset(&c->arena);
+    }
+}
+
+static void b_pool(bench_ctx_t *c, uint32_t n)
+{
+    while (n--) {
+        for (uint32_t i = 0; i < c->size; i++) c->blocks[i] = pool_get(&c->pool);
+        for (uint32_t i = 0; i < c->size; i++) pool_put(&c->pool, c->blocks[i]);
+    }
+}
+
+static void bench_alloc(bench_ctx_t *c)
+{
+    host_heap_reset();
+    c->size = BENCH_HEAP_BLOCKS;
+
+    bench_run("heap.lifo64",  b_heap_lifo,  c, 0);
+    bench_run("heap.fifo64",  b_heap_fifo,  c, 0);
+    bench_run("heap.mixed",   b_heap_mixed, c, 0);
+
+    if (arena_create(&c->arena, BENCH_HEAP_BLOCKS * 64)) {
+        bench_run("arena.alloc64", b_arena, c, 0);
+        arena_destroy(&c->arena);
+    }
+    if (pool_init(&c->pool, 64, BENCH_HEAP_BLOCKS, 16)) {
+        bench_run("pool.get_put64", b_pool, c, 0);
+        pool_destroy(&c->pool);
+    }
+}
+
+static int cmd_bench(void)
+{
+    static bench_ctx_t c;
+
+    /* No single screen here: each fb result's <param> is its height */
+    hal_debug_printf("@bench 1 host 0 0 0 %u\n", smp_cpu_count());
+    bench_screen(&c);
+    bench_panel(&c);
+    bench_gpio(&c);
+    bench_alloc(&c);
+    hal_debug_printf("@end\n");
+    return 0;
+}
+
+/* =============================================================================
+ * ENTRY
+ * =============================================================================
+ */
+
+static int usage(void)
+{
+    fprintf(stderr,
+            "usage: tutorial-os-host bench\n"
+            "       tutorial-os-host check [-v] <golden.txt>\n"
+            "       tutorial-os-host record <golden.txt>\n"
+            "       tutorial-os-host ppm <scene> <out.ppm>\n");
+    return 2;
+}
+
+int main(int argc, char **argv)
+{
+    if (!host_ram_init()) {
+        fprintf(stderr, "cannot map RAM at 0x%lx\n", HOST_RAM_BASE);
+        return 1;
+    }
+    hal_cache_init();
+
+    if (argc == 2 && strcmp(argv[1], "bench") == 0) return cmd_bench();
+    if (argc == 3 && strcmp(argv[1], "check") == 0) return cmd_check(argv[2], false);
+    if (argc == 4 && strcmp(argv[1], "check") == 0 && strcmp(argv[2], "-v") == 0) {
+        return cmd_check(argv[3], true);
+    }
+    if (argc == 3 && strcmp(argv[1], "record") == 0) return cmd_record(argv[2]);
+    if (argc == 4 && strcmp(argv[1], "ppm") == 0) return cmd_ppm(argv[2], argv[3]);
+    return usage();
+}
@@ -0,0 +1,621 @@
+/*
+ * bench.c - On-Target Microbenchmarks (make APP=bench)
+ * =====================================================
+ *
+ * The system-info kernel (main.c) shows that the board works; this one
+ * shows how fast. Built with `make BOARD=<board> APP=bench`, it brings up
+ * the same heap, framebuffer and cores, then times the primitives
+ * everything else is made of and prints one line per result on the debug
+ * UART:
+ *
+ *   @bench 1 <board> <width> <height> <bpp> <cpus>
+ *   @B <name> <param> <iters> <total_us> <ns_per_op> <mb_per_s>
+ *   ...
+ *   @end
+ *
+ * All fields are decimal. <param> is the size that varies within a
+ * group — bytes for mem.* and cache.*, the side of the square for fb.*,
+ * characters for text.*, blocks for heap.*, bus bytes for gpio.* — and
+ * <mb_per_s> is 0 where bytes moved aren't meaningful. Capture two runs
+ * and compare them with
+ *
+ *   python3 board/benchdiff.py before.log after.log
+ *
+ * HOW EACH NUMBER IS TAKEN:
+ * -------------------------
+ * One untimed warm-up call, then the iteration count is grown until a
+ * batch takes at least BENCH_MIN_US, then the best of BENCH_ROUNDS
+ * batches is reported. Best-of, not mean: an interrupt or a refresh
+ * cycle can only make a batch slower, so the minimum is the number that
+ * repeats from run to run. hal_timer_get_ticks() has 1 µs resolution,
+ * which is why the batches are long.
+ *
+ * Framebuffer results include whatever the primitive does beyond its
+ * inner loop — clipping, dirty tracking, the parallel bands — because
+ * that is what callers pay. fb.present includes the wait for vsync.
+ *
+ * HARDWARE COUNTERS:
+ * ------------------
+ * Where the core has a PMU (hal_perf.h), every @B line is followed by
+ * one more batch of the same size run between hal_perf_start() and
+ * hal_perf_stop():
+ *
+ *   @P <name> <param> <iters> <event>=<count> ...
+ *
+ * Counts are for the whole batch (divide by <iters>), on the boot core
+ * only — the parallel fb.* bands run partly on other cores and count
+ * just the boot core's share. A high llc_refill with high stall_backend
+ * says the primitive is waiting on DRAM; see hal_perf.h for reading them.
+ * benchdiff.py ignores @P lines.
+ */
+
+#include "types.h"
+#include "framebuffer.h"
+#include "fb_format.h"
+#include "smp.h"
+#include "timer.h"
+#include "boottime.h"
+#include "gpio_wave.h"
+
+#include "hal.h"
+#include "hal_cache.h"
+#include "hal_perf.h"
+
+#include "../../common/src/string.h"
+#include "../../memory/src/allocator.h"
+#include "../../memory/src/arena.h"
+#include "../../memory/src/dma_pool.h"
+
+extern uint64_t __ram_base;
+extern uint64_t __ram_size;
+
+/* =============================================================================
+ * CONFIGURATION
+ * =============================================================================
+ */
+
+#define BENCH_MIN_US        20000U          /* Shortest timed batch */
+#define BENCH_MAX_ITERS     (1U << 24)
+#define BENCH_ROUNDS        3U
+#define BENCH_BUF_BYTES     (1U << 20)      /* Largest mem/cache size */
+#define BENCH_HEAP_BLOCKS   64U
+#define FRAME_ARENA_SIZE    (64 * 1024)
+#define BENCH_GPIO_BYTES    64U
+#define BENCH_WAVE_STEPS    (BENCH_GPIO_BYTES * 16 + 1)     /* SPI: two per bit, one to idle */
+
+/*
+ * Pins the gpio.* group drives: an 8-bit bus with WR# above it, then
+ * MOSI and SCLK, eleven in a row from BENCH_GPIO_SHIFT. On the BCM2710
+ * they are GPIO 0-10, which hal_gpio_configure_dpi() has just given to
+ * the DPI block; GPSET/GPCLR only move their output latches, the pads
+ * carry on showing the picture. The JH7110 has no DPI, so GPIO 44-54,
+ * which only reach the Mars's 40-pin header — keep it empty while
+ * benchmarking.
+ */
+#if defined(SOC_JH7110)
+#define BENCH_GPIO_BANK     1
+#define BENCH_GPIO_SHIFT    12
+#else
+#define BENCH_GPIO_BANK     0
+#define BENCH_GPIO_SHIFT    0
+#endif
+
+/* =============================================================================
+ * HARNESS
+ * =============================================================================
+ */
+
+typedef struct {
+    framebuffer_t *fb;
+    uint8_t       *src;
+    uint8_t       *dst;
+    uint32_t       size;     /* The <param> of the current run */
+    fb_bitmap_t    bitmap;
+    void          *blocks[BENCH_HEAP_BLOCKS];
+    uint8_t        gpio_data[BENCH_GPIO_BYTES];
+    gpio_wave_t    wave;
+} bench_ctx_t;
+
+typedef void (*bench_fn_t)(bench_ctx_t *c, uint32_t iters);
+
+static bool g_perf;                     /* hal_perf is up: print @P lines */
+
+static uint64_t time_batch(bench_fn_t fn, bench_ctx_t *c, uint32_t iters)
+{
+    uint64_t t0 = hal_timer_get_ticks();
+    fn(c, iters);
+    fb_dma_wait(c->fb);                 /* Offloaded clears/copies count too */
+    return hal_timer_get_ticks() - t0;
+}
+
+/*
+ * Time fn at c->size and print its @B line. bytes is the data one
+ * iteration touches, for the MB/s column (bytes per µs = MB/s).
+ */
+static void bench_run(const char *name, bench_fn_t fn, bench_ctx_t *c, uint64_t bytes)
+{
+    uint32_t iters = 1;
+    uint64_t us;
+
+    fn(c, 1);
+    for (;;) {
+        us = time_batch(fn, c, iters);
+        if (us >= BENCH_MIN_US || iters >= BENCH_MAX_ITERS) break;
+
+        uint64_t next = us < BENCH_MIN_US / 8 ? (uint64_t)iters * 8
+                                              : (uint64_t)iters * BENCH_MIN_US / us + 1;
+        iters = next > BENCH_MAX_ITERS ? BENCH_MAX_ITERS : (uint32_t)next;
+    }
+    for (uint32_t r = 1; r < BENCH_ROUNDS; r++) {
+        uint64_t t = time_batch(fn, c, iters);
+        if (t < us) us = t;
+    }
+    if (us == 0) us = 1;
+
+    uint64_t ns_op = us * 1000 / iters;
+    uint64_t mbps  = bytes * iters / us;
+
+    hal_debug_printf("@B %s %u %u %u %u %u\n", name, c->size, iters,
+                     (uint32_t)us, (uint32_t)ns_op, (uint32_t)mbps);
+
+    if (g_perf) {
+        hal_perf_region_t r;
+
+        hal_perf_start(&r);
+        fn(c, iters);
+        fb_dma_wait(c->fb);
+        hal_perf_stop(&r);
+
+        hal_debug_printf("@P %s %u %u", name, c->size, iters);
+        for (uint32_t e = 0; e < hal_perf_count(); e++) {
+            uint64_t v = r.count[e] > 0xFFFFFFFFu ? 0xFFFFFFFFu : r.count[e];
+            hal_debug_printf(" %s=%u", hal_perf_event_name(hal_perf_event(e)), (uint32_t)v);
+        }
+        hal_debug_printf("\n");
+    }
+}
+
+/* =============================================================================
+ * MEMORY
+ * =============================================================================
+ */
+
+static void b_memcpy(bench_ctx_t *c, uint32_t n)
+{
+    while (n--) memcpy(c->dst, c->src, c->size);
+}
+
+static void b_memset(bench_ctx_t *c, uint32_t n)
+{
+    while (n--) memset(c->dst, (int)n, c->size);
+}
+
+static void bench_memory(bench_ctx_t *c)
+{
+    static const uint32_t sizes[] = { 64, 4096, 64 * 1024, BENCH_BUF_BYTES };
+
+    for (uint32_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        c->size = sizes[i];
+        bench_run("mem.memcpy", b_memcpy, c, 2ULL * c->size);
+        bench_run("mem.memset", b_memset, c, c->size);
+    }
+}
+
+/* =============================================================================
+ * FRAMEBUFFER
+ * =============================================================================
+ */
+
+static void b_clear(bench_ctx_t *c, uint32_t n)
+{
+    while (n--) fb_clear(c->fb, n & 1 ? 0xFF202020 : 0xFF000000);
+}
+
+static void b_fill_rect(bench_ctx_t *c, uint32_t n)
+{
+    while (n--) fb_fill_rect(c->fb, 8, 8, c->size, c->size, 0xFF3060C0);
+}
+
+static void b_fill_rect_blend(bench_ctx_t *c, uint32_t n)
+{
+    while (n--) fb_fill_rect_blend(c->fb, 8, 8, c->size, c->size, 0x803060C0);
+}
+
+static void b_draw_rect(bench_ctx_t *c, uint32_t n)
+{
+    while (n--) fb_draw_rect(c->fb, 8, 8, c->size, c->size, 0xFFC0C0C0);
+}
+
+static void b_draw_line(bench_ctx_t *c, uint32_t n)
+{
+    int32_t s = (int32_t)c->size;
+    while (n--) fb_draw_line(c->fb, 8, 8, 8 + s, 8 + s / 2, 0xFFFFFFFF);
+}
+
+static void b_fill_circle(bench_ctx_t *c, uint32_t n)
+{
+    int32_t r = (int32_t)c->size / 2;
+    while (n--) fb_fill_circle(c->fb, 8 + r, 8 + r, (uint32_t)r, 0xFF40A040);
+}
+
+static void b_fill_rounded(bench_ctx_t *c, uint32_t n)
+{
+    while (n--) fb_fill_rounded_rect(c->fb, 8, 8, c->size, c->size, 8, 0xFF804020);
+}
+
+static void b_copy_rect(bench_ctx_t *c, uint32_t n)
+{
+    while (n--) fb_copy_rect(c->fb, 8, 8, 16 + c->size, 8, c->size, c->size);
+}
+
+static void b_blit_opaque(bench_ctx_t *c, uint32_t n)
+{
+    while (n--) fb_blit_bitmap(c->fb, 8, 8, &c->bitmap);
+}
+
+static void b_blit_alpha(bench_ctx_t *c, uint32_t n)
+{
+    while (n--) fb_blit_bitmap_alpha(c->fb, 8, 8, &c->bitmap);
+}
+
+static void b_scroll_v(bench_ctx_t *c, uint32_t n)
+{
+    while (n--) fb_scroll_v(c->fb, (int32_t)c->size, 0xFF000000);
+}
+
+static void bench_fb(bench_ctx_t *c)
+{
+    framebuffer_t *fb  = c->fb;
+    uint32_t       bpp = fb->ops ? fb->ops->bpp : 4;
+    uint32_t       max = fb->width < fb->height ? fb->width : fb->height;
+    static const uint32_t sides[] = { 16, 64, 256 };
+
+    c->size = 0;
+    bench_run("fb.clear", b_clear, c, fb->buffer_size);
+
+    for (uint32_t i = 0; i < sizeof(sides) / sizeof(sides[0]); i++) {
+        uint32_t s = sides[i];
+        if (s + 16 > max) break;
+
+        uint64_t area = (uint64_t)s * s * bpp;
+        c->size = s;
+        bench_run("fb.fill_rect",         b_fill_rect,       c, area);
+        bench_run("fb.fill_rect_blend",   b_fill_rect_blend, c, area);
+        bench_run("fb.draw_rect",         b_draw_rect,       c, 4ULL * s * bpp);
+        bench_run("fb.draw_line",         b_draw_line,       c, 0);
+        bench_run("fb.fill_circle",       b_fill_circle,     c, 0);
+        bench_run("fb.fill_rounded_rect", b_fill_rounded,    c, area);
+        if (2 * s + 24 <= fb->width) {
+            bench_run("fb.copy_rect",     b_copy_rect,       c, 2 * area);
+        }
+        if ((uint64_t)s * s * 4 <= BENCH_BUF_BYTES) {
+            c->bitmap = (fb_bitmap_t){ s, s, (const uint32_t *)c->src, 0 };
+            bench_run("fb.blit_opaque",   b_blit_opaque,     c, area);
+            bench_run("fb.blit_alpha",    b_blit_alpha,      c, area);
+        }
+    }
+
+    c->size = 8;
+    bench_run("fb.scroll_v", b_scroll_v, c, fb->buffer_size);
+}
+
+/* =============================================================================
+ * TEXT
+ * =============================================================================
+ */
+
+static const char bench_text[] = "The quick brown fox jumps over 0123456789";
+
+static void b_string(bench_ctx_t *c, uint32_t n)
+{
+    while (n--) fb_draw_string(c->fb, 8, 8, bench_text, 0xFFFFFFFF, 0xFF000000);
+}
+
+static void b_string_transparent(bench_ctx_t *c, uint32_t n)
+{
+    while (n--) fb_draw_string_transparent(c->fb, 8, 8, bench_text, 0xFFFFFFFF);
+}
+
+static void b_string_scaled(bench_ctx_t *c, uint32_t n)
+{
+    while (n--) fb_draw_string_scaled(c->fb, 8, 8, bench_text, 0xFFFFFFFF, 0xFF000000, 2);
+}
+
+static void bench_text_render(bench_ctx_t *c)
+{
+    c->size = sizeof(bench_text) - 1;
+    bench_run("text.string",             b_string,             c, 0);
+    bench_run("text.string_transparent", b_string_transparent, c, 0);
+    bench_run("text.string_scaled2",     b_string_scaled,      c, 0);
+}
+
+/* =============================================================================
+ * ALLOCATOR
+ * =============================================================================
+ */
+
+/* Allocate c->size blocks of 64 bytes, free them newest first */
+static void b_heap_lifo(bench_ctx_t *c, uint32_t n)
+{
+    while (n--) {
+        for (uint32_t i = 0; i < c->size; i++) c->blocks[i] = heap_alloc(64);
+        for (uint32_t i = c->size; i-- > 0; )   heap_free(c->blocks[i]);
+    }
+}
+
+/* Same, freed oldest first */
+static void b_heap_fifo(bench_ctx_t *c, uint32_t n)
+{
+    while (n--) {
+        for (uint32_t i = 0; i < c->size; i++) c->blocks[i] = heap_alloc(64);
+        for (uint32_t i = 0; i < c->size; i++) heap_free(c->blocks[i]);
+    }
+}
+
+/* Sizes 16 B..4 KB from a fixed LCG, every other block freed early */
+static void b_heap_mixed(bench_ctx_t *c, uint32_t n)
+{
+    uint32_t seed = 12345;
+    while (n--) {
+        for (uint32_t i = 0; i < c->size; i++) {
+            seed = seed * 1103515245u + 12345u;
+            c->blocks[i] = heap_alloc(16u << ((seed >> 16) % 9));
+            if (i & 1) {
+                heap_free(c->blocks[i - 1]);
+                c->blocks[i - 1] = NULL;
+            }
+        }
+        for (uint32_t i = 0; i < c->size; i++) {
+            if (c->blocks[i]) heap_free(c->blocks[i]);
+        }
+    }
+}
+
+static void bench_heap(bench_ctx_t *c)
+{
+    c->size = BENCH_HEAP_BLOCKS;
+    bench_run("heap.lifo64",  b_heap_lifo,  c, 0);
+    bench_run("heap.fifo64",  b_heap_fifo,  c, 0);
+    bench_run("heap.mixed",   b_heap_mixed, c, 0);
+}
+
+/* =============================================================================
+ * CACHE MAINTENANCE
+ * =============================================================================
+ *
+ * Each iteration re-dirties one line per 64 bytes first, so there is
+ * always write-back to do; the dirtying is part of the number, and the
+ * mem.memset line at the same size says how much of it.
+ */
+
+static void dirty(bench_ctx_t *c)
+{
+    for (uint32_t off = 0; off < c->size; off += 64) c->dst[off]++;
+}
+
+static void b_clean(bench_ctx_t *c, uint32_t n)
+{
+    while (n--) {
+        dirty(c);
+        hal_dcache_clean((uintptr_t)c->dst, c->size);
+    }
+}
+
+static void b_flush(bench_ctx_t *c, uint32_t n)
+{
+    while (n--) {
+        dirty(c);
+        hal_dcache_flush((uintptr_t)c->dst, c->size);
+    }
+}
+
+static void bench_cache(bench_ctx_t *c)
+{
+    static const uint32_t sizes[] = { 4096, 64 * 1024, BENCH_BUF_BYTES };
+
+    for (uint32_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        c->size = sizes[i];
+        bench_run("cache.clean", b_clean, c, c->size);
+        bench_run("cache.flush", b_flush, c, c->size);
+    }
+}
+
+/* =============================================================================
+ * GPIO WAVEFORMS
+ * =============================================================================
+ *
+ * BENCH_GPIO_BYTES sent over a bit-banged bus with no delays: as fast as
+ * the GPIO block takes stores. gpio.pins is the way drivers did it, a
+ * call per pin; gpio.bus_wave the same bytes as a replayed waveform;
+ * gpio.bus_build what compiling that waveform costs, once. MB/s is bus
+ * bytes. gpio.spi_wave shifts the bytes out as SPI mode 0 instead, two
+ * steps a bit.
+ */
+
+static gpio_wave_step_t g_wave_steps[BENCH_WAVE_STEPS];
+
+static const gpio_wave_bus_t k_bench_bus = {
+    .shift  = BENCH_GPIO_SHIFT,
+    .width  = 8,
+    .strobe = 1u << (BENCH_GPIO_SHIFT + 8),
+};
+
+static const gpio_wave_spi_t k_bench_spi = {
+    .mosi = 1u << (BENCH_GPIO_SHIFT + 9),
+    .sclk = 1u << (BENCH_GPIO_SHIFT + 10),
+};
+
+static void b_gpio_pins(bench_ctx_t *c, uint32_t n)
+{
+    uint32_t pin0   = BENCH_GPIO_BANK * 32 + BENCH_GPIO_SHIFT;
+    uint32_t strobe = pin0 + 8;
+
+    while (n--) {
+        for (uint32_t i = 0; i < BENCH_GPIO_BYTES; i++) {
+            for (uint32_t b = 0; b < 8; b++) {
+                if ((c->gpio_data[i] >> b) & 1) {
+                    hal_gpio_set_high(pin0 + b);
+                } else {
+                    hal_gpio_set_low(pin0 + b);
+                }
+            }
+            hal_gpio_set_low(strobe);
+            hal_gpio_set_high(strobe);
+        }
+    }
+}
+
+static void b_gpio_build(bench_ctx_t *c, uint32_t n)
+{
+    while (n--) {
+        gpio_wave_reset(&c->wave);
+        gpio_wave_bus_write(&c->wave, &k_bench_bus, c->gpio_data, BENCH_GPIO_BYTES);
+    }
+}
+
+static void b_gpio_play(bench_ctx_t *c, uint32_t n)
+{
+    gpio_wave_play(&c->wave, n);
+}
+
+static void bench_gpio(bench_ctx_t *c)
+{
+    for (uint32_t i = 0; i < BENCH_GPIO_BYTES; i++) {
+        c->gpio_data[i] = (uint8_t)(i * 37 + 11);
+    }
+    gpio_wave_init(&c->wave, g_wave_steps, BENCH_WAVE_STEPS, BENCH_GPIO_BANK);
+
+    c->size = BENCH_GPIO_BYTES;
+    bench_run("gpio.pins",      b_gpio_pins,  c, BENCH_GPIO_BYTES);
+    bench_run("gpio.bus_build", b_gpio_build, c, 0);
+    bench_run("gpio.bus_wave",  b_gpio_play,  c, BENCH_GPIO_BYTES);
+
+    gpio_wave_reset(&c->wave);
+    gpio_wave_spi_write(&c->wave, &k_bench_spi, c->gpio_data, BENCH_GPIO_BYTES);
+    bench_run("gpio.spi_wave",  b_gpio_play,  c, BENCH_GPIO_BYTES);
+}
+
+/* =============================================================================
+ * PLATFORM ROUND TRIPS AND PRESENT
+ * =============================================================================
+ *
+ * hal.arm_freq and hal.temperature are one VideoCore mailbox round trip
+ * each on the BCM2710, an I2C transaction (or a cached value) on the
+ * JH7110, and a register read elsewhere.
+ */
+
+static void b_arm_freq(bench_ctx_t *c, uint32_t n)
+{
+    (void)c;
+    while (n--) (void)hal_platform_get_arm_freq();
+}
+
+static void b_temperature(bench_ctx_t *c, uint32_t n)
+{
+    int32_t t;
+    (void)c;
+    while (n--) (void)hal_platform_get_temperature(&t);
+}
+
+static void b_present(bench_ctx_t *c, uint32_t n)
+{
+    while (n--) {
+        fb_mark_all_dirty(c->fb);
+        fb_present(c->fb);
+    }
+}
+
+static void b_present_async(bench_ctx_t *c, uint32_t n)
+{
+    while (n--) {
+        fb_wait_flip(c->fb);
+        fb_mark_all_dirty(c->fb);
+        fb_present_async(c->fb);
+    }
+    fb_wait_flip(c->fb);
+}
+
+static void bench_platform(bench_ctx_t *c)
+{
+    c->size = 0;
+    bench_run("hal.arm_freq",     b_arm_freq,      c, 0);
+    bench_run("hal.temperature",  b_temperature,   c, 0);
+    bench_run("fb.present",       b_present,       c, c->fb->buffer_size);
+    bench_run("fb.present_async", b_present_async, c, c->fb->buffer_size);
+}
+
+/* =============================================================================
+ * KERNEL MAIN (APP=bench)
+ * =============================================================================
+ *
+ * Same bring-up as main.c, minus the UI. Results go to the UART as they
+ * are produced; the screen only says which group is running, so a hung
+ * board shows where it stopped.
+ */
+
+static void banner(framebuffer_t *fb, const char *text)
+{
+    fb_fill_rect(fb, 0, 0, fb->width, 24, 0xFF000000);
+    fb_draw_string(fb, 8, 8, text, 0xFFFFFFFF, 0xFF000000);
+    fb_present(fb);
+}
+
+void kernel_main(framebuffer_t *boot_fb)
+{
+    boottime_init();
+    hal_cache_init();
+
+    heap_init((uintptr_t)__ram_base, (size_t)__ram_size);
+    frame_arena_init(FRAME_ARENA_SIZE);
+    dma_pool_init();
+
+    hal_gpio_configure_dpi();
+
+    framebuffer_t fb;
+    if (boot_fb != NULL) {
+        fb = *boot_fb;
+    } else {
+        fb = (framebuffer_t){0};
+        if (!fb_init(&fb)) {
+            while (1) { cpu_idle(); }
+        }
+    }
+
+    smp_init();
+    hal_timer_events_init();
+
+    /* As in main.c: the JH7110's PMIC, and with it hal.temperature, comes up here */
+    hal_platform_late_init();
+
+    g_perf = hal_perf_init() == HAL_SUCCESS && hal_perf_configure_default() > 0;
+
+    static bench_ctx_t c;
+    c.fb  = &fb;
+    c.src = heap_alloc_aligned(BENCH_BUF_BYTES, 64);
+    c.dst = heap_alloc_aligned(BENCH_BUF_BYTES, 64);
+    if (!c.src || !c.dst) {
+        hal_debug_printf("@error heap: %u KB buffers unavailable\n", BENCH_BUF_BYTES >> 10);
+        while (1) { cpu_idle(); }
+    }
+    for (uint32_t i = 0; i < BENCH_BUF_BYTES / 4; i++) {
+        ((uint32_t *)c.src)[i] = 0x80000000u | (i * 0x010203u);   /* Half-alpha ARGB */
+    }
+
+    hal_debug_printf("@bench 1 %s %u %u %u %u\n", hal_platform_get_board_name(),
+                     fb.width, fb.height, (fb.ops ? fb.ops->bpp : 4) * 8, smp_cpu_count());
+
+    banner(&fb, "bench: memory");   bench_memory(&c);
+    banner(&fb, "bench: fb");       bench_fb(&c);
+    banner(&fb, "bench: text");     bench_text_render(&c);
+    banner(&fb, "bench: heap");     bench_heap(&c);
+    banner(&fb, "bench: cache");    bench_cache(&c);
+    banner(&fb, "bench: gpio");     bench_gpio(&c);
+    banner(&fb, "bench: platform"); bench_platform(&c);
+
+    hal_debug_printf("@end\n");
+    boottime_report();
+
+    fb_clear(&fb, 0xFF000000);
+    banner(&fb, "bench: done - results on the debug UART");
+    while (1) { cpu_idle(); }
+}
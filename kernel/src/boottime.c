@@ -0,0 +1,144 @@
+/*
+ * boottime.c - Boot Timeline
+ * ===========================
+ *
+ * See boottime.h. A fixed table of stamps, filled in order of arrival;
+ * stages are few and marked once, so there is nothing to sort or lock.
+ */
+
+#include "boottime.h"
+#include "hal.h"
+#include "hal_cpu.h"
+
+/*
+ * boot/<arch>/entry.S. Weak: a platform that doesn't come through those
+ * entry points has no sample, and the timeline starts at kernel_main.
+ */
+extern uint64_t __boot_counter __attribute__((weak));
+
+static boottime_stage_t  g_stages[BOOTTIME_MAX_STAGES];
+static volatile uint32_t g_count;
+static uint64_t          g_firmware_us;
+
+/* =============================================================================
+ * THE ARCHITECTURAL COUNTER
+ * =============================================================================
+ */
+
+static inline uint64_t arch_counter(void)
+{
+#if defined(__aarch64__)
+    uint64_t v;
+    __asm__ volatile("isb; mrs %0, cntpct_el0" : "=r"(v));
+    return v;
+#elif defined(__riscv)
+    uint64_t v;
+    __asm__ volatile("rdtime %0" : "=r"(v));
+    return v;
+#else
+    return 0;
+#endif
+}
+
+HAL_WEAK uint64_t hal_timer_counter_hz(void)
+{
+#if defined(__aarch64__)
+    uint64_t hz;
+    __asm__ volatile("mrs %0, cntfrq_el0" : "=r"(hz));
+    return hz;
+#else
+    return 0;
+#endif
+}
+
+/* =============================================================================
+ * RECORDING
+ * =============================================================================
+ */
+
+static void record(const char *name, uint64_t us)
+{
+    uint32_t i = __atomic_fetch_add(&g_count, 1, __ATOMIC_RELAXED);
+    if (i >= BOOTTIME_MAX_STAGES) return;
+
+    g_stages[i] = (boottime_stage_t){ name, us, hal_cpu_id() };
+}
+
+void boottime_init(void)
+{
+    uint64_t now_us = hal_timer_get_ticks();
+    uint64_t hz     = hal_timer_counter_hz();
+    uint64_t start  = &__boot_counter ? __boot_counter : 0;
+
+    if (start && hz) {
+        uint64_t since = (arch_counter() - start) * 1000000ULL / hz;
+        g_firmware_us  = start * 1000000ULL / hz;
+        record("entry", now_us > since ? now_us - since : 0);
+    }
+    record("kernel_main", now_us);
+}
+
+void boottime_mark(const char *name)
+{
+    record(name, hal_timer_get_ticks());
+}
+
+/* =============================================================================
+ * QUERIES
+ * =============================================================================
+ */
+
+uint32_t boottime_count(void)
+{
+    return g_count < BOOTTIME_MAX_STAGES ? g_count : BOOTTIME_MAX_STAGES;
+}
+
+const boottime_stage_t *boottime_stage(uint32_t i)
+{
+    return i < boottime_count() ? &g_stages[i] : NULL;
+}
+
+uint64_t boottime_firmware_us(void)
+{
+    return g_firmware_us;
+}
+
+uint64_t boottime_total_us(void)
+{
+    uint32_t n = boottime_count();
+    return n ? g_stages[n - 1].us - g_stages[0].us : 0;
+}
+
+/* =============================================================================
+ * REPORT
+ * =============================================================================
+ */
+
+void boottime_report(void)
+{
+    uint32_t n = boottime_count();
+    if (n == 0) return;
+
+    if (g_firmware_us) {
+        hal_debug_printf("[boot] %u.%03u ms in firmware before _start\n",
+                         (uint32_t)(g_firmware_us / 1000), (uint32_t)(g_firmware_us % 1000));
+    }
+
+    uint64_t t0   = g_stages[0].us;
+    uint64_t prev = t0;
+    for (uint32_t i = 0; i < n; i++) {
+        const boottime_stage_t *s = &g_stages[i];
+        uint64_t at    = s->us - t0;
+        uint64_t delta = s->us >= prev ? s->us - prev : 0;
+
+        hal_debug_printf("[boot] %6u.%03u  +%u.%03u  cpu%u  %s\n",
+                         (uint32_t)(at / 1000), (uint32_t)(at % 1000),
+                         (uint32_t)(delta / 1000), (uint32_t)(delta % 1000),
+                         s->cpu, s->name);
+        prev = s->us;
+    }
+
+    if (g_count > BOOTTIME_MAX_STAGES) {
+        hal_debug_printf("[boot] %u later stages dropped\n", g_count - BOOTTIME_MAX_STAGES);
+    }
+}
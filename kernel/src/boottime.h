@@ -0,0 +1,69 @@
+/*
+ * boottime.h - Boot Timeline
+ * ===========================
+ *
+ * How long from power-on to the first frame, and where does it go?
+ * boottime_mark() stamps a named stage with hal_timer_get_ticks();
+ * boottime_report() prints the list with the gap before each stage:
+ *
+ *   [boot] 1843.201 ms in firmware before _start
+ *   [boot]     0.000  +0.000     cpu0  entry
+ *   [boot]     0.412  +0.412     cpu0  kernel_main
+ *   [boot]    38.950  +38.538    cpu0  fb_init
+ *   ...
+ *   [boot]   212.774  +1.032     cpu0  first_frame
+ *
+ * THE EARLIEST STAMP:
+ * -------------------
+ * hal_timer_get_ticks() may not be usable in the first instructions — on
+ * the BCM2710 it is an MMIO timer and the MMU is still off. So
+ * boot/<arch>/entry.S only samples the architectural counter (CNTPCT_EL0
+ * / the RISC-V `time` CSR) into __boot_counter. boottime_init() reads the
+ * same counter again next to hal_timer_get_ticks() and works backwards,
+ * using hal_timer_counter_hz():
+ *
+ *   entry_us = now_us - (counter_now - __boot_counter) / hz
+ *
+ * The counter itself starts at reset, so __boot_counter / hz is also the
+ * time the firmware and bootloader took before _start.
+ *
+ * Stages may be marked from any core (a deferred query on a job worker);
+ * each mark takes its slot with one atomic add.
+ */
+
+#ifndef BOOTTIME_H
+#define BOOTTIME_H
+
+#include "types.h"
+
+#define BOOTTIME_MAX_STAGES     24
+
+typedef struct {
+    const char *name;       /* String literal */
+    uint64_t    us;         /* hal_timer_get_ticks() */
+    uint32_t    cpu;
+} boottime_stage_t;
+
+/*
+ * First call in kernel_main(): records "entry" from __boot_counter (when
+ * the platform has one) and "kernel_main" itself.
+ */
+void boottime_init(void);
+
+/* Stamp a stage now. Marks past BOOTTIME_MAX_STAGES are dropped. */
+void boottime_mark(const char *name);
+
+/* Stages recorded so far, and one of them (NULL past the end) */
+uint32_t boottime_count(void);
+const boottime_stage_t *boottime_stage(uint32_t i);
+
+/* Time from counter reset to _start, 0 if unknown */
+uint64_t boottime_firmware_us(void);
+
+/* Time from the first stage to the last */
+uint64_t boottime_total_us(void);
+
+/* Print the timeline on the debug UART */
+void boottime_report(void);
+
+#endif /* BOOTTIME_H */
@@ -0,0 +1,244 @@
+/*
+ * cache.c - Adaptive Data Cache Maintenance
+ * ==========================================
+ *
+ * See hal_cache.h. The ARM64 half does the work: geometry from CTR_EL0,
+ * CLIDR_EL1 and CCSIDR_EL1 once, then by-address loops four lines per
+ * iteration and set/way walks with the per-level shifts precomputed.
+ * Everywhere else the policy collapses to the existing range functions.
+ */
+
+#include "hal_cache.h"
+#include "hal.h"
+#include "smp.h"
+#if !defined(SOC_RP2350)
+#include "mmio.h"
+#endif
+#include "../../common/src/string.h"
+
+static hal_cache_info_t g_cache = {
+    .line      = 64,
+    .threshold = HAL_CACHE_NEVER,
+};
+
+#if defined(__aarch64__)
+
+/* =============================================================================
+ * ARM64: GEOMETRY
+ * =============================================================================
+ */
+
+static void cache_probe(hal_cache_info_t *c)
+{
+    uint64_t ctr, clidr;
+    __asm__ volatile("mrs %0, ctr_el0" : "=r"(ctr));
+    __asm__ volatile("mrs %0, clidr_el1" : "=r"(clidr));
+
+    c->line = 4u << ((ctr >> 16) & 0xF);            /* DminLine, in words */
+
+    uint32_t loc = (uint32_t)(clidr >> 24) & 0x7;
+    c->levels = 0;
+    for (uint32_t level = 0; level < loc && c->levels < HAL_CACHE_MAX_LEVELS; level++) {
+        uint32_t type = (uint32_t)(clidr >> (level * 3)) & 0x7;
+        if (type < 2) continue;                     /* None, or I-cache only */
+
+        uint64_t ccsidr;
+        __asm__ volatile("msr csselr_el1, %0" :: "r"((uint64_t)level << 1));
+        __asm__ volatile("isb");
+        __asm__ volatile("mrs %0, ccsidr_el1" : "=r"(ccsidr));
+
+        uint32_t i = c->levels++;
+        c->level[i]      = level;
+        c->line_shift[i] = (uint32_t)(ccsidr & 0x7) + 4;
+        c->ways[i]       = (uint32_t)((ccsidr >> 3) & 0x3FF) + 1;
+        c->sets[i]       = (uint32_t)((ccsidr >> 13) & 0x7FFF) + 1;
+        c->size[i]       = c->sets[i] * c->ways[i] << c->line_shift[i];
+    }
+    c->has_whole = c->levels > 0;
+}
+
+/* =============================================================================
+ * ARM64: BY ADDRESS
+ * =============================================================================
+ *
+ * Four lines per iteration, then the tail. `dc` ignores the offset bits,
+ * so the start only needs aligning for the loop bound to come out right.
+ */
+
+#define CACHE_RANGE_LOOP(op)                                                \
+    uintptr_t line = g_cache.line;                                          \
+    uintptr_t addr = start & ~(line - 1);                                   \
+    uintptr_t end  = start + len;                                           \
+                                                                            \
+    while (addr + 4 * line <= end) {                                        \
+        __asm__ volatile("dc " op ", %0" :: "r"(addr));                     \
+        __asm__ volatile("dc " op ", %0" :: "r"(addr + line));              \
+        __asm__ volatile("dc " op ", %0" :: "r"(addr + 2 * line));          \
+        __asm__ volatile("dc " op ", %0" :: "r"(addr + 3 * line));          \
+        addr += 4 * line;                                                   \
+    }                                                                       \
+    for (; addr < end; addr += line) {                                      \
+        __asm__ volatile("dc " op ", %0" :: "r"(addr));                     \
+    }                                                                       \
+    dsb()
+
+static void range_clean(uintptr_t start, size_t len) { CACHE_RANGE_LOOP("cvac"); }
+static void range_flush(uintptr_t start, size_t len) { CACHE_RANGE_LOOP("civac"); }
+static void range_inval(uintptr_t start, size_t len) { CACHE_RANGE_LOOP("ivac"); }
+
+/* =============================================================================
+ * ARM64: WHOLE CACHE
+ * =============================================================================
+ *
+ * Operand: level << 1 | set << line_shift | way << (32 - log2(ways)).
+ * Innermost level first for a clean — its lines land in the next level
+ * down, which is cleaned after it.
+ */
+
+#define CACHE_SETWAY_LOOP(op)                                               \
+    for (uint32_t i = 0; i < g_cache.levels; i++) {                         \
+        uint32_t ways  = g_cache.ways[i];                                   \
+        uint32_t wsh   = ways > 1 ? (uint32_t)__builtin_clz(ways - 1) : 0;  \
+        uint64_t level = (uint64_t)g_cache.level[i] << 1;                   \
+        for (uint32_t set = 0; set < g_cache.sets[i]; set++) {              \
+            uint64_t s = level | ((uint64_t)set << g_cache.line_shift[i]);  \
+            for (uint32_t way = 0; way < ways; way++) {                     \
+                uint64_t v = s | ((uint64_t)way << wsh);                    \
+                __asm__ volatile("dc " op ", %0" :: "r"(v));                \
+            }                                                               \
+        }                                                                   \
+    }                                                                       \
+    dsb();                                                                  \
+    isb()
+
+static void whole_clean(void) { CACHE_SETWAY_LOOP("csw"); }
+static void whole_flush(void) { CACHE_SETWAY_LOOP("cisw"); }
+
+#else
+
+/* =============================================================================
+ * EVERYTHING ELSE: THE EXISTING RANGE FUNCTIONS
+ * =============================================================================
+ *
+ * RISC-V: cache.S (Zicbom) or the SoC's own (JH7110 Flush64). x86_64:
+ * mmio.h no-ops. Cortex-M33 (RP2350): no data cache on the scan-out path.
+ */
+
+static void cache_probe(hal_cache_info_t *c)
+{
+    c->line      = 64;
+    c->levels    = 0;
+    c->has_whole = false;
+}
+
+#if defined(SOC_RP2350)
+static void range_clean(uintptr_t start, size_t len) { (void)start; (void)len; }
+static void range_flush(uintptr_t start, size_t len) { (void)start; (void)len; }
+static void range_inval(uintptr_t start, size_t len) { (void)start; (void)len; }
+#else
+static void range_clean(uintptr_t start, size_t len) { clean_dcache_range(start, len); }
+static void range_flush(uintptr_t start, size_t len) { flush_dcache_range(start, len); }
+static void range_inval(uintptr_t start, size_t len) { invalidate_dcache_range(start, len); }
+#endif
+
+static void whole_clean(void) { }
+static void whole_flush(void) { }
+
+#endif
+
+/* =============================================================================
+ * POLICY
+ * =============================================================================
+ */
+
+HAL_WEAK size_t hal_cache_soc_threshold(const hal_cache_info_t *info)
+{
+    if (!info->has_whole) return HAL_CACHE_NEVER;
+
+    size_t total = 0;
+    for (uint32_t i = 0; i < info->levels; i++) total += info->size[i];
+    return total;
+}
+
+void hal_cache_init(void)
+{
+    cache_probe(&g_cache);
+    g_cache.threshold = hal_cache_soc_threshold(&g_cache);
+}
+
+const hal_cache_info_t *hal_cache_info(void)
+{
+    return &g_cache;
+}
+
+void hal_cache_set_threshold(size_t bytes)
+{
+    g_cache.threshold = g_cache.has_whole ? bytes : HAL_CACHE_NEVER;
+}
+
+bool hal_dcache_prefers_whole(size_t len)
+{
+    return g_cache.has_whole && len >= g_cache.threshold && smp_cpu_count() == 1;
+}
+
+void hal_dcache_clean(uintptr_t start, size_t len)
+{
+    if (hal_dcache_prefers_whole(len)) whole_clean();
+    else range_clean(start, len);
+}
+
+void hal_dcache_flush(uintptr_t start, size_t len)
+{
+    if (hal_dcache_prefers_whole(len)) whole_flush();
+    else range_flush(start, len);
+}
+
+void hal_dcache_invalidate(uintptr_t start, size_t len)
+{
+    range_inval(start, len);
+}
+
+/* =============================================================================
+ * CALIBRATION
+ * =============================================================================
+ *
+ * The range cost is linear in bytes, the whole-cache cost is flat, so one
+ * sample of each is enough: threshold = t_whole / (t_range / len). Best of
+ * three of each, with the buffer re-dirtied every time so both paths have
+ * the same amount of write-back to do.
+ */
+
+#define CACHE_CAL_ROUNDS    3
+
+size_t hal_cache_calibrate(void *scratch, size_t len)
+{
+    if (!g_cache.has_whole || smp_cpu_count() != 1 || !scratch) return HAL_CACHE_NEVER;
+
+    uint64_t t_range = UINT64_MAX;
+    uint64_t t_whole = UINT64_MAX;
+
+    for (uint32_t round = 0; round < CACHE_CAL_ROUNDS; round++) {
+        memset(scratch, (int)round, len);
+        uint64_t t0 = hal_timer_get_ticks();
+        range_clean((uintptr_t)scratch, len);
+        uint64_t t1 = hal_timer_get_ticks();
+        if (t1 - t0 < t_range) t_range = t1 - t0;
+
+        memset(scratch, (int)round + 1, len);
+        t0 = hal_timer_get_ticks();
+        whole_clean();
+        t1 = hal_timer_get_ticks();
+        if (t1 - t0 < t_whole) t_whole = t1 - t0;
+    }
+
+    /* Below ~10 µs the timer's 1 µs resolution swamps the answer */
+    if (t_range < 10) return HAL_CACHE_NEVER;
+
+    size_t threshold = (size_t)((t_whole * (uint64_t)len) / t_range);
+    g_cache.threshold = threshold;
+
+    hal_debug_printf("[cache] range %u us for %u KB, whole %u us -> threshold %u KB\n",
+                     (unsigned)t_range, (unsigned)(len >> 10), (unsigned)t_whole,
+                     (unsigned)(threshold >> 10));
+    return threshold;
+}
@@ -0,0 +1,210 @@
+/*
+ * debug.c - Portable Debug Output
+ * ================================
+ *
+ * hal_debug_puts() and hal_debug_printf() from hal_platform.h, written
+ * once on top of the one thing each SoC supplies: hal_debug_putc(), a raw
+ * character out of the debug UART.
+ *
+ * Everything goes to the UART first, then to the sink set with
+ * hal_debug_set_sink() — the on-screen console (drivers/src/console) when
+ * it is attached. printf formats into a small stack buffer and hands the
+ * sink whole chunks, so a console sees one write per call, not one per
+ * character, and redraws once per line at most.
+ *
+ * One lock keeps lines from different cores from interleaving. It masks
+ * IRQs on the calling core while held, so a handler that logs can't spin
+ * on a lock the code it interrupted already holds. The price is that the
+ * sink must not block or draw: the console's only copies the text into a
+ * ring, and the frame loop draws it (console_debug_flush()).
+ */
+
+#include <stdarg.h>
+
+#include "hal.h"
+#include "spinlock.h"
+#include "string.h"
+
+#define DEBUG_CHUNK         128
+
+static spinlock_t           g_debug_lock = SPINLOCK_INIT;
+static hal_debug_sink_fn_t  g_debug_sink;
+static void                *g_debug_ctx;
+
+static inline hal_irq_flags_t debug_lock(void)
+{
+    hal_irq_flags_t f = hal_irq_save();
+    spin_lock(&g_debug_lock);
+    return f;
+}
+
+static inline void debug_unlock(hal_irq_flags_t f)
+{
+    spin_unlock(&g_debug_lock);
+    hal_irq_restore(f);
+}
+
+void hal_debug_set_sink(hal_debug_sink_fn_t fn, void *ctx)
+{
+    hal_irq_flags_t f = debug_lock();
+    g_debug_sink = fn;
+    g_debug_ctx  = ctx;
+    debug_unlock(f);
+}
+
+/* Called with g_debug_lock held */
+static void debug_emit(const char *s, size_t len)
+{
+    for (size_t i = 0; i < len; i++) hal_debug_putc(s[i]);
+    if (g_debug_sink && len) g_debug_sink(g_debug_ctx, s, len);
+}
+
+void hal_debug_puts(const char *s)
+{
+    if (!s) return;
+    hal_irq_flags_t f = debug_lock();
+    debug_emit(s, strlen(s));
+    debug_unlock(f);
+}
+
+/* =============================================================================
+ * PRINTF
+ * =============================================================================
+ *
+ * %d %i %u %x %X %p %s %c %%, with a '-' or '0' flag, a field width, and
+ * the l / ll / z length modifiers. No floating point: nothing in the kernel
+ * is built with it on ARM64 (-mgeneral-regs-only).
+ */
+
+typedef struct {
+    char   buf[DEBUG_CHUNK];
+    size_t len;
+} debug_out_t;
+
+static void out_char(debug_out_t *o, char c)
+{
+    if (o->len == sizeof(o->buf)) {
+        debug_emit(o->buf, o->len);
+        o->len = 0;
+    }
+    o->buf[o->len++] = c;
+}
+
+static void out_pad(debug_out_t *o, char c, int n)
+{
+    while (n-- > 0) out_char(o, c);
+}
+
+static void out_field(debug_out_t *o, const char *s, int len, int width, bool left, char pad)
+{
+    if (!left) out_pad(o, pad, width - len);
+    for (int i = 0; i < len; i++) out_char(o, s[i]);
+    if (left) out_pad(o, ' ', width - len);
+}
+
+static void out_number(debug_out_t *o, uint64_t v, bool neg, uint32_t base, bool upper,
+                       int width, bool left, char pad)
+{
+    const char *digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    char        tmp[24];
+    int         n = 0;
+
+    do {
+        tmp[sizeof(tmp) - 1 - n++] = digits[v % base];
+        v /= base;
+    } while (v);
+
+    if (neg) {
+        if (pad == '0') {                   /* Sign goes before the zeros */
+            out_char(o, '-');
+            width--;
+        } else {
+            tmp[sizeof(tmp) - 1 - n++] = '-';
+        }
+    }
+    out_field(o, &tmp[sizeof(tmp) - n], n, width, left, pad);
+}
+
+void hal_debug_printf(const char *fmt, ...)
+{
+    if (!fmt) return;
+
+    debug_out_t o;
+    o.len = 0;
+
+    va_list ap;
+    va_start(ap, fmt);
+    hal_irq_flags_t f = debug_lock();
+
+    for (const char *p = fmt; *p; p++) {
+        if (*p != '%') {
+            out_char(&o, *p);
+            continue;
+        }
+
+        bool left = false;
+        char pad  = ' ';
+        int  width = 0;
+        int  lng  = 0;                      /* 1: long, 2: long long / size_t */
+
+        for (;; p++) {
+            if (p[1] == '-')      left = true;
+            else if (p[1] == '0') pad  = '0';
+            else break;
+        }
+        while (p[1] >= '0' && p[1] <= '9') width = width * 10 + (*++p - '0');
+        while (p[1] == 'l') { lng++; p++; }
+        if (p[1] == 'z') { lng = 2; p++; }
+        if (left) pad = ' ';
+
+        char spec = *++p;
+        switch (spec) {
+            case 'd':
+            case 'i': {
+                int64_t v = lng == 2 ? va_arg(ap, long long) :
+                            lng == 1 ? va_arg(ap, long) : va_arg(ap, int);
+                out_number(&o, v < 0 ? 0 - (uint64_t)v : (uint64_t)v, v < 0, 10, false,
+                           width, left, pad);
+                break;
+            }
+            case 'u':
+            case 'x':
+            case 'X': {
+                uint64_t v = lng == 2 ? va_arg(ap, unsigned long long) :
+                             lng == 1 ? va_arg(ap, unsigned long) : va_arg(ap, unsigned int);
+                out_number(&o, v, false, spec == 'u' ? 10 : 16, spec == 'X',
+                           width, left, pad);
+                break;
+            }
+            case 'p':
+                out_char(&o, '0');
+                out_char(&o, 'x');
+                out_number(&o, (uintptr_t)va_arg(ap, void *), false, 16, false,
+                           width > 2 ? width - 2 : 0, left, pad);
+                break;
+            case 's': {
+                const char *s = va_arg(ap, const char *);
+                if (!s) s = "(null)";
+                out_field(&o, s, (int)strlen(s), width, left, ' ');
+                break;
+            }
+            case 'c':
+                out_char(&o, (char)va_arg(ap, int));
+                break;
+            case '%':
+                out_char(&o, '%');
+                break;
+            case '\0':
+                p--;                        /* Trailing '%': stop at the NUL */
+                break;
+            default:
+                out_char(&o, '%');
+                out_char(&o, spec);
+                break;
+        }
+    }
+
+    debug_emit(o.buf, o.len);
+    debug_unlock(f);
+    va_end(ap);
+}
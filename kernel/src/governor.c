@@ -0,0 +1,270 @@
+/*
+ * governor.c - Thermal- and Throttle-Aware Frame Pacing
+ * ======================================================
+ *
+ * See governor.h. One governor per system, fed from the render loop on
+ * the boot core; nothing here is shared with the workers.
+ */
+
+#include "governor.h"
+#include "hal.h"
+
+/* Throttle flags that mean "too hot or too little power, right now" */
+#define GOV_THROTTLE_NOW    (HAL_THROTTLE_UNDERVOLT_NOW | HAL_THROTTLE_ARM_FREQ_CAPPED | \
+                             HAL_THROTTLE_THROTTLED_NOW | HAL_THROTTLE_SOFT_TEMP_LIMIT)
+
+#define GOV_DEFAULT_MAX_FPS 60
+
+/* =============================================================================
+ * PLATFORM DEFAULTS
+ * =============================================================================
+ *
+ * Most platforms can't set their clocks from here — the governor paces
+ * the render rate and leaves the clock alone.
+ */
+
+HAL_WEAK hal_error_t hal_platform_get_clock_limits(hal_clock_id_t clock_id,
+                                                   uint32_t *min_hz, uint32_t *max_hz)
+{
+    (void)clock_id;
+    if (min_hz == NULL || max_hz == NULL) return HAL_ERROR_NULL_PTR;
+    return HAL_ERROR_NOT_SUPPORTED;
+}
+
+HAL_WEAK hal_error_t hal_platform_set_clock_rate(hal_clock_id_t clock_id, uint32_t hz,
+                                                 uint32_t *actual_hz)
+{
+    (void)clock_id;
+    (void)hz;
+    (void)actual_hz;
+    return HAL_ERROR_NOT_SUPPORTED;
+}
+
+/* =============================================================================
+ * STATE
+ * =============================================================================
+ */
+
+typedef struct {
+    gov_config_t cfg;
+    gov_state_t  st;
+
+    uint32_t     min_hz;            /* Settable range; min == max when fixed */
+    uint32_t     max_hz;
+    int32_t      soft_mc;           /* Temperature the ceiling is steered under */
+
+    uint32_t     busy_us;           /* Smoothed work per frame, at st.arm_hz */
+    bool         have_busy;
+
+    int32_t      last_temp_mc;
+    uint64_t     last_temp_us;
+    int32_t      slope_mc_s;        /* Smoothed trend, millicelsius per second */
+    bool         have_last_temp;
+
+    uint64_t     last_change_us;    /* Clock last moved */
+    uint64_t     last_raise_us;     /* Ceiling last climbed */
+} gov_t;
+
+static gov_t g_gov;
+
+static inline uint32_t clamp_u32(uint32_t v, uint32_t lo, uint32_t hi)
+{
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+static void gov_set_fps(uint32_t fps)
+{
+    g_gov.st.fps         = fps;
+    g_gov.st.interval_us = 1000000U / fps;
+}
+
+/* =============================================================================
+ * SETUP
+ * =============================================================================
+ */
+
+void gov_configure(const gov_config_t *cfg)
+{
+    gov_config_t c = *cfg;
+
+    if (c.min_fps == 0)    c.min_fps    = 1;
+    if (c.max_fps == 0)    c.max_fps    = GOV_DEFAULT_MAX_FPS;
+    if (c.target_fps == 0) c.target_fps = c.min_fps;
+    if (c.power_cap_pct == 0 || c.power_cap_pct > 100) c.power_cap_pct = 100;
+    if (c.soft_limit_mc != 0) g_gov.soft_mc = c.soft_limit_mc;
+
+    g_gov.cfg = c;
+}
+
+void gov_init(const gov_config_t *cfg)
+{
+    g_gov = (gov_t){0};
+
+    uint32_t hz = hal_platform_get_arm_freq();
+    g_gov.st.arm_hz = hz;
+
+    if (HAL_OK(hal_platform_get_clock_limits(HAL_CLOCK_ARM, &g_gov.min_hz, &g_gov.max_hz)) &&
+        g_gov.min_hz != 0 && g_gov.min_hz <= g_gov.max_hz) {
+        g_gov.st.can_set_clock = true;
+    } else {
+        g_gov.min_hz = hz;
+        g_gov.max_hz = hz;
+    }
+    g_gov.st.ceiling_hz = g_gov.max_hz;
+
+    int32_t max_mc;
+    g_gov.soft_mc = HAL_OK(hal_platform_get_max_temperature(&max_mc))
+                    ? max_mc - GOV_SOFT_MARGIN_MC : 60000;
+
+    gov_configure(cfg);
+    gov_set_fps(g_gov.cfg.policy == GOV_POLICY_TARGET_FPS ? g_gov.cfg.target_fps
+                                                          : g_gov.cfg.max_fps);
+}
+
+const gov_state_t *gov_state(void)
+{
+    return &g_gov.st;
+}
+
+void gov_frame(uint32_t busy_us)
+{
+    if (!g_gov.have_busy) {
+        g_gov.busy_us   = busy_us;
+        g_gov.have_busy = true;
+        return;
+    }
+    g_gov.busy_us = (g_gov.busy_us * 3 + busy_us) / 4;
+}
+
+/* =============================================================================
+ * DECISIONS
+ * =============================================================================
+ */
+
+/* Temperature GOV_LOOKAHEAD_S from now, if it keeps heading where it is */
+static int32_t gov_predict(int32_t temp_mc, uint64_t now)
+{
+    if (g_gov.have_last_temp && now > g_gov.last_temp_us) {
+        int64_t dt_us = (int64_t)(now - g_gov.last_temp_us);
+        int32_t slope = (int32_t)((int64_t)(temp_mc - g_gov.last_temp_mc) * 1000000 / dt_us);
+        g_gov.slope_mc_s = (g_gov.slope_mc_s + slope) / 2;
+    }
+    g_gov.last_temp_mc   = temp_mc;
+    g_gov.last_temp_us   = now;
+    g_gov.have_last_temp = true;
+
+    return temp_mc + g_gov.slope_mc_s * GOV_LOOKAHEAD_S;
+}
+
+static void gov_move_ceiling(int32_t temp_mc, bool have_temp, uint32_t throttle, uint64_t now)
+{
+    uint32_t range = g_gov.max_hz - g_gov.min_hz;
+    uint32_t step  = range / 100 * GOV_STEP_PCT;
+    uint32_t ceil  = g_gov.st.ceiling_hz;
+
+    if (step == 0) step = range;
+
+    int32_t predicted = have_temp ? gov_predict(temp_mc, now) : 0;
+    bool    hot       = (throttle & GOV_THROTTLE_NOW) ||
+                        (have_temp && predicted >= g_gov.soft_mc);
+    bool    cool      = !(throttle & GOV_THROTTLE_NOW) &&
+                        (!have_temp || predicted < g_gov.soft_mc - GOV_HYSTERESIS_MC);
+
+    if (hot) {
+        ceil = (ceil - g_gov.min_hz > step) ? ceil - step : g_gov.min_hz;
+    } else if (cool && ceil < g_gov.max_hz && now - g_gov.last_raise_us >= GOV_SETTLE_US) {
+        ceil = (g_gov.max_hz - ceil > step) ? ceil + step : g_gov.max_hz;
+        g_gov.last_raise_us = now;
+    }
+
+    g_gov.st.ceiling_hz      = ceil;
+    g_gov.st.thermal_limited = ceil < g_gov.max_hz;
+}
+
+/* Cycles one frame takes: busy time × the clock it was measured at */
+static uint64_t gov_frame_cycles(void)
+{
+    return (uint64_t)g_gov.busy_us * g_gov.st.arm_hz / 1000000U;
+}
+
+/* Clock for `fps` frames a second at GOV_UTIL_PCT busy */
+static uint64_t gov_hz_for(uint64_t cycles, uint32_t fps)
+{
+    return cycles * fps * 100 / GOV_UTIL_PCT;
+}
+
+/* Frames a second `hz` carries at GOV_UTIL_PCT busy */
+static uint32_t gov_fps_at(uint64_t cycles, uint32_t hz, uint32_t cap)
+{
+    if (cycles == 0) return cap;
+    uint64_t fps = (uint64_t)hz * GOV_UTIL_PCT / 100 / cycles;
+    return fps > cap ? cap : (uint32_t)fps;
+}
+
+static void gov_set_clock(uint32_t hz, uint64_t now)
+{
+    uint32_t old = g_gov.st.arm_hz;
+    uint32_t actual;
+
+    if (HAL_FAILED(hal_platform_set_clock_rate(HAL_CLOCK_ARM, hz, &actual)) || actual == 0) {
+        return;
+    }
+
+    /* The same work takes longer at a slower clock */
+    if (g_gov.have_busy) {
+        g_gov.busy_us = (uint32_t)((uint64_t)g_gov.busy_us * old / actual);
+    }
+    g_gov.st.arm_hz      = actual;
+    g_gov.last_change_us = now;
+}
+
+bool gov_update(int32_t temp_mc, bool have_temp, uint32_t throttle)
+{
+    uint64_t now     = hal_timer_get_ticks();
+    uint32_t old_fps = g_gov.st.fps;
+
+    gov_move_ceiling(temp_mc, have_temp, throttle, now);
+
+    uint32_t cap = g_gov.st.ceiling_hz;
+    if (g_gov.cfg.policy == GOV_POLICY_POWER_CAP) {
+        uint32_t power = (uint32_t)((uint64_t)g_gov.max_hz * g_gov.cfg.power_cap_pct / 100);
+        if (power < cap) cap = power;
+        if (cap < g_gov.min_hz) cap = g_gov.min_hz;
+    }
+
+    uint32_t want = (g_gov.cfg.policy == GOV_POLICY_TARGET_FPS) ? g_gov.cfg.target_fps
+                                                                : g_gov.cfg.max_fps;
+    uint32_t hz   = clamp_u32(g_gov.st.arm_hz, g_gov.min_hz, cap);
+    uint32_t fps  = want;
+
+    if (g_gov.have_busy) {
+        uint64_t cycles = gov_frame_cycles();
+        uint64_t need   = gov_hz_for(cycles, want);
+
+        hz  = need > cap ? cap : clamp_u32((uint32_t)need, g_gov.min_hz, cap);
+        fps = gov_fps_at(cycles, hz, want);
+    }
+    fps = clamp_u32(fps, g_gov.cfg.min_fps, want > g_gov.cfg.min_fps ? want : g_gov.cfg.min_fps);
+
+    /*
+     * Down at once — over the ceiling is what heats the board. Up only
+     * after GOV_SETTLE_US, and not for less than a step's worth, so the
+     * clock doesn't chase every frame's noise.
+     */
+    if (g_gov.st.can_set_clock && hz != g_gov.st.arm_hz) {
+        uint32_t step = (g_gov.max_hz - g_gov.min_hz) / 100 * GOV_STEP_PCT;
+        bool     down = hz < g_gov.st.arm_hz;
+        uint32_t diff = down ? g_gov.st.arm_hz - hz : hz - g_gov.st.arm_hz;
+
+        if (g_gov.st.arm_hz > cap ||
+            (diff > step / 2 && (down || now - g_gov.last_change_us >= GOV_SETTLE_US))) {
+            gov_set_clock(hz, now);
+        }
+    }
+
+    if (fps != old_fps) {
+        gov_set_fps(fps);
+        return true;
+    }
+    return false;
+}
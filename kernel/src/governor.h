@@ -0,0 +1,109 @@
+/*
+ * governor.h - Thermal- and Throttle-Aware Frame Pacing
+ * ======================================================
+ *
+ * Left alone, a busy board heats up until its firmware steps in: the
+ * BCM2710's VideoCore caps the ARM clock at its soft temperature limit
+ * (HAL_THROTTLE_SOFT_TEMP_LIMIT) and frame times jump without warning.
+ * A steady rate a little below the peak beats a fast one that collapses.
+ * The governor trades clock for temperature before the firmware has to:
+ *
+ *   gov_config_t cfg = { .policy = GOV_POLICY_TARGET_FPS, .target_fps = 30 };
+ *   gov_init(&cfg);
+ *
+ *   for (;;) {
+ *       wait for the frame tick;
+ *       poll temperature / throttle flags;
+ *       if (gov_update(temp_mc, have_temp, throttle))
+ *           restart the tick at gov_state()->interval_us;
+ *       draw, present;
+ *       gov_frame(busy_us);            // how long this frame really worked
+ *   }
+ *
+ * WHAT IT DECIDES:
+ * ================
+ *
+ *   ceiling      The fastest clock the temperature allows. Drops a step
+ *                when the predicted temperature (now + trend × 10 s)
+ *                reaches the soft limit, or the firmware reports any
+ *                throttling; climbs back a step once it is comfortably
+ *                below. Down at most a step per update, up at most a
+ *                step per GOV_SETTLE_US, so a short spike doesn't swing
+ *                the clock end to end.
+ *
+ *   clock        The slowest clock that keeps frames GOV_UTIL_PCT busy
+ *                at the chosen rate — measured work per frame × rate —
+ *                never above ceiling. Lower clocks run cooler, which is
+ *                what keeps the ceiling from coming down at all.
+ *
+ *   render rate  What the policy asks for, or what the ceiling can carry
+ *                if that is less: a steady lower rate instead of missed
+ *                frames at a higher one.
+ *
+ * POLICIES:
+ * =========
+ *
+ *   GOV_POLICY_TARGET_FPS   Hold target_fps at the lowest clock that can.
+ *   GOV_POLICY_POWER_CAP    Never clock above power_cap_pct of the
+ *                           maximum; render as fast as that allows, up
+ *                           to max_fps.
+ *
+ * Where the clock can't be set (hal_platform_set_clock_rate() returns
+ * HAL_ERROR_NOT_SUPPORTED — hosted builds, RP2350), the governor still
+ * paces: the ceiling is simply the fixed clock.
+ */
+
+#ifndef GOVERNOR_H
+#define GOVERNOR_H
+
+#include "types.h"
+
+#define GOV_UTIL_PCT        80       /* Aim for frames this busy */
+#define GOV_STEP_PCT        10       /* Ceiling moves by this much of the range */
+#define GOV_LOOKAHEAD_S     10       /* Temperature predicted this far ahead */
+#define GOV_HYSTERESIS_MC   5000     /* Climb back only this far below the limit */
+#define GOV_SOFT_MARGIN_MC  25000    /* Default soft limit: max temperature - this */
+#define GOV_SETTLE_US       500000   /* Least time between two steps upward */
+
+typedef enum {
+    GOV_POLICY_TARGET_FPS = 0,
+    GOV_POLICY_POWER_CAP  = 1,
+} gov_policy_t;
+
+typedef struct {
+    gov_policy_t policy;
+    uint32_t     target_fps;     /* TARGET_FPS: the rate to hold */
+    uint32_t     max_fps;        /* POWER_CAP: the most it renders (0 = 60) */
+    uint32_t     min_fps;        /* Never slower than this (0 = 1) */
+    uint32_t     power_cap_pct;  /* POWER_CAP: clock ceiling, % of max (0 = 100) */
+    int32_t      soft_limit_mc;  /* 0 = max temperature - GOV_SOFT_MARGIN_MC */
+} gov_config_t;
+
+typedef struct {
+    uint32_t fps;               /* Render rate to run at */
+    uint32_t interval_us;       /* 1 s / fps */
+    uint32_t arm_hz;            /* CPU clock now */
+    uint32_t ceiling_hz;        /* Fastest the temperature allows */
+    bool     can_set_clock;     /* false: pacing only */
+    bool     thermal_limited;   /* ceiling is below the maximum */
+} gov_state_t;
+
+/* Read the clock range and temperature limit, then gov_configure(cfg) */
+void gov_init(const gov_config_t *cfg);
+
+/* Switch policy or targets; the next gov_update() reports the new rate */
+void gov_configure(const gov_config_t *cfg);
+
+/* One frame's busy time — drawing and presenting, not waiting for the tick */
+void gov_frame(uint32_t busy_us);
+
+/*
+ * Decide, from a fresh reading: move the ceiling, request a clock, pick
+ * the render rate. throttle is HAL_THROTTLE_* (0 if unknown). Returns
+ * true if the render rate changed.
+ */
+bool gov_update(int32_t temp_mc, bool have_temp, uint32_t throttle);
+
+const gov_state_t *gov_state(void);
+
+#endif /* GOVERNOR_H */
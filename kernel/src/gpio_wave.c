@@ -0,0 +1,245 @@
+/*
+ * gpio_wave.c - Precompiled GPIO Waveforms
+ * =========================================
+ *
+ * See gpio_wave.h. Building is ordinary C; replay is the loop the whole
+ * file exists for, so it stays small: per step, two stores and a spin.
+ */
+
+#include "gpio_wave.h"
+
+/* =============================================================================
+ * PLATFORM DEFAULTS
+ * =============================================================================
+ *
+ * Without a set/clear register pair, replay goes through the bulk calls.
+ */
+
+HAL_WEAK hal_error_t hal_gpio_get_port(uint32_t bank, hal_gpio_port_t *port)
+{
+    (void)bank;
+    if (port == NULL) return HAL_ERROR_NULL_PTR;
+    return HAL_ERROR_NOT_SUPPORTED;
+}
+
+/* =============================================================================
+ * DELAY LOOP
+ * =============================================================================
+ *
+ * One loop for calibration and replay, so a pass costs the same in both.
+ * The nop keeps the compiler from folding it away.
+ */
+
+static uint32_t g_spins_per_ms;
+
+static inline void wave_spin(uint32_t n)
+{
+    while (n--) HAL_NOP();
+}
+
+void gpio_wave_calibrate(void)
+{
+    uint32_t n = 1024;
+    uint64_t us;
+
+    for (;;) {
+        uint64_t t0 = hal_timer_get_ticks();
+        wave_spin(n);
+        us = hal_timer_get_ticks() - t0;
+        if (us >= GPIO_WAVE_CAL_US || n >= (1U << 26)) break;
+        n *= 2;
+    }
+    if (us == 0) us = 1;
+
+    uint64_t per_ms = (uint64_t)n * 1000 / us;
+    g_spins_per_ms = per_ms == 0 ? 1 : (per_ms > 0xFFFFFFFFu ? 0xFFFFFFFFu : (uint32_t)per_ms);
+}
+
+/* Passes for at least delay_ns */
+static uint32_t wave_spins(uint32_t delay_ns)
+{
+    if (delay_ns == 0) return 0;
+    if (g_spins_per_ms == 0) gpio_wave_calibrate();
+
+    uint64_t spins = ((uint64_t)delay_ns * g_spins_per_ms + 999999) / 1000000;
+    return spins > 0xFFFFFFFFu ? 0xFFFFFFFFu : (uint32_t)spins;
+}
+
+static inline uint32_t add_sat(uint32_t a, uint32_t b)
+{
+    return a + b < a ? 0xFFFFFFFFu : a + b;
+}
+
+/* =============================================================================
+ * BUILDING
+ * =============================================================================
+ */
+
+void gpio_wave_init(gpio_wave_t *w, gpio_wave_step_t *steps, uint32_t capacity,
+                    uint32_t bank)
+{
+    *w = (gpio_wave_t){ .steps = steps, .capacity = capacity, .bank = bank };
+}
+
+void gpio_wave_reset(gpio_wave_t *w)
+{
+    w->count = 0;
+    w->error = false;
+}
+
+bool gpio_wave_step(gpio_wave_t *w, uint32_t set, uint32_t clear, uint32_t delay_ns)
+{
+    if ((set & clear) != 0) {
+        w->error = true;
+        return false;
+    }
+
+    uint32_t spins = wave_spins(delay_ns);
+
+    if (w->count > 0) {
+        gpio_wave_step_t *p = &w->steps[w->count - 1];
+
+        /* Nothing to drive: the wait belongs to the step before */
+        if (set == 0 && clear == 0) {
+            p->spins = add_sat(p->spins, spins);
+            return true;
+        }
+
+        /*
+         * Back to back with the step before: fold into it. Our sets then
+         * go out with the old sets, ahead of the old clears, so that is
+         * only safe if there were no old clears or we have no sets. A pin
+         * driven one way there and the other way here is a pulse someone
+         * asked for; leave it.
+         */
+        if (p->spins == 0 && (p->clear == 0 || set == 0) &&
+            ((p->set | set) & (p->clear | clear)) == 0) {
+            p->set   |= set;
+            p->clear |= clear;
+            p->spins  = spins;
+            return true;
+        }
+    }
+
+    if (w->count == w->capacity) {
+        w->error = true;
+        return false;
+    }
+    w->steps[w->count++] = (gpio_wave_step_t){ set, clear, spins };
+    return true;
+}
+
+bool gpio_wave_delay(gpio_wave_t *w, uint32_t delay_ns)
+{
+    return gpio_wave_step(w, 0, 0, delay_ns);
+}
+
+/* =============================================================================
+ * ENCODERS
+ * =============================================================================
+ */
+
+bool gpio_wave_bus_write(gpio_wave_t *w, const gpio_wave_bus_t *bus,
+                         const uint8_t *data, uint32_t len)
+{
+    if (bus->width == 0 || bus->width > 24 || bus->shift + bus->width > 32) {
+        w->error = true;
+        return false;
+    }
+
+    uint32_t field = ((1u << bus->width) - 1) << bus->shift;
+    bool     ok    = true;
+
+    for (uint32_t i = 0; i < len && ok; i++) {
+        uint32_t bits = ((uint32_t)data[i] << bus->shift) & field;
+
+        /* Data and WR# low together; the panel latches on the way back up */
+        ok = gpio_wave_step(w, bits, (field & ~bits) | bus->strobe, bus->low_ns) &&
+             gpio_wave_step(w, bus->strobe, 0, bus->high_ns);
+    }
+    return ok;
+}
+
+bool gpio_wave_spi_write(gpio_wave_t *w, const gpio_wave_spi_t *spi,
+                         const uint8_t *data, uint32_t len)
+{
+    bool ok = true;
+
+    for (uint32_t i = 0; i < len && ok; i++) {
+        for (int b = 7; b >= 0 && ok; b--) {
+            bool one = (data[i] >> b) & 1;
+
+            ok = gpio_wave_step(w, one ? spi->mosi : 0,
+                                spi->sclk | (one ? 0 : spi->mosi), spi->half_ns) &&
+                 gpio_wave_step(w, spi->sclk, 0, spi->half_ns);
+        }
+    }
+    /* Mode 0 idles with SCLK low */
+    return ok && gpio_wave_step(w, 0, spi->sclk, 0);
+}
+
+bool gpio_wave_nrz_write(gpio_wave_t *w, const gpio_wave_nrz_t *nrz,
+                         const uint8_t *data, uint32_t len)
+{
+    bool ok = true;
+
+    for (uint32_t i = 0; i < len && ok; i++) {
+        for (int b = 7; b >= 0 && ok; b--) {
+            uint32_t high = ((data[i] >> b) & 1) ? nrz->t1h_ns : nrz->t0h_ns;
+            uint32_t low  = nrz->bit_ns > high ? nrz->bit_ns - high : 0;
+
+            ok = gpio_wave_step(w, nrz->pin, 0, high) &&
+                 gpio_wave_step(w, 0, nrz->pin, low);
+        }
+    }
+    return ok;
+}
+
+/* =============================================================================
+ * REPLAY
+ * =============================================================================
+ *
+ * A zero mask costs a store on the bus for nothing, so it is skipped; the
+ * branch is free next to the store it saves.
+ */
+
+static void play_port(const gpio_wave_step_t *s, const gpio_wave_step_t *end,
+                      volatile uint32_t *set, volatile uint32_t *clear)
+{
+    for (; s < end; s++) {
+        if (s->set)   *set   = s->set;
+        if (s->clear) *clear = s->clear;
+        wave_spin(s->spins);
+    }
+}
+
+static void play_calls(const gpio_wave_step_t *s, const gpio_wave_step_t *end, uint32_t bank)
+{
+    for (; s < end; s++) {
+        if (s->set)   hal_gpio_set_mask(s->set, bank);
+        if (s->clear) hal_gpio_clear_mask(s->clear, bank);
+        wave_spin(s->spins);
+    }
+}
+
+hal_error_t gpio_wave_play(const gpio_wave_t *w, uint32_t times)
+{
+    if (w->error) return HAL_ERROR_INVALID_ARG;
+
+    const gpio_wave_step_t *end = w->steps + w->count;
+    hal_gpio_port_t         port;
+    hal_error_t             err = hal_gpio_get_port(w->bank, &port);
+
+    if (HAL_OK(err)) {
+        while (times--) play_port(w->steps, end, port.set, port.clear);
+        return HAL_SUCCESS;
+    }
+    if (err != HAL_ERROR_NOT_SUPPORTED) return err;
+
+    /* The bulk calls check the bank; find out once, not per step */
+    err = hal_gpio_set_mask(0, w->bank);
+    if (HAL_FAILED(err)) return err;
+
+    while (times--) play_calls(w->steps, end, w->bank);
+    return HAL_SUCCESS;
+}
@@ -0,0 +1,135 @@
+/*
+ * gpio_wave.h - Precompiled GPIO Waveforms
+ * =========================================
+ *
+ * Bit-banging a bus one pin at a time pays for every edge twice: a
+ * function call with its range checks, and a store per pin. An 8-bit
+ * parallel write is ten calls for the data and strobe, an SPI byte is
+ * twenty-four. The pins that change together can change together:
+ * hal_gpio_set_mask() drives a whole bank's worth in one store.
+ *
+ * A waveform is that idea taken all the way — the bus transaction
+ * compiled once into steps, then replayed as fast as the GPIO block
+ * takes stores:
+ *
+ *   step = { set mask, clear mask, delay }
+ *
+ *   static gpio_wave_step_t steps[1024];
+ *   gpio_wave_t w;
+ *
+ *   gpio_wave_init(&w, steps, ARRAY_SIZE(steps), 0);
+ *   gpio_wave_bus_write(&w, &bus, pixels, len);    // or the SPI / NRZ encoders
+ *   gpio_wave_play(&w, 1);                           // replay as often as needed
+ *
+ * Replay, per step, is at most two stores and a delay loop. Where the
+ * SoC has set/clear registers (hal_gpio_get_port — GPSET/GPCLR on the
+ * BCM2710) the stores go straight to them; otherwise through the bulk
+ * calls, which on the JH7110 are a store per pin.
+ *
+ * WITHIN A STEP:
+ * ==============
+ *
+ * The set store comes first, then the clear store, then the delay. A pin
+ * can't be in both masks. Building merges a step into the one before it
+ * when nothing in between would move — no delay, and no edge crossing
+ * another — so back-to-back edges cost one store pair, not two.
+ *
+ * DELAYS:
+ * =======
+ *
+ * Delays are given in nanoseconds and compiled into passes of a spin
+ * loop, calibrated against hal_timer_get_ticks() the first time a
+ * waveform is built. They are minimums: each step also costs its stores,
+ * which on a peripheral bus behind a bridge are tens of nanoseconds.
+ * A delay of 0 runs the steps at bus speed. Replay runs with whatever
+ * interrupts are enabled; mask them around gpio_wave_play() when the
+ * timing has to hold (WS2812 bits do).
+ *
+ * Replay is from the CPU only. Pacing it by DMA on the BCM2710 needs a
+ * DREQ source, and the only fitting one, the PWM FIFO, already drives
+ * the GPi Case's audio.
+ */
+
+#ifndef GPIO_WAVE_H
+#define GPIO_WAVE_H
+
+#include "types.h"
+#include "hal.h"
+
+#define GPIO_WAVE_CAL_US    2000U   /* How long calibration spins for */
+
+typedef struct {
+    uint32_t set;       /* Pins driven high */
+    uint32_t clear;     /* Then pins driven low */
+    uint32_t spins;     /* Then this many passes of the delay loop */
+} gpio_wave_step_t;
+
+typedef struct {
+    gpio_wave_step_t *steps;    /* Caller's storage */
+    uint32_t          count;
+    uint32_t          capacity;
+    uint32_t          bank;     /* Every step drives this bank */
+    bool              error;    /* A step didn't fit or was invalid */
+} gpio_wave_t;
+
+/* 8080-style parallel bus: data on consecutive pins, latched as WR# rises */
+typedef struct {
+    uint32_t shift;         /* Pin of data bit 0, within the bank */
+    uint32_t width;         /* Data pins, 1..24 */
+    uint32_t strobe;        /* WR# pin mask */
+    uint32_t low_ns;        /* WR# low, data on the pins */
+    uint32_t high_ns;       /* WR# high, after the rising edge */
+} gpio_wave_bus_t;
+
+/* SPI mode 0, MSB first: MOSI changes with SCLK low, sampled as it rises */
+typedef struct {
+    uint32_t mosi;          /* Pin masks */
+    uint32_t sclk;
+    uint32_t half_ns;       /* Each half of the clock period */
+} gpio_wave_spi_t;
+
+/* One-wire NRZ (WS2812 and friends): every bit a high pulse, then low */
+typedef struct {
+    uint32_t pin;           /* Pin mask */
+    uint32_t t0h_ns;        /* High time of a 0 */
+    uint32_t t1h_ns;        /* High time of a 1 */
+    uint32_t bit_ns;        /* Whole bit period */
+} gpio_wave_nrz_t;
+
+/* Start an empty waveform over `capacity` steps of storage */
+void gpio_wave_init(gpio_wave_t *w, gpio_wave_step_t *steps, uint32_t capacity,
+                    uint32_t bank);
+
+/* Drop the steps, keep the storage */
+void gpio_wave_reset(gpio_wave_t *w);
+
+/*
+ * Append a step: drive `set` high, `clear` low, then wait delay_ns.
+ * Returns false (and marks the waveform unplayable) if a pin is in both
+ * masks or the storage is full.
+ */
+bool gpio_wave_step(gpio_wave_t *w, uint32_t set, uint32_t clear, uint32_t delay_ns);
+
+/* Wait delay_ns more after the last step */
+bool gpio_wave_delay(gpio_wave_t *w, uint32_t delay_ns);
+
+/* Encoders: append the steps that send len bytes (bus: two per byte; SPI, NRZ: two per bit) */
+bool gpio_wave_bus_write(gpio_wave_t *w, const gpio_wave_bus_t *bus,
+                         const uint8_t *data, uint32_t len);
+bool gpio_wave_spi_write(gpio_wave_t *w, const gpio_wave_spi_t *spi,
+                         const uint8_t *data, uint32_t len);
+bool gpio_wave_nrz_write(gpio_wave_t *w, const gpio_wave_nrz_t *nrz,
+                         const uint8_t *data, uint32_t len);
+
+/*
+ * Replay the waveform `times` times, back to back.
+ *
+ * @return  HAL_SUCCESS, HAL_ERROR_INVALID_ARG (a build step failed, or
+ *          the bank doesn't exist)
+ */
+hal_error_t gpio_wave_play(const gpio_wave_t *w, uint32_t times);
+
+/* Measure the delay loop now, not on first use (it takes GPIO_WAVE_CAL_US) */
+void gpio_wave_calibrate(void);
+
+#endif /* GPIO_WAVE_H */
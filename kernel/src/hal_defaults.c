@@ -0,0 +1,51 @@
+/*
+ * hal_defaults.c - Weak Platform Defaults
+ * ========================================
+ *
+ * HAL_WEAK fallbacks for the hal_platform.h hooks a SoC may leave out.
+ * They live here rather than in an application so every APP (sysinfo,
+ * bench) links the same ones. Defaults that belong to one subsystem sit
+ * with it instead — timer.c, smp.c, governor.c, gpio_wave.c.
+ */
+
+#include "hal.h"
+
+/* =============================================================================
+ * DYNAMIC READINGS
+ * =============================================================================
+ */
+
+/*
+ * Default hal_platform_poll_dynamic() — one getter per reading. SoCs where
+ * each getter is a round trip to firmware (BCM2710) override this with a
+ * single batched transaction.
+ */
+HAL_WEAK hal_error_t hal_platform_poll_dynamic(hal_platform_dynamic_t *out)
+{
+    if (out == NULL) return HAL_ERROR_NULL_PTR;
+
+    out->arm_freq_hz  = hal_platform_get_arm_freq();
+    out->core_freq_hz = hal_platform_get_clock_rate(HAL_CLOCK_CORE);
+    out->emmc_freq_hz = hal_platform_get_clock_rate(HAL_CLOCK_EMMC);
+    out->pwm_freq_hz  = hal_platform_get_clock_rate(HAL_CLOCK_PWM);
+
+    out->have_temp     = HAL_OK(hal_platform_get_temperature(&out->temp_mc));
+    out->have_throttle = HAL_OK(hal_platform_get_throttle_status(&out->throttle));
+    return HAL_SUCCESS;
+}
+
+HAL_WEAK hal_error_t hal_platform_request_dynamic(void)
+{
+    return HAL_ERROR_NOT_SUPPORTED;
+}
+
+/* =============================================================================
+ * LATE INIT
+ * =============================================================================
+ */
+
+/* Default hal_platform_late_init() — nothing was deferred */
+HAL_WEAK hal_error_t hal_platform_late_init(void)
+{
+    return HAL_SUCCESS;
+}
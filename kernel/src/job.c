@@ -0,0 +1,245 @@
+/*
+ * job.c - Work-Stealing Job System Implementation
+ * ================================================
+ *
+ * See job.h for the design overview.
+ *
+ * MEMORY ORDERING:
+ * ----------------
+ * The deque follows the C11 formulation of Chase-Lev from Lê, Pop, Cohen
+ * and Zappa Nardelli, "Correct and Efficient Work-Stealing for Weak Memory
+ * Models" (PPoPP 2013). The two seq_cst fences are the important part: the
+ * owner's pop and a thief's steal both read top and bottom, and without a
+ * full fence between the store to one and the load of the other, both could
+ * take the last job. ARM64 and RISC-V are weakly ordered, so this matters.
+ *
+ * A thief copies the job out of its slot BEFORE the CAS on top. If the CAS
+ * succeeds, the owner cannot have overwritten that slot: push refuses to
+ * wrap onto any index at or above top.
+ *
+ * IDLE:
+ * -----
+ * On ARM64 an idle worker sleeps in wfe and job_submit() issues sev. The
+ * event register is latched, so a sev that lands between "found nothing"
+ * and wfe simply makes wfe return at once — no lost wake-ups. Elsewhere the
+ * worker spins with spin_hint() (RISC-V has no wfe; see spinlock.h).
+ */
+
+#include "job.h"
+#include "smp.h"
+#include "spinlock.h"
+#include "hal_cpu.h"
+
+#define JOB_CACHE_LINE  64      /* top and bottom live on separate lines */
+
+typedef struct {
+    job_fn_t        fn;
+    void           *arg;
+    job_counter_t  *counter;
+    uint32_t        index;
+} job_t;
+
+typedef struct {
+    volatile long   top;            /* Next slot to steal */
+    uint8_t         pad0[JOB_CACHE_LINE - sizeof(long)];
+    volatile long   bottom;         /* Next slot to push */
+    uint8_t         pad1[JOB_CACHE_LINE - sizeof(long)];
+    job_t           slots[JOB_DEQUE_SIZE];
+} job_deque_t;
+
+#define JOB_MASK    (JOB_DEQUE_SIZE - 1)
+
+static job_deque_t g_deques[HAL_MAX_CPUS] HAL_ALIGNED(JOB_CACHE_LINE);
+
+static inline job_deque_t *job_local_deque(void)
+{
+    uint32_t cpu = hal_cpu_id();
+    return &g_deques[cpu < HAL_MAX_CPUS ? cpu : 0];
+}
+
+static inline void job_sleep(void)
+{
+#if defined(__aarch64__)
+    HAL_WFE();
+#else
+    spin_hint();
+#endif
+}
+
+static inline void job_wake(void)
+{
+#if defined(__aarch64__)
+    HAL_DSB();
+    HAL_SEV();
+#endif
+}
+
+/* =============================================================================
+ * DEQUE OPERATIONS
+ * =============================================================================
+ */
+
+static bool deque_push(job_deque_t *q, const job_t *job)
+{
+    long b = __atomic_load_n(&q->bottom, __ATOMIC_RELAXED);
+    long t = __atomic_load_n(&q->top, __ATOMIC_ACQUIRE);
+
+    if (b - t >= JOB_DEQUE_SIZE) {
+        return false;
+    }
+
+    q->slots[b & JOB_MASK] = *job;
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&q->bottom, b + 1, __ATOMIC_RELAXED);
+    return true;
+}
+
+static bool deque_pop(job_deque_t *q, job_t *out)
+{
+    long b = __atomic_load_n(&q->bottom, __ATOMIC_RELAXED) - 1;
+    __atomic_store_n(&q->bottom, b, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    long t = __atomic_load_n(&q->top, __ATOMIC_RELAXED);
+
+    if (t > b) {
+        /* Empty */
+        __atomic_store_n(&q->bottom, b + 1, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    *out = q->slots[b & JOB_MASK];
+    if (t == b) {
+        /* Last job: race the thieves for it */
+        bool won = __atomic_compare_exchange_n(&q->top, &t, t + 1, false,
+                                               __ATOMIC_SEQ_CST,
+                                               __ATOMIC_RELAXED);
+        __atomic_store_n(&q->bottom, b + 1, __ATOMIC_RELAXED);
+        return won;
+    }
+    return true;
+}
+
+static bool deque_steal(job_deque_t *q, job_t *out)
+{
+    long t = __atomic_load_n(&q->top, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    long b = __atomic_load_n(&q->bottom, __ATOMIC_ACQUIRE);
+
+    if (t >= b) {
+        return false;
+    }
+
+    *out = q->slots[t & JOB_MASK];
+    return __atomic_compare_exchange_n(&q->top, &t, t + 1, false,
+                                       __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+}
+
+/* =============================================================================
+ * SCHEDULING
+ * =============================================================================
+ */
+
+static inline void job_run(const job_t *job)
+{
+    job->fn(job->arg, job->index);
+    __atomic_sub_fetch(&job->counter->pending, 1, __ATOMIC_RELEASE);
+}
+
+/*
+ * Find one job and run it: own deque first (LIFO — its data is still warm
+ * in this core's cache), then steal round-robin starting at our neighbour
+ * so thieves don't all pile onto core 0.
+ */
+static bool job_run_one(void)
+{
+    uint32_t self = hal_cpu_id();
+    job_t job;
+
+    if (self >= HAL_MAX_CPUS) self = 0;
+
+    if (deque_pop(&g_deques[self], &job)) {
+        job_run(&job);
+        return true;
+    }
+
+    uint32_t mask = smp_online_mask();
+    for (uint32_t i = 1; i < HAL_MAX_CPUS; i++) {
+        uint32_t victim = (self + i) % HAL_MAX_CPUS;
+        if (!(mask & (1u << victim))) continue;
+        if (deque_steal(&g_deques[victim], &job)) {
+            job_run(&job);
+            return true;
+        }
+    }
+    return false;
+}
+
+/* =============================================================================
+ * PUBLIC API
+ * =============================================================================
+ */
+
+void job_init(void)
+{
+    for (uint32_t i = 0; i < HAL_MAX_CPUS; i++) {
+        g_deques[i].top = 0;
+        g_deques[i].bottom = 0;
+    }
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+void job_submit(job_counter_t *counter, job_fn_t fn, void *arg, uint32_t index)
+{
+    job_t job = { .fn = fn, .arg = arg, .counter = counter, .index = index };
+
+    __atomic_add_fetch(&counter->pending, 1, __ATOMIC_RELAXED);
+    if (!deque_push(job_local_deque(), &job)) {
+        job_run(&job);
+        return;
+    }
+    job_wake();
+}
+
+void job_wait(job_counter_t *counter)
+{
+    while (__atomic_load_n(&counter->pending, __ATOMIC_ACQUIRE) != 0) {
+        if (!job_run_one()) {
+            spin_hint();
+        }
+    }
+}
+
+void job_parallel_for(uint32_t count, job_fn_t fn, void *arg)
+{
+    if (count == 0) return;
+
+    /* One core, or one item: skip the deque entirely */
+    if (count == 1 || smp_cpu_count() == 1) {
+        for (uint32_t i = 0; i < count; i++) {
+            fn(arg, i);
+        }
+        return;
+    }
+
+    job_counter_t counter = { 0 };
+
+    /*
+     * Push all but the first item, then run the first one here. By the
+     * time it's done the other cores have stolen their share.
+     */
+    for (uint32_t i = 1; i < count; i++) {
+        job_submit(&counter, fn, arg, i);
+    }
+    fn(arg, 0);
+    job_wait(&counter);
+}
+
+void job_worker_loop(uint32_t cpu)
+{
+    (void)cpu;
+    while (1) {
+        if (!job_run_one()) {
+            job_sleep();
+        }
+    }
+}
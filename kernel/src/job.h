@@ -0,0 +1,67 @@
+/*
+ * job.h - Work-Stealing Job System
+ * =================================
+ *
+ * Splits bulk work (framebuffer bands, asset decoding, ...) across every
+ * online core. Each core owns a fixed-size deque of jobs:
+ *
+ *                    steal (other cores)
+ *                         │
+ *        top ──> ┌─────┬──▼──┬─────┬─────┬─────┐ <── bottom
+ *                │ job │ job │ job │ job │     │
+ *                └─────┴─────┴─────┴─────┴─────┘
+ *                                        ▲
+ *                          push / pop (owner only)
+ *
+ * The owner pushes and pops at the bottom without any atomic read-modify-
+ * write in the common case. Idle cores steal from the top with a single
+ * compare-and-swap. This is the Chase-Lev deque (Chase & Lev, "Dynamic
+ * Circular Work-Stealing Deque", SPAA 2005), minus the resizing: a full
+ * deque just runs the job inline.
+ *
+ * COMPLETION:
+ * -----------
+ * Jobs are grouped by a job_counter_t. job_submit() increments it, a
+ * finished job decrements it, and job_wait() helps run jobs until it
+ * reaches zero. Waiting never blocks — the waiter is a worker too, which is
+ * what makes nested parallelism (a job submitting jobs) deadlock-free.
+ *
+ * BEFORE smp_init():
+ * ------------------
+ * Everything works with one core: jobs go onto core 0's deque and
+ * job_wait() pops and runs them itself.
+ */
+
+#ifndef JOB_H
+#define JOB_H
+
+#include "hal_types.h"
+
+#define JOB_DEQUE_SIZE  256     /* Per core, power of two */
+
+/* A job runs fn(arg, index). index lets one fn/arg pair cover many items. */
+typedef void (*job_fn_t)(void *arg, uint32_t index);
+
+typedef struct {
+    volatile uint32_t pending;
+} job_counter_t;
+
+/* Reset every deque. Called by smp_init() before any core starts. */
+void job_init(void);
+
+/* Queue fn(arg, index) on the calling core; runs inline if the deque is full */
+void job_submit(job_counter_t *counter, job_fn_t fn, void *arg, uint32_t index);
+
+/* Run jobs (own first, then stolen) until counter reaches zero */
+void job_wait(job_counter_t *counter);
+
+/*
+ * Run fn(arg, i) for every i in [0, count) across all cores and return
+ * when all of them have finished. The calling core takes part.
+ */
+void job_parallel_for(uint32_t count, job_fn_t fn, void *arg);
+
+/* Main loop of a secondary core. Never returns. */
+HAL_NORETURN void job_worker_loop(uint32_t cpu);
+
+#endif /* JOB_H */
@@ -23,10 +23,10 @@
  *             startup, never touched again.
  *
  *   DYNAMIC — CPU/Core/eMMC clock frequencies, CPU temperature,
- *             throttle/undervoltage status.  Polled and redrawn every
- *             UPDATE_INTERVAL_MS milliseconds.
+ *             throttle/undervoltage status, heap metrics.  Polled and
+ *             redrawn every UPDATE_INTERVAL_MS milliseconds.
  *
- * Only the two dynamic panels (PROCESSOR, SYSTEM STATUS) are erased and
+ * Only the three dynamic panels (PROCESSOR, SYSTEM STATUS, HEAP) are erased and
  * redrawn on each update cycle.  Everything else stays in DRAM untouched,
  * which minimises the per-frame DMA flush cost on SimpleFB platforms.
  *
@@ -34,7 +34,7 @@
  *   Row 1: BOARD (left)      + DISPLAY (right)       — static
  *   Row 2: PROCESSOR (left)  + PERIPHERALS (right)   — PROCESSOR dynamic
  *   Row 3: MEMORY (left)     + SYSTEM STATUS (right) — SYSTEM STATUS dynamic
- *   Full:  BOOT SEQUENCE                             — static
+ *   Row 4: BOOT SEQUENCE (left) + HEAP (right)       — HEAP dynamic
  *
  * PORTABILITY:
  * ------------
@@ -77,16 +77,27 @@
 
 #include "types.h"
 #include "framebuffer.h"
+#include "console.h"
+#include "smp.h"
+#include "job.h"
+#include "timer.h"
+#include "prof.h"
+#include "boottime.h"
+#include "governor.h"
 
 /* HAL Interface Headers */
 #include "mmio.h"
 #include "hal.h"
+#include "hal_cache.h"
 
 /* UI System */
 #include "ui_types.h"
 #include "ui_theme.h"
 #include "ui_widgets.h"
+#include "ui_displaylist.h"
 #include "../../memory/src/allocator.h"
+#include "../../memory/src/arena.h"
+#include "../../memory/src/dma_pool.h"
 
 
 /* =============================================================================
@@ -95,6 +106,9 @@
  */
 
 #define UPDATE_INTERVAL_MS  1000U
+#define FRAME_ARENA_SIZE    (64 * 1024)     /* Each of the two frame arenas */
+#define DYN_DL_BYTES        (16 * 1024)     /* Display-list commands per frame */
+#define PROF_DUMP_FRAMES    10U             /* prof_dump() every N updates */
 
 
 /* =============================================================================
@@ -102,21 +116,54 @@
  * =============================================================================
  */
 
-static allocator_t alloc;
 extern char __heap_start;
 
+/*
+ * Display list for the dynamic panels. Each tick re-records them and only
+ * the tiles whose command stream changed (the frame counter, a clock
+ * value) are actually redrawn. Every dynamic panel starts by repainting
+ * its whole rectangle, which is what the display list's ownership rule
+ * needs. The commands only live until ui_dl_end() has rasterized them,
+ * so each frame records into a fresh frame_alloc() block (arena.h).
+ */
+static ui_dl_t dyn_dl;
+
+/*
+ * Layers (framebuffer.h, OFF-SCREEN SURFACES). Everything that never
+ * changes — the static panels, and the fill, border and header of the
+ * dynamic ones — is drawn once into g_static_layer; the PERIPHERALS
+ * toasts go into an overlay above it. The screen starts as the two
+ * composited, and each tick a dynamic panel repaints its background by
+ * copying its rectangle back from the static layer.
+ *
+ * If the heap can't spare a screen-sized surface, g_layer_count stays 0
+ * and everything is drawn straight to the framebuffer instead.
+ */
+static fb_surface_t        g_static_layer;
+static fb_surface_t        g_toast_layer;
+static const fb_surface_t *g_layers[2];
+static uint32_t            g_layer_count;
+
 extern uint64_t __ram_base;
 extern uint64_t __ram_size;
 
 
 /* =============================================================================
- * ARCHITECTURE-PORTABLE IDLE
+ * UPDATE TICK
  * =============================================================================
+ *
+ * A periodic timer event raises a flag once per UPDATE_INTERVAL_MS, and the
+ * render loop sleeps in cpu_idle_wait() until it does. Between frames the
+ * boot core sits in wfi instead of spinning on the counter (timer.h).
  */
 
-static inline void cpu_idle(void)
+static hal_timer_event_t g_update_event;
+static volatile bool     g_update_due;
+
+static void update_tick(void *arg)
 {
-    HAL_WFI();
+    (void)arg;
+    g_update_due = true;
 }
 
 
@@ -346,6 +393,10 @@ typedef struct {
     /* Throttle / undervoltage */
     uint32_t throttle;          /* HAL_THROTTLE_* bitmask                 */
     bool     have_throttle;     /* true if throttle read succeeded        */
+
+    /* Heap — always available, no HAL involved */
+    allocator_metrics_t heap;
+    bool     heap_ok;           /* heap_validate() found no corruption    */
 } dynamic_state_t;
 
 
@@ -486,19 +537,15 @@ static const char *get_boot_stage(hal_platform_id_t id, int index)
  * mstr() — draw a string with transparent background at current font_scale.
  * mtw()  — measure a string's pixel width at current font_scale.
  *
- * At font_scale=1 (≤1080p): delegates to fb_draw_string_transparent.
- *   → Identical to previous behaviour on Milk-V Mars, Raspberry Pi, etc.
- *
- * At font_scale>1 (1440p, 4K): delegates to fb_draw_string_scaled_transparent.
- *   → Requires fb_draw_string_scaled_transparent() in framebuffer.c.
- *     See framebuffer_addition.c for the implementation to paste in.
+ * Both scales go straight to fb_draw_text_run(), which clips once per
+ * string and writes each glyph row as spans instead of per-pixel calls.
+ * At font_scale=1 the output is identical to fb_draw_string_transparent.
  *
  * TEACHING NOTE:
  * The wrapper pattern is a classical "single point of change" design.
  * Adding font scaling to a codebase with 50+ text draw calls would
  * normally require touching every call site. By routing all calls through
  * these two functions, the scaling logic lives in exactly one place.
- * At font_scale=1: delegates to fb_draw_string_transparent (no overhead).
  * Widgets use the same pattern via wstr()/wtw() in ui_widgets.c, reading
  * font_scale from theme instead of layout — same value, same scale.
  */
@@ -506,10 +553,7 @@ static const char *get_boot_stage(hal_platform_id_t id, int index)
 static void mstr(framebuffer_t *fb, const layout_t *L,
                  uint32_t x, uint32_t y, const char *s, uint32_t color)
 {
-    if (L->font_scale <= 1)
-        fb_draw_string_transparent(fb, x, y, s, color);
-    else
-        fb_draw_string_scaled_transparent(fb, x, y, s, color, L->font_scale);
+    fb_draw_text_run(fb, x, y, s, color, 0, L->font_scale, FB_TEXT_TRANSPARENT);
 }
 
 static uint32_t mtw(const layout_t *L, const char *s)
@@ -523,6 +567,17 @@ static uint32_t mtw(const layout_t *L, const char *s)
  * =============================================================================
  */
 
+/* Y of a panel header's divider, and of the first content row below it */
+static inline uint32_t panel_divider_y(const layout_t *L, uint32_t py)
+{
+    return py + L->hdr_h - 2;
+}
+
+static inline uint32_t panel_content_y(const layout_t *L, uint32_t py)
+{
+    return panel_divider_y(L, py) + L->pad / 2;
+}
+
 /*
  * draw_panel_header() — title text + horizontal divider.
  * Returns the Y coordinate where panel content should begin.
@@ -534,10 +589,60 @@ static uint32_t draw_panel_header(framebuffer_t *fb,
                                    uint32_t pw, const char *title)
 {
     mstr(fb, L, px + L->pad, py + L->pad / 2, title, theme->colors.accent);
-    uint32_t divider_y = py + L->hdr_h - 2;
-    fb_draw_hline(fb, px + L->pad, divider_y, pw - 2 * L->pad,
+    fb_draw_hline(fb, px + L->pad, panel_divider_y(L, py), pw - 2 * L->pad,
                   theme->colors.border);
-    return divider_y + L->pad / 2;
+    return panel_content_y(L, py);
+}
+
+/*
+ * draw_panel_chrome() — panel fill + header, the part of a panel that is
+ * the same every frame. Returns where content begins.
+ */
+static uint32_t draw_panel_chrome(framebuffer_t *fb,
+                                  const layout_t *L,
+                                  const ui_theme_t *theme,
+                                  uint32_t px, uint32_t py,
+                                  uint32_t pw, uint32_t ph,
+                                  const char *title)
+{
+    ui_draw_panel(fb, ui_rect(px, py, pw, ph), theme, UI_PANEL_ELEVATED);
+    return draw_panel_header(fb, L, theme, px, py, pw, title);
+}
+
+/*
+ * restore_panel() — a dynamic panel's background for this frame: its
+ * rectangle copied back from the static layer, where draw_static_panels()
+ * drew the chrome, or the chrome drawn again without one. Either way the
+ * old values are gone. Returns where content begins.
+ */
+static uint32_t restore_panel(framebuffer_t *fb,
+                              const layout_t *L,
+                              const ui_theme_t *theme,
+                              uint32_t px, uint32_t py,
+                              uint32_t pw, uint32_t ph,
+                              const char *title)
+{
+    if (g_layer_count == 0) {
+        return draw_panel_chrome(fb, L, theme, px, py, pw, ph, title);
+    }
+    fb_draw_surface(fb, &g_static_layer, (int32_t)px, (int32_t)py, pw, ph);
+    return panel_content_y(L, py);
+}
+
+/*
+ * draw_toast() — ui_draw_toast() into the overlay layer, whose
+ * coordinates start at its own corner, or onto fb without one.
+ */
+static void draw_toast(framebuffer_t *fb, fb_surface_t *overlay,
+                       ui_rect_t r, const ui_theme_t *theme,
+                       const char *message, ui_toast_style_t style)
+{
+    if (overlay != NULL) {
+        r.x -= overlay->x;
+        r.y -= overlay->y;
+        fb = &overlay->fb;
+    }
+    ui_draw_toast(fb, r, theme, message, style);
 }
 
 /*
@@ -616,17 +721,61 @@ static void static_state_init(static_state_t *s, uint32_t fb_width)
 
 static void dynamic_state_poll(dynamic_state_t *d)
 {
-    /* Clock frequencies — all can change between frames */
-    d->arm_hz  = hal_platform_get_arm_freq();
-    d->core_hz = hal_platform_get_clock_rate(HAL_CLOCK_CORE);
-    d->emmc_hz = hal_platform_get_clock_rate(HAL_CLOCK_EMMC);
-    d->pwm_hz  = hal_platform_get_clock_rate(HAL_CLOCK_PWM);
+    /*
+     * Clocks, temperature, throttle flags — all can change between frames.
+     * Ask first, walk the heap while the firmware answers, then collect.
+     */
+    hal_platform_dynamic_t dyn = {0};
+    hal_platform_request_dynamic();
 
-    /* Temperature */
-    d->have_temp = HAL_OK(hal_platform_get_temperature(&d->temp_mc));
+    /*
+     * Heap metrics + a full validation walk. The walk is O(blocks), and
+     * this kernel keeps a few hundred at most, so once a second is cheap.
+     */
+    heap_get_metrics(&d->heap);
+    d->heap_ok = heap_validate(NULL);
+
+    hal_platform_poll_dynamic(&dyn);
 
-    /* Throttle / undervoltage flags */
-    d->have_throttle = HAL_OK(hal_platform_get_throttle_status(&d->throttle));
+    d->arm_hz  = dyn.arm_freq_hz;
+    d->core_hz = dyn.core_freq_hz;
+    d->emmc_hz = dyn.emmc_freq_hz;
+    d->pwm_hz  = dyn.pwm_freq_hz;
+
+    d->temp_mc   = dyn.temp_mc;
+    d->have_temp = dyn.have_temp;
+
+    d->throttle      = dyn.throttle;
+    d->have_throttle = dyn.have_throttle;
+}
+
+
+/* =============================================================================
+ * BOOT-TIME QUERIES
+ * =============================================================================
+ *
+ * static_state_init() and the first dynamic_state_poll() are a string of
+ * mailbox round trips on the BCM2710 — tens of milliseconds that have
+ * nothing to do with pixels. kernel_main() hands them to a job worker and
+ * clears the screen meanwhile; the first frame only waits for whichever
+ * finishes last. One job, not two, so the mailbox sees one client at a
+ * time.
+ */
+
+typedef struct {
+    static_state_t  *s;
+    dynamic_state_t *d;
+    uint32_t         fb_width;
+} boot_query_t;
+
+static void boot_query_job(void *arg, uint32_t index)
+{
+    boot_query_t *q = arg;
+    (void)index;
+
+    static_state_init(q->s, q->fb_width);
+    dynamic_state_poll(q->d);
+    boottime_mark("hal_queries");
 }
 
 
@@ -639,11 +788,16 @@ static void dynamic_state_poll(dynamic_state_t *d)
  *   - Row 1: BOARD (left)              + DISPLAY (right)
  *   - Row 2: [PROCESSOR placeholder]   + PERIPHERALS (right)
  *   - Row 3: MEMORY (left)             + [SYSTEM STATUS placeholder]
- *   - BOOT SEQUENCE                    (full width)
+ *   - Row 4: BOOT SEQUENCE (left)      + [HEAP placeholder]
  *
  * The PROCESSOR and SYSTEM STATUS panels are drawn by draw_dynamic_panels.
  * We advance cur_y past row 2 and draw PERIPHERALS at the correct Y so
- * that all subsequent static panels land in the right place.
+ * that all subsequent static panels land in the right place. Their chrome
+ * (fill, border, header) IS drawn here: in the static layer, that is the
+ * background restore_panel() copies back every frame.
+ *
+ * toasts is the overlay layer for the PERIPHERALS toasts, or NULL to draw
+ * them into fb with everything else.
  *
  * TEACHING NOTE: This function reads ONLY from static_state_t and the
  * framebuffer struct — it makes zero HAL calls. That constraint is the
@@ -652,7 +806,8 @@ static void dynamic_state_poll(dynamic_state_t *d)
 static void draw_static_panels(framebuffer_t *fb,
                                 const layout_t *L,
                                 const ui_theme_t *theme,
-                                const static_state_t *s)
+                                const static_state_t *s,
+                                fb_surface_t *toasts)
 {
     char buf[20];
     uint32_t cur_y = L->margin;
@@ -770,13 +925,14 @@ static void draw_static_panels(framebuffer_t *fb,
     cur_y += panel_3row + L->panel_gap;
 
     /* -------------------------------------------------------------------------
-     * ROW 2 LEFT: PROCESSOR placeholder — drawn by draw_dynamic_panels.
+     * ROW 2 LEFT: PROCESSOR chrome — the values are draw_dynamic_panels'.
      * ROW 2 RIGHT: PERIPHERALS
      *
-     * We don't draw the PROCESSOR panel here — draw_dynamic_panels owns it.
-     * We DO advance cur_y by panel_4row so ROW 3 lands at the correct Y.
+     * We advance cur_y by panel_4row so ROW 3 lands at the correct Y.
      * -------------------------------------------------------------------------
      */
+    draw_panel_chrome(fb, L, theme, L->left_x, cur_y, L->col_w, panel_4row,
+                      "PROCESSOR");
     {
         uint32_t px = L->right_x, pw = L->col_w;
         ui_rect_t panel = ui_rect(px, cur_y, pw, panel_4row);
@@ -790,8 +946,8 @@ static void draw_static_panels(framebuffer_t *fb,
                  theme->colors.text_secondary);
             ui_rect_t toast = ui_rect(px + L->pad + 10 * L->char_w, y - 3,
                                       L->toast_w, L->toast_h);
-            ui_draw_toast(fb, toast, theme, usb_on ? "Active" : "Off",
-                          usb_on ? UI_TOAST_SUCCESS : UI_TOAST_ERROR);
+            draw_toast(fb, toasts, toast, theme, usb_on ? "Active" : "Off",
+                       usb_on ? UI_TOAST_SUCCESS : UI_TOAST_ERROR);
         }
         y += L->row_h + 4 * L->sy;
 
@@ -802,8 +958,8 @@ static void draw_static_panels(framebuffer_t *fb,
                  theme->colors.text_secondary);
             ui_rect_t toast = ui_rect(px + L->pad + 10 * L->char_w, y - 3,
                                       L->toast_w, L->toast_h);
-            ui_draw_toast(fb, toast, theme, sd_on ? "Active" : "Off",
-                          sd_on ? UI_TOAST_SUCCESS : UI_TOAST_ERROR);
+            draw_toast(fb, toasts, toast, theme, sd_on ? "Active" : "Off",
+                       sd_on ? UI_TOAST_SUCCESS : UI_TOAST_ERROR);
         }
         y += L->row_h + 4 * L->sy;
 
@@ -814,8 +970,8 @@ static void draw_static_panels(framebuffer_t *fb,
                  theme->colors.text_secondary);
             ui_rect_t toast = ui_rect(px + L->pad + 10 * L->char_w, y - 3,
                                       L->toast_w, L->toast_h);
-            ui_draw_toast(fb, toast, theme, i2c_on ? "Active" : "Off",
-                          i2c_on ? UI_TOAST_SUCCESS : UI_TOAST_ERROR);
+            draw_toast(fb, toasts, toast, theme, i2c_on ? "Active" : "Off",
+                       i2c_on ? UI_TOAST_SUCCESS : UI_TOAST_ERROR);
         }
     }
 
@@ -823,9 +979,11 @@ static void draw_static_panels(framebuffer_t *fb,
 
     /* -------------------------------------------------------------------------
      * ROW 3 LEFT: MEMORY
-     * ROW 3 RIGHT: SYSTEM STATUS placeholder — drawn by draw_dynamic_panels.
+     * ROW 3 RIGHT: SYSTEM STATUS chrome — the values are draw_dynamic_panels'.
      * -------------------------------------------------------------------------
      */
+    draw_panel_chrome(fb, L, theme, L->right_x, cur_y, L->col_w, panel_3row,
+                      "SYSTEM STATUS");
     {
         uint32_t px = L->left_x, pw = L->col_w;
         ui_rect_t panel = ui_rect(px, cur_y, pw, panel_3row);
@@ -913,14 +1071,17 @@ static void draw_static_panels(framebuffer_t *fb,
     cur_y += panel_3row + L->panel_gap;
 
     /* -------------------------------------------------------------------------
-     * BOOT SEQUENCE — full width
+     * ROW 4 LEFT: BOOT SEQUENCE
+     * ROW 4 RIGHT: HEAP chrome — the values are draw_dynamic_panels'.
      * -------------------------------------------------------------------------
      */
+    draw_panel_chrome(fb, L, theme, L->right_x, cur_y, L->col_w, panel_2row,
+                      "HEAP");
     {
-        ui_rect_t panel = ui_rect(L->left_x, cur_y, L->full_w, panel_2row);
+        ui_rect_t panel = ui_rect(L->left_x, cur_y, L->col_w, panel_2row);
         ui_draw_panel(fb, panel, theme, UI_PANEL_ELEVATED);
         uint32_t y = draw_panel_header(fb, L, theme, L->left_x, cur_y,
-                                       L->full_w, "BOOT SEQUENCE");
+                                       L->col_w, "BOOT SEQUENCE");
 
         uint32_t bx = L->left_x + L->pad;
         for (int i = 0; ; i++) {
@@ -949,10 +1110,11 @@ static void draw_static_panels(framebuffer_t *fb,
  * Called every UPDATE_INTERVAL_MS. Redraws only:
  *   - PROCESSOR panel     (left col, row 2) — clock frequencies + bars
  *   - SYSTEM STATUS panel (right col, row 3) — temperature + throttle
+ *   - HEAP panel          (right col, row 4) — allocator metrics
  *
- * Strategy: fill the panel rect with the panel background colour (erasing
- * stale values), re-draw the panel chrome, then redraw all content from
- * scratch using the freshly polled dynamic_state.
+ * Strategy: restore the panel rect from the static layer (erasing stale
+ * values — see restore_panel()), then redraw all content from scratch
+ * using the freshly polled dynamic_state.
  *
  * Y coordinates are recomputed using the same arithmetic as draw_static_panels
  * so they always match exactly.
@@ -985,6 +1147,7 @@ static void draw_dynamic_panels(framebuffer_t *fb,
     uint32_t row1_y = L->margin    + panel_2row + L->panel_gap;
     uint32_t row2_y = row1_y       + panel_3row + L->panel_gap;
     uint32_t row3_y = row2_y       + panel_4row + L->panel_gap;
+    uint32_t row4_y = row3_y       + panel_3row + L->panel_gap;
 
     /* -------------------------------------------------------------------------
      * PROCESSOR panel (left column, row 2)
@@ -998,10 +1161,7 @@ static void draw_dynamic_panels(framebuffer_t *fb,
         uint32_t px = L->left_x, pw = L->col_w;
         uint32_t ph = panel_4row;
 
-        ui_rect_t panel = ui_rect(px, row2_y, pw, ph);
-        ui_draw_panel(fb, panel, theme, UI_PANEL_ELEVATED);
-
-        uint32_t y = draw_panel_header(fb, L, theme, px, row2_y, pw, "PROCESSOR");
+        uint32_t y = restore_panel(fb, L, theme, px, row2_y, pw, ph, "PROCESSOR");
 
         /* CPU clock */
         if (d->arm_hz > 0) {
@@ -1057,11 +1217,8 @@ static void draw_dynamic_panels(framebuffer_t *fb,
         uint32_t px = L->right_x, pw = L->col_w;
         uint32_t ph = panel_3row;
 
-        ui_rect_t panel = ui_rect(px, row3_y, pw, ph);
-        ui_draw_panel(fb, panel, theme, UI_PANEL_ELEVATED);
-
-        uint32_t y = draw_panel_header(fb, L, theme, px, row3_y, pw,
-                                       "SYSTEM STATUS");
+        uint32_t y = restore_panel(fb, L, theme, px, row3_y, pw, ph,
+                                   "SYSTEM STATUS");
 
         /* Temperature */
         mstr(fb, L, px + L->pad, y, "Temp:", theme->colors.text_secondary);
@@ -1118,6 +1275,229 @@ static void draw_dynamic_panels(framebuffer_t *fb,
                  "N/A", theme->colors.text_secondary);
         }
     }
+
+    /* -------------------------------------------------------------------------
+     * HEAP panel (right column, row 4)
+     *
+     * 2 content rows, three columns 14 characters apart so they still fit
+     * the 38-character column at 640x480:
+     *   Used / Peak / Frag       — capacity and fragmentation
+     *   Big  / Lat  / Chk        — largest free block, worst TLSF-path
+     *                              heap_alloc() in microseconds, validation
+     * -------------------------------------------------------------------------
+     */
+    {
+        uint32_t px = L->right_x, pw = L->col_w;
+        const allocator_metrics_t *h = &d->heap;
+        uint32_t c0 = px + L->pad;
+        uint32_t c1 = c0 + 14 * L->char_w;
+        uint32_t c2 = c0 + 28 * L->char_w;
+        ui_color_t dim = theme->colors.text_secondary;
+        ui_color_t val = theme->colors.text_primary;
+        const char *v;
+
+        uint32_t y = restore_panel(fb, L, theme, px, row4_y, pw, panel_2row,
+                                   "HEAP");
+
+        mstr(fb, L, c0, y, "Used:", dim);
+        v = u64_to_dec(h->allocated >> 10, buf);
+        mstr(fb, L, c0 + 6 * L->char_w, y, v, val);
+        mstr(fb, L, c0 + 6 * L->char_w + mtw(L, v), y, "K", dim);
+
+        mstr(fb, L, c1, y, "Peak:", dim);
+        v = u64_to_dec(h->peak_allocated >> 10, buf);
+        mstr(fb, L, c1 + 6 * L->char_w, y, v, val);
+        mstr(fb, L, c1 + 6 * L->char_w + mtw(L, v), y, "K", dim);
+
+        mstr(fb, L, c2, y, "Frag:", dim);
+        v = u64_to_dec(h->fragmentation_pct, buf);
+        mstr(fb, L, c2 + 5 * L->char_w, y, v,
+             h->fragmentation_pct > 50 ? theme->colors.warning : val);
+        mstr(fb, L, c2 + 5 * L->char_w + mtw(L, v), y, "%", dim);
+        y += L->row_h;
+
+        mstr(fb, L, c0, y, "Big:", dim);
+        v = u64_to_dec(h->largest_free >> 10, buf);
+        mstr(fb, L, c0 + 5 * L->char_w, y, v, val);
+        mstr(fb, L, c0 + 5 * L->char_w + mtw(L, v), y, "K", dim);
+
+        mstr(fb, L, c1, y, "Lat:", dim);
+        v = u64_to_dec(h->alloc_ticks_max, buf);
+        mstr(fb, L, c1 + 5 * L->char_w, y, v, val);
+        mstr(fb, L, c1 + 5 * L->char_w + mtw(L, v), y, "us", dim);
+
+        mstr(fb, L, c2, y, "Chk:", dim);
+        mstr(fb, L, c2 + 5 * L->char_w, y,
+             d->heap_ok ? "OK" : "BAD",
+             d->heap_ok ? theme->colors.success : theme->colors.error);
+    }
+}
+
+
+/* =============================================================================
+ * PROFILING OVERLAY
+ * =============================================================================
+ *
+ * A strip along the bottom edge with the previous frame's timings from
+ * kernel/src/prof.h — the current frame isn't finished when it is drawn:
+ *
+ *   Frame 1843us  poll 412  wait 0  record 96  raster 1201  present 130 ...
+ *
+ * Recorded into the display list last, so it sits on top of everything.
+ * It paints its own opaque background (the display list's ownership rule)
+ * and only the tiles whose numbers changed are redrawn. The first pass
+ * measures how many lines the zones wrap onto, the second draws them;
+ * values get fixed-width columns so the strip never shrinks and leaves
+ * stale pixels above it.
+ */
+
+static uint32_t prof_hud_layout(framebuffer_t *fb, const layout_t *L,
+                                const ui_theme_t *theme,
+                                const prof_frame_t *pf, uint32_t y0,
+                                bool draw)
+{
+    char buf[20];
+    uint32_t x_end = fb->width - L->pad;
+    uint32_t x = L->pad, y = y0;
+    ui_color_t dim = theme->colors.text_secondary;
+    ui_color_t val = theme->colors.text_primary;
+
+    const char *v = u64_to_dec(pf->frame_us, buf);
+    if (draw) {
+        mstr(fb, L, x, y, "Frame", dim);
+        mstr(fb, L, x + 6 * L->char_w, y, v, theme->colors.accent);
+    }
+    x += 6 * L->char_w + mtw(L, v);
+    if (draw) mstr(fb, L, x, y, "us", dim);
+    x += 4 * L->char_w;
+
+    for (uint32_t i = 0; i < prof_zone_count(); i++) {
+        const char *name = prof_zone_name(i);
+        v = u64_to_dec(pf->zone_us[i], buf);
+
+        /* Fixed 7-digit value columns: the wrap doesn't move with the data */
+        uint32_t w = mtw(L, name) + L->char_w + 7 * L->char_w + L->char_w;
+        if (x + w > x_end && x > L->pad) {
+            x = L->pad;
+            y += L->row_h;
+        }
+        if (draw) {
+            mstr(fb, L, x, y, name, dim);
+            mstr(fb, L, x + mtw(L, name) + L->char_w, y, v, val);
+        }
+        x += w;
+    }
+    return y + L->row_h - y0;
+}
+
+static void draw_prof_hud(framebuffer_t *fb, const layout_t *L,
+                          const ui_theme_t *theme)
+{
+    const prof_frame_t *pf = prof_last_frame();
+    if (pf == NULL) return;
+
+    uint32_t text_h = prof_hud_layout(fb, L, theme, pf, 0, false);
+    uint32_t h = text_h + L->pad;
+    uint32_t y = fb->height - h;
+
+    fb_fill_rect(fb, 0, y, fb->width, h, theme->colors.bg_secondary);
+    prof_hud_layout(fb, L, theme, pf, y + L->pad / 2, true);
+}
+
+
+/* =============================================================================
+ * LAYERS
+ * =============================================================================
+ *
+ * The static layer covers the whole screen, with the framebuffer's format
+ * and pitch; restoring a panel from it copies rows at the same offsets.
+ * The toast overlay only covers the PERIPHERALS panel, the one place
+ * toasts are drawn.
+ */
+
+/*
+ * static_layers_init() — create the layers for fb. Returns where
+ * draw_static_panels() should draw — the static layer, or fb itself
+ * without one — and sets *toasts to the overlay, or NULL.
+ */
+static framebuffer_t *static_layers_init(framebuffer_t *fb, const layout_t *L,
+                                         fb_surface_t **toasts)
+{
+    g_layer_count = 0;
+    *toasts = NULL;
+
+    if (!fb_surface_create(&g_static_layer, fb, 0, 0, fb->width, fb->height)) {
+        return fb;
+    }
+    g_layers[g_layer_count++] = &g_static_layer;
+
+    /* PERIPHERALS: right column, row 2 — the arithmetic of draw_static_panels */
+    uint32_t row2_y = L->margin + panel_height(L, 2) + L->panel_gap
+                    + panel_height(L, 3) + L->panel_gap;
+    if (fb_surface_create_overlay(&g_toast_layer, (int32_t)L->right_x, (int32_t)row2_y,
+                                  L->col_w, panel_height(L, 4))) {
+        g_layers[g_layer_count++] = &g_toast_layer;
+        *toasts = &g_toast_layer;
+    }
+    return &g_static_layer.fb;
+}
+
+/* Put the finished layers on screen — once, at boot */
+static void static_layers_compose(framebuffer_t *fb)
+{
+    fb_composite(fb, g_layers, g_layer_count, 0, 0, fb->width, fb->height);
+}
+
+
+/* =============================================================================
+ * FIRST FRAME
+ * =============================================================================
+ *
+ * Split in two so kernel_main() can clear while the boot queries run on a
+ * worker, and so host/src/host_main.c draws its scenes through exactly
+ * this sequence.
+ *
+ * Copy-forward keeps the back buffer identical to the screen after every
+ * present, so the static panels are drawn exactly once and the render
+ * loop only redraws what changed — on both buffers. They are drawn into
+ * the static layer (see LAYERS), which then goes on screen with the toast
+ * overlay on top; the dynamic panels restore their backgrounds from it
+ * every tick.
+ */
+
+/*
+ * Start recording the dynamic panels. Without frame arenas (or with this
+ * frame's full) the list gets no storage and draws immediately — correct,
+ * just every tile every frame.
+ */
+static void dyn_dl_begin(framebuffer_t *fb)
+{
+    ui_dl_set_arena(&dyn_dl, frame_alloc(DYN_DL_BYTES), DYN_DL_BYTES);
+    ui_dl_begin(&dyn_dl, fb);
+}
+
+/* Set up the layers and clear; returns where the static panels go */
+static framebuffer_t *first_frame_begin(framebuffer_t *fb, const layout_t *L,
+                                        const ui_theme_t *theme, fb_surface_t **toasts)
+{
+    fb_set_copy_forward(fb, true);
+    framebuffer_t *base = static_layers_init(fb, L, toasts);
+    fb_clear(base, theme->colors.bg_primary);
+    return base;
+}
+
+/* All panels, composed and presented — needs the boot queries' answers */
+static void first_frame_finish(framebuffer_t *fb, framebuffer_t *base, fb_surface_t *toasts,
+                               const layout_t *L, const ui_theme_t *theme,
+                               const static_state_t *s, const dynamic_state_t *d)
+{
+    draw_static_panels(base, L, theme, s, toasts);
+    static_layers_compose(fb);
+    ui_dl_init(&dyn_dl, NULL, 0);
+    dyn_dl_begin(fb);
+    draw_dynamic_panels(fb, L, theme, s, d);
+    ui_dl_end(&dyn_dl);
+    fb_present(fb);
 }
 
 
@@ -1139,12 +1519,23 @@ static void draw_dynamic_panels(framebuffer_t *fb,
  */
 void kernel_main(framebuffer_t *boot_fb)
 {
-    /* Heap allocator — uses __ram_base/__ram_size globals */
-    allocator_init_from_ram(&alloc,
-                            (uintptr_t)__ram_base,
-                            (size_t)__ram_size,
-                            (uintptr_t)&__heap_start,
-                            NULL, NULL, NULL, NULL);
+    /* Boot timeline: the entry.S sample, then this point (boottime.h) */
+    boottime_init();
+
+    /* Cache geometry and the range-vs-whole threshold (hal_cache.h) */
+    hal_cache_init();
+
+    /*
+     * Heap allocator — uses __ram_base/__ram_size globals. heap_init()
+     * sets up g_allocator, the instance behind heap_alloc()/heap_free(),
+     * and the frame arenas are carved from it. The coherent DMA pool is
+     * the linker's non-cacheable .dma_coherent region; from here on,
+     * mailbox messages are staged through it.
+     */
+    heap_init((uintptr_t)__ram_base, (size_t)__ram_size);
+    frame_arena_init(FRAME_ARENA_SIZE);
+    dma_pool_init();
+    boottime_mark("heap");
 
     /* GPIO — DPI pin mux on BCM2710/GPi Case; no-op on other platforms */
     hal_gpio_configure_dpi();
@@ -1161,38 +1552,117 @@ void kernel_main(framebuffer_t *boot_fb)
             while (1) { cpu_idle(); }
         }
     }
+    boottime_mark("fb_init");
+
+    /*
+     * Secondary cores become job workers (kernel/src/job.h). Platforms
+     * without SMP support report one core and this returns immediately.
+     */
+    smp_init();
+    boottime_mark("smp");
+
+    /*
+     * Timer interrupt on the boot core — from here on, waiting is
+     * sleeping. Without one, cpu_idle() polls and nothing else changes.
+     */
+    hal_timer_events_init();
+
+    /* Cycle counter for the profiling zones, calibrated against the timer */
+    prof_init();
 
     /* Theme + layout — fully resolution-independent from here */
     ui_theme_t theme = ui_theme_for_width(fb.width, UI_PALETTE_DARK);
     layout_t   L     = compute_layout(fb.width, fb.height);
 
-    /* Collect all one-time HAL data */
-    static_state_t s;
-    static_state_init(&s, fb.width);
+    /*
+     * One-time HAL data and the first poll, on a worker (see BOOT-TIME
+     * QUERIES). With one core, job_wait() below simply runs it inline.
+     */
+    static_state_t  s;
+    dynamic_state_t d;
+    boot_query_t    q  = { &s, &d, fb.width };
+    job_counter_t   qc = {0};
+    job_submit(&qc, boot_query_job, &q, 0);
 
-    /* First frame: full clear + all static panels */
-    fb_clear(&fb, theme.colors.bg_primary);
-    draw_static_panels(&fb, &L, &theme, &s);
+    /* First frame (see FIRST FRAME): full clear, overlapping the queries */
+    fb_surface_t  *toasts;
+    framebuffer_t *base = first_frame_begin(&fb, &L, &theme, &toasts);
+    boottime_mark("clear");
 
-    /* Prime dynamic panels with first poll for First Buffer */
-    fb_clear(&fb, theme.colors.bg_primary);
-    draw_static_panels(&fb, &L, &theme, &s);
-    dynamic_state_t d;
-    dynamic_state_poll(&d);
-    draw_dynamic_panels(&fb, &L, &theme, &s, &d);
-    fb_present(&fb);
+    /* ... then all panels */
+    job_wait(&qc);
+    first_frame_finish(&fb, base, toasts, &L, &theme, &s, &d);
+    boottime_mark("first_frame");
 
-    /* Second buffer — now the NEW back buffer also needs static content */
-    fb_clear(&fb, theme.colors.bg_primary);
-    draw_static_panels(&fb, &L, &theme, &s);
-    draw_dynamic_panels(&fb, &L, &theme, &s, &d);
-    fb_present(&fb);
+    /* Everything the first frame could do without (hal_platform.h) */
+    hal_platform_late_init();
+    boottime_mark("late_init");
+    boottime_report();
 
-    /* Render loop — only dynamic panels redrawn per tick */
+    /*
+     * Render loop — dynamic panels re-recorded, changed tiles redrawn. The
+     * event is periodic, so the cadence holds no matter how long a frame
+     * took to draw. Presents are asynchronous: the HAL polling runs while
+     * the previous flip waits for vsync, and fb_wait_flip() only has to
+     * wait before we touch the framebuffer again.
+     *
+     * Each stage is a profiling zone; the overlay shows the last frame's
+     * and every PROF_DUMP_FRAMES updates the history goes out the UART.
+     */
+    /*
+     * The governor (governor.h) holds the update rate while keeping the
+     * ARM clock as low as that allows, and backs the clock off before the
+     * board reaches its soft temperature limit. It restarts the tick if
+     * the rate has to change; everything else in the loop is unaware.
+     */
+    gov_config_t gov = {
+        .policy     = GOV_POLICY_TARGET_FPS,
+        .target_fps = 1000 / UPDATE_INTERVAL_MS,
+    };
+    gov_init(&gov);
+
+    hal_timer_event_start(&g_update_event, UPDATE_INTERVAL_MS * 1000,
+                          UPDATE_INTERVAL_MS * 1000, update_tick, NULL);
     while (1) {
-        delay_ms(UPDATE_INTERVAL_MS);
-        dynamic_state_poll(&d);
+        cpu_idle_wait(&g_update_due);
+        uint64_t t_start = hal_timer_get_ticks();
+        prof_frame_begin();
+
+        PROF_ZONE_BEGIN("poll");
+        dynamic_state_poll(&d);     /* Mailbox/I2C — overlaps the flip */
+        PROF_ZONE_END();
+
+        if (gov_update(d.temp_mc, d.have_temp, d.have_throttle ? d.throttle : 0)) {
+            uint32_t us = gov_state()->interval_us;
+            hal_timer_event_start(&g_update_event, us, us, update_tick, NULL);
+        }
+
+        uint64_t t_wait = hal_timer_get_ticks();
+        PROF_ZONE_BEGIN("wait");
+        fb_wait_flip(&fb);
+        PROF_ZONE_END();
+        t_wait = hal_timer_get_ticks() - t_wait;
+
+        PROF_ZONE_BEGIN("record");
+        dyn_dl_begin(&fb);
         draw_dynamic_panels(&fb, &L, &theme, &s, &d);
-        fb_present(&fb);
+        draw_prof_hud(&fb, &L, &theme);
+        PROF_ZONE_END();
+
+        PROF_ZONE_BEGIN("raster");
+        ui_dl_end(&dyn_dl);
+        console_debug_flush();      /* Logging since the last frame, if attached */
+        PROF_ZONE_END();
+
+        PROF_ZONE_BEGIN("present");
+        fb_present_async(&fb);
+        PROF_ZONE_END();
+
+        gov_frame((uint32_t)(hal_timer_get_ticks() - t_start - t_wait));
+
+        prof_frame_end();
+        if (prof_frame_count() % PROF_DUMP_FRAMES == 0) {
+            prof_dump();
+        }
     }
 }
\ No newline at end of file
@@ -0,0 +1,656 @@
+/*
+ * perf.c - Hardware Performance Counters
+ * =======================================
+ *
+ * See hal_perf.h. Each architecture supplies the same five pieces:
+ * probe the PMU, say whether an event exists, claim a counter for an
+ * event, read it, and release everything. The slot table, the wrapping
+ * deltas and the region helpers on top are shared.
+ */
+
+#include "hal_perf.h"
+#include "hal.h"
+#include "hal_cpu.h"
+
+/* How a slot is read */
+enum {
+    SLOT_CYCLES,        /* The dedicated cycle counter */
+    SLOT_INSTRET,       /* RISC-V instret */
+    SLOT_EVENT,         /* A programmable counter */
+    SLOT_FIXED,         /* x86 fixed-function counter */
+    SLOT_FIRMWARE,      /* RISC-V SBI firmware counter */
+};
+
+typedef struct {
+    hal_perf_event_t event;
+    uint8_t          kind;
+    uint16_t         index;     /* Counter number within its kind */
+    uint16_t         csr;       /* RISC-V: the hpmcounter CSR to read */
+    uint64_t         mask;      /* Counter width */
+} perf_slot_t;
+
+static perf_slot_t g_slots[HAL_PERF_MAX_COUNTERS];
+static uint32_t    g_nslots;
+static bool        g_ready;
+static uint32_t    g_cpu;           /* Core whose PMU the slots describe */
+
+static const char *const k_names[HAL_PERF_EVENT_COUNT] = {
+    [HAL_PERF_CYCLES]         = "cycles",
+    [HAL_PERF_INSTRUCTIONS]   = "instructions",
+    [HAL_PERF_L1D_ACCESS]     = "l1d_access",
+    [HAL_PERF_L1D_REFILL]     = "l1d_refill",
+    [HAL_PERF_LLC_REFILL]     = "llc_refill",
+    [HAL_PERF_STALL_FRONTEND] = "stall_frontend",
+    [HAL_PERF_STALL_BACKEND]  = "stall_backend",
+    [HAL_PERF_BRANCH_MISS]    = "branch_miss",
+};
+
+#if defined(__aarch64__) && !defined(HAL_HOSTED)
+
+/* =============================================================================
+ * ARM64: PMUv3
+ * =============================================================================
+ *
+ * Common event numbers from the ARMv8 ARM (D7.10). The last-level refill
+ * is L2D_CACHE_REFILL on the A53/A72 (L2 is the last level) and
+ * LL_CACHE_MISS_RD where the core implements it — the A76 has an L3.
+ */
+
+#define ARM_EV_L1D_REFILL       0x03
+#define ARM_EV_L1D_ACCESS       0x04
+#define ARM_EV_INST_RETIRED     0x08
+#define ARM_EV_BR_MIS_PRED      0x10
+#define ARM_EV_CPU_CYCLES       0x11
+#define ARM_EV_L2D_REFILL       0x17
+#define ARM_EV_STALL_FRONTEND   0x23
+#define ARM_EV_STALL_BACKEND    0x24
+#define ARM_EV_LL_MISS_RD       0x37
+
+static uint32_t g_arm_counters;     /* PMCR_EL0.N */
+static uint32_t g_arm_next;         /* Next free event counter */
+static uint64_t g_arm_ceid;         /* PMCEID1:PMCEID0 — events 0x00..0x3F */
+
+static bool arm_has(uint32_t ev)
+{
+    return ev < 64 && (g_arm_ceid >> ev) & 1;
+}
+
+static uint32_t arm_event(hal_perf_event_t event)
+{
+    switch (event) {
+        case HAL_PERF_CYCLES:         return ARM_EV_CPU_CYCLES;
+        case HAL_PERF_INSTRUCTIONS:   return ARM_EV_INST_RETIRED;
+        case HAL_PERF_L1D_ACCESS:     return ARM_EV_L1D_ACCESS;
+        case HAL_PERF_L1D_REFILL:     return ARM_EV_L1D_REFILL;
+        case HAL_PERF_LLC_REFILL:     return arm_has(ARM_EV_LL_MISS_RD) ? ARM_EV_LL_MISS_RD
+                                                                        : ARM_EV_L2D_REFILL;
+        case HAL_PERF_STALL_FRONTEND: return ARM_EV_STALL_FRONTEND;
+        case HAL_PERF_STALL_BACKEND:  return ARM_EV_STALL_BACKEND;
+        case HAL_PERF_BRANCH_MISS:    return ARM_EV_BR_MIS_PRED;
+        default:                      return 0xFFFF;
+    }
+}
+
+static bool arch_probe(void)
+{
+    uint64_t dfr0, pmcr, ceid0, ceid1;
+
+    /* ID_AA64DFR0_EL1.PMUVer: 0 = no PMU, 0xF = IMPLEMENTATION DEFINED */
+    __asm__ volatile("mrs %0, id_aa64dfr0_el1" : "=r"(dfr0));
+    uint32_t ver = (uint32_t)(dfr0 >> 8) & 0xF;
+    if (ver == 0 || ver == 0xF) return false;
+
+    __asm__ volatile("mrs %0, pmcr_el0" : "=r"(pmcr));
+    __asm__ volatile("mrs %0, pmceid0_el0" : "=r"(ceid0));
+    __asm__ volatile("mrs %0, pmceid1_el0" : "=r"(ceid1));
+
+    g_arm_counters = (uint32_t)(pmcr >> 11) & 0x1F;
+    g_arm_ceid     = (ceid0 & 0xFFFFFFFFu) | (ceid1 << 32);
+
+    pmcr |= 1u << 0;                            /* E: counters on */
+    __asm__ volatile("msr pmcr_el0, %0" :: "r"(pmcr));
+    __asm__ volatile("msr pmcntenset_el0, %0" :: "r"((uint64_t)1 << 31));
+    HAL_ISB();
+    return true;
+}
+
+static bool arch_supported(hal_perf_event_t event)
+{
+    if (event == HAL_PERF_CYCLES) return true;      /* PMCCNTR_EL0 */
+    return g_arm_counters > 0 && arm_has(arm_event(event));
+}
+
+static void arch_release(void)
+{
+    /* Event counters off; the cycle counter stays on for prof.c */
+    uint64_t all = ((uint64_t)1 << g_arm_counters) - 1;
+    __asm__ volatile("msr pmcntenclr_el0, %0" :: "r"(all));
+    g_arm_next = 0;
+}
+
+static bool arch_claim(perf_slot_t *s)
+{
+    if (s->event == HAL_PERF_CYCLES) {
+        s->kind = SLOT_CYCLES;
+        s->mask = ~(uint64_t)0;
+        return true;
+    }
+    if (g_arm_next >= g_arm_counters) return false;
+
+    /* PMEVTYPER filter bits 0: count EL0 and EL1, not EL2 */
+    s->kind  = SLOT_EVENT;
+    s->index = (uint16_t)g_arm_next++;
+    s->mask  = 0xFFFFFFFFu;
+    __asm__ volatile("msr pmselr_el0, %0" :: "r"((uint64_t)s->index));
+    HAL_ISB();
+    __asm__ volatile("msr pmxevtyper_el0, %0" :: "r"((uint64_t)arm_event(s->event)));
+    __asm__ volatile("msr pmcntenset_el0, %0" :: "r"((uint64_t)1 << s->index));
+    return true;
+}
+
+static void arch_enable(void)
+{
+    HAL_ISB();
+}
+
+static uint64_t arch_read(const perf_slot_t *s)
+{
+    uint64_t v;
+
+    if (s->kind == SLOT_CYCLES) {
+        __asm__ volatile("mrs %0, pmccntr_el0" : "=r"(v));
+        return v;
+    }
+
+    /* PMSELR_EL0 is shared state: nothing may reselect in between */
+    hal_irq_flags_t f = hal_irq_save();
+    __asm__ volatile("msr pmselr_el0, %0" :: "r"((uint64_t)s->index));
+    HAL_ISB();
+    __asm__ volatile("mrs %0, pmxevcntr_el0" : "=r"(v));
+    hal_irq_restore(f);
+    return v;
+}
+
+#elif defined(__riscv) && !defined(HAL_HOSTED)
+
+/* =============================================================================
+ * RISC-V: BASE COUNTERS + SBI PMU
+ * =============================================================================
+ *
+ * SBI PMU extension (EID 0x504D55 "PMU"): OpenSBI picks a hardware
+ * counter that can count the event, programs its mhpmevent, and starts
+ * it; counter_get_info says which CSR it is and how wide. Event codes are
+ * the SBI spec's: type 0 hardware general events, type 1 cache events
+ * encoded as (cache << 3) | (op << 1) | result.
+ */
+
+#define SBI_EXT_BASE            0x10
+#define SBI_BASE_PROBE_EXT      3
+#define SBI_EXT_PMU             0x504D55
+#define SBI_PMU_NUM_COUNTERS    0
+#define SBI_PMU_COUNTER_INFO    1
+#define SBI_PMU_CFG_MATCH       2
+#define SBI_PMU_COUNTER_STOP    4
+#define SBI_PMU_FW_READ         5
+
+#define SBI_PMU_CFG_CLEAR       (1u << 1)
+#define SBI_PMU_CFG_AUTO_START  (1u << 2)
+#define SBI_PMU_STOP_RESET      (1u << 0)
+
+#define SBI_PMU_HW(code)        (code)
+#define SBI_PMU_CACHE(c, op, r) ((1u << 16) | ((c) << 3) | ((op) << 1) | (r))
+#define SBI_CACHE_L1D           0
+#define SBI_CACHE_LL            2
+#define SBI_OP_READ             0
+#define SBI_RESULT_ACCESS       0
+#define SBI_RESULT_MISS         1
+
+typedef struct {
+    long error;
+    long value;
+} sbi_ret_t;
+
+static sbi_ret_t sbi_call(long eid, long fid, long arg0, long arg1,
+                          long arg2, long arg3)
+{
+    register long a0 __asm__("a0") = arg0;
+    register long a1 __asm__("a1") = arg1;
+    register long a2 __asm__("a2") = arg2;
+    register long a3 __asm__("a3") = arg3;
+    register long a4 __asm__("a4") = 0;
+    register long a6 __asm__("a6") = fid;
+    register long a7 __asm__("a7") = eid;
+    __asm__ volatile("ecall"
+                     : "+r"(a0), "+r"(a1)
+                     : "r"(a2), "r"(a3), "r"(a4), "r"(a6), "r"(a7)
+                     : "memory");
+    return (sbi_ret_t){ a0, a1 };
+}
+
+static uint32_t g_rv_counters;      /* Counters the firmware manages */
+static uint64_t g_rv_used;          /* Claimed by the current configuration */
+static uint32_t g_rv_supported;     /* hal_perf_event_t bitmask, probed at init */
+
+static uint32_t rv_event(hal_perf_event_t event)
+{
+    switch (event) {
+        case HAL_PERF_L1D_ACCESS:
+            return SBI_PMU_CACHE(SBI_CACHE_L1D, SBI_OP_READ, SBI_RESULT_ACCESS);
+        case HAL_PERF_L1D_REFILL:
+            return SBI_PMU_CACHE(SBI_CACHE_L1D, SBI_OP_READ, SBI_RESULT_MISS);
+        case HAL_PERF_LLC_REFILL:
+            return SBI_PMU_CACHE(SBI_CACHE_LL, SBI_OP_READ, SBI_RESULT_MISS);
+        case HAL_PERF_STALL_FRONTEND: return SBI_PMU_HW(8);
+        case HAL_PERF_STALL_BACKEND:  return SBI_PMU_HW(9);
+        case HAL_PERF_BRANCH_MISS:    return SBI_PMU_HW(6);
+        default:                      return 0;
+    }
+}
+
+static uint64_t rv_free_mask(void)
+{
+    uint64_t all = g_rv_counters >= 64 ? ~(uint64_t)0
+                                       : ((uint64_t)1 << g_rv_counters) - 1;
+    return all & ~g_rv_used;
+}
+
+/* Ask the firmware for a counter; its index, or -1 */
+static long rv_match(uint32_t code, uint32_t flags)
+{
+    sbi_ret_t r = sbi_call(SBI_EXT_PMU, SBI_PMU_CFG_MATCH, 0, (long)rv_free_mask(),
+                           flags, code);
+    return r.error ? -1 : r.value;
+}
+
+static void rv_stop(long idx)
+{
+    sbi_call(SBI_EXT_PMU, SBI_PMU_COUNTER_STOP, idx, 1, SBI_PMU_STOP_RESET, 0);
+}
+
+static bool arch_probe(void)
+{
+    if (sbi_call(SBI_EXT_BASE, SBI_BASE_PROBE_EXT, SBI_EXT_PMU, 0, 0, 0).value == 0) {
+        return false;
+    }
+
+    sbi_ret_t n = sbi_call(SBI_EXT_PMU, SBI_PMU_NUM_COUNTERS, 0, 0, 0, 0);
+    g_rv_counters = n.error ? 0 : (uint32_t)n.value;
+
+    /* The firmware knows what the platform counts; ask once per event */
+    g_rv_supported = (1u << HAL_PERF_CYCLES) | (1u << HAL_PERF_INSTRUCTIONS);
+    for (uint32_t e = 0; e < HAL_PERF_EVENT_COUNT; e++) {
+        uint32_t code = rv_event((hal_perf_event_t)e);
+        if (code == 0 || g_rv_counters == 0) continue;
+
+        long idx = rv_match(code, 0);
+        if (idx >= 0) {
+            g_rv_supported |= 1u << e;
+            rv_stop(idx);
+        }
+    }
+    return true;
+}
+
+static bool arch_supported(hal_perf_event_t event)
+{
+    return (g_rv_supported >> event) & 1;
+}
+
+static void arch_release(void)
+{
+    for (long i = 0; i < 64; i++) {
+        if ((g_rv_used >> i) & 1) rv_stop(i);
+    }
+    g_rv_used = 0;
+}
+
+static bool arch_claim(perf_slot_t *s)
+{
+    s->mask = ~(uint64_t)0;
+    if (s->event == HAL_PERF_CYCLES) {
+        s->kind = SLOT_CYCLES;
+        return true;
+    }
+    if (s->event == HAL_PERF_INSTRUCTIONS) {
+        s->kind = SLOT_INSTRET;
+        return true;
+    }
+
+    long idx = rv_match(rv_event(s->event), SBI_PMU_CFG_CLEAR | SBI_PMU_CFG_AUTO_START);
+    if (idx < 0 || idx >= 64) return false;
+    g_rv_used |= (uint64_t)1 << idx;
+
+    /* info: [11:0] CSR, [17:12] width - 1, MSB set = firmware counter */
+    sbi_ret_t info = sbi_call(SBI_EXT_PMU, SBI_PMU_COUNTER_INFO, idx, 0, 0, 0);
+    if (info.error) return false;
+
+    uint32_t bits = (uint32_t)((unsigned long)info.value >> 12 & 0x3F) + 1;
+    s->index = (uint16_t)idx;
+    if (info.value < 0) {
+        s->kind = SLOT_FIRMWARE;
+    } else {
+        s->kind = SLOT_EVENT;
+        s->csr  = (uint16_t)(info.value & 0xFFF);
+        s->mask = bits >= 64 ? ~(uint64_t)0 : ((uint64_t)1 << bits) - 1;
+    }
+    return true;
+}
+
+static void arch_enable(void)
+{
+}
+
+/* csrr needs the CSR number as an immediate: one case per hpmcounter */
+#define RV_CSR_CASE(n)  case 0xC00 + (n): __asm__ volatile("csrr %0, %1" : "=r"(v) : "i"(0xC00 + (n))); break
+#define RV_CSR_CASE4(n) RV_CSR_CASE(n); RV_CSR_CASE(n + 1); RV_CSR_CASE(n + 2); RV_CSR_CASE(n + 3)
+
+static uint64_t arch_read(const perf_slot_t *s)
+{
+    uint64_t v = 0;
+
+    switch (s->kind) {
+        case SLOT_CYCLES:
+            __asm__ volatile("rdcycle %0" : "=r"(v));
+            return v;
+        case SLOT_INSTRET:
+            __asm__ volatile("rdinstret %0" : "=r"(v));
+            return v;
+        case SLOT_FIRMWARE:
+            return (uint64_t)sbi_call(SBI_EXT_PMU, SBI_PMU_FW_READ, s->index, 0, 0, 0).value;
+        default:
+            break;
+    }
+
+    switch (s->csr) {
+        RV_CSR_CASE4(0);  RV_CSR_CASE4(4);  RV_CSR_CASE4(8);  RV_CSR_CASE4(12);
+        RV_CSR_CASE4(16); RV_CSR_CASE4(20); RV_CSR_CASE4(24); RV_CSR_CASE4(28);
+        default: break;
+    }
+    return v;
+}
+
+#elif defined(__x86_64__) && !defined(HAL_HOSTED)
+
+/* =============================================================================
+ * x86_64: ARCHITECTURAL PERFMON
+ * =============================================================================
+ *
+ * CPUID leaf 0xA describes the PMU: version, general counters and their
+ * width, fixed counters (version 2+) and which architectural events are
+ * missing (EBX, one bit per event). Counters are read with rdpmc; bit 30
+ * of the index selects the fixed ones.
+ */
+
+#define MSR_PMC0                0x0C1
+#define MSR_PERFEVTSEL0         0x186
+#define MSR_FIXED_CTR_CTRL      0x38D
+#define MSR_PERF_GLOBAL_CTRL    0x38F
+
+#define EVTSEL_USR              (1u << 16)
+#define EVTSEL_OS               (1u << 17)
+#define EVTSEL_EN               (1u << 22)
+
+typedef struct {
+    uint8_t evsel;
+    uint8_t umask;
+    int8_t  arch_bit;       /* CPUID.0xA:EBX bit, -1 = not architectural */
+    int8_t  fixed;          /* Fixed counter, -1 = none */
+} x86_event_t;
+
+static const x86_event_t k_x86_events[HAL_PERF_EVENT_COUNT] = {
+    [HAL_PERF_CYCLES]         = { 0x3C, 0x00,  0,  1 },
+    [HAL_PERF_INSTRUCTIONS]   = { 0xC0, 0x00,  1,  0 },
+    [HAL_PERF_L1D_ACCESS]     = { 0,    0,    -1, -1 },
+    [HAL_PERF_L1D_REFILL]     = { 0,    0,    -1, -1 },
+    [HAL_PERF_LLC_REFILL]     = { 0x2E, 0x41,  4, -1 },
+    [HAL_PERF_STALL_FRONTEND] = { 0,    0,    -1, -1 },
+    [HAL_PERF_STALL_BACKEND]  = { 0,    0,    -1, -1 },
+    [HAL_PERF_BRANCH_MISS]    = { 0xC5, 0x00,  6, -1 },
+};
+
+static uint32_t g_x86_version;
+static uint32_t g_x86_gp, g_x86_gp_bits;
+static uint32_t g_x86_fixed, g_x86_fixed_bits;
+static uint32_t g_x86_arch_len, g_x86_missing;
+static uint32_t g_x86_gp_next;
+static uint32_t g_x86_fixed_ctrl;
+static uint64_t g_x86_global;
+
+static inline void cpuid(uint32_t leaf, uint32_t *a, uint32_t *b, uint32_t *c, uint32_t *d)
+{
+    __asm__ volatile("cpuid" : "=a"(*a), "=b"(*b), "=c"(*c), "=d"(*d) : "a"(leaf), "c"(0));
+}
+
+static inline void wrmsr(uint32_t msr, uint64_t v)
+{
+    __asm__ volatile("wrmsr" :: "c"(msr), "a"((uint32_t)v), "d"((uint32_t)(v >> 32)));
+}
+
+static inline uint64_t rdpmc(uint32_t counter)
+{
+    uint32_t lo, hi;
+    __asm__ volatile("rdpmc" : "=a"(lo), "=d"(hi) : "c"(counter));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+static bool x86_arch_has(int bit)
+{
+    return bit >= 0 && (uint32_t)bit < g_x86_arch_len && !((g_x86_missing >> bit) & 1);
+}
+
+static bool arch_probe(void)
+{
+    uint32_t a, b, c, d;
+
+    cpuid(0, &a, &b, &c, &d);
+    if (a < 0xA) return false;
+
+    cpuid(0xA, &a, &b, &c, &d);
+    g_x86_version  = a & 0xFF;
+    g_x86_gp       = (a >> 8) & 0xFF;
+    g_x86_gp_bits  = (a >> 16) & 0xFF;
+    g_x86_arch_len = (a >> 24) & 0xFF;
+    g_x86_missing  = b;
+    if (g_x86_version >= 2) {
+        g_x86_fixed      = d & 0x1F;
+        g_x86_fixed_bits = (d >> 5) & 0xFF;
+    }
+    return g_x86_version > 0;
+}
+
+static bool arch_supported(hal_perf_event_t event)
+{
+    const x86_event_t *e = &k_x86_events[event];
+    if (e->fixed >= 0 && (uint32_t)e->fixed < g_x86_fixed) return true;
+    return g_x86_gp > 0 && x86_arch_has(e->arch_bit);
+}
+
+static void arch_release(void)
+{
+    if (g_x86_version >= 2) {
+        wrmsr(MSR_PERF_GLOBAL_CTRL, 0);
+        wrmsr(MSR_FIXED_CTR_CTRL, 0);
+    }
+    for (uint32_t i = 0; i < g_x86_gp_next; i++) {
+        wrmsr(MSR_PERFEVTSEL0 + i, 0);
+    }
+    g_x86_gp_next    = 0;
+    g_x86_fixed_ctrl = 0;
+    g_x86_global     = 0;
+}
+
+static uint64_t width_mask(uint32_t bits)
+{
+    return bits == 0 || bits >= 64 ? ~(uint64_t)0 : ((uint64_t)1 << bits) - 1;
+}
+
+static bool arch_claim(perf_slot_t *s)
+{
+    const x86_event_t *e = &k_x86_events[s->event];
+
+    if (e->fixed >= 0 && (uint32_t)e->fixed < g_x86_fixed) {
+        s->kind  = SLOT_FIXED;
+        s->index = (uint16_t)e->fixed;
+        s->mask  = width_mask(g_x86_fixed_bits);
+        g_x86_fixed_ctrl |= 0x3u << (4 * e->fixed);     /* OS + USR */
+        g_x86_global     |= (uint64_t)1 << (32 + e->fixed);
+        return true;
+    }
+    if (g_x86_gp_next >= g_x86_gp) return false;
+
+    s->kind  = SLOT_EVENT;
+    s->index = (uint16_t)g_x86_gp_next++;
+    s->mask  = width_mask(g_x86_gp_bits);
+    wrmsr(MSR_PMC0 + s->index, 0);
+    wrmsr(MSR_PERFEVTSEL0 + s->index,
+          e->evsel | ((uint32_t)e->umask << 8) | EVTSEL_USR | EVTSEL_OS | EVTSEL_EN);
+    g_x86_global |= (uint64_t)1 << s->index;
+    return true;
+}
+
+static void arch_enable(void)
+{
+    if (g_x86_version >= 2) {
+        wrmsr(MSR_FIXED_CTR_CTRL, g_x86_fixed_ctrl);
+        wrmsr(MSR_PERF_GLOBAL_CTRL, g_x86_global);
+    }
+}
+
+static uint64_t arch_read(const perf_slot_t *s)
+{
+    return rdpmc(s->kind == SLOT_FIXED ? (1u << 30) | s->index : s->index);
+}
+
+#else
+
+/* =============================================================================
+ * NO PMU (ARM32, hosted builds)
+ * =============================================================================
+ */
+
+static bool arch_probe(void)                          { return false; }
+static bool arch_supported(hal_perf_event_t event)    { (void)event; return false; }
+static void arch_release(void)                        { }
+static bool arch_claim(perf_slot_t *s)                { (void)s; return false; }
+static void arch_enable(void)                         { }
+static uint64_t arch_read(const perf_slot_t *s)       { (void)s; return 0; }
+
+#endif
+
+/* =============================================================================
+ * CONFIGURATION
+ * =============================================================================
+ */
+
+hal_error_t hal_perf_init(void)
+{
+    if (!g_ready) {
+        g_ready = arch_probe();
+        g_cpu   = hal_cpu_id();
+    }
+    return g_ready ? HAL_SUCCESS : HAL_ERROR_NOT_SUPPORTED;
+}
+
+bool hal_perf_supported(hal_perf_event_t event)
+{
+    return g_ready && event < HAL_PERF_EVENT_COUNT && arch_supported(event);
+}
+
+hal_error_t hal_perf_configure(const hal_perf_event_t *events, uint32_t count)
+{
+    if (!g_ready) return HAL_ERROR_NOT_SUPPORTED;
+    if (events == NULL && count > 0) return HAL_ERROR_NULL_PTR;
+    if (count > HAL_PERF_MAX_COUNTERS) return HAL_ERROR_INVALID_ARG;
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (!hal_perf_supported(events[i])) return HAL_ERROR_NOT_SUPPORTED;
+    }
+
+    arch_release();
+    g_nslots = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        perf_slot_t *s = &g_slots[i];
+        *s = (perf_slot_t){ .event = events[i] };
+        if (!arch_claim(s)) {
+            arch_release();
+            g_nslots = 0;
+            return HAL_ERROR_INVALID_ARG;
+        }
+        g_nslots++;
+    }
+    arch_enable();
+    g_cpu = hal_cpu_id();
+    return HAL_SUCCESS;
+}
+
+uint32_t hal_perf_configure_default(void)
+{
+    static const hal_perf_event_t wanted[] = {
+        HAL_PERF_CYCLES,
+        HAL_PERF_INSTRUCTIONS,
+        HAL_PERF_L1D_REFILL,
+        HAL_PERF_LLC_REFILL,
+        HAL_PERF_STALL_BACKEND,
+        HAL_PERF_BRANCH_MISS,
+    };
+    hal_perf_event_t events[HAL_PERF_MAX_COUNTERS];
+    uint32_t n = 0;
+
+    for (uint32_t i = 0; i < ARRAY_SIZE(wanted) && n < HAL_PERF_MAX_COUNTERS; i++) {
+        if (hal_perf_supported(wanted[i])) events[n++] = wanted[i];
+    }
+
+    /* Fewer counters than events: drop from the end until it fits */
+    while (n > 0 && hal_perf_configure(events, n) != HAL_SUCCESS) n--;
+    return n;
+}
+
+uint32_t hal_perf_count(void)
+{
+    return g_nslots;
+}
+
+hal_perf_event_t hal_perf_event(uint32_t slot)
+{
+    return slot < g_nslots ? g_slots[slot].event : HAL_PERF_EVENT_COUNT;
+}
+
+const char *hal_perf_event_name(hal_perf_event_t event)
+{
+    return event < HAL_PERF_EVENT_COUNT ? k_names[event] : "?";
+}
+
+/* =============================================================================
+ * READING
+ * =============================================================================
+ */
+
+void hal_perf_read(hal_perf_counts_t *out)
+{
+    bool mine = g_ready && hal_cpu_id() == g_cpu;
+
+    for (uint32_t i = 0; i < HAL_PERF_MAX_COUNTERS; i++) {
+        out->count[i] = (mine && i < g_nslots) ? arch_read(&g_slots[i]) : 0;
+    }
+}
+
+void hal_perf_delta(const hal_perf_counts_t *start, const hal_perf_counts_t *end,
+                    uint64_t *delta)
+{
+    for (uint32_t i = 0; i < HAL_PERF_MAX_COUNTERS; i++) {
+        uint64_t mask = i < g_nslots ? g_slots[i].mask : ~(uint64_t)0;
+        delta[i] = (end->count[i] - start->count[i]) & mask;
+    }
+}
+
+void hal_perf_start(hal_perf_region_t *r)
+{
+    hal_perf_read(&r->start);
+}
+
+void hal_perf_stop(hal_perf_region_t *r)
+{
+    hal_perf_counts_t end;
+    hal_perf_read(&end);
+    hal_perf_delta(&r->start, &end, r->count);
+}
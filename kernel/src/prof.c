@@ -0,0 +1,231 @@
+/*
+ * prof.c - Cycle-Counting Profiling Zones
+ * ========================================
+ *
+ * See prof.h. Everything here runs on the boot core only, so there is no
+ * locking: prof_zone_add() from any other core returns straight away.
+ */
+
+#include "prof.h"
+#include "hal.h"
+#include "hal_cpu.h"
+
+#define PROF_CALIBRATE_US   2000
+
+static prof_zone_t  *g_zones[PROF_MAX_ZONES];
+static uint32_t      g_zone_count;
+
+static prof_frame_t  g_ring[PROF_HISTORY];
+static uint32_t      g_frames;          /* Committed so far */
+static uint64_t      g_frame_t0;
+static uint32_t      g_cycles_per_us;
+
+/* Per-zone hardware events of the last committed frame */
+static uint64_t      g_last_perf[PROF_MAX_ZONES][HAL_PERF_MAX_COUNTERS];
+
+/* =============================================================================
+ * CALIBRATION
+ * =============================================================================
+ */
+
+static void counter_enable(void)
+{
+#if defined(__aarch64__)
+    uint64_t pmcr;
+    __asm__ volatile("mrs %0, pmcr_el0" : "=r"(pmcr));
+    pmcr |= (1u << 0) | (1u << 2);          /* E: enable, C: reset PMCCNTR */
+    pmcr &= ~(uint64_t)(1u << 3);           /* D: count every cycle, not /64 */
+    __asm__ volatile("msr pmcr_el0, %0" :: "r"(pmcr));
+    __asm__ volatile("msr pmcntenset_el0, %0" :: "r"((uint64_t)1 << 31));
+    HAL_ISB();
+#endif
+}
+
+void prof_init(void)
+{
+    counter_enable();
+
+    uint64_t t0 = hal_timer_get_ticks();
+    uint64_t c0 = prof_cycles();
+    while (hal_timer_get_ticks() - t0 < PROF_CALIBRATE_US) {
+        HAL_NOP();
+    }
+    uint64_t c1 = prof_cycles();
+    uint64_t t1 = hal_timer_get_ticks();
+
+    g_cycles_per_us = (uint32_t)((c1 - c0) / (t1 - t0));
+
+#if PROF_PERF
+    if (hal_perf_init() == HAL_SUCCESS) {
+        hal_perf_configure_default();
+    }
+#endif
+}
+
+uint32_t prof_cycles_per_us(void)
+{
+    return g_cycles_per_us;
+}
+
+static uint32_t cycles_to_us(uint64_t cycles)
+{
+    if (g_cycles_per_us == 0) return 0;
+    uint64_t us = cycles / g_cycles_per_us;
+    return us > 0xFFFFFFFFu ? 0xFFFFFFFFu : (uint32_t)us;
+}
+
+/* =============================================================================
+ * ZONES AND FRAMES
+ * =============================================================================
+ */
+
+void prof_zone_add(prof_zone_t *z, uint64_t cycles)
+{
+    if (hal_cpu_id() != 0) return;
+
+    if (z->slot == 0) {
+        if (g_zone_count == PROF_MAX_ZONES) return;
+        g_zones[g_zone_count++] = z;
+        z->slot = (uint8_t)g_zone_count;
+    }
+    z->cycles += cycles;
+    z->calls++;
+}
+
+void prof_zone_add_perf(prof_zone_t *z, uint64_t cycles, const hal_perf_counts_t *start)
+{
+    if (hal_cpu_id() != 0) return;
+
+    hal_perf_counts_t end;
+    uint64_t          delta[HAL_PERF_MAX_COUNTERS];
+
+    hal_perf_read(&end);
+    hal_perf_delta(start, &end, delta);
+    for (uint32_t i = 0; i < HAL_PERF_MAX_COUNTERS; i++) {
+        z->perf[i] += delta[i];
+    }
+    prof_zone_add(z, cycles);
+}
+
+void prof_frame_begin(void)
+{
+    g_frame_t0 = prof_cycles();
+}
+
+void prof_frame_end(void)
+{
+    prof_frame_t *f = &g_ring[g_frames % PROF_HISTORY];
+
+    f->frame_us = cycles_to_us(prof_cycles() - g_frame_t0);
+    for (uint32_t i = 0; i < PROF_MAX_ZONES; i++) {
+        prof_zone_t *z = i < g_zone_count ? g_zones[i] : NULL;
+
+        f->zone_us[i]    = z ? cycles_to_us(z->cycles) : 0;
+        f->zone_calls[i] = z ? (uint16_t)z->calls : 0;
+        if (z) {
+            for (uint32_t e = 0; e < HAL_PERF_MAX_COUNTERS; e++) {
+                g_last_perf[i][e] = z->perf[e];
+                z->perf[e] = 0;
+            }
+            z->cycles = 0;
+            z->calls  = 0;
+        }
+    }
+    g_frames++;
+}
+
+uint32_t prof_frame_count(void)
+{
+    return g_frames;
+}
+
+const prof_frame_t *prof_last_frame(void)
+{
+    return g_frames ? &g_ring[(g_frames - 1) % PROF_HISTORY] : NULL;
+}
+
+uint32_t prof_zone_count(void)
+{
+    return g_zone_count;
+}
+
+const char *prof_zone_name(uint32_t index)
+{
+    return index < g_zone_count ? g_zones[index]->name : "";
+}
+
+const uint64_t *prof_zone_perf(uint32_t index)
+{
+    return index < g_zone_count ? g_last_perf[index] : NULL;
+}
+
+/* =============================================================================
+ * UART DUMP
+ * =============================================================================
+ */
+
+static void put_dec(uint64_t v)
+{
+    char buf[21];
+    int  i = 20;
+
+    buf[i] = '\0';
+    do {
+        buf[--i] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    hal_debug_puts(&buf[i]);
+}
+
+static void put_us(const char *label, uint32_t us)
+{
+    hal_debug_puts(label);
+    put_dec(us);
+    hal_debug_puts("us");
+}
+
+void prof_dump(void)
+{
+    const prof_frame_t *last = prof_last_frame();
+    if (last == NULL) return;
+
+    uint32_t n = g_frames < PROF_HISTORY ? g_frames : PROF_HISTORY;
+
+    hal_debug_puts("[prof] frame ");
+    put_dec(g_frames);
+    put_us(": ", last->frame_us);
+    hal_debug_puts(" (");
+    put_dec(g_cycles_per_us);
+    hal_debug_puts(" cycles/us)\n");
+
+    for (uint32_t z = 0; z < g_zone_count; z++) {
+        uint64_t sum = 0;
+        uint32_t max = 0;
+
+        for (uint32_t i = 0; i < n; i++) {
+            uint32_t us = g_ring[i].zone_us[z];
+            sum += us;
+            if (us > max) max = us;
+        }
+
+        hal_debug_puts("[prof]   ");
+        hal_debug_puts(g_zones[z]->name);
+        put_us(" last ", last->zone_us[z]);
+        hal_debug_puts(" x");
+        put_dec(last->zone_calls[z]);
+        put_us("  avg ", (uint32_t)(sum / n));
+        put_us("  max ", max);
+        hal_debug_puts("\n");
+
+        if (PROF_PERF && hal_perf_count() > 0) {
+            hal_debug_puts("[prof]     ");
+            for (uint32_t e = 0; e < hal_perf_count(); e++) {
+                hal_debug_puts(hal_perf_event_name(hal_perf_event(e)));
+                hal_debug_puts("=");
+                put_dec(g_last_perf[z][e]);
+                hal_debug_puts(" ");
+            }
+            hal_debug_puts("\n");
+        }
+    }
+}
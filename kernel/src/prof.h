@@ -0,0 +1,202 @@
+/*
+ * prof.h - Cycle-Counting Profiling Zones
+ * ========================================
+ *
+ * hal_timer_get_ticks() counts microseconds — fine for a frame, useless
+ * for a 3 µs mailbox copy or a surprise cache walk. This module times
+ * code with the CPU's own cycle counter and keeps the results per frame:
+ *
+ *   prof_frame_begin();
+ *
+ *   PROF_ZONE_BEGIN("poll");
+ *   dynamic_state_poll(&d);
+ *   PROF_ZONE_END();
+ *
+ *   prof_frame_end();          // zone totals → history ring, reset
+ *
+ * A zone is a static prof_zone_t declared by PROF_ZONE_BEGIN and
+ * registered the first time it runs, so instrumenting a function costs
+ * two counter reads and an add — no table to edit. Entering the same zone
+ * several times in a frame accumulates: "flush" is the sum of every
+ * flush, "calls" how many there were.
+ *
+ * Each finished frame's totals, converted to microseconds, go into a
+ * static ring of PROF_HISTORY frames. kernel_main draws the last one as
+ * an overlay; prof_dump() prints last / average / max over the ring on
+ * the debug UART.
+ *
+ * CYCLE COUNTERS:
+ * ---------------
+ *   ARM64:   PMCCNTR_EL0, enabled by prof_init() (PMCR_EL0.E, PMCNTENSET
+ *            bit 31). entry.S clears MDCR_EL2.TPM so EL1 may touch it.
+ *   RISC-V:  rdcycle. The U74 allows it from S-mode once the SBI firmware
+ *            has set mcounteren.CY, which OpenSBI does.
+ *   x86_64:  rdtsc — invariant TSC, constant rate on everything we run.
+ *
+ * prof_init() calibrates cycles per microsecond against hal_timer, so the
+ * counters never need to know the CPU clock. If the clock changes later
+ * (BCM2710 throttling) the microsecond figures drift with it; the cycle
+ * counts stay exact.
+ *
+ * LIMITATIONS:
+ * ------------
+ * Zones only count on the boot core: the accumulators aren't atomic, and
+ * the cycle counters of different cores aren't synchronised anyway. A
+ * zone entered on a job worker is silently ignored.
+ *
+ * Build with -DPROF_ENABLE=0 and every macro compiles to nothing.
+ *
+ * HARDWARE COUNTERS:
+ * ------------------
+ * Build with -DPROF_PERF=1 and every zone also brackets itself with
+ * hal_perf_read() (hal_perf.h): prof_init() configures the default event
+ * set, and prof_dump() prints each zone's cache refills, stalls and
+ * mispredicts for the last frame next to its time. Off by default — a
+ * counter read on ARM64 is a select, an isb and a read per event, which
+ * is noise in a 3 µs zone.
+ */
+
+#ifndef PROF_H
+#define PROF_H
+
+#include "types.h"
+#include "hal_perf.h"
+
+#ifndef PROF_ENABLE
+#define PROF_ENABLE     1
+#endif
+
+#ifndef PROF_PERF
+#define PROF_PERF       0
+#endif
+
+#define PROF_MAX_ZONES  16      /* Registered zones; later ones are dropped */
+#define PROF_HISTORY    64      /* Frames kept in the ring */
+
+/* =============================================================================
+ * CYCLE COUNTER
+ * =============================================================================
+ */
+
+static inline uint64_t prof_cycles(void)
+{
+#if defined(__aarch64__)
+    uint64_t c;
+    __asm__ volatile("mrs %0, pmccntr_el0" : "=r"(c));
+    return c;
+#elif defined(__riscv)
+    uint64_t c;
+    __asm__ volatile("rdcycle %0" : "=r"(c));
+    return c;
+#elif defined(__x86_64__)
+    uint32_t lo, hi;
+    __asm__ volatile("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t)hi << 32) | lo;
+#else
+    return 0;
+#endif
+}
+
+/* =============================================================================
+ * ZONES
+ * =============================================================================
+ */
+
+typedef struct {
+    const char *name;
+    uint64_t    cycles;         /* Accumulated this frame */
+    uint32_t    calls;          /* Entries this frame */
+    uint8_t     slot;           /* 1 + index in the zone table, 0 = new */
+    uint64_t    perf[HAL_PERF_MAX_COUNTERS];    /* PROF_PERF: events this frame */
+} prof_zone_t;
+
+/* Add one timed run to a zone; registers it on first use */
+void prof_zone_add(prof_zone_t *z, uint64_t cycles);
+
+/* The same, plus the hardware events since start (PROF_PERF builds) */
+void prof_zone_add_perf(prof_zone_t *z, uint64_t cycles, const hal_perf_counts_t *start);
+
+#if PROF_ENABLE && PROF_PERF
+
+#define PROF_ZONE_BEGIN(zname)                                      \
+    do {                                                            \
+        static prof_zone_t prof_zone__ = { .name = (zname) };      \
+        hal_perf_counts_t prof_p0__;                                \
+        hal_perf_read(&prof_p0__);                                  \
+        uint64_t prof_t0__ = prof_cycles()
+
+#define PROF_ZONE_END()                                             \
+        prof_zone_add_perf(&prof_zone__, prof_cycles() - prof_t0__, \
+                           &prof_p0__);                             \
+    } while (0)
+
+#elif PROF_ENABLE
+
+/*
+ * BEGIN and END open and close a block, so they must pair up in the same
+ * scope — the compiler rejects a missing END.
+ */
+#define PROF_ZONE_BEGIN(zname)                                      \
+    do {                                                            \
+        static prof_zone_t prof_zone__ = { .name = (zname) };      \
+        uint64_t prof_t0__ = prof_cycles()
+
+#define PROF_ZONE_END()                                             \
+        prof_zone_add(&prof_zone__, prof_cycles() - prof_t0__);    \
+    } while (0)
+
+#else
+
+#define PROF_ZONE_BEGIN(zname)  do {
+#define PROF_ZONE_END()         } while (0)
+
+#endif /* PROF_ENABLE */
+
+/* =============================================================================
+ * FRAMES
+ * =============================================================================
+ */
+
+typedef struct {
+    uint32_t frame_us;                      /* frame_begin → frame_end */
+    uint32_t zone_us[PROF_MAX_ZONES];       /* Indexed like prof_zone_name() */
+    uint16_t zone_calls[PROF_MAX_ZONES];
+} prof_frame_t;
+
+/*
+ * Enable the cycle counter and calibrate it against hal_timer. Spins for
+ * about 2 ms; call once on the boot core after the timer is up. PROF_PERF
+ * builds also bring up hal_perf with its default events.
+ */
+void prof_init(void);
+
+/* Mark the start / end of a frame. End commits the zones to the ring. */
+void prof_frame_begin(void);
+void prof_frame_end(void);
+
+/* Frames committed so far */
+uint32_t prof_frame_count(void);
+
+/* The last committed frame, or NULL before the first */
+const prof_frame_t *prof_last_frame(void);
+
+/* Registered zones, in first-use order */
+uint32_t    prof_zone_count(void);
+const char *prof_zone_name(uint32_t index);
+
+/*
+ * PROF_PERF builds: zone index's hardware events in the last committed
+ * frame, indexed like hal_perf_event(). NULL for an unknown zone.
+ */
+const uint64_t *prof_zone_perf(uint32_t index);
+
+/* Calibrated rate; 0 if no cycle counter was found */
+uint32_t prof_cycles_per_us(void);
+
+/*
+ * Print the last frame and, per zone, the average and maximum over the
+ * ring, on the debug UART (hal_debug_puts).
+ */
+void prof_dump(void);
+
+#endif /* PROF_H */
@@ -0,0 +1,103 @@
+/*
+ * smp.c - Secondary Core Bring-Up
+ * ================================
+ *
+ * See smp.h for the bring-up sequence.
+ *
+ * STACKS:
+ * -------
+ * The boot core keeps the linker-script stack (_stack_top). Secondary
+ * cores get SMP_STACK_SIZE bytes each from smp_stacks[] below, which lives
+ * in .bss. The boot core zeroed .bss long before any secondary is released,
+ * so there's no race with the BSS clear loop.
+ */
+
+#include "smp.h"
+#include "job.h"
+#include "hal_cpu.h"
+#include "hal_platform.h"
+#include "hal_timer.h"
+#include "bitops.h"
+
+static uint8_t smp_stacks[HAL_MAX_CPUS - 1][SMP_STACK_SIZE] HAL_ALIGNED(16);
+static hal_cpu_boot_t smp_boot[HAL_MAX_CPUS];
+
+static volatile uint32_t g_online_mask = 1;     /* Boot core is always online */
+
+/* =============================================================================
+ * SINGLE-CORE DEFAULTS
+ * =============================================================================
+ *
+ * Platforms that can't (yet) start secondary cores don't have to do
+ * anything: these weak versions report one core and smp_init() is a no-op.
+ */
+
+HAL_WEAK uint32_t hal_platform_get_cpu_count(void)
+{
+    return 1;
+}
+
+HAL_WEAK hal_error_t hal_platform_start_cpu(uint32_t cpu, struct hal_cpu_boot *boot)
+{
+    (void)cpu;
+    (void)boot;
+    return HAL_ERROR_NOT_SUPPORTED;
+}
+
+/* =============================================================================
+ * SECONDARY ENTRY
+ * =============================================================================
+ *
+ * First C code on a secondary core. The trampoline has already set up the
+ * MMU, vectors and this core's stack.
+ */
+
+static HAL_NORETURN void smp_secondary_main(uint32_t cpu)
+{
+    __atomic_or_fetch(&g_online_mask, 1u << cpu, __ATOMIC_RELEASE);
+    job_worker_loop(cpu);
+}
+
+/* =============================================================================
+ * PUBLIC API
+ * =============================================================================
+ */
+
+uint32_t smp_init(void)
+{
+    job_init();
+
+    uint32_t count = hal_platform_get_cpu_count();
+    if (count > HAL_MAX_CPUS) count = HAL_MAX_CPUS;
+
+    for (uint32_t cpu = 1; cpu < count; cpu++) {
+        hal_cpu_boot_t *boot = &smp_boot[cpu];
+
+        boot->stack_top = (uintptr_t)&smp_stacks[cpu - 1][SMP_STACK_SIZE];
+        boot->entry     = smp_secondary_main;
+        boot->cpu       = cpu;
+
+        if (HAL_FAILED(hal_platform_start_cpu(cpu, boot))) {
+            continue;
+        }
+
+        uint64_t start = hal_timer_get_ms();
+        while (!(__atomic_load_n(&g_online_mask, __ATOMIC_ACQUIRE) & (1u << cpu))) {
+            if (hal_timer_get_ms() - start > SMP_START_TIMEOUT_MS) {
+                break;
+            }
+        }
+    }
+
+    return smp_cpu_count();
+}
+
+uint32_t smp_cpu_count(void)
+{
+    return bit_popcount32(smp_online_mask());
+}
+
+uint32_t smp_online_mask(void)
+{
+    return __atomic_load_n(&g_online_mask, __ATOMIC_ACQUIRE);
+}
@@ -0,0 +1,53 @@
+/*
+ * smp.h - Secondary Core Bring-Up
+ * ================================
+ *
+ * Every board we support has more than one core, but until smp_init() runs
+ * only the boot core executes kernel code. The others wait where boot code
+ * left them:
+ *
+ *   BCM2710:  In the firmware's spin-table loop (armstub8), or in our own
+ *             copy of it in boot/arm64/entry.S. Each core polls a 64-bit
+ *             release slot at 0xD8 + 8 * core.
+ *
+ *   RISC-V:   Stopped inside OpenSBI. The SBI Hart State Management (HSM)
+ *             extension's sbi_hart_start() starts a hart at an address of
+ *             our choosing, with a0 = hart ID and a1 = an opaque word.
+ *
+ * BRING-UP SEQUENCE:
+ * ------------------
+ *   1. smp_init() picks a stack for each core and fills a hal_cpu_boot_t.
+ *   2. hal_platform_start_cpu() copies the boot core's MMU state into the
+ *      block and releases the core.
+ *   3. The architecture trampoline (arm64_secondary_entry,
+ *      riscv_secondary_start) installs vectors, the MMU and the stack, then
+ *      calls smp_secondary_main(cpu).
+ *   4. The core marks itself online and becomes a job worker (job.h).
+ *
+ * Cores that don't come online within SMP_START_TIMEOUT_MS are skipped;
+ * the job system simply has fewer workers.
+ */
+
+#ifndef SMP_H
+#define SMP_H
+
+#include "types.h"
+
+#define SMP_STACK_SIZE          (16 * 1024)     /* Per secondary core */
+#define SMP_START_TIMEOUT_MS    100
+
+/*
+ * Start every secondary core the platform reports.
+ * Call once, from the boot core, after the MMU is set up.
+ *
+ * @return  Number of cores online, including the boot core
+ */
+uint32_t smp_init(void);
+
+/* Number of cores currently online (1 before smp_init()) */
+uint32_t smp_cpu_count(void);
+
+/* Bitmask of online cores, bit N = logical CPU N */
+uint32_t smp_online_mask(void);
+
+#endif /* SMP_H */
@@ -0,0 +1,285 @@
+/*
+ * timer.c - Timer Event Queue and Tickless Idle
+ * ==============================================
+ *
+ * See hal_timer.h (TIMER EVENTS) for the API and timer.h for the idle
+ * loop.
+ *
+ * The queue is a singly linked list sorted by deadline. This kernel has a
+ * handful of events at most, so an O(n) insert beats anything cleverer;
+ * the operation that matters — "what is the earliest deadline?" — is a
+ * single load of g_timer_head.
+ *
+ * Every queue operation runs with IRQs masked on the boot core. That is
+ * the whole locking story: hal_timer_irq() is the only other mutator and
+ * it can only run when IRQs are unmasked on this same core.
+ */
+
+#include "timer.h"
+#include "spinlock.h"
+
+static hal_timer_event_t *g_timer_head;
+static bool               g_timer_irq;     /* Hardware compare available */
+
+/* =============================================================================
+ * PLATFORM DEFAULTS
+ * =============================================================================
+ *
+ * SoCs without a timer interrupt don't have to do anything: with these
+ * weak hooks hal_timer_events_init() reports HAL_ERROR_NOT_SUPPORTED and
+ * cpu_idle() falls back to polling.
+ */
+
+HAL_WEAK hal_error_t hal_timer_irq_init(void)
+{
+    return HAL_ERROR_NOT_SUPPORTED;
+}
+
+HAL_WEAK void hal_timer_irq_set(uint64_t deadline_us)
+{
+    (void)deadline_us;
+}
+
+HAL_WEAK void hal_timer_irq_clear(void)
+{
+}
+
+/* =============================================================================
+ * QUEUE (IRQs masked)
+ * =============================================================================
+ */
+
+static void queue_remove(hal_timer_event_t *ev)
+{
+    if (!ev->pending) return;
+
+    for (hal_timer_event_t **pp = &g_timer_head; *pp; pp = &(*pp)->next) {
+        if (*pp == ev) {
+            *pp = ev->next;
+            break;
+        }
+    }
+    ev->next    = NULL;
+    ev->pending = false;
+}
+
+/* Equal deadlines keep insertion order, so same-period events stay FIFO */
+static void queue_insert(hal_timer_event_t *ev)
+{
+    hal_timer_event_t **pp = &g_timer_head;
+
+    while (*pp && (*pp)->deadline <= ev->deadline) {
+        pp = &(*pp)->next;
+    }
+    ev->next    = *pp;
+    ev->pending = true;
+    *pp = ev;
+}
+
+static void program_head(void)
+{
+    if (!g_timer_irq) return;
+
+    if (g_timer_head) {
+        hal_timer_irq_set(g_timer_head->deadline);
+    } else {
+        hal_timer_irq_clear();
+    }
+}
+
+/*
+ * Run every event whose deadline has passed. `now` is read once: a
+ * periodic event with a tiny period can't keep this loop alive forever.
+ */
+static void run_expired(void)
+{
+    uint64_t now = hal_timer_get_ticks();
+
+    while (g_timer_head && g_timer_head->deadline <= now) {
+        hal_timer_event_t *ev = g_timer_head;
+
+        g_timer_head = ev->next;
+        ev->next     = NULL;
+        ev->pending  = false;
+
+        if (ev->period) {
+            ev->deadline += ev->period;
+            if (ev->deadline <= now) {
+                /* Fell more than a period behind: skip, don't burst */
+                ev->deadline = now + ev->period;
+            }
+            queue_insert(ev);
+        }
+
+        /* Requeued first, so the callback may cancel or restart it */
+        ev->fn(ev->arg);
+    }
+}
+
+/* =============================================================================
+ * EVENT API
+ * =============================================================================
+ */
+
+hal_error_t hal_timer_events_init(void)
+{
+    hal_error_t err = hal_timer_irq_init();
+
+    g_timer_irq = HAL_OK(err);
+    if (g_timer_irq) {
+        program_head();
+        hal_irq_enable();
+    }
+    return err;
+}
+
+hal_error_t hal_timer_event_start(hal_timer_event_t *ev, uint32_t delay_us,
+                                  uint32_t period_us, hal_timer_fn_t fn,
+                                  void *arg)
+{
+    if (ev == NULL || fn == NULL) return HAL_ERROR_NULL_PTR;
+
+    hal_irq_flags_t f = hal_irq_save();
+
+    queue_remove(ev);
+    ev->deadline = hal_timer_get_ticks() + delay_us;
+    ev->period   = period_us;
+    ev->fn       = fn;
+    ev->arg      = arg;
+    queue_insert(ev);
+
+    if (g_timer_head == ev) {
+        program_head();
+    }
+
+    hal_irq_restore(f);
+    return HAL_SUCCESS;
+}
+
+void hal_timer_event_cancel(hal_timer_event_t *ev)
+{
+    if (ev == NULL) return;
+
+    hal_irq_flags_t f = hal_irq_save();
+    bool was_head = (g_timer_head == ev);
+
+    queue_remove(ev);
+    if (was_head) {
+        program_head();
+    }
+
+    hal_irq_restore(f);
+}
+
+uint64_t hal_timer_next_deadline(void)
+{
+    hal_timer_event_t *head = g_timer_head;
+    return head ? head->deadline : HAL_TIMER_NO_DEADLINE;
+}
+
+void hal_timer_irq(void)
+{
+    run_expired();
+    program_head();
+}
+
+/* =============================================================================
+ * TICKLESS IDLE
+ * =============================================================================
+ */
+
+/*
+ * One sleep, IRQs masked on entry and exit. With a hardware compare the
+ * wfi wakes on the pending interrupt and the caller's hal_irq_restore()
+ * takes it. Without one, spin until the head deadline and dispatch here.
+ */
+static void idle_masked(void)
+{
+    if (g_timer_irq) {
+        HAL_WFI();
+        return;
+    }
+
+    uint64_t deadline = hal_timer_next_deadline();
+    if (deadline == HAL_TIMER_NO_DEADLINE) {
+        HAL_WFI();      /* Nothing will ever be due */
+        return;
+    }
+
+    while (hal_timer_get_ticks() < deadline) {
+        spin_hint();
+    }
+    run_expired();
+}
+
+void cpu_idle(void)
+{
+    hal_irq_flags_t f = hal_irq_save();
+    idle_masked();
+    hal_irq_restore(f);
+}
+
+void cpu_idle_wait(volatile bool *flag)
+{
+    for (;;) {
+        hal_irq_flags_t f = hal_irq_save();
+        if (*flag) {
+            *flag = false;
+            hal_irq_restore(f);
+            return;
+        }
+        idle_masked();
+        hal_irq_restore(f);
+    }
+}
+
+static void sleep_done(void *arg)
+{
+    *(volatile bool *)arg = true;
+}
+
+void cpu_sleep_us(uint32_t us)
+{
+    hal_timer_event_t ev = {0};
+    volatile bool     done = false;
+
+    hal_timer_event_start(&ev, us, 0, sleep_done, (void *)&done);
+    cpu_idle_wait(&done);
+}
+
+/* =============================================================================
+ * FRAME PACING
+ * =============================================================================
+ * n × num overflows 64 bits after ~2^28 GB frames (52 days) — the clock
+ * restarts long before that on any real lag.
+ */
+
+void cpu_pacer_init(cpu_pacer_t *p, uint64_t num, uint64_t den)
+{
+    p->start = hal_timer_get_ticks();
+    p->frame = 0;
+    p->num   = num ? num : 1;
+    p->den   = den ? den : 1;
+}
+
+uint32_t cpu_pacer_wait(cpu_pacer_t *p)
+{
+    uint64_t due = p->start + (++p->frame) * p->num / p->den;
+    uint64_t now = hal_timer_get_ticks();
+
+    if (now < due) {
+        cpu_sleep_us((uint32_t)(due - now));
+        return 0;
+    }
+
+    /* Truncation can put `passed` a frame short of the one just due */
+    uint64_t passed = (now - p->start) * p->den / p->num;
+    uint64_t behind = passed > p->frame ? passed - p->frame : 0;
+    if (behind > CPU_PACER_MAX_LAG) {
+        p->start = now;
+        p->frame = 0;
+        return 0;
+    }
+    p->frame += behind;
+    return (uint32_t)behind;
+}
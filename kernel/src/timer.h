@@ -0,0 +1,96 @@
+/*
+ * timer.h - Timer Events and Tickless Idle
+ * =========================================
+ *
+ * The portable half of hal_timer.h's TIMER EVENTS API lives in timer.c:
+ * the sorted event queue, hal_timer_irq() dispatch, and the idle loop
+ * built on top of them.
+ *
+ * TICKLESS IDLE:
+ * --------------
+ * There is no periodic tick. cpu_idle() masks IRQs, then sleeps in wfi;
+ * the only thing that wakes it is the compare programmed for the earliest
+ * pending event (or some other enabled interrupt). A core with nothing to
+ * do for a second really does nothing for a second — no 1 kHz wake-ups,
+ * no spinning on the counter.
+ *
+ *   thread                      IRQ
+ *   ──────                      ───
+ *   mask IRQs
+ *   *flag set? ──yes──▶ return
+ *   wfi ........................ compare fires, core wakes
+ *   unmask ───────────────────▶ hal_timer_irq() → callback sets *flag
+ *   loop
+ *
+ * Checking the flag with IRQs masked is what closes the lost-wake-up race:
+ * an interrupt that arrives after the check stays pending, and a pending
+ * interrupt makes wfi return immediately even while masked.
+ *
+ * On a platform without timer interrupts (hal_timer_events_init() reported
+ * HAL_ERROR_NOT_SUPPORTED) the same calls still work: cpu_idle() spins on
+ * the counter until the head deadline and runs the expired events itself.
+ *
+ * All of this is for the boot core (see hal_timer.h CONTEXT).
+ */
+
+#ifndef KERNEL_TIMER_H
+#define KERNEL_TIMER_H
+
+#include "hal_timer.h"
+
+/*
+ * cpu_idle() - Sleep until the next interrupt
+ *
+ * Returns after any interrupt has been handled. With no pending events and
+ * no other interrupt source, it never returns — which is what the "halt"
+ * loops want.
+ */
+void cpu_idle(void);
+
+/*
+ * cpu_idle_wait() - Sleep until *flag is set, then clear it
+ *
+ * The flag is meant to be set by a timer event callback (or any other
+ * IRQ handler). See TICKLESS IDLE above for why this is not just
+ * `while (!*flag) cpu_idle();`.
+ */
+void cpu_idle_wait(volatile bool *flag);
+
+/*
+ * cpu_sleep_us() - Sleep for at least us microseconds
+ *
+ * A one-shot event plus cpu_idle_wait(). Use this instead of
+ * hal_delay_us() for anything longer than a few hundred microseconds.
+ */
+void cpu_sleep_us(uint32_t us);
+
+/*
+ * FRAME PACING:
+ * -------------
+ * A pacer holds a loop to a fixed rate whose period need not be a whole
+ * number of microseconds: it is num/den µs. The Game Boy's 59.73 Hz is
+ * 70224 cycles of a 4194304 Hz clock, 16742.706 µs — rounding that to
+ * 16743 would gain a frame every ten minutes of play. So each deadline is
+ * computed from the start, never by adding a rounded period to the last:
+ *
+ *   deadline(n) = start + n × num / den
+ *
+ * cpu_pacer_wait() sleeps (cpu_sleep_us) until the next deadline and
+ * returns 0. If the caller is already past it, there's no sleep and the
+ * return value says how many more deadlines have gone by: an emulator
+ * runs that many frames without presenting them and is back on time.
+ * More than CPU_PACER_MAX_LAG behind (a breakpoint, a slow SD read) the
+ * pacer gives up catching up and restarts its clock from now.
+ */
+#define CPU_PACER_MAX_LAG       8
+
+typedef struct {
+    uint64_t start;             /* hal_timer_get_ticks() at frame 0 */
+    uint64_t frame;             /* Deadlines passed */
+    uint64_t num, den;          /* Period, num/den microseconds */
+} cpu_pacer_t;
+
+void     cpu_pacer_init(cpu_pacer_t *p, uint64_t num, uint64_t den);
+uint32_t cpu_pacer_wait(cpu_pacer_t *p);
+
+#endif /* KERNEL_TIMER_H */
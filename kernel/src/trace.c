@@ -0,0 +1,122 @@
+/*
+ * trace.c - Deferred Binary Trace Log
+ * ====================================
+ *
+ * See trace.h. Each core only ever writes its own ring, so the only race
+ * left is an interrupt on the same core tracing in the middle of a
+ * record — masking IRQs for the few stores closes it.
+ */
+
+#include "trace.h"
+#include "hal.h"
+#include "hal_cpu.h"
+
+#if (TRACE_RING & (TRACE_RING - 1)) != 0
+#error "TRACE_RING must be a power of two"
+#endif
+
+typedef struct {
+    trace_rec_t rec[TRACE_RING];
+    uint32_t    head;                   /* Records written, lost ones included */
+} __attribute__((aligned(64))) trace_ring_t;
+
+static trace_ring_t g_rings[HAL_MAX_CPUS];
+
+/* =============================================================================
+ * RECORDING
+ * =============================================================================
+ */
+
+void trace_emit(const char *fmt, uintptr_t a0, uintptr_t a1, uintptr_t a2, uintptr_t a3)
+{
+    uint32_t cpu = hal_cpu_id();
+    if (cpu >= HAL_MAX_CPUS) return;
+
+    trace_ring_t   *ring = &g_rings[cpu];
+    uint64_t        ts   = hal_timer_get_ticks();
+    hal_irq_flags_t f    = hal_irq_save();
+
+    trace_rec_t *r = &ring->rec[ring->head++ & (TRACE_RING - 1)];
+    r->ts     = ts;
+    r->fmt    = (uintptr_t)fmt;
+    r->arg[0] = a0;
+    r->arg[1] = a1;
+    r->arg[2] = a2;
+    r->arg[3] = a3;
+
+    hal_irq_restore(f);
+}
+
+void trace_reset(void)
+{
+    for (uint32_t cpu = 0; cpu < HAL_MAX_CPUS; cpu++) {
+        g_rings[cpu].head = 0;
+    }
+}
+
+uint32_t trace_count(uint32_t cpu)
+{
+    return cpu < HAL_MAX_CPUS ? g_rings[cpu].head : 0;
+}
+
+/* =============================================================================
+ * DUMP
+ * =============================================================================
+ *
+ * Lines are built by hand rather than with hal_debug_printf(), which
+ * TRACE_DEBUG_PRINTF may have turned into a TRACE() itself.
+ */
+
+static char *put_hex(char *p, uint64_t v)
+{
+    static const char digits[] = "0123456789abcdef";
+    int shift = 60;
+
+    *p++ = ' ';
+    while (shift > 0 && ((v >> shift) & 0xF) == 0) shift -= 4;
+    for (; shift >= 0; shift -= 4) *p++ = digits[(v >> shift) & 0xF];
+    return p;
+}
+
+/* "<tag> v0 v1 ...\n"; 7 values of 17 chars fit easily */
+static void put_line(const char *tag, const uint64_t *v, uint32_t n)
+{
+    char  line[160];
+    char *p = line;
+
+    while (*tag) *p++ = *tag++;
+    for (uint32_t i = 0; i < n; i++) p = put_hex(p, v[i]);
+    *p++ = '\n';
+    *p   = '\0';
+    hal_debug_puts(line);
+}
+
+void trace_dump(void)
+{
+    uint64_t v[3 + TRACE_MAX_ARGS];
+
+    v[0] = 1;
+    v[1] = TRACE_RING;
+    put_line("@trace", v, 2);
+
+    for (uint32_t cpu = 0; cpu < HAL_MAX_CPUS; cpu++) {
+        const trace_ring_t *ring = &g_rings[cpu];
+        uint32_t head = ring->head;
+        if (head == 0) continue;
+
+        v[0] = cpu;
+        v[1] = head;
+        put_line("@C", v, 2);
+
+        uint32_t first = head > TRACE_RING ? head - TRACE_RING : 0;
+        for (uint32_t i = first; i != head; i++) {
+            const trace_rec_t *r = &ring->rec[i & (TRACE_RING - 1)];
+            v[0] = cpu;
+            v[1] = r->ts;
+            v[2] = r->fmt;
+            for (uint32_t a = 0; a < TRACE_MAX_ARGS; a++) v[3 + a] = r->arg[a];
+            put_line("@T", v, 3 + TRACE_MAX_ARGS);
+        }
+    }
+    hal_debug_puts("@end\n");
+}
@@ -0,0 +1,126 @@
+/*
+ * trace.h - Deferred Binary Trace Log
+ * ====================================
+ *
+ * hal_debug_printf() formats on the spot and then pushes every byte out
+ * the UART: fine for a boot message, far too heavy to leave inside
+ * fb_present() or a flush without changing the very timing you wanted to
+ * see. TRACE() takes the same arguments and does none of that work:
+ *
+ *   TRACE("present: %u dirty rows, age %u", rows, fb_buffer_age(fb));
+ *
+ * stores one fixed-size record — the format string's ADDRESS, a
+ * hal_timer_get_ticks() timestamp and the raw argument words — in the
+ * calling core's ring. Nothing is formatted on the target, ever.
+ *
+ * LATER, ON THE HOST:
+ * -------------------
+ * trace_dump() prints the rings over the debug UART as hex lines. Save
+ * the session log and hand it, with the kernel ELF, to the decoder:
+ *
+ *   python3 board/tracedump.py build/<board>/kernel.elf uart.log
+ *
+ * which looks each format address up in the ELF's .rodata and does the
+ * printf there. That is why the format must be a string literal. Records
+ * from all cores are merged by timestamp.
+ *
+ * ARGUMENTS:
+ * ----------
+ * Up to TRACE_MAX_ARGS, each stored as one machine word (uintptr_t), so
+ * the same %d %i %u %x %X %p %c as hal_debug_printf work; on 32-bit
+ * targets a 64-bit value is truncated. %s records only the pointer: the
+ * decoder prints the string if it lies in the image (a literal, a const
+ * table), and the bare address otherwise — the contents of a stack buffer
+ * are long gone by the time anyone looks.
+ *
+ * RINGS:
+ * ------
+ * One ring of TRACE_RING records per core, written only by that core, so
+ * there is no lock and no shared cache line: a record costs one timer
+ * read and six stores with IRQs masked. A full ring overwrites its
+ * oldest records; the dump says how many were lost.
+ *
+ * Build with -DTRACE_ENABLE=0 and TRACE() compiles to nothing. Build
+ * with -DTRACE_DEBUG_PRINTF=1 and every hal_debug_printf() in a file that
+ * includes this header becomes a TRACE() too.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "types.h"
+
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE        1
+#endif
+
+#ifndef TRACE_RING
+#define TRACE_RING          256     /* Records per core; power of two */
+#endif
+
+#define TRACE_MAX_ARGS      4
+
+typedef struct {
+    uint64_t    ts;                     /* hal_timer_get_ticks(), µs */
+    uint64_t    fmt;                    /* Address of the format string */
+    uint64_t    arg[TRACE_MAX_ARGS];
+} trace_rec_t;
+
+/* Append one record to the calling core's ring. Use TRACE(), not this. */
+void trace_emit(const char *fmt, uintptr_t a0, uintptr_t a1, uintptr_t a2, uintptr_t a3);
+
+#if TRACE_ENABLE
+
+/*
+ * "" fmt "" only compiles for a string literal. The argument count picks
+ * TRACE0_..TRACE4_; a fifth argument lands on TRACE_TOO_MANY_ARGS, so it
+ * fails to compile instead of being dropped.
+ */
+#define TRACE(...)                                                              \
+    TRACE_PICK_(__VA_ARGS__, TRACE_TOO_MANY_ARGS, TRACE4_, TRACE3_, TRACE2_,    \
+                TRACE1_, TRACE0_, -)(__VA_ARGS__)
+#define TRACE_PICK_(_0, _1, _2, _3, _4, _5, name, ...)  name
+
+#define TRACE_TOO_MANY_ARGS(...) \
+    _Static_assert(0, "TRACE() takes at most 4 arguments")
+
+#define TRACE_W_(x)             ((uintptr_t)(x))
+#define TRACE0_(f)              trace_emit("" f "", 0, 0, 0, 0)
+#define TRACE1_(f, a)           trace_emit("" f "", TRACE_W_(a), 0, 0, 0)
+#define TRACE2_(f, a, b)        trace_emit("" f "", TRACE_W_(a), TRACE_W_(b), 0, 0)
+#define TRACE3_(f, a, b, c)     trace_emit("" f "", TRACE_W_(a), TRACE_W_(b), \
+                                           TRACE_W_(c), 0)
+#define TRACE4_(f, a, b, c, d)  trace_emit("" f "", TRACE_W_(a), TRACE_W_(b), \
+                                           TRACE_W_(c), TRACE_W_(d))
+
+#else
+
+#define TRACE(...)          do { } while (0)
+
+#endif /* TRACE_ENABLE */
+
+#if TRACE_DEBUG_PRINTF
+#define hal_debug_printf(...)   TRACE(__VA_ARGS__)
+#endif
+
+/* Empty every ring */
+void trace_reset(void);
+
+/* Records written by one core since the last reset, lost ones included */
+uint32_t trace_count(uint32_t cpu);
+
+/*
+ * Print every ring on the debug UART (hal_debug_puts), oldest record
+ * first, for board/tracedump.py:
+ *
+ *   @trace 1 <records per ring>
+ *   @C <cpu> <written>
+ *   @T <cpu> <ts> <fmt> <arg0> <arg1> <arg2> <arg3>      (all hex)
+ *   @end
+ *
+ * Call it where timing no longer matters — after a benchmark, from a
+ * button, on the way into a panic.
+ */
+void trace_dump(void);
+
+#endif /* TRACE_H */
@@ -37,18 +37,26 @@
  *   (No footer needed - we only need footer for coalescing with free blocks)
  *
  * SIZE CLASS CALCULATION:
- * Given a block size, we compute its size class as:
- *   class = floor(log2(size)) - floor(log2(MIN_BLOCK_SIZE))
+ * Given a block size, mapping_insert() computes its two-level class:
+ *   size <  128:  fl = 0,                 sl = size / 8
+ *   size >= 128:  fl = fls(size) - 6,     sl = the 4 bits below the top bit
  *
- * This groups blocks into power-of-two buckets:
- *   Class 0: [32, 64)
- *   Class 1: [64, 128)
- *   Class 2: [128, 256)
- *   etc.
+ *   size 200 = 0b1100_1000:  fls = 7 → fl = 1
+ *                            (200 >> 3) = 0b1_1001 → sl = 0b1001 = 9
+ *                            list [1][9] holds [200, 208)
+ *
+ * fls() ("find last set") is a single clz instruction where the
+ * hardware has one — see common/src/bitops.h.
  */
 
 #include "allocator.h"
 #include "../../common/src/string.h"
+#include "../../common/src/spinlock.h"
+#include "../../common/src/bitops.h"
+#include "hal_types.h"
+#include "hal_cpu.h"
+#include "hal_timer.h"
+#include "smp.h"
 
 /* =============================================================================
  * INTERNAL DATA STRUCTURES
@@ -227,41 +235,56 @@ static inline void write_footer(block_header_t *block)
 }
 
 /*
- * size_class() - Calculate size class for a block size
+ * mapping_insert() - Two-level class of a block of exactly `size` bytes
  *
- * Uses the position of the highest set bit to determine class.
- * Equivalent to floor(log2(size)) - floor(log2(MIN_BLOCK_SIZE))
+ * Used when a block goes onto (or comes off) a free list.
  */
-static inline size_t size_class(size_t size)
+static inline void mapping_insert(size_t size, uint32_t *fl, uint32_t *sl)
 {
-    if (size <= MIN_BLOCK_SIZE) {
-        return 0;
+    if (size < TLSF_SMALL_BLOCK) {
+        *fl = 0;
+        *sl = (uint32_t)(size / (TLSF_SMALL_BLOCK / TLSF_SL_COUNT));
+        return;
     }
 
-    /*
-     * Count leading zeros to find highest bit position.
-     * class = (bit_position(size) - bit_position(MIN_BLOCK_SIZE))
-     *
-     * MIN_BLOCK_SIZE = 32 = 2^5, so its highest bit is at position 5.
-     * For size 64 (2^6), highest bit at 6, class = 6-5 = 1.
-     * For size 128 (2^7), highest bit at 7, class = 7-5 = 2.
-     */
-    unsigned int bits = 0;
-    size_t temp = size;
-    while (temp > 1) {
-        temp >>= 1;
-        bits++;
+    uint32_t top = bit_fls64(size);
+    *fl = top - TLSF_FL_SHIFT + 1;
+    *sl = (uint32_t)(size >> (top - TLSF_SL_LOG2)) ^ TLSF_SL_COUNT;
+}
+
+/*
+ * mapping_search() - First class whose EVERY block holds `size` bytes
+ *
+ * Rounds size up to the next second-level boundary first. Without that,
+ * list [fl][sl] could hold blocks a few bytes too small and we'd have to
+ * walk it. Returns false if the request is beyond the largest class.
+ */
+static inline bool mapping_search(size_t size, uint32_t *fl, uint32_t *sl)
+{
+    if (size >= TLSF_SMALL_BLOCK) {
+        size += ((size_t)1 << (bit_fls64(size) - TLSF_SL_LOG2)) - 1;
     }
+    mapping_insert(size, fl, sl);
+    return *fl < TLSF_FL_COUNT;
+}
 
-    unsigned int min_bits = 5;  /* log2(32) = 5 */
-    size_t class = (bits > min_bits) ? (bits - min_bits) : 0;
 
-    /* Clamp to valid range */
-    if (class >= NUM_SIZE_CLASSES) {
-        class = NUM_SIZE_CLASSES - 1;
-    }
+/* log2 of bucket 0's bound: the smallest block, and the smallest slab class */
+#define ALLOC_HIST_MIN_SHIFT    5
+
+_Static_assert((1u << ALLOC_HIST_MIN_SHIFT) == MIN_BLOCK_SIZE &&
+               (1u << ALLOC_HIST_MIN_SHIFT) == HEAP_CACHE_MIN,
+               "ALLOC_HIST_MIN_SHIFT must track MIN_BLOCK_SIZE");
 
-    return class;
+/*
+ * alloc_hist_bucket() - Metrics class of a payload (see ALLOC_HIST_BUCKETS)
+ */
+static inline uint32_t alloc_hist_bucket(size_t payload)
+{
+    if (payload <= HEAP_CACHE_MIN) return 0;
+    /* ceil(log2(payload)) - log2(HEAP_CACHE_MIN) */
+    uint32_t b = bit_fls64(payload - 1) + 1 - ALLOC_HIST_MIN_SHIFT;
+    return b < ALLOC_HIST_BUCKETS ? b : ALLOC_HIST_BUCKETS - 1;
 }
 
 
@@ -275,8 +298,8 @@ static inline size_t size_class(size_t size)
  */
 static void remove_from_free_list(allocator_t *alloc, block_header_t *block)
 {
-    size_t size = block_size(block);
-    size_t class = size_class(size);
+    uint32_t fl, sl;
+    mapping_insert(block_size(block), &fl, &sl);
     free_node_t *node = free_list_node(block);
 
     /* Update previous node's next pointer (or list head) */
@@ -284,7 +307,7 @@ static void remove_from_free_list(allocator_t *alloc, block_header_t *block)
         node->prev->next = node->next;
     } else {
         /* This was the head of the list */
-        alloc->free_lists[class] = node->next;
+        alloc->free_lists[fl][sl] = node->next;
     }
 
     /* Update next node's prev pointer */
@@ -292,9 +315,12 @@ static void remove_from_free_list(allocator_t *alloc, block_header_t *block)
         node->next->prev = node->prev;
     }
 
-    /* If list is now empty, clear bitmap bit */
-    if (alloc->free_lists[class] == NULL) {
-        alloc->free_bitmap &= ~(1u << class);
+    /* If list is now empty, clear its bit — and the row's, if that was the last */
+    if (alloc->free_lists[fl][sl] == NULL) {
+        alloc->sl_bitmap[fl] &= ~(1u << sl);
+        if (alloc->sl_bitmap[fl] == 0) {
+            alloc->fl_bitmap &= ~(1u << fl);
+        }
     }
 }
 
@@ -303,12 +329,12 @@ static void remove_from_free_list(allocator_t *alloc, block_header_t *block)
  */
 static void insert_into_free_list(allocator_t *alloc, block_header_t *block)
 {
-    size_t size = block_size(block);
-    size_t class = size_class(size);
+    uint32_t fl, sl;
+    mapping_insert(block_size(block), &fl, &sl);
     free_node_t *node = free_list_node(block);
 
     /* Insert at head of list */
-    free_node_t *old_head = (free_node_t *)alloc->free_lists[class];
+    free_node_t *old_head = (free_node_t *)alloc->free_lists[fl][sl];
     node->prev = NULL;
     node->next = old_head;
 
@@ -316,10 +342,11 @@ static void insert_into_free_list(allocator_t *alloc, block_header_t *block)
         old_head->prev = node;
     }
 
-    alloc->free_lists[class] = node;
+    alloc->free_lists[fl][sl] = node;
 
-    /* Set bitmap bit */
-    alloc->free_bitmap |= (1u << class);
+    /* Set bitmap bits */
+    alloc->sl_bitmap[fl] |= (1u << sl);
+    alloc->fl_bitmap |= (1u << fl);
 }
 
 
@@ -371,6 +398,28 @@ static void split_block(allocator_t *alloc, block_header_t *block, size_t needed
     }
 }
 
+/*
+ * split_front() - Give the first `gap` bytes of a free block back
+ *
+ * Used by aligned allocations: the block we found starts too early, so
+ * its head becomes a free block of its own and the rest (returned) starts
+ * where the aligned payload needs it to. gap must be >= MIN_BLOCK_SIZE.
+ * The original block must already be off its free list.
+ */
+static block_header_t *split_front(allocator_t *alloc, block_header_t *block, size_t gap)
+{
+    size_t total = block_size(block);
+
+    /* The found block was free, so its own predecessor isn't: no merging */
+    block->size_and_flags = gap | FLAG_FREE;
+    write_footer(block);
+    insert_into_free_list(alloc, block);
+
+    block_header_t *rest = (block_header_t *)((uint8_t *)block + gap);
+    rest->size_and_flags = (total - gap) | FLAG_FREE | FLAG_PREV_FREE;
+    return rest;
+}
+
 /*
  * coalesce() - Merge adjacent free blocks
  *
@@ -433,37 +482,30 @@ static block_header_t *coalesce(allocator_t *alloc, block_header_t *block)
 /*
  * find_free_block() - Find a free block of at least the given size
  *
- * Uses the bitmap to quickly find a size class with available blocks.
+ * Two bit scans, no loops: the lowest non-empty list at or after
+ * mapping_search()'s (fl, sl) in this row, else the lowest list of the
+ * next non-empty row. Any block on that list is large enough.
  */
 static block_header_t *find_free_block(allocator_t *alloc, size_t size)
 {
-    size_t min_class = size_class(size);
-
-    /*
-     * Mask off classes smaller than we need, then find first set bit.
-     * This gives us the smallest class that might have a large enough block.
-     */
-    uint32_t available = alloc->free_bitmap & ~((1u << min_class) - 1);
-
-    if (available == 0) {
-        return NULL;  /* No suitable blocks */
+    uint32_t fl, sl;
+    if (!mapping_search(size, &fl, &sl)) {
+        return NULL;  /* Larger than any class */
     }
 
-    /*
-     * Find first set bit (lowest class with blocks)
-     */
-    size_t class = 0;
-    while ((available & (1u << class)) == 0) {
-        class++;
-    }
-
-    /* Get first block from that class */
-    free_node_t *node = (free_node_t *)alloc->free_lists[class];
-    if (node == NULL) {
-        return NULL;  /* Shouldn't happen if bitmap is correct */
+    uint32_t sl_map = alloc->sl_bitmap[fl] & (~0u << sl);
+    if (sl_map == 0) {
+        /* Nothing left in this row: the next row up has only bigger blocks */
+        uint32_t fl_map = (fl + 1 < TLSF_FL_COUNT) ? alloc->fl_bitmap & (~0u << (fl + 1)) : 0;
+        if (fl_map == 0) {
+            return NULL;  /* No suitable blocks */
+        }
+        fl = bit_ctz32(fl_map);
+        sl_map = alloc->sl_bitmap[fl];
     }
+    sl = bit_ctz32(sl_map);
 
-    return block_from_node(node);
+    return block_from_node((free_node_t *)alloc->free_lists[fl][sl]);
 }
 
 
@@ -487,11 +529,24 @@ void allocator_init(allocator_t *alloc, uintptr_t heap_start, uintptr_t heap_end
     alloc->heap_end = end;
     alloc->free_space = size;
     alloc->allocated = 0;
-    alloc->free_bitmap = 0;
+    alloc->fl_bitmap = 0;
+
+    /* Reset metrics */
+    alloc->peak_allocated = 0;
+    alloc->alloc_count = 0;
+    alloc->free_count = 0;
+    alloc->fail_count = 0;
+    for (int b = 0; b < ALLOC_HIST_BUCKETS; b++) {
+        alloc->class_allocs[b] = 0;
+        alloc->class_frees[b] = 0;
+    }
 
     /* Clear free lists */
-    for (int i = 0; i < NUM_SIZE_CLASSES; i++) {
-        alloc->free_lists[i] = NULL;
+    for (int fl = 0; fl < TLSF_FL_COUNT; fl++) {
+        alloc->sl_bitmap[fl] = 0;
+        for (int sl = 0; sl < TLSF_SL_COUNT; sl++) {
+            alloc->free_lists[fl][sl] = NULL;
+        }
     }
 
     /*
@@ -500,18 +555,11 @@ void allocator_init(allocator_t *alloc, uintptr_t heap_start, uintptr_t heap_end
     block_header_t *initial = (block_header_t *)start;
     initial->size_and_flags = size | FLAG_FREE;
 
-    /* Initialize free list node */
-    free_node_t *node = free_list_node(initial);
-    node->next = NULL;
-    node->prev = NULL;
-
     /* Write footer */
     write_footer(initial);
 
     /* Add to free list */
-    size_t class = size_class(size);
-    alloc->free_lists[class] = node;
-    alloc->free_bitmap = 1u << class;
+    insert_into_free_list(alloc, initial);
 
     alloc->initialized = true;
 }
@@ -578,15 +626,38 @@ void *allocator_alloc(allocator_t *alloc, size_t size, size_t align)
         block_size_needed = MIN_BLOCK_SIZE;
     }
 
+    /*
+     * Over-aligned requests search for enough slack to slide the payload
+     * forward: up to align - MIN_ALIGN to reach the boundary, plus
+     * MIN_BLOCK_SIZE in case the gap is too small to be a block by itself
+     * and we have to skip to the next boundary.
+     */
+    size_t search_size = block_size_needed;
+    if (align > MIN_ALIGN) {
+        search_size += align + MIN_BLOCK_SIZE;
+    }
+
     /* Find a suitable free block */
-    block_header_t *block = find_free_block(alloc, block_size_needed);
+    block_header_t *block = find_free_block(alloc, search_size);
     if (block == NULL) {
+        alloc->fail_count++;
         return NULL;  /* Out of memory */
     }
 
     /* Remove from free list */
     remove_from_free_list(alloc, block);
 
+    if (align > MIN_ALIGN) {
+        uintptr_t payload = (uintptr_t)block_payload(block);
+        uintptr_t aligned = align_up(payload, align);
+        if (aligned != payload && aligned - payload < MIN_BLOCK_SIZE) {
+            aligned = align_up(payload + MIN_BLOCK_SIZE, align);
+        }
+        if (aligned != payload) {
+            block = split_front(alloc, block, aligned - payload);
+        }
+    }
+
     /* Split if block is much larger than needed */
     split_block(alloc, block, block_size_needed);
 
@@ -604,6 +675,11 @@ void *allocator_alloc(allocator_t *alloc, size_t size, size_t align)
     /* Update statistics */
     alloc->allocated += final_size;
     alloc->free_space -= final_size;
+    if (alloc->allocated > alloc->peak_allocated) {
+        alloc->peak_allocated = alloc->allocated;
+    }
+    alloc->alloc_count++;
+    alloc->class_allocs[alloc_hist_bucket(final_size - HEADER_SIZE)]++;
 
     return block_payload(block);
 }
@@ -628,6 +704,8 @@ void allocator_free(allocator_t *alloc, void *ptr)
     /* Update statistics */
     alloc->allocated -= size;
     alloc->free_space += size;
+    alloc->free_count++;
+    alloc->class_frees[alloc_hist_bucket(size - HEADER_SIZE)]++;
 
     /* Mark as free */
     block_set_free(block, true);
@@ -687,6 +765,101 @@ void allocator_stats(const allocator_t *alloc, size_t *allocated_out, size_t *fr
     if (free_out) *free_out = alloc->free_space;
 }
 
+/*
+ * largest_free_block() - Size of the biggest free block
+ *
+ * It can only be on the highest non-empty list, but that list spans a
+ * 1/16th size range, so walk it.
+ */
+static size_t largest_free_block(const allocator_t *alloc)
+{
+    if (alloc->fl_bitmap == 0) return 0;
+
+    uint32_t fl = 31 - bit_clz32(alloc->fl_bitmap);
+    uint32_t sl = 31 - bit_clz32(alloc->sl_bitmap[fl]);
+
+    size_t largest = 0;
+    for (free_node_t *node = (free_node_t *)alloc->free_lists[fl][sl];
+         node != NULL; node = node->next) {
+        size_t size = block_size(block_from_node(node));
+        if (size > largest) largest = size;
+    }
+    return largest;
+}
+
+/*
+ * allocator_get_metrics() - Snapshot counters, peak and fragmentation
+ */
+void allocator_get_metrics(const allocator_t *alloc, allocator_metrics_t *out)
+{
+    out->heap_size      = alloc->heap_end - alloc->heap_start;
+    out->allocated      = alloc->allocated;
+    out->free_space     = alloc->free_space;
+    out->peak_allocated = alloc->peak_allocated;
+
+    out->largest_free = largest_free_block(alloc);
+    out->fragmentation_pct = alloc->free_space
+        ? (uint32_t)(100 - (uint64_t)out->largest_free * 100 / alloc->free_space)
+        : 0;
+
+    out->allocs   = alloc->alloc_count;
+    out->frees    = alloc->free_count;
+    out->failures = alloc->fail_count;
+    for (int b = 0; b < ALLOC_HIST_BUCKETS; b++) {
+        out->class_allocs[b] = alloc->class_allocs[b];
+        out->class_frees[b]  = alloc->class_frees[b];
+    }
+
+    out->timed_allocs      = 0;
+    out->alloc_ticks_total = 0;
+    out->alloc_ticks_max   = 0;
+}
+
+/*
+ * allocator_validate() - Walk every block and check the heap's invariants
+ */
+bool allocator_validate(const allocator_t *alloc, uintptr_t *bad_block)
+{
+    if (bad_block) *bad_block = 0;
+    if (!alloc->initialized) return true;
+
+    uintptr_t addr = alloc->heap_start;
+    size_t used = 0, free = 0;
+    bool prev_free = false;
+
+    while (addr < alloc->heap_end) {
+        block_header_t *block = (block_header_t *)addr;
+        size_t size = block_size(block);
+        bool is_free = block_is_free(block);
+        bool ok = (size >= MIN_BLOCK_SIZE) &&
+                  (size & (MIN_ALIGN - 1)) == 0 &&
+                  size <= alloc->heap_end - addr &&
+                  block_is_prev_free(block) == prev_free &&
+                  !(is_free && prev_free);
+
+        if (ok && is_free) {
+            uint32_t fl, sl;
+            mapping_insert(size, &fl, &sl);
+            uintptr_t footer = *(uintptr_t *)(addr + size - FOOTER_SIZE);
+            ok = footer == size &&
+                 fl < TLSF_FL_COUNT &&
+                 (alloc->fl_bitmap & (1u << fl)) &&
+                 (alloc->sl_bitmap[fl] & (1u << sl));
+        }
+
+        if (!ok) {
+            if (bad_block) *bad_block = addr;
+            return false;
+        }
+
+        if (is_free) free += size; else used += size;
+        prev_free = is_free;
+        addr += size;
+    }
+
+    return used == alloc->allocated && free == alloc->free_space;
+}
+
 /*
  * allocator_bounds() - Get heap bounds
  */
@@ -713,6 +886,268 @@ bool allocator_is_initialized(const allocator_t *alloc)
 /* Global allocator instance */
 allocator_t g_allocator = {0};
 
+/*
+ * Serializes every g_allocator call made by heap_*(). Only taken once
+ * secondary cores are online: before that there is nobody to race with,
+ * and on BCM2710 the exclusives behind spin_lock() don't work until the
+ * data cache is on (see spinlock.h).
+ */
+static spinlock_t g_heap_lock = SPINLOCK_INIT;
+
+static inline bool heap_lock(void)
+{
+    if (smp_cpu_count() == 1) return false;
+    spin_lock(&g_heap_lock);
+    return true;
+}
+
+static inline void heap_unlock(bool locked)
+{
+    if (locked) spin_unlock(&g_heap_lock);
+}
+
+/* TLSF-path latency, updated under g_heap_lock (heap_get_metrics()) */
+static uint64_t g_heap_timed_allocs;
+static uint64_t g_heap_alloc_ticks;
+static uint32_t g_heap_alloc_ticks_max;
+
+static void *heap_tlsf_alloc(size_t size, size_t align)
+{
+    uint32_t start = hal_timer_get_ticks32();
+    bool locked = heap_lock();
+    void *ptr = allocator_alloc(&g_allocator, size, align);
+
+    uint32_t ticks = hal_timer_get_ticks32() - start;
+    g_heap_timed_allocs++;
+    g_heap_alloc_ticks += ticks;
+    if (ticks > g_heap_alloc_ticks_max) g_heap_alloc_ticks_max = ticks;
+
+    heap_unlock(locked);
+    return ptr;
+}
+
+static void heap_tlsf_free(void *ptr)
+{
+    bool locked = heap_lock();
+    allocator_free(&g_allocator, ptr);
+    heap_unlock(locked);
+}
+
+
+/* =============================================================================
+ * PER-CORE SLAB CACHES
+ * =============================================================================
+ *
+ * SLAB LAYOUT:
+ *   +-------------+--------+---------+--------+---------+-----+
+ *   | heap_slab_t | header | payload | header | payload | ... |
+ *   +-------------+--------+---------+--------+---------+-----+
+ *                   slab | FLAG_SLAB
+ *
+ * A free object's payload holds the next pointer of whichever list it is
+ * on: the owner's `free` list or the lock-free `remote` list.
+ *
+ * Each core keeps one singly linked list of slabs per class with the slab
+ * it is currently allocating from at the head. A slab whose last object
+ * comes home goes back to TLSF, unless it is the head (keeping one slab
+ * per class avoids thrashing on alloc/free pairs at a slab boundary).
+ *
+ * Objects freed remotely are only counted once the owner drains them, so
+ * a slab that empties purely through remote frees is returned the next
+ * time its owner allocates from that class.
+ */
+
+typedef struct heap_slab {
+    struct heap_slab *next;         /* Owner's list for this class */
+    void             *free;         /* Owner-only free list */
+    void * volatile   remote;       /* Other cores push here (CAS) */
+    uint32_t          owner;        /* hal_cpu_id() of the owning core */
+    uint32_t          cls;
+    uint32_t          used;         /* Objects not on the free list */
+    uint32_t          capacity;
+} heap_slab_t;
+
+#define HEAP_CACHE_LINE 64
+
+typedef struct {
+    heap_slab_t *slabs[HEAP_CACHE_CLASSES];
+
+    /* Metrics: objects this core allocated / freed, whoever owns the slab */
+    uint32_t     allocs[HEAP_CACHE_CLASSES];
+    uint32_t     frees[HEAP_CACHE_CLASSES];
+} HAL_ALIGNED(HEAP_CACHE_LINE) heap_core_cache_t;
+
+static heap_core_cache_t g_heap_cache[HAL_MAX_CPUS];
+
+static inline uint32_t heap_cache_class(size_t size)
+{
+    if (size <= HEAP_CACHE_MIN) return 0;
+    /* ceil(log2(size)) - log2(HEAP_CACHE_MIN) */
+    return (32 - bit_clz32((uint32_t)size - 1)) - 5;
+}
+
+static inline size_t heap_cache_stride(uint32_t cls)
+{
+    return HEADER_SIZE + ((size_t)HEAP_CACHE_MIN << cls);
+}
+
+static inline uint32_t heap_self(void)
+{
+    uint32_t cpu = hal_cpu_id();
+    return cpu < HAL_MAX_CPUS ? cpu : 0;
+}
+
+static heap_slab_t *heap_slab_create(uint32_t owner, uint32_t cls)
+{
+    /*
+     * Ask for HEAP_SLAB_SIZE minus the TLSF header, so the block itself is
+     * exactly a power of two and sits on a class boundary: mapping_search()
+     * doesn't have to round it up into a bigger list.
+     */
+    size_t bytes = HEAP_SLAB_SIZE - HEADER_SIZE;
+    heap_slab_t *slab = (heap_slab_t *)heap_tlsf_alloc(bytes, MIN_ALIGN);
+    if (slab == NULL) return NULL;
+
+    size_t stride = heap_cache_stride(cls);
+    uintptr_t first = align_up((uintptr_t)(slab + 1), MIN_ALIGN);
+    uint32_t capacity = (uint32_t)(((uintptr_t)slab + bytes - first) / stride);
+
+    slab->next     = NULL;
+    slab->free     = NULL;
+    slab->remote   = NULL;
+    slab->owner    = owner;
+    slab->cls      = cls;
+    slab->used     = 0;
+    slab->capacity = capacity;
+
+    /* Thread the objects in reverse so the first allocation is the lowest */
+    for (uint32_t i = capacity; i > 0; i--) {
+        uintptr_t obj = first + (uintptr_t)(i - 1) * stride;
+        ((block_header_t *)obj)->size_and_flags = (uintptr_t)slab | FLAG_SLAB;
+        void *payload = (void *)(obj + HEADER_SIZE);
+        *(void **)payload = slab->free;
+        slab->free = payload;
+    }
+    return slab;
+}
+
+/* Take back everything other cores freed into this slab */
+static void heap_slab_drain(heap_slab_t *slab)
+{
+    if (__atomic_load_n(&slab->remote, __ATOMIC_RELAXED) == NULL) return;
+
+    void *list = __atomic_exchange_n(&slab->remote, NULL, __ATOMIC_ACQUIRE);
+    while (list) {
+        void *next = *(void **)list;
+        *(void **)list = slab->free;
+        slab->free = list;
+        slab->used--;
+        list = next;
+    }
+}
+
+/* Unlink and release every non-head slab of this class with nothing in use */
+static void heap_cache_trim(heap_core_cache_t *cache, uint32_t cls)
+{
+    heap_slab_t **link = &cache->slabs[cls]->next;
+    while (*link) {
+        heap_slab_t *slab = *link;
+        heap_slab_drain(slab);
+        if (slab->used == 0) {
+            *link = slab->next;
+            heap_tlsf_free(slab);
+        } else {
+            link = &slab->next;
+        }
+    }
+}
+
+static void *heap_cache_alloc(uint32_t cls)
+{
+    uint32_t self = heap_self();
+    heap_core_cache_t *cache = &g_heap_cache[self];
+    heap_slab_t *slab = cache->slabs[cls];
+
+    if (slab == NULL || slab->free == NULL) {
+        if (slab) heap_slab_drain(slab);
+
+        if (slab == NULL || slab->free == NULL) {
+            /* Head is full: reclaim, then find (or make) a slab with room */
+            heap_slab_t **link = slab ? &slab->next : &cache->slabs[cls];
+            if (slab) heap_cache_trim(cache, cls);
+
+            while (*link && (*link)->free == NULL) link = &(*link)->next;
+
+            heap_slab_t *found = *link;
+            if (found) {
+                *link = found->next;
+            } else {
+                found = heap_slab_create(self, cls);
+                if (found == NULL) return NULL;
+            }
+            found->next = cache->slabs[cls];
+            cache->slabs[cls] = found;
+            slab = found;
+        }
+    }
+
+    void *payload = slab->free;
+    slab->free = *(void **)payload;
+    slab->used++;
+    cache->allocs[cls]++;
+    return payload;
+}
+
+static void heap_cache_free(heap_slab_t *slab, void *payload)
+{
+    uint32_t self = heap_self();
+    g_heap_cache[self].frees[slab->cls]++;
+
+    if (slab->owner != self) {
+        /* Someone else's slab: lock-free push, the owner drains later */
+        void *head = __atomic_load_n(&slab->remote, __ATOMIC_RELAXED);
+        do {
+            *(void **)payload = head;
+        } while (!__atomic_compare_exchange_n(&slab->remote, &head, payload, true,
+                                              __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+        return;
+    }
+
+    *(void **)payload = slab->free;
+    slab->free = payload;
+    slab->used--;
+
+    heap_core_cache_t *cache = &g_heap_cache[slab->owner];
+    if (slab->used == 0 && cache->slabs[slab->cls] != slab) {
+        heap_slab_t **link = &cache->slabs[slab->cls];
+        while (*link != slab) link = &(*link)->next;
+        *link = slab->next;
+        heap_tlsf_free(slab);
+    }
+}
+
+/*
+ * The slab behind a heap_alloc() pointer, or NULL for a TLSF block.
+ *
+ * Runs without g_heap_lock. The header of an allocated TLSF block can
+ * still change under us — a neighbour being freed on another core flips
+ * its FLAG_PREV_FREE — but FLAG_SLAB and the size bits can't, and an
+ * aligned 64-bit load never tears.
+ */
+static inline heap_slab_t *heap_slab_of(void *ptr)
+{
+    uintptr_t header = __atomic_load_n(&block_from_payload(ptr)->size_and_flags,
+                                       __ATOMIC_RELAXED);
+    return (header & FLAG_SLAB) ? (heap_slab_t *)(header & ~(uintptr_t)(MIN_ALIGN - 1))
+                                : NULL;
+}
+
+
+/* =============================================================================
+ * HEAP FRONT DOOR
+ * =============================================================================
+ */
+
 /* Linker symbol for heap start - must be defined in linker script */
 extern uint8_t __heap_start[];
 
@@ -724,24 +1159,99 @@ void heap_init(uintptr_t ram_base, size_t ram_size)
                             (uintptr_t)__heap_start,
                             &heap_start, &heap_end,
                             &jit_start, &jit_end);
+
+    for (uint32_t cpu = 0; cpu < HAL_MAX_CPUS; cpu++) {
+        for (uint32_t cls = 0; cls < HEAP_CACHE_CLASSES; cls++) {
+            g_heap_cache[cpu].slabs[cls]  = NULL;
+            g_heap_cache[cpu].allocs[cls] = 0;
+            g_heap_cache[cpu].frees[cls]  = 0;
+        }
+    }
+
+    g_heap_timed_allocs    = 0;
+    g_heap_alloc_ticks     = 0;
+    g_heap_alloc_ticks_max = 0;
 }
 
 void *heap_alloc(size_t size)
 {
-    return allocator_alloc(&g_allocator, size, MIN_ALIGN);
+    if (size == 0 || !g_allocator.initialized) return NULL;
+    if (size <= HEAP_CACHE_MAX) return heap_cache_alloc(heap_cache_class(size));
+    return heap_tlsf_alloc(size, MIN_ALIGN);
 }
 
 void *heap_alloc_aligned(size_t size, size_t align)
 {
-    return allocator_alloc(&g_allocator, size, align);
+    /* Slab objects are only MIN_ALIGN aligned */
+    if (align <= MIN_ALIGN) return heap_alloc(size);
+    return heap_tlsf_alloc(size, align);
 }
 
 void heap_free(void *ptr)
 {
-    allocator_free(&g_allocator, ptr);
+    if (ptr == NULL) return;
+
+    heap_slab_t *slab = heap_slab_of(ptr);
+    if (slab) {
+        heap_cache_free(slab, ptr);
+    } else {
+        heap_tlsf_free(ptr);
+    }
 }
 
 void *heap_realloc(void *ptr, size_t size)
 {
-    return allocator_realloc(&g_allocator, ptr, size);
+    if (ptr == NULL) return heap_alloc(size);
+
+    heap_slab_t *slab = heap_slab_of(ptr);
+    if (slab == NULL) {
+        bool locked = heap_lock();
+        void *new_ptr = allocator_realloc(&g_allocator, ptr, size);
+        heap_unlock(locked);
+        return new_ptr;
+    }
+
+    if (size == 0) {
+        heap_free(ptr);
+        return NULL;
+    }
+
+    size_t current = (size_t)HEAP_CACHE_MIN << slab->cls;
+    if (size <= current) return ptr;
+
+    void *new_ptr = heap_alloc(size);
+    if (new_ptr == NULL) return NULL;   /* Original pointer still valid */
+
+    memcpy(new_ptr, ptr, current);
+    heap_free(ptr);
+    return new_ptr;
+}
+
+void heap_get_metrics(allocator_metrics_t *out)
+{
+    bool locked = heap_lock();
+    allocator_get_metrics(&g_allocator, out);
+    out->timed_allocs      = g_heap_timed_allocs;
+    out->alloc_ticks_total = g_heap_alloc_ticks;
+    out->alloc_ticks_max   = g_heap_alloc_ticks_max;
+    heap_unlock(locked);
+
+    for (uint32_t cpu = 0; cpu < HAL_MAX_CPUS; cpu++) {
+        for (uint32_t cls = 0; cls < HEAP_CACHE_CLASSES; cls++) {
+            uint32_t a = __atomic_load_n(&g_heap_cache[cpu].allocs[cls], __ATOMIC_RELAXED);
+            uint32_t f = __atomic_load_n(&g_heap_cache[cpu].frees[cls], __ATOMIC_RELAXED);
+            out->class_allocs[cls] += a;
+            out->class_frees[cls]  += f;
+            out->allocs += a;
+            out->frees  += f;
+        }
+    }
+}
+
+bool heap_validate(uintptr_t *bad_block)
+{
+    bool locked = heap_lock();
+    bool ok = allocator_validate(&g_allocator, bad_block);
+    heap_unlock(locked);
+    return ok;
 }
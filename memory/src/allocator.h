@@ -21,23 +21,34 @@
  *   - Free/allocated status
  *   - Whether previous block is free (for coalescing)
  *
- * Free blocks are organized into "segregated free lists" by size class:
- *   - Class 0: 32-64 bytes
- *   - Class 1: 64-128 bytes
- *   - Class 2: 128-256 bytes
- *   - ... and so on
+ * Free blocks are organized into "segregated free lists" on two levels:
  *
- * A bitmap tracks which classes have free blocks, enabling O(1) lookup.
+ *   First level (fl):   one per power of two — [128, 256), [256, 512), ...
+ *                       Blocks under 128 bytes all share fl = 0.
+ *   Second level (sl):  each power of two split into TLSF_SL_COUNT equal
+ *                       slices — [256, 272), [272, 288), ... [496, 512)
+ *
+ *   fl_bitmap:     bit F set  ⇔  some sl list in row F is non-empty
+ *   sl_bitmap[F]:  bit S set  ⇔  free_lists[F][S] is non-empty
+ *
+ * Every list holds blocks whose sizes differ by less than 1/16th, so a
+ * request never searches inside a list — one count-trailing-zeros per
+ * level finds the list, and its head is the answer.
  *
  * ALLOCATION STRATEGY:
  * --------------------
  *   1. Calculate required size (payload + header, aligned)
- *   2. Determine size class
- *   3. Use bitmap to find class with available block
- *   4. Remove block from free list
+ *   2. Round it UP to the next second-level boundary, and map that to
+ *      (fl, sl). Every block in that list or any later one is big enough.
+ *   3. ctz(sl_bitmap[fl] masked to >= sl); if empty, ctz(fl_bitmap masked
+ *      to > fl), then ctz of that row's sl_bitmap
+ *   4. Remove the head block from its free list
  *   5. Split if block is much larger than needed
  *   6. Return pointer to payload area
  *
+ * "Good fit", not best fit: the chosen block is at most one slice larger
+ * than the rounded request, in O(1), with no fallback scan.
+ *
  * DEALLOCATION STRATEGY:
  * ----------------------
  *   1. Get block header from payload pointer
@@ -67,8 +78,35 @@
  *
  * THREAD SAFETY:
  * --------------
- * This implementation is NOT thread-safe. In a multi-core system,
- * you'd need to add spinlocks around allocation/deallocation.
+ * The allocator_*() functions are NOT thread-safe: they operate on one
+ * allocator_t and leave locking to the caller.
+ *
+ * The heap_*() front door IS safe on every core (see kernel/src/smp.h):
+ *
+ *   heap_alloc(n), n <= 512          heap_alloc(n), n > 512
+ *            │                                  │
+ *            ▼                                  │
+ *   ┌──────────────────┐  empty    ┌────────────▼───────────┐
+ *   │ this core's slab │ ────────> │ TLSF heap (g_allocator)│
+ *   │ cache, one list  │  refill:  │ behind g_heap_lock     │
+ *   │ per size class   │ 16KB slab └────────────────────────┘
+ *   └──────────────────┘
+ *
+ * Small requests are rounded up to 32, 64, 128, 256 or 512 bytes and
+ * served from slabs owned by the calling core — no lock, no atomics.
+ * A slab is one HEAP_SLAB_SIZE TLSF allocation carved into equal objects.
+ *
+ * Freeing an object on the core that owns its slab is just as cheap.
+ * Freeing it on ANOTHER core pushes it onto the slab's remote-free list
+ * with one compare-and-swap; the owner takes the whole list back with a
+ * single atomic exchange the next time that slab runs dry.
+ *
+ * Slab objects carry an 8-byte header like TLSF blocks do, but with
+ * FLAG_SLAB set and the slab's address instead of a size. heap_free()
+ * uses that to tell the two apart, so never hand a heap_alloc() pointer
+ * to allocator_free() directly.
+ *
+ * None of this is interrupt-safe: don't allocate from an IRQ handler.
  */
 
 #ifndef ALLOCATOR_H
@@ -93,17 +131,20 @@
 #define MIN_BLOCK_SIZE      32
 
 /*
- * Number of size classes
+ * Two-level size classes
  *
- * Each class covers blocks of size [2^(n+5), 2^(n+6))
- *   Class 0: 32-64 bytes
- *   Class 1: 64-128 bytes
- *   ...
- *   Class 25: 1GB-2GB
+ * TLSF_SL_LOG2 = 4 gives 16 second-level lists per power of two, i.e.
+ * at most 6.25% internal slack per class.
  *
- * 26 classes covers up to 2GB blocks, more than enough.
+ * Blocks below TLSF_SMALL_BLOCK (128 bytes) go to first-level row 0,
+ * split linearly in MIN_ALIGN steps. Row F >= 1 covers
+ * [2^(F+6), 2^(F+7)), so 32 rows reach blocks of 2^38 bytes.
  */
-#define NUM_SIZE_CLASSES    26
+#define TLSF_SL_LOG2        4
+#define TLSF_SL_COUNT       (1 << TLSF_SL_LOG2)
+#define TLSF_FL_SHIFT       (TLSF_SL_LOG2 + 3)      /* + log2(MIN_ALIGN) */
+#define TLSF_SMALL_BLOCK    (1 << TLSF_FL_SHIFT)    /* 128 */
+#define TLSF_FL_COUNT       32
 
 /*
  * Minimum alignment
@@ -141,6 +182,13 @@
 #define FLAG_PREV_FREE      0x02    /* Previous block is free */
 #define FLAG_MASK           0x03    /* Mask for flag bits */
 
+/*
+ * Bit 2 of a TLSF size is always zero (sizes are multiples of 8), so the
+ * heap_*() slab caches use it to mark their object headers. It is
+ * deliberately NOT part of FLAG_MASK: TLSF never sees these headers.
+ */
+#define FLAG_SLAB           0x04    /* Header holds a slab pointer (heap_*) */
+
 
 /* =============================================================================
  * JIT REGION
@@ -153,6 +201,37 @@
 #define JIT_SIZE            (4 * 1024 * 1024)   /* 4 MB for JIT */
 
 
+/* =============================================================================
+ * PER-CORE SLAB CACHES
+ * =============================================================================
+ *
+ * See THREAD SAFETY above. Classes are powers of two from
+ * HEAP_CACHE_MIN to HEAP_CACHE_MAX bytes of payload.
+ */
+
+#define HEAP_CACHE_MIN      32
+#define HEAP_CACHE_MAX      512
+#define HEAP_CACHE_CLASSES  5                   /* 32, 64, 128, 256, 512 */
+#define HEAP_SLAB_SIZE      (16 * 1024)         /* One TLSF block per slab */
+
+
+/* =============================================================================
+ * METRICS
+ * =============================================================================
+ *
+ * Alloc/free counts are kept per power-of-two payload class:
+ *
+ *   bucket 0: <= 32 bytes,  bucket b: (16 << b, 32 << b],
+ *   bucket ALLOC_HIST_BUCKETS - 1 also takes everything larger
+ *
+ * so slab class c (HEAP_CACHE_MIN << c) is exactly bucket c. TLSF blocks
+ * are counted by the payload they actually granted, not the request, so
+ * an alloc and its free always land in the same bucket.
+ */
+
+#define ALLOC_HIST_BUCKETS  16                  /* 32 B ... 512 KB, > 512 KB */
+
+
 /* =============================================================================
  * DATA STRUCTURES
  * =============================================================================
@@ -167,11 +246,14 @@
  * caller's responsibility).
  */
 typedef struct {
-    /* Bitmap: bit N set means free_lists[N] is non-empty */
-    uint32_t free_bitmap;
+    /* First level: bit F set means sl_bitmap[F] != 0 */
+    uint32_t fl_bitmap;
+
+    /* Second level: bit S of sl_bitmap[F] set means free_lists[F][S] != NULL */
+    uint32_t sl_bitmap[TLSF_FL_COUNT];
 
-    /* Segregated free lists by size class */
-    void *free_lists[NUM_SIZE_CLASSES];
+    /* Segregated free lists, one per (fl, sl) */
+    void *free_lists[TLSF_FL_COUNT][TLSF_SL_COUNT];
 
     /* Heap bounds */
     uintptr_t heap_start;
@@ -181,6 +263,14 @@ typedef struct {
     size_t allocated;
     size_t free_space;
 
+    /* Metrics — see allocator_get_metrics() */
+    size_t   peak_allocated;
+    uint64_t alloc_count;
+    uint64_t free_count;
+    uint64_t fail_count;
+    uint32_t class_allocs[ALLOC_HIST_BUCKETS];
+    uint32_t class_frees[ALLOC_HIST_BUCKETS];
+
     /* Initialization flag */
     bool initialized;
 } allocator_t;
@@ -229,6 +319,10 @@ void allocator_init_from_ram(allocator_t *alloc,
  * @param size   Number of bytes to allocate
  * @param align  Alignment requirement (must be power of 2, >= 8)
  *
+ * Alignments above MIN_ALIGN search for a block with enough slack and
+ * split its head off as a separate free block, so the payload lands on
+ * the boundary without wasting the gap.
+ *
  * Returns: Pointer to allocated memory, or NULL if allocation failed
  */
 void *allocator_alloc(allocator_t *alloc, size_t size, size_t align);
@@ -262,6 +356,75 @@ void *allocator_realloc(allocator_t *alloc, void *ptr, size_t new_size);
  */
 void allocator_stats(const allocator_t *alloc, size_t *allocated_out, size_t *free_out);
 
+/*
+ * Everything measured about one allocator, from allocator_get_metrics()
+ * or (for the global heap, slab caches included) heap_get_metrics().
+ */
+typedef struct {
+    /* Capacity */
+    size_t   heap_size;
+    size_t   allocated;
+    size_t   free_space;
+    size_t   peak_allocated;        /* High-water mark of `allocated` */
+
+    /*
+     * Fragmentation: how much of the free space is NOT in the largest
+     * block. 0% = one contiguous hole, 90% = a request for a tenth of
+     * the free space might already fail.
+     */
+    size_t   largest_free;
+    uint32_t fragmentation_pct;
+
+    /* Operation counts, totals and per class (see ALLOC_HIST_BUCKETS) */
+    uint64_t allocs;
+    uint64_t frees;
+    uint64_t failures;              /* Out-of-memory returns */
+    uint32_t class_allocs[ALLOC_HIST_BUCKETS];
+    uint32_t class_frees[ALLOC_HIST_BUCKETS];
+
+    /*
+     * Latency of heap_alloc() calls that reach TLSF (lock wait included),
+     * in hal_timer ticks (microseconds). Slab fast paths are not timed:
+     * they cost less than reading the timer. Zero from
+     * allocator_get_metrics(), which has no timer.
+     */
+    uint64_t timed_allocs;
+    uint64_t alloc_ticks_total;
+    uint32_t alloc_ticks_max;
+} allocator_metrics_t;
+
+/*
+ * allocator_get_metrics() - Snapshot counters, peak and fragmentation
+ *
+ * O(1) apart from the largest-free-block search, which walks only the
+ * single highest non-empty free list.
+ *
+ * @param alloc  Pointer to allocator state
+ * @param out    Filled in; the latency fields are zero
+ */
+void allocator_get_metrics(const allocator_t *alloc, allocator_metrics_t *out);
+
+/*
+ * allocator_validate() - Walk every block and check the heap's invariants
+ *
+ * Checks, block by block from heap_start:
+ *   - the size is aligned, >= MIN_BLOCK_SIZE and stays inside the heap
+ *   - a free block's footer matches its header
+ *   - FLAG_PREV_FREE agrees with the previous block
+ *   - no two free blocks are adjacent (coalescing missed one)
+ *   - every free block's list is marked in the bitmaps
+ *   - the walk's byte totals match allocated + free_space
+ *
+ * O(number of blocks) — a debugging aid, not something to run per frame.
+ *
+ * @param alloc      Pointer to allocator state
+ * @param bad_block  Output (may be NULL): first bad block, or 0 if the
+ *                   totals were the only thing wrong
+ *
+ * Returns: true if the heap is consistent
+ */
+bool allocator_validate(const allocator_t *alloc, uintptr_t *bad_block);
+
 /*
  * allocator_bounds() - Get heap bounds
  *
@@ -326,10 +489,29 @@ void *heap_alloc_aligned(size_t size, size_t align);
 /*
  * heap_free() - Free memory from global allocator
  *
+ * May be called on any core, not just the one that allocated ptr.
+ *
  * @param ptr  Pointer to free (NULL is safe)
  */
 void heap_free(void *ptr);
 
+/*
+ * heap_get_metrics() - allocator_get_metrics() for the global heap
+ *
+ * Adds every core's slab-cache counts into the class histogram and the
+ * totals, and fills in the TLSF-path latency. Slab refills also appear
+ * as HEAP_SLAB_SIZE TLSF allocations, so `allocated` counts whole slabs.
+ *
+ * The slab counters of other cores are read without stopping them, so a
+ * snapshot taken while they run may be a few operations stale.
+ */
+void heap_get_metrics(allocator_metrics_t *out);
+
+/*
+ * heap_validate() - allocator_validate() on the global heap, under the lock
+ */
+bool heap_validate(uintptr_t *bad_block);
+
 /*
  * heap_realloc() - Reallocate from global allocator
  *
@@ -0,0 +1,113 @@
+/*
+ * arena.c - Bump Arena Allocator Implementation
+ * ==============================================
+ *
+ * See arena.h for the design overview.
+ */
+
+#include "arena.h"
+#include "allocator.h"
+
+/* =============================================================================
+ * ARENA
+ * =============================================================================
+ */
+
+bool arena_create(arena_t *arena, size_t size)
+{
+    void *chunk = heap_alloc(size);
+    if (chunk == NULL) {
+        arena_init(arena, NULL, 0);
+        return false;
+    }
+
+    arena_init(arena, chunk, size);
+    arena->owned = true;
+    return true;
+}
+
+void arena_init(arena_t *arena, void *buffer, size_t size)
+{
+    arena->base  = (uint8_t *)buffer;
+    arena->size  = buffer ? size : 0;
+    arena->used  = 0;
+    arena->peak  = 0;
+    arena->owned = false;
+}
+
+void arena_destroy(arena_t *arena)
+{
+    if (arena->owned) {
+        heap_free(arena->base);
+    }
+    arena_init(arena, NULL, 0);
+}
+
+void *arena_alloc_aligned(arena_t *arena, size_t size, size_t align)
+{
+    /*
+     * Align the ADDRESS, not the offset: heap_alloc() only promises
+     * MIN_ALIGN, so base itself may be less aligned than the request.
+     */
+    uintptr_t base  = (uintptr_t)arena->base;
+    uintptr_t start = (base + arena->used + align - 1) & ~(uintptr_t)(align - 1);
+    size_t offset   = start - base;
+
+    if (offset > arena->size || size > arena->size - offset) {
+        return NULL;
+    }
+
+    arena->used = offset + size;
+    if (arena->used > arena->peak) {
+        arena->peak = arena->used;
+    }
+    return (void *)start;
+}
+
+void *arena_alloc(arena_t *arena, size_t size)
+{
+    return arena_alloc_aligned(arena, size, ARENA_DEFAULT_ALIGN);
+}
+
+
+/* =============================================================================
+ * FRAME ARENAS
+ * =============================================================================
+ */
+
+static arena_t  g_frame_arenas[2];
+static uint32_t g_frame_current;
+static bool     g_frame_ready;
+
+bool frame_arena_init(size_t bytes_per_frame)
+{
+    if (!arena_create(&g_frame_arenas[0], bytes_per_frame)) {
+        return false;
+    }
+    if (!arena_create(&g_frame_arenas[1], bytes_per_frame)) {
+        arena_destroy(&g_frame_arenas[0]);
+        return false;
+    }
+
+    g_frame_current = 0;
+    g_frame_ready = true;
+    return true;
+}
+
+void *frame_alloc(size_t size)
+{
+    if (!g_frame_ready) return NULL;
+    return arena_alloc(&g_frame_arenas[g_frame_current], size);
+}
+
+void frame_arena_flip(void)
+{
+    if (!g_frame_ready) return;
+    g_frame_current ^= 1;
+    arena_reset(&g_frame_arenas[g_frame_current]);
+}
+
+arena_t *frame_arena_current(void)
+{
+    return g_frame_ready ? &g_frame_arenas[g_frame_current] : NULL;
+}
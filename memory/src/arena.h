@@ -0,0 +1,156 @@
+/*
+ * arena.h - Bump Arena Allocator
+ * ===============================
+ *
+ * Most allocations in a render loop live for exactly one frame: formatted
+ * strings, scratch scanlines, temporary command buffers. Sending each one
+ * through heap_alloc()/heap_free() means free-list traffic and coalescing
+ * for memory whose lifetime we already know.
+ *
+ * An arena is a single chunk with a cursor:
+ *
+ *   base                      used                          size
+ *    │                          │                             │
+ *    ▼                          ▼                             ▼
+ *    ┌────────┬──────┬──────────┬─────────────────────────────┐
+ *    │ alloc  │alloc │  alloc   │            free             │
+ *    └────────┴──────┴──────────┴─────────────────────────────┘
+ *
+ *   arena_alloc():   round `used` up to the alignment, bump it by size
+ *   arena_mark():    remember `used`
+ *   arena_rewind():  put `used` back to a mark — everything after is gone
+ *   arena_reset():   used = 0
+ *
+ * All O(1), no headers, no individual frees.
+ *
+ * FRAME ARENAS:
+ * -------------
+ * frame_arena_init() sets up two arenas that fb_present() swaps between:
+ *
+ *   frame N:    frame_alloc() → arena A
+ *   present:    switch to B, reset B
+ *   frame N+1:  frame_alloc() → arena B   (A's data still intact)
+ *   present:    switch to A, reset A
+ *
+ * So a frame_alloc() pointer stays valid until the end of the NEXT frame
+ * — long enough for anything that compares this frame with the last one.
+ * kernel/src/main.c's display list records each frame's commands there.
+ *
+ * THREAD SAFETY:
+ * --------------
+ * None. An arena belongs to one core. The frame arenas belong to the core
+ * that calls fb_present(); band jobs on other cores must not use them.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "types.h"
+
+#define ARENA_DEFAULT_ALIGN 8
+
+typedef struct {
+    uint8_t *base;
+    size_t   size;
+    size_t   used;
+    size_t   peak;          /* High-water mark of `used`, survives resets */
+    bool     owned;         /* base came from heap_alloc() */
+} arena_t;
+
+/* Position in an arena, from arena_mark() */
+typedef size_t arena_mark_t;
+
+/*
+ * arena_create() - Back an arena with a heap_alloc() chunk
+ *
+ * Returns: false if the heap can't supply `size` bytes
+ */
+bool arena_create(arena_t *arena, size_t size);
+
+/*
+ * arena_init() - Use caller-owned memory (a static buffer, a stack array)
+ */
+void arena_init(arena_t *arena, void *buffer, size_t size);
+
+/*
+ * arena_destroy() - Return an arena_create() chunk to the heap
+ *
+ * Safe on arena_init() arenas too; it just forgets the buffer.
+ */
+void arena_destroy(arena_t *arena);
+
+/*
+ * arena_alloc() - Bump-allocate ARENA_DEFAULT_ALIGN-aligned memory
+ *
+ * Returns: NULL if the arena is full (nothing is consumed in that case)
+ */
+void *arena_alloc(arena_t *arena, size_t size);
+
+/*
+ * arena_alloc_aligned() - Bump-allocate with an explicit alignment
+ *
+ * @param align  Power of two
+ */
+void *arena_alloc_aligned(arena_t *arena, size_t size, size_t align);
+
+static inline arena_mark_t arena_mark(const arena_t *arena)
+{
+    return arena->used;
+}
+
+/* Free everything allocated after `mark` */
+static inline void arena_rewind(arena_t *arena, arena_mark_t mark)
+{
+    if (mark <= arena->used) arena->used = mark;
+}
+
+/* Free everything */
+static inline void arena_reset(arena_t *arena)
+{
+    arena->used = 0;
+}
+
+static inline size_t arena_remaining(const arena_t *arena)
+{
+    return arena->size - arena->used;
+}
+
+
+/* =============================================================================
+ * FRAME ARENAS
+ * =============================================================================
+ */
+
+/*
+ * frame_arena_init() - Create the two frame arenas from the heap
+ *
+ * @param bytes_per_frame  Size of EACH arena
+ *
+ * Returns: false if the heap can't supply both
+ */
+bool frame_arena_init(size_t bytes_per_frame);
+
+/*
+ * frame_alloc() - Allocate memory that lives until the end of next frame
+ *
+ * Returns: NULL if frame_arena_init() wasn't called or this frame's
+ *          arena is full
+ */
+void *frame_alloc(size_t size);
+
+/*
+ * frame_arena_flip() - Switch to the other arena and reset it
+ *
+ * Called by fb_present() after every flip. A no-op until
+ * frame_arena_init() has run.
+ */
+void frame_arena_flip(void);
+
+/*
+ * frame_arena_current() - This frame's arena, for arena_mark()/rewind()
+ *
+ * Returns: NULL before frame_arena_init()
+ */
+arena_t *frame_arena_current(void);
+
+#endif /* ARENA_H */
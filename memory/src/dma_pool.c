@@ -0,0 +1,96 @@
+/*
+ * dma_pool.c - Coherent DMA Buffer Pool Implementation
+ * =====================================================
+ *
+ * See dma_pool.h for the design overview.
+ */
+
+#include "dma_pool.h"
+#include "allocator.h"
+#include "smp.h"
+#include "../../common/src/spinlock.h"
+
+/* Linker symbols — soc/<soc>/linker.ld, .dma_coherent section */
+extern uint8_t __dma_start[];
+extern uint8_t __dma_end[];
+
+static allocator_t g_dma_alloc;
+static spinlock_t  g_dma_lock = SPINLOCK_INIT;
+
+static inline bool dma_pool_lock(void)
+{
+    if (smp_cpu_count() == 1) return false;
+    spin_lock(&g_dma_lock);
+    return true;
+}
+
+static inline void dma_pool_unlock(bool locked)
+{
+    if (locked) spin_unlock(&g_dma_lock);
+}
+
+bool dma_pool_init(void)
+{
+    uintptr_t start = (uintptr_t)__dma_start;
+    uintptr_t end   = (uintptr_t)__dma_end;
+
+    if (end <= start) return false;
+
+    allocator_init(&g_dma_alloc, start, end);
+    return g_dma_alloc.initialized;
+}
+
+bool dma_pool_ready(void)
+{
+    return g_dma_alloc.initialized;
+}
+
+hal_error_t dma_pool_alloc(hal_dma_buf_t *buf, size_t size,
+                           hal_dma_dir_t dir, hal_dma_channel_t ch)
+{
+    if (buf == NULL || size == 0) return HAL_ERROR_INVALID_ARG;
+    if (!g_dma_alloc.initialized) return HAL_ERROR_NOT_INIT;
+
+    size = (size + HAL_DMA_ALIGN - 1) & ~(size_t)(HAL_DMA_ALIGN - 1);
+
+    bool locked = dma_pool_lock();
+    void *p = allocator_alloc(&g_dma_alloc, size, HAL_DMA_ALIGN);
+    dma_pool_unlock(locked);
+
+    if (p == NULL) return HAL_ERROR_NO_MEMORY;
+
+    buf->cpu_addr  = p;
+    buf->dev_addr  = hal_dma_to_device_addr(p);
+    buf->size      = size;
+    buf->direction = dir;
+    buf->channel   = ch;
+    buf->owner     = HAL_DMA_OWNER_CPU;
+    buf->coherent  = DMA_POOL_UNCACHED;
+    return HAL_SUCCESS;
+}
+
+void dma_pool_free(hal_dma_buf_t *buf)
+{
+    if (buf == NULL || buf->cpu_addr == NULL) return;
+
+    bool locked = dma_pool_lock();
+    allocator_free(&g_dma_alloc, buf->cpu_addr);
+    dma_pool_unlock(locked);
+
+    buf->cpu_addr = NULL;
+    buf->dev_addr = 0;
+    buf->size     = 0;
+    buf->coherent = false;
+}
+
+bool dma_pool_owns(const void *addr, size_t size)
+{
+    uintptr_t p = (uintptr_t)addr;
+    return p >= (uintptr_t)__dma_start && p <= (uintptr_t)__dma_end &&
+           size <= (uintptr_t)__dma_end - p;
+}
+
+void dma_pool_stats(size_t *allocated_out, size_t *free_out)
+{
+    allocator_stats(&g_dma_alloc, allocated_out, free_out);
+}
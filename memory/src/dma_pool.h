@@ -0,0 +1,115 @@
+/*
+ * dma_pool.h - Coherent DMA Buffer Pool
+ * ======================================
+ *
+ * hal_dma_prepare()/hal_dma_complete() make a cacheable buffer safe for a
+ * device by cleaning and invalidating it around every transfer. For a
+ * buffer that is handed to hardware over and over (mailbox messages,
+ * audio rings, descriptor tables) that is a cache walk per transfer
+ * spent on memory the CPU barely touches.
+ *
+ * The alternative is to never cache it. The linker script reserves a
+ * 2MB-aligned `.dma_coherent` region between the stack and the heap, and
+ * where the core allows it the boot page tables map it non-cacheable:
+ *
+ *   BCM2710:  boot_soc.S  L2 block descriptors with MAIR Attr2 = 0x44
+ *                         (Normal, Inner/Outer Non-cacheable)
+ *   JH7110:   —           nothing: the U74 has no Svpbmt, so the region
+ *                         stays cached and its buffers come back with
+ *                         coherent = false — still one place to carve
+ *                         device memory from, but maintained like the heap
+ *
+ *   __dma_start                                          __dma_end
+ *    │                                                     │
+ *    ▼                                                     ▼
+ *    ┌──────────┬─────┬──────────────┬───────────────────────┐
+ *    │ mailbox  │ ... │  audio ring  │         free          │  TLSF
+ *    └──────────┴─────┴──────────────┴───────────────────────┘
+ *
+ * Buffers are carved with a private allocator_t — the same TLSF as the
+ * heap, just over a different range — and come back as hal_dma_buf_t
+ * with dev_addr already translated and coherent = DMA_POOL_UNCACHED, so
+ * where the region really is uncached the hal_dma lifecycle calls skip
+ * their cache operations.
+ *
+ * TRADE-OFF:
+ * ----------
+ * Every CPU access to the region goes straight to DRAM. That is right for
+ * buffers the CPU writes once and the device reads (or the other way
+ * round), and wrong for anything the CPU loops over — keep those in the
+ * heap and pay for the maintenance.
+ *
+ * Non-cacheable memory also can't host exclusives on the Cortex-A53, so
+ * nothing in the region may be a spinlock or an atomic. The pool's own
+ * lock and allocator state live in .bss.
+ *
+ * THREAD SAFETY:
+ * --------------
+ * dma_pool_alloc()/dma_pool_free() take the pool lock once secondary
+ * cores are online, like heap_alloc(). Not IRQ-safe.
+ */
+
+#ifndef DMA_POOL_H
+#define DMA_POOL_H
+
+#include "types.h"
+#include "hal_dma.h"
+
+/* Whether the boot page tables map the region non-cacheable (see above) */
+#if defined(SOC_JH7110)
+#define DMA_POOL_UNCACHED   false
+#else
+#define DMA_POOL_UNCACHED   true
+#endif
+
+/*
+ * dma_pool_init() - Hand the linker's .dma_coherent region to the pool
+ *
+ * Called from kernel_main() right after heap_init(). Before this,
+ * dma_pool_alloc() fails and callers fall back to cached buffers.
+ *
+ * Returns: false if the linker script reserved no region
+ */
+bool dma_pool_init(void);
+
+/* True once dma_pool_init() has succeeded */
+bool dma_pool_ready(void);
+
+/*
+ * dma_pool_alloc() - Allocate a coherent DMA buffer
+ *
+ * The buffer is HAL_DMA_ALIGN aligned, its size rounded up to a whole
+ * number of HAL_DMA_ALIGN lines, and its contents are undefined.
+ *
+ * @param buf   Descriptor to fill in: cpu_addr, dev_addr, size, direction,
+ *              channel, owner = CPU, coherent = DMA_POOL_UNCACHED
+ * @param size  Bytes wanted
+ * @param dir   Transfer direction
+ * @param ch    DMA channel the buffer belongs to
+ *
+ * Returns: HAL_SUCCESS, HAL_ERROR_NOT_INIT before dma_pool_init(),
+ *          HAL_ERROR_NO_MEMORY when the region is exhausted
+ */
+hal_error_t dma_pool_alloc(hal_dma_buf_t *buf, size_t size,
+                           hal_dma_dir_t dir, hal_dma_channel_t ch);
+
+/*
+ * dma_pool_free() - Return a buffer and clear its descriptor
+ *
+ * The buffer must be CPU-owned. Safe on a zeroed descriptor.
+ */
+void dma_pool_free(hal_dma_buf_t *buf);
+
+/*
+ * dma_pool_owns() - True if [addr, addr + size) is inside the region
+ *
+ * Works before dma_pool_init() — it only compares against the linker
+ * symbols — so the hal_dma layer can use it to skip maintenance on any
+ * pointer into the region, descriptor or not.
+ */
+bool dma_pool_owns(const void *addr, size_t size);
+
+/* Bytes allocated / still free in the region */
+void dma_pool_stats(size_t *allocated_out, size_t *free_out);
+
+#endif /* DMA_POOL_H */
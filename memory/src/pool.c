@@ -0,0 +1,116 @@
+/*
+ * pool.c - Fixed-Size Object Pool Implementation
+ * ===============================================
+ *
+ * See pool.h for the design overview.
+ *
+ * The slot array is ONE heap_alloc_aligned() block, so the heap's only
+ * cost is at pool_init() and pool_destroy(). heap_alloc_aligned() passes
+ * the alignment through to allocator_alloc(), which slides the payload to
+ * the requested boundary.
+ */
+
+#include "pool.h"
+#include "allocator.h"
+#include "smp.h"
+
+static inline bool pool_lock(pool_t *pool)
+{
+    if (smp_cpu_count() == 1) return false;
+    spin_lock(&pool->lock);
+    return true;
+}
+
+static inline void pool_unlock(pool_t *pool, bool locked)
+{
+    if (locked) spin_unlock(&pool->lock);
+}
+
+bool pool_init(pool_t *pool, size_t elem_size, uint32_t count, size_t align)
+{
+    if (align == 0) align = HAL_DMA_ALIGN;
+    if (elem_size < sizeof(void *)) elem_size = sizeof(void *);
+
+    pool->stride    = (elem_size + align - 1) & ~(align - 1);
+    pool->count     = 0;
+    pool->base      = NULL;
+    pool->free_list = NULL;
+    pool->in_use    = 0;
+    pool->peak      = 0;
+    pool->failures  = 0;
+    spin_lock_init(&pool->lock);
+
+    /* Neither the rounding nor stride × count may wrap */
+    if (pool->stride < elem_size) return false;
+    if (count > SIZE_MAX / pool->stride) return false;
+
+    pool->base = (uint8_t *)heap_alloc_aligned(pool->stride * count, align);
+    if (pool->base == NULL) {
+        return false;
+    }
+    pool->count = count;
+
+    /* Thread in reverse so the first pool_get() returns slot 0 */
+    for (uint32_t i = count; i > 0; i--) {
+        void *slot = pool->base + (size_t)(i - 1) * pool->stride;
+        *(void **)slot = pool->free_list;
+        pool->free_list = slot;
+    }
+    return true;
+}
+
+void pool_destroy(pool_t *pool)
+{
+    heap_free(pool->base);
+    pool->base      = NULL;
+    pool->count     = 0;
+    pool->free_list = NULL;
+    pool->in_use    = 0;
+}
+
+void *pool_get(pool_t *pool)
+{
+    bool locked = pool_lock(pool);
+
+    void *slot = pool->free_list;
+    if (slot) {
+        pool->free_list = *(void **)slot;
+        if (++pool->in_use > pool->peak) {
+            pool->peak = pool->in_use;
+        }
+    } else {
+        pool->failures++;
+    }
+
+    pool_unlock(pool, locked);
+    return slot;
+}
+
+void pool_put(pool_t *pool, void *obj)
+{
+    if (obj == NULL) return;
+
+    bool locked = pool_lock(pool);
+    *(void **)obj = pool->free_list;
+    pool->free_list = obj;
+    pool->in_use--;
+    pool_unlock(pool, locked);
+}
+
+bool pool_owns(const pool_t *pool, const void *obj)
+{
+    uintptr_t p    = (uintptr_t)obj;
+    uintptr_t base = (uintptr_t)pool->base;
+
+    if (p < base || p >= base + pool->stride * pool->count) return false;
+    return (p - base) % pool->stride == 0;
+}
+
+void pool_stats(const pool_t *pool, pool_stats_t *out)
+{
+    out->capacity  = pool->count;
+    out->in_use    = pool->in_use;
+    out->peak      = pool->peak;
+    out->failures  = pool->failures;
+    out->slot_size = pool->stride;
+}
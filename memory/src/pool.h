@@ -0,0 +1,106 @@
+/*
+ * pool.h - Fixed-Size Object Pool
+ * ================================
+ *
+ * For objects that are all the same size and come and go at a high rate
+ * (UI widgets, DMA descriptors, scheduler job records), the general heap
+ * does work nobody needs: headers, footers, size-class lookups and
+ * coalescing. A pool allocates `count` slots up front and keeps the free
+ * ones on an intrusive singly linked list:
+ *
+ *   base
+ *    │
+ *    ▼
+ *    ┌────────┬────────┬────────┬────────┬────────┐
+ *    │ slot 0 │ slot 1 │ slot 2 │ slot 3 │ slot 4 │   stride = elem_size
+ *    │ (used) │ free ──┼────────┼> free ─┼> NULL  │   rounded up to align
+ *    └────────┴────────┴────────┴────────┴────────┘
+ *                 ▲
+ *             free_list
+ *
+ *   pool_get():  pop the head       pool_put():  push onto the head
+ *
+ * A free slot's first word is the link, so there is no per-slot overhead.
+ *
+ * ALIGNMENT:
+ * ----------
+ * Slots default to HAL_DMA_ALIGN (one cache line). Two slots never share
+ * a line, so two cores working on neighbouring objects don't ping-pong
+ * the line between them (false sharing), and a slot can be handed to a
+ * DMA engine and cleaned/invalidated without touching its neighbours.
+ *
+ * THREAD SAFETY:
+ * --------------
+ * pool_get()/pool_put() take the pool's spinlock once secondary cores are
+ * online (same rule as heap_alloc(), see allocator.h). Not IRQ-safe.
+ */
+
+#ifndef POOL_H
+#define POOL_H
+
+#include "types.h"
+#include "hal_dma.h"        /* HAL_DMA_ALIGN */
+#include "../../common/src/spinlock.h"
+
+typedef struct {
+    uint8_t    *base;
+    size_t      stride;         /* Slot size: elem_size rounded up to align */
+    uint32_t    count;
+    void       *free_list;
+    spinlock_t  lock;
+
+    /* Occupancy statistics */
+    uint32_t    in_use;
+    uint32_t    peak;           /* High-water mark of in_use */
+    uint32_t    failures;       /* pool_get() calls that found it empty */
+} pool_t;
+
+typedef struct {
+    uint32_t capacity;
+    uint32_t in_use;
+    uint32_t peak;
+    uint32_t failures;
+    size_t   slot_size;
+} pool_stats_t;
+
+/*
+ * pool_init() - Allocate `count` slots of `elem_size` bytes
+ *
+ * @param pool       Pool state to initialize
+ * @param elem_size  Object size in bytes
+ * @param count      Number of slots
+ * @param align      Slot alignment (power of two), 0 = HAL_DMA_ALIGN
+ *
+ * Returns: false if the heap can't supply the slots, or if their total
+ *          size doesn't fit in a size_t
+ */
+bool pool_init(pool_t *pool, size_t elem_size, uint32_t count, size_t align);
+
+/*
+ * pool_destroy() - Return the slots to the heap
+ *
+ * Every object handed out by the pool becomes invalid.
+ */
+void pool_destroy(pool_t *pool);
+
+/*
+ * pool_get() - Take a slot
+ *
+ * Returns: Pointer to an uninitialized slot, or NULL if the pool is empty
+ */
+void *pool_get(pool_t *pool);
+
+/*
+ * pool_put() - Return a slot (NULL is safe)
+ */
+void pool_put(pool_t *pool, void *obj);
+
+/* True if obj is a slot of this pool (not necessarily an allocated one) */
+bool pool_owns(const pool_t *pool, const void *obj);
+
+void pool_stats(const pool_t *pool, pool_stats_t *out);
+
+/* Typed wrapper: Widget *w = POOL_GET(&widget_pool, Widget); */
+#define POOL_GET(pool, type)    ((type *)pool_get(pool))
+
+#endif /* POOL_H */
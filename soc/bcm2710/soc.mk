@@ -10,14 +10,18 @@ BOOT_SOURCES := \
     boot/arm64/entry.S \
     boot/arm64/vectors.S \
     boot/arm64/cache.S \
+    boot/arm64/memops.S \
     boot/arm64/common_init.S \
     soc/bcm2710/boot_soc.S
 
 # SoC-specific C sources
 SOC_SOURCES := \
     soc/bcm2710/src/timer.c \
+    soc/bcm2710/src/irq.c \
     soc/bcm2710/src/gpio.c \
     soc/bcm2710/src/mailbox.c \
+    soc/bcm2710/src/dma.c \
+    soc/bcm2710/src/mmu.c \
     soc/bcm2710/src/soc_init.c \
     soc/bcm2710/src/display_dpi.c
 
@@ -25,7 +29,43 @@ SOC_SOURCES := \
 SOC_INCLUDES := -Isoc/bcm2710/src/
 
 # Compiler defines
-SOC_DEFINES := -DSOC_BCM2710 -DPERIPHERAL_BASE=0x3F000000
+#   STRING_ARCH_MEMOPS — memset/memcpy/memmove come from boot/arm64/memops.S
+#                        (NEON + DC ZVA); common/src/string.c skips its own.
+SOC_DEFINES := -DSOC_BCM2710 -DPERIPHERAL_BASE=0x3F000000 -DSTRING_ARCH_MEMOPS
+
+# Scan-out buffer memory type (soc/bcm2710/src/mmu.c):
+#   wc      Normal Non-cacheable, no cache maintenance per present (default)
+#   cached  Normal Write-Back, dirty spans cleaned on every present
+#   device  Device-nGnRnE, as the boot page tables leave it
+# Override per board (FB_MAP := cached in board.mk) or per build
+# (make FB_MAP=cached).
+FB_MAP ?= wc
+ifeq ($(FB_MAP),cached)
+SOC_DEFINES += -DFB_MAP_CACHED
+else ifeq ($(FB_MAP),device)
+SOC_DEFINES += -DFB_MAP_DEVICE
+else ifneq ($(FB_MAP),wc)
+$(error FB_MAP must be wc, cached or device)
+endif
+
+# Scan-out buffers (drivers/src/framebuffer/framebuffer.h):
+#   2  double buffering — fb_present waits for the vsync (default)
+#   3  triple buffering — latest frame wins, the renderer never waits
+#   1  single buffer, drawn while it is on screen
+FB_BUFFERS ?= 2
+ifeq ($(filter 1 2 3,$(FB_BUFFERS)),)
+$(error FB_BUFFERS must be 1, 2 or 3)
+endif
+SOC_DEFINES += -DFB_BUFFER_COUNT=$(FB_BUFFERS)
+
+# The VideoCore scans out 32-bit pixels only: build just that raster core
+# (drivers/src/framebuffer/fb_format.h).
+SOC_DEFINES += -DFB_HAVE_RGB565=0
+
+# fb_span.c is built with NEON enabled (see the Makefile special rule).
+# The span kernels run only from thread context, so the vectors don't need
+# to save the extra SIMD registers they use.
+FB_SPAN_CFLAGS := -DFB_SPAN_NEON
 
 # Linker script
 LINKER_SCRIPT := soc/bcm2710/linker.ld
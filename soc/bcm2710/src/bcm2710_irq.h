@@ -0,0 +1,32 @@
+/*
+ * soc/bcm2710/bcm2710_irq.h - BCM2710 Interrupt Dispatch (Internal)
+ *
+ * Tutorial-OS: BCM2710 HAL Implementation
+ *
+ * This is an INTERNAL header - not part of the public HAL API.
+ *
+ * The BCM2710 has two interrupt layers. Peripheral ("GPU") interrupts go
+ * to the legacy controller at PERIPHERAL_BASE + 0xB000, which feeds one
+ * input of the ARM local controller at 0x40000000, which finally asserts
+ * IRQ on a core — core 0 unless GPU_INT_ROUTE says otherwise:
+ *
+ *   system timer C1 ─┐
+ *   DMA, USB, ... ───┼─▶ legacy ENABLE1/2 ─▶ PENDING1/2 ─▶ local GPU input ─▶ core 0 IRQ
+ *   ...           ───┘                                                         │
+ *                                                       vectors.S irq_handler ◀┘
+ *                                                         └─▶ handle_irq() (irq.c)
+ *
+ * Every source starts masked. Drivers enable the ones they service, and
+ * handle_irq() checks each of those by name — there is no handler table.
+ */
+
+#ifndef BCM2710_IRQ_H
+#define BCM2710_IRQ_H
+
+#include "hal_types.h"
+
+/* Unmask / mask a GPU IRQ (BCM_IRQ_* number, 0-63) on the legacy controller */
+void bcm_irq_enable(uint32_t irq);
+void bcm_irq_disable(uint32_t irq);
+
+#endif /* BCM2710_IRQ_H */
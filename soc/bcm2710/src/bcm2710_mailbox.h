@@ -21,11 +21,14 @@
  * MAILBOX BUFFER
  * =============================================================================
  * Must be 16-byte aligned because low 4 bits are used for channel number.
+ * We align to a full cache line (and 36 words pad out to 192 bytes) so
+ * bcm_mailbox_call() can clean and invalidate the buffer without touching
+ * a neighbouring variable that happens to share its first or last line.
  */
 
 typedef struct {
     uint32_t data[36];  /* Buffer for property tags */
-} HAL_ALIGNED(16) bcm_mailbox_buffer_t;
+} HAL_ALIGNED(64) bcm_mailbox_buffer_t;
 
 /* =============================================================================
  * MAILBOX FUNCTIONS
@@ -41,6 +44,119 @@ typedef struct {
  */
 bool bcm_mailbox_call(bcm_mailbox_buffer_t *buffer, uint8_t channel);
 
+/* =============================================================================
+ * ASYNCHRONOUS CALLS
+ * =============================================================================
+ * bcm_mailbox_call() spins twice: until the write FIFO has room, then until
+ * the VideoCore answers — under load the firmware can take longer to reply
+ * than the ARM takes to draw a frame. The asynchronous pair splits the
+ * call so the wait can overlap other work:
+ *
+ *   int t;
+ *   if (HAL_OK(bcm_mailbox_submit(&msg, BCM_MBOX_CH_PROP, &t))) {
+ *       ... draw ...
+ *       while (bcm_mailbox_poll(t, &msg) == HAL_ERROR_BUSY) { ... }
+ *   }
+ *
+ * The message is copied into one of a small ring of coherent buffers from
+ * the DMA pool, so the caller's buffer is free as soon as submit returns.
+ * Only available once dma_pool_init() has run. Blocking and asynchronous
+ * calls can be mixed; either one files replies for the other.
+ */
+
+/*
+ * Queue a message and return without waiting for the reply
+ *
+ * @param msg       Message to copy into the ring
+ * @param channel   Mailbox channel
+ * @param ticket    Output: handle for bcm_mailbox_poll()
+ * @return          HAL_SUCCESS, HAL_ERROR_NOT_INIT before the DMA pool,
+ *                  HAL_ERROR_BUSY if the ring or the write FIFO is full
+ */
+hal_error_t bcm_mailbox_submit(const bcm_mailbox_buffer_t *msg,
+                               uint8_t channel, int *ticket);
+
+/*
+ * Check a submitted message, never blocking
+ *
+ * @param ticket    Handle from bcm_mailbox_submit()
+ * @param reply     Output: the answered message (may be NULL)
+ * @return          HAL_ERROR_BUSY while in flight. Otherwise the ticket is
+ *                  retired: HAL_SUCCESS, or HAL_ERROR_DISPLAY_MAILBOX if
+ *                  the firmware rejected the buffer.
+ */
+hal_error_t bcm_mailbox_poll(int ticket, bcm_mailbox_buffer_t *reply);
+
+/* =============================================================================
+ * BATCHED PROPERTY TRANSACTIONS
+ * =============================================================================
+ * The property channel takes any number of tags in one buffer and answers
+ * them all in one round trip. Every bcm_mailbox_call() is a doorbell, a
+ * spin while the VideoCore firmware wakes up and walks the message, and
+ * the copies in and out of the staging buffer — so six one-tag calls cost
+ * six times what one six-tag call does.
+ *
+ *   bcm_mbox_batch_t b;
+ *   bcm_mbox_batch_begin(&b);
+ *   int arm  = bcm_mbox_batch_add_tag(&b, BCM_TAG_GET_CLOCK_RATE, &id, 1, 2);
+ *   int temp = bcm_mbox_batch_add_tag(&b, BCM_TAG_GET_TEMPERATURE, &z, 1, 2);
+ *   if (bcm_mbox_batch_submit(&b)) {
+ *       const uint32_t *v = bcm_mbox_batch_result(&b, arm);
+ *       if (v) rate = v[1];
+ *   }
+ *
+ * The whole message must fit in bcm_mailbox_buffer_t: 2 header words, per
+ * tag 3 words plus its value buffer, and the end tag. A tag that doesn't
+ * fit is refused (-1) and poisons the batch, so submit fails rather than
+ * sending half a request.
+ */
+
+typedef struct {
+    bcm_mailbox_buffer_t buf;
+    uint32_t             len;       /* Words used, header included */
+    bool                 overflow;  /* A tag didn't fit */
+} bcm_mbox_batch_t;
+
+/*
+ * Start an empty batch
+ */
+void bcm_mbox_batch_begin(bcm_mbox_batch_t *b);
+
+/*
+ * Append a tag
+ *
+ * @param tag         BCM_TAG_* identifier
+ * @param req         Request words (may be NULL if req_words is 0)
+ * @param req_words   Number of request words
+ * @param resp_words  Number of words the firmware answers with
+ * @return            Slot to pass to bcm_mbox_batch_result(), -1 if full
+ */
+int bcm_mbox_batch_add_tag(bcm_mbox_batch_t *b, uint32_t tag,
+                           const uint32_t *req, uint32_t req_words,
+                           uint32_t resp_words);
+
+/*
+ * Terminate the batch and send it on the property channel
+ *
+ * @return  true if the firmware accepted the buffer. Individual tags can
+ *          still fail — check each with bcm_mbox_batch_result().
+ */
+bool bcm_mbox_batch_submit(bcm_mbox_batch_t *b);
+
+/*
+ * Asynchronous submit: bcm_mailbox_submit() on the batch's buffer. Poll
+ * with bcm_mbox_batch_poll() — the reply lands back in the batch, so
+ * bcm_mbox_batch_result() works on it as after a blocking submit.
+ */
+hal_error_t bcm_mbox_batch_submit_async(bcm_mbox_batch_t *b, int *ticket);
+hal_error_t bcm_mbox_batch_poll(bcm_mbox_batch_t *b, int ticket);
+
+/*
+ * Value words of an answered tag, or NULL if the firmware didn't set the
+ * tag's response bit (unknown tag, unsupported clock, ...)
+ */
+const uint32_t *bcm_mbox_batch_result(const bcm_mbox_batch_t *b, int slot);
+
 /* =============================================================================
  * CONVENIENCE FUNCTIONS
  * =============================================================================
@@ -66,6 +182,16 @@ bool bcm_mailbox_get_clock_rate(uint32_t clock_id, uint32_t *rate_hz);
  */
 bool bcm_mailbox_get_clock_measured(uint32_t clock_id, uint32_t *rate_hz);
 
+/*
+ * Get the min and max rate the firmware will set a clock to
+ */
+bool bcm_mailbox_get_clock_limits(uint32_t clock_id, uint32_t *min_hz, uint32_t *max_hz);
+
+/*
+ * Set clock rate; *actual_hz (may be NULL) is the rate the firmware chose
+ */
+bool bcm_mailbox_set_clock_rate(uint32_t clock_id, uint32_t rate_hz, uint32_t *actual_hz);
+
 /*
  * Get temperature in millicelsius
  */
@@ -111,4 +237,9 @@ bool bcm_mailbox_wait_vsync(void);
  */
 bool bcm_mailbox_set_virtual_offset(uint32_t x, uint32_t y);
 
+/*
+ * Optionally wait for vsync, then set the virtual offset — one transaction
+ */
+bool bcm_mailbox_flip(uint32_t x, uint32_t y, bool wait_vsync);
+
 #endif /* BCM2710_MAILBOX_H */
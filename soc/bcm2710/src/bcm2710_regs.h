@@ -43,6 +43,13 @@
 #define BCM_SYSTIMER_C2         (BCM_SYSTIMER_BASE + 0x14)  /* Compare 2 */
 #define BCM_SYSTIMER_C3         (BCM_SYSTIMER_BASE + 0x18)  /* Compare 3 */
 
+/*
+ * CS match bits — set when CLO == Cn, write 1 to clear. C0 and C2 are used
+ * by the VideoCore firmware; C1 and C3 are free for the ARM.
+ */
+#define BCM_SYSTIMER_CS_M1      (1 << 1)
+#define BCM_SYSTIMER_CS_M3      (1 << 3)
+
 /* =============================================================================
  * GPIO
  * =============================================================================
@@ -221,6 +228,56 @@
 
 #define BCM_TAG_END                 0x00000000
 
+/* =============================================================================
+ * DMA CONTROLLER
+ * =============================================================================
+ * BCM2835 ARM Peripherals, chapter 4. Channels 0-6 are full engines with
+ * 2D mode; 7-14 are "lite" (no 2D, half bandwidth); 15 sits elsewhere.
+ * The firmware keeps some channels for itself — Linux's dma-channel-mask
+ * on these boards (0x7F35) leaves 0, 2, 4 and 5 as the full ones it may
+ * use.
+ */
+
+#define BCM_DMA_BASE                (BCM_PERIPHERAL_BASE + 0x00007000)
+#define BCM_DMA_CH(n)               (BCM_DMA_BASE + (n) * 0x100)
+#define BCM_DMA_CS(n)               (BCM_DMA_CH(n) + 0x00)
+#define BCM_DMA_CONBLK_AD(n)        (BCM_DMA_CH(n) + 0x04)
+#define BCM_DMA_DEBUG(n)            (BCM_DMA_CH(n) + 0x20)
+#define BCM_DMA_INT_STATUS          (BCM_DMA_BASE + 0xFE0)
+#define BCM_DMA_ENABLE              (BCM_DMA_BASE + 0xFF0)
+
+/* CS */
+#define BCM_DMA_CS_ACTIVE           (1u << 0)
+#define BCM_DMA_CS_END              (1u << 1)   /* Write 1 to clear */
+#define BCM_DMA_CS_INT              (1u << 2)   /* Write 1 to clear */
+#define BCM_DMA_CS_ERROR            (1u << 8)
+#define BCM_DMA_CS_PRIORITY(p)      ((uint32_t)(p) << 16)
+#define BCM_DMA_CS_PANIC_PRIORITY(p) ((uint32_t)(p) << 20)
+#define BCM_DMA_CS_WAIT_WRITES      (1u << 28)  /* Hold END until writes land */
+#define BCM_DMA_CS_RESET            (1u << 31)
+
+/* DEBUG error flags, write 1 to clear */
+#define BCM_DMA_DEBUG_ERRORS        0x7u
+
+/* Control block transfer information (TI) */
+#define BCM_DMA_TI_INTEN            (1u << 0)
+#define BCM_DMA_TI_TDMODE           (1u << 1)   /* 2D: TXFR_LEN = rows × bytes */
+#define BCM_DMA_TI_WAIT_RESP        (1u << 3)
+#define BCM_DMA_TI_DEST_INC         (1u << 4)
+#define BCM_DMA_TI_DEST_WIDTH       (1u << 5)   /* 128-bit writes */
+#define BCM_DMA_TI_SRC_INC          (1u << 8)
+#define BCM_DMA_TI_SRC_WIDTH        (1u << 9)   /* 128-bit reads */
+#define BCM_DMA_TI_BURST(n)         ((uint32_t)(n) << 12)
+#define BCM_DMA_TI_NO_WIDE_BURSTS   (1u << 26)
+
+/* 2D TXFR_LEN / STRIDE fields */
+#define BCM_DMA_TXFR_XLEN_MAX       0xFFFFu
+#define BCM_DMA_TXFR_YLEN_MAX       0x3FFFu
+#define BCM_DMA_TXFR_2D(rows, bytes) \
+    ((((uint32_t)(rows) - 1) << 16) | (uint32_t)(bytes))
+#define BCM_DMA_STRIDE(dst, src) \
+    (((uint32_t)(uint16_t)(int16_t)(dst) << 16) | (uint16_t)(int16_t)(src))
+
 /* =============================================================================
  * USB (DWC2 OTG Controller)
  * =============================================================================
@@ -350,6 +407,18 @@
 #define BCM_AUX_MU_CNTL             (BCM_AUX_BASE + 0x60)
 #define BCM_AUX_MU_BAUD             (BCM_AUX_BASE + 0x68)
 
+/* =============================================================================
+ * SMI (Secondary Memory Interface)
+ * =============================================================================
+ * Not used as a memory bus here. The firmware pulses its interrupt at every
+ * vertical blank; the SMI_CS interrupt bits say it was us, and writing 0
+ * acknowledges.
+ */
+
+#define BCM_SMI_BASE                (BCM_PERIPHERAL_BASE + 0x00600000)
+#define BCM_SMI_CS                  (BCM_SMI_BASE + 0x00)
+#define BCM_SMI_CS_INTERRUPTS       ((1 << 9) | (1 << 10) | (1 << 11))
+
 /* =============================================================================
  * INTERRUPT CONTROLLER
  * =============================================================================
@@ -367,6 +436,11 @@
 #define BCM_IRQ_DISABLE2            (BCM_IRQ_BASE + 0x220)
 #define BCM_IRQ_DISABLE_BASIC       (BCM_IRQ_BASE + 0x224)
 
+/* GPU IRQ numbers (bit in PENDING1/ENABLE1 for 0-31, PENDING2 for 32-63) */
+#define BCM_IRQ_SYSTIMER_1          1
+#define BCM_IRQ_SYSTIMER_3          3
+#define BCM_IRQ_SMI                 48  /* Firmware vsync signal */
+
 /* =============================================================================
  * ARM LOCAL PERIPHERALS
  * =============================================================================
@@ -376,6 +450,10 @@
 #define BCM_LOCAL_PRESCALER         (BCM_LOCAL_BASE + 0x08)
 #define BCM_LOCAL_GPU_INT_ROUTE     (BCM_LOCAL_BASE + 0x0C)
 
+/* Per-core IRQ source: which of the core's inputs is asserting */
+#define BCM_LOCAL_IRQ_SOURCE(core)  (BCM_LOCAL_BASE + 0x60 + (core) * 0x04)
+#define BCM_LOCAL_IRQ_SRC_GPU       (1 << 8)    /* Legacy controller */
+
 /* Per-core mailboxes (for multicore) */
 #define BCM_LOCAL_MBOX_SET(core)    (BCM_LOCAL_BASE + 0x80 + (core) * 0x10)
 #define BCM_LOCAL_MBOX_CLR(core)    (BCM_LOCAL_BASE + 0xC0 + (core) * 0x10)
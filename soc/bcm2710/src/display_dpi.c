@@ -14,10 +14,12 @@
 #include "hal_display.h"
 #include "hal_gpio.h"
 #include "bcm2710_mailbox.h"
+#include "bcm2710_irq.h"
 
 /* Include the portable framebuffer header for the struct definition */
 /* This header stays in drivers/framebuffer/ */
 #include "framebuffer.h"
+#include "fb_format.h"
 
 /* =============================================================================
  * CONFIGURATION
@@ -25,7 +27,6 @@
  */
 
 #define FB_BITS_PER_PIXEL   32
-#define FB_BUFFER_COUNT     2       /* Double buffering */
 #define FB_DEFAULT_WIDTH    640
 #define FB_DEFAULT_HEIGHT   480
 
@@ -134,12 +135,14 @@ static hal_error_t allocate_framebuffer(uint32_t width, uint32_t height)
     g_framebuffer.virtual_height = virtual_height;
     g_framebuffer.buffer_size = pitch * height;
 
-    g_framebuffer.buffers[0] = (uint32_t *)(uintptr_t)fb_addr;
-    if (FB_BUFFER_COUNT > 1) {
-        g_framebuffer.buffers[1] = (uint32_t *)(uintptr_t)(fb_addr + g_framebuffer.buffer_size);
+    for (uint32_t b = 0; b < FB_BUFFER_COUNT; b++) {
+        g_framebuffer.buffers[b] =
+            (uint32_t *)(uintptr_t)(fb_addr + b * g_framebuffer.buffer_size);
     }
+    g_framebuffer.mem_type = hal_display_map_scanout(fb_addr, fb_size_bytes);
 
     g_framebuffer.front_buffer = 0;
+    g_framebuffer.scan_buffer = 0;
     g_framebuffer.back_buffer = (FB_BUFFER_COUNT > 1) ? 1 : 0;
     g_framebuffer.addr = g_framebuffer.buffers[g_framebuffer.back_buffer];
 
@@ -155,6 +158,11 @@ static hal_error_t allocate_framebuffer(uint32_t width, uint32_t height)
     g_framebuffer.full_dirty = true;
     g_framebuffer.frame_count = 0;
     g_framebuffer.vsync_enabled = true;
+
+    g_framebuffer.pixel_format = FB_FORMAT_ARGB8888;
+    if (!fb_format_bind(&g_framebuffer)) {
+        return HAL_ERROR_NOT_SUPPORTED;
+    }
     g_framebuffer.initialized = true;
 
     return HAL_SUCCESS;
@@ -284,11 +292,6 @@ hal_error_t hal_display_present(framebuffer_t *fb)
         return HAL_ERROR_NOT_INIT;
     }
 
-    /* Wait for vsync if enabled */
-    if (fb->vsync_enabled) {
-        bcm_mailbox_wait_vsync();
-    }
-
     /* Swap buffers */
     if (FB_BUFFER_COUNT > 1) {
         uint32_t temp = fb->front_buffer;
@@ -297,9 +300,14 @@ hal_error_t hal_display_present(framebuffer_t *fb)
         fb->addr = fb->buffers[fb->back_buffer];
     }
 
-    /* Set virtual offset to display front buffer */
-    uint32_t y_offset = fb->front_buffer * fb->height;
-    bcm_mailbox_set_virtual_offset(0, y_offset);
+    /*
+     * Wait for vsync (if enabled) and show the front buffer. Both tags go
+     * in one mailbox transaction; the firmware holds the reply until the
+     * vsync, then applies the offset.
+     */
+    uint32_t y_offset = fb->scroll_rows ? fb->scroll_top       /* Scroll ring */
+                                        : fb->front_buffer * fb->height;
+    bcm_mailbox_flip(0, y_offset, fb->vsync_enabled);
 
     fb->frame_count++;
     fb->full_dirty = false;
@@ -322,7 +330,8 @@ hal_error_t hal_display_present_immediate(framebuffer_t *fb)
         fb->addr = fb->buffers[fb->back_buffer];
     }
 
-    uint32_t y_offset = fb->front_buffer * fb->height;
+    uint32_t y_offset = fb->scroll_rows ? fb->scroll_top       /* Scroll ring */
+                                        : fb->front_buffer * fb->height;
     bcm_mailbox_set_virtual_offset(0, y_offset);
 
     fb->frame_count++;
@@ -350,6 +359,42 @@ hal_error_t hal_display_wait_vsync(void)
     return HAL_ERROR_HARDWARE;
 }
 
+/* =============================================================================
+ * ASYNCHRONOUS FLIP
+ * =============================================================================
+ * The flip itself is framebuffer.c's: fb_flip_display() sends the new
+ * virtual offset, the SMI interrupt (irq.c) completes it.
+ */
+
+hal_error_t hal_display_flip_async(framebuffer_t *fb)
+{
+    if (fb == NULL || !fb->initialized) {
+        return HAL_ERROR_NOT_INIT;
+    }
+
+    fb_present_async(fb);
+    return HAL_SUCCESS;
+}
+
+hal_error_t hal_display_set_frame_callback(framebuffer_t *fb,
+                                           hal_display_frame_fn_t fn,
+                                           void *arg)
+{
+    if (fb == NULL) {
+        return HAL_ERROR_NULL_PTR;
+    }
+
+    fb_set_frame_callback(fb, fn, arg);
+    return HAL_SUCCESS;
+}
+
+hal_error_t hal_display_vsync_irq_init(void)
+{
+    hal_mmio_write32(BCM_SMI_CS, 0);
+    bcm_irq_enable(BCM_IRQ_SMI);
+    return HAL_SUCCESS;
+}
+
 /* =============================================================================
  * DEFAULT CONFIGURATION
  * =============================================================================
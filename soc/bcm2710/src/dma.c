@@ -0,0 +1,359 @@
+/*
+ * soc/bcm2710/dma.c - BCM2710 DMA Coherency Implementation
+ *
+ * Tutorial-OS: BCM2710 HAL Implementation
+ *
+ * Implements the buffer lifecycle from hal_dma.h with the ARM64 cache
+ * maintenance routines in boot/arm64/cache.S and the VideoCore 0xC0000000
+ * bus alias.
+ *
+ * Buffers from the coherent pool (memory/src/dma_pool.h) are mapped
+ * Normal Non-cacheable by build_page_tables, so for those every call
+ * below reduces to a DSB: the stores still have to drain from the write
+ * buffer before the doorbell, but there are no lines to clean.
+ */
+
+#include "hal_dma.h"
+#include "bcm2710_regs.h"
+#include "hal_cache.h"
+#include "../../../memory/src/dma_pool.h"
+
+/* =============================================================================
+ * CACHE MAINTENANCE
+ * =============================================================================
+ * Through hal_cache.h, so a multi-megabyte transfer on one core gets the
+ * set/way clean instead of a line-by-line walk.
+ */
+
+static void dma_maintain(const hal_dma_buf_t *buf, hal_dma_dir_t dir)
+{
+    if (buf->coherent) return;
+
+    uintptr_t start = (uintptr_t)buf->cpu_addr;
+    switch (dir) {
+        case HAL_DMA_TO_DEVICE:
+            hal_dcache_clean(start, buf->size);
+            break;
+        case HAL_DMA_FROM_DEVICE:
+            hal_dcache_invalidate(start, buf->size);
+            break;
+        case HAL_DMA_BIDIRECTIONAL:
+            hal_dcache_flush(start, buf->size);
+            break;
+    }
+}
+
+/* =============================================================================
+ * BUFFER LIFECYCLE
+ * =============================================================================
+ */
+
+hal_error_t hal_dma_prepare(hal_dma_buf_t *buf)
+{
+    if (buf == NULL || buf->cpu_addr == NULL) return HAL_ERROR_NULL_PTR;
+
+    if (!buf->coherent) {
+        buf->dev_addr = hal_dma_to_device_addr(buf->cpu_addr);
+    }
+    dma_maintain(buf, buf->direction);
+    HAL_DSB();
+
+    buf->owner = HAL_DMA_OWNER_DEVICE;
+    return HAL_SUCCESS;
+}
+
+hal_error_t hal_dma_complete(hal_dma_buf_t *buf)
+{
+    if (buf == NULL || buf->cpu_addr == NULL) return HAL_ERROR_NULL_PTR;
+
+    HAL_DSB();
+    if (buf->direction != HAL_DMA_TO_DEVICE) {
+        /*
+         * Invalidate again: the CPU may have speculatively refilled lines
+         * while the device was writing.
+         */
+        dma_maintain(buf, buf->direction);
+    }
+
+    buf->owner = HAL_DMA_OWNER_CPU;
+    return HAL_SUCCESS;
+}
+
+void hal_dma_sync(hal_dma_buf_t *buf, hal_dma_dir_t dir)
+{
+    if (buf == NULL || buf->cpu_addr == NULL) return;
+
+    dma_maintain(buf, dir);
+    HAL_DSB();
+}
+
+/* =============================================================================
+ * ADDRESS TRANSLATION
+ * =============================================================================
+ */
+
+uintptr_t hal_dma_to_device_addr(void *cpu_addr)
+{
+    return BCM_ARM_TO_BUS((uintptr_t)cpu_addr);
+}
+
+uintptr_t hal_dma_to_cpu_addr(uintptr_t dev_addr)
+{
+    return BCM_BUS_TO_ARM(dev_addr);
+}
+
+/* =============================================================================
+ * BARRIERS
+ * =============================================================================
+ */
+
+void hal_dma_channel_barrier(hal_dma_channel_t from_ch, hal_dma_channel_t to_ch)
+{
+    (void)from_ch;
+    (void)to_ch;
+    HAL_DSB();
+}
+
+void hal_dma_full_barrier(void)
+{
+    HAL_DSB();
+}
+
+/* =============================================================================
+ * MAILBOX
+ * =============================================================================
+ */
+
+uintptr_t hal_dma_prepare_mailbox(void *buf, size_t size)
+{
+    if (!dma_pool_owns(buf, size)) {
+        hal_dcache_clean((uintptr_t)buf, size);
+    }
+    __asm__ volatile("dsb st" ::: "memory");
+    return BCM_ARM_TO_BUS((uintptr_t)buf);
+}
+
+void hal_dma_complete_mailbox(void *buf, size_t size)
+{
+    if (!dma_pool_owns(buf, size)) {
+        hal_dcache_invalidate((uintptr_t)buf, size);
+    }
+    HAL_DMB();
+}
+
+/* =============================================================================
+ * 2D TRANSFER ENGINE
+ * =============================================================================
+ * Each logical channel that has an engine gets one full (2D-capable) DMA
+ * channel and a slab of BCM_DMA_CHAIN_MAX control blocks from the coherent
+ * pool. A chain is the first `count` blocks of the slab linked through
+ * NEXTCONBK; the engine walks it from CONBLK_AD and drops ACTIVE after the
+ * block whose NEXTCONBK is 0.
+ *
+ * Completion is polled — CS.ACTIVE — rather than taken as an interrupt:
+ * the only waiter is the renderer, right before it touches pixels again,
+ * and by then a full-screen fill has usually long finished.
+ *
+ * Everything here runs on the boot core, like the framebuffer it serves,
+ * so the engine state has no lock.
+ */
+
+#define BCM_DMA_CHAIN_MAX   8
+#define BCM_DMA_BURST_WORDS 8
+#define BCM_DMA_PRIORITY    8       /* Normal AXI priority, mid-range */
+#define BCM_DMA_PANIC       15
+
+/* Control block: 32 bytes, 32-byte aligned, fetched by bus address */
+typedef struct {
+    uint32_t ti;
+    uint32_t source_ad;
+    uint32_t dest_ad;
+    uint32_t txfr_len;
+    uint32_t stride;
+    uint32_t nextconbk;
+    uint32_t reserved[2];
+} bcm_dma_cb_t;
+
+/* One chain link: the block plus the 16-byte pattern a FILL reads from */
+typedef struct {
+    bcm_dma_cb_t cb;
+    uint32_t     fill[4];
+    uint32_t     pad[4];            /* Links are HAL_DMA_ALIGN apart */
+} bcm_dma_link_t;
+
+typedef struct {
+    hal_dma_buf_t slab;             /* BCM_DMA_CHAIN_MAX links */
+    uint32_t      submitted;        /* Seq of the last chain started */
+    uint32_t      completed;        /* Seq of the last chain seen finished */
+    bool          error;            /* That chain hit a bus error */
+} bcm_dma_engine_t;
+
+static bcm_dma_engine_t g_engines[HAL_DMA_CH_COUNT];
+
+/* Hardware channel behind a logical one; -1 if it has no engine */
+static int bcm_dma_hw_channel(hal_dma_channel_t ch)
+{
+    switch (ch) {
+        case HAL_DMA_CH_DISPLAY: return 5;
+        case HAL_DMA_CH_GENERIC: return 4;
+        default:                 return -1;
+    }
+}
+
+static hal_error_t engine_open(hal_dma_channel_t ch, bcm_dma_engine_t **out)
+{
+    int hw = bcm_dma_hw_channel(ch);
+    if (hw < 0) return HAL_ERROR_NOT_SUPPORTED;
+
+    bcm_dma_engine_t *e = &g_engines[ch];
+    if (e->slab.cpu_addr == NULL) {
+        hal_error_t err = dma_pool_alloc(&e->slab,
+                                         BCM_DMA_CHAIN_MAX * sizeof(bcm_dma_link_t),
+                                         HAL_DMA_TO_DEVICE, ch);
+        if (HAL_FAILED(err)) return err;
+
+        hal_mmio_write32(BCM_DMA_ENABLE,
+                         hal_mmio_read32(BCM_DMA_ENABLE) | (1u << hw));
+        hal_mmio_write32(BCM_DMA_CS(hw), BCM_DMA_CS_RESET);
+        while (hal_mmio_read32(BCM_DMA_CS(hw)) & BCM_DMA_CS_RESET) {
+            HAL_NOP();
+        }
+    }
+    *out = e;
+    return HAL_SUCCESS;
+}
+
+/* Note a finished chain; ERROR ends the chain too, leaving the channel paused */
+static void engine_retire(bcm_dma_engine_t *e, int hw)
+{
+    if (e->completed == e->submitted) return;
+
+    uint32_t cs = hal_mmio_read32(BCM_DMA_CS(hw));
+    if ((cs & BCM_DMA_CS_ERROR) != 0) {
+        hal_mmio_write32(BCM_DMA_DEBUG(hw), BCM_DMA_DEBUG_ERRORS);
+        hal_mmio_write32(BCM_DMA_CS(hw), BCM_DMA_CS_RESET);
+        e->error = true;
+    } else if ((cs & BCM_DMA_CS_ACTIVE) == 0) {
+        hal_mmio_write32(BCM_DMA_CS(hw), BCM_DMA_CS_END);
+        e->error = false;
+    } else {
+        return;
+    }
+    HAL_DMB();      /* The engine's writes before the CPU's next reads */
+    e->completed = e->submitted;
+}
+
+static bool engine_signaled(bcm_dma_engine_t *e, int hw, uint32_t seq)
+{
+    engine_retire(e, hw);
+    return (int32_t)(e->completed - seq) >= 0;
+}
+
+static bool fits_i16(int32_t v)
+{
+    return v >= -32768 && v <= 32767;
+}
+
+/*
+ * Encode one transfer as a 2D control block; false if the engine can't
+ * express it. Strides are what the engine adds after each row, so they
+ * are pitch minus row length — negative for bottom-up walks.
+ */
+static bool encode_link(bcm_dma_link_t *link, uint32_t link_bus,
+                        const hal_dma_2d_t *x)
+{
+    bool      fill = (x->op == HAL_DMA_2D_FILL);
+    uintptr_t dst  = (uintptr_t)x->dst;
+    uintptr_t src  = (uintptr_t)x->src;
+    int32_t   dstride = x->dst_pitch - (int32_t)x->row_bytes;
+    int32_t   sstride = fill ? 0 : x->src_pitch - (int32_t)x->row_bytes;
+
+    if (x->rows == 0 || x->rows - 1 > BCM_DMA_TXFR_YLEN_MAX) return false;
+    if (x->row_bytes == 0 || x->row_bytes > BCM_DMA_TXFR_XLEN_MAX) return false;
+    if (((dst | x->row_bytes) & 3) != 0) return false;
+    if (!fill && (src & 3) != 0) return false;
+    if (!fits_i16(dstride) || !fits_i16(sstride)) return false;
+
+    /* 128-bit beats when every row start stays on a 16-byte boundary */
+    bool wide = ((dst | x->row_bytes | (uint32_t)x->dst_pitch) & 15) == 0 &&
+                (fill || ((src | (uint32_t)x->src_pitch) & 15) == 0);
+
+    uint32_t ti = BCM_DMA_TI_TDMODE | BCM_DMA_TI_WAIT_RESP |
+                  BCM_DMA_TI_DEST_INC | BCM_DMA_TI_BURST(BCM_DMA_BURST_WORDS);
+    if (wide) ti |= BCM_DMA_TI_DEST_WIDTH | BCM_DMA_TI_SRC_WIDTH;
+    if (!fill) ti |= BCM_DMA_TI_SRC_INC;
+
+    for (int i = 0; i < 4; i++) link->fill[i] = x->fill;
+
+    link->cb.ti        = ti;
+    link->cb.source_ad = fill ? link_bus + (uint32_t)sizeof(bcm_dma_cb_t)
+                              : (uint32_t)hal_dma_to_device_addr((void *)src);
+    link->cb.dest_ad   = (uint32_t)hal_dma_to_device_addr((void *)dst);
+    link->cb.txfr_len  = BCM_DMA_TXFR_2D(x->rows, x->row_bytes);
+    link->cb.stride    = BCM_DMA_STRIDE(dstride, sstride);
+    return true;
+}
+
+hal_error_t hal_dma_2d_submit(hal_dma_channel_t ch, const hal_dma_2d_t *xfers,
+                              uint32_t count, hal_dma_fence_t *fence_out)
+{
+    if (xfers == NULL) return HAL_ERROR_NULL_PTR;
+    if (count == 0 || count > BCM_DMA_CHAIN_MAX) return HAL_ERROR_INVALID_ARG;
+
+    bcm_dma_engine_t *e;
+    hal_error_t err = engine_open(ch, &e);
+    if (HAL_FAILED(err)) return err;
+
+    int hw = bcm_dma_hw_channel(ch);
+
+    /* One chain at a time: the slab is about to be rewritten */
+    while (!engine_signaled(e, hw, e->submitted)) {
+        HAL_NOP();
+    }
+
+    bcm_dma_link_t *links = (bcm_dma_link_t *)e->slab.cpu_addr;
+    uint32_t        bus   = (uint32_t)e->slab.dev_addr;
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t link_bus = bus + i * (uint32_t)sizeof(bcm_dma_link_t);
+
+        if (!encode_link(&links[i], link_bus, &xfers[i])) {
+            return HAL_ERROR_INVALID_ARG;
+        }
+        links[i].cb.nextconbk = (i + 1 == count) ? 0 :
+                                link_bus + (uint32_t)sizeof(bcm_dma_link_t);
+    }
+
+    /* The blocks and every pixel store before them, out before the doorbell */
+    HAL_DSB();
+
+    if (++e->submitted == 0) e->submitted = 1;      /* seq 0 means "none" */
+    hal_mmio_write32(BCM_DMA_CONBLK_AD(hw), bus);
+    hal_mmio_write32(BCM_DMA_CS(hw), BCM_DMA_CS_ACTIVE | BCM_DMA_CS_WAIT_WRITES |
+                                     BCM_DMA_CS_PRIORITY(BCM_DMA_PRIORITY) |
+                                     BCM_DMA_CS_PANIC_PRIORITY(BCM_DMA_PANIC));
+
+    if (fence_out) {
+        fence_out->channel = ch;
+        fence_out->seq     = e->submitted;
+    }
+    return HAL_SUCCESS;
+}
+
+bool hal_dma_fence_signaled(hal_dma_fence_t fence)
+{
+    int hw = bcm_dma_hw_channel(fence.channel);
+    if (fence.seq == 0 || hw < 0) return true;
+    return engine_signaled(&g_engines[fence.channel], hw, fence.seq);
+}
+
+hal_error_t hal_dma_fence_wait(hal_dma_fence_t fence)
+{
+    while (!hal_dma_fence_signaled(fence)) {
+        HAL_NOP();
+    }
+
+    const bcm_dma_engine_t *e = &g_engines[fence.channel];
+    bool failed = fence.seq != 0 && fence.seq == e->completed && e->error;
+    return failed ? HAL_ERROR_HARDWARE : HAL_SUCCESS;
+}
@@ -276,6 +276,25 @@ uint32_t hal_gpio_read_mask(uint32_t bank)
     return 0;
 }
 
+hal_error_t hal_gpio_get_port(uint32_t bank, hal_gpio_port_t *port)
+{
+    if (port == NULL) {
+        return HAL_ERROR_NULL_PTR;
+    }
+    if (bank > 1) {
+        return HAL_ERROR_INVALID_ARG;
+    }
+
+    /*
+     * GPSET1/GPCLR1 sit one word after GPSET0/GPCLR0. A bit written to a
+     * pin that isn't an output only sets its latch; the pad follows once
+     * the pin is made an output.
+     */
+    port->set   = (volatile uint32_t *)(uintptr_t)(BCM_GPSET0 + bank * 4);
+    port->clear = (volatile uint32_t *)(uintptr_t)(BCM_GPCLR0 + bank * 4);
+    return HAL_SUCCESS;
+}
+
 /* =============================================================================
  * PERIPHERAL CONFIGURATION
  * =============================================================================
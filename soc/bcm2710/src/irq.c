@@ -0,0 +1,89 @@
+/*
+ * soc/bcm2710/irq.c - BCM2710 Interrupt Dispatch
+ *
+ * Tutorial-OS: BCM2710 HAL Implementation
+ *
+ * Provides handle_irq(), which overrides the weak default in
+ * boot/arm64/vectors.S. irq_handler has already saved the interrupted
+ * context (and q0-q3); we find out which source fired, acknowledge it at
+ * the device, and call the driver.
+ *
+ * Only peripheral interrupts routed through the legacy controller are
+ * handled. The per-core local sources (generic timers, mailboxes, PMU)
+ * stay disabled.
+ */
+
+#include "bcm2710_irq.h"
+#include "bcm2710_regs.h"
+#include "hal_timer.h"
+#include "hal_display.h"
+
+/* =============================================================================
+ * LEGACY CONTROLLER
+ * =============================================================================
+ */
+
+static bool g_irq_masked_all;
+
+/*
+ * The firmware can leave sources enabled. An enabled source nobody
+ * acknowledges is a level that never drops — handle_irq() would be
+ * re-entered forever — so the first enable masks everything else.
+ */
+static void bcm_irq_mask_all(void)
+{
+    hal_mmio_write32(BCM_IRQ_DISABLE1, 0xFFFFFFFF);
+    hal_mmio_write32(BCM_IRQ_DISABLE2, 0xFFFFFFFF);
+    hal_mmio_write32(BCM_IRQ_DISABLE_BASIC, 0xFFFFFFFF);
+    g_irq_masked_all = true;
+}
+
+void bcm_irq_enable(uint32_t irq)
+{
+    if (!g_irq_masked_all) bcm_irq_mask_all();
+
+    if (irq < 32) {
+        hal_mmio_write32(BCM_IRQ_ENABLE1, 1u << irq);
+    } else if (irq < 64) {
+        hal_mmio_write32(BCM_IRQ_ENABLE2, 1u << (irq - 32));
+    }
+}
+
+void bcm_irq_disable(uint32_t irq)
+{
+    if (irq < 32) {
+        hal_mmio_write32(BCM_IRQ_DISABLE1, 1u << irq);
+    } else if (irq < 64) {
+        hal_mmio_write32(BCM_IRQ_DISABLE2, 1u << (irq - 32));
+    }
+}
+
+/* =============================================================================
+ * DISPATCH
+ * =============================================================================
+ */
+
+void handle_irq(void *context)
+{
+    (void)context;
+
+    uint32_t pending1 = hal_mmio_read32(BCM_IRQ_PENDING1);
+    uint32_t pending2 = hal_mmio_read32(BCM_IRQ_PENDING2);
+
+    if (pending2 & (1u << (BCM_IRQ_SMI - 32))) {
+        /*
+         * Vsync first: a flip completing late is visible, a timer isn't.
+         * Ack whatever raised the line, even with no vsync bit to show for
+         * it — an unacked source would re-enter handle_irq() forever.
+         */
+        uint32_t cs = hal_mmio_read32(BCM_SMI_CS);
+        hal_mmio_write32(BCM_SMI_CS, 0);
+        if (cs & BCM_SMI_CS_INTERRUPTS) hal_display_vsync_irq();
+    }
+
+    if (pending1 & (1u << BCM_IRQ_SYSTIMER_1)) {
+        /* Match bits latch: clear before the queue reprograms C1 */
+        hal_mmio_write32(BCM_SYSTIMER_CS, BCM_SYSTIMER_CS_M1);
+        hal_timer_irq();
+    }
+}
@@ -11,6 +11,95 @@
 
 #include "bcm2710_mailbox.h"
 #include "hal_types.h"
+#include "hal_dma.h"
+#include "smp.h"
+#include "../../../common/src/spinlock.h"
+#include "../../../memory/src/dma_pool.h"
+
+/* =============================================================================
+ * COHERENT STAGING BUFFER
+ * =============================================================================
+ * Callers build messages in ordinary (cacheable) stack buffers. Once the
+ * DMA pool is up, bcm_mailbox_call() copies the message into one buffer
+ * from the pool — mapped non-cacheable — rings the doorbell on that, and
+ * copies the reply back. The copy touches data[0] bytes, usually 32; the
+ * clean + invalidate it replaces walked the whole 144-byte buffer by
+ * cache line on every call.
+ *
+ * Before dma_pool_init() (soc_init, early platform queries) the caller's
+ * buffer is used directly and hal_dma_prepare_mailbox() cleans it.
+ */
+
+static hal_dma_buf_t g_mbox_stage;
+static spinlock_t    g_mbox_lock = SPINLOCK_INIT;
+
+static bcm_mailbox_buffer_t *mbox_stage(void)
+{
+    if (g_mbox_stage.cpu_addr == NULL && dma_pool_ready()) {
+        dma_pool_alloc(&g_mbox_stage, sizeof(bcm_mailbox_buffer_t),
+                       HAL_DMA_BIDIRECTIONAL, HAL_DMA_CH_MAILBOX);
+    }
+    return (bcm_mailbox_buffer_t *)g_mbox_stage.cpu_addr;
+}
+
+/* Words of the message, from its size header, clamped to the buffer */
+static uint32_t mbox_words(const bcm_mailbox_buffer_t *buffer)
+{
+    uint32_t words = (buffer->data[0] + 3) / 4;
+    uint32_t max   = sizeof(buffer->data) / sizeof(buffer->data[0]);
+    return words > max ? max : words;
+}
+
+/* =============================================================================
+ * IN-FLIGHT RING
+ * =============================================================================
+ * bcm_mailbox_submit() copies a message into one of these coherent slots,
+ * rings the doorbell and returns. The VideoCore answers through the same
+ * READ FIFO the blocking call waits on, echoing the bus address it was
+ * given, so a reply is matched to its slot by address — whoever happens
+ * to be reading the FIFO (a poll or a blocking call) marks it done.
+ *
+ * Four slots: one batched telemetry query in flight plus headroom. All
+ * ring state is under g_mbox_lock.
+ */
+
+#define MBOX_RING_SIZE  4
+
+enum { MBOX_SLOT_FREE, MBOX_SLOT_INFLIGHT, MBOX_SLOT_DONE };
+
+typedef struct {
+    hal_dma_buf_t dma;
+    uint32_t      bus;          /* Address | channel, as written */
+    uint32_t      words;
+    uint8_t       state;
+} mbox_slot_t;
+
+static mbox_slot_t g_mbox_ring[MBOX_RING_SIZE];
+
+static inline bool mbox_lock(void)
+{
+    if (smp_cpu_count() == 1) return false;
+    spin_lock(&g_mbox_lock);
+    return true;
+}
+
+static inline void mbox_unlock(bool locked)
+{
+    if (locked) spin_unlock(&g_mbox_lock);
+}
+
+/* Hand a FIFO word to the ring slot it answers. False if it isn't one. */
+static bool mbox_dispatch(uint32_t response)
+{
+    for (int i = 0; i < MBOX_RING_SIZE; i++) {
+        mbox_slot_t *slot = &g_mbox_ring[i];
+        if (slot->state == MBOX_SLOT_INFLIGHT && slot->bus == response) {
+            slot->state = MBOX_SLOT_DONE;
+            return true;
+        }
+    }
+    return false;
+}
 
 /* =============================================================================
  * CORE MAILBOX CALL
@@ -19,14 +108,24 @@
 
 bool bcm_mailbox_call(bcm_mailbox_buffer_t *buffer, uint8_t channel)
 {
-    uint32_t addr = (uint32_t)(uintptr_t)buffer;
+    bool locked = mbox_lock();
+
+    bcm_mailbox_buffer_t *stage = mbox_stage();
+    bcm_mailbox_buffer_t *msg   = stage ? stage : buffer;
+    uint32_t words = mbox_words(buffer);
+
+    if (stage) {
+        for (uint32_t i = 0; i < words; i++) stage->data[i] = buffer->data[i];
+    }
 
     /*
-     * Convert ARM physical address to VC bus address.
-     * The VideoCore sees memory through a different mapping than the ARM core.
+     * The VideoCore reads and writes the buffer in DRAM; it never sees the
+     * ARM's caches. hal_dma_prepare_mailbox() cleans a cacheable buffer
+     * (a no-op for the coherent stage), drains the stores with DSB ST and
+     * converts the ARM physical address to the VC bus address:
      * 0xC0000000 = L2 cache coherent alias (required for mailbox DMA).
      */
-    addr = BCM_ARM_TO_BUS(addr);
+    uint32_t addr = (uint32_t)hal_dma_prepare_mailbox(msg, sizeof(*msg));
 
     /* Wait for mailbox to not be full */
     while ((hal_mmio_read32(BCM_MBOX_STATUS) & BCM_MBOX_FULL) != 0) {
@@ -34,7 +133,8 @@ bool bcm_mailbox_call(bcm_mailbox_buffer_t *buffer, uint8_t channel)
     }
 
     /* Write address with channel in low 4 bits */
-    hal_mmio_write32(BCM_MBOX_WRITE, (addr & ~0xF) | (channel & 0xF));
+    uint32_t request = (addr & ~0xF) | (channel & 0xF);
+    hal_mmio_write32(BCM_MBOX_WRITE, request);
 
     /* Wait for response */
     while (1) {
@@ -46,11 +146,186 @@ bool bcm_mailbox_call(bcm_mailbox_buffer_t *buffer, uint8_t channel)
         /* Read response */
         uint32_t response = hal_mmio_read32(BCM_MBOX_READ);
 
-        /* Check if it's for our channel */
-        if ((response & 0xF) == channel) {
-            return buffer->data[1] == BCM_MBOX_RESPONSE_OK;
+        /*
+         * Ours, or an asynchronous request that finished first? Anything
+         * else on our channel is a stray reply — take it as ours, as this
+         * loop always has.
+         */
+        if (response == request) {
+            break;
+        }
+        if (!mbox_dispatch(response) && (response & 0xF) == channel) {
+            break;
+        }
+    }
+
+    hal_dma_complete_mailbox(msg, sizeof(*msg));
+    if (stage) {
+        for (uint32_t i = 0; i < words; i++) buffer->data[i] = stage->data[i];
+    }
+
+    mbox_unlock(locked);
+    return buffer->data[1] == BCM_MBOX_RESPONSE_OK;
+}
+
+/* =============================================================================
+ * ASYNCHRONOUS CALLS
+ * =============================================================================
+ */
+
+hal_error_t bcm_mailbox_submit(const bcm_mailbox_buffer_t *msg,
+                               uint8_t channel, int *ticket)
+{
+    if (msg == NULL || ticket == NULL) return HAL_ERROR_NULL_PTR;
+    if (!dma_pool_ready()) return HAL_ERROR_NOT_INIT;
+
+    bool locked = mbox_lock();
+    hal_error_t err = HAL_ERROR_BUSY;
+
+    if (hal_mmio_read32(BCM_MBOX_STATUS) & BCM_MBOX_FULL) {
+        goto out;
+    }
+
+    for (int i = 0; i < MBOX_RING_SIZE; i++) {
+        mbox_slot_t *slot = &g_mbox_ring[i];
+        if (slot->state != MBOX_SLOT_FREE) continue;
+
+        if (slot->dma.cpu_addr == NULL) {
+            err = dma_pool_alloc(&slot->dma, sizeof(bcm_mailbox_buffer_t),
+                                 HAL_DMA_BIDIRECTIONAL, HAL_DMA_CH_MAILBOX);
+            if (!HAL_OK(err)) goto out;
+        }
+
+        bcm_mailbox_buffer_t *stage = slot->dma.cpu_addr;
+        slot->words = mbox_words(msg);
+        for (uint32_t w = 0; w < slot->words; w++) {
+            stage->data[w] = msg->data[w];
+        }
+
+        uint32_t addr = (uint32_t)hal_dma_prepare_mailbox(stage,
+                                                          sizeof(*stage));
+        slot->bus   = (addr & ~0xF) | (channel & 0xF);
+        slot->state = MBOX_SLOT_INFLIGHT;
+        hal_mmio_write32(BCM_MBOX_WRITE, slot->bus);
+
+        *ticket = i;
+        err = HAL_SUCCESS;
+        break;
+    }
+
+out:
+    mbox_unlock(locked);
+    return err;
+}
+
+hal_error_t bcm_mailbox_poll(int ticket, bcm_mailbox_buffer_t *reply)
+{
+    if (ticket < 0 || ticket >= MBOX_RING_SIZE) return HAL_ERROR_INVALID_ARG;
+
+    mbox_slot_t *slot = &g_mbox_ring[ticket];
+    bool locked = mbox_lock();
+
+    if (slot->state == MBOX_SLOT_FREE) {
+        mbox_unlock(locked);
+        return HAL_ERROR_INVALID_ARG;
+    }
+
+    /* Drain whatever has arrived; replies nobody is waiting for are dropped */
+    while (slot->state == MBOX_SLOT_INFLIGHT &&
+           (hal_mmio_read32(BCM_MBOX_STATUS) & BCM_MBOX_EMPTY) == 0) {
+        mbox_dispatch(hal_mmio_read32(BCM_MBOX_READ));
+    }
+
+    if (slot->state == MBOX_SLOT_INFLIGHT) {
+        mbox_unlock(locked);
+        return HAL_ERROR_BUSY;
+    }
+
+    bcm_mailbox_buffer_t *stage = slot->dma.cpu_addr;
+    hal_dma_complete_mailbox(stage, sizeof(*stage));
+    if (reply) {
+        for (uint32_t w = 0; w < slot->words; w++) {
+            reply->data[w] = stage->data[w];
         }
     }
+    bool ok = stage->data[1] == BCM_MBOX_RESPONSE_OK;
+    slot->state = MBOX_SLOT_FREE;
+
+    mbox_unlock(locked);
+    return ok ? HAL_SUCCESS : HAL_ERROR_DISPLAY_MAILBOX;
+}
+
+/* =============================================================================
+ * BATCHED PROPERTY TRANSACTIONS
+ * =============================================================================
+ */
+
+#define MBOX_BATCH_WORDS    (sizeof(((bcm_mailbox_buffer_t *)0)->data) / 4)
+#define MBOX_TAG_RESPONSE   0x80000000u     /* Set in the tag's code word */
+
+void bcm_mbox_batch_begin(bcm_mbox_batch_t *b)
+{
+    b->buf.data[0] = 0;
+    b->buf.data[1] = BCM_MBOX_REQUEST;
+    b->len      = 2;
+    b->overflow = false;
+}
+
+int bcm_mbox_batch_add_tag(bcm_mbox_batch_t *b, uint32_t tag,
+                           const uint32_t *req, uint32_t req_words,
+                           uint32_t resp_words)
+{
+    uint32_t words = req_words > resp_words ? req_words : resp_words;
+
+    /* Tag header + value buffer, leaving room for the end tag */
+    if (b->overflow || b->len + 3 + words + 1 > MBOX_BATCH_WORDS) {
+        b->overflow = true;
+        return -1;
+    }
+
+    uint32_t *t = &b->buf.data[b->len];
+    t[0] = tag;
+    t[1] = words * 4;                   /* Value buffer size */
+    t[2] = req_words * 4;               /* Request size */
+    for (uint32_t i = 0; i < words; i++) {
+        t[3 + i] = i < req_words ? req[i] : 0;
+    }
+
+    int slot = (int)b->len;
+    b->len += 3 + words;
+    return slot;
+}
+
+bool bcm_mbox_batch_submit(bcm_mbox_batch_t *b)
+{
+    if (b->overflow) return false;
+
+    b->buf.data[b->len] = BCM_TAG_END;
+    b->buf.data[0] = (b->len + 1) * 4;
+    return bcm_mailbox_call(&b->buf, BCM_MBOX_CH_PROP);
+}
+
+hal_error_t bcm_mbox_batch_submit_async(bcm_mbox_batch_t *b, int *ticket)
+{
+    if (b->overflow) return HAL_ERROR_INVALID_ARG;
+
+    b->buf.data[b->len] = BCM_TAG_END;
+    b->buf.data[0] = (b->len + 1) * 4;
+    return bcm_mailbox_submit(&b->buf, BCM_MBOX_CH_PROP, ticket);
+}
+
+hal_error_t bcm_mbox_batch_poll(bcm_mbox_batch_t *b, int ticket)
+{
+    return bcm_mailbox_poll(ticket, &b->buf);
+}
+
+const uint32_t *bcm_mbox_batch_result(const bcm_mbox_batch_t *b, int slot)
+{
+    if (slot < 0 || (uint32_t)slot + 3 > b->len) return NULL;
+
+    const uint32_t *t = &b->buf.data[slot];
+    if ((t[2] & MBOX_TAG_RESPONSE) == 0) return NULL;
+    return &t[3];
 }
 
 /* =============================================================================
@@ -149,6 +424,61 @@ bool bcm_mailbox_get_clock_measured(uint32_t clock_id, uint32_t *rate_hz)
     return true;
 }
 
+/* Two tags, one round trip */
+bool bcm_mailbox_get_clock_limits(uint32_t clock_id, uint32_t *min_hz, uint32_t *max_hz)
+{
+    bcm_mbox_batch_t b;
+
+    bcm_mbox_batch_begin(&b);
+    int lo = bcm_mbox_batch_add_tag(&b, BCM_TAG_GET_MIN_CLOCK_RATE, &clock_id, 1, 2);
+    int hi = bcm_mbox_batch_add_tag(&b, BCM_TAG_GET_MAX_CLOCK_RATE, &clock_id, 1, 2);
+    if (!bcm_mbox_batch_submit(&b)) {
+        return false;
+    }
+
+    const uint32_t *vlo = bcm_mbox_batch_result(&b, lo);
+    const uint32_t *vhi = bcm_mbox_batch_result(&b, hi);
+    if (vlo == NULL || vhi == NULL || vlo[1] == 0 || vhi[1] == 0) {
+        return false;
+    }
+
+    if (min_hz) *min_hz = vlo[1];
+    if (max_hz) *max_hz = vhi[1];
+    return true;
+}
+
+/*
+ * Request: clock id, rate, skip_setting_turbo. Response: clock id, rate.
+ * skip_setting_turbo = 0 lets the firmware raise the core voltage along
+ * with the ARM clock, as it would for its own turbo.
+ */
+bool bcm_mailbox_set_clock_rate(uint32_t clock_id, uint32_t rate_hz, uint32_t *actual_hz)
+{
+    bcm_mailbox_buffer_t mbox = { .data = {0} };
+
+    mbox.data[0] = 9 * 4;
+    mbox.data[1] = BCM_MBOX_REQUEST;
+    mbox.data[2] = BCM_TAG_SET_CLOCK_RATE;
+    mbox.data[3] = 12;
+    mbox.data[4] = 12;
+    mbox.data[5] = clock_id;
+    mbox.data[6] = rate_hz;
+    mbox.data[7] = 0;                   /* skip_setting_turbo */
+    mbox.data[8] = BCM_TAG_END;
+
+    if (!bcm_mailbox_call(&mbox, BCM_MBOX_CH_PROP)) {
+        return false;
+    }
+
+    /* Rate 0: the firmware refused (unknown clock, or out of range) */
+    if (mbox.data[6] == 0) {
+        return false;
+    }
+
+    if (actual_hz) *actual_hz = mbox.data[6];
+    return true;
+}
+
 /* =============================================================================
  * TEMPERATURE
  * =============================================================================
@@ -347,3 +677,25 @@ bool bcm_mailbox_set_virtual_offset(uint32_t x, uint32_t y)
 
     return bcm_mailbox_call(&mbox, BCM_MBOX_CH_PROP);
 }
+
+/*
+ * The double-buffered present is "wait for the next vsync, then point
+ * scan-out at the other half" — two tags the firmware handles back to
+ * back, so send them together and pay one round trip per frame.
+ */
+bool bcm_mailbox_flip(uint32_t x, uint32_t y, bool wait_vsync)
+{
+    bcm_mbox_batch_t b;
+    uint32_t zero = 0;
+    uint32_t offset[2] = { x, y };
+
+    bcm_mbox_batch_begin(&b);
+    if (wait_vsync) {
+        bcm_mbox_batch_add_tag(&b, BCM_TAG_WAIT_FOR_VSYNC, &zero, 1, 1);
+    }
+    int set = bcm_mbox_batch_add_tag(&b, BCM_TAG_SET_VIRTUAL_OFFSET,
+                                     offset, 2, 2);
+
+    if (!bcm_mbox_batch_submit(&b)) return false;
+    return bcm_mbox_batch_result(&b, set) != NULL;
+}
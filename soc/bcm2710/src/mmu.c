@@ -0,0 +1,193 @@
+/*
+ * soc/bcm2710/mmu.c - Run-Time Changes to the Boot Page Tables
+ *
+ * Tutorial-OS: BCM2710 HAL Implementation
+ *
+ * build_page_tables (boot_soc.S) maps the first 1GB with 2MB L2 blocks,
+ * before anything is known about the framebuffer: the VideoCore only
+ * hands one out when fb_init() asks, long after the MMU is on. So the
+ * carve-out above ARM RAM — where the buffer lands — starts out with the
+ * "past end of RAM" attribute, Device-nGnRnE, and the framebuffer's
+ * memory type is chosen here once its address is known.
+ *
+ * SCAN-OUT MEMORY TYPES (FB_MAP= in soc.mk):
+ * ------------------------------------------
+ *   cached   Normal Write-Back (Attr1). Draws run at cache speed, blends
+ *            and copy-forward read from L1/L2. Every present cleans the
+ *            dirty spans line by line with DC CVAC.
+ *
+ *   wc       Normal Non-cacheable (Attr2) — the A53's write-combining
+ *            type. Stores to adjacent addresses merge in the write buffer
+ *            and go out as bursts; no cache maintenance at all. Reads go
+ *            to DRAM, so alpha blending and copy-forward's read of the
+ *            front buffer are the slow part. The default.
+ *
+ *   device   Device-nGnRnE (Attr0), what the boot tables give the region.
+ *            Every store is its own uncombined bus write, and unaligned
+ *            accesses and DC ZVA fault — kept as a reference point.
+ *
+ * Which wins depends on the mix of fills, blends and copies a board does
+ * per frame. The "flush" and "raster" profiling zones (kernel/src/prof.h)
+ * show both sides of the trade; build each mode and compare the [prof]
+ * lines on the UART.
+ *
+ * BREAK-BEFORE-MAKE:
+ * ------------------
+ * The architecture forbids changing a live block's memory type in one
+ * write: another core's TLB could hold the old entry while the new one is
+ * in use. Each block is invalidated, its TLB entry flushed, and only then
+ * rewritten. This runs from fb_init(), before the secondary cores start.
+ *
+ * CONTIGUOUS RUNS:
+ * ----------------
+ * build_page_tables sets the contiguous hint (bit 52) on every aligned
+ * run of 16 Normal WB blocks, so the core can hold 32MB of RAM in one
+ * TLB entry. The framebuffer gets the same treatment: a run the scan-out
+ * range touches is remade whole, with the hint, when all 16 of its
+ * blocks are still-unclaimed carve-out — the few spare MB of VideoCore
+ * memory around the buffer get the buffer's type, which is harmless for
+ * memory the ARM never touches — so a 1080p double buffer needs one or
+ * two translations instead of nine.
+ *
+ * The hint is a promise about all 16 entries at once — same attributes,
+ * consecutive addresses — so the run is the unit of change: its entries
+ * are rebuilt together, every one that differs is broken first, and only
+ * then are they all rewritten.
+ */
+
+#include "hal_types.h"
+#include "hal_display.h"
+
+/* boot_soc.S */
+extern uint64_t mmu_l2_table[512];
+
+#define L2_BLOCK_SHIFT      21
+#define L2_BLOCK_SIZE       (1UL << L2_BLOCK_SHIFT)
+#define L2_PERIPH_INDEX     (0x3F000000UL >> L2_BLOCK_SHIFT)
+
+/* Lower attributes, matching build_page_tables */
+#define L2_DESC_DEVICE      0x401   /* AttrIndx 0, AF */
+#define L2_DESC_NORMAL_WB   0x705   /* AttrIndx 1, inner shareable, AF */
+#define L2_DESC_NORMAL_NC   0x709   /* AttrIndx 2, inner shareable, AF */
+#define L2_DESC_ATTR_MASK   0xFFF
+#define L2_DESC_ATTRINDX(d) (((d) >> 2) & 7)
+#define L2_DESC_CONTIG      (1UL << 52)
+#define L2_CONTIG_RUN       16      /* Entries per contiguous run: 32MB */
+#define L2_ENTRIES          512
+
+static uint64_t mem_desc(fb_mem_t type)
+{
+    switch (type) {
+        case FB_MEM_CACHED: return L2_DESC_NORMAL_WB;
+        case FB_MEM_WC:     return L2_DESC_NORMAL_NC;
+        default:            return L2_DESC_DEVICE;
+    }
+}
+
+/* Only blocks the boot tables mapped Device below the peripherals */
+static bool l2_block_ours(uint32_t i, uint64_t desc)
+{
+    return i < L2_PERIPH_INDEX && (desc & 3) == 1 && L2_DESC_ATTRINDX(desc) == 0;
+}
+
+/*
+ * Give [base, base + size) a new memory type, in whole 2MB blocks. Only
+ * blocks the boot tables mapped Device below the peripherals are touched
+ * — ARM RAM and MMIO keep their attributes whatever the caller asks.
+ * A run of 16 blocks that are all ours is converted as a whole, with the
+ * contiguous hint, even where it reaches past the range.
+ *
+ * Returns false, with nothing changed, if any block in the range is off
+ * limits: half a framebuffer remapped is worse than none, because the
+ * caller then can't say which type the whole buffer has.
+ */
+static bool bcm_mmu_set_mem_type(uintptr_t base, size_t size, fb_mem_t type)
+{
+    uint64_t desc = mem_desc(type);
+
+    if (size == 0 || base + size < base) return false;
+
+    uint32_t first = (uint32_t)(base >> L2_BLOCK_SHIFT);
+    uint32_t last  = (uint32_t)((base + size - 1) >> L2_BLOCK_SHIFT);
+    if (last >= L2_ENTRIES) return false;
+
+    /* Validate the whole range before the first entry is touched */
+    for (uint32_t i = first; i <= last; i++) {
+        if (!l2_block_ours(i, mmu_l2_table[i])) return false;
+    }
+
+    for (uint32_t run = first & ~(L2_CONTIG_RUN - 1); run <= last; run += L2_CONTIG_RUN) {
+        uint64_t next[L2_CONTIG_RUN];
+        bool     whole = true;
+
+        for (uint32_t k = 0; k < L2_CONTIG_RUN; k++) {
+            whole = whole && l2_block_ours(run + k, mmu_l2_table[run + k]);
+        }
+
+        /* The run as it should be: the range, or all of it if every block is ours */
+        for (uint32_t k = 0; k < L2_CONTIG_RUN; k++) {
+            uint32_t i   = run + k;
+            uint64_t old = mmu_l2_table[i];
+
+            next[k] = old & ~L2_DESC_CONTIG;
+            if (whole || (i >= first && i <= last)) {
+                next[k] = (next[k] & ~(uint64_t)L2_DESC_ATTR_MASK) | desc;
+            }
+            if (whole) next[k] |= L2_DESC_CONTIG;
+        }
+
+        /* Break every entry that changes */
+        uint32_t broken = 0;
+        for (uint32_t k = 0; k < L2_CONTIG_RUN; k++) {
+            if (next[k] != mmu_l2_table[run + k]) {
+                mmu_l2_table[run + k] = 0;
+                broken |= 1u << k;
+            }
+        }
+        if (!broken) continue;
+
+        __asm__ volatile("dsb ishst" ::: "memory");
+        for (uint32_t k = 0; k < L2_CONTIG_RUN; k++) {
+            if (broken & (1u << k)) {
+                uint64_t va = (uint64_t)(run + k) << L2_BLOCK_SHIFT;
+                __asm__ volatile("tlbi vaae1is, %0" :: "r"(va >> 12));
+            }
+        }
+        __asm__ volatile("dsb ish" ::: "memory");
+
+        /* Make */
+        for (uint32_t k = 0; k < L2_CONTIG_RUN; k++) {
+            if (broken & (1u << k)) mmu_l2_table[run + k] = next[k];
+        }
+        __asm__ volatile("dsb ishst" ::: "memory");
+    }
+    HAL_ISB();
+    return true;
+}
+
+/* =============================================================================
+ * SCAN-OUT MAPPING
+ * =============================================================================
+ */
+
+#if defined(FB_MAP_CACHED)
+#define FB_MAP_TYPE     FB_MEM_CACHED
+#elif defined(FB_MAP_DEVICE)
+#define FB_MAP_TYPE     FB_MEM_DEVICE
+#else
+#define FB_MAP_TYPE     FB_MEM_WC
+#endif
+
+fb_mem_t hal_display_map_scanout(uintptr_t base, size_t size)
+{
+    if (bcm_mmu_set_mem_type(base, size, FB_MAP_TYPE)) {
+        return FB_MAP_TYPE;
+    }
+
+    /*
+     * Part of the range wasn't ours to change (a buffer inside ARM RAM
+     * would be Normal WB already), so none of it was changed. Claim
+     * "cached" so fb_present keeps cleaning.
+     */
+    return FB_MEM_CACHED;
+}
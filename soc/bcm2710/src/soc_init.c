@@ -8,6 +8,7 @@
  */
 
 #include "hal_platform.h"
+#include "hal_cpu.h"
 #include "hal_timer.h"
 #include "hal_gpio.h"
 #include "bcm2710_regs.h"
@@ -252,6 +253,49 @@ uint32_t hal_platform_get_clock_rate(hal_clock_id_t clock_id)
     return 0;
 }
 
+/* Only the ARM clock: the others feed peripherals that were set up at their rate */
+hal_error_t hal_platform_get_clock_limits(hal_clock_id_t clock_id,
+                                          uint32_t *min_hz, uint32_t *max_hz)
+{
+    if (min_hz == NULL || max_hz == NULL) {
+        return HAL_ERROR_NULL_PTR;
+    }
+    if (clock_id != HAL_CLOCK_ARM) {
+        return HAL_ERROR_NOT_SUPPORTED;
+    }
+
+    if (!bcm_mailbox_get_clock_limits(BCM_CLOCK_ARM, min_hz, max_hz)) {
+        return HAL_ERROR_HARDWARE;
+    }
+    return HAL_SUCCESS;
+}
+
+hal_error_t hal_platform_set_clock_rate(hal_clock_id_t clock_id, uint32_t hz,
+                                        uint32_t *actual_hz)
+{
+    if (clock_id != HAL_CLOCK_ARM) {
+        return HAL_ERROR_NOT_SUPPORTED;
+    }
+
+    uint32_t min_hz, max_hz;
+    if (!bcm_mailbox_get_clock_limits(BCM_CLOCK_ARM, &min_hz, &max_hz)) {
+        return HAL_ERROR_HARDWARE;
+    }
+    if (hz < min_hz) {
+        return HAL_ERROR_INVALID_ARG;
+    }
+    if (hz > max_hz) {
+        hz = max_hz;
+    }
+
+    uint32_t rate;
+    if (!bcm_mailbox_set_clock_rate(BCM_CLOCK_ARM, hz, &rate)) {
+        return HAL_ERROR_HARDWARE;
+    }
+    if (actual_hz) *actual_hz = rate;
+    return HAL_SUCCESS;
+}
+
 /* =============================================================================
  * TEMPERATURE
  * =============================================================================
@@ -324,6 +368,107 @@ bool hal_platform_is_throttled(void)
     return false;
 }
 
+/* =============================================================================
+ * DYNAMIC READINGS
+ * =============================================================================
+ *
+ * Six tags, one mailbox round trip: 2 header words + 4 clocks x 5 +
+ * temperature 5 + throttle 5 + end = 33 of the buffer's 36 words. Value
+ * layouts match the single-tag getters in mailbox.c.
+ *
+ * hal_platform_request_dynamic() submits the batch asynchronously and
+ * hal_platform_poll_dynamic() collects it, so the VideoCore's reply time
+ * overlaps whatever the caller does in between. Without a request in
+ * flight, poll submits and waits.
+ */
+
+typedef struct {
+    bcm_mbox_batch_t batch;
+    int              clock[4];
+    int              temp;
+    int              throttle;
+} dyn_query_t;
+
+static dyn_query_t g_dyn;
+static int         g_dyn_ticket = -1;
+
+static void dyn_build(dyn_query_t *q)
+{
+    static const uint32_t clocks[4] = {
+        BCM_CLOCK_ARM, BCM_CLOCK_CORE, BCM_CLOCK_EMMC, BCM_CLOCK_PWM
+    };
+    uint32_t zero = 0;
+
+    bcm_mbox_batch_t *b = &q->batch;
+
+    bcm_mbox_batch_begin(b);
+    for (int i = 0; i < 4; i++) {
+        q->clock[i] = bcm_mbox_batch_add_tag(b, BCM_TAG_GET_CLOCK_RATE,
+                                             &clocks[i], 1, 2);
+    }
+    q->temp     = bcm_mbox_batch_add_tag(b, BCM_TAG_GET_TEMPERATURE,
+                                         &zero, 1, 2);
+    q->throttle = bcm_mbox_batch_add_tag(b, BCM_TAG_GET_THROTTLED,
+                                         &zero, 1, 2);
+}
+
+static void dyn_parse(const dyn_query_t *q, bool ok,
+                      hal_platform_dynamic_t *out)
+{
+    uint32_t *rates[4] = {
+        &out->arm_freq_hz, &out->core_freq_hz,
+        &out->emmc_freq_hz, &out->pwm_freq_hz
+    };
+    const uint32_t *v;
+
+    for (int i = 0; i < 4; i++) {
+        v = ok ? bcm_mbox_batch_result(&q->batch, q->clock[i]) : NULL;
+        *rates[i] = v ? v[1] : 0;
+    }
+
+    v = ok ? bcm_mbox_batch_result(&q->batch, q->temp) : NULL;
+    out->have_temp = (v != NULL);
+    out->temp_mc   = v ? (int32_t)v[1] : 0;
+
+    v = ok ? bcm_mbox_batch_result(&q->batch, q->throttle) : NULL;
+    out->have_throttle = (v != NULL);
+    out->throttle      = v ? v[1] : 0;
+}
+
+hal_error_t hal_platform_request_dynamic(void)
+{
+    if (g_dyn_ticket >= 0) {
+        return HAL_SUCCESS;             /* Already in flight */
+    }
+
+    dyn_build(&g_dyn);
+    return bcm_mbox_batch_submit_async(&g_dyn.batch, &g_dyn_ticket);
+}
+
+hal_error_t hal_platform_poll_dynamic(hal_platform_dynamic_t *out)
+{
+    if (out == NULL) {
+        return HAL_ERROR_NULL_PTR;
+    }
+
+    bool ok;
+    if (g_dyn_ticket >= 0) {
+        hal_error_t err;
+        while ((err = bcm_mbox_batch_poll(&g_dyn.batch, g_dyn_ticket)) ==
+               HAL_ERROR_BUSY) {
+            HAL_NOP();
+        }
+        g_dyn_ticket = -1;
+        ok = HAL_OK(err);
+    } else {
+        dyn_build(&g_dyn);
+        ok = bcm_mbox_batch_submit(&g_dyn.batch);
+    }
+
+    dyn_parse(&g_dyn, ok, out);
+    return HAL_SUCCESS;
+}
+
 /* =============================================================================
  * POWER MANAGEMENT
  * =============================================================================
@@ -371,6 +516,76 @@ hal_error_t hal_platform_get_power(hal_device_id_t device, bool *on)
     return HAL_SUCCESS;
 }
 
+/* =============================================================================
+ * MULTICORE
+ * =============================================================================
+ *
+ * The Cortex-A53 cores 1-3 spin in the firmware's armstub (or entry.S's copy
+ * of it) on a 64-bit release slot at 0xD8 + 8 * core. Writing an address
+ * there and issuing sev starts the core at that address, at EL2, with the
+ * MMU and caches off. The armstub has already set CPUECTLR_EL1.SMPEN, so
+ * the cores join the coherency domain as soon as their caches are on.
+ *
+ * DATA CACHE:
+ *   boot_soc.S enables the MMU with SCTLR_EL1.C = 0. That's fine for one
+ *   core, but the job system's atomics (ldaxr/stlxr) need cacheable memory
+ *   — there is no global exclusive monitor for non-cacheable accesses on
+ *   this SoC. So the first start request turns the D- and I-caches on. The
+ *   framebuffer is mapped Device and the mailbox cleans/invalidates its
+ *   buffers, so nothing else changes.
+ *
+ * A core running with its caches off reads straight from DRAM, so the boot
+ * block, its arm64_cpu_boot[] slot and the spin-table slot are all cleaned
+ * to the point of coherency before the sev.
+ */
+
+#define BCM_NUM_CORES           4
+#define BCM_SPIN_TABLE_BASE     0xD8UL
+
+#define SCTLR_C                 (1UL << 2)
+#define SCTLR_I                 (1UL << 12)
+
+/* boot/arm64 */
+extern void arm64_secondary_start(void);
+extern hal_cpu_boot_t *arm64_cpu_boot[];
+extern void enable_dcache(void);
+extern void enable_icache(void);
+extern void clean_dcache_range(uintptr_t start, size_t len);
+
+uint32_t hal_platform_get_cpu_count(void)
+{
+    return BCM_NUM_CORES;
+}
+
+hal_error_t hal_platform_start_cpu(uint32_t cpu, hal_cpu_boot_t *boot)
+{
+    uint64_t reg;
+
+    if (boot == NULL) return HAL_ERROR_NULL_PTR;
+    if (cpu == 0 || cpu >= BCM_NUM_CORES) return HAL_ERROR_INVALID_ARG;
+
+    __asm__ volatile("mrs %0, sctlr_el1" : "=r"(reg));
+    if (!(reg & SCTLR_C)) enable_dcache();
+    if (!(reg & SCTLR_I)) enable_icache();
+
+    __asm__ volatile("mrs %0, mair_el1"  : "=r"(reg)); boot->mmu[0] = reg;
+    __asm__ volatile("mrs %0, tcr_el1"   : "=r"(reg)); boot->mmu[1] = reg;
+    __asm__ volatile("mrs %0, ttbr0_el1" : "=r"(reg)); boot->mmu[2] = reg;
+    __asm__ volatile("mrs %0, sctlr_el1" : "=r"(reg)); boot->mmu[3] = reg;
+
+    arm64_cpu_boot[cpu] = boot;
+    clean_dcache_range((uintptr_t)boot, sizeof(*boot));
+    clean_dcache_range((uintptr_t)&arm64_cpu_boot[cpu], sizeof(arm64_cpu_boot[cpu]));
+
+    volatile uint64_t *slot = (volatile uint64_t *)(BCM_SPIN_TABLE_BASE + 8 * cpu);
+    *slot = (uintptr_t)arm64_secondary_start;
+    clean_dcache_range((uintptr_t)slot, sizeof(*slot));
+
+    HAL_DSB();
+    HAL_SEV();
+    return HAL_SUCCESS;
+}
+
 /* =============================================================================
  * SYSTEM CONTROL
  * =============================================================================
@@ -405,21 +620,10 @@ void hal_panic(const char *message)
  * =============================================================================
  */
 
+/* hal_debug_puts() / hal_debug_printf() are portable: kernel/src/debug.c */
+
 void hal_debug_putc(char c)
 {
     (void)c;
     /* TODO: UART output */
 }
-
-void hal_debug_puts(const char *s)
-{
-    while (*s) {
-        hal_debug_putc(*s++);
-    }
-}
-
-void hal_debug_printf(const char *fmt, ...)
-{
-    (void)fmt;
-    /* TODO: Implement minimal printf */
-}
@@ -7,10 +7,15 @@
  * The system timer is a 1MHz free-running counter - perfect for
  * microsecond-accurate timing.
  *
+ * Timer events use compare channel C1. Its deadlines are in the same
+ * microseconds as hal_timer_get_ticks(), so there is no conversion at all
+ * — which is why this, and not the ARM generic timer, drives them.
+ *
  */
 
 #include "hal_timer.h"
 #include "bcm2710_regs.h"
+#include "bcm2710_irq.h"
 
 /* =============================================================================
  * INITIALIZATION
@@ -104,3 +109,61 @@ void hal_delay_s(uint32_t s)
         hal_delay_us(1000000);
     }
 }
+
+/* =============================================================================
+ * TIMER INTERRUPT HOOKS (System Timer C1)
+ * =============================================================================
+ *
+ * C1 is a 32-bit compare against CLO, and it matches for EQUALITY only.
+ * Two consequences:
+ *
+ *   - A deadline more than 2^31 us (~35 minutes) out can't be expressed
+ *     unambiguously; we fire early at the limit and the queue simply
+ *     reprograms with nothing expired.
+ *   - A deadline already in the past would not match until CLO wraps, 71
+ *     minutes later. So after writing C1 we re-read CLO, and if it has
+ *     reached the target we push the compare a couple of ticks ahead and
+ *     check again.
+ */
+
+#define BCM_TIMER_MIN_LEAD_US   2
+#define BCM_TIMER_MAX_LEAD_US   0x7FFFFFFFu
+
+hal_error_t hal_timer_irq_init(void)
+{
+    hal_mmio_write32(BCM_SYSTIMER_CS, BCM_SYSTIMER_CS_M1);
+    bcm_irq_enable(BCM_IRQ_SYSTIMER_1);
+    return HAL_SUCCESS;
+}
+
+void hal_timer_irq_set(uint64_t deadline_us)
+{
+    uint64_t now = hal_timer_get_ticks();
+    uint32_t target;
+
+    if (deadline_us > now + BCM_TIMER_MAX_LEAD_US) {
+        target = (uint32_t)(now + BCM_TIMER_MAX_LEAD_US);
+    } else {
+        target = (uint32_t)deadline_us;
+    }
+
+    hal_mmio_write32(BCM_SYSTIMER_CS, BCM_SYSTIMER_CS_M1);
+    hal_mmio_write32(BCM_SYSTIMER_C1, target);
+
+    /* Signed distance still <= 0: CLO got there first (or it was past due) */
+    for (;;) {
+        uint32_t clo = hal_mmio_read32(BCM_SYSTIMER_CLO);
+        if ((int32_t)(target - clo) > 0) break;
+        target = clo + BCM_TIMER_MIN_LEAD_US;
+        hal_mmio_write32(BCM_SYSTIMER_C1, target);
+    }
+
+    bcm_irq_enable(BCM_IRQ_SYSTIMER_1);
+}
+
+void hal_timer_irq_clear(void)
+{
+    /* No way to switch a compare off: mask the line instead */
+    bcm_irq_disable(BCM_IRQ_SYSTIMER_1);
+    hal_mmio_write32(BCM_SYSTIMER_CS, BCM_SYSTIMER_CS_M1);
+}
@@ -63,7 +63,6 @@ KERNEL_NAME   := tutorial-os-mars.bin
 BOOT_SOURCES := \
 	boot/riscv64/entry.S \
 	boot/riscv64/common_init.S \
-	soc/jh7110/mmu.S \
 	boot/riscv64/vectors.S
 
 # ─────────────────────────────────────────────────────────────────────────────
@@ -71,10 +70,18 @@ BOOT_SOURCES := \
 # ─────────────────────────────────────────────────────────────────────────────
 #
 # uart.c            — DW 8250 / 16550-compatible UART (NOT PXA like kyx1)
+#                     behind a TX ring: SBI DBCN per line, then THRE IRQ
 #                     JH7110 uses standard Synopsys DesignWare 8250 UART IP.
 #                     UART0 (GPIO5/GPIO6) = primary debug console at 115200.
-# timer.c           — rdtime @ 24 MHz reference (identical concept to kyx1)
+# timer.c           — rdtime @ 24 MHz reference (identical concept to kyx1),
+#                     plus the SBI-timer hooks behind hal_timer.h events
+# irq.c             — handle_interrupt(): scause 5 → hal_timer_irq(),
+#                     scause 9 → PLIC claim → jh7110_uart_irq()
 # gpio.c            — JH7110 GPIO controller + sys_iomux pin function select
+# mmu.c             — Sv39 tables from a region map: 1GB gigapages where a
+#                     whole GB shares one attribute, 2MB megapages elsewhere
+# dma.c             — hal_dma.h lifecycle: L2 Flush64 for cached buffers,
+#                     fence-only for the PBMT_NC .dma_coherent pool
 # display_simplefb.c — SimpleFB from DTB, identical strategy to kyx1.
 #                      U-Boot initializes the DC8200 + HDMI2.0 and injects
 #                      a simple-framebuffer node. We read it from a1.
@@ -86,8 +93,11 @@ SOC_SOURCES := \
 	soc/jh7110/src/drivers/pmic_axp15060.c \
 	soc/jh7110/src/uart.c \
 	soc/jh7110/src/timer.c \
+	soc/jh7110/src/irq.c \
 	soc/jh7110/src/gpio.c \
+	soc/jh7110/src/mmu.c \
 	soc/jh7110/src/cache.c \
+	soc/jh7110/src/dma.c \
 	soc/jh7110/src/display_simplefb.c \
 	soc/jh7110/src/soc_init.c
 
@@ -109,9 +119,19 @@ HAL_SOURCES := \
 SOC_INCLUDES := \
 	-Isoc/jh7110/src/
 
+#
+# memset/memcpy/memmove: no STRING_ARCH_MEMOPS and no STRING_HAVE_CBO_ZERO.
+# The U74 has neither the V extension nor Zicboz, so common/src/string.c's
+# portable 64-bit unrolled loops are the fast path here. A Zicboz part
+# (Ky X1) adds -DSTRING_HAVE_CBO_ZERO alongside its cache.S.
+#
+# FB_HAVE_RGB565=0: the DC8200 scans out 32-bit pixels, so only that
+# raster core is built (drivers/src/framebuffer/fb_format.h).
+
 SOC_DEFINES := \
     -DSOC_JH7110=1 \
     -DJH7110_PERI_BASE=0x10000000 \
     -DRAM_BASE=0x40000000UL \
     -DRAM_SIZE=0x40000000UL \
-    -DBOOT_HART_ID=1
\ No newline at end of file
+    -DBOOT_HART_ID=1 \
+    -DFB_HAVE_RGB565=0
\ No newline at end of file
@@ -5,6 +5,13 @@
 #define JH7110_L2_CACHE_BASE    0x02010000UL
 #define L2_FLUSH64_OFFSET       0x200
 
+/*
+ * Running total of Flush64 writes since boot. display_simplefb.c samples
+ * it at each present to report how many lines a frame actually cost.
+ * Atomic: DMA maintenance can flush from any core, concurrently.
+ */
+static uint64_t g_l2_lines_flushed = 0;
+
 /*
  * jh7110_l2_flush_range — flush physical address range to DRAM
  *
@@ -15,23 +22,43 @@
  * This is our substitute for Zicbom cbo.flush (not implemented on the U74
  * in JH7110) and Svpbmt non-cacheable page table entries (also absent).
  *
- * Called once after all drawing is complete, before fb_present().
- * For a 1920x1080x4 framebuffer: ~130,000 cache line flushes.
- * At bare-metal MMIO speeds this completes in well under 100ms — fine
- * for a static display. For animation you'd want double-buffering with
- * async flush; for Tutorial-OS a single static frame is sufficient.
+ * A full 1920x1080x4 framebuffer is ~130,000 Flush64 writes. fb_present()
+ * only hands us the dirty row spans (see fb_for_each_dirty_span), so a
+ * live-panel update is typically a few thousand lines, not the whole
+ * buffer. This is called once per span, so it must stay quiet — no UART
+ * breadcrumbs in here.
+ *
+ * There is no whole-cache alternative for large ranges (hal_cache.h), so
+ * the walk is unrolled instead: four MMIO writes per loop iteration, then
+ * the tail, with the line count computed up front rather than counted.
  */
 void jh7110_l2_flush_range(uintptr_t phys_addr, size_t size)
 {
-    jh7110_uart_putc('L');   /* confirm entry */
     volatile uint64_t *flush64 =
-        (volatile uint64_t *)(0x02010000UL + 0x200);
+        (volatile uint64_t *)(JH7110_L2_CACHE_BASE + L2_FLUSH64_OFFSET);
     uintptr_t line = phys_addr & ~63UL;
     uintptr_t end  = phys_addr + size;
-    while (line < end) {
+    if (line >= end) return;
+
+    uint64_t n = (end - line + 63) / 64;
+    uint64_t i = n;
+    for (; i >= 4; i -= 4) {
+        *flush64 = (uint64_t)line;
+        *flush64 = (uint64_t)line + 64;
+        *flush64 = (uint64_t)line + 128;
+        *flush64 = (uint64_t)line + 192;
+        line += 256;
+    }
+    for (; i > 0; i--) {
         *flush64 = (uint64_t)line;
         line += 64;
     }
     __asm__ volatile("fence iorw, iorw" ::: "memory");
-    jh7110_uart_putc('l');   /* confirm exit */
-}
\ No newline at end of file
+    __atomic_fetch_add(&g_l2_lines_flushed, n, __ATOMIC_RELAXED);
+}
+
+/* Total Flush64 writes issued since boot */
+uint64_t jh7110_l2_flush_count(void)
+{
+    return __atomic_load_n(&g_l2_lines_flushed, __ATOMIC_RELAXED);
+}
@@ -34,12 +34,12 @@
  *
  * HAL TEACHING POINT:
  *   Compare this file with soc/kyx1/display_simplefb.c side by side.
- *   The entire DTB parsing logic — fdt_get_u32(), fdt_strncmp(),
- *   parse_simplefb_from_dtb() — is copy-identical. This is not an
- *   accident. DTB parsing is architecture-agnostic C code. It would be
- *   a natural candidate for a shared common/ module. We keep it
- *   duplicated here intentionally to keep each SoC directory self-contained
- *   and minimize surprise for readers studying one platform at a time.
+ *   The DTB walk used to be copy-identical in both: every driver that
+ *   wanted a node re-scanned the whole blob token by token. It now lives
+ *   once in common/src/fdt.c, which indexes the blob on first use; this
+ *   file only asks the index for "simple-framebuffer" and reads the
+ *   properties by name. What stays here is genuinely JH7110-specific —
+ *   the DC8200 stride probe and the U-Boot fallback address.
  *
  * BUG FIXES (2025):
  * -----------------
@@ -68,12 +68,14 @@
 
 #include "jh7110_regs.h"
 #include "types.h"
+#include "fdt.h"
 
 extern void jh7110_uart_puts(const char *str);
 extern void jh7110_uart_puthex(uint64_t val);
 extern void jh7110_uart_putdec(uint32_t val);
 extern void jh7110_uart_putc(char c);
 void jh7110_l2_flush_range(uintptr_t phys_addr, size_t size);
+uint64_t jh7110_l2_flush_count(void);
 
 #define JH7110_COLOR(argb) \
 (((argb) & 0xFF00FF00) | \
@@ -104,32 +106,6 @@ void jh7110_l2_flush_range(uintptr_t phys_addr, size_t size);
 #define DC8200_BASE         0x29400000UL
 #define DC8200_STRIDE_REG   0x1430         /* Primary layer stride, bytes (could also be 0x1408 ) */
 
-/* =============================================================================
- * FDT (FLATTENED DEVICE TREE) CONSTANTS
- * =============================================================================
- */
-
-#define FDT_MAGIC       0xD00DFEED
-#define FDT_BEGIN_NODE  0x00000001
-#define FDT_END_NODE    0x00000002
-#define FDT_PROP        0x00000003
-#define FDT_NOP         0x00000004
-#define FDT_END         0x00000009
-
-/* FDT header structure */
-typedef struct {
-    uint32_t magic;
-    uint32_t totalsize;
-    uint32_t off_dt_struct;
-    uint32_t off_dt_strings;
-    uint32_t off_mem_rsvmap;
-    uint32_t version;
-    uint32_t last_comp_version;
-    uint32_t boot_cpuid_phys;
-    uint32_t size_dt_strings;
-    uint32_t size_dt_struct;
-} fdt_header_t;
-
 /* SimpleFB information extracted from the DTB */
 typedef struct {
     uint64_t base_addr;     /* Framebuffer physical base address */
@@ -143,23 +119,21 @@ typedef struct {
 } simplefb_info_t;
 
 /* =============================================================================
- * MINIMAL FDT PARSING UTILITIES
+ * SIMPLEFB NODE LOOKUP
  * =============================================================================
+ *
+ * The blob itself is indexed once by fdt_init() (common/src/fdt.c); here
+ * we only ask the index for the first simple-framebuffer node and read
+ * its properties by name. `reg` is decoded with the parent's
+ * #address-cells / #size-cells, so both the <hi lo hi lo> and <addr size>
+ * forms come out right.
  */
 
-/* Read a big-endian 32-bit value from unaligned memory */
-static uint32_t fdt_r32(const uint8_t *p)
-{
-    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
-           ((uint32_t)p[2] <<  8) | ((uint32_t)p[3]);
-}
-
-/* Compare two byte strings of given length */
-static bool fdt_strncmp(const char *a, const char *b, uint32_t n)
+/* True if the NUL-terminated format string starts with prefix */
+static bool format_is(const char *format, const char *prefix)
 {
-    for (uint32_t i = 0; i < n; i++) {
-        if (a[i] != b[i]) return false;
-        if (a[i] == '\0') return true;
+    while (*prefix) {
+        if (*format++ != *prefix++) return false;
     }
     return true;
 }
@@ -167,9 +141,6 @@ static bool fdt_strncmp(const char *a, const char *b, uint32_t n)
 /*
  * parse_simplefb_from_dtb — extract SimpleFB info from DTB
  *
- * Walks the FDT structure block looking for a node with
- * compatible = "simple-framebuffer". Extracts all properties.
- *
  * @param dtb   Pointer to the device tree blob (from boot register a1)
  * @param info  Output structure to populate
  * @return      true if a valid simple-framebuffer node was found
@@ -178,123 +149,34 @@ static bool parse_simplefb_from_dtb(const void *dtb, simplefb_info_t *info)
 {
     if (!dtb || !info) return false;
 
-    const fdt_header_t *hdr = (const fdt_header_t *)dtb;
-
-    /* Validate FDT magic number */
-    if (fdt_r32((const uint8_t *)&hdr->magic) != FDT_MAGIC) {
-        jh7110_uart_puts("[simplefb] ERROR: Invalid DTB magic\n");
+    if (!fdt_init(dtb)) {
+        jh7110_uart_puts("[simplefb] ERROR: DTB could not be indexed\n");
         return false;
     }
 
-    uint32_t struct_off   = fdt_r32((const uint8_t *)&hdr->off_dt_struct);
-    uint32_t strings_off  = fdt_r32((const uint8_t *)&hdr->off_dt_strings);
-
-    const uint8_t *struct_base  = (const uint8_t *)dtb + struct_off;
-    const char    *strings_base = (const char    *)dtb + strings_off;
-
-    const uint8_t *p = struct_base;
-    bool in_simplefb_node = false;
-    int  depth = 0;
-
-    while (true) {
-        uint32_t token = fdt_r32(p);
-        p += 4;
-
-        switch (token) {
-        case FDT_BEGIN_NODE: {
-            depth++;
-            /* Node name is a null-terminated string at p, padded to 4 bytes */
-            const char *name = (const char *)p;
-            uint32_t name_len = 0;
-            while (name[name_len]) name_len++;
-            p += (name_len + 4) & ~3;   /* Advance past name, 4-byte aligned */
-            (void)name;
-            break;
-        }
-
-        case FDT_END_NODE:
-            if (in_simplefb_node && depth == 1) {
-                in_simplefb_node = false;
-                if (info->found) return true;  /* Got everything we need */
-            }
-            depth--;
-            if (depth < 0) return info->found;
-            break;
-
-        case FDT_PROP: {
-            uint32_t val_size = fdt_r32(p); p += 4;
-            uint32_t name_off = fdt_r32(p); p += 4;
-            const uint8_t *val = p;
-            p += (val_size + 3) & ~3;   /* Skip value, 4-byte aligned */
-
-            const char *prop_name = strings_base + name_off;
-
-            /* Check for compatible = "simple-framebuffer" */
-            if (fdt_strncmp(prop_name, "compatible", 10) && val_size >= 18) {
-                if (fdt_strncmp((const char *)val, "simple-framebuffer", 18)) {
-                    in_simplefb_node = true;
-                    info->found = false;    /* Not yet — need reg/width/height */
-                }
-            }
-
-            if (!in_simplefb_node) break;
-
-            /* Extract properties from the simple-framebuffer node */
-            if (fdt_strncmp(prop_name, "reg", 3) && val_size >= 8) {
-                /* reg = <addr_hi addr_lo size_hi size_lo> (two 64-bit values) */
-                if (val_size >= 16) {
-                    /* 64-bit address cells */
-                    info->base_addr = ((uint64_t)fdt_r32(val) << 32) |
-                                       (uint64_t)fdt_r32(val + 4);
-                    info->size      = ((uint64_t)fdt_r32(val + 8) << 32) |
-                                       (uint64_t)fdt_r32(val + 12);
-                } else {
-                    /* 32-bit address cells */
-                    info->base_addr = (uint64_t)fdt_r32(val);
-                    info->size      = (uint64_t)fdt_r32(val + 4);
-                }
-                info->found = (info->width > 0 && info->height > 0);
-            }
-            else if (fdt_strncmp(prop_name, "width", 5) && val_size == 4) {
-                info->width = fdt_r32(val);
-                info->found = (info->base_addr > 0 && info->height > 0);
-            }
-            else if (fdt_strncmp(prop_name, "height", 6) && val_size == 4) {
-                info->height = fdt_r32(val);
-                info->found = (info->base_addr > 0 && info->width > 0);
-            }
-            else if (fdt_strncmp(prop_name, "stride", 6) && val_size == 4) {
-                info->stride = fdt_r32(val);
-            }
-            else if (fdt_strncmp(prop_name, "format", 6) && val_size > 0) {
-                uint32_t copy_len = val_size < 31 ? val_size : 31;
-                for (uint32_t i = 0; i < copy_len; i++)
-                    info->format[i] = (char)val[i];
-                info->format[copy_len] = '\0';
-
-                /* Determine BPP from format string */
-                if (fdt_strncmp(info->format, "a8r8g8b8", 8) || fdt_strncmp(info->format, "x8r8g8b8", 8)) {
-                    info->bpp = 32;
-                } else if (fdt_strncmp(info->format, "r5g6b5", 6) == 0) {
-                    info->bpp = 16;
-                } else {
-                    info->bpp = 32;
-                }
-            }
-            break;
-        }
-
-        case FDT_NOP:
-            break;
-
-        case FDT_END:
-            return info->found;
-
-        default:
-            jh7110_uart_puts("[simplefb] ERROR: Unknown FDT token\n");
-            return false;
-        }
+    int node = fdt_find_compatible("simple-framebuffer", FDT_NONE);
+    if (node == FDT_NONE) return false;
+
+    if (!fdt_reg(node, 0, &info->base_addr, &info->size) ||
+        !fdt_prop_u32(node, "width", &info->width) ||
+        !fdt_prop_u32(node, "height", &info->height)) {
+        return false;
     }
+    fdt_prop_u32(node, "stride", &info->stride);
+
+    uint32_t    len;
+    const char *format = fdt_prop(node, "format", &len);
+    if (format && len > 0) {
+        uint32_t copy_len = len < 31 ? len : 31;
+        for (uint32_t i = 0; i < copy_len; i++)
+            info->format[i] = format[i];
+        info->format[copy_len] = '\0';
+    }
+
+    /* Determine BPP from format string */
+    info->bpp   = format_is(info->format, "r5g6b5") ? 16 : 32;
+    info->found = info->base_addr > 0 && info->width > 0 && info->height > 0;
+    return info->found;
 }
 
 /* =============================================================================
@@ -348,6 +230,7 @@ static uint32_t probe_dc8200_stride(uint32_t width, uint32_t bpp)
  */
 
 #include "framebuffer.h"
+#include "fb_format.h"
 
 bool jh7110_display_init(framebuffer_t *fb, const void *dtb)
 {
@@ -442,10 +325,15 @@ bool jh7110_display_init(framebuffer_t *fb, const void *dtb)
     fb->virtual_height = info.height;
     fb->front_buffer   = 0;
     fb->back_buffer    = 0;
-    fb->buffers[0]     = (uint32_t *)(uintptr_t)info.base_addr;
-    fb->buffers[1]     = (uint32_t *)(uintptr_t)info.base_addr;
-    fb->initialized    = true;
+    for (uint32_t b = 0; b < FB_BUFFER_COUNT; b++) {
+        fb->buffers[b] = (uint32_t *)(uintptr_t)info.base_addr;
+    }
     fb->pixel_format   = FB_FORMAT_ABGR8888;
+    if (!fb_format_bind(fb)) {
+        jh7110_uart_puts("[simplefb] ERROR: pixel format not built in\n");
+        return false;
+    }
+    fb->initialized    = true;
     // These below need to be set, otherwise, no drawing will occur as they are discarded.
     fb->clip_depth      = 0;
     fb->clip_stack[0].x = 0;
@@ -460,20 +348,79 @@ bool jh7110_display_init(framebuffer_t *fb, const void *dtb)
     return true;
 }
 
+/* =============================================================================
+ * PRESENT — DIRTY-REGION L2 FLUSH
+ * =============================================================================
+ *
+ * The DC8200 scans DRAM. Anything still sitting dirty in the U74's L2 is
+ * invisible to it, and the only way to push lines out is one Flush64 MMIO
+ * write per 64-byte line. Flushing the whole 1080p buffer is ~130k writes
+ * per frame — by far the biggest cost of a live panel on this board.
+ *
+ * So we flush only what the frame drew. fb_for_each_dirty_span() turns
+ * the framebuffer's dirty list into per-row byte ranges (pitch-aware) and
+ * we issue Flush64 for those lines alone. fb_present() does the same thing
+ * through clean_dcache_range(), which hal_platform_jh7110.c routes to
+ * jh7110_l2_flush_range().
+ *
+ * g_lines_last_frame records how many Flush64 writes went out between the
+ * previous present and this one, whichever path issued them. Read it with
+ * jh7110_display_flush_lines() — useful for checking that a panel update
+ * really is as small as it looks.
+ */
+
+static uint64_t g_flush_mark       = 0;
+static uint32_t g_lines_last_frame = 0;
+
+static void jh7110_flush_span(uintptr_t start, size_t len, void *ctx)
+{
+    (void)ctx;
+    jh7110_l2_flush_range(start, len);
+}
+
+static void jh7110_latch_flush_count(void)
+{
+    uint64_t now = jh7110_l2_flush_count();
+    g_lines_last_frame = (uint32_t)(now - g_flush_mark);
+    g_flush_mark = now;
+}
+
+/* Flush64 lines issued for the most recently presented frame */
+uint32_t jh7110_display_flush_lines(void)
+{
+    return g_lines_last_frame;
+}
+
+/*
+ * fb_flip_display — strong override of the weak default in framebuffer.c
+ *
+ * Called by fb_present() after the dirty spans have been flushed. SimpleFB
+ * has no flip to perform (single buffer, DC8200 already scanning it); we
+ * just order the stores and close out the frame's flush count.
+ */
+void fb_flip_display(framebuffer_t *fb)
+{
+    (void)fb;
+    __asm__ volatile("fence iorw, iorw" ::: "memory");
+    jh7110_latch_flush_count();
+}
+
 void jh7110_display_present(framebuffer_t *fb)
 {
-    jh7110_uart_putc('K');  /* breadcrumb — did we get here? */
-    jh7110_l2_flush_range((uintptr_t)fb->addr, fb->buffer_size);
+    if (!fb || !fb->initialized) return;
+
+    fb_for_each_dirty_span(fb, jh7110_flush_span, NULL);
+
     /*
      * No explicit present needed — the DC8200 is already scanning out
      * from the framebuffer address. All writes to fb->addr are immediately
      * visible (no double buffering in SimpleFB mode).
      *
      * A fence ensures all pending stores complete before we consider the
-     * frame "presented". On the JH7110, the DC8200 DMA is cache-coherent
-     * with the CPU so this fence is sufficient. On platforms with
-     * non-coherent display paths an explicit cache clean would be needed.
+     * frame "presented".
      */
     __asm__ volatile("fence iorw, iorw" ::: "memory");
-    (void)fb;
-}
\ No newline at end of file
+
+    jh7110_latch_flush_count();
+    fb_clear_dirty(fb);
+}
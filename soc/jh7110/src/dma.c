@@ -0,0 +1,148 @@
+/*
+ * dma.c — DMA Coherency Implementation for the JH-7110 SoC
+ * =========================================================
+ *
+ * Implements the buffer lifecycle from hal_dma.h for the SiFive U74.
+ *
+ * The U74 has no Zicbom, so the only cache operation available is the
+ * L2 controller's Flush64 register (cache.c, jh7110_l2_flush_range()):
+ * a CLEAN, one 64-byte line per MMIO write. There is no invalidate —
+ * FROM_DEVICE transfers rely on the TileLink fabric keeping the L2
+ * coherent with on-chip DMA masters (see the LIMITATION note on
+ * hal_dma_prepare() in hal_dma.h).
+ *
+ * Every buffer gets the walk, the DMA pool's included: without Svpbmt
+ * the page tables can't make any DRAM non-cacheable (see mmu.c), so the
+ * pool is as cached as the heap and dma_pool_alloc() leaves coherent
+ * false here.
+ *
+ * No bus alias: devices see the physical address, and with identity
+ * mapping that is the CPU address too.
+ */
+
+#include "hal_dma.h"
+
+void jh7110_l2_flush_range(uintptr_t phys_addr, size_t size);
+
+/* =============================================================================
+ * BUFFER LIFECYCLE
+ * =============================================================================
+ */
+
+static void dma_maintain(const hal_dma_buf_t *buf, hal_dma_dir_t dir)
+{
+    if (dir == HAL_DMA_FROM_DEVICE) {
+        HAL_DSB();
+        return;
+    }
+    jh7110_l2_flush_range((uintptr_t)buf->cpu_addr, buf->size);   /* fences */
+}
+
+hal_error_t hal_dma_prepare(hal_dma_buf_t *buf)
+{
+    if (buf == NULL || buf->cpu_addr == NULL) return HAL_ERROR_NULL_PTR;
+
+    buf->dev_addr = hal_dma_to_device_addr(buf->cpu_addr);
+    dma_maintain(buf, buf->direction);
+
+    buf->owner = HAL_DMA_OWNER_DEVICE;
+    return HAL_SUCCESS;
+}
+
+hal_error_t hal_dma_complete(hal_dma_buf_t *buf)
+{
+    if (buf == NULL || buf->cpu_addr == NULL) return HAL_ERROR_NULL_PTR;
+
+    HAL_DSB();
+    buf->owner = HAL_DMA_OWNER_CPU;
+    return HAL_SUCCESS;
+}
+
+void hal_dma_sync(hal_dma_buf_t *buf, hal_dma_dir_t dir)
+{
+    if (buf == NULL || buf->cpu_addr == NULL) return;
+    dma_maintain(buf, dir);
+}
+
+/* =============================================================================
+ * ADDRESS TRANSLATION
+ * =============================================================================
+ */
+
+uintptr_t hal_dma_to_device_addr(void *cpu_addr)
+{
+    return (uintptr_t)cpu_addr;
+}
+
+uintptr_t hal_dma_to_cpu_addr(uintptr_t dev_addr)
+{
+    return dev_addr;
+}
+
+/* =============================================================================
+ * BARRIERS
+ * =============================================================================
+ */
+
+void hal_dma_channel_barrier(hal_dma_channel_t from_ch, hal_dma_channel_t to_ch)
+{
+    (void)from_ch;
+    (void)to_ch;
+    HAL_DSB();
+}
+
+void hal_dma_full_barrier(void)
+{
+    HAL_DSB();
+}
+
+/* =============================================================================
+ * MAILBOX
+ * =============================================================================
+ * There is no VideoCore here. These exist so portable code can call them
+ * unconditionally: the "bus address" is the buffer itself.
+ */
+
+uintptr_t hal_dma_prepare_mailbox(void *buf, size_t size)
+{
+    (void)size;
+    HAL_DSB();
+    return (uintptr_t)buf;
+}
+
+void hal_dma_complete_mailbox(void *buf, size_t size)
+{
+    (void)buf;
+    (void)size;
+    HAL_DSB();
+}
+
+/* =============================================================================
+ * 2D TRANSFER ENGINE
+ * =============================================================================
+ * The JH-7110's DW AXI DMA is not driven yet, and the framebuffer here is
+ * cached (no Svpbmt — see cache.c), so an engine would need the Flush64
+ * walk around every transfer anyway. Callers keep their CPU loops.
+ */
+
+hal_error_t hal_dma_2d_submit(hal_dma_channel_t ch, const hal_dma_2d_t *xfers,
+                              uint32_t count, hal_dma_fence_t *fence_out)
+{
+    (void)ch;
+    (void)xfers;
+    (void)count;
+    (void)fence_out;
+    return HAL_ERROR_NOT_SUPPORTED;
+}
+
+bool hal_dma_fence_signaled(hal_dma_fence_t fence)
+{
+    (void)fence;
+    return true;
+}
+
+hal_error_t hal_dma_fence_wait(hal_dma_fence_t fence)
+{
+    (void)fence;
+    return HAL_SUCCESS;
+}
@@ -2,9 +2,9 @@
  * drivers/i2c.c — I2C Driver for the StarFive JH-7110 SoC
  * =========================================================
  *
- * This implements a polled I2C master driver for the Synopsys DesignWare
- * I2C controller embedded in the JH7110. It's used to communicate with
- * the AXP15060 PMIC on I2C6 (base 0x100E0000, PMIC at address 0x36).
+ * This implements an I2C master driver for the Synopsys DesignWare I2C
+ * controller embedded in the JH7110. It's used to communicate with the
+ * AXP15060 PMIC on I2C6 (base 0x100E0000, PMIC at address 0x36).
  *
  * COMPARISON WITH KYX1:
  *   The Ky X1 uses I2C8 (0xD401D800) with the PXA/MMP I2C variant.
@@ -14,30 +14,71 @@
  * DESIGNWARE I2C OPERATION:
  * =========================
  *
- * To write a byte to a register:
- *   1. Disable I2C controller (IC_ENABLE = 0)
- *   2. Set target address in IC_TAR
- *   3. Re-enable controller (IC_ENABLE = 1)
- *   4. Write data bytes to IC_DATA_CMD (command = 0 for write)
- *   5. For the last byte, set STOP bit (IC_DATA_CMD bit 9)
- *   6. Poll IC_STATUS until MST_ACTIVITY goes low (transfer complete)
- *
- * To read a byte from a register:
- *   1. Disable + set target + re-enable (same as write)
- *   2. Write the register address byte (write command, no STOP)
- *   3. Write a read command byte (IC_DATA_CMD bit 8 set, with STOP)
- *   4. Poll until RX FIFO has data (IC_STATUS.RFNE = 1)
- *   5. Read the result from IC_DATA_CMD
+ * Everything the master does on the bus is a command pushed into the TX
+ * FIFO through IC_DATA_CMD, one per byte:
+ *
+ *   bits [7:0]   byte to send (ignored for a read)
+ *   bit  8       READ — clock one byte in; it lands in the RX FIFO
+ *   bit  9       STOP after this byte
+ *   bit  10      RESTART before this byte
+ *
+ * Reading N registers starting at reg is ONE transaction:
+ *
+ *   S  addr+W  reg  Sr  addr+R  d0  d1 ... dN-1  P
+ *      └── write ──┘    └──────── N reads ───────┘
+ *
+ *   IC_DATA_CMD ← reg
+ *   IC_DATA_CMD ← READ | RESTART
+ *   IC_DATA_CMD ← READ                 (N - 2 times)
+ *   IC_DATA_CMD ← READ | STOP
+ *
+ * The controller runs the commands by itself; the CPU only keeps the TX
+ * FIFO fed and the RX FIFO emptied. Both are a few entries deep — the
+ * depths are in IC_COMP_PARAM_1 — so a transaction longer than that is
+ * pushed in bursts: as many commands as the TX FIFO has room for, but
+ * never more reads in flight than the RX FIFO can hold, or received
+ * bytes would be dropped.
+ *
+ * The FIFO must not run dry mid-transaction: depending on how the
+ * controller was synthesized, an empty TX FIFO either stretches SCL or
+ * ends the transfer with a STOP. Topping it up before it empties keeps
+ * the bytes back-to-back.
+ *
+ * A transaction is over when the controller reports STOP_DET — the STOP
+ * we asked for went out. That, not "RX FIFO not empty" or "master idle",
+ * is the completion signal: it covers writes and reads alike, and it is
+ * an interrupt source.
  *
  * ERROR HANDLING:
  *   A TX abort (IC_RAW_INTR_STAT.TX_ABRT) means the target didn't ACK.
- *   We must read IC_CLR_TX_ABRT to clear it before the next transfer.
- *   This happens if the PMIC address is wrong or the I2C bus is busy.
+ *   The controller flushes the TX FIFO and ends the transfer; we read
+ *   IC_CLR_TX_ABRT to clear it before the next one. This happens if the
+ *   PMIC address is wrong or the I2C bus is busy.
  *
  * POLLED VS INTERRUPT-DRIVEN:
- *   We use polled I2C (spin-wait on status registers). This is simpler
- *   for bare-metal and avoids interrupt setup complexity. The PMIC read
- *   during boot takes ~100µs — negligible compared to display init.
+ * ===========================
+ *
+ * A byte at 100 kHz takes 90µs. Spinning on the status registers for a
+ * three-byte transaction burns ~270µs of CPU doing nothing. Once
+ * jh7110_i2c_irq_enable() has routed the controller's PLIC source, a
+ * transaction started with interrupts enabled sleeps instead:
+ *
+ *   thread                                     IRQ
+ *   ──────                                     ───
+ *   fill TX FIFO, set thresholds, unmask
+ *   cpu_idle_wait(&wake) ..................... TX_EMPTY / RX_FULL /
+ *                                              STOP_DET / TX_ABRT
+ *                                              mask, wake = true
+ *   drain RX, refill TX, loop until STOP_DET
+ *
+ * The handler only masks and wakes; all FIFO work stays in the thread,
+ * so there is one copy of it for both modes. Without the route — or
+ * with interrupts masked, as during soc_init() — the same loop polls.
+ * A one-shot timer event bounds the sleep, so a lost interrupt costs
+ * I2C_TIMEOUT_US, not a hang.
+ *
+ * The PLIC source is routed to the boot hart, and timer events are
+ * boot-core only: other cores always poll.
  *
  * CLOCK CONFIGURATION:
  *   The JH7110 APB bus clock is ~100 MHz (from SYS_CRG).
@@ -49,17 +90,55 @@
 #include "i2c.h"
 #include "jh7110_regs.h"
 #include "types.h"
+#include "hal_cpu.h"
+#include "timer.h"
 
 extern void jh7110_uart_puts(const char *str);
 extern void jh7110_uart_puthex(uint64_t val);
 extern void delay_us(uint32_t us);
+extern uint64_t __boot_hart_id;
 
 /* Convenience macro: read/write I2C registers */
 #define I2C_REG(base, offset)   (*((volatile uint32_t *)((base) + (offset))))
 
-/* Timeout for polling operations (in microseconds) */
+/* Timeout for one transaction or bus-idle wait (in microseconds) */
 #define I2C_TIMEOUT_US          10000   /* 10 ms */
 
+/* I2C0-I2C6, 64 KB apart (jh7110_regs.h) */
+#define I2C_CONTROLLERS         7
+#define I2C_INDEX(base)         (((base) - JH7110_I2C0_BASE) >> 16)
+
+#define SIE_SEIE                (1UL << 9)
+
+/* =============================================================================
+ * CONTROLLER STATE
+ * =============================================================================
+ */
+
+typedef struct {
+    uint32_t      tx_depth;     /* FIFO entries, from IC_COMP_PARAM_1 */
+    uint32_t      rx_depth;
+    uint32_t      irq;          /* PLIC source; 0 = not routed, always poll */
+    volatile bool wake;         /* Set by jh7110_i2c_irq() or the timeout */
+} i2c_ctl_t;
+
+static i2c_ctl_t g_ctl[I2C_CONTROLLERS];
+
+static i2c_ctl_t *i2c_ctl(uintptr_t base)
+{
+    return &g_ctl[I2C_INDEX(base)];
+}
+
+/* One transaction in progress: wr_len writes, then rd_len reads */
+typedef struct {
+    const uint8_t *wr;
+    uint32_t       wr_len;
+    uint8_t       *rd;
+    uint32_t       rd_len;
+    uint32_t       issued;      /* Commands pushed into the TX FIFO */
+    uint32_t       received;    /* Bytes taken from the RX FIFO */
+} i2c_xfer_t;
+
 /* =============================================================================
  * LOW-LEVEL I2C CONTROL
  * =============================================================================
@@ -85,25 +164,145 @@ static void i2c_enable(uintptr_t base, bool enable)
 
 static bool i2c_wait_not_busy(uintptr_t base)
 {
-    uint32_t timeout = I2C_TIMEOUT_US;
-    while (timeout--) {
-        uint32_t status = I2C_REG(base, DWI2C_IC_STATUS);
-        if (!(status & DWI2C_STATUS_MST_ACTIVITY)) return true;
-        delay_us(1);
+    uint64_t deadline = hal_timer_get_ticks() + I2C_TIMEOUT_US;
+    while (I2C_REG(base, DWI2C_IC_STATUS) & DWI2C_STATUS_MST_ACTIVITY) {
+        if (hal_timer_get_ticks() >= deadline) {
+            jh7110_uart_puts("[i2c] Timeout waiting for bus idle\n");
+            return false;
+        }
+    }
+    return true;
+}
+
+/* =============================================================================
+ * TRANSACTION ENGINE
+ * =============================================================================
+ */
+
+/* Push as many commands as the TX FIFO — and the RX FIFO behind it — allow */
+static void i2c_fill(uintptr_t base, const i2c_ctl_t *c, i2c_xfer_t *x)
+{
+    uint32_t total = x->wr_len + x->rd_len;
+    uint32_t room  = c->tx_depth - I2C_REG(base, DWI2C_IC_TXFLR);
+
+    while (room > 0 && x->issued < total) {
+        uint32_t i = x->issued;
+        uint32_t cmd;
+
+        if (i < x->wr_len) {
+            cmd = x->wr[i];
+        } else {
+            /* Every read in flight needs a free RX FIFO entry to land in */
+            if (i - x->wr_len - x->received >= c->rx_depth) break;
+            cmd = DWI2C_DATA_CMD_READ;
+            if (i == x->wr_len && x->wr_len != 0) cmd |= DWI2C_DATA_CMD_RESTART;
+        }
+        if (i + 1 == total) cmd |= DWI2C_DATA_CMD_STOP;
+
+        I2C_REG(base, DWI2C_IC_DATA_CMD) = cmd;
+        x->issued++;
+        room--;
+    }
+}
+
+static void i2c_drain(uintptr_t base, i2c_xfer_t *x)
+{
+    uint32_t level = I2C_REG(base, DWI2C_IC_RXFLR);
+    while (level-- > 0 && x->received < x->rd_len) {
+        x->rd[x->received++] = (uint8_t)I2C_REG(base, DWI2C_IC_DATA_CMD);
+    }
+}
+
+/* Interrupt when there's something for the thread to do, then sleep */
+static void i2c_sleep(uintptr_t base, i2c_ctl_t *c, const i2c_xfer_t *x)
+{
+    uint32_t total    = x->wr_len + x->rd_len;
+    uint32_t inflight = (x->issued > x->wr_len) ? x->issued - x->wr_len - x->received : 0;
+    uint32_t mask     = DWI2C_INTR_STOP_DET | DWI2C_INTR_TX_ABRT;
+
+    /* Refill at half empty — unless it's the RX FIFO holding us back */
+    if (x->issued < total && !(x->issued >= x->wr_len && inflight >= c->rx_depth)) {
+        I2C_REG(base, DWI2C_IC_TX_TL) = c->tx_depth / 2;
+        mask |= DWI2C_INTR_TX_EMPTY;
     }
-    jh7110_uart_puts("[i2c] Timeout waiting for bus idle\n");
-    return false;
+    if (inflight > 0) {
+        /* Wake once every read in flight has landed */
+        I2C_REG(base, DWI2C_IC_RX_TL) = inflight - 1;
+        mask |= DWI2C_INTR_RX_FULL;
+    }
+
+    I2C_REG(base, DWI2C_IC_INTR_MASK) = mask;
+    cpu_idle_wait(&c->wake);
 }
 
-static bool i2c_check_abort(uintptr_t base)
+static void i2c_timeout(void *arg)
 {
-    uint32_t raw = I2C_REG(base, DWI2C_IC_RAW_INTR_STAT);
-    if (raw & DWI2C_INTR_TX_ABRT) {
-        /* Clear the abort by reading IC_CLR_TX_ABRT */
-        (void)I2C_REG(base, DWI2C_IC_CLR_TX_ABRT);
-        return true;    /* Abort occurred */
+    ((i2c_ctl_t *)arg)->wake = true;
+}
+
+/* Sleeping needs the PLIC route, IRQs on, and the core both are aimed at */
+static bool i2c_can_sleep(const i2c_ctl_t *c)
+{
+    if (c->irq == 0 || hal_cpu_id() != 0) return false;
+
+    hal_irq_flags_t f = hal_irq_save();
+    hal_irq_restore(f);
+    return f != 0;
+}
+
+static bool i2c_run(uintptr_t base, i2c_xfer_t *x)
+{
+    i2c_ctl_t        *c        = i2c_ctl(base);
+    uint32_t          total    = x->wr_len + x->rd_len;
+    bool              sleep    = i2c_can_sleep(c);
+    bool              ok       = false;
+    hal_timer_event_t timeout  = {0};
+    uint64_t          deadline;
+
+    if (total == 0) return true;
+    if (!i2c_wait_not_busy(base)) return false;
+
+    /* Stale STOP_DET / TX_ABRT from the last transaction */
+    (void)I2C_REG(base, DWI2C_IC_CLR_INTR);
+
+    deadline = hal_timer_get_ticks() + I2C_TIMEOUT_US;
+    if (sleep) {
+        c->wake = false;
+        hal_timer_event_start(&timeout, I2C_TIMEOUT_US, 0, i2c_timeout, c);
+    }
+
+    for (;;) {
+        i2c_fill(base, c, x);
+        i2c_drain(base, x);
+
+        uint32_t raw = I2C_REG(base, DWI2C_IC_RAW_INTR_STAT);
+        if (raw & DWI2C_INTR_TX_ABRT) {
+            (void)I2C_REG(base, DWI2C_IC_CLR_TX_ABRT);
+            break;
+        }
+        if ((raw & DWI2C_INTR_STOP_DET) && x->issued == total) {
+            i2c_drain(base, x);     /* The last byte can land with the STOP */
+            ok = (x->received == x->rd_len);
+            break;
+        }
+        if (hal_timer_get_ticks() >= deadline) {
+            jh7110_uart_puts("[i2c] Transfer timeout\n");
+            break;
+        }
+        if (sleep) i2c_sleep(base, c, x);
     }
-    return false;
+
+    if (sleep) {
+        I2C_REG(base, DWI2C_IC_INTR_MASK) = 0;
+        hal_timer_event_cancel(&timeout);
+    }
+
+    /* After an abort, bytes of the failed read may still be queued */
+    while (I2C_REG(base, DWI2C_IC_RXFLR) != 0) {
+        (void)I2C_REG(base, DWI2C_IC_DATA_CMD);
+    }
+    (void)I2C_REG(base, DWI2C_IC_CLR_STOP_DET);
+    return ok;
 }
 
 /* =============================================================================
@@ -119,6 +318,8 @@ static bool i2c_check_abort(uintptr_t base)
  */
 void jh7110_i2c_init(uintptr_t base, uint8_t addr_7bit)
 {
+    i2c_ctl_t *c = i2c_ctl(base);
+
     /* Disable controller to allow configuration */
     i2c_enable(base, false);
 
@@ -135,13 +336,78 @@ void jh7110_i2c_init(uintptr_t base, uint8_t addr_7bit)
     I2C_REG(base, DWI2C_IC_SS_SCL_HCNT) = DWI2C_SS_SCL_HCNT_100MHZ;
     I2C_REG(base, DWI2C_IC_SS_SCL_LCNT) = DWI2C_SS_SCL_LCNT_100MHZ;
 
-    /* Mask all interrupts (polled mode — we don't use IRQs) */
+    /* Masked until a transaction sleeps on them (see i2c_sleep) */
     I2C_REG(base, DWI2C_IC_INTR_MASK) = 0x0000;
 
+    /* Burst sizes: the FIFOs this controller was built with */
+    uint32_t param = I2C_REG(base, DWI2C_IC_COMP_PARAM_1);
+    c->tx_depth = DWI2C_PARAM_TX_DEPTH(param);
+    c->rx_depth = DWI2C_PARAM_RX_DEPTH(param);
+
     /* Re-enable controller */
     i2c_enable(base, true);
 }
 
+/*
+ * jh7110_i2c_irq_enable — let transactions on this controller sleep
+ *
+ * Routes the controller's PLIC source to the boot hart's S-mode context,
+ * alongside whatever is already enabled there (UART0).
+ *
+ * @param base  I2C controller base address
+ * @param irq   Its PLIC source number (e.g. JH7110_IRQ_I2C6)
+ */
+void jh7110_i2c_irq_enable(uintptr_t base, uint32_t irq)
+{
+    uint32_t           ctx    = JH7110_PLIC_CTX_S((uint32_t)__boot_hart_id);
+    volatile uint32_t *enable = (volatile uint32_t *)(JH7110_PLIC_ENABLE(ctx) + (irq / 32) * 4);
+
+    I2C_REG(base, DWI2C_IC_INTR_MASK) = 0x0000;
+    *(volatile uint32_t *)JH7110_PLIC_PRIORITY(irq) = 1;
+    *enable |= 1u << (irq % 32);
+
+    __asm__ volatile("csrs sie, %0" :: "r"(SIE_SEIE));
+    i2c_ctl(base)->irq = irq;
+}
+
+/*
+ * jh7110_i2c_irq — PLIC dispatch for I2C sources (irq.c)
+ *
+ * Masks the controller so the level-triggered line drops, and wakes the
+ * transaction sleeping on it. Unknown sources are ignored.
+ */
+void jh7110_i2c_irq(uint32_t irq)
+{
+    for (uint32_t i = 0; i < I2C_CONTROLLERS; i++) {
+        if (g_ctl[i].irq == irq) {
+            I2C_REG(JH7110_I2C0_BASE + ((uintptr_t)i << 16), DWI2C_IC_INTR_MASK) = 0x0000;
+            g_ctl[i].wake = true;
+        }
+    }
+}
+
+/*
+ * jh7110_i2c_xfer — one transaction: write, then (RESTART) read
+ *
+ * Either half may be empty. The bytes go out in FIFO-deep bursts, with a
+ * single STOP at the very end.
+ *
+ * @param base    I2C controller base address
+ * @param wr      Bytes to write (typically the register address first)
+ * @param wr_len  How many
+ * @param rd      Output: bytes read after the write
+ * @param rd_len  How many
+ * @return        true on success, false on NACK or timeout
+ */
+bool jh7110_i2c_xfer(uintptr_t base, const uint8_t *wr, uint32_t wr_len,
+                     uint8_t *rd, uint32_t rd_len)
+{
+    if ((wr_len && !wr) || (rd_len && !rd)) return false;
+
+    i2c_xfer_t x = { .wr = wr, .wr_len = wr_len, .rd = rd, .rd_len = rd_len };
+    return i2c_run(base, &x);
+}
+
 /*
  * jh7110_i2c_write_reg — write a single byte to a device register
  *
@@ -152,18 +418,8 @@ void jh7110_i2c_init(uintptr_t base, uint8_t addr_7bit)
  */
 bool jh7110_i2c_write_reg(uintptr_t base, uint8_t reg, uint8_t data)
 {
-    if (!i2c_wait_not_busy(base)) return false;
-
-    /* Write register address (no STOP — more data follows) */
-    I2C_REG(base, DWI2C_IC_DATA_CMD) = (uint32_t)reg;
-
-    /* Write data byte with STOP to end the transfer */
-    I2C_REG(base, DWI2C_IC_DATA_CMD) = (uint32_t)data | DWI2C_DATA_CMD_STOP;
-
-    /* Wait for transfer to complete */
-    if (!i2c_wait_not_busy(base)) return false;
-
-    return !i2c_check_abort(base);
+    uint8_t buf[2] = { reg, data };
+    return jh7110_i2c_xfer(base, buf, 2, NULL, 0);
 }
 
 /*
@@ -177,34 +433,15 @@ bool jh7110_i2c_write_reg(uintptr_t base, uint8_t reg, uint8_t data)
 bool jh7110_i2c_read_reg(uintptr_t base, uint8_t reg, uint8_t *data)
 {
     if (!data) return false;
-    if (!i2c_wait_not_busy(base)) return false;
-
-    /* Write register address (no STOP — RESTART will follow for read) */
-    I2C_REG(base, DWI2C_IC_DATA_CMD) = (uint32_t)reg;
-
-    /* Issue read command with STOP */
-    I2C_REG(base, DWI2C_IC_DATA_CMD) = DWI2C_DATA_CMD_READ |
-                                        DWI2C_DATA_CMD_STOP;
-
-    /* Wait for RX data to arrive */
-    uint32_t timeout = I2C_TIMEOUT_US;
-    while (timeout--) {
-        if (i2c_check_abort(base)) return false;
-        if (I2C_REG(base, DWI2C_IC_STATUS) & DWI2C_STATUS_RFNE) break;
-        delay_us(1);
-    }
-    if (timeout == 0) {
-        jh7110_uart_puts("[i2c] Read timeout\n");
-        return false;
-    }
-
-    *data = (uint8_t)(I2C_REG(base, DWI2C_IC_DATA_CMD) & 0xFF);
-    return true;
+    return jh7110_i2c_xfer(base, &reg, 1, data, 1);
 }
 
 /*
  * jh7110_i2c_read_regs — read multiple consecutive bytes
  *
+ * One transaction: the device auto-increments its register address after
+ * each byte, so the address goes out once, not once per byte.
+ *
  * @param base   I2C controller base address
  * @param reg    Starting register address
  * @param buf    Output buffer
@@ -214,8 +451,5 @@ bool jh7110_i2c_read_reg(uintptr_t base, uint8_t reg, uint8_t *data)
 bool jh7110_i2c_read_regs(uintptr_t base, uint8_t reg,
                            uint8_t *buf, uint32_t count)
 {
-    for (uint32_t i = 0; i < count; i++) {
-        if (!jh7110_i2c_read_reg(base, reg + i, &buf[i])) return false;
-    }
-    return true;
-}
\ No newline at end of file
+    return jh7110_i2c_xfer(base, &reg, 1, buf, count);
+}
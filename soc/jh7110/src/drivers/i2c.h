@@ -8,8 +8,12 @@
 #include "types.h"
 
 void jh7110_i2c_init(uintptr_t base, uint8_t addr_7bit);
+void jh7110_i2c_irq_enable(uintptr_t base, uint32_t irq);
+void jh7110_i2c_irq(uint32_t irq);
+bool jh7110_i2c_xfer(uintptr_t base, const uint8_t *wr, uint32_t wr_len,
+                     uint8_t *rd, uint32_t rd_len);
 bool jh7110_i2c_write_reg(uintptr_t base, uint8_t reg, uint8_t data);
 bool jh7110_i2c_read_reg(uintptr_t base, uint8_t reg, uint8_t *data);
 bool jh7110_i2c_read_regs(uintptr_t base, uint8_t reg, uint8_t *buf, uint32_t count);
 
-#endif /* JH7110_I2C_H */
\ No newline at end of file
+#endif /* JH7110_I2C_H */
@@ -57,6 +57,23 @@
  *   The AXP15060 has a proper datasheet and a clean kernel driver to reference.
  *   This is a common pattern: dedicated PMIC vendors (X-Powers, Maxim, TI)
  *   publish full documentation. SoC-integrated or SoC-vendor PMICs often don't.
+ *
+ * REGISTER SHADOW:
+ * ================
+ * Every register read is an I2C transaction — ~300µs at 100 kHz — and
+ * the dashboard asks for rail voltages and status over and over. Most of
+ * those registers only change when someone writes them, and the only one
+ * writing them is this driver. So configuration registers are kept in a
+ * write-through shadow:
+ *
+ *   read   shadow valid? → answer from RAM, no bus traffic
+ *          otherwise     → read over I2C, remember it
+ *   write  over I2C first; the shadow is updated only if the PMIC ACKed
+ *
+ * axp15060_init() fills the whole DCDC block in one burst read, so voltage
+ * queries never touch the bus afterwards. Registers the PMIC itself
+ * changes — power status, GPADC results, IRQ status — are never cached
+ * (axp_cacheable() decides).
  */
 
 #include "pmic_axp15060.h"
@@ -141,6 +158,68 @@ extern void jh7110_uart_putc(char c);
 static bool g_pmic_initialized = false;
 static uint8_t g_chip_id = 0;
 
+/* Write-through shadow of the configuration registers (see REGISTER SHADOW) */
+static uint8_t  g_shadow[256];
+static uint32_t g_shadow_valid[256 / 32];
+
+/* =============================================================================
+ * REGISTER ACCESS
+ * =============================================================================
+ */
+
+/* Configuration the PMIC never changes by itself */
+static bool axp_cacheable(uint8_t reg)
+{
+    return reg == AXP15060_CHIP_ID_REG ||
+           (reg >= AXP15060_DCDC1_CTRL && reg <= AXP15060_DCDC_EN) ||
+           (reg >= AXP15060_ALDO1_CTRL && reg <= AXP15060_ALDO5_CTRL) ||
+           reg == AXP15060_IRQ_EN1 || reg == AXP15060_IRQ_EN2 ||
+           reg == AXP15060_TS_PIN_CFG || reg == AXP15060_GPADC_CTRL ||
+           reg == AXP15060_THERMAL_THRESH;
+}
+
+static bool axp_shadow_valid(uint8_t reg)
+{
+    return (g_shadow_valid[reg / 32] >> (reg % 32)) & 1;
+}
+
+static void axp_shadow_set(uint8_t reg, uint8_t val)
+{
+    if (!axp_cacheable(reg)) return;
+    g_shadow[reg] = val;
+    g_shadow_valid[reg / 32] |= 1u << (reg % 32);
+}
+
+/* Read count consecutive registers: from the shadow, or in one transaction */
+static bool axp_read_regs(uint8_t reg, uint8_t *buf, uint32_t count)
+{
+    bool cached = true;
+    for (uint32_t i = 0; i < count && cached; i++) {
+        cached = axp_shadow_valid((uint8_t)(reg + i));
+    }
+
+    if (cached) {
+        for (uint32_t i = 0; i < count; i++) buf[i] = g_shadow[reg + i];
+        return true;
+    }
+
+    if (!jh7110_i2c_read_regs(PMIC_I2C_BASE, reg, buf, count)) return false;
+    for (uint32_t i = 0; i < count; i++) axp_shadow_set((uint8_t)(reg + i), buf[i]);
+    return true;
+}
+
+static bool axp_read(uint8_t reg, uint8_t *val)
+{
+    return axp_read_regs(reg, val, 1);
+}
+
+static bool axp_write(uint8_t reg, uint8_t val)
+{
+    if (!jh7110_i2c_write_reg(PMIC_I2C_BASE, reg, val)) return false;
+    axp_shadow_set(reg, val);
+    return true;
+}
+
 /* =============================================================================
  * INITIALIZATION
  * =============================================================================
@@ -160,7 +239,7 @@ int axp15060_init(void)
     jh7110_i2c_init(PMIC_I2C_BASE, PMIC_I2C_ADDR);
 
     /* Read chip ID register */
-    if (!jh7110_i2c_read_reg(PMIC_I2C_BASE, AXP15060_CHIP_ID_REG, &g_chip_id)) {
+    if (!axp_read(AXP15060_CHIP_ID_REG, &g_chip_id)) {
         jh7110_uart_puts("[pmic] ERROR: I2C read failed — PMIC not responding\n");
         return -1;
     }
@@ -174,6 +253,13 @@ int axp15060_init(void)
         /* Continue anyway — register layout may still be compatible */
     }
 
+    /* DCDC1-8 and the enable register: one burst instead of nine reads */
+    uint8_t dcdc[AXP15060_DCDC_EN - AXP15060_DCDC1_CTRL + 1];
+    (void)axp_read_regs(AXP15060_DCDC1_CTRL, dcdc, sizeof(dcdc));
+
+    /* From here on, transactions sleep instead of spinning */
+    jh7110_i2c_irq_enable(PMIC_I2C_BASE, JH7110_AXP15060_I2C_IRQ);
+
     g_pmic_initialized = true;
     jh7110_uart_puts("[pmic] AXP15060 init OK\n");
     return 0;
@@ -218,22 +304,24 @@ int axp15060_get_temperature(int32_t *temp_mc)
 
     /* Enable GPADC measurement (bit 5 in GPADC_CTRL enables TS channel) */
     uint8_t ctrl;
-    if (!jh7110_i2c_read_reg(PMIC_I2C_BASE, AXP15060_GPADC_CTRL, &ctrl))
+    if (!axp_read(AXP15060_GPADC_CTRL, &ctrl))
         return -1;
 
     /* Enable TS pin ADC measurement (bit 5) */
     uint8_t ctrl_new = ctrl | (1 << 5);
     if (ctrl_new != ctrl) {
-        if (!jh7110_i2c_write_reg(PMIC_I2C_BASE, AXP15060_GPADC_CTRL, ctrl_new))
+        if (!axp_write(AXP15060_GPADC_CTRL, ctrl_new))
             return -1;
     }
 
-    /* Read 12-bit GPADC result (2 registers: high byte + low 4 bits) */
-    uint8_t adc_h, adc_l;
-    if (!jh7110_i2c_read_reg(PMIC_I2C_BASE, AXP15060_GPADC_H, &adc_h)) return -1;
-    if (!jh7110_i2c_read_reg(PMIC_I2C_BASE, AXP15060_GPADC_L, &adc_l)) return -1;
+    /*
+     * Read 12-bit GPADC result (2 registers: high byte + low 4 bits).
+     * One burst, so both halves come from the same conversion.
+     */
+    uint8_t adc[2];
+    if (!axp_read_regs(AXP15060_GPADC_H, adc, 2)) return -1;
 
-    uint32_t raw_adc = ((uint32_t)adc_h << 4) | (adc_l & 0x0F);
+    uint32_t raw_adc = ((uint32_t)adc[0] << 4) | (adc[1] & 0x0F);
 
     /*
      * Rough temperature approximation:
@@ -277,7 +365,7 @@ int axp15060_read_dcdc_voltage(uint8_t dcdc_num, uint32_t *mv_out)
 
     uint8_t reg = AXP15060_DCDC1_CTRL + (dcdc_num - 1);
     uint8_t val;
-    if (!jh7110_i2c_read_reg(PMIC_I2C_BASE, reg, &val)) return -1;
+    if (!axp_read(reg, &val)) return -1;
 
     /*
      * AXP15060 DCDC voltage encoding (from AXP15060 datasheet):
@@ -319,7 +407,7 @@ void axp15060_print_status(void)
 
     /* Read and display power status */
     uint8_t pwr_status;
-    if (jh7110_i2c_read_reg(PMIC_I2C_BASE, 0x00, &pwr_status)) {
+    if (axp_read(0x00, &pwr_status)) {
         jh7110_uart_puts("  Power Status: 0x");
         jh7110_uart_puthex((uint64_t)pwr_status);
         jh7110_uart_putc('\n');
@@ -327,7 +415,7 @@ void axp15060_print_status(void)
 
     /* Read DCDC enable register */
     uint8_t dcdc_en;
-    if (jh7110_i2c_read_reg(PMIC_I2C_BASE, AXP15060_DCDC_EN, &dcdc_en)) {
+    if (axp_read(AXP15060_DCDC_EN, &dcdc_en)) {
         jh7110_uart_puts("  DCDC Enable: 0x");
         jh7110_uart_puthex((uint64_t)dcdc_en);
         jh7110_uart_putc('\n');
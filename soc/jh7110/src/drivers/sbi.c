@@ -30,6 +30,7 @@
  *   0x10 FID1   — Extension probe (check if an extension is present)
  *   0x54494D45  — SBI Timer (set_timer)
  *   0x48534D   — Hart State Management (hart_start, hart_stop)
+ *   0x4442434E  — Debug Console (write a whole buffer per ecall)
  *
  * CPU CSR READS:
  *   RISC-V CSRs mvendorid, marchid, mimpid are M-mode only.
@@ -157,6 +158,71 @@ void jh7110_sbi_get_cpu_info(jh7110_cpu_info_t *info)
     info->sbi_spec_minor = spec & 0xFFFFFF;
 }
 
+/* =============================================================================
+ * HART STATE MANAGEMENT (EID 0x48534D)
+ * =============================================================================
+ *
+ * hart_start (FID 0) asks OpenSBI to start a STOPPED hart at start_addr in
+ * S-mode, with a0 = hartid, a1 = opaque and the MMU off. It returns as soon
+ * as the request is accepted; the hart may not have executed anything yet.
+ *
+ * Returns 0 on success or a negative SBI error (e.g. -6 ALREADY_AVAILABLE
+ * if the hart is already running, -3 INVALID_PARAM for a bad hart ID).
+ */
+
+long sbi_hart_start(unsigned long hartid, unsigned long start_addr,
+                    unsigned long opaque)
+{
+    sbi_ret_t ret = sbi_ecall(SBI_EXT_HSM, 0, (long)hartid, (long)start_addr,
+                              (long)opaque, 0, 0, 0);
+    return ret.error;
+}
+
+/* =============================================================================
+ * SBI TIMER EXTENSION (EID 0x54494D45 "TIME")
+ * =============================================================================
+ *
+ * S-mode can't write mtimecmp itself; it asks OpenSBI to. set_timer
+ * programs this hart's compare (in raw 24 MHz rdtime ticks) and clears a
+ * pending supervisor timer interrupt (sip.STIP). The interrupt stays
+ * asserted while time >= stime_value, so programming UINT64_MAX is how
+ * you "switch it off".
+ *
+ * OpenSBI older than v0.2 only has the legacy call (EID 0x00), which takes
+ * the same argument; use it if TIME isn't there.
+ */
+
+long sbi_set_timer(uint64_t stime_value)
+{
+    static int have_time = -1;
+
+    if (have_time < 0) {
+        have_time = sbi_probe_extension(SBI_EXT_TIME) != 0;
+    }
+
+    sbi_ret_t ret = have_time
+        ? sbi_ecall(SBI_EXT_TIME, 0, (long)stime_value, 0, 0, 0, 0, 0)
+        : sbi_ecall(0x00, 0, (long)stime_value, 0, 0, 0, 0, 0);
+    return ret.error;
+}
+
+/* =============================================================================
+ * SBI DEBUG CONSOLE EXTENSION (EID 0x4442434E "DBCN")
+ * =============================================================================
+ *
+ * console_write (FID 0) takes the buffer as a physical address split into
+ * low (a1) and high (a2) halves. Our page tables identity-map DRAM, so the
+ * virtual address of a kernel buffer IS its physical address. OpenSBI may
+ * write fewer bytes than asked; the count comes back in value.
+ */
+
+long sbi_debug_console_write(const char *buf, unsigned long len)
+{
+    sbi_ret_t ret = sbi_ecall(SBI_EXT_DBCN, 0, (long)len, (long)(uintptr_t)buf,
+                              0, 0, 0, 0);
+    return ret.error == 0 ? ret.value : ret.error;
+}
+
 /* =============================================================================
  * SYSTEM CONTROL
  * =============================================================================
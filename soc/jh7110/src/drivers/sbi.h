@@ -29,6 +29,23 @@ long sbi_get_mimpid(void);
 /* JH7110-specific CPU info collection */
 void jh7110_sbi_get_cpu_info(jh7110_cpu_info_t *info);
 
+/* Hart State Management (EID 0x48534D "HSM") */
+#define SBI_EXT_HSM     0x48534DL
+long sbi_hart_start(unsigned long hartid, unsigned long start_addr,
+                    unsigned long opaque);
+
+/* Timer (EID 0x54494D45 "TIME") — stime_value in raw rdtime ticks */
+#define SBI_EXT_TIME    0x54494D45L
+long sbi_set_timer(uint64_t stime_value);
+
+/*
+ * Debug Console (EID 0x4442434E "DBCN") — one ecall for a whole buffer.
+ * Returns bytes written (possibly fewer than len), or a negative SBI
+ * error. Check sbi_probe_extension(SBI_EXT_DBCN) first.
+ */
+#define SBI_EXT_DBCN    0x4442434EL
+long sbi_debug_console_write(const char *buf, unsigned long len);
+
 /* System control */
 void sbi_shutdown(void);
 void sbi_reboot(void);
@@ -47,6 +47,7 @@
 
 #include "jh7110_regs.h"
 #include "types.h"
+#include "hal_types.h"
 
 extern void jh7110_uart_puts(const char *str);
 extern void jh7110_uart_putdec(uint32_t val);
@@ -241,4 +242,48 @@ void hal_gpio_set_low(uint32_t pin)
 bool hal_gpio_read(uint32_t pin)
 {
     return jh7110_gpio_read(pin) != 0;
-}
\ No newline at end of file
+}
+
+/* =============================================================================
+ * BULK OPERATIONS
+ * =============================================================================
+ *
+ * There is no set/clear register pair to write a whole bank through —
+ * each pin has its own DOUT word. A bulk write is one store per pin in
+ * the mask, lowest pin first, so hal_gpio_get_port() keeps its weak
+ * NOT_SUPPORTED default and waveform replay comes through here.
+ */
+
+static void jh7110_gpio_write_mask(uint32_t mask, uint32_t bank, uint32_t value)
+{
+    while (mask != 0) {
+        uint32_t bit = (uint32_t)__builtin_ctz(mask);
+        *((volatile uint32_t *)JH7110_GPIO_DOUT(bank * 32 + bit)) = value;
+        mask &= mask - 1;
+    }
+}
+
+hal_error_t hal_gpio_set_mask(uint32_t mask, uint32_t bank)
+{
+    if (bank > 1) return HAL_ERROR_INVALID_ARG;
+    jh7110_gpio_write_mask(mask, bank, 1);
+    return HAL_SUCCESS;
+}
+
+hal_error_t hal_gpio_clear_mask(uint32_t mask, uint32_t bank)
+{
+    if (bank > 1) return HAL_ERROR_INVALID_ARG;
+    jh7110_gpio_write_mask(mask, bank, 0);
+    return HAL_SUCCESS;
+}
+
+uint32_t hal_gpio_read_mask(uint32_t bank)
+{
+    uint32_t levels = 0;
+
+    if (bank > 1) return 0;
+    for (uint32_t bit = 0; bit < 32; bit++) {
+        levels |= jh7110_gpio_read(bank * 32 + bit) << bit;
+    }
+    return levels;
+}
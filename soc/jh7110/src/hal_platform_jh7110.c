@@ -42,9 +42,11 @@
 
 #include "types.h"
 #include "hal_platform.h"
+#include "hal_cpu.h"
 #include "hal_types.h"
 #include "hal_gpio.h"
 #include "jh7110_regs.h"
+#include "fdt.h"
 #include "drivers/sbi.h"
 #include "drivers/pmic_axp15060.h"
 
@@ -58,6 +60,7 @@ extern void jh7110_uart_putc(char c);
 extern void jh7110_uart_puts(const char *str);
 extern void jh7110_uart_puthex(uint64_t val);
 extern void jh7110_uart_putdec(uint32_t val);
+extern void jh7110_uart_flush(void);
 
 /* timer.c */
 extern void delay_ms(uint32_t ms);
@@ -126,6 +129,18 @@ hal_error_t hal_platform_init(void)
     jh7110_uart_puts(g_cpu_info.core_name);
     jh7110_uart_putc('\n');
 
+    /*
+     * Index the DTB once. Every later lookup — the framebuffer node, the
+     * memory banks — is answered from the index instead of a fresh walk.
+     */
+    if (fdt_init((const void *)(uintptr_t)__dtb_ptr)) {
+        jh7110_uart_puts("[hal] DTB: ");
+        jh7110_uart_putdec(fdt_node_count());
+        jh7110_uart_puts(" nodes indexed\n");
+    } else {
+        jh7110_uart_puts("[hal] DTB: not indexed, using built-in defaults\n");
+    }
+
     /* Measure CPU frequency */
     uint32_t freq_mhz = jh7110_measure_cpu_freq(10);
     g_measured_cpu_freq_hz = freq_mhz * 1000000UL;
@@ -133,8 +148,7 @@ hal_error_t hal_platform_init(void)
     jh7110_uart_putdec(freq_mhz);
     jh7110_uart_puts(" MHz\n");
 
-    /* Initialize PMIC */
-    axp15060_init();
+    /* PMIC bring-up is deferred to hal_platform_late_init() */
 
     /* Initialize heartbeat LED (no-op on Mars, but API is uniform) */
     jh7110_gpio_init_heartbeat_led();
@@ -149,6 +163,19 @@ bool hal_platform_is_initialized(void)
     return g_platform_initialized;
 }
 
+hal_error_t hal_platform_late_init(void)
+{
+    /*
+     * The AXP15060 probe is a chip-ID read plus configuration over I2C6
+     * at 100 kHz — a few milliseconds the first frame doesn't need.
+     * Until it's done, hal_platform_get_temperature() reports "N/A".
+     */
+    if (!axp15060_is_available() && axp15060_init() != 0) {
+        return HAL_ERROR_NOT_SUPPORTED;
+    }
+    return HAL_SUCCESS;
+}
+
 /* =============================================================================
  * PLATFORM INFORMATION
  * =============================================================================
@@ -195,6 +222,13 @@ hal_error_t hal_platform_get_info(hal_platform_info_t *info)
  * =============================================================================
  */
 
+/* DRAM size from the DTB memory node(s), the 8 GB board if there is none */
+static uint64_t jh7110_dram_size(void)
+{
+    uint64_t total = fdt_memory_total();
+    return total ? total : JH7110_TOTAL_RAM;
+}
+
 hal_error_t hal_platform_get_memory_info(hal_memory_info_t *info)
 {
     if (!info) return HAL_ERROR_NULL_PTR;
@@ -206,7 +240,7 @@ hal_error_t hal_platform_get_memory_info(hal_memory_info_t *info)
      * region like the Ky X1 does for its DPU at 0x2FF40000.
      */
     info->arm_base        = 0x40000000UL;        /* DRAM starts here */
-    info->arm_size        = JH7110_TOTAL_RAM;    /* 8 GB */
+    info->arm_size        = jh7110_dram_size();  /* 8 GB on the Mars 8GB */
     info->gpu_base        = 0;                   /* No dedicated GPU memory */
     info->gpu_size        = 0;
     info->peripheral_base = JH7110_PERI_BASE;    /* 0x10000000 */
@@ -216,12 +250,12 @@ hal_error_t hal_platform_get_memory_info(hal_memory_info_t *info)
 
 size_t hal_platform_get_arm_memory(void)
 {
-    return (size_t)JH7110_TOTAL_RAM;
+    return (size_t)jh7110_dram_size();
 }
 
 size_t hal_platform_get_total_memory(void)
 {
-    return (size_t)JH7110_TOTAL_RAM;
+    return (size_t)jh7110_dram_size();
 }
 
 /* =============================================================================
@@ -366,6 +400,55 @@ bool fb_init_with_size(framebuffer_t *fb, uint32_t width, uint32_t height)
     return fb_init(fb);
 }
 
+/* =============================================================================
+ * MULTICORE
+ * =============================================================================
+ *
+ * The JH7110 has five harts: hart 0 is the S7 monitor core (RV64IMAC, no
+ * MMU, no FPU — it must never run kernel code) and harts 1-4 are the U74
+ * application cores. Logical CPU 0 is whichever U74 booted; the others are
+ * numbered upwards from there, wrapping within 1-4.
+ *
+ * OpenSBI holds the other U74s in the HSM STOPPED state, so starting one
+ * is a single sbi_hart_start() to riscv_secondary_start. The U74 caches
+ * are coherent across cores, so no cache maintenance is needed on the boot
+ * block — just a fence before the ecall.
+ */
+
+#define JH7110_FIRST_U74_HART   1
+
+/* boot/riscv64/common_init.S */
+extern void riscv_secondary_start(void);
+
+uint32_t hal_platform_get_cpu_count(void)
+{
+    if (sbi_probe_extension(SBI_EXT_HSM) == 0) {
+        return 1;
+    }
+    return JH7110_NUM_CORES_CONST;
+}
+
+hal_error_t hal_platform_start_cpu(uint32_t cpu, hal_cpu_boot_t *boot)
+{
+    if (boot == NULL) return HAL_ERROR_NULL_PTR;
+    if (cpu == 0 || cpu >= JH7110_NUM_CORES_CONST) return HAL_ERROR_INVALID_ARG;
+
+    uint64_t boot_index = __boot_hart_id - JH7110_FIRST_U74_HART;
+    uint64_t hart = JH7110_FIRST_U74_HART +
+                    (boot_index + cpu) % JH7110_NUM_CORES_CONST;
+
+    uint64_t satp;
+    __asm__ volatile("csrr %0, satp" : "=r"(satp));
+    boot->mmu[0] = satp;
+    __asm__ volatile("fence rw, rw" ::: "memory");
+
+    if (sbi_hart_start(hart, (uintptr_t)riscv_secondary_start,
+                       (uintptr_t)boot) != 0) {
+        return HAL_ERROR_HARDWARE;
+    }
+    return HAL_SUCCESS;
+}
+
 /* =============================================================================
  * PANIC
  * =============================================================================
@@ -383,14 +466,15 @@ hal_error_t hal_platform_shutdown(void)
     return HAL_SUCCESS;
 }
 
+/* hal_debug_puts() / hal_debug_printf() are portable: kernel/src/debug.c */
 void hal_debug_putc(char c) { jh7110_uart_putc(c); }
-void hal_debug_puts(const char *s) { jh7110_uart_puts(s); }
 
 void hal_panic(const char *msg)
 {
     jh7110_uart_puts("\n[PANIC] ");
     jh7110_uart_puts(msg ? msg : "(null)");
     jh7110_uart_puts("\n[PANIC] System halted\n");
+    jh7110_uart_flush();
     while (1) __asm__ volatile("wfi");
 }
 
@@ -436,6 +520,69 @@ uint32_t hal_platform_get_clock_rate(hal_clock_id_t clock_id)
     }
 }
 
+/*
+ * Setting the CPU clock: cpu_core = PLL0 / divider. Only the divider is
+ * ours to move. PLL0 and the CPU rail on the AXP15060 stay as U-Boot
+ * left them, which is the voltage for the boot rate — so the boot rate is
+ * the ceiling, and anything slower is one of PLL0 / (boot div .. 7).
+ *
+ * PLL0 itself is recovered from the measured boot frequency and the boot
+ * divider, the first time it is needed.
+ */
+static uint32_t g_cpu_root_hz;
+static uint32_t g_cpu_boot_div;
+
+static uint32_t jh7110_cpu_div(void)
+{
+    uint32_t div = *((volatile uint32_t *)JH7110_SYS_CRG_CPU_CORE) & JH7110_CRG_DIV_MASK;
+    return div ? div : 1;
+}
+
+static bool jh7110_cpu_root_probe(void)
+{
+    if (g_cpu_root_hz) return true;
+
+    uint32_t hz = hal_platform_get_arm_freq_measured();
+    if (hz == 0) return false;
+
+    g_cpu_boot_div = jh7110_cpu_div();
+    if (g_cpu_boot_div > JH7110_CPU_CORE_DIV_MAX) return false;
+    g_cpu_root_hz = hz * g_cpu_boot_div;
+    return true;
+}
+
+hal_error_t hal_platform_get_clock_limits(hal_clock_id_t clock_id,
+                                          uint32_t *min_hz, uint32_t *max_hz)
+{
+    if (!min_hz || !max_hz) return HAL_ERROR_NULL_PTR;
+    if (clock_id != HAL_CLOCK_ARM) return HAL_ERROR_NOT_SUPPORTED;
+    if (!jh7110_cpu_root_probe()) return HAL_ERROR_NOT_SUPPORTED;
+
+    *min_hz = g_cpu_root_hz / JH7110_CPU_CORE_DIV_MAX;
+    *max_hz = g_cpu_root_hz / g_cpu_boot_div;
+    return HAL_SUCCESS;
+}
+
+hal_error_t hal_platform_set_clock_rate(hal_clock_id_t clock_id, uint32_t hz,
+                                        uint32_t *actual_hz)
+{
+    if (clock_id != HAL_CLOCK_ARM) return HAL_ERROR_NOT_SUPPORTED;
+    if (!jh7110_cpu_root_probe()) return HAL_ERROR_NOT_SUPPORTED;
+    if (hz < g_cpu_root_hz / JH7110_CPU_CORE_DIV_MAX) return HAL_ERROR_INVALID_ARG;
+
+    /* Smallest divider that doesn't overshoot, never below the boot one */
+    uint32_t div = (g_cpu_root_hz + hz - 1) / hz;
+    if (div < g_cpu_boot_div) div = g_cpu_boot_div;
+    if (div > JH7110_CPU_CORE_DIV_MAX) div = JH7110_CPU_CORE_DIV_MAX;
+
+    volatile uint32_t *reg = (volatile uint32_t *)JH7110_SYS_CRG_CPU_CORE;
+    *reg = (*reg & ~JH7110_CRG_DIV_MASK) | div;
+
+    g_measured_cpu_freq_hz = g_cpu_root_hz / div;
+    if (actual_hz) *actual_hz = g_measured_cpu_freq_hz;
+    return HAL_SUCCESS;
+}
+
 /* =============================================================================
  * POWER MANAGEMENT
  * =============================================================================
@@ -506,6 +653,23 @@ void clean_dcache_range(uintptr_t start, size_t size)
     jh7110_l2_flush_range(start, size);
 }
 
+/* Flush64 writes back AND evicts: clean and flush are the same walk */
+void flush_dcache_range(uintptr_t start, size_t size)
+{
+    jh7110_l2_flush_range(start, size);
+}
+
+/*
+ * No invalidate exists. FROM_DEVICE data reaches us through the coherent
+ * TileLink fabric (see soc/jh7110/src/dma.c), so ordering is all we need.
+ */
+void invalidate_dcache_range(uintptr_t start, size_t size)
+{
+    (void)start;
+    (void)size;
+    __asm__ volatile("fence iorw, iorw" ::: "memory");
+}
+
 void handle_exception(void *frame, unsigned long scause, unsigned long stval)
 {
     (void)frame;
@@ -534,6 +698,7 @@ void handle_exception(void *frame, unsigned long scause, unsigned long stval)
     case 15: jh7110_uart_puts("[TRAP] Store page fault\n"); break;
     default: jh7110_uart_puts("[TRAP] Unknown cause\n"); break;
     }
+    jh7110_uart_flush();
 
     while (1) __asm__ volatile("wfi");
 }
\ No newline at end of file
@@ -0,0 +1,66 @@
+/*
+ * irq.c — Interrupt Dispatch for the StarFive JH-7110 SoC
+ * ========================================================
+ *
+ * Provides handle_interrupt(), which overrides the weak default in
+ * boot/riscv64/vectors.S (that one prints 'I' and halts). trap_vector has
+ * already saved the trap frame and stripped the interrupt bit from
+ * scause, so `cause` is the plain interrupt number:
+ *
+ *   1 — supervisor software interrupt (IPI)      not used yet
+ *   5 — supervisor timer interrupt (SBI timer)   → hal_timer_irq()
+ *   9 — supervisor external interrupt (PLIC)     → claim, dispatch, complete
+ *
+ * Only causes whose bit is set in sie can arrive: hal_timer_irq_init()
+ * sets STIE and jh7110_uart_init_hw() sets SEIE. The PLIC sources enabled
+ * are UART0 TX and, once the PMIC is up, I2C6 (jh7110_i2c_irq_enable());
+ * anything else is ignored. sret
+ * restores the interrupted context and sstatus.SIE from SPIE.
+ */
+
+#include "jh7110_regs.h"
+#include "types.h"
+#include "hal_timer.h"
+
+extern uint64_t __boot_hart_id;
+extern void jh7110_uart_irq(void);
+extern void jh7110_i2c_irq(uint32_t irq);
+
+#define IRQ_S_SOFT      1
+#define IRQ_S_TIMER     5
+#define IRQ_S_EXT       9
+
+/*
+ * Claiming returns the highest-priority pending source (0 = none) and
+ * holds it off until the same number is written back as "complete".
+ * Loop so a source that became pending meanwhile doesn't need a re-trap.
+ */
+static void plic_dispatch(void)
+{
+    volatile uint32_t *claim =
+        (volatile uint32_t *)JH7110_PLIC_CLAIM(JH7110_PLIC_CTX_S((uint32_t)__boot_hart_id));
+    uint32_t irq;
+
+    while ((irq = *claim) != 0) {
+        if (irq == JH7110_IRQ_UART0) jh7110_uart_irq();
+        else                         jh7110_i2c_irq(irq);
+        *claim = irq;
+    }
+}
+
+void handle_interrupt(void *frame, unsigned long cause)
+{
+    (void)frame;
+
+    switch (cause) {
+        case IRQ_S_TIMER:
+            /* Level-triggered: hal_timer_irq() reprograms, which clears it */
+            hal_timer_irq();
+            break;
+        case IRQ_S_EXT:
+            plic_dispatch();
+            break;
+        default:
+            break;
+    }
+}
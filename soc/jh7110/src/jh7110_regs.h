@@ -93,6 +93,17 @@
 #define JH7110_PLIC_ENABLE(ctx)     (JH7110_PLIC_BASE + 0x2000 + (ctx) * 0x80)
 #define JH7110_PLIC_THRESHOLD(ctx)  (JH7110_PLIC_BASE + 0x200000 + (ctx) * 0x1000)
 #define JH7110_PLIC_CLAIM(ctx)      (JH7110_PLIC_BASE + 0x200004 + (ctx) * 0x1000)
+#define JH7110_PLIC_NUM_SOURCES     136
+
+/*
+ * Hart 0 (S7) has only an M-mode context, so U74 hart h (1-4) owns
+ * contexts 2h - 1 (M) and 2h (S).
+ */
+#define JH7110_PLIC_CTX_S(hart)     ((hart) * 2)
+
+/* PLIC source numbers */
+#define JH7110_IRQ_UART0            32
+#define JH7110_IRQ_I2C6             51      /* Linux jh7110.dtsi */
 
 /* =============================================================================
  * UART — SYNOPSYS DESIGNWARE 8250 / 16550-COMPATIBLE
@@ -145,6 +156,15 @@
 #define UART8250_LCR_PEN_NONE       0x00    /* No parity */
 #define UART8250_LCR_DLAB           0x80    /* Divisor Latch Access Bit */
 
+/* IER bits */
+#define UART8250_IER_ERBFI          0x01    /* RX data available */
+#define UART8250_IER_ETBEI          0x02    /* TX holding register empty */
+
+/* IIR bits (low nibble = interrupt ID) */
+#define UART8250_IIR_ID_MASK        0x0F
+#define UART8250_IIR_NONE           0x01    /* No interrupt pending */
+#define UART8250_IIR_THRE           0x02    /* THR empty */
+
 /* FCR bits */
 #define UART8250_FCR_FIFO_EN        0x01    /* Enable FIFO */
 #define UART8250_FCR_RX_RESET       0x02    /* Reset RX FIFO */
@@ -156,6 +176,13 @@
 #define UART8250_LSR_THRE           0x20    /* Transmit Holding Register Empty */
 #define UART8250_LSR_TEMT           0x40    /* Transmitter Empty (shift + THR) */
 
+/*
+ * With FIFOs on, THRE means the whole TX FIFO is empty, so that many
+ * bytes can go in without another LSR read. 16 is the 16550 minimum;
+ * the DW_apb_uart instance on the JH7110 is built with at least that.
+ */
+#define UART8250_TX_FIFO_DEPTH      16
+
 /* Clock configuration */
 #define JH7110_UART_CLK_HZ          24000000UL  /* 24 MHz from OSC */
 #define JH7110_UART_BAUD            115200
@@ -197,11 +224,14 @@
 #define DWI2C_IC_INTR_STAT          0x2C    /* Interrupt status */
 #define DWI2C_IC_INTR_MASK          0x30    /* Interrupt mask */
 #define DWI2C_IC_RAW_INTR_STAT      0x34    /* Raw interrupt status */
+#define DWI2C_IC_RX_TL              0x38    /* RX_FULL when RXFLR > this */
+#define DWI2C_IC_TX_TL              0x3C    /* TX_EMPTY when TXFLR <= this */
 #define DWI2C_IC_CLR_INTR           0x40    /* Clear all interrupts */
 #define DWI2C_IC_CLR_RX_UNDER       0x44
 #define DWI2C_IC_CLR_RX_OVER        0x48
 #define DWI2C_IC_CLR_TX_OVER        0x4C
 #define DWI2C_IC_CLR_TX_ABRT        0x54
+#define DWI2C_IC_CLR_STOP_DET       0x60
 #define DWI2C_IC_ENABLE             0x6C    /* Enable/disable I2C */
 #define DWI2C_IC_STATUS             0x70    /* I2C status */
 #define DWI2C_IC_TXFLR              0x74    /* TX FIFO level */
@@ -236,6 +266,11 @@
 #define DWI2C_INTR_TX_ABRT          (1 << 6)    /* TX abort */
 #define DWI2C_INTR_TX_EMPTY         (1 << 4)    /* TX FIFO empty */
 #define DWI2C_INTR_RX_FULL          (1 << 2)    /* RX FIFO >= threshold */
+#define DWI2C_INTR_STOP_DET         (1 << 9)    /* STOP seen: transfer over */
+
+/* IC_COMP_PARAM_1: FIFO depths the controller was synthesized with */
+#define DWI2C_PARAM_TX_DEPTH(p)     ((((p) >> 16) & 0xFF) + 1)
+#define DWI2C_PARAM_RX_DEPTH(p)     ((((p) >> 8) & 0xFF) + 1)
 
 /* I2C clock: APB bus @ ~100 MHz (from sys_crg). Standard mode = 100 kHz.
  * SS_SCL_HCNT = APB_CLK/(2*SCL_freq) - 7 = 100MHz/(200kHz) - 7 = 493
@@ -246,6 +281,7 @@
 /* PMIC I2C address */
 #define JH7110_AXP15060_I2C_ADDR    0x36
 #define JH7110_AXP15060_I2C_BASE    JH7110_I2C6_BASE
+#define JH7110_AXP15060_I2C_IRQ     JH7110_IRQ_I2C6
 
 /* =============================================================================
  * GPIO / SYS_IOMUX
@@ -276,6 +312,19 @@
 #define JH7110_SYS_CRG_BASE         0x13020000UL
 #define JH7110_SYS_GPIO_BASE        0x13040000UL
 
+/*
+ * SYS CRG clock words — one 32-bit register per clock, in the order of
+ * Linux's clk-starfive-jh7110-sys.c. A divider's value is bits [23:0].
+ *
+ *   cpu_root  mux: 24 MHz oscillator or PLL0
+ *   cpu_core  cpu_root / 1..7 — the U74 cores' clock
+ *   cpu_bus   cpu_core / 1..2
+ */
+#define JH7110_SYS_CRG_CPU_ROOT     (JH7110_SYS_CRG_BASE + 0x000)
+#define JH7110_SYS_CRG_CPU_CORE     (JH7110_SYS_CRG_BASE + 0x004)
+#define JH7110_CRG_DIV_MASK         0x00FFFFFFU
+#define JH7110_CPU_CORE_DIV_MAX     7
+
 /*
  * JH7110 sys_gpio register layout (from Linux driver: pinctrl-starfive-jh7110.c)
  *
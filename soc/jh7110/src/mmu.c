@@ -0,0 +1,265 @@
+/*
+ * soc/jh7110/mmu.c - Sv39 Page Tables from a Region Map
+ *
+ * Tutorial-OS: JH7110 HAL Implementation
+ *
+ * WHAT THE MMU CAN AND CAN'T DO HERE
+ * ===================================
+ * The SiFive U74 has a 2MB L2 cache, no Zicbom and no Svpbmt. Memory types
+ * come from the core's fixed PMAs — DRAM cacheable, the low GB strongly
+ * ordered I/O — and no page table bit changes them. So the MMU can't make
+ * the framebuffer at 0xFE000000 non-cacheable; the display sees CPU writes
+ * because every present walks the dirty rows through the L2 Flush64
+ * register (see hal_display.h). What the tables do carry is permissions —
+ * the heap is not executable — with VA == PA everywhere.
+ *
+ * SV39 OVERVIEW
+ * =============
+ *   Virtual address (39-bit):
+ *   [38:30] VPN[2]  → index into L1 — each entry 1GB
+ *   [29:21] VPN[1]  → index into L2 — each entry 2MB
+ *   [20:12] VPN[0]  → index into L3 — each entry 4KB
+ *   [11: 0] Offset
+ *
+ * Any level can hold a LEAF (R, W or X set) instead of a pointer to the
+ * next table: a leaf in L1 is a 1GB gigapage, a leaf in L2 a 2MB
+ * megapage. The base of a leaf must be aligned to its size.
+ *
+ * WHY THE PAGE SIZE MATTERS
+ * =========================
+ * The U74's TLB holds a few dozen entries whatever their size. A
+ * full-screen fill walks every byte of an 8MB framebuffer each frame:
+ *
+ *   4KB pages    2048 translations — the TLB thrashes every frame
+ *   2MB pages       4 translations
+ *   1GB page        1 translation, shared with everything else in the GB
+ *
+ * So the builder always uses the largest leaf whose whole span has one
+ * attribute.
+ *
+ * THE REGION MAP
+ * ==============
+ * g_regions below lists what the kernel needs, general first, specific
+ * after. A 2MB block takes the attribute of the LAST region that covers
+ * it completely; a region that only partly covers a block (the heap
+ * starts wherever the kernel image ends) leaves that block to the
+ * regions before it. Then, one GB at a time:
+ *
+ *   every block the same   → one gigapage in L1 (or nothing, if unmapped)
+ *   blocks differ          → an L2 from the pool, one megapage per block
+ *
+ *   GB   Range                    Result
+ *   0    0x00000000–0x3FFFFFFF    gigapage, RW        peripherals
+ *   1    0x40000000–0x7FFFFFFF    L2: kernel RWX, heap RW, .dma_coherent
+ *                                 RW, JIT RWX — 512 megapages
+ *   3    0xC0000000–0xFFFFFFFF    gigapage, RW        scan-out (0xFE000000)
+ *
+ * The heap and JIT bounds come from the same arithmetic as
+ * allocator_init_from_ram(): heap from __heap_start to the JIT region,
+ * JIT_SIZE at the top of RAM.
+ *
+ * PTE FLAGS
+ * =========
+ *   V R W X U G A D in bits [7:0]; A and D are preset so the hardware
+ *   never faults to have them set. Svpbmt would add a memory type in bits
+ *   [62:61] (PMA / NC / IO); the U74 doesn't implement it, those bits are
+ *   reserved and must be zero, so every leaf here leaves them clear and
+ *   takes the PMA's type.
+ *
+ * ARM64 EQUIVALENT
+ * ================
+ * On ARM64 the memory type is an index into MAIR_EL1, so the page tables
+ * do choose it — the BCM2710 maps scan-out write-combining that way. The
+ * block sizes are the same 2MB and 1GB. The BCM2710 can't use a 1GB block
+ * (RAM and peripherals share its first GB), so it gets its reach from the
+ * contiguous hint instead — see soc/bcm2710/mmu.c.
+ */
+
+#include "hal_types.h"
+#include "../../../memory/src/allocator.h"
+
+/* linker.ld */
+extern char __heap_start[];
+extern char __dma_start[];
+extern char __dma_end[];
+
+/* uart.c */
+extern void jh7110_uart_puts(const char *str);
+extern void jh7110_uart_putdec(uint32_t val);
+
+/* =============================================================================
+ * PTE BITS
+ * =============================================================================
+ */
+
+#define PTE_V               (1UL << 0)
+#define PTE_R               (1UL << 1)
+#define PTE_W               (1UL << 2)
+#define PTE_X               (1UL << 3)
+#define PTE_G               (1UL << 5)
+#define PTE_A               (1UL << 6)
+#define PTE_D               (1UL << 7)
+
+#define PTE_LEAF            (PTE_V | PTE_R | PTE_W | PTE_G | PTE_A | PTE_D)
+
+/* No Svpbmt: the type comes from the PMAs, so MMIO is just a data leaf */
+#define MAP_RAM_RWX         (PTE_LEAF | PTE_X)
+#define MAP_RAM_RW          (PTE_LEAF)
+#define MAP_IO              (PTE_LEAF)
+
+/* PTE[53:10] = PA[55:12], i.e. PA >> 2 for an aligned PA */
+#define PTE_PPN(pa)         ((uint64_t)(pa) >> 2)
+#define PTE_TABLE(table)    (PTE_PPN((uintptr_t)(table)) | PTE_V)
+
+#define MEGA_SHIFT          21
+#define GIGA_SHIFT          30
+#define MEGA_SIZE           (1UL << MEGA_SHIFT)
+#define GIGA_SIZE           (1UL << GIGA_SHIFT)
+#define PTES_PER_TABLE      512
+
+/* GBs the builder looks at: 16GB of physical space, past the 8GB board's DRAM */
+#define MMU_GB_SLOTS        16
+#define MMU_L2_POOL         4
+
+/* The GB holding the U-Boot framebuffer */
+#define JH7110_SCANOUT_GB   0xC0000000UL
+
+/* =============================================================================
+ * TABLES
+ * =============================================================================
+ * In .bss: zeroed by common_init.S long before soc_init() calls us.
+ */
+
+static uint64_t g_l1[PTES_PER_TABLE] __attribute__((aligned(4096)));
+static uint64_t g_l2[MMU_L2_POOL][PTES_PER_TABLE] __attribute__((aligned(4096)));
+
+static uint32_t g_l2_used;
+static uint32_t g_giga_count;
+static uint32_t g_mega_count;
+static bool     g_pool_short;
+
+/* =============================================================================
+ * REGION MAP
+ * =============================================================================
+ */
+
+typedef struct {
+    const char *name;
+    uintptr_t   base;
+    uint64_t    size;
+    uint64_t    flags;      /* MAP_*, no PPN */
+} mmu_region_t;
+
+#define MMU_MAX_REGIONS     6
+
+static mmu_region_t g_regions[MMU_MAX_REGIONS];
+static uint32_t     g_region_count;
+
+static void region_add(const char *name, uintptr_t base, uint64_t size, uint64_t flags)
+{
+    if (g_region_count < MMU_MAX_REGIONS && size != 0) {
+        g_regions[g_region_count++] = (mmu_region_t){ name, base, size, flags };
+    }
+}
+
+static void regions_init(void)
+{
+    uintptr_t ram_end   = RAM_BASE + RAM_SIZE;
+    uintptr_t jit_start = ram_end - JIT_SIZE;
+
+    g_region_count = 0;
+    region_add("periph", 0x00000000UL, GIGA_SIZE, MAP_IO);
+    region_add("ram",    RAM_BASE, RAM_SIZE, MAP_RAM_RWX);
+    region_add("heap",   (uintptr_t)__heap_start, jit_start - (uintptr_t)__heap_start, MAP_RAM_RW);
+    region_add("jit",    jit_start, JIT_SIZE, MAP_RAM_RWX);
+    region_add("dma",    (uintptr_t)__dma_start,
+                         (uintptr_t)__dma_end - (uintptr_t)__dma_start, MAP_RAM_RW);
+    region_add("scanout", JH7110_SCANOUT_GB, GIGA_SIZE, MAP_RAM_RW);
+}
+
+/* Flags for the 2MB block at pa: the last region covering all of it, or 0 */
+static uint64_t block_flags(uintptr_t pa)
+{
+    uint64_t flags = 0;
+
+    for (uint32_t i = 0; i < g_region_count; i++) {
+        const mmu_region_t *r = &g_regions[i];
+        if (pa >= r->base && pa + MEGA_SIZE <= r->base + r->size) {
+            flags = r->flags;
+        }
+    }
+    return flags;
+}
+
+/* =============================================================================
+ * BUILDER
+ * =============================================================================
+ */
+
+static void map_gb(uint32_t slot)
+{
+    uintptr_t gb    = (uintptr_t)slot << GIGA_SHIFT;
+    uint64_t  first = block_flags(gb);
+    bool      same  = true;
+
+    for (uint32_t i = 1; i < PTES_PER_TABLE && same; i++) {
+        same = block_flags(gb + ((uintptr_t)i << MEGA_SHIFT)) == first;
+    }
+
+    if (same) {
+        if (first) {
+            g_l1[slot] = PTE_PPN(gb) | first;
+            g_giga_count++;
+        }
+        return;
+    }
+
+    if (g_l2_used == MMU_L2_POOL) {
+        g_pool_short = true;        /* This GB stays unmapped */
+        return;
+    }
+
+    uint64_t *l2 = g_l2[g_l2_used++];
+    for (uint32_t i = 0; i < PTES_PER_TABLE; i++) {
+        uintptr_t pa    = gb + ((uintptr_t)i << MEGA_SHIFT);
+        uint64_t  flags = block_flags(pa);
+        l2[i] = flags ? PTE_PPN(pa) | flags : 0;
+        if (flags) g_mega_count++;
+    }
+    g_l1[slot] = PTE_TABLE(l2);
+}
+
+/*
+ * Build the tables from the region map and switch satp to Sv39. Called
+ * from jh7110_soc_init() before the first framebuffer write; the UART
+ * isn't up yet, so jh7110_mmu_report() prints the result afterwards.
+ */
+void jh7110_mmu_init(void)
+{
+    regions_init();
+
+    for (uint32_t slot = 0; slot < MMU_GB_SLOTS; slot++) {
+        map_gb(slot);
+    }
+
+    /* satp: MODE = 8 (Sv39), ASID = 0, PPN of the L1 table */
+    uint64_t satp = (8UL << 60) | ((uintptr_t)g_l1 >> 12);
+
+    __asm__ volatile("sfence.vma" ::: "memory");
+    __asm__ volatile("csrw satp, %0" :: "r"(satp) : "memory");
+    __asm__ volatile("sfence.vma" ::: "memory");
+}
+
+/* One line: what the region map turned into */
+void jh7110_mmu_report(void)
+{
+    jh7110_uart_puts("[mmu] ");
+    jh7110_uart_putdec(g_giga_count);
+    jh7110_uart_puts(" x 1GB, ");
+    jh7110_uart_putdec(g_mega_count);
+    jh7110_uart_puts(" x 2MB, L2 tables ");
+    jh7110_uart_putdec(g_l2_used);
+    jh7110_uart_puts("/");
+    jh7110_uart_putdec(MMU_L2_POOL);
+    jh7110_uart_puts(g_pool_short ? "  (pool exhausted: a GB is unmapped)\n" : "\n");
+}
@@ -61,8 +61,9 @@ extern void jh7110_uart_putdec(uint32_t val);
 extern void jh7110_uart_putc(char c);
 extern void jh7110_uart_init_hw(void);
 
-/* cache coherency resolution page table mmu.S */
+/* mmu.c — Sv39 tables from the region map */
 extern void jh7110_mmu_init(void);
+extern void jh7110_mmu_report(void);
 
 /* timer.c */
 extern uint32_t micros(void);
@@ -133,6 +134,7 @@ bool jh7110_soc_init(framebuffer_t *fb)
     jh7110_uart_puts("  DTB @ ");
     jh7110_uart_puthex((uint64_t)(uintptr_t)dtb);
     jh7110_uart_putc('\n');
+    jh7110_mmu_report();
 
     /* =====================================================================
      * Phase 2: CPU Frequency Measurement
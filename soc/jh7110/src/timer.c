@@ -47,10 +47,17 @@
  * The U74 supports rdcycle from S-mode. Some strict supervisor
  * configurations disable this, but on JH7110 with stock U-Boot/OpenSBI,
  * rdcycle is accessible.
+ *
+ * TIMER EVENTS:
+ * =============
+ * hal_timer.h's tickless events program the hart's mtimecmp through the
+ * SBI Timer extension; see TIMER INTERRUPT HOOKS below.
  */
 
 #include "jh7110_regs.h"
 #include "types.h"
+#include "hal_timer.h"
+#include "drivers/sbi.h"
 
 /* 24 MHz OSC = timer ticks per microsecond */
 #define TIMER_TICKS_PER_US      24ULL
@@ -162,6 +169,95 @@ void delay_ms(uint32_t ms)
     }
 }
 
+/* =============================================================================
+ * HAL TIMER API (hal_timer.h)
+ * =============================================================================
+ *
+ * Portable code (kernel/src/smp.c, the allocator metrics) times itself
+ * through hal_timer.h, whose ticks are microseconds like BCM2710's 1 MHz
+ * system timer. These are thin wrappers over the functions above.
+ */
+
+hal_error_t hal_timer_init(void)
+{
+    /* rdtime runs from reset; OpenSBI has already enabled S-mode access */
+    return HAL_SUCCESS;
+}
+
+uint64_t hal_timer_get_ticks(void)
+{
+    return micros64();
+}
+
+uint32_t hal_timer_get_ticks32(void)
+{
+    return micros();
+}
+
+uint64_t hal_timer_get_ms(void)
+{
+    return read_time() / (TIMER_FREQ_HZ / 1000);
+}
+
+/* entry.S samples the same `time` CSR that micros64() divides down */
+uint64_t hal_timer_counter_hz(void)
+{
+    return TIMER_FREQ_HZ;
+}
+
+void hal_delay_us(uint32_t us)
+{
+    delay_us(us);
+}
+
+void hal_delay_ms(uint32_t ms)
+{
+    delay_ms(ms);
+}
+
+void hal_delay_s(uint32_t s)
+{
+    while (s--) {
+        delay_ms(1000);
+    }
+}
+
+/* =============================================================================
+ * TIMER INTERRUPT HOOKS (SBI Timer)
+ * =============================================================================
+ *
+ * The compare is mtimecmp, owned by OpenSBI and reached through
+ * sbi_set_timer() — one per hart, so these must run on the boot hart.
+ * Unlike the BCM2710's equality compare, the interrupt is LEVEL: it is
+ * pending whenever time >= mtimecmp. A deadline in the past therefore
+ * fires at once, and the only way to clear it is to program a later one.
+ *
+ * irq.c routes scause 5 (supervisor timer) to hal_timer_irq().
+ */
+
+#define SIE_STIE    (1UL << 5)
+
+hal_error_t hal_timer_irq_init(void)
+{
+    sbi_set_timer(UINT64_MAX);
+    __asm__ volatile("csrs sie, %0" :: "r"(SIE_STIE));
+    return HAL_SUCCESS;
+}
+
+void hal_timer_irq_set(uint64_t deadline_us)
+{
+    /* Saturate instead of wrapping: 2^64 / 24 us is ~24,000 years anyway */
+    uint64_t ticks = deadline_us > UINT64_MAX / TIMER_TICKS_PER_US
+                   ? UINT64_MAX
+                   : deadline_us * TIMER_TICKS_PER_US;
+    sbi_set_timer(ticks);
+}
+
+void hal_timer_irq_clear(void)
+{
+    sbi_set_timer(UINT64_MAX);
+}
+
 /* =============================================================================
  * CPU FREQUENCY MEASUREMENT
  * =============================================================================
@@ -15,11 +15,37 @@
  *   entry.S uses this to print 'T' at the very start of _start.
  *   The SBI console goes through OpenSBI's existing UART driver.
  *
- * Layer 2 — Direct Hardware UART (optional, slightly faster):
+ * Layer 2 — Direct Hardware UART (after jh7110_uart_init_hw()):
  *   We program the 8250 UART registers directly.
  *   This is useful for high-bandwidth debug output (register dumps, etc.)
  *   where SBI ecall overhead becomes measurable.
- *   Must call jh7110_uart_init_hw() before jh7110_uart_putc_direct().
+ *
+ * NEITHER LAYER IS CALLED PER CHARACTER:
+ * ======================================
+ * Every jh7110_uart_* call only appends to a 4 KB TX ring. What drains it
+ * depends on the layer:
+ *
+ *   before init_hw   at each '\n' (or half-full ring) the queued bytes go
+ *                    to OpenSBI in ONE Debug Console write — one trap per
+ *                    line instead of one per byte. The legacy putchar
+ *                    (EID 0x01) is the fallback if DBCN isn't there.
+ *
+ *   after init_hw    whenever THRE says the FIFO is empty, up to a FIFO's
+ *                    worth of bytes go straight into THR. The THR-empty
+ *                    interrupt (PLIC source 32) refills it while bytes
+ *                    remain, so a caller never waits on the wire:
+ *
+ *      putc ──▶ [ ring ] ──▶ THR/FIFO (16) ──▶ TX pin @ 115200
+ *                  ▲               │
+ *                  └── THRE IRQ ◀──┘  "FIFO empty, send more"
+ *
+ * At 115200 baud one byte takes ~87 µs on the wire, so a 60-byte
+ * breadcrumb used to be 5 ms of polling inside OpenSBI; now it is a
+ * memcpy. If output outruns the wire for long enough to fill the ring,
+ * new bytes are dropped (and counted) rather than stalling the caller.
+ * Until kernel_main() unmasks interrupts, the ring drains whenever
+ * something else is written. jh7110_uart_flush() waits for the ring to
+ * empty — panic and trap reports use it so their last words get out.
  *
  * HARDWARE DETAILS:
  * =================
@@ -52,6 +78,11 @@
 
 #include "jh7110_regs.h"
 #include "types.h"
+#include "hal_types.h"
+#include "spinlock.h"
+#include "drivers/sbi.h"
+
+extern uint64_t __boot_hart_id;
 
 /* The UART0 base address we'll use for direct hardware access */
 #define UART_BASE   JH7110_UART0_BASE
@@ -60,16 +91,13 @@
 #define UART_REG(offset)    (*((volatile uint32_t *)(UART_BASE + (offset))))
 
 /* =============================================================================
- * SBI CONSOLE (LAYER 1 — PRIMARY OUTPUT)
+ * SBI CONSOLE (LAYER 1 — BEFORE THE HARDWARE IS OURS)
  * =============================================================================
  *
- * SBI Debug Console extension (EID 0x4442434E "DBCN").
- * These ecalls go through OpenSBI which handles the actual hardware.
- *
- * We use the Legacy Console Putchar (EID 0x01) for simplicity — it's
- * supported by all OpenSBI versions and requires no capability probe.
- * The Debug Console extension (EID 0x4442434E) is newer and preferred
- * for multi-char writes but requires a version check first.
+ * SBI Debug Console extension (EID 0x4442434E "DBCN") writes a whole
+ * buffer per ecall; it needs a probe first, done on the first drain.
+ * Legacy Console Putchar (EID 0x01) is supported by every OpenSBI version
+ * and stays as the fallback — and as the path entry.S's 'T' takes.
  *
  * a7 = EID (extension ID), a6 = FID (function ID), a0 = argument
  */
@@ -86,60 +114,215 @@ static inline void sbi_putchar(char c)
 }
 
 /* =============================================================================
- * PUBLIC API — SBI-BACKED (works before jh7110_uart_init_hw())
+ * TX RING
+ * =============================================================================
+ *
+ * head and tail run freely; head - tail is the queued count and
+ * index % UART_TX_RING the slot. The lock covers other harts; IRQs are
+ * masked around it because the THRE interrupt drains the same ring.
+ */
+
+#define UART_TX_RING    4096    /* Power of two */
+
+typedef enum {
+    UART_TX_PROBE,              /* Nothing decided yet */
+    UART_TX_LEGACY,             /* SBI putchar, one ecall per byte */
+    UART_TX_DBCN,               /* SBI Debug Console, one ecall per chunk */
+    UART_TX_HW,                 /* THR + FIFO, interrupt refilled */
+} uart_tx_mode_t;
+
+static char           g_tx_ring[UART_TX_RING];
+static uint32_t       g_tx_head;
+static uint32_t       g_tx_tail;
+static uint32_t       g_tx_dropped;
+static uart_tx_mode_t g_tx_mode = UART_TX_PROBE;
+static bool           g_tx_irq;
+static spinlock_t     g_tx_lock = SPINLOCK_INIT;
+
+static inline uint32_t uart_tx_queued(void)
+{
+    return g_tx_head - g_tx_tail;
+}
+
+/* Longest run of queued bytes that is contiguous in the ring */
+static inline uint32_t uart_tx_chunk(void)
+{
+    uint32_t queued = uart_tx_queued();
+    uint32_t to_end = UART_TX_RING - (g_tx_tail % UART_TX_RING);
+    return queued < to_end ? queued : to_end;
+}
+
+static void uart_tx_drain_sbi(void)
+{
+    if (g_tx_mode == UART_TX_PROBE) {
+        g_tx_mode = sbi_probe_extension(SBI_EXT_DBCN) ? UART_TX_DBCN : UART_TX_LEGACY;
+    }
+
+    uint32_t chunk;
+    while ((chunk = uart_tx_chunk()) != 0) {
+        const char *p = &g_tx_ring[g_tx_tail % UART_TX_RING];
+
+        if (g_tx_mode == UART_TX_DBCN) {
+            long n = sbi_debug_console_write(p, chunk);
+            if (n > 0) {
+                g_tx_tail += (uint32_t)n;
+                continue;
+            }
+            g_tx_mode = UART_TX_LEGACY;     /* Refused: never ask again */
+        }
+        for (uint32_t i = 0; i < chunk; i++) sbi_putchar(p[i]);
+        g_tx_tail += chunk;
+    }
+}
+
+/* Top the FIFO up once per THRE; never waits for the wire */
+static void uart_tx_drain_hw(void)
+{
+    while (uart_tx_queued() && (UART_REG(UART8250_LSR) & UART8250_LSR_THRE)) {
+        uint32_t n = uart_tx_queued();
+        if (n > UART8250_TX_FIFO_DEPTH) n = UART8250_TX_FIFO_DEPTH;
+        for (uint32_t i = 0; i < n; i++) {
+            UART_REG(UART8250_THR) = (uint32_t)(uint8_t)g_tx_ring[g_tx_tail++ % UART_TX_RING];
+        }
+    }
+
+    /* Ask for THRE only while there is something to send */
+    if (g_tx_irq) {
+        UART_REG(UART8250_IER) = uart_tx_queued() ? UART8250_IER_ETBEI : 0;
+    }
+}
+
+static void uart_tx_push(char c)
+{
+    if (uart_tx_queued() == UART_TX_RING) {
+        if (g_tx_mode == UART_TX_HW) {
+            g_tx_dropped++;
+            return;
+        }
+        uart_tx_drain_sbi();
+    }
+    g_tx_ring[g_tx_head++ % UART_TX_RING] = c;
+}
+
+static void uart_tx_write(const char *s, uint32_t len)
+{
+    hal_irq_flags_t f = hal_irq_save();
+    spin_lock(&g_tx_lock);
+
+    bool line = false;
+    for (uint32_t i = 0; i < len; i++) {
+        if (s[i] == '\n') {
+            line = true;
+            /* OpenSBI adds the '\r' itself; the bare UART needs it from us */
+            if (g_tx_mode == UART_TX_HW) uart_tx_push('\r');
+        }
+        uart_tx_push(s[i]);
+    }
+
+    if (g_tx_mode == UART_TX_HW) {
+        uart_tx_drain_hw();
+    } else if (line || uart_tx_queued() >= UART_TX_RING / 2) {
+        uart_tx_drain_sbi();
+    }
+
+    spin_unlock(&g_tx_lock);
+    hal_irq_restore(f);
+}
+
+/* =============================================================================
+ * PUBLIC API — BUFFERED (works before jh7110_uart_init_hw())
  * =============================================================================
  */
 
 void jh7110_uart_putc(char c)
 {
-    sbi_putchar(c);
+    uart_tx_write(&c, 1);
 }
 
 void jh7110_uart_puts(const char *str)
 {
     if (!str) return;
-    while (*str) {
-        sbi_putchar(*str++);
-    }
+    uint32_t len = 0;
+    while (str[len]) len++;
+    uart_tx_write(str, len);
 }
 
 void jh7110_uart_puthex(uint64_t val)
 {
     const char hex[] = "0123456789ABCDEF";
-    sbi_putchar('0');
-    sbi_putchar('x');
-    for (int i = 60; i >= 0; i -= 4) {
-        sbi_putchar(hex[(val >> i) & 0xF]);
+    char buf[18];
+
+    buf[0] = '0';
+    buf[1] = 'x';
+    for (int i = 0; i < 16; i++) {
+        buf[2 + i] = hex[(val >> (60 - 4 * i)) & 0xF];
     }
+    uart_tx_write(buf, sizeof(buf));
 }
 
 void jh7110_uart_putdec(uint32_t val)
 {
-    char buf[12];
-    int i = 0;
+    char buf[10];
+    int i = sizeof(buf);
 
-    if (val == 0) {
-        sbi_putchar('0');
-        return;
-    }
-
-    while (val > 0) {
-        buf[i++] = '0' + (val % 10);
+    do {
+        buf[--i] = '0' + (val % 10);
         val /= 10;
-    }
+    } while (val > 0);
+
+    uart_tx_write(&buf[i], (uint32_t)sizeof(buf) - (uint32_t)i);
+}
+
+/*
+ * jh7110_uart_flush — wait until every queued byte has left the ring
+ *
+ * The one blocking call, for panic and trap paths. Those can arrive with
+ * the lock held by the code they interrupted, so it is taken only if free.
+ */
+void jh7110_uart_flush(void)
+{
+    hal_irq_flags_t f = hal_irq_save();
+    bool locked = spin_trylock(&g_tx_lock);
 
-    while (i > 0) {
-        sbi_putchar(buf[--i]);
+    if (g_tx_mode == UART_TX_HW) {
+        while (uart_tx_queued()) uart_tx_drain_hw();
+    } else {
+        uart_tx_drain_sbi();
     }
+
+    if (locked) spin_unlock(&g_tx_lock);
+    hal_irq_restore(f);
+}
+
+/* Bytes dropped because the ring was full (hardware mode only) */
+uint32_t jh7110_uart_tx_dropped(void)
+{
+    return g_tx_dropped;
+}
+
+/*
+ * jh7110_uart_irq — UART0 interrupt, called from irq.c after a PLIC claim
+ *
+ * Reading IIR acknowledges a THRE interrupt; the drain refills the FIFO
+ * and turns THRE back off once the ring is empty.
+ */
+void jh7110_uart_irq(void)
+{
+    (void)UART_REG(UART8250_IIR);
+
+    spin_lock(&g_tx_lock);
+    uart_tx_drain_hw();
+    spin_unlock(&g_tx_lock);
 }
 
 /* =============================================================================
- * DIRECT HARDWARE UART (LAYER 2 — OPTIONAL FAST PATH)
+ * DIRECT HARDWARE UART (LAYER 2)
  * =============================================================================
  *
- * Programs the 8250 UART registers directly. Call jh7110_uart_init_hw()
- * once, then jh7110_uart_putc_direct() for faster output that doesn't
- * go through SBI ecall overhead.
+ * Programs the 8250 UART registers directly and hands the ring over to
+ * them. Anything still queued for OpenSBI goes out first, and the
+ * transmitter is allowed to go idle before the FIFOs are reset, so no
+ * byte of either is lost in the switch.
  *
  * INITIALIZATION SEQUENCE:
  *   1. Disable interrupts (IER = 0)
@@ -147,13 +330,51 @@ void jh7110_uart_putdec(uint32_t val)
  *   3. Write baud divisor to DLL (low byte) and DLM (high byte)
  *   4. Clear DLAB, configure 8N1 in LCR
  *   5. Enable and reset FIFOs via FCR
+ *   6. Route the UART0 interrupt to this hart's S-mode PLIC context
  *
- * This sequence is identical for any 16550-compatible UART regardless
+ * Steps 1-5 are identical for any 16550-compatible UART regardless
  * of the SoC it's embedded in — a good example of IP reuse reducing
  * porting effort.
+ *
+ * Calling it again once the hardware is ours does nothing.
  */
+
+#define SIE_SEIE    (1UL << 9)
+
+static void uart_irq_route(void)
+{
+    uint32_t ctx = JH7110_PLIC_CTX_S((uint32_t)__boot_hart_id);
+
+    /* Only our source enabled on this context, whatever firmware left */
+    for (uint32_t w = 0; w <= JH7110_PLIC_NUM_SOURCES / 32; w++) {
+        *(volatile uint32_t *)(JH7110_PLIC_ENABLE(ctx) + w * 4) = 0;
+    }
+    *(volatile uint32_t *)JH7110_PLIC_PRIORITY(JH7110_IRQ_UART0) = 1;
+    *(volatile uint32_t *)(JH7110_PLIC_ENABLE(ctx) + (JH7110_IRQ_UART0 / 32) * 4) =
+        1u << (JH7110_IRQ_UART0 % 32);
+    *(volatile uint32_t *)JH7110_PLIC_THRESHOLD(ctx) = 0;
+
+    __asm__ volatile("csrs sie, %0" :: "r"(SIE_SEIE));
+    g_tx_irq = true;
+}
+
 void jh7110_uart_init_hw(void)
 {
+    hal_irq_flags_t f = hal_irq_save();
+    spin_lock(&g_tx_lock);
+
+    if (g_tx_mode == UART_TX_HW) {
+        spin_unlock(&g_tx_lock);
+        hal_irq_restore(f);
+        return;
+    }
+
+    /* Hand-over: OpenSBI's bytes out, then wait for the shifter to idle */
+    uart_tx_drain_sbi();
+    for (uint32_t spin = 0; spin < 1000000; spin++) {
+        if (UART_REG(UART8250_LSR) & UART8250_LSR_TEMT) break;
+    }
+
     /* Step 1: Disable all UART interrupts */
     UART_REG(UART8250_IER) = 0x00;
 
@@ -175,17 +396,24 @@ void jh7110_uart_init_hw(void)
                               UART8250_FCR_TX_RESET |
                               UART8250_FCR_TRIG_14;
 
-    /* Step 6: Enable TX (DTR + RTS asserted — modem control) */
+    /* Enable TX (DTR + RTS asserted — modem control) */
     UART_REG(UART8250_MCR) = 0x03;
 
-    jh7110_uart_puts("[jh7110] UART0 direct hardware init OK (115200 8N1)\n");
+    /* Step 6: THRE interrupt → PLIC → scause 9 → jh7110_uart_irq() */
+    uart_irq_route();
+    g_tx_mode = UART_TX_HW;
+
+    spin_unlock(&g_tx_lock);
+    hal_irq_restore(f);
+
+    jh7110_uart_puts("[jh7110] UART0 direct hardware init OK (115200 8N1, buffered)\n");
 }
 
 /*
- * jh7110_uart_putc_direct — write a character directly to UART hardware
+ * jh7110_uart_putc_direct — write a character straight to THR
  *
- * Polls the LSR THRE (Transmit Holding Register Empty) bit before writing.
- * If the TX FIFO is full, this spins until there's space.
+ * Bypasses the ring and polls LSR.THRE, so it reaches the wire even with
+ * interrupts dead. Mixing it with buffered output can reorder the two.
  *
  * Only use after jh7110_uart_init_hw() has been called.
  */
@@ -203,4 +431,4 @@ void jh7110_uart_putc_direct(char c)
             ;
         UART_REG(UART8250_THR) = '\r';
     }
-}
\ No newline at end of file
+}
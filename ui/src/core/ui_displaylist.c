@@ -0,0 +1,409 @@
+/*
+ * ui_displaylist.c - Tile-Based Retained-Mode Display List
+ * =========================================================
+ *
+ * See ui_displaylist.h for the record → bin → diff → raster pipeline.
+ *
+ * IMPLEMENTATION NOTES:
+ * ---------------------
+ * Commands are stored back to back in the arena as ui_dl_rec_t headers,
+ * each optionally followed by its NUL-terminated text, padded to 8 bytes.
+ *
+ * Tile hashes use FNV-1a. A command's own hash covers its fb_cmd_t (which
+ * includes the clip) and its text, so moving, recoloring or rewording
+ * anything changes the hash of every tile it touches, both where it was
+ * and where it is now. Folding with (h ^ cmd) * prime is order-sensitive,
+ * so reordering overlapping commands is detected too.
+ */
+
+#include "ui_displaylist.h"
+
+#define FNV_BASIS   0x811C9DC5u
+#define FNV_PRIME   0x01000193u
+
+typedef struct {
+    fb_cmd_t cmd;
+    uint32_t x1, y1, x2, y2;        /* Clipped bounding box, half-open */
+    uint32_t hash;
+    uint32_t size;                  /* Header + text, 8-byte aligned */
+    uint32_t has_text;
+    uint32_t pad;
+} ui_dl_rec_t;
+
+
+/* =============================================================================
+ * HELPERS
+ * =============================================================================
+ */
+
+static inline uint32_t fnv1a(uint32_t h, const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    while (len--) {
+        h ^= *p++;
+        h *= FNV_PRIME;
+    }
+    return h;
+}
+
+static inline size_t dl_strlen(const char *s)
+{
+    size_t len = 0;
+    while (s[len]) len++;
+    return len;
+}
+
+static inline int64_t min_i64(int64_t a, int64_t b) { return a < b ? a : b; }
+static inline int64_t max_i64(int64_t a, int64_t b) { return a > b ? a : b; }
+
+/*
+ * Bounding box of a command, clipped to its recorded clip. Returns false
+ * when nothing would be drawn, in which case the command is dropped.
+ */
+static bool dl_cmd_bounds(const fb_cmd_t *c, const char *text, ui_dl_rec_t *r)
+{
+    int64_t x1, y1, x2, y2;
+    int64_t x = c->x, y = c->y;
+
+    switch (c->op) {
+    case FB_CMD_LINE:
+        x1 = min_i64(x, c->w);  x2 = max_i64(x, c->w) + 1;
+        y1 = min_i64(y, c->h);  y2 = max_i64(y, c->h) + 1;
+        break;
+    case FB_CMD_FILL_CIRCLE:
+    case FB_CMD_DRAW_CIRCLE:
+        x1 = x - c->r;  x2 = x + c->r + 1;
+        y1 = y - c->r;  y2 = y + c->r + 1;
+        break;
+    case FB_CMD_TEXT: {
+        int64_t scale = c->r ? c->r : 1;
+        int64_t rows  = (c->flags & FB_TEXT_LARGE) ? FB_CHAR_HEIGHT_LG : FB_CHAR_HEIGHT;
+        x1 = x;  x2 = x + (int64_t)dl_strlen(text) * FB_CHAR_WIDTH * scale;
+        y1 = y;  y2 = y + rows * scale;
+        break;
+    }
+    default:
+        /* Rect-shaped: x, y, w, h are unsigned on the fb_* side */
+        x1 = (uint32_t)c->x;  x2 = x1 + (uint32_t)c->w;
+        y1 = (uint32_t)c->y;  y2 = y1 + (uint32_t)c->h;
+        break;
+    }
+
+    x1 = max_i64(x1, c->clip.x);
+    y1 = max_i64(y1, c->clip.y);
+    x2 = min_i64(x2, (int64_t)c->clip.x + c->clip.w);
+    y2 = min_i64(y2, (int64_t)c->clip.y + c->clip.h);
+    if (x2 <= x1 || y2 <= y1) return false;
+
+    r->x1 = (uint32_t)x1;  r->y1 = (uint32_t)y1;
+    r->x2 = (uint32_t)x2;  r->y2 = (uint32_t)y2;
+    return true;
+}
+
+static inline const char *dl_rec_text(const ui_dl_rec_t *r)
+{
+    return r->has_text ? (const char *)(r + 1) : NULL;
+}
+
+/* Replay everything recorded so far with no tile restriction */
+static void dl_replay_all(ui_dl_t *dl)
+{
+    size_t off = 0;
+    while (off < dl->used) {
+        const ui_dl_rec_t *r = (const ui_dl_rec_t *)(void *)(dl->arena + off);
+        fb_replay_cmd(dl->fb, &r->cmd, dl_rec_text(r));
+        off += r->size;
+    }
+}
+
+
+/* =============================================================================
+ * RECORDING
+ * =============================================================================
+ */
+
+static void dl_record(fb_recorder_t *rec, const fb_cmd_t *cmd, const char *text)
+{
+    ui_dl_t *dl = (ui_dl_t *)(void *)rec;
+
+    ui_dl_rec_t r;
+    if (cmd->op == FB_CMD_TEXT && !text) return;
+    if (!dl_cmd_bounds(cmd, text, &r)) return;
+
+    size_t text_len = text ? dl_strlen(text) + 1 : 0;
+    size_t size = (sizeof(ui_dl_rec_t) + text_len + 7) & ~(size_t)7;
+
+    if (dl->used + size > dl->arena_size) {
+        /* Out of arena: draw what we have, then go immediate-mode */
+        dl->overflow = true;
+        dl->fb->recorder = NULL;
+        dl_replay_all(dl);
+        fb_replay_cmd(dl->fb, cmd, text);
+        return;
+    }
+
+    r.cmd = *cmd;
+    r.size = (uint32_t)size;
+    r.has_text = text != NULL;
+    r.pad = 0;
+    r.hash = fnv1a(FNV_BASIS, cmd, sizeof(*cmd));
+    if (text) r.hash = fnv1a(r.hash, text, text_len);
+
+    uint8_t *dst = dl->arena + dl->used;
+    *(ui_dl_rec_t *)(void *)dst = r;
+    if (text) {
+        char *t = (char *)(dst + sizeof(ui_dl_rec_t));
+        for (size_t i = 0; i < text_len; i++) t[i] = text[i];
+    }
+    dl->used += size;
+    dl->cmd_count++;
+
+    /* Bin: fold the command hash into every tile it touches */
+    uint32_t s = dl->tile_shift;
+    uint32_t tx2 = (r.x2 - 1) >> s, ty2 = (r.y2 - 1) >> s;
+    if (tx2 >= dl->cols) tx2 = dl->cols - 1;
+    if (ty2 >= dl->rows) ty2 = dl->rows - 1;
+    for (uint32_t ty = r.y1 >> s; ty <= ty2; ty++) {
+        uint32_t *row = &dl->hash[ty * dl->cols];
+        for (uint32_t tx = r.x1 >> s; tx <= tx2; tx++) {
+            row[tx] = (row[tx] ^ r.hash) * FNV_PRIME;
+        }
+    }
+}
+
+
+/* =============================================================================
+ * PUBLIC API
+ * =============================================================================
+ */
+
+void ui_dl_init(ui_dl_t *dl, void *arena, size_t arena_size)
+{
+    dl->rec.record = dl_record;
+    dl->arena = (uint8_t *)arena;
+    dl->arena_size = arena_size;
+    dl->used = 0;
+    dl->cmd_count = 0;
+    dl->overflow = false;
+    dl->fb = NULL;
+    dl->tile_shift = UI_DL_MIN_SHIFT;
+    dl->cols = dl->rows = 0;
+    dl->has_bg = false;
+    dl->bg = 0;
+    dl->tiles_drawn = 0;
+}
+
+void ui_dl_set_arena(ui_dl_t *dl, void *arena, size_t arena_size)
+{
+    dl->arena = (uint8_t *)arena;
+    dl->arena_size = arena ? arena_size : 0;
+    dl->used = 0;
+}
+
+void ui_dl_set_background(ui_dl_t *dl, ui_color_t color)
+{
+    dl->bg = color;
+    dl->has_bg = true;
+}
+
+void ui_dl_invalidate(ui_dl_t *dl)
+{
+    /* 0 stands in for "unknown"; an empty tile hashes to FNV_BASIS */
+    for (uint32_t i = 0; i < dl->cols * dl->rows; i++) dl->prev_hash[i] = 0;
+}
+
+void ui_dl_begin(ui_dl_t *dl, framebuffer_t *fb)
+{
+    /* (Re)size the tile grid if the target changed */
+    uint32_t shift = UI_DL_MIN_SHIFT;
+    uint32_t cols, rows;
+    for (;;) {
+        uint32_t t = 1u << shift;
+        cols = (fb->width + t - 1) >> shift;
+        rows = (fb->height + t - 1) >> shift;
+        if (cols * rows <= UI_DL_MAX_TILES) break;
+        shift++;
+    }
+    if (fb != dl->fb || shift != dl->tile_shift || cols != dl->cols || rows != dl->rows) {
+        dl->fb = fb;
+        dl->tile_shift = shift;
+        dl->cols = cols;
+        dl->rows = rows;
+        ui_dl_invalidate(dl);
+    }
+
+    for (uint32_t i = 0; i < cols * rows; i++) dl->hash[i] = FNV_BASIS;
+    dl->used = 0;
+    dl->cmd_count = 0;
+    dl->overflow = false;
+    fb->recorder = &dl->rec;
+}
+
+uint32_t ui_dl_end(ui_dl_t *dl)
+{
+    framebuffer_t *fb = dl->fb;
+    uint32_t n = dl->cols * dl->rows;
+    if (!fb) return 0;
+    if (fb->recorder == &dl->rec) fb->recorder = NULL;
+
+    if (dl->overflow) {
+        /* Already drawn immediately; hashes are incomplete, redo all next time */
+        ui_dl_invalidate(dl);
+        dl->tiles_drawn = n;
+        return n;
+    }
+
+    uint32_t s = dl->tile_shift;
+    uint32_t drawn = 0;
+    for (uint32_t ty = 0; ty < dl->rows; ty++) {
+        const uint32_t *cur  = &dl->hash[ty * dl->cols];
+        const uint32_t *prev = &dl->prev_hash[ty * dl->cols];
+        uint32_t tx = 0;
+        while (tx < dl->cols) {
+            if (cur[tx] == prev[tx]) { tx++; continue; }
+
+            /* Extend to a horizontal run of changed tiles */
+            uint32_t run_start = tx;
+            while (tx < dl->cols && cur[tx] != prev[tx]) tx++;
+            drawn += tx - run_start;
+
+            uint32_t rx1 = run_start << s, ry1 = ty << s;
+            uint32_t rx2 = tx << s, ry2 = (ty + 1) << s;
+            if (rx2 > fb->width)  rx2 = fb->width;
+            if (ry2 > fb->height) ry2 = fb->height;
+
+            fb_rect_t run = { (int32_t)rx1, (int32_t)ry1, rx2 - rx1, ry2 - ry1 };
+            if (!fb_push_clip(fb, run)) continue;
+            if (dl->has_bg) fb_fill_rect(fb, rx1, ry1, rx2 - rx1, ry2 - ry1, dl->bg);
+
+            size_t off = 0;
+            while (off < dl->used) {
+                const ui_dl_rec_t *r = (const ui_dl_rec_t *)(void *)(dl->arena + off);
+                if (r->x1 < rx2 && r->x2 > rx1 && r->y1 < ry2 && r->y2 > ry1) {
+                    fb_replay_cmd(fb, &r->cmd, dl_rec_text(r));
+                }
+                off += r->size;
+            }
+            fb_pop_clip(fb);
+        }
+    }
+
+    for (uint32_t i = 0; i < n; i++) dl->prev_hash[i] = dl->hash[i];
+    dl->tiles_drawn = drawn;
+    return drawn;
+}
+
+
+/* =============================================================================
+ * ui_canvas_t FRONT-END
+ * =============================================================================
+ *
+ * Each operation is forwarded to the matching fb_* primitive on the list's
+ * framebuffer. Between ui_dl_begin() and ui_dl_end() those primitives are
+ * routed into dl_record() by fb->recorder, so no second code path exists.
+ */
+
+static bool dl_clamp_rect(ui_rect_t r, uint32_t *x, uint32_t *y, uint32_t *w, uint32_t *h)
+{
+    int64_t x1 = r.x < 0 ? 0 : r.x;
+    int64_t y1 = r.y < 0 ? 0 : r.y;
+    int64_t x2 = (int64_t)r.x + r.w;
+    int64_t y2 = (int64_t)r.y + r.h;
+    if (x2 <= x1 || y2 <= y1) return false;
+    *x = (uint32_t)x1;  *w = (uint32_t)(x2 - x1);
+    *y = (uint32_t)y1;  *h = (uint32_t)(y2 - y1);
+    return true;
+}
+
+static uint32_t dl_cv_width(void *ctx)  { return ((ui_dl_t *)ctx)->fb->width; }
+static uint32_t dl_cv_height(void *ctx) { return ((ui_dl_t *)ctx)->fb->height; }
+
+static void dl_cv_draw_pixel(void *ctx, int32_t x, int32_t y, ui_color_t color)
+{
+    if (x < 0 || y < 0) return;
+    fb_fill_rect(((ui_dl_t *)ctx)->fb, (uint32_t)x, (uint32_t)y, 1, 1, color);
+}
+
+/* Reads the framebuffer as it is now, not as recorded */
+static ui_color_t dl_cv_get_pixel(void *ctx, int32_t x, int32_t y)
+{
+    if (x < 0 || y < 0) return 0;
+    return fb_get_pixel(((ui_dl_t *)ctx)->fb, (uint32_t)x, (uint32_t)y);
+}
+
+static void dl_cv_fill_rect(void *ctx, ui_rect_t rect, ui_color_t color)
+{
+    uint32_t x, y, w, h;
+    if (dl_clamp_rect(rect, &x, &y, &w, &h))
+        fb_fill_rect(((ui_dl_t *)ctx)->fb, x, y, w, h, color);
+}
+
+static void dl_cv_draw_rect(void *ctx, ui_rect_t rect, ui_color_t color)
+{
+    if (rect.x < 0 || rect.y < 0) return;
+    fb_draw_rect(((ui_dl_t *)ctx)->fb, (uint32_t)rect.x, (uint32_t)rect.y,
+                 rect.w, rect.h, color);
+}
+
+static void dl_cv_draw_hline(void *ctx, int32_t x, int32_t y, uint32_t len, ui_color_t color)
+{
+    uint32_t cx, cy, w, h;
+    if (dl_clamp_rect(ui_rect(x, y, len, 1), &cx, &cy, &w, &h))
+        fb_draw_hline(((ui_dl_t *)ctx)->fb, cx, cy, w, color);
+}
+
+static void dl_cv_draw_vline(void *ctx, int32_t x, int32_t y, uint32_t len, ui_color_t color)
+{
+    uint32_t cx, cy, w, h;
+    if (dl_clamp_rect(ui_rect(x, y, 1, len), &cx, &cy, &w, &h))
+        fb_draw_vline(((ui_dl_t *)ctx)->fb, cx, cy, h, color);
+}
+
+static void dl_cv_draw_line(void *ctx, int32_t x0, int32_t y0, int32_t x1, int32_t y1, ui_color_t color)
+{
+    fb_draw_line(((ui_dl_t *)ctx)->fb, x0, y0, x1, y1, color);
+}
+
+static void dl_cv_set_clip(void *ctx, ui_rect_t rect)
+{
+    framebuffer_t *fb = ((ui_dl_t *)ctx)->fb;
+    fb_reset_clip(fb);
+    fb_push_clip(fb, (fb_rect_t){ rect.x, rect.y, rect.w, rect.h });
+}
+
+static void dl_cv_clear_clip(void *ctx)
+{
+    fb_reset_clip(((ui_dl_t *)ctx)->fb);
+}
+
+static void dl_cv_clear(void *ctx, ui_color_t color)
+{
+    fb_clear(((ui_dl_t *)ctx)->fb, color);
+}
+
+/* Presenting is the caller's job after ui_dl_end() */
+static void dl_cv_present(void *ctx)
+{
+    (void)ctx;
+}
+
+static const ui_canvas_vtable_t dl_canvas_vt = {
+    .width      = dl_cv_width,
+    .height     = dl_cv_height,
+    .draw_pixel = dl_cv_draw_pixel,
+    .get_pixel  = dl_cv_get_pixel,
+    .fill_rect  = dl_cv_fill_rect,
+    .draw_rect  = dl_cv_draw_rect,
+    .draw_hline = dl_cv_draw_hline,
+    .draw_vline = dl_cv_draw_vline,
+    .draw_line  = dl_cv_draw_line,
+    .set_clip   = dl_cv_set_clip,
+    .clear_clip = dl_cv_clear_clip,
+    .clear      = dl_cv_clear,
+    .present    = dl_cv_present,
+};
+
+ui_canvas_t ui_dl_canvas(ui_dl_t *dl)
+{
+    return (ui_canvas_t){ .vt = &dl_canvas_vt, .ctx = dl };
+}
@@ -0,0 +1,103 @@
+/*
+ * ui_displaylist.h - Tile-Based Retained-Mode Display List
+ * =========================================================
+ *
+ * Immediate-mode UI code (the widgets, kernel/main.c's panels) redraws
+ * everything on every tick, even when nothing visible changed. Working out
+ * the minimal dirty rectangles by hand is tedious and easy to get wrong.
+ *
+ * A display list does it automatically:
+ *
+ *   1. RECORD   ui_dl_begin() installs the list as the framebuffer's
+ *               recorder (fb->recorder). Every recordable fb_* call, and
+ *               every call through ui_dl_canvas(), is appended to an arena
+ *               instead of drawing.
+ *
+ *   2. BIN      Each command's clipped bounding box is mapped onto a grid
+ *               of screen tiles. Each tile folds the hash of every command
+ *               that touches it into a running hash, in draw order.
+ *
+ *   3. DIFF     ui_dl_end() compares each tile hash with the previous
+ *               frame's. Same hash → same commands → same pixels.
+ *
+ *   4. RASTER   Runs of changed tiles in each tile row are clipped to and
+ *               replayed, in record order, with fb_replay_cmd(). Only those
+ *               rectangles are drawn and marked dirty.
+ *
+ * OWNERSHIP RULE:
+ * ---------------
+ * A tile's hash only covers what the list itself drew there. Whatever the
+ * recorded commands don't cover keeps its old pixels. Either make every
+ * recorded region paint its own background (a panel fill, as main.c does)
+ * or give the list a background with ui_dl_set_background().
+ *
+ * OVERFLOW:
+ * ---------
+ * If the arena fills up, everything recorded so far is replayed
+ * immediately, the rest of the frame draws in immediate mode, and the next
+ * frame redraws every tile. Correct, just not minimal.
+ */
+
+#ifndef UI_DISPLAYLIST_H
+#define UI_DISPLAYLIST_H
+
+#include "ui_canvas.h"
+#include "framebuffer.h"
+
+#define UI_DL_MAX_TILES     4096    /* 32 px tiles up to 1080p, coarser above */
+#define UI_DL_MIN_SHIFT     5       /* Smallest tile: 32×32 */
+
+typedef struct ui_dl {
+    fb_recorder_t  rec;             /* Must be first: fb->recorder points here */
+
+    /* Command arena (caller-provided) */
+    uint8_t       *arena;
+    size_t         arena_size;
+    size_t         used;
+    uint32_t       cmd_count;
+    bool           overflow;        /* Arena ran out this frame */
+
+    /* Tile grid */
+    framebuffer_t *fb;
+    uint32_t       tile_shift;
+    uint32_t       cols, rows;
+    uint32_t       hash[UI_DL_MAX_TILES];
+    uint32_t       prev_hash[UI_DL_MAX_TILES];
+
+    /* Optional background painted under every rasterized run */
+    ui_color_t     bg;
+    bool           has_bg;
+
+    /* Statistics for the last ui_dl_end() */
+    uint32_t       tiles_drawn;
+} ui_dl_t;
+
+/* Initialize with a command arena; the list is idle until ui_dl_begin() */
+void ui_dl_init(ui_dl_t *dl, void *arena, size_t arena_size);
+
+/*
+ * Record the next frame into different memory — a frame_alloc() block,
+ * say. Call it before ui_dl_begin(); the tile hashes are kept, so the
+ * diff against the last frame still works.
+ */
+void ui_dl_set_arena(ui_dl_t *dl, void *arena, size_t arena_size);
+
+/* Paint `color` under the commands in each redrawn run */
+void ui_dl_set_background(ui_dl_t *dl, ui_color_t color);
+
+/* Force every tile to be redrawn by the next ui_dl_end() */
+void ui_dl_invalidate(ui_dl_t *dl);
+
+/* Start recording the draw calls made on `fb` */
+void ui_dl_begin(ui_dl_t *dl, framebuffer_t *fb);
+
+/* Stop recording, rasterize changed tiles. Returns the tile count drawn. */
+uint32_t ui_dl_end(ui_dl_t *dl);
+
+/*
+ * ui_canvas_t front-end for the recorder. Drawing through it between
+ * ui_dl_begin() and ui_dl_end() is recorded like the fb_* calls above.
+ */
+ui_canvas_t ui_dl_canvas(ui_dl_t *dl);
+
+#endif /* UI_DISPLAYLIST_H */
@@ -40,10 +40,7 @@
 static void wstr(framebuffer_t *fb, const ui_theme_t *theme,
                  uint32_t x, uint32_t y, const char *s, uint32_t color)
 {
-    if (theme->font_scale <= 1)
-        fb_draw_string_transparent(fb, x, y, s, color);
-    else
-        fb_draw_string_scaled_transparent(fb, x, y, s, color, theme->font_scale);
+    fb_draw_text_run(fb, x, y, s, color, 0, theme->font_scale, FB_TEXT_TRANSPARENT);
 }
 
 static uint32_t wtw(const ui_theme_t *theme, const char *s)
@@ -89,6 +86,20 @@ static inline uint32_t chars_that_fit(uint32_t width, bool large)
     return char_w > 0 ? width / char_w : 0;
 }
 
+/*
+ * True if bounds lies wholly outside the current clip. A scrolling list
+ * draws every row and lets the clip sort it out; checking first skips
+ * the truncation and string work for rows nobody will see.
+ */
+static inline bool ui_clipped_out(const framebuffer_t *fb, ui_rect_t bounds)
+{
+    fb_clip_t clip = fb_get_clip(fb);
+    return (int64_t)bounds.x + bounds.w <= (int64_t)clip.x ||
+           (int64_t)bounds.y + bounds.h <= (int64_t)clip.y ||
+           (int64_t)bounds.x >= (int64_t)clip.x + clip.w ||
+           (int64_t)bounds.y >= (int64_t)clip.y + clip.h;
+}
+
 
 /* =============================================================================
  * PANEL WIDGET
@@ -249,6 +260,7 @@ void ui_draw_list_item(
     bool selected)
 {
     if (bounds.x < 0 || bounds.y < 0) return;
+    if (ui_clipped_out(fb, bounds)) return;
     uint32_t x = (uint32_t)bounds.x;
     uint32_t y = (uint32_t)bounds.y;
 
@@ -306,6 +318,7 @@ void ui_draw_list_item_with_badge(
     bool selected)
 {
     if (bounds.x < 0 || bounds.y < 0) return;
+    if (ui_clipped_out(fb, bounds)) return;
     uint32_t x = (uint32_t)bounds.x;
     uint32_t y = (uint32_t)bounds.y;
 